@@ -61,5 +61,7 @@ floatToDWORD(Float f)             { return *((DWORD*)&f); }
 
 
 Int random(Int max = 100);
+// the same numbers from random again, for replaying a race
+void seedRandom(UInt seed);
 
 #endif /* __COMMON_ALGORITHM_H__ */
@@ -7,10 +7,12 @@
 #include <Common/If/Common.h>
 #include <time.h>
 
+static Boolean firstrun = true;
+
+
 Int 
 random(Int max)
 {
-    static Boolean firstrun = true;
     if (firstrun)
     {
         ::srand( (unsigned)time( NULL ) );
@@ -18,3 +20,11 @@ random(Int max)
     }
     return (rand( ) % max);
 }
+
+
+void
+seedRandom(UInt seed)
+{
+    ::srand(seed);
+    firstrun = false;
+}
@@ -11,6 +11,7 @@
 #include <DxCommon/If/Internal.h>
 #include <DxCommon/If/Utilities.h>
 #include <DxCommon/If/Sound.h>
+#include <DxCommon/If/PcmCache.h>
 #include <DxCommon/If/Input.h>
 #include <DxCommon/If/Timer.h>
 #include <DxCommon/If/D3DFont.h>
@@ -0,0 +1,229 @@
+/**
+* DXCommon library
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __DXCOMMON_MIXER_H__
+#define __DXCOMMON_MIXER_H__
+
+#include <DxCommon/If/Internal.h>
+#include <stdio.h>
+
+#define MIXERFREQUENCY      44100
+#define MIXERBLOCKFRAMES    512
+#define MIXERVOICES         256
+// blocks mixed ahead of the clock by the mixer thread
+#define MIXERLATENCYBLOCKS  2
+
+
+namespace DirectX
+{
+
+class MixerOutput;
+class NullOutput;
+class WaveFileOutput;
+class Mixer;
+
+/*************************************************************************************
+ *@class MixerOutput
+ *@description
+ *    Where the Mixer sends its blocks: interleaved float samples in [-1, 1].
+ *************************************************************************************/
+class MixerOutput
+{
+public:
+    virtual ~MixerOutput( )                                         {               }
+
+public:
+    virtual Boolean open(UInt frequency, UInt nChannels) = 0;
+    virtual void    write(const Float* samples, UInt nFrames) = 0;
+    virtual void    close( ) = 0;
+};
+
+
+/*************************************************************************************
+ *@class NullOutput
+ *@description
+ *    Throws the mixed blocks away, for running and timing the mixer without a
+ *    sound card.
+ *************************************************************************************/
+class NullOutput : public MixerOutput
+{
+public:
+    _dxcommon_ NullOutput( ) : m_frames(0)                          {               }
+
+public:
+    _dxcommon_ Boolean open(UInt frequency, UInt nChannels)         { return true;  }
+    _dxcommon_ void    write(const Float* samples, UInt nFrames)    { m_frames += nFrames; }
+    _dxcommon_ void    close( )                                     {               }
+    _dxcommon_ UHuge   frames( ) const                              { return m_frames; }
+
+private:
+    UHuge   m_frames;
+};
+
+
+/*************************************************************************************
+ *@class WaveFileOutput
+ *@description
+ *    Writes the mixed blocks to a 16 bit PCM wave file.
+ *************************************************************************************/
+class WaveFileOutput : public MixerOutput
+{
+public:
+    _dxcommon_ WaveFileOutput(const Char* filename);
+    _dxcommon_ virtual ~WaveFileOutput( );
+
+public:
+    _dxcommon_ Boolean open(UInt frequency, UInt nChannels);
+    _dxcommon_ void    write(const Float* samples, UInt nFrames);
+    _dxcommon_ void    close( );
+
+private:
+    void    writeHeader( );
+
+private:
+    Char    m_filename[MAX_PATH];
+    FILE*   m_file;
+    UInt    m_frequency;
+    UInt    m_nChannels;
+    UInt    m_dataSize;
+    Short*  m_buffer;
+    UInt    m_bufferFrames;
+};
+
+
+/*************************************************************************************
+ *@class Mixer
+ *@description
+ *    Software replacement for the DirectSound mixer. Sounds are split in sources,
+ *    the samples of a file, and voices, one playing instance of a source with its
+ *    own volume, pan, frequency and 3D position. All playing voices are mixed in
+ *    float, block by block, either by a thread of its own running at the output
+ *    rate or by calling 'mix' directly. The time every block takes is measured,
+ *    so the number of voices that can be mixed in real time can be estimated.
+ *    Like the rest of DxCommon it is a Windows backend: the thread, the clock and
+ *    the atomics are Win32; only the outputs need no sound card. The game runs
+ *    on it when TopSpeed.cfg names a SoundMixer output.
+ *************************************************************************************/
+class Mixer
+{
+public:
+    struct Source
+    {
+        Short*      data;               // interleaved, 16 bit
+        UInt        nFrames;
+        UInt        nChannels;
+        UInt        frequency;
+        UInt        references;
+    };
+
+    struct Voice
+    {
+        Source*     source;
+        Double      position;           // in source frames
+        Boolean     used;
+        Boolean     playing;
+        Boolean     looped;
+        Boolean     positional;
+        Int         volume;             // [0, 100]
+        Int         pan;                // [-100, 100]
+        Int         frequency;          // 0 for the frequency of the source
+        Float       x, y, z;
+        Float       gainLeft;           // gains applied in the last block
+        Float       gainRight;
+    };
+
+public:
+    _dxcommon_ Mixer(MixerOutput* output, UInt frequency = MIXERFREQUENCY, UInt nChannels = 2,
+                     UInt blockFrames = MIXERBLOCKFRAMES, UInt nVoices = MIXERVOICES);
+    _dxcommon_ virtual ~Mixer( );
+
+public:
+    ///@name interface 'source/voice' methods
+    //@{
+    _dxcommon_ Source*  createSource(const UByte* data, UInt size, UInt nChannels, UInt frequency,
+                                     UInt bitsPerSample);
+    _dxcommon_ void     releaseSource(Source* source);
+    _dxcommon_ Voice*   createVoice(Source* source, Boolean positional = false);
+    _dxcommon_ void     destroyVoice(Voice* voice);
+    //@}
+
+    ///@name interface 'voice control' methods, the same ranges as Sound uses
+    //@{
+    _dxcommon_ void     play(Voice* voice, Boolean looped = false);
+    _dxcommon_ void     stop(Voice* voice);
+    _dxcommon_ void     reset(Voice* voice);
+    _dxcommon_ Boolean  playing(Voice* voice);
+    _dxcommon_ void     volume(Voice* voice, Int value);
+    _dxcommon_ void     pan(Voice* voice, Int value);
+    _dxcommon_ void     frequency(Voice* voice, Int value);
+    _dxcommon_ void     position(Voice* voice, Float x, Float y, Float z);
+    //@}
+
+    ///@name interface 'listener' methods
+    //@{
+    _dxcommon_ void     listener(Float x, Float y, Float z, Float direction);
+    _dxcommon_ void     rolloff(Float factor);
+    //@}
+
+    ///@name interface 'mixing' methods
+    //@{
+    _dxcommon_ Boolean  startThread( );
+    _dxcommon_ void     stopThread( );
+    _dxcommon_ void     mix(UInt nBlocks = 1);
+    //@}
+
+    ///@name interface 'statistics' methods, times in microseconds
+    //@{
+    _dxcommon_ UInt     frequency( ) const              { return m_frequency;           }
+    _dxcommon_ UInt     blockFrames( ) const            { return m_blockFrames;         }
+    _dxcommon_ Float    blockTime( ) const;
+    _dxcommon_ Float    mixTime( ) const;
+    _dxcommon_ Float    maxMixTime( ) const             { return m_maxMixTime;          }
+    _dxcommon_ UInt     activeVoices( ) const           { return m_activeVoices;        }
+    _dxcommon_ UInt     maxVoices( ) const;
+    _dxcommon_ UHuge    blocks( ) const                 { return m_blocks;              }
+    _dxcommon_ void     resetStatistics( );
+    //@}
+
+private:
+    void            mixBlock( );
+    void            mixVoice(Voice& voice, Float gainLeft, Float gainRight);
+    void            gains(const Voice& voice, Float& left, Float& right) const;
+    Huge            ticks( ) const;
+    static DWORD WINAPI threadProc(LPVOID parameter);
+    void            run( );
+
+private:
+    MixerOutput*    m_output;
+    UInt            m_frequency;
+    UInt            m_nChannels;
+    UInt            m_blockFrames;
+    Voice*          m_voices;
+    UInt            m_nVoices;
+    Float*          m_block;
+    Mutex           m_mutex;
+
+    Float           m_listenerX;
+    Float           m_listenerY;
+    Float           m_listenerZ;
+    Float           m_listenerDirection;
+    Float           m_rolloff;
+
+    HANDLE          m_thread;
+    volatile LONG   m_running;
+
+    Huge            m_ticksPerSec;
+    UHuge           m_blocks;
+    Double          m_mixTimeTotal;
+    Float           m_maxMixTime;
+    UHuge           m_voicesMixed;
+    UInt            m_activeVoices;
+};
+
+} // namespace DirectX
+
+
+#endif /* __DXCOMMON_MIXER_H__ */
@@ -61,6 +61,8 @@ private:
     IDirectPlay8Server*         m_directPlayServer;
     PDIRECTPLAY8ADDRESS         m_directPlayAddress;
     DPN_APPLICATION_DESC        m_directPlayAppDesc;
+
+protected:
     GUID                        m_applicationGUID;
     IServer*                    m_iServer;
     Boolean                     m_started;
@@ -127,10 +129,13 @@ public:
 
 private:
     IDirectPlay8Client*         m_directPlayClient;
-    IClient*                    m_iClient;
     DPNHANDLE                   m_directPlayEnumHandle;
+
+protected:
+    IClient*                    m_iClient;
     GUID                        m_applicationGUID;
 
+private:
     Mutex                       m_mutex;
     UInt                        m_nSessions;
 
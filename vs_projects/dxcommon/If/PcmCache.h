@@ -0,0 +1,100 @@
+/**
+* DXCommon library
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __DXCOMMON_PCMCACHE_H__
+#define __DXCOMMON_PCMCACHE_H__
+
+#include <DxCommon/If/Internal.h>
+
+// decoded samples kept around while no sound uses them, in bytes
+#define PCMCACHEBUDGET      (32*1024*1024)
+#define PCMCACHEBUCKETS     256
+
+
+namespace DirectX
+{
+
+class PcmCache;
+
+/*************************************************************************************
+ *@class PcmCache
+ *@description
+ *    Keeps the decoded samples of the sound files loaded so far, keyed by path and
+ *    decode format, so loading the same file again copies samples instead of
+ *    running the decoder. A clip stays in memory as long as it is acquired. Once
+ *    the cache holds more than its budget, clips nobody uses are dropped, least
+ *    recently used first. There is one cache for the whole process, 'pcmCache'.
+ *************************************************************************************/
+class PcmCache
+{
+public:
+    struct Clip
+    {
+        Char        path[MAX_PATH];     // lower case, backslashes only
+        UShort      bitsPerSample;
+        UShort      channels;
+        UInt        samplesPerSec;
+        UByte*      data;
+        UInt        size;
+        UInt        references;
+        Clip*       hashNext;
+        Clip*       older;
+        Clip*       newer;
+    };
+
+public:
+    _dxcommon_ PcmCache(UInt budget = PCMCACHEBUDGET);
+    _dxcommon_ virtual ~PcmCache( );
+
+public:
+    ///@name interface 'acquire/release' methods
+    //@{
+    _dxcommon_ Clip*  acquire(Char* filename, UShort bitsPerSample = 16);
+    _dxcommon_ void   release(Clip* clip);
+    _dxcommon_ void   flush( );
+    //@}
+
+    ///@name interface 'get/set' methods
+    //@{
+    _dxcommon_ void   budget(UInt bytes);
+    _dxcommon_ UInt   budget( ) const           { return m_budget;          }
+    _dxcommon_ UInt   hits( ) const             { return m_hits;            }
+    _dxcommon_ UInt   misses( ) const           { return m_misses;          }
+    _dxcommon_ UInt   evictions( ) const        { return m_evictions;       }
+    _dxcommon_ UInt   clips( ) const            { return m_clips;           }
+    _dxcommon_ UInt   bytes( ) const            { return m_bytes;           }
+    _dxcommon_ UHuge  bytesDecoded( ) const     { return m_bytesDecoded;    }
+    //@}
+
+private:
+    UInt    hash(const Char* path, UShort bitsPerSample) const;
+    Clip*   decode(Char* filename, UShort bitsPerSample);
+    void    link(Clip* clip);
+    void    unlink(Clip* clip);
+    void    trim( );
+    void    destroy(Clip* clip);
+
+private:
+    Mutex       m_mutex;
+    Clip*       m_buckets[PCMCACHEBUCKETS];
+    Clip*       m_oldest;
+    Clip*       m_newest;
+    UInt        m_budget;
+    UInt        m_bytes;
+    UInt        m_clips;
+    UInt        m_hits;
+    UInt        m_misses;
+    UInt        m_evictions;
+    UHuge       m_bytesDecoded;
+};
+
+} // namespace DirectX
+
+
+extern   _dxcommon_  DirectX::PcmCache  pcmCache;
+
+
+#endif /* __DXCOMMON_PCMCACHE_H__ */
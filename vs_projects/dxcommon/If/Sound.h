@@ -10,6 +10,7 @@
 #define DIRECTSOUND_VERSION 0x1000
 
 #include <DxCommon/If/Common.h>
+#include <DxCommon/If/Mixer.h>
 #include <mmsystem.h>  
 #include <dsound.h>
 
@@ -33,6 +34,8 @@ class Listener3D;
  *    This class represents the DirectSound interface. It's responsible for 
  *    initiliasing the DirectSound interface and setting the default buffer format.
  *    It has an interface for creating new Sound objects given a Wave file.
+ *    Created with a Mixer instead of a window, it leaves DirectSound alone and
+ *    the sounds it creates play through the Mixer.
  *************************************************************************************/
 class SoundManager
 {
@@ -49,6 +52,7 @@ public:
     ///@name interface 'constructor/desctructor'
     //@{
     _dxcommon_ SoundManager(::Window::Handle, UInt nChannels, UInt frequency, UInt bitrate);
+    _dxcommon_ SoundManager(Mixer* mixer);
     _dxcommon_ virtual ~SoundManager();
     //@}
 
@@ -67,18 +71,23 @@ public:
     _dxcommon_ void           playInSoftware(Boolean val)  { m_playInSoftware = val; }
     _dxcommon_ void           reverseStereo(Boolean val)   { m_reverseStereo = val;  }
     _dxcommon_ LPDIRECTSOUND8 directSound() const          { return m_directSound;   }
+    _dxcommon_ Mixer*         mixer() const                { return m_mixer;         }
     _dxcommon_ Int            bufferFormat(UInt nChannels, UInt frequency, UInt bitrate);
     _dxcommon_ Int            listener3DInterface(LPDIRECTSOUND3DLISTENER* listener);
     _dxcommon_ Algorithm      algorithm( ) const           { return m_3dAlgorithm;   }
     _dxcommon_ void           algorithm(Algorithm algo)    { m_3dAlgorithm = algo;   }
     //@}    
 
+private:
+    Sound*         createMixed(Mixer::Source* source, Boolean enable3d, UInt nBuffers);
+
 private:
     LPDIRECTSOUND8 m_directSound;
     Boolean        m_created;
     Boolean        m_playInSoftware;
     Boolean        m_reverseStereo;
     Algorithm      m_3dAlgorithm;
+    Mixer*         m_mixer;
 };
 
 
@@ -94,17 +103,14 @@ class Sound
 public:
     _dxcommon_ Sound(LPDIRECTSOUNDBUFFER* buffer, UInt bufferSize, UInt nBuffers, WaveFile* waveFile);
     _dxcommon_ Sound(LPDIRECTSOUNDBUFFER* buffer, UInt bufferSize, UInt nBuffers, LPWAVEFORMATEX waveFormat);
-#ifdef _USE_VORBIS_
-    _dxcommon_ Sound(LPDIRECTSOUNDBUFFER* buffer, UInt bufferSize, UInt nBuffers, 
-                     OggVorbis_File* vorbisFile, UShort bitsPerSample, UInt avgBytesPerSec);
-#endif
+    _dxcommon_ Sound(LPDIRECTSOUNDBUFFER* buffer, UInt bufferSize, UInt nBuffers, LPWAVEFORMATEX waveFormat,
+                     const UByte* data);
+    _dxcommon_ Sound(Mixer* mixer, Mixer::Source* source, UInt nBuffers, Boolean enable3d);
     _dxcommon_ virtual ~Sound();
 
     _dxcommon_ Int fillBufferWithSound(LPDIRECTSOUNDBUFFER buffer);
     _dxcommon_ Int fillBufferWithSilence(LPDIRECTSOUNDBUFFER buffer, LPWAVEFORMATEX waveFormat);
-#ifdef _USE_VORBIS_
-    _dxcommon_ Int fillBufferWithSound(LPDIRECTSOUNDBUFFER buffer, OggVorbis_File *vorbisFile, UShort bitsPerSample);
-#endif
+    _dxcommon_ Int fillBufferWithSound(LPDIRECTSOUNDBUFFER buffer, const UByte* data, UShort bitsPerSample);
     _dxcommon_ LPDIRECTSOUNDBUFFER getFreeBuffer();
     
     _dxcommon_ Int play(UInt priority = 0, Boolean looped = FALSE);
@@ -150,8 +156,15 @@ protected:
     LPDIRECTSOUND3DBUFFER   m_buffer3D;
     DS3DBUFFER              m_parameters;
     Float                   m_length; // ORDER DEPENDENCY
+    Mixer*                  m_mixer;
+    Mixer::Source*          m_source;
+    Mixer::Voice**          m_voices;
+    UInt                    m_nextSteal;    // buffer cut off next when all are playing
     
     Int restoreBuffer(LPDIRECTSOUNDBUFFER buffer, Boolean* wasRestored);
+    // takes the buffers in turn, rand() would draw from the stream the race
+    // seeds and a replay then plays back differently
+    UInt stealIndex( );
 };
 
 
@@ -213,6 +226,7 @@ public:
 protected:
     LPDIRECTSOUND3DLISTENER      m_ds3DListener;
     DS3DLISTENER                 m_parameters;
+    Mixer*                       m_mixer;
 };
 
 
@@ -0,0 +1,250 @@
+/**
+* DXCommon library
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __DXCOMMON_UDPNETWORK_H__
+#define __DXCOMMON_UDPNETWORK_H__
+
+#include <DxCommon/If/Network.h>
+#include <vector>
+
+#define UDPDATAGRAMSIZE     1200
+#define UDPMAXCONNECTIONS   64
+#define UDPMAXMESSAGE       (64*1024)
+// reliable datagrams in flight past the oldest one not acknowledged
+#define UDPWINDOW           64
+// reliable datagrams queued per connection, in flight or waiting for the window;
+// the queue starts with room for UDPSENDQUEUE and grows up to UDPMAXQUEUE
+#define UDPSENDQUEUE        256
+#define UDPMAXQUEUE         16384
+// the connection id the server uses for itself
+#define UDPSERVERID         1
+// times in milliseconds
+#define UDPPOLLTIME         5
+#define UDPMINRESEND        20
+#define UDPMAXRESEND        1000
+#define UDPKEEPALIVE        1000
+#define UDPTIMEOUT          10000
+#define UDPCONNECTRETRY     250
+#define UDPCONNECTTIMEOUT   5000
+#define UDPENUMINTERVAL     1000
+
+
+namespace DirectX
+{
+
+struct UdpLink;
+class UdpTransport;
+class UdpServer;
+class UdpClient;
+
+/*************************************************************************************
+ *@class UdpTransport
+ *@description
+ *    One UDP socket and the connections made over it, served by a thread of its
+ *    own that waits for datagrams, resends what was not acknowledged and drops
+ *    peers that went quiet. Messages are sent either reliable, in order and split
+ *    over as many datagrams as needed, or unreliable, one datagram that is thrown
+ *    away at the other end when a newer one already arrived. The callbacks run on
+ *    the transport thread without any lock of the transport held, so they may
+ *    send right away. A host accepts connections and answers enumeration; the
+ *    other side enumerates hosts and connects to one of them.
+ *************************************************************************************/
+class UdpTransport
+{
+public:
+    struct Statistics
+    {
+        UHuge       datagramsSent;
+        UHuge       datagramsReceived;
+        UHuge       bytesSent;
+        UHuge       bytesReceived;
+        UHuge       resends;
+        UHuge       dropped;            // by the simulated loss
+    };
+
+    struct Session
+    {
+        UInt        address;            // network byte order
+        UShort      port;               // host byte order
+        Char        name[MAX_PATH];
+    };
+
+public:
+    _dxcommon_ UdpTransport( );
+    _dxcommon_ virtual ~UdpTransport( );
+
+public:
+    ///@name interface 'socket' methods
+    //@{
+    _dxcommon_ Int      open(UInt port, Boolean host);
+    _dxcommon_ void     close( );
+    _dxcommon_ Boolean  opened( ) const                 { return m_socket != ~UInt(0);  }
+    _dxcommon_ UInt     port( ) const                   { return m_port;                }
+    //@}
+
+    ///@name interface 'connection' methods
+    //@{
+    _dxcommon_ Int      connect(UInt address, UInt port);
+    _dxcommon_ Int      send(UInt to, const void* buffer, UInt size, Boolean reliable);
+    _dxcommon_ UInt     nConnections( );
+    _dxcommon_ UInt     roundTrip(UInt id);
+    //@}
+
+    ///@name interface 'enumeration' methods
+    //@{
+    _dxcommon_ void     startEnum(UInt address, UInt port);
+    _dxcommon_ void     stopEnum( );
+    _dxcommon_ UInt     nSessions( );
+    _dxcommon_ Int      session(UInt i, Session& session);
+    //@}
+
+    ///@name interface 'get/set' methods
+    //@{
+    _dxcommon_ void     setGUID(const GUID& guid);
+    _dxcommon_ void     setSessionName(const Char* name);
+    _dxcommon_ void     setIServer(IServer* server)     { m_iServer = server;           }
+    _dxcommon_ void     setIClient(IClient* client)     { m_iClient = client;           }
+    _dxcommon_ void     simulateLoss(UInt percent)      { m_loss = percent;             }
+    _dxcommon_ void     statistics(Statistics& statistics);
+    //@}
+
+    _dxcommon_ static UInt  resolve(const Char* host);
+
+private:
+    enum State
+    {
+        idle,
+        connecting,
+        connected,
+        refused
+    };
+
+    struct Event
+    {
+        UInt        type;
+        UInt        id;
+        UInt        offset;
+        UInt        size;
+    };
+
+private:
+    static DWORD WINAPI threadProc(LPVOID parameter);
+    void        run( );
+    UInt        now( ) const;
+    void        receive(const UByte* datagram, UInt size, const void* from);
+    void        receiveLink(UdpLink* link, const UByte* datagram, UInt size);
+    void        receiveReliable(UdpLink* link, UShort sequence, UByte flags, const UByte* data, UInt size);
+    void        receiveAck(UdpLink* link, UShort sequence, UShort next);
+    void        tick( );
+    void        flush(UdpLink* link);
+    Int         queue(UdpLink* link, const UByte* data, UInt size);
+    void        control(UdpLink* link, UByte type, UShort sequence, const void* data = 0, UInt size = 0);
+    void        transmit(const void* address, const UByte* datagram, UInt size);
+    UdpLink*    createLink(UInt slot, const void* address);
+    UdpLink*    find(UInt id);
+    void        destroyLink(UInt slot, Boolean notify);
+    void        post(UInt type, UInt id, const UByte* data = 0, UInt size = 0);
+    void        dispatch( );
+
+private:
+    UInt                m_socket;
+    UInt                m_port;
+    Boolean             m_host;
+    Boolean             m_winsock;
+    Mutex               m_mutex;
+    HANDLE              m_thread;
+    volatile LONG       m_running;
+    Huge                m_ticksPerSec;
+
+    UInt                m_protocol;
+    Char                m_sessionName[MAX_PATH];
+    IServer*            m_iServer;
+    IClient*            m_iClient;
+
+    UdpLink*            m_links[UDPMAXCONNECTIONS];
+    UInt                m_serial;
+    volatile State      m_state;
+    UInt                m_nonce;
+    UInt                m_lastConnect;
+
+    Boolean             m_enumerating;
+    UInt                m_enumAddress;
+    UShort              m_enumPort;
+    UInt                m_lastEnum;
+    Session             m_sessions[DXCOMMON_NMAXSESSIONS];
+    UInt                m_nSessions;
+
+    // only touched by the transport thread
+    std::vector<Event>  m_events;
+    std::vector<UByte>  m_eventData;
+
+    UInt                m_loss;
+    UInt                m_random;
+    Statistics          m_statistics;
+};
+
+
+/*************************************************************************************
+ *@class UdpServer
+ *@description
+ *    Server over UdpTransport instead of DirectPlay. Secure packets go over the
+ *    reliable channel, the others are sent unreliable.
+ *************************************************************************************/
+class UdpServer : public Server
+{
+public:
+    _dxcommon_  UdpServer( );
+    _dxcommon_  virtual ~UdpServer( );
+
+public:
+    _dxcommon_  Int     startSession(Char* name, UInt port);
+    _dxcommon_  void    stopSession( );
+    _dxcommon_  void    sendPacket(UInt to, void* buffer, UInt size, Boolean secure, UInt timeout = 0);
+
+    _dxcommon_  UdpTransport&   transport( )            { return m_transport;   }
+
+private:
+    UdpTransport    m_transport;
+};
+
+
+/*************************************************************************************
+ *@class UdpClient
+ *@description
+ *    Client over UdpTransport instead of DirectPlay. Sessions are found by asking
+ *    the given address, or the whole local network when there is none.
+ *************************************************************************************/
+class UdpClient : public Client
+{
+public:
+    _dxcommon_  UdpClient( );
+    _dxcommon_  virtual ~UdpClient( );
+
+public:
+    _dxcommon_  Int     initialize( );
+    _dxcommon_  Int     finalize( );
+
+    _dxcommon_  Int     sendPacket(void* buffer, UInt size, Boolean secure, UInt timeout = 0);
+
+    _dxcommon_  Int     startSessionEnum(UInt port, const Char* ipaddress = 0);
+    _dxcommon_  Int     stopSessionEnum( );
+
+    _dxcommon_  UInt    nSessions( );
+    _dxcommon_  Int     session(UInt i, SessionInfo& info);
+
+    _dxcommon_  Int     joinSession(UInt i);
+    _dxcommon_  Int     joinSessionAt(UInt port, const Char* ipaddress);
+
+    _dxcommon_  UdpTransport&   transport( )            { return m_transport;   }
+
+private:
+    UdpTransport    m_transport;
+};
+
+} // namespace DirectX
+
+
+#endif /* __DXCOMMON_UDPNETWORK_H__ */
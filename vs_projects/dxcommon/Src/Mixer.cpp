@@ -0,0 +1,607 @@
+/**
+* DXCommon library
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include <DxCommon/If/Mixer.h>
+#include <Common/If/Algorithm.h>  // minimum, maximum
+#include <math.h>
+#include <string.h>
+
+// distance up to which a 3D voice plays at full volume, as in DirectSound
+#define MIXERMINDISTANCE    1.0f
+
+
+namespace DirectX
+{
+
+static void put16(FILE* file, UInt value)
+{
+    fputc(value & 0xff, file);
+    fputc((value >> 8) & 0xff, file);
+}
+
+
+static void put32(FILE* file, UInt value)
+{
+    put16(file, value & 0xffff);
+    put16(file, value >> 16);
+}
+
+
+WaveFileOutput::WaveFileOutput(const Char* filename) :
+    m_file(0),
+    m_frequency(0),
+    m_nChannels(0),
+    m_dataSize(0),
+    m_buffer(0),
+    m_bufferFrames(0)
+{
+    DXCOMMON("(+) WaveFileOutput : %s", filename);
+    strncpy(m_filename, filename, MAX_PATH - 1);
+    m_filename[MAX_PATH - 1] = 0;
+}
+
+
+WaveFileOutput::~WaveFileOutput( )
+{
+    DXCOMMON("(-) WaveFileOutput");
+    close( );
+    SAFE_DELETE_ARRAY(m_buffer);
+}
+
+
+Boolean WaveFileOutput::open(UInt frequency, UInt nChannels)
+{
+    close( );
+    m_file = fopen(m_filename, "wb");
+    if (m_file == 0)
+    {
+        DXCOMMON("(!) WaveFileOutput::open : could not create %s", m_filename);
+        return false;
+    }
+    m_frequency = frequency;
+    m_nChannels = nChannels;
+    m_dataSize  = 0;
+    // sizes are filled in by close
+    writeHeader( );
+    return true;
+}
+
+
+void WaveFileOutput::write(const Float* samples, UInt nFrames)
+{
+    if (m_file == 0)
+        return;
+    if (nFrames > m_bufferFrames)
+    {
+        SAFE_DELETE_ARRAY(m_buffer);
+        m_buffer = new Short[nFrames*m_nChannels];
+        m_bufferFrames = nFrames;
+    }
+    UInt nSamples = nFrames*m_nChannels;
+    for (UInt i = 0; i < nSamples; ++i)
+    {
+        Float sample = samples[i];
+        if (sample > 1.0f)
+            sample = 1.0f;
+        else if (sample < -1.0f)
+            sample = -1.0f;
+        m_buffer[i] = Short(sample*32767.0f);
+    }
+    // wave data is little endian, as is every machine this runs on
+    m_dataSize += UInt(fwrite(m_buffer, sizeof(Short), nSamples, m_file)*sizeof(Short));
+}
+
+
+void WaveFileOutput::close( )
+{
+    if (m_file == 0)
+        return;
+    fseek(m_file, 0, SEEK_SET);
+    writeHeader( );
+    fclose(m_file);
+    m_file = 0;
+}
+
+
+void WaveFileOutput::writeHeader( )
+{
+    fwrite("RIFF", 1, 4, m_file);
+    put32(m_file, 36 + m_dataSize);
+    fwrite("WAVEfmt ", 1, 8, m_file);
+    put32(m_file, 16);
+    put16(m_file, 1);                               // PCM
+    put16(m_file, m_nChannels);
+    put32(m_file, m_frequency);
+    put32(m_file, m_frequency*m_nChannels*2);
+    put16(m_file, m_nChannels*2);
+    put16(m_file, 16);
+    fwrite("data", 1, 4, m_file);
+    put32(m_file, m_dataSize);
+}
+
+
+
+
+/*************************************************************************************
+ *@class Mixer
+ *@method
+ *    constructor
+ *@parameters
+ *    - output : where the mixed blocks go, not owned by the mixer
+ *    - frequency : the output frequency
+ *    - nChannels : 1 or 2 output channels
+ *    - blockFrames : the number of frames mixed at a time
+ *    - nVoices : the number of voices that can exist at the same time
+ *************************************************************************************/
+Mixer::Mixer(MixerOutput* output, UInt frequency, UInt nChannels, UInt blockFrames, UInt nVoices) :
+    m_output(output),
+    m_frequency(frequency),
+    m_nChannels((nChannels == 1) ? 1 : 2),
+    m_blockFrames(blockFrames),
+    m_voices(0),
+    m_nVoices(nVoices),
+    m_block(0),
+    m_listenerX(0.0f),
+    m_listenerY(0.0f),
+    m_listenerZ(0.0f),
+    m_listenerDirection(0.0f),
+    m_rolloff(1.0f),
+    m_thread(0),
+    m_running(0),
+    m_ticksPerSec(1)
+{
+    DXCOMMON("(+) Mixer : %d Hz, %d channels, %d frames a block, %d voices", frequency, m_nChannels, blockFrames, nVoices);
+    m_voices = new Voice[m_nVoices];
+    for (UInt i = 0; i < m_nVoices; ++i)
+        m_voices[i].used = false;
+    m_block = new Float[m_blockFrames*m_nChannels];
+    LARGE_INTEGER ticksPerSec;
+    if (QueryPerformanceFrequency(&ticksPerSec))
+        m_ticksPerSec = ticksPerSec.QuadPart;
+    resetStatistics( );
+    if (m_output && !m_output->open(m_frequency, m_nChannels))
+        m_output = 0;
+}
+
+
+Mixer::~Mixer( )
+{
+    DXCOMMON("(-) Mixer");
+    stopThread( );
+    if (m_output)
+        m_output->close( );
+    SAFE_DELETE_ARRAY(m_voices);
+    SAFE_DELETE_ARRAY(m_block);
+}
+
+
+/*************************************************************************************
+ *@class Mixer
+ *@method
+ *    Source* createSource(const UByte* data, UInt size, UInt nChannels, UInt frequency,
+ *                         UInt bitsPerSample)
+ *@description
+ *    Copies wave data, 8 or 16 bit, mono or stereo, into a source voices can play.
+ *    The source is freed once it's released and no voice uses it anymore.
+ *************************************************************************************/
+Mixer::Source* Mixer::createSource(const UByte* data, UInt size, UInt nChannels, UInt frequency,
+                                   UInt bitsPerSample)
+{
+    if ((data == 0) || (nChannels < 1) || (nChannels > 2) ||
+        ((bitsPerSample != 8) && (bitsPerSample != 16)))
+    {
+        DXCOMMON("(!) Mixer::createSource : unsupported format, %d channels, %d bits", nChannels, bitsPerSample);
+        return 0;
+    }
+    Source* source = new Source;
+    source->nChannels  = nChannels;
+    source->frequency  = frequency;
+    source->nFrames    = size/(nChannels*bitsPerSample/8);
+    source->references = 1;
+    UInt nSamples = source->nFrames*nChannels;
+    source->data = new Short[nSamples + nChannels];
+    if (bitsPerSample == 16)
+        memcpy(source->data, data, nSamples*sizeof(Short));
+    else
+    {
+        for (UInt i = 0; i < nSamples; ++i)
+            source->data[i] = Short((Int(data[i]) - 128) << 8);
+    }
+    // one frame of silence, so interpolation never reads past the end
+    for (UInt i = 0; i < nChannels; ++i)
+        source->data[nSamples + i] = 0;
+    return source;
+}
+
+
+void Mixer::releaseSource(Source* source)
+{
+    if (source == 0)
+        return;
+    Mutex::Guard guard(m_mutex);
+    if (--source->references == 0)
+    {
+        SAFE_DELETE_ARRAY(source->data);
+        SAFE_DELETE(source);
+    }
+}
+
+
+Mixer::Voice* Mixer::createVoice(Source* source, Boolean positional)
+{
+    if (source == 0)
+        return 0;
+    Mutex::Guard guard(m_mutex);
+    for (UInt i = 0; i < m_nVoices; ++i)
+    {
+        Voice& voice = m_voices[i];
+        if (voice.used)
+            continue;
+        voice.source     = source;
+        voice.position   = 0.0;
+        voice.used       = true;
+        voice.playing    = false;
+        voice.looped     = false;
+        voice.positional = positional;
+        voice.volume     = 100;
+        voice.pan        = 0;
+        voice.frequency  = 0;
+        voice.x          = 0.0f;
+        voice.y          = 0.0f;
+        voice.z          = 0.0f;
+        voice.gainLeft   = 0.0f;
+        voice.gainRight  = 0.0f;
+        ++source->references;
+        return &voice;
+    }
+    DXCOMMON("(!) Mixer::createVoice : all %d voices in use", m_nVoices);
+    return 0;
+}
+
+
+void Mixer::destroyVoice(Voice* voice)
+{
+    if (voice == 0)
+        return;
+    Source* source = 0;
+    {
+        Mutex::Guard guard(m_mutex);
+        voice->used = false;
+        voice->playing = false;
+        source = voice->source;
+        voice->source = 0;
+    }
+    releaseSource(source);
+}
+
+
+void Mixer::play(Voice* voice, Boolean looped)
+{
+    Mutex::Guard guard(m_mutex);
+    // start from silence to avoid a click
+    if (!voice->playing)
+    {
+        voice->gainLeft  = 0.0f;
+        voice->gainRight = 0.0f;
+    }
+    voice->looped  = looped;
+    voice->playing = true;
+}
+
+
+void Mixer::stop(Voice* voice)
+{
+    Mutex::Guard guard(m_mutex);
+    voice->playing = false;
+}
+
+
+void Mixer::reset(Voice* voice)
+{
+    Mutex::Guard guard(m_mutex);
+    voice->position = 0.0;
+}
+
+
+Boolean Mixer::playing(Voice* voice)
+{
+    Mutex::Guard guard(m_mutex);
+    return voice->playing;
+}
+
+
+void Mixer::volume(Voice* voice, Int value)
+{
+    Mutex::Guard guard(m_mutex);
+    voice->volume = minimum<Int>(maximum<Int>(value, 0), 100);
+}
+
+
+void Mixer::pan(Voice* voice, Int value)
+{
+    Mutex::Guard guard(m_mutex);
+    voice->pan = minimum<Int>(maximum<Int>(value, -100), 100);
+}
+
+
+void Mixer::frequency(Voice* voice, Int value)
+{
+    Mutex::Guard guard(m_mutex);
+    voice->frequency = maximum<Int>(value, 0);
+}
+
+
+void Mixer::position(Voice* voice, Float x, Float y, Float z)
+{
+    Mutex::Guard guard(m_mutex);
+    voice->x = x;
+    voice->y = y;
+    voice->z = z;
+}
+
+
+void Mixer::listener(Float x, Float y, Float z, Float direction)
+{
+    Mutex::Guard guard(m_mutex);
+    m_listenerX = x;
+    m_listenerY = y;
+    m_listenerZ = z;
+    m_listenerDirection = direction;
+}
+
+
+void Mixer::rolloff(Float factor)
+{
+    Mutex::Guard guard(m_mutex);
+    m_rolloff = factor;
+}
+
+
+Boolean Mixer::startThread( )
+{
+    if (m_thread)
+        return true;
+    m_running = 1;
+    m_thread = CreateThread(NULL, 0, threadProc, this, 0, NULL);
+    if (m_thread == 0)
+    {
+        DXCOMMON("(!) Mixer::startThread : could not create the mixer thread");
+        m_running = 0;
+        return false;
+    }
+    return true;
+}
+
+
+void Mixer::stopThread( )
+{
+    if (m_thread == 0)
+        return;
+    InterlockedExchange(&m_running, 0);
+    WaitForSingleObject(m_thread, INFINITE);
+    CloseHandle(m_thread);
+    m_thread = 0;
+}
+
+
+/*************************************************************************************
+ *@class Mixer
+ *@method
+ *    void mix(UInt nBlocks)
+ *@description
+ *    Mixes blocks and hands them to the output right away, for running without
+ *    the mixer thread. Don't call it while the thread runs.
+ *************************************************************************************/
+void Mixer::mix(UInt nBlocks)
+{
+    for (UInt i = 0; i < nBlocks; ++i)
+    {
+        {
+            Mutex::Guard guard(m_mutex);
+            Huge start = ticks( );
+            mixBlock( );
+            Float elapsed = Float(Double(ticks( ) - start)*1000000.0/Double(m_ticksPerSec));
+            m_mixTimeTotal += elapsed;
+            if (elapsed > m_maxMixTime)
+                m_maxMixTime = elapsed;
+            m_voicesMixed += m_activeVoices;
+            ++m_blocks;
+        }
+        if (m_output)
+            m_output->write(m_block, m_blockFrames);
+    }
+}
+
+
+Float Mixer::blockTime( ) const
+{
+    return m_blockFrames*1000000.0f/m_frequency;
+}
+
+
+Float Mixer::mixTime( ) const
+{
+    if (m_blocks == 0)
+        return 0.0f;
+    return Float(m_mixTimeTotal/Double(m_blocks));
+}
+
+
+// voices that fit in one block of time, judging by what the mixed voices cost so far
+UInt Mixer::maxVoices( ) const
+{
+    if ((m_voicesMixed == 0) || (m_mixTimeTotal <= 0.0))
+        return 0;
+    Double voiceTime = m_mixTimeTotal/Double(m_voicesMixed);
+    return UInt(blockTime( )/voiceTime);
+}
+
+
+void Mixer::resetStatistics( )
+{
+    m_blocks = 0;
+    m_mixTimeTotal = 0.0;
+    m_maxMixTime = 0.0f;
+    m_voicesMixed = 0;
+    m_activeVoices = 0;
+}
+
+
+void Mixer::mixBlock( )
+{
+    memset(m_block, 0, m_blockFrames*m_nChannels*sizeof(Float));
+    m_activeVoices = 0;
+    for (UInt i = 0; i < m_nVoices; ++i)
+    {
+        Voice& voice = m_voices[i];
+        if (!voice.used || !voice.playing)
+            continue;
+        Float left, right;
+        gains(voice, left, right);
+        mixVoice(voice, left, right);
+        ++m_activeVoices;
+    }
+}
+
+
+void Mixer::mixVoice(Voice& voice, Float gainLeft, Float gainRight)
+{
+    const Source& source = *voice.source;
+    Double step = Double(voice.frequency ? voice.frequency : source.frequency)/m_frequency;
+    Double end  = Double(source.nFrames);
+    // ramp the gains over the block
+    Float left   = voice.gainLeft;
+    Float right  = voice.gainRight;
+    Float dLeft  = (gainLeft - left)/m_blockFrames;
+    Float dRight = (gainRight - right)/m_blockFrames;
+    Float* out   = m_block;
+    const Short* data = source.data;
+    for (UInt i = 0; i < m_blockFrames; ++i)
+    {
+        if (voice.position >= end)
+        {
+            if (!voice.looped || (end == 0.0))
+            {
+                voice.playing  = false;
+                voice.position = 0.0;
+                break;
+            }
+            voice.position = fmod(voice.position, end);
+        }
+        UInt index = UInt(voice.position);
+        Float frac = Float(voice.position - index);
+        UInt next  = index + 1;
+        if (voice.looped && (next == source.nFrames))
+            next = 0;
+        Float sampleLeft, sampleRight;
+        if (source.nChannels == 1)
+        {
+            Float a = data[index];
+            sampleLeft = sampleRight = a + (data[next] - a)*frac;
+        }
+        else
+        {
+            Float a = data[2*index];
+            Float b = data[2*index + 1];
+            sampleLeft  = a + (data[2*next] - a)*frac;
+            sampleRight = b + (data[2*next + 1] - b)*frac;
+        }
+        left  += dLeft;
+        right += dRight;
+        if (m_nChannels == 1)
+            *out++ += 0.5f*(sampleLeft*left + sampleRight*right);
+        else
+        {
+            *out++ += sampleLeft*left;
+            *out++ += sampleRight*right;
+        }
+        voice.position += step;
+    }
+    voice.gainLeft  = gainLeft;
+    voice.gainRight = gainRight;
+}
+
+
+/*************************************************************************************
+ *@class Mixer
+ *@method
+ *    void gains(const Voice& voice, Float& left, Float& right)
+ *@description
+ *    Volume and pan follow DirectSound: volume drops 1 dB per step below 100, pan
+ *    attenuates the other side 1 dB per step. 3D voices fade with distance using
+ *    the DirectSound rolloff and are panned by their angle to the listener.
+ *************************************************************************************/
+void Mixer::gains(const Voice& voice, Float& left, Float& right) const
+{
+    if (voice.volume <= 0)
+    {
+        left = right = 0.0f;
+        return;
+    }
+    Float gain = powf(10.0f, (voice.volume - 100)/20.0f)/32768.0f;
+    left = right = gain;
+    if (!voice.positional)
+    {
+        if (voice.pan > 0)
+            left  *= powf(10.0f, -voice.pan/20.0f);
+        else if (voice.pan < 0)
+            right *= powf(10.0f, voice.pan/20.0f);
+        return;
+    }
+    Float dx = voice.x - m_listenerX;
+    Float dy = voice.y - m_listenerY;
+    Float dz = voice.z - m_listenerZ;
+    Float distance = sqrtf(dx*dx + dy*dy + dz*dz);
+    if (distance > MIXERMINDISTANCE)
+    {
+        Float attenuation = MIXERMINDISTANCE/(MIXERMINDISTANCE + m_rolloff*(distance - MIXERMINDISTANCE));
+        left  *= attenuation;
+        right *= attenuation;
+    }
+    if (distance > 0.0f)
+    {
+        // the listener faces (sin, 0, cos), so its right hand side is (cos, 0, -sin)
+        Float side = (dx*cosf(m_listenerDirection) - dz*sinf(m_listenerDirection))/distance;
+        left  *= minimum<Float>(1.0f, sqrtf(maximum<Float>(0.0f, 1.0f - side)));
+        right *= minimum<Float>(1.0f, sqrtf(maximum<Float>(0.0f, 1.0f + side)));
+    }
+}
+
+
+Huge Mixer::ticks( ) const
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+
+DWORD WINAPI Mixer::threadProc(LPVOID parameter)
+{
+    ((Mixer*)parameter)->run( );
+    return 0;
+}
+
+
+// keeps MIXERLATENCYBLOCKS blocks ahead of the clock
+void Mixer::run( )
+{
+    Huge start = ticks( );
+    UHuge framesMixed = 0;
+    while (m_running)
+    {
+        UHuge due = UHuge((ticks( ) - start)*m_frequency/m_ticksPerSec) + m_blockFrames*MIXERLATENCYBLOCKS;
+        if (framesMixed < due)
+        {
+            mix(1);
+            framesMixed += m_blockFrames;
+        }
+        else
+            Sleep(1);
+    }
+}
+
+} // namespace DirectX
@@ -0,0 +1,263 @@
+/**
+* DXCommon library
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include <DxCommon/If/Common.h>
+#include <ctype.h>
+
+
+_dxcommon_ DirectX::PcmCache  pcmCache;
+
+
+namespace DirectX
+{
+
+PcmCache::PcmCache(UInt budget) :
+    m_oldest(0),
+    m_newest(0),
+    m_budget(budget),
+    m_bytes(0),
+    m_clips(0),
+    m_hits(0),
+    m_misses(0),
+    m_evictions(0),
+    m_bytesDecoded(0)
+{
+    for (UInt i = 0; i < PCMCACHEBUCKETS; ++i)
+        m_buckets[i] = 0;
+}
+
+
+PcmCache::~PcmCache( )
+{
+    while (m_oldest)
+        destroy(m_oldest);
+}
+
+
+/*************************************************************************************
+ *@class PcmCache
+ *@method
+ *    Clip* acquire(Char* filename, UShort bitsPerSample)
+ *@description
+ *    Returns the decoded samples of a file, decoding it only when it is not cached.
+ *    Every clip returned has to be handed back with 'release'. Returns 0 when the
+ *    file can't be read.
+ *************************************************************************************/
+PcmCache::Clip* PcmCache::acquire(Char* filename, UShort bitsPerSample)
+{
+    if (filename == 0)
+        return 0;
+    if (strlen(filename) >= MAX_PATH)
+    {
+        DXCOMMON("(!) PcmCache::acquire : path too long, %s", filename);
+        return 0;
+    }
+    // Sounds\en\a.ogg and sounds/en/A.ogg are the same file
+    Char path[MAX_PATH];
+    UInt i;
+    for (i = 0; filename[i]; ++i)
+        path[i] = (filename[i] == '/') ? '\\' : Char(tolower(UByte(filename[i])));
+    path[i] = 0;
+
+    Mutex::Guard guard(m_mutex);
+    UInt bucket = hash(path, bitsPerSample);
+    for (Clip* clip = m_buckets[bucket]; clip; clip = clip->hashNext)
+    {
+        if ((clip->bitsPerSample == bitsPerSample) && (strcmp(clip->path, path) == 0))
+        {
+            ++m_hits;
+            ++clip->references;
+            unlink(clip);
+            link(clip);
+            return clip;
+        }
+    }
+
+    ++m_misses;
+    Clip* clip = decode(filename, bitsPerSample);
+    if (clip == 0)
+        return 0;
+    strcpy(clip->path, path);
+    clip->references = 1;
+    clip->hashNext = m_buckets[bucket];
+    m_buckets[bucket] = clip;
+    link(clip);
+    ++m_clips;
+    m_bytes += clip->size;
+    m_bytesDecoded += clip->size;
+    trim( );
+    return clip;
+}
+
+
+void PcmCache::release(Clip* clip)
+{
+    if (clip == 0)
+        return;
+    Mutex::Guard guard(m_mutex);
+    if (clip->references > 0)
+        --clip->references;
+    trim( );
+}
+
+
+// drops every clip that is not in use
+void PcmCache::flush( )
+{
+    Mutex::Guard guard(m_mutex);
+    Clip* clip = m_oldest;
+    while (clip)
+    {
+        Clip* newer = clip->newer;
+        if (clip->references == 0)
+        {
+            destroy(clip);
+            ++m_evictions;
+        }
+        clip = newer;
+    }
+}
+
+
+void PcmCache::budget(UInt bytes)
+{
+    Mutex::Guard guard(m_mutex);
+    m_budget = bytes;
+    trim( );
+}
+
+
+UInt PcmCache::hash(const Char* path, UShort bitsPerSample) const
+{
+    // FNV-1a
+    UInt h = 2166136261u;
+    for (; *path; ++path)
+        h = (h ^ UByte(*path))*16777619u;
+    h = (h ^ bitsPerSample)*16777619u;
+    return h % PCMCACHEBUCKETS;
+}
+
+
+PcmCache::Clip* PcmCache::decode(Char* filename, UShort bitsPerSample)
+{
+#ifdef _USE_VORBIS_
+    if ((bitsPerSample != 8) && (bitsPerSample != 16))
+        return 0;
+    FILE* file = fopen(filename, "rb");
+    if (file == 0)
+    {
+        DXCOMMON("(!) PcmCache::decode : could not locate %s", filename);
+        return 0;
+    }
+    OggVorbis_File vorbisFile;
+    if (ov_open(file, &vorbisFile, NULL, 0) < 0)
+    {
+        DXCOMMON("(!) PcmCache::decode : %s is not an Ogg Vorbis file", filename);
+        fclose(file);
+        return 0;
+    }
+    vorbis_info* vi = ov_info(&vorbisFile, -1);
+    ogg_int64_t samples = ov_pcm_total(&vorbisFile, -1);
+    if ((vi == 0) || (samples <= 0))
+    {
+        DXCOMMON("(!) PcmCache::decode : %s holds no samples", filename);
+        ov_clear(&vorbisFile);
+        return 0;
+    }
+
+    Clip* clip = new Clip;
+    clip->bitsPerSample = bitsPerSample;
+    clip->channels      = UShort(vi->channels);
+    clip->samplesPerSec = vi->rate;
+    clip->size          = UInt(samples)*(bitsPerSample/8)*vi->channels;
+    clip->data          = new UByte[clip->size];
+    clip->hashNext      = 0;
+    clip->older         = 0;
+    clip->newer         = 0;
+
+    // 8 bit wave data is unsigned, 16 bit is signed
+    Int sec = 0;
+    UInt pos = 0;
+    while (pos < clip->size)
+    {
+        long read = ov_read(&vorbisFile, (char*)(clip->data) + pos, clip->size - pos,
+                            0, bitsPerSample/8, (bitsPerSample == 16) ? 1 : 0, &sec);
+        if (read <= 0)
+            break;
+        pos += read;
+    }
+    if (pos < clip->size)
+        FillMemory(clip->data + pos, clip->size - pos, (UByte)(bitsPerSample == 8 ? 128 : 0));
+    // closes the file as well
+    ov_clear(&vorbisFile);
+    return clip;
+#else
+    DXCOMMON("(!) PcmCache::decode : no decoder for %s", filename);
+    return 0;
+#endif
+}
+
+
+// adds a clip as the most recently used one
+void PcmCache::link(Clip* clip)
+{
+    clip->older = m_newest;
+    clip->newer = 0;
+    if (m_newest)
+        m_newest->newer = clip;
+    else
+        m_oldest = clip;
+    m_newest = clip;
+}
+
+
+void PcmCache::unlink(Clip* clip)
+{
+    if (clip->older)
+        clip->older->newer = clip->newer;
+    else
+        m_oldest = clip->newer;
+    if (clip->newer)
+        clip->newer->older = clip->older;
+    else
+        m_newest = clip->older;
+    clip->older = 0;
+    clip->newer = 0;
+}
+
+
+void PcmCache::trim( )
+{
+    Clip* clip = m_oldest;
+    while (clip && (m_bytes > m_budget))
+    {
+        Clip* newer = clip->newer;
+        if (clip->references == 0)
+        {
+            DXCOMMON("PcmCache::trim : dropping %s", clip->path);
+            destroy(clip);
+            ++m_evictions;
+        }
+        clip = newer;
+    }
+}
+
+
+void PcmCache::destroy(Clip* clip)
+{
+    Clip** entry = &m_buckets[hash(clip->path, clip->bitsPerSample)];
+    while (*entry && (*entry != clip))
+        entry = &(*entry)->hashNext;
+    if (*entry)
+        *entry = clip->hashNext;
+    unlink(clip);
+    --m_clips;
+    m_bytes -= clip->size;
+    SAFE_DELETE_ARRAY(clip->data);
+    SAFE_DELETE(clip);
+}
+
+} // namespace DirectX
@@ -29,7 +29,8 @@ SoundManager::SoundManager(::Window::Handle handle, UInt nChannels, UInt frequen
     m_created(true),
     m_playInSoftware(false),
     m_reverseStereo(false),
-    m_3dAlgorithm(AlgoFullHrtf)
+    m_3dAlgorithm(AlgoFullHrtf),
+    m_mixer(0)
 {
 	DXCOMMON("(+) SoundManager : %d channels, %d freq, %d bitrate", nChannels, frequency, bitrate);
     // m_directSound = 0;
@@ -78,6 +79,27 @@ SoundManager::~SoundManager()
 
 
 
+/*************************************************************************************
+ *@class SoundManager
+ *@method
+ *    constructor
+ *@parameters
+ *    - mixer : the software mixer all sounds will play through, not owned by the
+ *            SoundManager
+ *************************************************************************************/
+SoundManager::SoundManager(Mixer* mixer) :
+    m_directSound(0),
+    m_created(mixer != 0),
+    m_playInSoftware(true),
+    m_reverseStereo(false),
+    m_3dAlgorithm(AlgoDefault),
+    m_mixer(mixer)
+{
+    DXCOMMON("(+) SoundManager : software mixer");
+}
+
+
+
 /*************************************************************************************
  *@class SoundManager
  *@method
@@ -144,6 +166,8 @@ SoundManager::bufferFormat(UInt nChannels, UInt frequency, UInt bitrate)
 Int
 SoundManager::listener3DInterface(LPDIRECTSOUND3DLISTENER* listener)
 {
+    if (m_mixer)
+        return dxFailed;
     HRESULT             hr;
     DSBUFFERDESC        bufferDesc;
     LPDIRECTSOUNDBUFFER buffer = NULL;
@@ -217,6 +241,27 @@ Sound* SoundManager::create(Char* filename, Boolean enable3d, UInt nBuffers)
     WaveFile*            waveFile   = 0;
     Sound*               sound      = 0;
 
+    if (m_mixer)
+    {
+        if (filename == 0 || nBuffers < 1)
+            return 0;
+        WaveFile mixerFile;
+        mixerFile.open(filename, 0, WAVEFILE_READ);
+        if (mixerFile.size() == 0)
+        {
+            DXCOMMON("(!) SoundManager::Create : Size of Wavefile == 0.");
+            return 0;
+        }
+        UByte* data = new UByte[mixerFile.size()];
+        UInt   read = 0;
+        mixerFile.read(data, mixerFile.size(), &read);
+        WAVEFORMATEX* format = mixerFile.waveFormat();
+        Mixer::Source* source = m_mixer->createSource(data, read, format->nChannels, 
+                                                      format->nSamplesPerSec, format->wBitsPerSample);
+        SAFE_DELETE_ARRAY(data);
+        return createMixed(source, enable3d, nBuffers);
+    }
+
     if (m_directSound == 0)
         return 0;
     if (filename == 0 || nBuffers < 1)
@@ -331,6 +376,11 @@ Sound* SoundManager::create(Char* filename, Boolean enable3d, UInt nBuffers)
 
 Sound* SoundManager::create(DSBUFFERDESC& bufferDesc, Boolean enable3d, UInt nBuffers)
 {
+    if (m_mixer)
+    {
+        DXCOMMON("(!) SoundManager::Create : the software mixer can't create empty buffers.");
+        return 0;
+    }
     HRESULT res;
     // Int     result = dxSuccess;
     UInt    i;
@@ -424,6 +474,14 @@ Sound* SoundManager::create(DSBUFFERDESC& bufferDesc, Boolean enable3d, UInt nBu
 
 
 #ifdef _USE_VORBIS_
+/*************************************************************************************
+ *@class SoundManager
+ *@method
+ *    Sound* createVorbis(Char* filename, Boolean enable3d, UInt nBuffers)
+ *@description
+ *    Creates a sound from an Ogg Vorbis file. The decoded samples come from
+ *    'pcmCache', so a file is only decoded the first time it's loaded.
+ *************************************************************************************/
 Sound* SoundManager::createVorbis(Char* filename, Boolean enable3d, UInt nBuffers)
 {
     HRESULT res;
@@ -431,10 +489,9 @@ Sound* SoundManager::createVorbis(Char* filename, Boolean enable3d, UInt nBuffer
     UInt    i;
     LPDIRECTSOUNDBUFFER* buffer     = 0;
     UInt                 bufferSize = 0;
-    WaveFile*            waveFile   = 0;
     Sound*               sound      = 0;
 
-    if (m_directSound == 0)
+    if ((m_directSound == 0) && (m_mixer == 0))
         return 0;
     if (filename == 0 || nBuffers < 1)
         return 0;
@@ -448,32 +505,33 @@ Sound* SoundManager::createVorbis(Char* filename, Boolean enable3d, UInt nBuffer
         return 0;
     }
 
-    // Ogg vorbis specific code
-    FILE *file;
-    file = fopen(filename, "rb");
-    if (file == 0)
+    PcmCache::Clip* clip = pcmCache.acquire(filename, 16); // vorbis is always 16
+    if (clip == 0)
     {
-        DXCOMMON("(!) SoundManager::Create : could not locate %s", filename);
+        DXCOMMON("(!) SoundManager::Create : could not load %s", filename);
         // Cleanup
         SAFE_DELETE(buffer);
         return 0;
     }
-    OggVorbis_File vorbisFile;
-    ov_open(file, &vorbisFile, NULL, 0);
-
-    vorbis_info *vi = ov_info(&vorbisFile, -1);
+    bufferSize = clip->size;
 
-    // Get the size of the VorbisFile so we can set the size of the buffer
-    bufferSize = (UInt) ov_pcm_total(&vorbisFile, -1) * 2 * vi->channels;
+    if (m_mixer)
+    {
+        SAFE_DELETE(buffer);
+        Mixer::Source* source = m_mixer->createSource(clip->data, clip->size, clip->channels,
+                                                      clip->samplesPerSec, clip->bitsPerSample);
+        pcmCache.release(clip);
+        return createMixed(source, enable3d, nBuffers);
+    }
 
     // Get the wave format
     WAVEFORMATEX        waveFormat;
     ZeroMemory(&waveFormat, sizeof(WAVEFORMATEX));
 
     waveFormat.cbSize           = sizeof(WAVEFORMATEX);
-    waveFormat.nChannels        = (WORD)vi->channels;
-    waveFormat.wBitsPerSample   = 16; // vorbis is always 16
-    waveFormat.nSamplesPerSec   = vi->rate;
+    waveFormat.nChannels        = clip->channels;
+    waveFormat.wBitsPerSample   = clip->bitsPerSample;
+    waveFormat.nSamplesPerSec   = clip->samplesPerSec;
     waveFormat.nAvgBytesPerSec  = waveFormat.nSamplesPerSec*waveFormat.nChannels*2;
     waveFormat.nBlockAlign      = 2*waveFormat.nChannels;
     waveFormat.wFormatTag       = 1;
@@ -507,7 +565,6 @@ Sound* SoundManager::createVorbis(Char* filename, Boolean enable3d, UInt nBuffer
     }
     else
         bufferDesc.guid3DAlgorithm = GUID_NULL;
-    bufferDesc.lpwfxFormat     = waveFile->m_waveFormat;
     bufferDesc.lpwfxFormat     = &waveFormat;
 
     // DirectSound is only guarenteed to play PCM data.  Other
@@ -528,7 +585,7 @@ Sound* SoundManager::createVorbis(Char* filename, Boolean enable3d, UInt nBuffer
         {
             DXCOMMON("(!) SoundManager::Create : Error 0x%x creating soundbuffer. (%s)", res, DXGetErrorDescription8(res));
             // Cleanup
-            SAFE_DELETE(waveFile);
+            pcmCache.release(clip);
             SAFE_DELETE(buffer);
             return 0;
         }
@@ -539,26 +596,36 @@ Sound* SoundManager::createVorbis(Char* filename, Boolean enable3d, UInt nBuffer
         {
             DXCOMMON("(!) SoundManager::Create : Error duplicating the soundbuffer for the %dth time.", i);
             // Cleanup
-            SAFE_DELETE(waveFile);
+            pcmCache.release(clip);
             SAFE_DELETE(buffer);
             return 0;
         }
     }
 
     // Create the sound
-    sound = new Sound(buffer, bufferSize, nBuffers, &vorbisFile, 
-                      waveFormat.wBitsPerSample, waveFormat.nAvgBytesPerSec);
+    sound = new Sound(buffer, bufferSize, nBuffers, &waveFormat, clip->data);
     sound->playInSoftware(m_playInSoftware);
     sound->reverseStereo(m_reverseStereo);
     SAFE_DELETE(buffer);
-    ov_clear(&vorbisFile);
-    fclose(file);
+    pcmCache.release(clip);
     return sound;
 }
 #endif
 
 
 
+// the sound takes over the reference to the source
+Sound* SoundManager::createMixed(Mixer::Source* source, Boolean enable3d, UInt nBuffers)
+{
+    if (source == 0)
+        return 0;
+    Sound* sound = new Sound(m_mixer, source, nBuffers, enable3d);
+    sound->reverseStereo(m_reverseStereo);
+    return sound;
+}
+
+
+
 
 /*************************************************************************************
  *@class Sound
@@ -574,7 +641,11 @@ Sound::Sound( LPDIRECTSOUNDBUFFER* buffer, UInt bufferSize,
     m_reverseStereo(1),
     // calculate the length of the sound
     m_length(Float(m_bufferSize)/Float(m_waveFile->m_waveFormat->nAvgBytesPerSec)),
-    m_buffer3D(0)
+    m_buffer3D(0),
+    m_mixer(0),
+    m_source(0),
+    m_voices(0),
+    m_nextSteal(0)
 {
     UInt i;
     m_buffer = new LPDIRECTSOUNDBUFFER[nBuffers];
@@ -595,7 +666,11 @@ Sound::Sound(LPDIRECTSOUNDBUFFER* buffer, UInt bufferSize, UInt nBuffers, LPWAVE
     m_reverseStereo(1),
     // calculate the length of the sound
     m_length(Float(m_bufferSize)/Float(waveFormat->nAvgBytesPerSec)),
-    m_buffer3D(0)
+    m_buffer3D(0),
+    m_mixer(0),
+    m_source(0),
+    m_voices(0),
+    m_nextSteal(0)
 {
     UInt i;
     m_buffer = new LPDIRECTSOUNDBUFFER[nBuffers];
@@ -609,30 +684,54 @@ Sound::Sound(LPDIRECTSOUNDBUFFER* buffer, UInt bufferSize, UInt nBuffers, LPWAVE
 }
 
 
-
-#ifdef _USE_VORBIS_
-Sound::Sound(LPDIRECTSOUNDBUFFER* buffer, UInt bufferSize, UInt nBuffers,
-             OggVorbis_File* vorbisFile, UShort bitsPerSample, UInt avgBytesPerSec) :
+// fills the first buffer with decoded samples, 'data' holds bufferSize bytes
+Sound::Sound(LPDIRECTSOUNDBUFFER* buffer, UInt bufferSize, UInt nBuffers, LPWAVEFORMATEX waveFormat,
+             const UByte* data) :
     m_bufferSize(bufferSize),
     m_nBuffers(nBuffers),
     m_waveFile(0),
     m_playInSoftware(false),
     m_reverseStereo(1),
     // calculate the length of the sound
-    m_length(Float(m_bufferSize)/Float(avgBytesPerSec)),
-    m_buffer3D(0)
+    m_length(Float(m_bufferSize)/Float(waveFormat->nAvgBytesPerSec)),
+    m_buffer3D(0),
+    m_mixer(0),
+    m_source(0),
+    m_voices(0),
+    m_nextSteal(0)
 {
     UInt i;
     m_buffer = new LPDIRECTSOUNDBUFFER[nBuffers];
     for (i = 0; i < nBuffers; ++i)
         m_buffer[i] = buffer[i];
-    fillBufferWithSound(m_buffer[0], vorbisFile, bitsPerSample);
+    fillBufferWithSound(m_buffer[0], data, waveFormat->wBitsPerSample);
 
     // Rewind all buffers
     for (i = 0; i < nBuffers; ++i)
         m_buffer[i]->SetCurrentPosition(0);
 }
-#endif
+
+
+
+// plays through the software mixer, one voice per buffer
+Sound::Sound(Mixer* mixer, Mixer::Source* source, UInt nBuffers, Boolean enable3d) :
+    m_buffer(0),
+    m_bufferSize(source->nFrames*source->nChannels*sizeof(Short)),
+    m_nBuffers(nBuffers),
+    m_waveFile(0),
+    m_playInSoftware(true),
+    m_reverseStereo(1),
+    m_length(Float(source->nFrames)/Float(source->frequency)),
+    m_buffer3D(0),
+    m_mixer(mixer),
+    m_source(source),
+    m_voices(0),
+    m_nextSteal(0)
+{
+    m_voices = new Mixer::Voice*[nBuffers];
+    for (UInt i = 0; i < nBuffers; ++i)
+        m_voices[i] = m_mixer->createVoice(source, enable3d);
+}
 
 
 /*************************************************************************************
@@ -642,6 +741,14 @@ Sound::Sound(LPDIRECTSOUNDBUFFER* buffer, UInt bufferSize, UInt nBuffers,
  *************************************************************************************/
 Sound::~Sound()
 {
+    if (m_mixer)
+    {
+        for (UInt i = 0; i < m_nBuffers; ++i)
+            m_mixer->destroyVoice(m_voices[i]);
+        SAFE_DELETE_ARRAY(m_voices);
+        m_mixer->releaseSource(m_source);
+        return;
+    }
     if (playing( ))
         stop( );
     for (UInt i = 0; i < m_nBuffers; ++i)
@@ -768,13 +875,12 @@ Sound::fillBufferWithSilence(LPDIRECTSOUNDBUFFER buffer, LPWAVEFORMATEX waveForm
     return dxSuccess;
 }
 
-#ifdef _USE_VORBIS_
-Int Sound::fillBufferWithSound(LPDIRECTSOUNDBUFFER buffer, OggVorbis_File *vorbisFile, UShort bitsPerSample)
+Int Sound::fillBufferWithSound(LPDIRECTSOUNDBUFFER buffer, const UByte* data, UShort bitsPerSample)
 {
     void*   lockedBuffer     = 0; // Pointer to locked buffer memory
     UInt    lockedBufferSize = 0;    // Size of the locked DirectSound buffer
 
-    if (buffer == 0)
+    if ((buffer == 0) || (data == 0))
         return dxFailed;
 
     // Make sure we have focus, and we didn't just switch in from
@@ -794,29 +900,12 @@ Int Sound::fillBufferWithSound(LPDIRECTSOUNDBUFFER buffer, OggVorbis_File *vorbi
         return dxFailed;
     }
 
-    // read in the data
-    UInt size = lockedBufferSize;
-    int retval = 1;
-    int pos = 0;
-    int sec = 0;
-    while (retval && pos < (int)size)
+    UInt size = minimum<UInt>(lockedBufferSize, m_bufferSize);
+    CopyMemory(lockedBuffer, data, size);
+    if (size < lockedBufferSize)
     {
-        retval = ov_read(vorbisFile, (char*)(lockedBuffer) + pos, size - pos, 0, 2, 1, &sec);
-        pos += retval;
-    }
-
-    // fill the remainder with silence
-    if (pos == 0)
-    {
-        // Wav is blank, so just fill with silence
-        FillMemory((UByte*) lockedBuffer, 
-                   lockedBufferSize, 
-                   (UByte)(bitsPerSample == 8 ? 128 : 0 ));
-    }
-    else if ((UInt)pos < lockedBufferSize)
-    {
-        FillMemory((UByte*) lockedBuffer + pos, 
-                    lockedBufferSize - pos, 
+        FillMemory((UByte*) lockedBuffer + size, 
+                    lockedBufferSize - size, 
                     (UByte)(bitsPerSample == 8 ? 128 : 0));
     }
 
@@ -825,7 +914,6 @@ Int Sound::fillBufferWithSound(LPDIRECTSOUNDBUFFER buffer, OggVorbis_File *vorbi
 
     return dxSuccess;
 }
-#endif
 
 
 /*************************************************************************************
@@ -876,11 +964,13 @@ Int Sound::restoreBuffer(LPDIRECTSOUNDBUFFER buffer, Boolean* wasRestored)
  *@method
  *    LPDIRECTSOUNDBUFFER getFreeBuffer()
  *@returns
- *    A free SoundBuffer associated with this Sound, or, when none being available, a
- *    random one.
+ *    A free SoundBuffer associated with this Sound, or, when none being available, the
+ *    next one in turn.
  *************************************************************************************/
 LPDIRECTSOUNDBUFFER Sound::getFreeBuffer()
 {
+    if (m_mixer)
+        return 0;
     if (m_buffer == 0)
         return 0; 
 
@@ -899,7 +989,16 @@ LPDIRECTSOUNDBUFFER Sound::getFreeBuffer()
     if (i != m_nBuffers)
         return m_buffer[i];
     else
-        return m_buffer[rand() % m_nBuffers];
+        return m_buffer[stealIndex( )];
+}
+
+
+// the buffer to cut off when all of them are playing, each in turn
+UInt Sound::stealIndex( )
+{
+    UInt i = m_nextSteal;
+    m_nextSteal = (m_nextSteal + 1) % m_nBuffers;
+    return i;
 }
 
 
@@ -920,6 +1019,20 @@ LPDIRECTSOUNDBUFFER Sound::getFreeBuffer()
  *************************************************************************************/
 Int Sound::play(UInt priority, Boolean looped)
 {
+    if (m_mixer)
+    {
+        // a voice that isn't playing, or the next one in turn
+        Mixer::Voice* voice = 0;
+        for (UInt i = 0; (i < m_nBuffers) && (voice == 0); ++i)
+            if (m_voices[i] && !m_mixer->playing(m_voices[i]))
+                voice = m_voices[i];
+        if (voice == 0)
+            voice = m_voices[stealIndex( )];
+        if (voice == 0)
+            return dxFailed;
+        m_mixer->play(voice, looped);
+        return dxSuccess;
+    }
     Boolean  restored;
 
     if (m_buffer == 0)
@@ -999,6 +1112,13 @@ Int Sound::play(UInt priority, Boolean looped)
  *************************************************************************************/
 Int Sound::stop()
 {
+    if (m_mixer)
+    {
+        for (UInt i = 0; i < m_nBuffers; ++i)
+            if (m_voices[i])
+                m_mixer->stop(m_voices[i]);
+        return dxSuccess;
+    }
     if (m_buffer == 0)
         return dxFailed;
 
@@ -1026,6 +1146,13 @@ Int Sound::stop()
  *************************************************************************************/
 Int Sound::reset()
 {
+    if (m_mixer)
+    {
+        for (UInt i = 0; i < m_nBuffers; ++i)
+            if (m_voices[i])
+                m_mixer->reset(m_voices[i]);
+        return dxSuccess;
+    }
     if (m_buffer == 0)
         return dxFailed;
 
@@ -1052,6 +1179,13 @@ Int Sound::reset()
  *************************************************************************************/
 Boolean Sound::playing()
 {
+    if (m_mixer)
+    {
+        for (UInt i = 0; i < m_nBuffers; ++i)
+            if (m_voices[i] && m_mixer->playing(m_voices[i]))
+                return true;
+        return false;
+    }
     if (m_buffer == 0)
         return false; 
 
@@ -1073,6 +1207,9 @@ Boolean Sound::playing()
 
 Int Sound::initializeBuffer3D(UInt index)
 {
+    // mixer voices are created 3D already
+    if (m_mixer)
+        return dxSuccess;
     if (m_buffer3D)
     {
         DXCOMMON("(!) Sound::initializeBuffer3D : already initialized");
@@ -1117,6 +1254,13 @@ Int Sound::initializeBuffer3D(UInt index)
  *************************************************************************************/
 void Sound::pan(Int value)
 {   
+    if (m_mixer)
+    {
+        for (UInt i = 0; i < m_nBuffers; ++i)
+            if (m_voices[i])
+                m_mixer->pan(m_voices[i], value*m_reverseStereo);
+        return;
+    }
     UInt i;
     if (value == 0)
     {
@@ -1153,6 +1297,14 @@ void Sound::pan(Int value)
  *************************************************************************************/
 void Sound::frequency(Int value)
 {
+    if (m_mixer)
+    {
+        value = minimum<Int>(maximum<Int>(value, DSBFREQUENCY_MIN), DSBFREQUENCY_MAX);
+        for (UInt i = 0; i < m_nBuffers; ++i)
+            if (m_voices[i])
+                m_mixer->frequency(m_voices[i], value);
+        return;
+    }
     UInt i;
     if (value < DSBFREQUENCY_MIN)
     {
@@ -1182,6 +1334,12 @@ void Sound::frequency(Int value)
  *************************************************************************************/
 Int Sound::frequency( )
 {
+    if (m_mixer)
+    {
+        if ((m_voices[0] == 0) || (m_voices[0]->frequency == 0))
+            return Int(m_source->frequency);
+        return m_voices[0]->frequency;
+    }
     DWORD freq;
     m_buffer[0]->GetFrequency(&freq);
     return (Int) freq;
@@ -1199,6 +1357,13 @@ Int Sound::frequency( )
  *************************************************************************************/
 void Sound::volume(Int value)
 {
+    if (m_mixer)
+    {
+        for (UInt i = 0; i < m_nBuffers; ++i)
+            if (m_voices[i])
+                m_mixer->volume(m_voices[i], value);
+        return;
+    }
     UInt i;
     if (value < 0)
     {
@@ -1227,6 +1392,8 @@ void Sound::volume(Int value)
  *************************************************************************************/
 Int Sound::volume( )
 {
+    if (m_mixer)
+        return m_voices[0] ? m_voices[0]->volume : 0;
     long vol;
     m_buffer[0]->GetVolume(&vol);
     return Int((vol / 100.0L) + 100.0L);
@@ -1241,6 +1408,13 @@ Sound::length( )
 void 
 Sound::position(Vector3 pos)
 {
+    if (m_mixer)
+    {
+        for (UInt i = 0; i < m_nBuffers; ++i)
+            if (m_voices[i])
+                m_mixer->position(m_voices[i], pos.x, pos.y, pos.z);
+        return;
+    }
     DWORD applyFlag = DS3D_IMMEDIATE;
     m_parameters.vPosition.x = pos.x;
     m_parameters.vPosition.y = pos.y;
@@ -1271,6 +1445,8 @@ Sound::copyBuffer(LPDIRECTSOUNDBUFFER* buffer, UInt bufferOffset, UInt bufferSiz
     UInt    lockedOriginalBufferSize = 0;
 
 
+    if (m_mixer)
+        return (UInt)dxFailed;
     if (buffer == 0)
         return (UInt)dxFailed;
 
@@ -1318,6 +1494,8 @@ Sound::insertSilence(UInt bufferOffset, UInt bufferSize)
     void*   lockedBuffer     = 0; // Pointer to locked buffer memory
     UInt    lockedBufferSize = 0;    // Size of the locked DirectSound buffer
 
+    if (m_mixer)
+        return (UInt)dxFailed;
     if ((*m_buffer) == 0) // Remember this spot
         return (UInt)dxFailed;
 
@@ -2025,9 +2203,14 @@ Int WaveFile::write(UInt nSizeToWrite, UByte* pbSrcData, UInt* pnSizeWrote)
 
 
 Listener3D::Listener3D(SoundManager* soundManager) :
-    m_ds3DListener(0)
+    m_ds3DListener(0),
+    m_mixer(soundManager->mixer( ))
 {
     DXCOMMON("(+) Listener3D");
+    ZeroMemory(&m_parameters, sizeof(DS3DLISTENER));
+    m_parameters.vOrientFront.z = 1.0f;
+    if (m_mixer)
+        return;
     if (soundManager->listener3DInterface(&m_ds3DListener) != dxSuccess)
     {
         DXCOMMON("(!) Listener3D : failed to get listener3DInterface from SoundManager");
@@ -2065,6 +2248,8 @@ Listener3D::parameters(Float dopplerFactor, Float rolloffFactor)
     
     if (m_ds3DListener)
         m_ds3DListener->SetAllParameters(&m_parameters, applyFlag);
+    if (m_mixer)
+        m_mixer->rolloff(rolloffFactor);
 
 }
 
@@ -2077,6 +2262,8 @@ Listener3D::position(Vector3 pos)
 
     if (m_ds3DListener)
         m_ds3DListener->SetPosition(pos.x, pos.y, pos.z, applyFlag);
+    if (m_mixer)
+        m_mixer->listener(pos.x, pos.y, pos.z, atan2f(m_parameters.vOrientFront.x, m_parameters.vOrientFront.z));
 }
 
 
@@ -2089,6 +2276,8 @@ Listener3D::orientation(Float dir)
 
     if (m_ds3DListener)
         m_ds3DListener->SetOrientation(sinf(dir), 0.0f, cosf(dir), 0.0f, 1.0f, 0.0f, applyFlag);
+    if (m_mixer)
+        m_mixer->listener(m_parameters.vPosition.x, m_parameters.vPosition.y, m_parameters.vPosition.z, dir);
 }
 
 
@@ -2108,6 +2297,8 @@ Listener3D::positionAndOrientation(Vector3 pos, Float dir)
         m_ds3DListener->SetOrientation(sinf(dir), 0.0f, cosf(dir), 0.0f, 1.0f, 0.0f, applyFlag);
         m_ds3DListener->CommitDeferredSettings( );
     }
+    if (m_mixer)
+        m_mixer->listener(pos.x, pos.y, pos.z, dir);
 
 }
 
@@ -0,0 +1,1249 @@
+/**
+* DXCommon library
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "DxCommon/If/UdpNetwork.h"
+
+// winsock comes with windows.h, link with Ws2_32.lib
+typedef int socklen_t;
+
+// bumped whenever the datagram layout changes
+#define UDPPROTOCOL         1
+#define UDPHEADERSIZE       12
+#define UDPPAYLOAD          (UDPDATAGRAMSIZE - UDPHEADERSIZE)
+// datagrams read in one go before the timers get a turn
+#define UDPRECEIVEBURST     256
+
+
+namespace DirectX
+{
+
+// datagram types
+enum
+{
+    udpConnect = 1,
+    udpAccept,
+    udpRefuse,
+    udpDisconnect,
+    udpKeepAlive,
+    udpReliable,
+    udpUnreliable,
+    udpAck,
+    udpEnumRequest,
+    udpEnumResponse
+};
+
+// datagram flags
+enum
+{
+    udpLast = 1                 // last fragment of a reliable message
+};
+
+// events handed to the callbacks
+enum
+{
+    eventPacket,
+    eventAddConnection,
+    eventRemoveConnection,
+    eventSessionLost
+};
+
+
+struct UdpFragment
+{
+    UByte*      datagram;
+    UShort      size;
+    Boolean     acked;
+    UShort      sends;
+    UInt        sentAt;
+};
+
+
+struct UdpPending
+{
+    UByte*      data;
+    UShort      size;
+    UByte       flags;
+    Boolean     used;
+};
+
+
+/*************************************************************************************
+ *@class UdpLink
+ *@description
+ *    One connection. Reliable datagrams are numbered and kept until acknowledged;
+ *    the ones that arrive ahead of a missing one wait in 'received' until the gap
+ *    is filled. The fragments of a message are put together in 'message'.
+ *************************************************************************************/
+struct UdpLink
+{
+    UdpLink( ) :
+        id(0),
+        slot(0),
+        nonce(0),
+        lastReceived(0),
+        lastSent(0),
+        sendNext(0),
+        sendOldest(0),
+        receiveNext(0),
+        unreliableNext(0),
+        unreliableLast(0),
+        unreliableReceived(false),
+        roundTrip(-1.0f)
+    {
+        ZeroMemory(&address, sizeof(address));
+        ZeroMemory(received, sizeof(received));
+        UdpFragment empty;
+        ZeroMemory(&empty, sizeof(empty));
+        sent.resize(UDPSENDQUEUE, empty);
+    }
+
+    ~UdpLink( )
+    {
+        for (UInt i = 0; i < sent.size( ); ++i)
+            SAFE_DELETE_ARRAY(sent[i].datagram);
+        for (UInt i = 0; i < UDPWINDOW; ++i)
+            SAFE_DELETE_ARRAY(received[i].data);
+    }
+
+    UdpFragment& fragment(UShort sequence)
+    {
+        // the size is a power of two
+        return sent[sequence & (sent.size( ) - 1)];
+    }
+
+    // makes room for 'needed' queued datagrams, keeping the ones queued
+    void grow(UInt needed)
+    {
+        UInt size = UInt(sent.size( ));
+        while (size < needed)
+            size *= 2;
+        UdpFragment empty;
+        ZeroMemory(&empty, sizeof(empty));
+        std::vector<UdpFragment> grown(size, empty);
+        for (UShort sequence = sendOldest; sequence != sendNext; ++sequence)
+        {
+            grown[sequence & (size - 1)] = fragment(sequence);
+            fragment(sequence).datagram = 0;
+        }
+        for (UInt i = 0; i < sent.size( ); ++i)
+            SAFE_DELETE_ARRAY(sent[i].datagram);
+        sent.swap(grown);
+    }
+
+    UInt                id;
+    UInt                slot;
+    sockaddr_in         address;
+    UInt                nonce;
+    UInt                lastReceived;
+    UInt                lastSent;
+
+    UShort              sendNext;
+    UShort              sendOldest;
+    std::vector<UdpFragment> sent;
+
+    UShort              receiveNext;
+    UdpPending          received[UDPWINDOW];
+    std::vector<UByte>  message;
+
+    UShort              unreliableNext;
+    UShort              unreliableLast;
+    Boolean             unreliableReceived;
+    Float               roundTrip;          // smoothed, in milliseconds
+};
+
+
+static void write16(UByte* p, UShort value)
+{
+    value = htons(value);
+    memcpy(p, &value, 2);
+}
+
+static void write32(UByte* p, UInt value)
+{
+    value = htonl(value);
+    memcpy(p, &value, 4);
+}
+
+static UShort read16(const UByte* p)
+{
+    UShort value;
+    memcpy(&value, p, 2);
+    return ntohs(value);
+}
+
+static UInt read32(const UByte* p)
+{
+    UInt value;
+    memcpy(&value, p, 4);
+    return ntohl(value);
+}
+
+static Boolean sameAddress(const sockaddr_in& a, const sockaddr_in& b)
+{
+    return (a.sin_addr.s_addr == b.sin_addr.s_addr) && (a.sin_port == b.sin_port);
+}
+
+
+
+UdpTransport::UdpTransport( ) :
+    m_socket(~UInt(0)),
+    m_port(0),
+    m_host(false),
+    m_winsock(false),
+    m_thread(0),
+    m_running(0),
+    m_ticksPerSec(1),
+    m_protocol(0),
+    m_iServer(0),
+    m_iClient(0),
+    m_serial(0),
+    m_state(idle),
+    m_nonce(0),
+    m_lastConnect(0),
+    m_enumerating(false),
+    m_enumAddress(0),
+    m_enumPort(0),
+    m_lastEnum(0),
+    m_nSessions(0),
+    m_loss(0),
+    m_random(1)
+{
+    LARGE_INTEGER ticksPerSec;
+    if (QueryPerformanceFrequency(&ticksPerSec))
+        m_ticksPerSec = ticksPerSec.QuadPart;
+    LARGE_INTEGER ticks;
+    QueryPerformanceCounter(&ticks);
+    m_random = UInt(ticks.QuadPart) | 1;
+    m_sessionName[0] = 0;
+    for (UInt i = 0; i < UDPMAXCONNECTIONS; ++i)
+        m_links[i] = 0;
+    ZeroMemory(&m_statistics, sizeof(m_statistics));
+    GUID guid;
+    ZeroMemory(&guid, sizeof(guid));
+    setGUID(guid);
+}
+
+
+UdpTransport::~UdpTransport( )
+{
+    close( );
+}
+
+
+/*************************************************************************************
+ *@class UdpTransport
+ *@method
+ *    Int open(UInt port, Boolean host)
+ *@description
+ *    Binds the socket and starts the transport thread. A host listens on 'port',
+ *    the other side passes 0 to get any free port.
+ *************************************************************************************/
+Int UdpTransport::open(UInt port, Boolean host)
+{
+    close( );
+    DXCOMMON("UdpTransport::open(%d, %d)", port, host);
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 0), &wsaData) != 0)
+    {
+        DXCOMMON("(!) UdpTransport::open : WSAStartup failed");
+        return dxFailed;
+    }
+    m_winsock = true;
+    SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == INVALID_SOCKET)
+    {
+        DXCOMMON("(!) UdpTransport::open : could not create the socket");
+        close( );
+        return dxFailed;
+    }
+    int on = 1;
+    setsockopt(s, SOL_SOCKET, SO_BROADCAST, (const char*) &on, sizeof(on));
+    // a race start sends a burst to every player at once
+    int bufferSize = 256*1024;
+    setsockopt(s, SOL_SOCKET, SO_RCVBUF, (const char*) &bufferSize, sizeof(bufferSize));
+    setsockopt(s, SOL_SOCKET, SO_SNDBUF, (const char*) &bufferSize, sizeof(bufferSize));
+
+    sockaddr_in address;
+    ZeroMemory(&address, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port        = htons(UShort(port));
+    if (bind(s, (const sockaddr*) &address, sizeof(address)) != 0)
+    {
+        DXCOMMON("(!) UdpTransport::open : could not bind to port %d", port);
+        closesocket(s);
+        close( );
+        return dxFailed;
+    }
+    socklen_t addressSize = sizeof(address);
+    getsockname(s, (sockaddr*) &address, &addressSize);
+    m_port = ntohs(address.sin_port);
+
+    u_long nonBlocking = 1;
+    ioctlsocket(s, FIONBIO, &nonBlocking);
+
+    m_socket    = UInt(s);
+    m_host      = host;
+    m_state     = idle;
+    m_running   = 1;
+    m_thread    = CreateThread(NULL, 0, threadProc, this, 0, NULL);
+    if (m_thread == 0)
+    {
+        DXCOMMON("(!) UdpTransport::open : could not create the transport thread");
+        close( );
+        return dxFailed;
+    }
+    return dxSuccess;
+}
+
+
+void UdpTransport::close( )
+{
+    if (m_thread)
+    {
+        InterlockedExchange(&m_running, 0);
+        WaitForSingleObject(m_thread, INFINITE);
+        CloseHandle(m_thread);
+        m_thread = 0;
+    }
+    if (opened( ))
+    {
+        Mutex::Guard guard(m_mutex);
+        for (UInt slot = 0; slot < UDPMAXCONNECTIONS; ++slot)
+        {
+            if (m_links[slot] == 0)
+                continue;
+            // without the thread there is nobody to resend, so say it a few times
+            if (m_host || (m_state == connected))
+            {
+                for (UInt i = 0; i < 3; ++i)
+                    control(m_links[slot], udpDisconnect, 0);
+            }
+            destroyLink(slot, false);
+        }
+        closesocket(SOCKET(m_socket));
+        m_socket = ~UInt(0);
+        m_port = 0;
+    }
+    if (m_winsock)
+        WSACleanup( );
+    m_winsock = false;
+    m_state = idle;
+    m_enumerating = false;
+    m_nSessions = 0;
+    m_events.clear( );
+    m_eventData.clear( );
+}
+
+
+/*************************************************************************************
+ *@class UdpTransport
+ *@method
+ *    Int connect(UInt address, UInt port)
+ *@description
+ *    Connects to a host, the address in network byte order, and waits until the
+ *    host accepts or refuses, or until UDPCONNECTTIMEOUT passed.
+ *************************************************************************************/
+Int UdpTransport::connect(UInt address, UInt port)
+{
+    {
+        Mutex::Guard guard(m_mutex);
+        if ((opened( ) == false) || m_host)
+            return dxFailed;
+        if (m_links[0])
+            destroyLink(0, false);
+        sockaddr_in to;
+        ZeroMemory(&to, sizeof(to));
+        to.sin_family       = AF_INET;
+        to.sin_addr.s_addr  = address;
+        to.sin_port         = htons(UShort(port));
+        UdpLink* link = createLink(0, &to);
+        m_random = m_random*1103515245 + 12345;
+        m_nonce = m_random ^ now( );
+        link->nonce = m_nonce;
+        m_enumerating = false;
+        m_state = connecting;
+        m_lastConnect = now( );
+        UByte nonce[4];
+        write32(nonce, m_nonce);
+        control(link, udpConnect, 0, nonce, 4);
+    }
+
+    UInt start = now( );
+    while ((m_state == connecting) && (now( ) - start < UDPCONNECTTIMEOUT))
+        Sleep(10);
+
+    Mutex::Guard guard(m_mutex);
+    if (m_state == connected)
+    {
+        DXCOMMON("UdpTransport::connect : connected as %d", m_links[0]->id);
+        return dxSuccess;
+    }
+    DXCOMMON("(!) UdpTransport::connect : %s", (m_state == refused) ? "refused" : "no answer");
+    if (m_links[0])
+        destroyLink(0, false);
+    m_state = idle;
+    return dxFailed;
+}
+
+
+/*************************************************************************************
+ *@class UdpTransport
+ *@method
+ *    Int send(UInt to, const void* buffer, UInt size, Boolean reliable)
+ *@description
+ *    Sends a message to a connection; the other side of a connection always sends
+ *    to UDPSERVERID. Unreliable messages that don't fit a datagram go reliable.
+ *    Messages over UDPMAXMESSAGE are refused, and a peer that sends one anyway
+ *    is disconnected.
+ *************************************************************************************/
+Int UdpTransport::send(UInt to, const void* buffer, UInt size, Boolean reliable)
+{
+    Mutex::Guard guard(m_mutex);
+    UdpLink* link = find(to);
+    if (link == 0)
+        return dxFailed;
+    if (reliable || (size > UDPPAYLOAD))
+        return queue(link, (const UByte*) buffer, size);
+
+    UByte datagram[UDPDATAGRAMSIZE];
+    write32(datagram, m_protocol);
+    write32(datagram + 4, link->id);
+    datagram[8] = udpUnreliable;
+    datagram[9] = 0;
+    write16(datagram + 10, link->unreliableNext++);
+    memcpy(datagram + UDPHEADERSIZE, buffer, size);
+    transmit(&link->address, datagram, UDPHEADERSIZE + size);
+    link->lastSent = now( );
+    return dxSuccess;
+}
+
+
+UInt UdpTransport::nConnections( )
+{
+    Mutex::Guard guard(m_mutex);
+    if (m_host == false)
+        return (m_state == connected) ? 1 : 0;
+    UInt n = 0;
+    for (UInt slot = 0; slot < UDPMAXCONNECTIONS; ++slot)
+    {
+        if (m_links[slot])
+            ++n;
+    }
+    return n;
+}
+
+
+// smoothed round trip of a connection in milliseconds, 0 while unknown
+UInt UdpTransport::roundTrip(UInt id)
+{
+    Mutex::Guard guard(m_mutex);
+    UdpLink* link = find(id);
+    if ((link == 0) || (link->roundTrip < 0.0f))
+        return 0;
+    return UInt(link->roundTrip + 0.5f);
+}
+
+
+/*************************************************************************************
+ *@class UdpTransport
+ *@method
+ *    void startEnum(UInt address, UInt port)
+ *@description
+ *    Asks the host at 'address' every UDPENUMINTERVAL for its session, or every
+ *    host on the local network when 'address' is 0, until 'stopEnum' or 'connect'.
+ *************************************************************************************/
+void UdpTransport::startEnum(UInt address, UInt port)
+{
+    Mutex::Guard guard(m_mutex);
+    m_enumerating   = true;
+    m_enumAddress   = address ? address : htonl(INADDR_BROADCAST);
+    m_enumPort      = UShort(port);
+    m_nSessions     = 0;
+    // the first request goes out on the next tick
+    m_lastEnum      = now( ) - UDPENUMINTERVAL;
+}
+
+
+void UdpTransport::stopEnum( )
+{
+    Mutex::Guard guard(m_mutex);
+    m_enumerating = false;
+}
+
+
+UInt UdpTransport::nSessions( )
+{
+    Mutex::Guard guard(m_mutex);
+    return m_nSessions;
+}
+
+
+Int UdpTransport::session(UInt i, Session& session)
+{
+    Mutex::Guard guard(m_mutex);
+    if (i >= m_nSessions)
+        return dxFailed;
+    session = m_sessions[i];
+    return dxSuccess;
+}
+
+
+void UdpTransport::setGUID(const GUID& guid)
+{
+    // FNV-1a, so other games and other versions of this protocol are ignored
+    const UByte* p = (const UByte*) &guid;
+    UInt h = 2166136261u;
+    for (UInt i = 0; i < sizeof(GUID); ++i)
+        h = (h ^ p[i])*16777619u;
+    m_protocol = (h ^ UDPPROTOCOL)*16777619u;
+}
+
+
+void UdpTransport::setSessionName(const Char* name)
+{
+    Mutex::Guard guard(m_mutex);
+    strncpy(m_sessionName, name ? name : "", MAX_PATH - 1);
+    m_sessionName[MAX_PATH - 1] = 0;
+}
+
+
+void UdpTransport::statistics(Statistics& statistics)
+{
+    Mutex::Guard guard(m_mutex);
+    statistics = m_statistics;
+}
+
+
+// address of a host name or dotted address in network byte order, 0 if unknown
+UInt UdpTransport::resolve(const Char* host)
+{
+    if ((host == 0) || (host[0] == 0))
+        return 0;
+    UInt address = inet_addr(host);
+    if (address != INADDR_NONE)
+        return address;
+    hostent* entry = gethostbyname(host);
+    if ((entry == 0) || (entry->h_addrtype != AF_INET))
+    {
+        DXCOMMON("(!) UdpTransport::resolve : unknown host %s", host);
+        return 0;
+    }
+    memcpy(&address, entry->h_addr, 4);
+    return address;
+}
+
+
+DWORD WINAPI UdpTransport::threadProc(LPVOID parameter)
+{
+    ((UdpTransport*) parameter)->run( );
+    return 0;
+}
+
+
+void UdpTransport::run( )
+{
+    UByte datagram[UDPDATAGRAMSIZE];
+    while (m_running)
+    {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(SOCKET(m_socket), &readable);
+        timeval timeout;
+        timeout.tv_sec  = 0;
+        timeout.tv_usec = UDPPOLLTIME*1000;
+        if (select(int(m_socket) + 1, &readable, 0, 0, &timeout) > 0)
+        {
+            for (UInt i = 0; i < UDPRECEIVEBURST; ++i)
+            {
+                sockaddr_in from;
+                socklen_t fromSize = sizeof(from);
+                int size = recvfrom(SOCKET(m_socket), (char*) datagram, sizeof(datagram), 0,
+                                    (sockaddr*) &from, &fromSize);
+                // nothing left, or on Windows the echo of a datagram sent to a closed port
+                if (size <= 0)
+                    break;
+                {
+                    Mutex::Guard guard(m_mutex);
+                    receive(datagram, UInt(size), &from);
+                }
+                dispatch( );
+            }
+        }
+        {
+            Mutex::Guard guard(m_mutex);
+            tick( );
+        }
+        dispatch( );
+    }
+}
+
+
+UInt UdpTransport::now( ) const
+{
+    LARGE_INTEGER ticks;
+    QueryPerformanceCounter(&ticks);
+    return UInt(ticks.QuadPart*1000/m_ticksPerSec);
+}
+
+
+void UdpTransport::receive(const UByte* datagram, UInt size, const void* from)
+{
+    if (size < UDPHEADERSIZE)
+        return;
+    ++m_statistics.datagramsReceived;
+    m_statistics.bytesReceived += size;
+    if (read32(datagram) != m_protocol)
+        return;
+    const sockaddr_in& address = *(const sockaddr_in*) from;
+    UInt connection = read32(datagram + 4);
+    UByte type = datagram[8];
+    const UByte* data = datagram + UDPHEADERSIZE;
+    UInt dataSize = size - UDPHEADERSIZE;
+
+    if (m_host)
+    {
+        if (type == udpEnumRequest)
+        {
+            UByte response[UDPDATAGRAMSIZE];
+            UInt nameSize = UInt(strlen(m_sessionName)) + 1;
+            write32(response, m_protocol);
+            write32(response + 4, 0);
+            response[8] = udpEnumResponse;
+            response[9] = 0;
+            write16(response + 10, 0);
+            memcpy(response + UDPHEADERSIZE, m_sessionName, nameSize);
+            transmit(&address, response, UDPHEADERSIZE + nameSize);
+            return;
+        }
+        if (type == udpConnect)
+        {
+            if (dataSize < 4)
+                return;
+            UInt nonce = read32(data);
+            UInt free = UDPMAXCONNECTIONS;
+            for (UInt slot = 0; slot < UDPMAXCONNECTIONS; ++slot)
+            {
+                UdpLink* link = m_links[slot];
+                if (link == 0)
+                {
+                    if (free == UDPMAXCONNECTIONS)
+                        free = slot;
+                }
+                else if (sameAddress(link->address, address) && (link->nonce == nonce))
+                {
+                    // the accept got lost
+                    control(link, udpAccept, 0, data, 4);
+                    return;
+                }
+            }
+            if (free == UDPMAXCONNECTIONS)
+            {
+                DXCOMMON("UdpTransport : refusing connection, no room");
+                UByte refuse[UDPHEADERSIZE];
+                write32(refuse, m_protocol);
+                write32(refuse + 4, 0);
+                refuse[8] = udpRefuse;
+                refuse[9] = 0;
+                write16(refuse + 10, 0);
+                transmit(&address, refuse, UDPHEADERSIZE);
+                return;
+            }
+            UdpLink* link = createLink(free, &address);
+            link->nonce = nonce;
+            // the slot in the low byte, never UDPSERVERID
+            link->id    = ((++m_serial % 0xFFFFFF + 1) << 8) | free;
+            control(link, udpAccept, 0, data, 4);
+            post(eventAddConnection, link->id);
+            return;
+        }
+        UdpLink* link = find(connection);
+        if (link && sameAddress(link->address, address))
+            receiveLink(link, datagram, size);
+        return;
+    }
+
+    if (type == udpEnumResponse)
+    {
+        if (m_enumerating == false)
+            return;
+        UInt i;
+        for (i = 0; i < m_nSessions; ++i)
+        {
+            if ((m_sessions[i].address == address.sin_addr.s_addr) && (m_sessions[i].port == ntohs(address.sin_port)))
+                break;
+        }
+        if (i == DXCOMMON_NMAXSESSIONS)
+            return;
+        UInt nameSize = (dataSize < MAX_PATH) ? dataSize : MAX_PATH - 1;
+        memcpy(m_sessions[i].name, data, nameSize);
+        m_sessions[i].name[nameSize] = 0;
+        m_sessions[i].address = address.sin_addr.s_addr;
+        m_sessions[i].port    = ntohs(address.sin_port);
+        if (i == m_nSessions)
+            ++m_nSessions;
+        return;
+    }
+    UdpLink* link = m_links[0];
+    if ((link == 0) || (sameAddress(link->address, address) == false))
+        return;
+    if (type == udpAccept)
+    {
+        if ((m_state == connecting) && (dataSize >= 4) && (read32(data) == m_nonce))
+        {
+            link->id = connection;
+            link->lastReceived = now( );
+            m_state = connected;
+        }
+        return;
+    }
+    if (type == udpRefuse)
+    {
+        if (m_state == connecting)
+            m_state = refused;
+        return;
+    }
+    if ((m_state == connected) && (connection == link->id))
+        receiveLink(link, datagram, size);
+}
+
+
+void UdpTransport::receiveLink(UdpLink* link, const UByte* datagram, UInt size)
+{
+    UByte type = datagram[8];
+    UByte flags = datagram[9];
+    UShort sequence = read16(datagram + 10);
+    const UByte* data = datagram + UDPHEADERSIZE;
+    UInt dataSize = size - UDPHEADERSIZE;
+    link->lastReceived = now( );
+
+    switch (type)
+    {
+        case udpDisconnect:
+            DXCOMMON("UdpTransport : connection %d closed by the other side", link->id);
+            destroyLink(link->slot, true);
+            break;
+
+        case udpReliable:
+            receiveReliable(link, sequence, flags, data, dataSize);
+            break;
+
+        case udpUnreliable:
+            // a newer one was handed over already
+            if (link->unreliableReceived && (Short(sequence - link->unreliableLast) <= 0))
+                break;
+            link->unreliableReceived = true;
+            link->unreliableLast = sequence;
+            post(eventPacket, m_host ? link->id : UDPSERVERID, data, dataSize);
+            break;
+
+        case udpAck:
+            if (dataSize >= 2)
+                receiveAck(link, sequence, read16(data));
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+void UdpTransport::receiveReliable(UdpLink* link, UShort sequence, UByte flags, const UByte* data, UInt size)
+{
+    UShort ahead = UShort(sequence - link->receiveNext);
+    if (ahead < UDPWINDOW)
+    {
+        UdpPending& pending = link->received[sequence % UDPWINDOW];
+        if (pending.used == false)
+        {
+            if (pending.data == 0)
+                pending.data = new UByte[UDPPAYLOAD];
+            memcpy(pending.data, data, size);
+            pending.size  = UShort(size);
+            pending.flags = flags;
+            pending.used  = true;
+        }
+        // hand over what is complete and in order
+        for (;;)
+        {
+            UdpPending& next = link->received[link->receiveNext % UDPWINDOW];
+            if (next.used == false)
+                break;
+            // send( ) never makes a message this long, so the peer is not one of ours
+            if (link->message.size( ) + next.size > UDPMAXMESSAGE)
+            {
+                DXCOMMON("(!) UdpTransport : message from %d over %d bytes, disconnecting", link->id, UDPMAXMESSAGE);
+                control(link, udpDisconnect, 0);
+                destroyLink(link->slot, true);
+                return;
+            }
+            link->message.insert(link->message.end( ), next.data, next.data + next.size);
+            next.used = false;
+            ++link->receiveNext;
+            if (next.flags & udpLast)
+            {
+                post(eventPacket, m_host ? link->id : UDPSERVERID,
+                     link->message.empty( ) ? 0 : &link->message[0], UInt(link->message.size( )));
+                link->message.clear( );
+            }
+        }
+    }
+    // past the window, the sender did not see our acks yet and will send it again
+    else if (ahead < 0x8000)
+        return;
+    // duplicates are acknowledged again, the first ack may have been lost
+    UByte next[2];
+    write16(next, link->receiveNext);
+    control(link, udpAck, sequence, next, 2);
+}
+
+
+void UdpTransport::receiveAck(UdpLink* link, UShort sequence, UShort next)
+{
+    UShort queued = UShort(link->sendNext - link->sendOldest);
+    if (UShort(sequence - link->sendOldest) < queued)
+    {
+        UdpFragment& fragment = link->fragment(sequence);
+        // only a datagram sent once tells the round trip
+        if ((fragment.acked == false) && (fragment.sends == 1))
+        {
+            Float sample = Float(now( ) - fragment.sentAt);
+            link->roundTrip = (link->roundTrip < 0.0f) ? sample : link->roundTrip*0.875f + sample*0.125f;
+        }
+        fragment.acked = true;
+    }
+    // everything before 'next' arrived as well
+    UShort upTo = UShort(next - link->sendOldest);
+    if (upTo <= queued)
+    {
+        for (UShort i = 0; i < upTo; ++i)
+            link->fragment(UShort(link->sendOldest + i)).acked = true;
+    }
+    while ((link->sendOldest != link->sendNext) && link->fragment(link->sendOldest).acked)
+        ++link->sendOldest;
+    // the window moved
+    flush(link);
+}
+
+
+void UdpTransport::tick( )
+{
+    UInt time = now( );
+    for (UInt slot = 0; slot < UDPMAXCONNECTIONS; ++slot)
+    {
+        UdpLink* link = m_links[slot];
+        if (link == 0)
+            continue;
+        if (m_host || (m_state == connected))
+        {
+            if (time - link->lastReceived > UDPTIMEOUT)
+            {
+                DXCOMMON("UdpTransport : connection %d timed out", link->id);
+                destroyLink(slot, true);
+                continue;
+            }
+            flush(link);
+            if (time - link->lastSent >= UDPKEEPALIVE)
+                control(link, udpKeepAlive, 0);
+        }
+        else if ((m_state == connecting) && (time - m_lastConnect >= UDPCONNECTRETRY))
+        {
+            UByte nonce[4];
+            write32(nonce, m_nonce);
+            control(link, udpConnect, 0, nonce, 4);
+            m_lastConnect = time;
+        }
+    }
+
+    if (m_enumerating && (time - m_lastEnum >= UDPENUMINTERVAL))
+    {
+        sockaddr_in to;
+        ZeroMemory(&to, sizeof(to));
+        to.sin_family       = AF_INET;
+        to.sin_addr.s_addr  = m_enumAddress;
+        to.sin_port         = htons(m_enumPort);
+        UByte request[UDPHEADERSIZE];
+        write32(request, m_protocol);
+        write32(request + 4, 0);
+        request[8] = udpEnumRequest;
+        request[9] = 0;
+        write16(request + 10, 0);
+        transmit(&to, request, UDPHEADERSIZE);
+        m_lastEnum = time;
+    }
+}
+
+
+// sends what is in the window and not sent yet, and resends what is overdue
+void UdpTransport::flush(UdpLink* link)
+{
+    UInt time = now( );
+    UInt resend = (link->roundTrip < 0.0f) ? 100 : UInt(link->roundTrip*2.0f) + UDPPOLLTIME;
+    if (resend < UDPMINRESEND)
+        resend = UDPMINRESEND;
+    UShort queued = UShort(link->sendNext - link->sendOldest);
+    UShort window = (queued < UDPWINDOW) ? queued : UDPWINDOW;
+    for (UShort i = 0; i < window; ++i)
+    {
+        UdpFragment& fragment = link->fragment(UShort(link->sendOldest + i));
+        if (fragment.acked)
+            continue;
+        if (fragment.sends > 0)
+        {
+            // back off while nothing comes back
+            UInt wait = resend << ((fragment.sends < 6) ? fragment.sends - 1 : 5);
+            if (wait > UDPMAXRESEND)
+                wait = UDPMAXRESEND;
+            if (time - fragment.sentAt < wait)
+                continue;
+            ++m_statistics.resends;
+        }
+        transmit(&link->address, fragment.datagram, fragment.size);
+        fragment.sentAt = time;
+        ++fragment.sends;
+        link->lastSent = time;
+    }
+}
+
+
+// splits a message in reliable datagrams, queues them and sends what the window allows
+Int UdpTransport::queue(UdpLink* link, const UByte* data, UInt size)
+{
+    UInt nFragments = (size + UDPPAYLOAD - 1)/UDPPAYLOAD;
+    if (nFragments == 0)
+        nFragments = 1;
+    UShort queued = UShort(link->sendNext - link->sendOldest);
+    if ((size > UDPMAXMESSAGE) || (queued + nFragments > UDPMAXQUEUE))
+    {
+        DXCOMMON("(!) UdpTransport::queue : no room for %d bytes to %d, %d datagrams queued", size, link->id, queued);
+        return dxFailed;
+    }
+    if (queued + nFragments > link->sent.size( ))
+        link->grow(queued + nFragments);
+    for (UInt i = 0; i < nFragments; ++i)
+    {
+        UInt offset = i*UDPPAYLOAD;
+        UInt chunk = (size - offset < UDPPAYLOAD) ? size - offset : UDPPAYLOAD;
+        UdpFragment& fragment = link->fragment(link->sendNext);
+        if (fragment.datagram == 0)
+            fragment.datagram = new UByte[UDPDATAGRAMSIZE];
+        write32(fragment.datagram, m_protocol);
+        write32(fragment.datagram + 4, link->id);
+        fragment.datagram[8] = udpReliable;
+        fragment.datagram[9] = (i == nFragments - 1) ? udpLast : 0;
+        write16(fragment.datagram + 10, link->sendNext);
+        if (chunk)
+            memcpy(fragment.datagram + UDPHEADERSIZE, data + offset, chunk);
+        fragment.size   = UShort(UDPHEADERSIZE + chunk);
+        fragment.acked  = false;
+        fragment.sends  = 0;
+        fragment.sentAt = 0;
+        ++link->sendNext;
+    }
+    flush(link);
+    return dxSuccess;
+}
+
+
+// sends a datagram that is not queued: connect, accept, ack, keep alive, disconnect
+void UdpTransport::control(UdpLink* link, UByte type, UShort sequence, const void* data, UInt size)
+{
+    UByte datagram[UDPDATAGRAMSIZE];
+    write32(datagram, m_protocol);
+    write32(datagram + 4, link->id);
+    datagram[8] = type;
+    datagram[9] = 0;
+    write16(datagram + 10, sequence);
+    if (size)
+        memcpy(datagram + UDPHEADERSIZE, data, size);
+    transmit(&link->address, datagram, UDPHEADERSIZE + size);
+    link->lastSent = now( );
+}
+
+
+void UdpTransport::transmit(const void* address, const UByte* datagram, UInt size)
+{
+    if (m_loss)
+    {
+        m_random = m_random*1103515245 + 12345;
+        if ((m_random >> 16) % 100 < m_loss)
+        {
+            ++m_statistics.dropped;
+            return;
+        }
+    }
+    sendto(SOCKET(m_socket), (const char*) datagram, size, 0, (const sockaddr*) address, sizeof(sockaddr_in));
+    ++m_statistics.datagramsSent;
+    m_statistics.bytesSent += size;
+}
+
+
+UdpLink* UdpTransport::createLink(UInt slot, const void* address)
+{
+    UdpLink* link = new UdpLink;
+    link->slot = slot;
+    link->address = *(const sockaddr_in*) address;
+    link->lastReceived = now( );
+    link->lastSent = link->lastReceived;
+    m_links[slot] = link;
+    return link;
+}
+
+
+UdpLink* UdpTransport::find(UInt id)
+{
+    if (m_host == false)
+        return (m_state == connected) ? m_links[0] : 0;
+    UInt slot = id & 0xFF;
+    if ((slot >= UDPMAXCONNECTIONS) || (m_links[slot] == 0) || (m_links[slot]->id != id))
+        return 0;
+    return m_links[slot];
+}
+
+
+void UdpTransport::destroyLink(UInt slot, Boolean notify)
+{
+    UdpLink* link = m_links[slot];
+    if (link == 0)
+        return;
+    if (notify)
+    {
+        if (m_host)
+            post(eventRemoveConnection, link->id);
+        else
+            post(eventSessionLost, UDPSERVERID);
+    }
+    if (m_host == false)
+        m_state = idle;
+    SAFE_DELETE(link);
+    m_links[slot] = 0;
+}
+
+
+void UdpTransport::post(UInt type, UInt id, const UByte* data, UInt size)
+{
+    Event event;
+    event.type   = type;
+    event.id     = id;
+    event.offset = UInt(m_eventData.size( ));
+    event.size   = size;
+    if (size)
+        m_eventData.insert(m_eventData.end( ), data, data + size);
+    m_events.push_back(event);
+}
+
+
+// runs the callbacks for what was posted, without holding the lock
+void UdpTransport::dispatch( )
+{
+    for (UInt i = 0; i < m_events.size( ); ++i)
+    {
+        const Event& event = m_events[i];
+        void* data = event.size ? &m_eventData[event.offset] : 0;
+        switch (event.type)
+        {
+            case eventPacket:
+                if (m_iServer)
+                    m_iServer->onPacket(event.id, data, event.size);
+                else if (m_iClient)
+                    m_iClient->onPacket(event.id, data, event.size);
+                break;
+
+            case eventAddConnection:
+                if (m_iServer)
+                    m_iServer->onAddConnection(event.id);
+                break;
+
+            case eventRemoveConnection:
+                if (m_iServer)
+                    m_iServer->onRemoveConnection(event.id);
+                break;
+
+            case eventSessionLost:
+                if (m_iServer)
+                    m_iServer->onSessionLost( );
+                else if (m_iClient)
+                    m_iClient->onSessionLost( );
+                break;
+        }
+    }
+    m_events.clear( );
+    m_eventData.clear( );
+}
+
+
+
+UdpServer::UdpServer( )
+{
+    DXCOMMON("(+) UdpServer");
+}
+
+
+UdpServer::~UdpServer( )
+{
+    DXCOMMON("(-) UdpServer");
+    stopSession( );
+}
+
+
+Int
+UdpServer::startSession(Char* name, UInt port)
+{
+    if (m_started)
+        stopSession( );
+
+    DXCOMMON("UdpServer::startSession(%s, %d)", name, port);
+    m_transport.setGUID(m_applicationGUID);
+    m_transport.setSessionName(name);
+    m_transport.setIServer(m_iServer);
+    if (m_transport.open(port, true) != dxSuccess)
+    {
+        DXCOMMON("(!) UdpServer::startSession : could not open port %d", port);
+        return dxFailed;
+    }
+    m_started = true;
+    return dxSuccess;
+}
+
+
+void
+UdpServer::stopSession( )
+{
+    m_transport.close( );
+    m_started = false;
+}
+
+
+// the timeout is for DirectPlay, reliable packets are resent until the connection drops
+void
+UdpServer::sendPacket(UInt to, void* buffer, UInt size, Boolean secure, UInt timeout)
+{
+    m_transport.send(to, buffer, size, secure);
+}
+
+
+
+UdpClient::UdpClient( )
+{
+    DXCOMMON("(+) UdpClient");
+}
+
+
+UdpClient::~UdpClient( )
+{
+    DXCOMMON("(-) UdpClient");
+    finalize( );
+}
+
+
+Int
+UdpClient::initialize( )
+{
+    DXCOMMON("UdpClient::initialize");
+    m_transport.setGUID(m_applicationGUID);
+    m_transport.setIClient(m_iClient);
+    if (m_transport.open(0, false) != dxSuccess)
+    {
+        DXCOMMON("(!) UdpClient::initialize : could not open a socket");
+        return dxFailed;
+    }
+    return dxSuccess;
+}
+
+
+Int
+UdpClient::finalize( )
+{
+    m_transport.close( );
+    return dxSuccess;
+}
+
+
+Int
+UdpClient::sendPacket(void* buffer, UInt size, Boolean secure, UInt timeout)
+{
+    if (m_transport.opened( ) == false)
+    {
+        DXCOMMON("(!) UdpClient::sendPacket : client not initialized");
+        return dxFailed;
+    }
+    return m_transport.send(UDPSERVERID, buffer, size, secure);
+}
+
+
+Int
+UdpClient::startSessionEnum(UInt port, const Char* ipaddress)
+{
+    DXCOMMON("UdpClient::startSessionEnum");
+    if (m_transport.opened( ) == false)
+    {
+        DXCOMMON("(!) UdpClient::startSessionEnum : client not initialized");
+        return dxFailed;
+    }
+    UInt address = 0;
+    if ((ipaddress != 0) && (ipaddress[0] != 0))
+    {
+        address = UdpTransport::resolve(ipaddress);
+        if (address == 0)
+            return dxFailed;
+    }
+    m_transport.startEnum(address, port);
+    return dxSuccess;
+}
+
+
+Int
+UdpClient::stopSessionEnum( )
+{
+    DXCOMMON("UdpClient::stopSessionEnum");
+    m_transport.stopEnum( );
+    return dxSuccess;
+}
+
+
+UInt
+UdpClient::nSessions( )
+{
+    return m_transport.nSessions( );
+}
+
+
+Int
+UdpClient::session(UInt i, SessionInfo& info)
+{
+    UdpTransport::Session session;
+    if (m_transport.session(i, session) != dxSuccess)
+        return dxFailed;
+    ZeroMemory(&info.appDesc, sizeof(info.appDesc));
+    info.hostAddress   = 0;
+    info.deviceAddress = 0;
+    strcpy(info.sessionName, session.name);
+    return dxSuccess;
+}
+
+
+Int
+UdpClient::joinSession(UInt i)
+{
+    DXCOMMON("UdpClient::joinSession %d", i);
+    UdpTransport::Session session;
+    if (m_transport.session(i, session) != dxSuccess)
+        return dxFailed;
+    return m_transport.connect(session.address, session.port);
+}
+
+
+Int
+UdpClient::joinSessionAt(UInt port, const Char* ipaddress)
+{
+    DXCOMMON("UdpClient::joinSessionAt : port = %d, address = %s", port, ipaddress);
+    UInt address = UdpTransport::resolve(ipaddress);
+    if (address == 0)
+        return dxFailed;
+    return m_transport.connect(address, port);
+}
+
+} // namespace DirectX
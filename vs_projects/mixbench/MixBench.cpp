@@ -0,0 +1,563 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// Runs and times the software mixer without a sound card, through NullOutput
+// and WaveFileOutput:
+//
+//     mixbench [-sounds <directory>] [-cars <n>[,<n>...]] [-seconds <n>]
+//              [-wave <file>] [-vorbis <directory>] [-loads <n>] [-budget <MB>]
+//
+// A race is recorded first. Every car has its engine looping at a frequency
+// that follows its speed, at a place relative to the player, and bumps,
+// crashes and horns go off now and then, over the engine and surface of the
+// player, the crowd and the wind. The recording is the list of calls made on
+// the sounds, block by block, so it plays back the same every time. The
+// sounds are the wave files of the game, loaded by a SoundManager made with a
+// Mixer, so they play through Sound the way the game would.
+//
+// For every car count the recording is mixed into a NullOutput as fast as
+// the mixer goes. Reported are the mean and the longest time a block took
+// against the time it lasts, and the number of voices the mixer keeps up
+// with in real time. Then the recording with the first car count is mixed
+// into a wave file to listen to; both outputs have to get every block.
+//
+// Last, every Ogg Vorbis file in the -vorbis directory and the ones below it
+// is loaded the way the game loads its spoken sounds, with createVorbis, as
+// many rounds as -loads says: cold, with 'pcmCache' emptied before every
+// round so each load runs the decoder, and warm, with the cache kept so each
+// load copies samples. Cold rounds may only miss the cache and warm rounds
+// only hit it. Then the same rounds run with a -budget below what the files
+// decode to, half of it by default; clips have to be evicted and the cache
+// may never hold more than the budget.
+
+#include <DxCommon/If/Sound.h>
+#include <DxCommon/If/PcmCache.h>
+#include <vector>
+#include <string>
+
+#define MAXCARSETS          8
+// every car takes CARVOICES voices at most, the player PLAYERSOUNDS more
+#define CARSOUNDS           4
+#define CARVOICES           5
+#define PLAYERSOUNDS        4
+#define MAXCARS             ((MIXERVOICES - PLAYERSOUNDS)/CARVOICES)
+// blocks between two updates of the race, about 70 ms
+#define UPDATEBLOCKS        6
+#define WAVEHEADERSIZE      44
+
+
+enum Action
+{
+    actionPlay,
+    actionLoop,
+    actionStop,
+    actionFrequency,
+    actionVolume,
+    actionPan,
+    actionPosition
+};
+
+struct Call
+{
+    UInt            block;
+    UInt            sound;
+    Action          action;
+    Int             value;
+    Float           x, y, z;
+};
+
+struct SoundFile
+{
+    std::string     name;
+    Boolean         threeD;
+    UInt            nBuffers;
+};
+
+struct Recording
+{
+    std::vector<SoundFile>  sounds;
+    std::vector<Call>       calls;              // in the order of their blocks
+    UInt                    nBlocks;
+};
+
+struct Settings
+{
+    const Char*     directory;
+    UInt            cars[MAXCARSETS];
+    UInt            nCarSets;
+    UInt            seconds;
+    const Char*     wave;
+    const Char*     vorbis;
+    UInt            loads;
+    UInt            budget;             // MB, 0 for half of what the files decode to
+};
+
+// the vehicles that come with a horn
+static const UInt _hornVehicles[] = { 1, 2, 3, 4, 5, 6, 9, 10, 12 };
+
+
+static UInt
+nextRandom(UInt& seed, UInt range)
+{
+    seed = seed*1664525 + 1013904223;
+    return (seed >> 8) % range;
+}
+
+
+static UInt
+addSound(Recording& recording, const Char* name, Boolean threeD, UInt nBuffers)
+{
+    SoundFile sound;
+    sound.name     = name;
+    sound.threeD   = threeD;
+    sound.nBuffers = nBuffers;
+    recording.sounds.push_back(sound);
+    return UInt(recording.sounds.size( ) - 1);
+}
+
+
+static void
+addCall(Recording& recording, UInt block, UInt sound, Action action, Int value = 0,
+        Float x = 0.0f, Float y = 0.0f, Float z = 0.0f)
+{
+    Call call;
+    call.block  = block;
+    call.sound  = sound;
+    call.action = action;
+    call.value  = value;
+    call.x      = x;
+    call.y      = y;
+    call.z      = z;
+    recording.calls.push_back(call);
+}
+
+
+// speeds in km/h, places in lane widths across and ten meters along the
+// road, ahead of the player is positive
+static void
+record(Recording& recording, UInt nCars, UInt nBlocks)
+{
+    recording.sounds.clear( );
+    recording.calls.clear( );
+    recording.nBlocks = nBlocks;
+
+    UInt engine  = addSound(recording, "vehicle1_e.wav", false, 1);
+    UInt surface = addSound(recording, "asphalt.wav", false, 1);
+    UInt crowd   = addSound(recording, "crowd.wav", false, 1);
+    UInt wind    = addSound(recording, "wind.wav", false, 1);
+    addCall(recording, 0, engine, actionLoop);
+    addCall(recording, 0, surface, actionLoop);
+    addCall(recording, 0, surface, actionVolume, 80);
+    addCall(recording, 0, crowd, actionLoop);
+    addCall(recording, 0, crowd, actionVolume, 70);
+    addCall(recording, 0, crowd, actionPan, -30);
+    addCall(recording, 0, wind, actionLoop);
+    addCall(recording, 0, wind, actionVolume, 60);
+
+    std::vector<UInt>  first(nCars);
+    std::vector<Float> lane(nCars);
+    std::vector<Float> gap(nCars);
+    std::vector<Float> speed(nCars);
+    std::vector<Float> topSpeed(nCars);
+    std::vector<UInt>  hornStop(nCars);
+    UInt seed = 12345;
+    for (UInt c = 0; c < nCars; ++c)
+    {
+        Char name[32];
+        _snprintf(name, sizeof(name) - 1, "vehicle%u_e.wav", c % 12 + 1);
+        name[sizeof(name) - 1] = '\0';
+        first[c] = addSound(recording, name, true, 1);
+        _snprintf(name, sizeof(name) - 1, "vehicle%u_h.wav", _hornVehicles[c % (sizeof(_hornVehicles)/sizeof(UInt))]);
+        name[sizeof(name) - 1] = '\0';
+        addSound(recording, name, true, 1);
+        addSound(recording, "bump.wav", true, 2);
+        addSound(recording, "crashshort.wav", true, 1);
+        lane[c]     = Float(Int(c % 3) - 1);
+        gap[c]      = -2.0f*(c + 1);
+        speed[c]    = 0.0f;
+        topSpeed[c] = 160.0f + nextRandom(seed, 60);
+        hornStop[c] = 0;
+        addCall(recording, 0, first[c], actionLoop);
+    }
+
+    Float playerSpeed = 0.0f;
+    Float seconds = UPDATEBLOCKS*MIXERBLOCKFRAMES/Float(MIXERFREQUENCY);
+    for (UInt block = 0; block < nBlocks; block += UPDATEBLOCKS)
+    {
+        playerSpeed = (std::min)(playerSpeed + 15.0f*seconds, 180.0f);
+        addCall(recording, block, engine, actionFrequency, Int(11025 + playerSpeed*150));
+        addCall(recording, block, surface, actionFrequency, Int(22050 + playerSpeed*100));
+        for (UInt c = 0; c < nCars; ++c)
+        {
+            speed[c] = (std::min)(speed[c] + (10.0f + nextRandom(seed, 10))*seconds, topSpeed[c]);
+            gap[c]  += (speed[c] - playerSpeed)/36.0f*seconds;
+            lane[c]  = (std::max)(-1.5f, (std::min)(1.5f, lane[c] + (Int(nextRandom(seed, 3)) - 1)*0.05f));
+            addCall(recording, block, first[c], actionFrequency, Int(11025 + speed[c]*150));
+            for (UInt s = 0; s < CARSOUNDS; ++s)
+                addCall(recording, block, first[c] + s, actionPosition, 0, lane[c], 0.0f, gap[c]);
+
+            if (nextRandom(seed, 60) == 0)
+                addCall(recording, block, first[c] + 2, actionPlay);
+            if ((hornStop[c] == 0) && (nextRandom(seed, 300) == 0))
+            {
+                addCall(recording, block, first[c] + 1, actionLoop);
+                hornStop[c] = block + 20 + nextRandom(seed, 60);
+            }
+            else if ((hornStop[c] != 0) && (block >= hornStop[c]))
+            {
+                addCall(recording, block, first[c] + 1, actionStop);
+                hornStop[c] = 0;
+            }
+            if (nextRandom(seed, 2000) == 0)
+            {
+                addCall(recording, block, first[c] + 3, actionPlay);
+                speed[c] = 0.0f;
+            }
+        }
+    }
+}
+
+
+static void
+apply(std::vector<DirectX::Sound*>& sounds, const Call& call)
+{
+    DirectX::Sound* sound = sounds[call.sound];
+    switch (call.action)
+    {
+    case actionPlay :
+        sound->play(0, false);
+        break;
+    case actionLoop :
+        sound->play(0, true);
+        break;
+    case actionStop :
+        sound->stop( );
+        break;
+    case actionFrequency :
+        sound->frequency(call.value);
+        break;
+    case actionVolume :
+        sound->volume(call.value);
+        break;
+    case actionPan :
+        sound->pan(call.value);
+        break;
+    case actionPosition :
+        sound->position(DirectX::Vector3(call.x, call.y, call.z));
+        break;
+    }
+}
+
+
+// plays the recording into the output, with the mixer statistics of the
+// blocks mixed; returns the blocks mixed or 0 if a sound didn't load
+static UInt
+play(const Settings& settings, const Recording& recording, DirectX::MixerOutput* output,
+     Float& mixTime, Float& maxMixTime, Float& blockTime, UInt& maxVoices, UInt& peakVoices)
+{
+    DirectX::Mixer mixer(output);
+    DirectX::SoundManager soundManager(&mixer);
+    DirectX::Listener3D listener(&soundManager);
+    listener.parameters(1.0f, 1.0f);
+    listener.positionAndOrientation(DirectX::Vector3(0.0f, 0.0f, 0.0f), 0.0f);
+
+    std::vector<DirectX::Sound*> sounds(recording.sounds.size( ), (DirectX::Sound*) 0);
+    Boolean loaded = true;
+    for (UInt i = 0; i < sounds.size( ); ++i)
+    {
+        const SoundFile& file = recording.sounds[i];
+        Char name[MAX_PATH];
+        _snprintf(name, sizeof(name) - 1, "%s\\%s", settings.directory, file.name.c_str( ));
+        name[sizeof(name) - 1] = '\0';
+        sounds[i] = soundManager.create(name, file.threeD, file.nBuffers);
+        if (sounds[i] == 0)
+        {
+            printf("%s: could not load\n", name);
+            loaded = false;
+            break;
+        }
+    }
+
+    UInt nBlocks = 0;
+    if (loaded)
+    {
+        mixer.resetStatistics( );
+        peakVoices = 0;
+        UInt next = 0;
+        for (; nBlocks < recording.nBlocks; ++nBlocks)
+        {
+            for (; (next < recording.calls.size( )) && (recording.calls[next].block == nBlocks); ++next)
+                apply(sounds, recording.calls[next]);
+            mixer.mix(1);
+            peakVoices = (std::max)(peakVoices, mixer.activeVoices( ));
+        }
+        mixTime    = mixer.mixTime( );
+        maxMixTime = mixer.maxMixTime( );
+        blockTime  = mixer.blockTime( );
+        maxVoices  = mixer.maxVoices( );
+    }
+    // the voices go before the mixer does
+    for (UInt i = 0; i < sounds.size( ); ++i)
+        SAFE_DELETE(sounds[i]);
+    return nBlocks;
+}
+
+
+static Boolean
+mixNull(const Settings& settings, UInt nCars, UInt nBlocks)
+{
+    Recording recording;
+    record(recording, nCars, nBlocks);
+    DirectX::NullOutput output;
+    Float mixTime, maxMixTime, blockTime;
+    UInt maxVoices, peakVoices;
+    UInt nMixed = play(settings, recording, &output, mixTime, maxMixTime, blockTime, maxVoices, peakVoices);
+    if (nMixed == 0)
+        return false;
+    Boolean passed = (output.frames( ) == UHuge(nMixed)*MIXERBLOCKFRAMES);
+    printf("%3u cars, %3u voices at most: %7.1f us a block, %8.1f us longest, of %6.1f us, "
+           "%5u voices in real time, %6.1fx real time%s\n",
+           nCars, peakVoices, mixTime, maxMixTime, blockTime, maxVoices,
+           blockTime/mixTime, passed ? "" : ", FAILED");
+    return passed;
+}
+
+
+static Boolean
+mixWave(const Settings& settings, UInt nCars, UInt nBlocks)
+{
+    Recording recording;
+    record(recording, nCars, nBlocks);
+    UInt nMixed;
+    Float mixTime, maxMixTime, blockTime;
+    UInt maxVoices, peakVoices;
+    {
+        DirectX::WaveFileOutput output(settings.wave);
+        nMixed = play(settings, recording, &output, mixTime, maxMixTime, blockTime, maxVoices, peakVoices);
+    }
+    if (nMixed == 0)
+        return false;
+
+    // 16 bit stereo
+    UInt size = 0;
+    FILE* file = fopen(settings.wave, "rb");
+    if (file != NULL)
+    {
+        fseek(file, 0, SEEK_END);
+        size = UInt(ftell(file));
+        fclose(file);
+    }
+    Boolean passed = (size == WAVEHEADERSIZE + nMixed*MIXERBLOCKFRAMES*4);
+    printf("%3u cars into %s: %u bytes, %7.1f us a block, %5u voices in real time%s\n",
+           nCars, settings.wave, size, mixTime, maxVoices, passed ? "" : ", FAILED");
+    return passed;
+}
+
+
+// loads every file once, returns the number loaded
+static UInt
+loadFiles(DirectX::SoundManager& soundManager, std::vector<std::string>& files)
+{
+    UInt nLoaded = 0;
+    for (UInt f = 0; f < files.size( ); ++f)
+    {
+        DirectX::Sound* sound = soundManager.createVorbis(&files[f][0]);
+        if (sound == 0)
+            continue;
+        ++nLoaded;
+        SAFE_DELETE(sound);
+    }
+    return nLoaded;
+}
+
+
+// every Ogg Vorbis file below the directory, subdirectories too
+static void
+findVorbis(const std::string& directory, std::vector<std::string>& files)
+{
+    WIN32_FIND_DATA findFileData;
+    HANDLE findHandle = ::FindFirstFile((directory + "\\*").c_str( ), &findFileData);
+    if (findHandle == INVALID_HANDLE_VALUE)
+        return;
+    do
+    {
+        std::string name = findFileData.cFileName;
+        if ((name == ".") || (name == ".."))
+            continue;
+        std::string path = directory + "\\" + name;
+        if (findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            findVorbis(path, files);
+        else if ((name.size( ) > 4) && (_stricmp(name.c_str( ) + name.size( ) - 4, ".ogg") == 0))
+            files.push_back(path);
+    }
+    while (::FindNextFile(findHandle, &findFileData));
+    ::FindClose(findHandle);
+}
+
+
+static Boolean
+loadVorbis(const Settings& settings)
+{
+    std::vector<std::string> files;
+    findVorbis(settings.vorbis, files);
+    if (files.empty( ))
+    {
+        printf("%s: no Ogg Vorbis files\n", settings.vorbis);
+        return false;
+    }
+
+    DirectX::NullOutput output;
+    DirectX::Mixer mixer(&output);
+    DirectX::SoundManager soundManager(&mixer);
+    // room for every file, so a warm round finds all of them
+    UInt budget = pcmCache.budget( );
+    pcmCache.budget(0xffffffff);
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    Double time[2];
+    UInt hits[2], misses[2], nLoaded[2];
+    UHuge decoded[2];
+    for (UInt warm = 0; warm < 2; ++warm)
+    {
+        pcmCache.flush( );
+        if (warm)
+            loadFiles(soundManager, files);
+        UInt firstHits      = pcmCache.hits( );
+        UInt firstMisses    = pcmCache.misses( );
+        UHuge firstDecoded  = pcmCache.bytesDecoded( );
+        nLoaded[warm] = 0;
+        ::QueryPerformanceCounter(&start);
+        for (UInt r = 0; r < settings.loads; ++r)
+        {
+            if (!warm)
+                pcmCache.flush( );
+            nLoaded[warm] += loadFiles(soundManager, files);
+        }
+        ::QueryPerformanceCounter(&stop);
+        time[warm]    = Double(stop.QuadPart - start.QuadPart)/frequency.QuadPart;
+        hits[warm]    = pcmCache.hits( ) - firstHits;
+        misses[warm]  = pcmCache.misses( ) - firstMisses;
+        decoded[warm] = pcmCache.bytesDecoded( ) - firstDecoded;
+    }
+
+    UInt nLoads = UInt(files.size( ))*settings.loads;
+    UHuge roundBytes = decoded[0]/settings.loads;
+    Boolean passed = (nLoaded[0] == nLoads) && (nLoaded[1] == nLoads) &&
+                     (hits[0] == 0) && (misses[0] == nLoads) && (hits[1] == nLoads) && (misses[1] == 0) &&
+                     (decoded[1] == 0);
+    printf("%u Ogg Vorbis files, %.1f MB decoded a round: %8.1f us a load cold, %8.1f us warm, %6.1fx, "
+           "%u hits, %u misses%s\n",
+           UInt(files.size( )), Double(roundBytes)/(1024*1024),
+           1e6*time[0]/nLoads, 1e6*time[1]/nLoads, (time[1] > 0.0) ? time[0]/time[1] : 0.0,
+           hits[0] + hits[1], misses[0] + misses[1], passed ? "" : ", FAILED");
+
+    // a budget below what the files decode to, so clips are dropped, least
+    // recently used first; what is kept never goes over it
+    UInt limit = (settings.budget > 0) ? settings.budget*1024*1024 : UInt(roundBytes/2);
+    pcmCache.flush( );
+    pcmCache.budget(limit);
+    UInt firstHits      = pcmCache.hits( );
+    UInt firstMisses    = pcmCache.misses( );
+    UInt firstEvictions = pcmCache.evictions( );
+    UInt nTrimmed = 0;
+    UInt maxBytes = 0;
+    ::QueryPerformanceCounter(&start);
+    for (UInt r = 0; r < settings.loads; ++r)
+    {
+        nTrimmed += loadFiles(soundManager, files);
+        maxBytes = (std::max)(maxBytes, pcmCache.bytes( ));
+    }
+    ::QueryPerformanceCounter(&stop);
+    Double trimmed = Double(stop.QuadPart - start.QuadPart)/frequency.QuadPart;
+    UInt evictions = pcmCache.evictions( ) - firstEvictions;
+    Boolean kept = (nTrimmed == nLoads) && (maxBytes <= limit) && ((roundBytes <= limit) || (evictions > 0));
+    printf("budget of %.1f MB: %8.1f us a load, %u hits, %u misses, %u evictions, %.1f MB kept at most%s\n",
+           Double(limit)/(1024*1024), 1e6*trimmed/nLoads, pcmCache.hits( ) - firstHits,
+           pcmCache.misses( ) - firstMisses, evictions, Double(maxBytes)/(1024*1024), kept ? "" : ", FAILED");
+    pcmCache.flush( );
+    pcmCache.budget(budget);
+    return passed && kept;
+}
+
+
+static Boolean
+parseArguments(int argc, char* argv[], Settings& settings)
+{
+    settings.directory  = "Sounds";
+    settings.cars[0]    = 4;
+    settings.cars[1]    = 8;
+    settings.cars[2]    = 16;
+    settings.cars[3]    = 32;
+    settings.nCarSets   = 4;
+    settings.seconds    = 60;
+    settings.wave       = "mixbench.wav";
+    settings.vorbis     = "Sounds";
+    settings.loads      = 3;
+    settings.budget     = 0;
+    for (Int i = 1; i < argc; ++i)
+    {
+        const Char* option = argv[i];
+        const Char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (value == NULL)
+            return false;
+        ++i;
+        if (strcmp(option, "-sounds") == 0)
+            settings.directory = value;
+        else if (strcmp(option, "-cars") == 0)
+        {
+            settings.nCarSets = 0;
+            for (const Char* p = value; *p && (settings.nCarSets < MAXCARSETS); )
+            {
+                settings.cars[settings.nCarSets++] = atoi(p);
+                while (*p && (*p != ','))
+                    ++p;
+                if (*p == ',')
+                    ++p;
+            }
+        }
+        else if (strcmp(option, "-seconds") == 0)
+            settings.seconds = atoi(value);
+        else if (strcmp(option, "-wave") == 0)
+            settings.wave = value;
+        else if (strcmp(option, "-vorbis") == 0)
+            settings.vorbis = value;
+        else if (strcmp(option, "-loads") == 0)
+            settings.loads = atoi(value);
+        else if (strcmp(option, "-budget") == 0)
+            settings.budget = atoi(value);
+        else
+            return false;
+    }
+    if ((settings.nCarSets == 0) || (settings.seconds == 0) || (settings.loads == 0))
+        return false;
+    for (UInt i = 0; i < settings.nCarSets; ++i)
+    {
+        if (settings.cars[i] > MAXCARS)
+            return false;
+    }
+    return true;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    Settings settings;
+    if (!parseArguments(argc, argv, settings))
+    {
+        printf("usage: mixbench [-sounds <directory>] [-cars <n>[,<n>...]] [-seconds <n>]\n");
+        printf("                [-wave <file>] [-vorbis <directory>] [-loads <n>] [-budget <MB>]\n");
+        return 2;
+    }
+    UInt nBlocks = settings.seconds*MIXERFREQUENCY/MIXERBLOCKFRAMES;
+    Boolean passed = true;
+    for (UInt i = 0; i < settings.nCarSets; ++i)
+        passed = mixNull(settings, settings.cars[i], nBlocks) && passed;
+    passed = mixWave(settings, settings.cars[0], nBlocks) && passed;
+    passed = loadVorbis(settings) && passed;
+    return passed ? 0 : 1;
+}
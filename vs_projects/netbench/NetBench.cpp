@@ -0,0 +1,744 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// Checks and measures the UDP transport over the loopback interface, with one
+// server and any number of clients in this process:
+//
+//     netbench [-clients <n>[,<n>...]] [-seconds <n>] [-rate <n>] [-loss <percent>]
+//              [-port <n>]
+//
+// The check has one client send reliable messages of every size while both
+// sides drop 'loss' percent of their datagrams; the server echoes them and
+// they must come back whole and in order. Then, for every client count, a
+// latency run has each client ping the server 'rate' times a second with
+// unreliable packets, the way PacketPlayerData goes during a race, and two
+// throughput runs have all clients send as fast as the transport takes them,
+// unreliable and reliable. The server echoes every packet, so the datagrams
+// it handles per second are twice the round trips reported.
+//
+// Last come the track handoffs: the server picks a built-in track, a custom
+// track the size of a built-in one and a custom track as long as a race
+// allows, and every client has to get it and report ready before the race
+// starts. Each track goes the old way, whole to every client, then offered by
+// its hash to clients with an empty track cache and then to the same clients
+// again, which have it cached by then. Reported are the bytes the server and
+// the clients sent and the time until the last client got the start.
+
+#include <DxCommon/If/UdpNetwork.h>
+#include "TrackCache.h"
+#include "TrackRegistry.h"
+#include "Game.h"
+#include <vector>
+#include <algorithm>
+
+#define MAXCLIENTSETS       8
+#define CHECKMESSAGES       400
+#define CHECKMAXSIZE        6000
+#define THROUGHPUTSIZE      40
+#define TRACKCACHEROOT      "netbench.cache"
+#define TRACKLAPS           3
+
+Tracer  _raceTracer("netbench");
+
+enum PacketType
+{
+    packetCheck,
+    packetPing,
+    packetFlood
+};
+
+struct Settings
+{
+    UInt            clients[MAXCLIENTSETS];
+    UInt            nClientSets;
+    UInt            seconds;
+    UInt            rate;
+    UInt            loss;
+    UInt            port;
+};
+
+
+static Huge
+ticks( )
+{
+    LARGE_INTEGER now;
+    ::QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+
+static Huge
+ticksPerSec( )
+{
+    LARGE_INTEGER frequency;
+    ::QueryPerformanceFrequency(&frequency);
+    return frequency.QuadPart;
+}
+
+
+/*************************************************************************************
+ *@class EchoServer
+ *@description
+ *    Sends every packet back to where it came from, over the same channel.
+ *************************************************************************************/
+class EchoServer : public DirectX::IServer
+{
+public:
+    EchoServer( ) : m_connections(0)                    {                           }
+
+public:
+    void    onPacket(UInt from, void* buffer, UInt size)
+    {
+        Boolean reliable = (((UByte*) buffer)[0] == packetCheck) || (((UByte*) buffer)[1] != 0);
+        m_server.sendPacket(from, buffer, size, reliable);
+    }
+    void    onAddConnection(UInt id)                    { ::InterlockedIncrement(&m_connections);  }
+    void    onRemoveConnection(UInt id)                 { ::InterlockedDecrement(&m_connections);  }
+    void    onSessionLost( )                            {                           }
+
+public:
+    DirectX::UdpServer  m_server;
+    volatile LONG       m_connections;
+};
+
+
+/*************************************************************************************
+ *@class BenchClient
+ *@description
+ *    Counts the echoes and keeps their round trips; checks the check messages.
+ *************************************************************************************/
+class BenchClient : public DirectX::IClient
+{
+public:
+    BenchClient( ) : m_echoes(0), m_checked(0), m_corrupt(0), m_lost(false)   {   }
+
+public:
+    void    onPacket(UInt from, void* buffer, UInt size)
+    {
+        const UByte* p = (const UByte*) buffer;
+        Mutex::Guard guard(m_mutex);
+        if (p[0] == packetCheck)
+        {
+            UInt n;
+            memcpy(&n, p + 2, 4);
+            Boolean whole = (n == m_checked) && (size == messageSize(n));
+            for (UInt i = 6; whole && (i < size); ++i)
+                whole = (p[i] == UByte(n + i));
+            if (!whole)
+                ++m_corrupt;
+            ++m_checked;
+        }
+        else if (p[0] == packetPing)
+        {
+            Huge sent;
+            memcpy(&sent, p + 2, sizeof(sent));
+            m_roundTrips.push_back(ticks( ) - sent);
+        }
+        ++m_echoes;
+    }
+    void    onSessionLost( )                            { m_lost = true;            }
+
+    static UInt messageSize(UInt n)                     { return 6 + (n*397) % (CHECKMAXSIZE - 6); }
+
+public:
+    DirectX::UdpClient  m_client;
+    Mutex               m_mutex;
+    UInt                m_echoes;
+    UInt                m_checked;
+    UInt                m_corrupt;
+    std::vector<Huge>   m_roundTrips;
+    Boolean             m_lost;
+};
+
+
+/*************************************************************************************
+ *@class TrackServer
+ *@description
+ *    The track handoff of RaceServer: offers the track by its hash and sends it
+ *    whole to the clients that ask, or, the old way, sends it whole to everyone.
+ *    Starts the race once every client reported ready.
+ *************************************************************************************/
+class TrackServer : public DirectX::IServer
+{
+public:
+    TrackServer(const Char* name, const Track::TrackData& data, Boolean offer) :
+        m_name(name), m_data(data), m_hash(TrackCache::hash(data)), m_offer(offer), m_ready(0)   {   }
+
+public:
+    // the host picked the track, everyone connected gets it
+    void    start( )
+    {
+        Mutex::Guard guard(m_mutex);
+        for (UInt i = 0; i < m_clients.size( ); ++i)
+        {
+            if (m_offer)
+                sendOffer(m_clients[i]);
+            else
+                sendTrack(m_clients[i]);
+        }
+    }
+
+    UInt    nClients( )                                 { Mutex::Guard guard(m_mutex); return UInt(m_clients.size( )); }
+
+    void    onPacket(UInt from, void* buffer, UInt size)
+    {
+        PacketBase* packet = static_cast<PacketBase*>(buffer);
+        Mutex::Guard guard(m_mutex);
+        if ((packet->command == cmdRequestTrack) && (size >= sizeof(PacketRequestTrack)) &&
+            (static_cast<PacketRequestTrack*>(packet)->trackHash == m_hash))
+            sendTrack(from);
+        else if ((packet->command == cmdPlayerState) && (++m_ready == m_clients.size( )))
+        {
+            PacketGeneral start;
+            start.version = _TopSpeedVersion;
+            start.command = cmdStartRace;
+            for (UInt i = 0; i < m_clients.size( ); ++i)
+                m_server.sendPacket(m_clients[i], &start, sizeof(PacketGeneral), true);
+        }
+    }
+    void    onAddConnection(UInt id)                    { Mutex::Guard guard(m_mutex); m_clients.push_back(id);    }
+    void    onRemoveConnection(UInt id)                 {                           }
+    void    onSessionLost( )                            {                           }
+
+private:
+    void    header(PacketLoadTrack& packet)
+    {
+        packet.version = _TopSpeedVersion;
+        packet.nrOfLaps = TRACKLAPS;
+        _snprintf(packet.trackname, sizeof(packet.trackname) - 1, "%s", m_name);
+        packet.trackname[sizeof(packet.trackname) - 1] = '\0';
+        packet.trackWeather = (UByte)m_data.weather;
+        packet.trackAmbience = (UByte)m_data.ambience;
+        packet.trackLength = (UShort)m_data.length;
+    }
+
+    void    sendOffer(UInt to)
+    {
+        PacketOfferTrack packet;
+        header(packet);
+        packet.command = cmdOfferTrack;
+        packet.trackHash = m_hash;
+        m_server.sendPacket(to, &packet, sizeof(PacketOfferTrack), true);
+    }
+
+    void    sendTrack(UInt to)
+    {
+        PacketLoadCustomTrack packet;
+        header(packet);
+        packet.command = cmdLoadCustomTrack;
+        UInt size = TrackCache::writePacket(m_data, packet);
+        m_server.sendPacket(to, &packet, size, true);
+    }
+
+public:
+    DirectX::UdpServer  m_server;
+
+private:
+    const Char*         m_name;
+    Track::TrackData    m_data;
+    UHuge               m_hash;
+    Boolean             m_offer;
+    Mutex               m_mutex;
+    std::vector<UInt>   m_clients;
+    UInt                m_ready;
+};
+
+
+/*************************************************************************************
+ *@class TrackClient
+ *@description
+ *    The track handoff of RaceClient, with a track cache of its own. Reports
+ *    ready as soon as it has the track and notes when the race starts.
+ *************************************************************************************/
+class TrackClient : public DirectX::IClient
+{
+public:
+    TrackClient(const Char* directory) : m_cache(directory), m_hash(0), m_started(0)   { m_data.definition = NULL;    }
+    virtual ~TrackClient( )                             { SAFE_DELETE_ARRAY(m_data.definition);                     }
+
+public:
+    void    onPacket(UInt from, void* buffer, UInt size)
+    {
+        PacketBase* packet = static_cast<PacketBase*>(buffer);
+        Mutex::Guard guard(m_mutex);
+        if ((packet->command == cmdOfferTrack) && (size >= sizeof(PacketOfferTrack)))
+        {
+            m_hash = static_cast<PacketOfferTrack*>(packet)->trackHash;
+            if (m_cache.find(m_hash, m_data))
+                ready( );
+            else
+            {
+                PacketRequestTrack request;
+                request.version   = _TopSpeedVersion;
+                request.command   = cmdRequestTrack;
+                request.trackHash = m_hash;
+                m_client.sendPacket(&request, sizeof(PacketRequestTrack), true);
+            }
+        }
+        else if ((packet->command == cmdLoadCustomTrack) &&
+                 (TrackCache::readPacket(static_cast<PacketLoadCustomTrack*>(packet), size, m_data)))
+        {
+            m_cache.store(TrackCache::hash(m_data), m_data);
+            ready( );
+        }
+        else if (packet->command == cmdStartRace)
+            m_started = ticks( );
+    }
+    void    onSessionLost( )                            {                           }
+
+    Huge    started( )                                  { Mutex::Guard guard(m_mutex); return m_started;    }
+    UHuge   trackHash( )                                { Mutex::Guard guard(m_mutex); return (m_data.definition != NULL) ? TrackCache::hash(m_data) : 0; }
+
+private:
+    void    ready( )
+    {
+        PacketPlayerState state;
+        state.version      = _TopSpeedVersion;
+        state.command      = cmdPlayerState;
+        state.playerId     = 0;
+        state.playerNumber = 0;
+        state.state        = awaitingStart;
+        m_client.sendPacket(&state, sizeof(PacketPlayerState), true);
+    }
+
+public:
+    DirectX::UdpClient  m_client;
+    TrackCache          m_cache;
+
+private:
+    Mutex               m_mutex;
+    Track::TrackData    m_data;
+    UHuge               m_hash;
+    Huge                m_started;
+};
+
+
+static GUID
+benchGuid( )
+{
+    GUID guid = {0x5a1d3c70, 0x2b4e, 0x4f0a, {0x9c, 0x61, 0x3e, 0x07, 0x58, 0xd2, 0x14, 0xa9}};
+    return guid;
+}
+
+
+static Boolean
+startServer(DirectX::UdpServer& server, DirectX::IServer* iServer, const Settings& settings)
+{
+    GUID guid = benchGuid( );
+    Char name[] = "netbench";
+    server.setGUID(guid);
+    server.setIServer(iServer);
+    if (server.startSession(name, settings.port) != dxSuccess)
+    {
+        fprintf(stderr, "could not host on port %u\n", settings.port);
+        return false;
+    }
+    return true;
+}
+
+
+static Boolean
+startClient(DirectX::UdpClient& client, DirectX::IClient* iClient, const Settings& settings)
+{
+    GUID guid = benchGuid( );
+    client.setGUID(guid);
+    client.setIClient(iClient);
+    return (client.initialize( ) == dxSuccess) &&
+           (client.joinSessionAt(settings.port, "127.0.0.1") == dxSuccess);
+}
+
+
+static Boolean
+check(const Settings& settings)
+{
+    EchoServer server;
+    if (!startServer(server.m_server, &server, settings))
+        return false;
+    server.m_server.transport( ).simulateLoss(settings.loss);
+
+    BenchClient client;
+    GUID guid = benchGuid( );
+    client.m_client.setGUID(guid);
+    client.m_client.setIClient(&client);
+    client.m_client.initialize( );
+    client.m_client.transport( ).simulateLoss(settings.loss);
+    client.m_client.startSessionEnum(settings.port, "127.0.0.1");
+    for (UInt i = 0; (i < 50) && (client.m_client.nSessions( ) == 0); ++i)
+        ::Sleep(100);
+    DirectX::Client::SessionInfo session;
+    if ((client.m_client.session(0, session) != dxSuccess) || (strcmp(session.sessionName, "netbench") != 0))
+    {
+        fprintf(stderr, "check: the session was not found\n");
+        return false;
+    }
+    if (client.m_client.joinSession(0) != dxSuccess)
+    {
+        fprintf(stderr, "check: could not join\n");
+        return false;
+    }
+
+    std::vector<UByte> message(CHECKMAXSIZE);
+    for (UInt n = 0; n < CHECKMESSAGES; ++n)
+    {
+        UInt size = BenchClient::messageSize(n);
+        message[0] = packetCheck;
+        message[1] = 1;
+        memcpy(&message[2], &n, 4);
+        for (UInt i = 6; i < size; ++i)
+            message[i] = UByte(n + i);
+        client.m_client.sendPacket(&message[0], size, true);
+    }
+    for (UInt i = 0; (i < 300) && (client.m_checked < CHECKMESSAGES) && !client.m_lost; ++i)
+        ::Sleep(100);
+
+    DirectX::UdpTransport::Statistics statistics;
+    client.m_client.transport( ).statistics(statistics);
+    Boolean passed = (client.m_checked == CHECKMESSAGES) && (client.m_corrupt == 0);
+    printf("check: %u of %u reliable messages back in order, %u damaged, %u%% loss, %u resends: %s\n",
+           client.m_checked, CHECKMESSAGES, client.m_corrupt, settings.loss, UInt(statistics.resends),
+           passed ? "passed" : "FAILED");
+    client.m_client.finalize( );
+    server.m_server.stopSession( );
+    return passed;
+}
+
+
+static void
+latency(const Settings& settings, UInt nClients)
+{
+    EchoServer server;
+    if (!startServer(server.m_server, &server, settings))
+        return;
+    std::vector<BenchClient*> clients;
+    for (UInt i = 0; i < nClients; ++i)
+    {
+        clients.push_back(new BenchClient);
+        if (!startClient(clients.back( )->m_client, clients.back( ), settings))
+            fprintf(stderr, "client %u could not join\n", i);
+    }
+
+    Huge frequency = ticksPerSec( );
+    Huge start = ticks( );
+    Huge interval = frequency/settings.rate;
+    Huge next = start;
+    UInt sent = 0;
+    UByte packet[THROUGHPUTSIZE];
+    memset(packet, 0, sizeof(packet));
+    packet[0] = packetPing;
+    while (ticks( ) - start < settings.seconds*frequency)
+    {
+        // the clients ping in turn, spread over the interval
+        for (UInt i = 0; i < nClients; ++i)
+        {
+            while (ticks( ) < next + interval*i/nClients)
+                ::Sleep(0);
+            Huge now = ticks( );
+            memcpy(packet + 2, &now, sizeof(now));
+            clients[i]->m_client.sendPacket(packet, THROUGHPUTSIZE, false);
+            ++sent;
+        }
+        next += interval;
+    }
+    ::Sleep(200);
+
+    std::vector<Huge> roundTrips;
+    for (UInt i = 0; i < nClients; ++i)
+    {
+        Mutex::Guard guard(clients[i]->m_mutex);
+        roundTrips.insert(roundTrips.end( ), clients[i]->m_roundTrips.begin( ), clients[i]->m_roundTrips.end( ));
+    }
+    std::sort(roundTrips.begin( ), roundTrips.end( ));
+    Double us = 1000000.0/Double(frequency);
+    UInt n = UInt(roundTrips.size( ));
+    printf("%3u clients, latency at %u Hz: %u pings, %u echoes, round trip median %.0f us, p99 %.0f us, max %.0f us\n",
+           nClients, settings.rate, sent, n,
+           n ? roundTrips[n/2]*us : 0.0, n ? roundTrips[n*99/100]*us : 0.0, n ? roundTrips[n - 1]*us : 0.0);
+
+    for (UInt i = 0; i < nClients; ++i)
+    {
+        clients[i]->m_client.finalize( );
+        SAFE_DELETE(clients[i]);
+    }
+    server.m_server.stopSession( );
+}
+
+
+static void
+throughput(const Settings& settings, UInt nClients, Boolean reliable)
+{
+    EchoServer server;
+    if (!startServer(server.m_server, &server, settings))
+        return;
+    std::vector<BenchClient*> clients;
+    for (UInt i = 0; i < nClients; ++i)
+    {
+        clients.push_back(new BenchClient);
+        if (!startClient(clients.back( )->m_client, clients.back( ), settings))
+            fprintf(stderr, "client %u could not join\n", i);
+    }
+
+    Huge frequency = ticksPerSec( );
+    Huge start = ticks( );
+    UInt sent = 0;
+    UByte packet[THROUGHPUTSIZE];
+    memset(packet, 0, sizeof(packet));
+    packet[0] = packetFlood;
+    packet[1] = reliable ? 1 : 0;
+    while (ticks( ) - start < settings.seconds*frequency)
+    {
+        for (UInt i = 0; i < nClients; ++i)
+        {
+            // a full send queue means the other side can't keep up, give it a moment
+            if (clients[i]->m_client.sendPacket(packet, THROUGHPUTSIZE, reliable) == dxSuccess)
+                ++sent;
+            else
+                ::Sleep(1);
+        }
+        // leave the transport threads some room on small machines
+        if (sent % (nClients*8) == 0)
+            ::Sleep(0);
+    }
+    Double seconds = Double(ticks( ) - start)/Double(frequency);
+    UInt echoes = 0;
+    for (UInt i = 0; i < nClients; ++i)
+    {
+        Mutex::Guard guard(clients[i]->m_mutex);
+        echoes += clients[i]->m_echoes;
+    }
+    // reliable echoes keep coming in after the senders stopped
+    ::Sleep(reliable ? 2000 : 200);
+    UInt total = 0;
+    for (UInt i = 0; i < nClients; ++i)
+    {
+        Mutex::Guard guard(clients[i]->m_mutex);
+        total += clients[i]->m_echoes;
+    }
+    printf("%3u clients, %s throughput: %u sent, %u echoed, %.0f round trips/s\n",
+           nClients, reliable ? "reliable  " : "unreliable", sent, total, echoes/seconds);
+
+    for (UInt i = 0; i < nClients; ++i)
+    {
+        clients[i]->m_client.finalize( );
+        SAFE_DELETE(clients[i]);
+    }
+    server.m_server.stopSession( );
+}
+
+
+static UHuge
+bytesSent(TrackServer& server, std::vector<TrackClient*>& clients, Boolean up)
+{
+    DirectX::UdpTransport::Statistics statistics;
+    if (!up)
+    {
+        server.m_server.transport( ).statistics(statistics);
+        return statistics.bytesSent;
+    }
+    UHuge bytes = 0;
+    for (UInt i = 0; i < clients.size( ); ++i)
+    {
+        clients[i]->m_client.transport( ).statistics(statistics);
+        bytes += statistics.bytesSent;
+    }
+    return bytes;
+}
+
+
+static Boolean
+trackHandoff(const Settings& settings, UInt nClients, const Char* name, const Track::TrackData& data,
+             Boolean offer, Boolean clearCache)
+{
+    TrackServer server(name, data, offer);
+    if (!startServer(server.m_server, &server, settings))
+        return false;
+    ::CreateDirectory(TRACKCACHEROOT, NULL);
+    std::vector<TrackClient*> clients;
+    for (UInt i = 0; i < nClients; ++i)
+    {
+        Char directory[MAX_PATH];
+        _snprintf(directory, sizeof(directory) - 1, "%s\\client%u", TRACKCACHEROOT, i);
+        directory[sizeof(directory) - 1] = '\0';
+        clients.push_back(new TrackClient(directory));
+        if (clearCache)
+            clients.back( )->m_cache.clear( );
+        if (!startClient(clients.back( )->m_client, clients.back( ), settings))
+            fprintf(stderr, "client %u could not join\n", i);
+    }
+    for (UInt i = 0; (i < 100) && (server.nClients( ) < nClients); ++i)
+        ::Sleep(50);
+    // the connections settle before the clock starts
+    ::Sleep(200);
+
+    UHuge down = bytesSent(server, clients, false);
+    UHuge up = bytesSent(server, clients, true);
+    Huge frequency = ticksPerSec( );
+    Huge start = ticks( );
+    server.start( );
+    Huge last = 0;
+    UInt nStarted = 0;
+    while ((nStarted < nClients) && (ticks( ) - start < 30*frequency))
+    {
+        ::Sleep(1);
+        nStarted = 0;
+        for (UInt i = 0; i < nClients; ++i)
+        {
+            Huge started = clients[i]->started( );
+            if (started != 0)
+            {
+                ++nStarted;
+                last = std::max(last, started);
+            }
+        }
+    }
+    down = bytesSent(server, clients, false) - down;
+    up = bytesSent(server, clients, true) - up;
+
+    UHuge hash = TrackCache::hash(data);
+    UInt nWrong = 0;
+    for (UInt i = 0; i < nClients; ++i)
+    {
+        if (clients[i]->trackHash( ) != hash)
+            ++nWrong;
+    }
+    Boolean passed = (nStarted == nClients) && (nWrong == 0);
+    printf("%3u clients, %-28s %-15s: %8llu bytes down %6llu up, started after %7.1f ms%s\n",
+           nClients, name, offer ? (clearCache ? "offer, uncached" : "offer, cached") : "whole track",
+           down, up, (nStarted == nClients) ? 1000.0*(last - start)/frequency : 0.0,
+           passed ? "" : ", FAILED");
+
+    for (UInt i = 0; i < nClients; ++i)
+    {
+        clients[i]->m_client.finalize( );
+        SAFE_DELETE(clients[i]);
+    }
+    server.m_server.stopSession( );
+    return passed;
+}
+
+
+static Boolean
+trackHandoffs(const Settings& settings, UInt nClients)
+{
+    // a built-in track, one a player made of it and the longest a race sends
+    const TrackRegistry::Entry& entry = TrackRegistry::entry(0);
+    std::vector<Track::Definition> edited(entry.definition, entry.definition + entry.length);
+    edited[0].length += 100;
+    std::vector<Track::Definition> longest(MAXMULTITRACKLENGTH);
+    for (UInt i = 0; i < MAXMULTITRACKLENGTH; ++i)
+    {
+        longest[i].type    = Track::Type((i*7) % 9);
+        longest[i].surface = Track::asphalt;
+        longest[i].noise   = Track::noNoise;
+        longest[i].length  = 1000 + 377*(i % 11);
+    }
+
+    Char editedName[64];
+    Char longestName[64];
+    _snprintf(editedName, sizeof(editedName) - 1, "%s, edited", entry.name);
+    editedName[sizeof(editedName) - 1] = '\0';
+    _snprintf(longestName, sizeof(longestName) - 1, "custom, %u segments", MAXMULTITRACKLENGTH);
+    longestName[sizeof(longestName) - 1] = '\0';
+    const Char* names[3] = { entry.name, editedName, longestName };
+    Track::TrackData tracks[3];
+    for (UInt i = 0; i < 3; ++i)
+    {
+        tracks[i].userDefined = (i > 0);
+        tracks[i].weather     = entry.weather;
+        tracks[i].ambience    = entry.ambience;
+    }
+    tracks[0].length     = entry.length;
+    tracks[0].definition = entry.definition;
+    tracks[1].length     = entry.length;
+    tracks[1].definition = &edited[0];
+    tracks[2].length     = MAXMULTITRACKLENGTH;
+    tracks[2].definition = &longest[0];
+
+    Boolean passed = true;
+    for (UInt i = 0; i < 3; ++i)
+    {
+        passed = trackHandoff(settings, nClients, names[i], tracks[i], false, false) && passed;
+        passed = trackHandoff(settings, nClients, names[i], tracks[i], true, true) && passed;
+        passed = trackHandoff(settings, nClients, names[i], tracks[i], true, false) && passed;
+    }
+    return passed;
+}
+
+
+static Boolean
+parseArguments(int argc, char* argv[], Settings& settings)
+{
+    settings.clients[0]     = 8;
+    settings.clients[1]     = 64;
+    settings.nClientSets    = 2;
+    settings.seconds        = 3;
+    settings.rate           = 60;
+    settings.loss           = 10;
+    settings.port           = 25256;
+    for (Int i = 1; i < argc; ++i)
+    {
+        const Char* option = argv[i];
+        const Char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (value == NULL)
+            return false;
+        ++i;
+        if (strcmp(option, "-clients") == 0)
+        {
+            settings.nClientSets = 0;
+            for (const Char* p = value; *p && (settings.nClientSets < MAXCLIENTSETS); )
+            {
+                settings.clients[settings.nClientSets++] = atoi(p);
+                while (*p && (*p != ','))
+                    ++p;
+                if (*p == ',')
+                    ++p;
+            }
+        }
+        else if (strcmp(option, "-seconds") == 0)
+            settings.seconds = atoi(value);
+        else if (strcmp(option, "-rate") == 0)
+            settings.rate = atoi(value);
+        else if (strcmp(option, "-loss") == 0)
+            settings.loss = atoi(value);
+        else if (strcmp(option, "-port") == 0)
+            settings.port = atoi(value);
+        else
+            return false;
+    }
+    if ((settings.nClientSets == 0) || (settings.seconds == 0) || (settings.rate == 0) || (settings.loss >= 100))
+        return false;
+    for (UInt i = 0; i < settings.nClientSets; ++i)
+    {
+        if ((settings.clients[i] == 0) || (settings.clients[i] > UDPMAXCONNECTIONS))
+            return false;
+    }
+    return true;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    Settings settings;
+    if (!parseArguments(argc, argv, settings))
+    {
+        printf("usage: netbench [-clients <n>[,<n>...]] [-seconds <n>] [-rate <n>] [-loss <percent>]\n");
+        printf("                [-port <n>]\n");
+        return 2;
+    }
+    if (!check(settings))
+        return 1;
+    for (UInt i = 0; i < settings.nClientSets; ++i)
+    {
+        latency(settings, settings.clients[i]);
+        throughput(settings, settings.clients[i], false);
+        throughput(settings, settings.clients[i], true);
+    }
+    Boolean passed = true;
+    for (UInt i = 0; i < settings.nClientSets; ++i)
+        passed = trackHandoffs(settings, settings.clients[i]) && passed;
+    return passed ? 0 : 1;
+}
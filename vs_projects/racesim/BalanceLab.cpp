@@ -0,0 +1,519 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// With -balance a built-in vehicle is tuned: a sweep such as
+//
+//     3:acceleration=8..14/2,topspeed=16000..20000
+//
+// races vehicle 3 as it is and with every combination of the values given,
+// from..to in steps (BALANCEVALUES values without one), the fields the
+// ones of a vehicle file: acceleration, deceleration, topspeed,
+// numberofgears, steering and steeringfactor. Every configuration is raced
+// -races times alone, by ComputerDriver, over -laps laps of every built-in
+// track, on all threads, each with the same seeds. Per configuration come
+// the lap times of the tracks added up (the median, 10th and 90th
+// percentile of each), the crashes per lap, the races not finished and the
+// time from standing to top speed on asphalt; the first lap, which starts
+// standing, only counts with -laps 1. The configurations no other of their
+// sweep beats on both lap time and crashes are the Pareto front, written as
+// vehicle files into the -front directory; -output gets the lap times of
+// every configuration on every track as CSV. Last, the laps simulated per
+// second and core.
+
+#include "RaceSim.h"
+#include "VehicleDefinition.h"
+#include "TrackRegistry.h"
+#include <algorithm>
+#include <string>
+
+// the configurations one sweep of -balance may make
+#define BALANCEMAXCONFIGURATIONS 4096
+// values a range without a step is swept in
+#define BALANCEVALUES   5
+// simulated seconds -balance gives a vehicle to get to its top speed
+#define BALANCETOPSPEEDTIME 120.0f
+
+
+// the fields of a vehicle -balance sweeps, by their name in a vehicle file,
+// and the values a car can be raced with
+struct BalanceField
+{
+    const Char*                     name;
+    Int Car::Parameters::*          value;
+    Int                             minimum;
+    Int                             maximum;
+};
+
+static const BalanceField balanceFields[] =
+{
+    { "acceleration",   &Car::Parameters::acceleration,   1,    100   },
+    { "deceleration",   &Car::Parameters::deceleration,   1,    200   },
+    { "topspeed",       &Car::Parameters::topspeed,       1000, 60000 },
+    { "numberofgears",  &Car::Parameters::gears,          1,    PROFILEMAXGEARS },
+    { "steering",       &Car::Parameters::steering,       1,    1000  },
+    { "steeringfactor", &Car::Parameters::steeringFactor, 0,    1000  }
+};
+#define NBALANCEFIELDS  (sizeof(balanceFields) / sizeof(balanceFields[0]))
+
+struct BalanceSweep
+{
+    UInt            vehicle;
+    Int             from[NBALANCEFIELDS];
+    Int             to[NBALANCEFIELDS];
+    Int             step[NBALANCEFIELDS];
+};
+
+struct BalanceConfiguration
+{
+    UInt            sweep;
+    UInt            vehicle;
+    UInt            number;         // within its sweep, 0 for the vehicle as it is
+    Car::Parameters parameters;
+    VehicleProfile  profile;
+    Float           topSpeedTime;   // seconds, 0 when it never gets there
+    // the tracks added up, Boolean complete when every track had a lap
+    Double          lapTime;
+    Double          lapLow;
+    Double          lapHigh;
+    Double          crashRate;
+    UInt            laps;
+    UInt            unfinished;
+    Boolean         complete;
+    Boolean         front;
+};
+
+// the races of a configuration on a track
+struct BalanceItem
+{
+    std::vector<Float> lapTimes;
+    UInt            laps;
+    UInt            crashes;
+    UInt            unfinished;
+    UHuge           steps;
+};
+
+struct BalanceBatch
+{
+    const Settings*         settings;
+    Track**                 tracks;
+    BalanceConfiguration*   configurations;
+    BalanceItem*            items;          // configuration by configuration, NBUILTINTRACKS each
+    UInt                    nItems;
+    volatile LONG           next;
+};
+
+
+// "<vehicle>:<field>=<from>[..<to>[/<step>]],..."; the fields left out keep
+// the value of the vehicle
+static Boolean
+parseSweep(const Char* text, BalanceSweep& sweep)
+{
+    Char* end;
+    Long vehicle = strtol(text, &end, 10);
+    if ((end == text) || (*end != ':') || (vehicle < 1) || (vehicle > NVEHICLES))
+    {
+        fprintf(stderr, "%s: no vehicle 1-%u\n", text, NVEHICLES);
+        return false;
+    }
+    sweep.vehicle = UInt(vehicle - 1);
+    for (UInt f = 0; f < NBALANCEFIELDS; ++f)
+    {
+        sweep.from[f] = sweep.to[f] = vehicles[sweep.vehicle].*balanceFields[f].value;
+        sweep.step[f] = 1;
+    }
+    const Char* field = end + 1;
+    while (*field != '\0')
+    {
+        const Char* equals = strchr(field, '=');
+        UInt f = 0;
+        while ((f < NBALANCEFIELDS) && ((equals == NULL) || (strlen(balanceFields[f].name) != UInt(equals - field)) ||
+                                        (strncmp(balanceFields[f].name, field, equals - field) != 0)))
+            ++f;
+        if (f == NBALANCEFIELDS)
+        {
+            fprintf(stderr, "%s: not a field of a vehicle\n", field);
+            return false;
+        }
+        const Char* value = equals + 1;
+        Long from = strtol(value, &end, 10);
+        Long to = from;
+        Long step = 0;
+        Boolean valid = (end != value);
+        if ((valid) && (strncmp(end, "..", 2) == 0))
+        {
+            value = end + 2;
+            to = strtol(value, &end, 10);
+            valid = (end != value);
+            if ((valid) && (*end == '/'))
+            {
+                value = end + 1;
+                step = strtol(value, &end, 10);
+                valid = (end != value) && (step > 0);
+            }
+        }
+        if ((!valid) || ((*end != ',') && (*end != '\0')) || (from > to) ||
+            (from < balanceFields[f].minimum) || (to > balanceFields[f].maximum))
+        {
+            fprintf(stderr, "%s: not a range of %d-%d\n", equals + 1, balanceFields[f].minimum, balanceFields[f].maximum);
+            return false;
+        }
+        if (step == 0)
+            step = (std::max)(1L, (to - from)/(BALANCEVALUES - 1));
+        sweep.from[f] = Int(from);
+        sweep.to[f]   = Int(to);
+        sweep.step[f] = Int(step);
+        field = (*end == ',') ? end + 1 : end;
+    }
+    return true;
+}
+
+
+// seconds from standing to top speed, flat out on asphalt, 0 for never
+static Float
+topSpeedTime(const CarPhysics::Parameters& parameters)
+{
+    CarPhysics physics;
+    physics.parameters(parameters);
+    physics.reset(0, 0);
+    CarPhysics::Input input;
+    input.steering = 0;
+    input.throttle = 100;
+    input.brake    = 0;
+    input.gear     = 0;
+    input.surface  = Track::asphalt;
+    for (UInt step = 1; step <= UInt(BALANCETOPSPEEDTIME*PHYSICSRATE); ++step)
+    {
+        physics.step(input);
+        physics.settle( );
+        if (physics.speed( ) >= parameters.topspeed)
+            return step*PHYSICSSTEP;
+    }
+    return 0.0f;
+}
+
+
+// a configuration alone on a track, race after race, the same seeds for
+// every configuration
+static void
+balanceRaces(const Settings& settings, Track* track, const BalanceConfiguration& configuration, BalanceItem& item)
+{
+    Settings alone = settings;
+    alone.computers = 1;
+    alone.player    = -1;
+    CarPhysics::Parameters parameters;
+    vehicleParameters(configuration.parameters, &configuration.profile, CarPhysics::computer, parameters);
+    item.lapTimes.clear( );
+    item.laps       = 0;
+    item.crashes    = 0;
+    item.unfinished = 0;
+    item.steps      = 0;
+    for (UInt number = 0; number < settings.races; ++number)
+    {
+        UInt random = settings.seed + number;
+        if (random == 0)
+            random = 1;
+        Race race;
+        RaceResult result;
+        race.nCars    = 1;
+        race.position = 0;
+        race.steps    = 0;
+        race.time     = 0.0f;
+        result.seed   = random;
+        result.cars   = 1;
+        result.time   = 0.0f;
+        ::memset(&result.car[0], 0, sizeof(result.car[0]));
+        result.car[0].vehicle = configuration.vehicle;
+        startCar(track, settings.difficulty, 0, parameters, random, race.car[0]);
+        race.random = random;
+        while (raceRunning(alone, race))
+            stepRace(alone, track, race, result);
+        endRace(race, result);
+
+        const CarResult& r = result.car[0];
+        for (UInt lap = (settings.laps > 1) ? 1 : 0; (lap < r.laps) && (lap < MAXLAPS); ++lap)
+            item.lapTimes.push_back(r.lapTime[lap]);
+        item.laps    += r.laps;
+        item.crashes += r.crashes;
+        item.steps   += race.steps;
+        if (!r.finished)
+            ++item.unfinished;
+    }
+    std::sort(item.lapTimes.begin( ), item.lapTimes.end( ));
+}
+
+
+static DWORD WINAPI
+balanceWorker(LPVOID parameter)
+{
+    BalanceBatch* batch = (BalanceBatch*)parameter;
+    for (;;)
+    {
+        LONG item = InterlockedIncrement(&batch->next) - 1;
+        if (item >= (LONG)batch->nItems)
+            break;
+        balanceRaces(*batch->settings, batch->tracks[item % NBUILTINTRACKS],
+                     batch->configurations[item / NBUILTINTRACKS], batch->items[item]);
+    }
+    return 0;
+}
+
+
+// of lap times sorted
+static Float
+percentile(const std::vector<Float>& sorted, UInt percent)
+{
+    return sorted.empty( ) ? 0.0f : sorted[(sorted.size( ) - 1)*percent/100];
+}
+
+
+// faster and crashing less, or as fast and as often but not both the same;
+// a configuration that has no lap on some track beats none
+static Boolean
+dominates(const BalanceConfiguration& a, const BalanceConfiguration& b)
+{
+    if (!a.complete)
+        return false;
+    if (!b.complete)
+        return true;
+    return (a.lapTime <= b.lapTime) && (a.crashRate <= b.crashRate) &&
+           ((a.lapTime < b.lapTime) || (a.crashRate < b.crashRate));
+}
+
+
+static void
+writeBalance(FILE* out, const Settings& settings, const BalanceConfiguration* configurations, UInt nConfigurations,
+             const BalanceItem* items)
+{
+    fprintf(out, "vehicle,configuration");
+    for (UInt f = 0; f < NBALANCEFIELDS; ++f)
+        fprintf(out, ",%s", balanceFields[f].name);
+    fprintf(out, ",track,races,laps,timed,min,p10,median,p90,max,mean,crashes,unfinished\n");
+    for (UInt c = 0; c < nConfigurations; ++c)
+    {
+        const BalanceConfiguration& configuration = configurations[c];
+        for (UInt t = 0; t < NBUILTINTRACKS; ++t)
+        {
+            const BalanceItem& item = items[c*NBUILTINTRACKS + t];
+            Double sum = 0.0;
+            for (UInt i = 0; i < item.lapTimes.size( ); ++i)
+                sum += item.lapTimes[i];
+            fprintf(out, "%u,%u", configuration.vehicle + 1, configuration.number);
+            for (UInt f = 0; f < NBALANCEFIELDS; ++f)
+                fprintf(out, ",%d", configuration.parameters.*balanceFields[f].value);
+            fprintf(out, ",%s,%u,%u,%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%u,%u\n", TrackRegistry::entry(t).name,
+                    settings.races, item.laps, UInt(item.lapTimes.size( )),
+                    item.lapTimes.empty( ) ? 0.0f : item.lapTimes.front( ), percentile(item.lapTimes, 10),
+                    percentile(item.lapTimes, 50), percentile(item.lapTimes, 90),
+                    item.lapTimes.empty( ) ? 0.0f : item.lapTimes.back( ),
+                    item.lapTimes.empty( ) ? 0.0 : sum/item.lapTimes.size( ), item.crashes, item.unfinished);
+        }
+    }
+}
+
+
+static Boolean
+writeFront(const Char* directory, const BalanceConfiguration& configuration)
+{
+    Char filename[MAX_PATH];
+    _snprintf(filename, sizeof(filename) - 1, "%s/balance%u-%u.vhc", directory, configuration.vehicle + 1,
+              configuration.number);
+    filename[sizeof(filename) - 1] = '\0';
+    std::vector<Char> text;
+    vehicleText(configuration.parameters, configuration.vehicle, text);
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL)
+        return false;
+    fwrite(&text[0], 1, text.size( ), file);
+    Boolean written = (ferror(file) == 0);
+    fclose(file);
+    return written;
+}
+
+
+// every configuration of every sweep raced on every built-in track by all
+// threads, then summed up per configuration and the Pareto front picked out
+Int
+balanceVehicles(const Settings& settings)
+{
+    std::vector<BalanceSweep> sweeps;
+    UInt nConfigurations = 0;
+    const Char* text = settings.balance;
+    while (*text != '\0')
+    {
+        const Char* end = strchr(text, ';');
+        std::string spec(text, end ? end : text + strlen(text));
+        BalanceSweep sweep;
+        if (!parseSweep(spec.c_str( ), sweep))
+            return 2;
+        UInt n = 1;
+        for (UInt f = 0; f < NBALANCEFIELDS; ++f)
+            n *= UInt((sweep.to[f] - sweep.from[f])/sweep.step[f] + 1);
+        if (n > BALANCEMAXCONFIGURATIONS)
+        {
+            fprintf(stderr, "%s: %u configurations, more than %u\n", spec.c_str( ), n, BALANCEMAXCONFIGURATIONS);
+            return 2;
+        }
+        // the vehicle as it is comes first, and once
+        nConfigurations += n + 1;
+        sweeps.push_back(sweep);
+        text = end ? end + 1 : text + strlen(text);
+    }
+
+    Track* tracks[NBUILTINTRACKS];
+    for (UInt t = 0; t < NBUILTINTRACKS; ++t)
+        tracks[t] = Track::readTrack(TrackRegistry::entry(t).name);
+
+    BalanceConfiguration* configurations = new BalanceConfiguration[nConfigurations];
+    nConfigurations = 0;
+    for (UInt s = 0; s < sweeps.size( ); ++s)
+    {
+        const BalanceSweep& sweep = sweeps[s];
+        const Car::Parameters& stock = vehicles[sweep.vehicle];
+        Int value[NBALANCEFIELDS];
+        for (UInt f = 0; f < NBALANCEFIELDS; ++f)
+            value[f] = sweep.from[f];
+        UInt number = 0;
+        for (Boolean more = true; more; )
+        {
+            Car::Parameters parameters = stock;
+            Boolean same = (number > 0);
+            for (UInt f = 0; f < NBALANCEFIELDS; ++f)
+            {
+                if (number > 0)
+                    parameters.*balanceFields[f].value = value[f];
+                same = same && (parameters.*balanceFields[f].value == stock.*balanceFields[f].value);
+            }
+            if (!same)
+            {
+                BalanceConfiguration& configuration = configurations[nConfigurations++];
+                configuration.sweep      = s;
+                configuration.vehicle    = sweep.vehicle;
+                configuration.number     = number;
+                configuration.parameters = parameters;
+                configuration.profile.build(parameters.topspeed, parameters.gears, parameters.idlefreq,
+                                            parameters.topfreq, parameters.shiftfreq);
+                CarPhysics::Parameters physics;
+                vehicleParameters(parameters, &configuration.profile, CarPhysics::computer, physics);
+                configuration.topSpeedTime = topSpeedTime(physics);
+            }
+            // the first time round is the vehicle as it is, then the values count up
+            if (number++ == 0)
+                continue;
+            more = false;
+            for (UInt f = 0; (f < NBALANCEFIELDS) && (!more); ++f)
+            {
+                value[f] += sweep.step[f];
+                if (value[f] <= sweep.to[f])
+                    more = true;
+                else
+                    value[f] = sweep.from[f];
+            }
+        }
+    }
+
+    BalanceBatch batch;
+    batch.settings       = &settings;
+    batch.tracks         = tracks;
+    batch.configurations = configurations;
+    batch.nItems         = nConfigurations*NBUILTINTRACKS;
+    batch.items          = new BalanceItem[batch.nItems];
+    batch.next           = 0;
+    UInt nThreads = (std::min)(settings.threads, batch.nItems);
+    Double seconds = runThreads(nThreads, balanceWorker, &batch);
+
+    UHuge laps = 0;
+    UHuge steps = 0;
+    for (UInt c = 0; c < nConfigurations; ++c)
+    {
+        BalanceConfiguration& configuration = configurations[c];
+        configuration.lapTime    = 0.0;
+        configuration.lapLow     = 0.0;
+        configuration.lapHigh    = 0.0;
+        configuration.laps       = 0;
+        configuration.unfinished = 0;
+        configuration.complete   = true;
+        UInt crashes = 0;
+        for (UInt t = 0; t < NBUILTINTRACKS; ++t)
+        {
+            const BalanceItem& item = batch.items[c*NBUILTINTRACKS + t];
+            configuration.lapTime    += percentile(item.lapTimes, 50);
+            configuration.lapLow     += percentile(item.lapTimes, 10);
+            configuration.lapHigh    += percentile(item.lapTimes, 90);
+            configuration.laps       += item.laps;
+            configuration.unfinished += item.unfinished;
+            configuration.complete    = configuration.complete && (!item.lapTimes.empty( ));
+            crashes += item.crashes;
+            steps   += item.steps;
+        }
+        configuration.crashRate = (configuration.laps > 0) ? Double(crashes)/configuration.laps : Double(crashes);
+        laps += configuration.laps;
+    }
+    for (UInt c = 0; c < nConfigurations; ++c)
+    {
+        configurations[c].front = true;
+        for (UInt o = 0; (o < nConfigurations) && (configurations[c].front); ++o)
+            if ((configurations[o].sweep == configurations[c].sweep) && (dominates(configurations[o], configurations[c])))
+                configurations[c].front = false;
+    }
+
+    Int exitCode = 0;
+    for (UInt c = 0; c < nConfigurations; ++c)
+    {
+        const BalanceConfiguration& configuration = configurations[c];
+        if ((c == 0) || (configuration.sweep != configurations[c - 1].sweep))
+        {
+            printf("vehicle %u, %u races of %u laps on %u tracks a configuration\n", configuration.vehicle + 1,
+                   settings.races, settings.laps, NBUILTINTRACKS);
+            printf("config   accel decel topspeed gears steer sfactor   lap time (p10-p90) s  crashes/lap  "
+                   "unfinished  top speed s\n");
+        }
+        printf("%6u%s", configuration.number, (configuration.number == 0) ? "*" : " ");
+        for (UInt f = 0; f < NBALANCEFIELDS; ++f)
+            printf(" %*d", (f == 2) ? 8 : (f == 5) ? 7 : 5, configuration.parameters.*balanceFields[f].value);
+        if (configuration.complete)
+            printf("  %8.2f (%.2f-%.2f)", configuration.lapTime, configuration.lapLow, configuration.lapHigh);
+        else
+            printf("  %8s %19s", "-", "");
+        printf("  %11.4f  %10u  %11.2f%s\n", configuration.crashRate, configuration.unfinished,
+               configuration.topSpeedTime, configuration.front ? "  front" : "");
+        if ((configuration.front) && (settings.front[0] != '\0') && (!writeFront(settings.front, configuration)))
+        {
+            fprintf(stderr, "%s: could not write vehicle %u-%u\n", settings.front, configuration.vehicle + 1,
+                    configuration.number);
+            exitCode = 1;
+        }
+    }
+
+    if (settings.output[0] != '\0')
+    {
+        FILE* out = fopen(settings.output, "w");
+        if (out == NULL)
+        {
+            fprintf(stderr, "%s: could not write\n", settings.output);
+            exitCode = 1;
+        }
+        else
+        {
+            writeBalance(out, settings, configurations, nConfigurations, batch.items);
+            fclose(out);
+        }
+    }
+
+    // more threads than processors share them
+    SYSTEM_INFO system;
+    ::GetSystemInfo(&system);
+    UInt nCores = (std::max)((std::min)(nThreads, UInt(system.dwNumberOfProcessors)), 1U);
+    Double rate = (seconds > 0.0) ? laps/seconds : 0.0;
+    printf("%llu laps, %llu physics steps, %u configurations on %u threads in %.3f s: %.1f laps/s, "
+           "%.1f laps/s per core on %u cores\n", (unsigned long long)laps, (unsigned long long)steps, nConfigurations,
+           nThreads, seconds, rate, rate/nCores, nCores);
+    SAFE_DELETE_ARRAY(batch.items);
+    SAFE_DELETE_ARRAY(configurations);
+    for (UInt t = 0; t < NBUILTINTRACKS; ++t)
+        SAFE_DELETE(tracks[t]);
+    return exitCode;
+}
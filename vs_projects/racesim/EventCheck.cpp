@@ -0,0 +1,308 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// With -events the EventScheduler is checked against a plain list of the
+// same events: up to the given number pending, many due at the same time,
+// some cancelled and some rescheduled, they have to come out in order of due
+// time and, at the same time, of scheduling, and save has to copy all of them
+// out in that order or none when they don't fit. Handles of events that fired
+// or were cancelled have to be refused, also once their slot is used again.
+// Then a race keeps 10 up to that many events pending, each one scheduled
+// again as it fires, and a frame is timed with the scheduler and the way the
+// events went before, walking an EventList every frame.
+
+#include "RaceSim.h"
+#include <algorithm>
+#include <math.h>
+
+// the pool the checks start with, so it has to grow
+#define EVENTCHECKCAPACITY  4
+// event times are multiples of this, so many come due together
+#define EVENTCHECKTICK      0.125f
+#define EVENTBENCHFRAMES    1200
+#define EVENTBENCHSPREAD    10.0f
+
+
+struct Expected
+{
+    Float                   time;
+    UInt                    sequence;
+    UInt                    tag;
+    EventScheduler::Handle  handle;
+    Boolean                 pending;
+};
+
+
+static Boolean
+dueBefore(const Expected& a, const Expected& b)
+{
+    if (a.time != b.time)
+        return a.time < b.time;
+    return a.sequence < b.sequence;
+}
+
+
+// the scheduler only carries the sound of an event, so it tells them apart here
+static DirectX::Sound*
+tag(UInt n)
+{
+    return reinterpret_cast<DirectX::Sound*>(size_t(n) + 1);
+}
+
+
+static UInt
+checkOrder(UInt nEvents)
+{
+    UInt nErrors = 0;
+    UInt random = 1;
+    EventScheduler scheduler(EVENTCHECKCAPACITY);
+    std::vector<Expected> expected(nEvents);
+    UInt sequence = 0;
+    UInt nTicks = (std::max)(nEvents/4, 1u);
+    for (UInt i = 0; i < nEvents; ++i)
+    {
+        Expected& e = expected[i];
+        e.time     = nextRandom(random, nTicks)*EVENTCHECKTICK;
+        e.sequence = sequence++;
+        e.tag      = i;
+        e.pending  = true;
+        e.handle   = scheduler.schedule(Event::playSound, e.time, tag(i));
+    }
+    if ((scheduler.pending( ) != nEvents) || (scheduler.capacity( ) < nEvents))
+    {
+        printf("%u events scheduled, %u pending in room for %u\n", nEvents, scheduler.pending( ), scheduler.capacity( ));
+        ++nErrors;
+    }
+
+    // every third cancelled, twice; every fifth of the others due again
+    for (UInt i = 0; i < nEvents; i += 3)
+    {
+        if (!scheduler.cancel(expected[i].handle))
+            ++nErrors;
+        if (scheduler.cancel(expected[i].handle) || scheduler.reschedule(expected[i].handle, 0.0f))
+            ++nErrors;
+        expected[i].pending = false;
+    }
+    for (UInt i = 1; i < nEvents; i += 5)
+    {
+        if (!expected[i].pending)
+            continue;
+        expected[i].time     = nextRandom(random, nTicks)*EVENTCHECKTICK;
+        expected[i].sequence = sequence++;
+        if (!scheduler.reschedule(expected[i].handle, expected[i].time))
+            ++nErrors;
+    }
+
+    std::vector<Expected> order;
+    for (UInt i = 0; i < nEvents; ++i)
+    {
+        if (expected[i].pending)
+            order.push_back(expected[i]);
+    }
+    std::stable_sort(order.begin( ), order.end( ), dueBefore);
+    if (scheduler.pending( ) != order.size( ))
+        ++nErrors;
+
+    // saved all in order, or none with one slot too few
+    std::vector<Event> saved(order.size( ) + 1);
+    UInt nSaved = 0;
+    if (!scheduler.save(&saved[0], UInt(order.size( )), nSaved) || (nSaved != order.size( )))
+    {
+        printf("%u events: %u of %u pending saved\n", nEvents, nSaved, UInt(order.size( )));
+        ++nErrors;
+    }
+    for (UInt i = 0; i < nSaved; ++i)
+    {
+        if ((saved[i].sound != tag(order[i].tag)) || (saved[i].time != order[i].time))
+        {
+            if (nErrors < 10)
+                printf("%u events: saved event %u at %.3f, expected event %u at %.3f\n", nEvents,
+                       i, saved[i].time, order[i].tag, order[i].time);
+            ++nErrors;
+        }
+    }
+    if (!order.empty( ) && (scheduler.save(&saved[0], UInt(order.size( )) - 1, nSaved) || (nSaved != 0)))
+    {
+        printf("%u events: saved in room for one less\n", nEvents);
+        ++nErrors;
+    }
+
+    // popped a tick at a time, nothing before it is due
+    UInt next = 0;
+    Event event;
+    for (UInt t = 0; t <= nTicks; ++t)
+    {
+        Float now = t*EVENTCHECKTICK;
+        while (scheduler.popDue(now, event))
+        {
+            if ((next >= order.size( )) || (event.sound != tag(order[next].tag)) || (event.time > now))
+            {
+                if (nErrors < 10)
+                    printf("%u events: popped %.3f at %.3f, expected event %u at %.3f\n", nEvents, event.time, now,
+                           (next < order.size( )) ? order[next].tag : 0, (next < order.size( )) ? order[next].time : 0.0f);
+                ++nErrors;
+            }
+            else if (scheduler.cancel(order[next].handle))
+                ++nErrors;
+            ++next;
+        }
+    }
+    if ((next != order.size( )) || (scheduler.pending( ) != 0))
+    {
+        printf("%u events: %u popped, %u expected, %u still pending\n", nEvents, next, UInt(order.size( )),
+               scheduler.pending( ));
+        ++nErrors;
+    }
+
+    // a slot used again does not take the old handles
+    EventScheduler::Handle first = scheduler.schedule(Event::playSound, 1.0f, tag(0));
+    scheduler.cancel(first);
+    EventScheduler::Handle second = scheduler.schedule(Event::playSound, 2.0f, tag(1));
+    if ((first == second) || scheduler.cancel(first) || scheduler.reschedule(first, 3.0f) ||
+        (scheduler.pending( ) != 1) || !scheduler.cancel(second) || (scheduler.pending( ) != 0))
+    {
+        printf("%u events: a stale handle was taken\n", nEvents);
+        ++nErrors;
+    }
+
+    // cancelSounds keeps the events without a sound, in order
+    for (UInt i = 0; i < nEvents; ++i)
+        scheduler.schedule(Event::Type(i % 2), Float(nEvents - i/2), (i % 2 == 0) ? tag(i) : 0);
+    scheduler.cancelSounds( );
+    UInt nKept = 0;
+    Float last = 0.0f;
+    while (scheduler.popDue(Float(nEvents + 1), event))
+    {
+        if ((event.sound != 0) || (event.time < last))
+            ++nErrors;
+        last = event.time;
+        ++nKept;
+    }
+    if (nKept != nEvents/2)
+        ++nErrors;
+
+    printf("%6u events: order, cancel and stale handles checked, room for %u, %u errors\n",
+           nEvents, scheduler.capacity( ), nErrors);
+    return nErrors;
+}
+
+
+// when a fired event is due again, from its time alone, so both ways below
+// fire the same events
+static Float
+dueAgain(Float now, Float time)
+{
+    Float x = time*7.77f;
+    return now + 0.05f + (x - floorf(x))*EVENTBENCHSPREAD;
+}
+
+
+// a frame of the race at 60 fps fires the events due, each due again later
+static Double
+benchScheduler(UInt nPending, UInt& nFired)
+{
+    UInt random = 7;
+    EventScheduler scheduler;
+    for (UInt i = 0; i < nPending; ++i)
+        scheduler.schedule(Event::playSound, nextRandom(random, 100000)*EVENTBENCHSPREAD/100000.0f);
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    ::QueryPerformanceCounter(&start);
+    Event event;
+    for (UInt f = 1; f <= EVENTBENCHFRAMES; ++f)
+    {
+        Float now = f/60.0f;
+        while (scheduler.popDue(now, event))
+        {
+            scheduler.schedule(event.type, dueAgain(now, event.time));
+            ++nFired;
+        }
+    }
+    ::QueryPerformanceCounter(&stop);
+    return Double(stop.QuadPart - start.QuadPart)/frequency.QuadPart;
+}
+
+
+// the same with an EventList, as Car, ComputerPlayer and Level had it
+static Double
+benchList(UInt nPending, UInt& nFired)
+{
+    UInt random = 7;
+    EventList list;
+    for (UInt i = 0; i < nPending; ++i)
+    {
+        Event* e = new Event;
+        e->type  = Event::playSound;
+        e->time  = nextRandom(random, 100000)*EVENTBENCHSPREAD/100000.0f;
+        e->sound = 0;
+        list.push(e);
+    }
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    ::QueryPerformanceCounter(&start);
+    for (UInt f = 1; f <= EVENTBENCHFRAMES; ++f)
+    {
+        Float now = f/60.0f;
+        Event* e = list.next(0);
+        while (e)
+        {
+            Event* next = list.next(e);
+            if (e->time <= now)
+            {
+                list.purge(e);
+                Event* again = new Event;
+                again->type  = e->type;
+                again->time  = dueAgain(now, e->time);
+                again->sound = 0;
+                SAFE_DELETE(e);
+                list.push(again);
+                ++nFired;
+            }
+            e = next;
+        }
+    }
+    ::QueryPerformanceCounter(&stop);
+    Event* e;
+    while ((e = list.next(0)) != 0)
+    {
+        list.purge(e);
+        SAFE_DELETE(e);
+    }
+    return Double(stop.QuadPart - start.QuadPart)/frequency.QuadPart;
+}
+
+
+Int
+checkEvents(UInt maxPending)
+{
+    UInt nErrors = 0;
+    for (UInt n = 10; ; n *= 10)
+    {
+        n = (std::min)(n, maxPending);
+        nErrors += checkOrder(n);
+        if (n == maxPending)
+            break;
+    }
+
+    printf("pending  heap us/frame  list us/frame  speedup  fired\n");
+    for (UInt n = 10; ; n *= 10)
+    {
+        n = (std::min)(n, maxPending);
+        UInt firedHeap = 0;
+        UInt firedList = 0;
+        Double heap = benchScheduler(n, firedHeap);
+        Double list = benchList(n, firedList);
+        printf("%7u  %13.2f  %13.2f  %6.1fx  %5u%s\n", n, 1e6*heap/EVENTBENCHFRAMES, 1e6*list/EVENTBENCHFRAMES,
+               (heap > 0.0) ? list/heap : 0.0, firedHeap, (firedHeap == firedList) ? "" : "  FAILED");
+        if (firedHeap != firedList)
+            ++nErrors;
+        if (n == maxPending)
+            break;
+    }
+    printf("%u errors\n", nErrors);
+    return (nErrors == 0) ? 0 : 1;
+}
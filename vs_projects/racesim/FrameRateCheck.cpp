@@ -0,0 +1,139 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// With -framerate every built-in vehicle, as the player and as a computer,
+// in floating and in fixed point, is run through the same inputs the way the
+// game runs it, a frame at a time, at 30, 60, 144 and 1000 frames a second.
+// The inputs change every whole second, which every rate ends a frame on.
+// After each second the cars have to have taken the same number of steps and
+// be in the same state to the last bit at every rate. The steps a second of
+// wall time each rate gets through are reported.
+
+#include "RaceSim.h"
+
+#define NFRAMERATES     4
+
+static const UInt _frameRates[NFRAMERATES] = { 30, 60, 144, 1000 };
+
+
+// what the driver does in every second: steering, throttle, brake, gear and
+// surface, with a manual gear only in some
+static void
+inputs(UInt vehicle, UInt seconds, std::vector<CarPhysics::Input>& script)
+{
+    UInt random = 1 + vehicle;
+    script.resize(seconds);
+    for (UInt s = 0; s < seconds; ++s)
+    {
+        CarPhysics::Input& input = script[s];
+        input.steering = nextRandom(random, 201) - 100;
+        input.throttle = (nextRandom(random, 4) == 0) ? 0 : nextRandom(random, 101);
+        input.brake    = (nextRandom(random, 3) == 0) ? nextRandom(random, 101) : 0;
+        input.gear     = (nextRandom(random, 2) == 0) ? 0 : 1 + nextRandom(random, vehicles[vehicle].gears);
+        input.surface  = Track::Surface(nextRandom(random, NSURFACES));
+    }
+}
+
+
+// the state after every second at one frame rate
+static void
+drive(const CarPhysics::Parameters& parameters, const std::vector<CarPhysics::Input>& script, UInt rate,
+      std::vector<CarPhysics::State>& states, std::vector<UInt>& steps)
+{
+    CarPhysics physics;
+    physics.parameters(parameters);
+    physics.reset(0, 0);
+    Float elapsed = 1.0f/rate;
+    states.resize(script.size( ));
+    steps.resize(script.size( ));
+    for (UInt s = 0; s < script.size( ); ++s)
+    {
+        for (UInt f = 0; f < rate; ++f)
+            physics.run(elapsed, script[s]);
+        states[s] = physics.state( );
+        steps[s]  = physics.steps( );
+    }
+}
+
+
+Int
+checkFrameRates(UInt seconds)
+{
+    static const CarPhysics::Model models[2] = { CarPhysics::player, CarPhysics::computer };
+    static const Char* modelNames[2] = { "player", "computer" };
+    static const CarPhysics::Arithmetic arithmetics[2] = { CarPhysics::floatingPoint, CarPhysics::fixedPoint };
+    static const Char* arithmeticNames[2] = { "float", "fixed" };
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    UInt nErrors = 0;
+    Double time[2][NFRAMERATES];
+    UHuge totalSteps[2][NFRAMERATES];
+    for (UInt a = 0; a < 2; ++a)
+    {
+        CarPhysics::defaultArithmetic(arithmetics[a]);
+        for (UInt r = 0; r < NFRAMERATES; ++r)
+        {
+            time[a][r] = 0.0;
+            totalSteps[a][r] = 0;
+        }
+        for (UInt v = 0; v < NVEHICLES; ++v)
+        {
+            std::vector<CarPhysics::Input> script;
+            inputs(v, seconds, script);
+            for (UInt m = 0; m < 2; ++m)
+            {
+                CarPhysics::Parameters parameters;
+                vehicleParameters(v, models[m], parameters);
+                std::vector<CarPhysics::State> reference;
+                std::vector<UInt> referenceSteps;
+                for (UInt r = 0; r < NFRAMERATES; ++r)
+                {
+                    std::vector<CarPhysics::State> states;
+                    std::vector<UInt> steps;
+                    ::QueryPerformanceCounter(&start);
+                    drive(parameters, script, _frameRates[r], states, steps);
+                    ::QueryPerformanceCounter(&stop);
+                    time[a][r] += Double(stop.QuadPart - start.QuadPart)/frequency.QuadPart;
+                    totalSteps[a][r] += steps.back( );
+                    if (r == 0)
+                    {
+                        reference = states;
+                        referenceSteps = steps;
+                        continue;
+                    }
+                    for (UInt s = 0; s < seconds; ++s)
+                    {
+                        if ((steps[s] != referenceSteps[s]) || !sameState(&states[s], &reference[s], 1))
+                        {
+                            printf("vehicle %u, %s, %s: at %u fps after %u s %u steps, speed %.9g at %.9g,\n"
+                                   "    at %u fps %u steps, speed %.9g at %.9g\n",
+                                   v + 1, modelNames[m], arithmeticNames[a], _frameRates[r], s + 1,
+                                   steps[s], states[s].speed, states[s].positionY,
+                                   _frameRates[0], referenceSteps[s], reference[s].speed, reference[s].positionY);
+                            ++nErrors;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    CarPhysics::defaultArithmetic(CarPhysics::floatingPoint);
+
+    printf("%u vehicles, player and computer, %u s at", NVEHICLES, seconds);
+    for (UInt r = 0; r < NFRAMERATES; ++r)
+        printf(" %u", _frameRates[r]);
+    printf(" fps, %u differ\n", nErrors);
+    printf("fps    float steps/s  fixed steps/s\n");
+    for (UInt r = 0; r < NFRAMERATES; ++r)
+    {
+        printf("%4u  %14.0f  %13.0f\n", _frameRates[r],
+               (time[0][r] > 0.0) ? totalSteps[0][r]/time[0][r] : 0.0,
+               (time[1][r] > 0.0) ? totalSteps[1][r]/time[1][r] : 0.0);
+    }
+    return (nErrors == 0) ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// With -ghosts the scripted player of every race is recorded into a Ghost,
+// which is written to the file, read back and played by a GhostCursor at
+// every physics step. At a sample the ghost has to be within half a rounding
+// step of where the car was, in between within GHOSTERRORY and a bound worked
+// out from how fast the vehicle steers, unless the car crashed or bumped into
+// someone around there. Then playing a
+// ghost frame by frame is timed, and the bytes a lap takes given, on the
+// longest built-in circuit.
+
+#include "RaceSim.h"
+#include "Ghost.h"
+#include "TrackRegistry.h"
+
+// how far a ghost played by -ghosts may be off the car in between samples
+// along the road and in speed, well above what the hardest braking gives;
+// sideways it is half an interval of full steering on snow
+#define GHOSTERRORY     64
+#define GHOSTERRORSPEED 500
+// frames a second the game plays a ghost at, and times -ghosts plays it
+#define GHOSTBENCHFPS   60
+#define GHOSTBENCHRUNS  200
+
+
+// a race with the player recorded into the ghost at every step until it
+// finishes; where it was at every step goes into path, and into disturbed
+// for every sample interval whether it crashed or bumped in there
+static void
+ghostRace(const Settings& settings, Track* track, UInt number, Ghost& ghost,
+          std::vector<Ghost::Sample>& path, std::vector<UByte>& disturbed)
+{
+    Race race;
+    RaceResult result;
+    startRace(settings, track, number, race, result);
+    const VehicleProfile& profile = VehicleProfile::official(result.car[0].vehicle);
+    path.clear( );
+    disturbed.clear( );
+    UInt stepsPerSample = PHYSICSRATE / GHOSTRATE;
+    while (true)
+    {
+        CarPhysics& physics = race.car[0].physics;
+        Ghost::Sample sample;
+        sample.positionX = physics.positionX( );
+        sample.positionY = physics.positionY( );
+        sample.speed     = physics.speed( );
+        sample.gear      = profile.gear(sample.speed);
+        ghost.add(race.time, sample);
+        path.push_back(sample);
+        if ((race.car[0].state == SimCar::finished) || (!raceRunning(settings, race)))
+            break;
+        UInt incidents = result.car[0].crashes + result.car[0].bumps;
+        stepRace(settings, track, race, result);
+        // a bump may leave the car faster than it goes, for the step after it
+        UInt interval = (race.steps - 1) / stepsPerSample;
+        if (disturbed.size( ) <= interval + 1)
+            disturbed.resize(interval + 2, 0);
+        if (result.car[0].crashes + result.car[0].bumps != incidents)
+        {
+            disturbed[interval] = 1;
+            disturbed[race.steps / stepsPerSample] = 1;
+        }
+    }
+    ghost.finish(Int(race.time*1000.0f));
+    endRace(race, result);
+}
+
+
+static UInt
+fileSize(const Char* filename)
+{
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL)
+        return 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return (size > 0) ? UInt(size) : 0;
+}
+
+
+// every race's ghost written, read back and played at every step; the
+// samples have to be where the car was, give or take the rounding, and the
+// steps in between close to it. Then a ghost on the longest built-in circuit
+// is played frame by frame as a benchmark
+Int
+checkGhosts(const Settings& settings, Track* track)
+{
+    Settings scripted = settings;
+    if (scripted.player < 0)
+        scripted.player = 0;
+    UInt stepsPerSample = PHYSICSRATE / GHOSTRATE;
+    const Car::Parameters& vehicle = vehicles[scripted.player];
+    Float sideways = 100.0f*1.44f*vehicle.steering*(5000.0f + vehicle.topspeed*vehicle.steeringFactor/100.0f)
+                     / vehicle.topspeed;
+    Int boundX = Int(sideways/(2*GHOSTRATE)) + GHOSTPOSITIONSTEP;
+    UInt nErrors = 0;
+    std::vector<Ghost::Sample> path;
+    std::vector<UByte> disturbed;
+    for (UInt number = 0; number < settings.races; ++number)
+    {
+        Ghost recorded;
+        recorded.record(settings.track, UInt(scripted.player), NULL, false);
+        ghostRace(scripted, track, number, recorded, path, disturbed);
+        Ghost loaded;
+        Boolean same = (recorded.write(settings.ghosts)) && (loaded.read(settings.ghosts))
+                       && (loaded.nSamples( ) == recorded.nSamples( )) && (loaded.size( ) == recorded.size( ));
+        // off by at most half a step at a sample, and by one more for the
+        // sample falling a hair after its step in float time
+        Int errorY = 0, errorX = 0, errorSpeed = 0;
+        Int sampleErrorY = 0, sampleErrorX = 0, sampleErrorSpeed = 0;
+        UInt nWrongGears = 0;
+        // the last sample is at most an interval before the finish, after it the ghost stands still
+        GhostCursor cursor(&loaded);
+        UInt nSteps = std::min(UInt(path.size( )), (loaded.nSamples( ) - 1)*stepsPerSample + 1);
+        for (UInt step = 0; (same) && (step < nSteps); ++step)
+        {
+            Ghost::Sample sample;
+            cursor.at(step*PHYSICSSTEP, sample);
+            Int dY = absval<Int>(sample.positionY - path[step].positionY);
+            Int dX = absval<Int>(sample.positionX - path[step].positionX);
+            Int dSpeed = absval<Int>(sample.speed - path[step].speed);
+            UInt interval = step/stepsPerSample;
+            Boolean calm = ((interval >= disturbed.size( )) || (!disturbed[interval]))
+                           && ((interval == 0) || (!disturbed[interval - 1]));
+            if (!calm)
+                continue;
+            if (step % stepsPerSample == 0)
+            {
+                sampleErrorY     = std::max(sampleErrorY, dY);
+                sampleErrorX     = std::max(sampleErrorX, dX);
+                sampleErrorSpeed = std::max(sampleErrorSpeed, dSpeed);
+                if (sample.gear != path[step].gear)
+                    ++nWrongGears;
+            }
+            else
+            {
+                errorY     = std::max(errorY, dY);
+                errorX     = std::max(errorX, dX);
+                errorSpeed = std::max(errorSpeed, dSpeed);
+            }
+        }
+        same = (same) && (sampleErrorY <= GHOSTPOSITIONSTEP/2 + 1) && (sampleErrorX <= GHOSTPOSITIONSTEP/2 + 1)
+               && (sampleErrorSpeed <= GHOSTSPEEDSTEP/2 + 1) && (nWrongGears == 0)
+               && (errorY <= GHOSTERRORY) && (errorX <= boundX) && (errorSpeed <= GHOSTERRORSPEED);
+        if (!same)
+            ++nErrors;
+        printf("race %u: %.3f s, %u samples in %u bytes, off by %d/%d/%d at samples and %d/%d/%d in between, %s\n",
+               number, loaded.raceTime( )/1000.0f, loaded.nSamples( ), loaded.size( ), sampleErrorY, sampleErrorX,
+               sampleErrorSpeed, errorY, errorX, errorSpeed, same ? "within bounds" : "OUT OF BOUNDS");
+    }
+
+    // the longest built-in circuit, played the way LevelTimeTrial does
+    UInt longest = 0;
+    for (UInt i = 1; i < NBUILTINCIRCUITS; ++i)
+        if (TrackRegistry::entry(i).lapDistance > TrackRegistry::entry(longest).lapDistance)
+            longest = i;
+    Settings bench = scripted;
+    _snprintf(bench.track, sizeof(bench.track) - 1, "%s", TrackRegistry::entry(longest).name);
+    Track* benchTrack = Track::readTrack(bench.track);
+    Ghost ghost;
+    ghost.record(bench.track, UInt(bench.player), NULL, false);
+    ghostRace(bench, benchTrack, 0, ghost, path, disturbed);
+    SAFE_DELETE(benchTrack);
+    if (!ghost.write(settings.ghosts))
+    {
+        fprintf(stderr, "%s: could not write\n", settings.ghosts);
+        return 1;
+    }
+    UInt nFrames = UInt(ghost.raceTime( )*GHOSTBENCHFPS/1000) + 1;
+    GhostCursor cursor(&ghost);
+    Ghost::Sample sample;
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    ::QueryPerformanceCounter(&start);
+    for (UInt run = 0; run < GHOSTBENCHRUNS; ++run)
+    {
+        for (UInt frame = 0; frame < nFrames; ++frame)
+            cursor.at(Float(frame)/GHOSTBENCHFPS, sample);
+    }
+    ::QueryPerformanceCounter(&stop);
+    Double seconds = Double(stop.QuadPart - start.QuadPart) / Double(frequency.QuadPart);
+    UInt size = fileSize(settings.ghosts);
+    printf("%s, %u laps in %.3f s: %u bytes, %.0f bytes per lap, %.1f bytes per second; "
+           "%.1f ns per frame at %u frames per second\n", bench.track, bench.laps, ghost.raceTime( )/1000.0f,
+           size, Double(size)/bench.laps, 1000.0*ghost.size( )/std::max(ghost.raceTime( ), 1),
+           1e9*seconds/(Double(nFrames)*GHOSTBENCHRUNS), GHOSTBENCHFPS);
+    printf("%u races, %u errors\n", settings.races, nErrors);
+    return (nErrors == 0) ? 0 : 1;
+}
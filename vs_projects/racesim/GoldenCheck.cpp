@@ -0,0 +1,267 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// With -golden every built-in vehicle is driven at random in both
+// arithmetics, and a lap of every built-in track raced, hashing the state of
+// the cars after every step. In fixed point the hashes have to be the ones
+// built into racesim. The file (golden.txt by default) is written by the
+// first build to run, and later builds are compared with it in both
+// arithmetics; only fixed point has to match. Both configurations of
+// RaceSim.vcxproj write Output\RaceSim.exe, so running -golden from the Debug
+// build (/Od) and then from the Release build (/O2) compares the two. Then
+// physics steps are timed both ways.
+
+#include "RaceSim.h"
+#include "TrackRegistry.h"
+
+// steps of a golden trajectory, 100 seconds a vehicle and model
+#define GOLDENSTEPS     20000
+
+
+// FNV-1a, over every bit of the state
+static UHuge
+hashBytes(UHuge hash, const void* data, UInt size)
+{
+    const UByte* bytes = (const UByte*)data;
+    for (UInt i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    return hash;
+}
+
+
+static UHuge
+hashState(UHuge hash, const CarPhysics::State& state)
+{
+    hash = hashBytes(hash, &state.positionX, sizeof(state.positionX));
+    hash = hashBytes(hash, &state.positionY, sizeof(state.positionY));
+    hash = hashBytes(hash, &state.speed, sizeof(state.speed));
+    hash = hashBytes(hash, &state.speedDiff, sizeof(state.speedDiff));
+    hash = hashBytes(hash, &state.thrust, sizeof(state.thrust));
+    return hashBytes(hash, &state.steering, sizeof(state.steering));
+}
+
+
+// what -golden has to give in fixed point, with every compiler and setting on
+// every machine; a change to the physics, the driver or the tracks that is
+// meant to change them runs -golden once and takes the new values from it
+static const UHuge goldenTrajectories[NVEHICLES] =
+{
+    0x27e4f896da81b990ULL, 0xf392cf367cbb6391ULL, 0x07b8ff33f99ec71dULL,
+    0x2a343b8bb4fc1092ULL, 0x278e0a3d5d39845dULL, 0x262f610d0afbe5ebULL,
+    0x321bd3378410da3cULL, 0x048f07207f84fe86ULL, 0xb0f9c72cdcd12444ULL,
+    0x153f5cb1bd7ea36dULL, 0x767535126bdae5b2ULL, 0xc5c93ed288fdad36ULL
+};
+
+static const UHuge goldenRaces[NBUILTINTRACKS] =
+{
+    0x76487be7242f5597ULL, 0x6c866fb0f0e46b6eULL, 0xde778dc2064c5818ULL,
+    0x1fa281196352faf6ULL, 0x6356b433e991fd9fULL, 0x2c5b722595fead74ULL,
+    0xa9b32da22282c07fULL, 0xe15bfa5f736979e2ULL, 0x331d0881c91034f3ULL,
+    0x4c6fabb7a0fb7c9aULL, 0x61403da075badd56ULL, 0x8e29ef3ebf9db7e9ULL,
+    0xd2df932a591b40c3ULL, 0x0091303aca457534ULL, 0x587be29eb2537d7aULL,
+    0x8ad649a521179b23ULL, 0x6438ca399d5260c0ULL, 0x05b773110731d548ULL,
+    0xb002b6d2d23376a7ULL, 0xbc5171e9f7212f4fULL, 0xd31ca0d3884a5e33ULL,
+    0xbdae761dee9d355eULL, 0x78638fd3fe99b230ULL, 0x08746a6c22d234beULL
+};
+
+
+// a vehicle as player, with a manual gear, and as computer, driven at random
+// over every surface and stopped now and then
+static UHuge
+goldenTrajectory(UInt vehicle)
+{
+    UHuge hash = 14695981039346656037ULL;
+    UInt random = vehicle + 1;
+    for (UInt m = 0; m < 2; ++m)
+    {
+        CarPhysics::Parameters parameters;
+        vehicleParameters(vehicle, (m == 0) ? CarPhysics::player : CarPhysics::computer, parameters);
+        CarPhysics physics;
+        physics.parameters(parameters);
+        physics.reset(0, 0);
+        for (UInt i = 0; i < GOLDENSTEPS; ++i)
+        {
+            if (nextRandom(random, 200) == 0)
+                physics.stepStopping( );
+            else
+            {
+                CarPhysics::Input input;
+                input.steering = nextRandom(random, 201) - 100;
+                input.throttle = (nextRandom(random, 4) == 0) ? 0 : nextRandom(random, 101);
+                input.brake    = (nextRandom(random, 4) == 0) ? -nextRandom(random, 101) : 0;
+                input.gear     = (m == 0) ? 1 + nextRandom(random, parameters.gears) : 0;
+                input.surface  = Track::Surface(nextRandom(random, NSURFACES));
+                physics.step(input);
+            }
+            hash = hashState(hash, physics.state( ));
+        }
+    }
+    return hash;
+}
+
+
+// a lap of a built-in track by a full field, the computers and the scripted
+// player driving, every car after every step
+static UHuge
+goldenRace(UInt track)
+{
+    Settings settings;
+    ::memset(&settings, 0, sizeof(settings));
+    _snprintf(settings.track, sizeof(settings.track) - 1, "%s", TrackRegistry::entry(track).name);
+    settings.laps       = 1;
+    settings.computers  = MAXCARS - 1;
+    settings.difficulty = 1;
+    settings.player     = 0;
+    settings.races      = 1;
+    settings.seed       = track + 1;
+    Track* definition = Track::readTrack(settings.track);
+    Race race;
+    RaceResult result;
+    startRace(settings, definition, 0, race, result);
+    UHuge hash = 14695981039346656037ULL;
+    while (raceRunning(settings, race))
+    {
+        stepRace(settings, definition, race, result);
+        for (UInt i = 0; i < race.nCars; ++i)
+            hash = hashState(hash, race.car[i].physics.state( ));
+    }
+    endRace(race, result);
+    SAFE_DELETE(definition);
+    return hash;
+}
+
+
+// the golden trajectories and races in both arithmetics: fixed point against
+// the values every build has to give, both against the file of another build
+// when there is one, else written to it. Then steps are timed both ways
+Int
+checkGolden(const Char* filename, UInt nSteps)
+{
+    UInt nErrors = 0;
+    UInt nGolden = NVEHICLES + NBUILTINTRACKS;
+    std::vector<UHuge> hashes[2];
+    for (UInt a = 0; a < 2; ++a)
+    {
+        CarPhysics::defaultArithmetic((a == 0) ? CarPhysics::fixedPoint : CarPhysics::floatingPoint);
+        for (UInt v = 0; v < NVEHICLES; ++v)
+            hashes[a].push_back(goldenTrajectory(v));
+        for (UInt t = 0; t < NBUILTINTRACKS; ++t)
+            hashes[a].push_back(goldenRace(t));
+    }
+    CarPhysics::defaultArithmetic(CarPhysics::floatingPoint);
+
+    // the file of another build, or of this one the first time
+    std::vector<UHuge> other[2];
+    FILE* file = fopen(filename, "r");
+    if (file != NULL)
+    {
+        unsigned long long fixed, floating;
+        while (fscanf(file, "%*s %llx %llx", &fixed, &floating) == 2)
+        {
+            other[0].push_back(fixed);
+            other[1].push_back(floating);
+        }
+        fclose(file);
+        if (other[0].size( ) != nGolden)
+        {
+            printf("%s: %u golden values, not %u FAILED\n", filename, UInt(other[0].size( )), nGolden);
+            other[0].clear( );
+            other[1].clear( );
+            ++nErrors;
+        }
+    }
+    else
+    {
+        file = fopen(filename, "w");
+        for (UInt i = 0; (file != NULL) && (i < nGolden); ++i)
+        {
+            if (i < NVEHICLES)
+                fprintf(file, "vehicle%u", i + 1);
+            else
+                fprintf(file, "%s", TrackRegistry::entry(i - NVEHICLES).name);
+            fprintf(file, " %016llx %016llx\n", (unsigned long long)hashes[0][i], (unsigned long long)hashes[1][i]);
+        }
+        if (file == NULL)
+        {
+            printf("%s: could not write\n", filename);
+            ++nErrors;
+        }
+        else
+        {
+            fclose(file);
+            printf("%s: written, run another build against it\n", filename);
+        }
+    }
+
+    printf("golden              fixed point                float\n");
+    UInt nFloatDiffers = 0;
+    for (UInt i = 0; i < nGolden; ++i)
+    {
+        UHuge expected = (i < NVEHICLES) ? goldenTrajectories[i] : goldenRaces[i - NVEHICLES];
+        Boolean fixedSame = (hashes[0][i] == expected) && (other[0].empty( ) || (hashes[0][i] == other[0][i]));
+        Boolean floatSame = other[1].empty( ) || (hashes[1][i] == other[1][i]);
+        Char name[32];
+        if (i < NVEHICLES)
+            _snprintf(name, sizeof(name) - 1, "vehicle %u", i + 1);
+        else
+            _snprintf(name, sizeof(name) - 1, "%s", TrackRegistry::entry(i - NVEHICLES).name);
+        name[sizeof(name) - 1] = '\0';
+        printf("%-18s  %016llx %-8s  %016llx %s\n", name, (unsigned long long)hashes[0][i], fixedSame ? "" : "FAILED",
+               (unsigned long long)hashes[1][i], floatSame ? "" : "differs");
+        if (!fixedSame)
+            ++nErrors;
+        if (!floatSame)
+            ++nFloatDiffers;
+    }
+    if (!other[1].empty( ))
+        printf("float: %u of %u differ from %s, which fixed point is for\n", nFloatDiffers, nGolden, filename);
+
+    // a field of cars on inputs prepared beforehand, the player with a manual gear
+    UInt random = 1;
+    CarPhysics::Parameters parameters[MAXCARS];
+    for (UInt i = 0; i < MAXCARS; ++i)
+        vehicleParameters(UInt(nextRandom(random, NVEHICLES)), (i == 0) ? CarPhysics::player : CarPhysics::computer,
+                          parameters[i]);
+    CarPhysics::Input inputs[256];
+    for (UInt i = 0; i < 256; ++i)
+    {
+        inputs[i].steering = nextRandom(random, 201) - 100;
+        inputs[i].throttle = nextRandom(random, 101);
+        inputs[i].brake    = (nextRandom(random, 4) == 0) ? -nextRandom(random, 101) : 0;
+        inputs[i].gear     = 1 + nextRandom(random, 5);
+        inputs[i].surface  = Track::Surface(nextRandom(random, NSURFACES));
+    }
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    Double seconds[2];
+    Double sum = 0.0;
+    for (UInt a = 0; a < 2; ++a)
+    {
+        CarPhysics::defaultArithmetic((a == 0) ? CarPhysics::floatingPoint : CarPhysics::fixedPoint);
+        CarPhysics cars[MAXCARS];
+        for (UInt i = 0; i < MAXCARS; ++i)
+        {
+            cars[i].parameters(parameters[i]);
+            cars[i].reset(0, 0);
+        }
+        ::QueryPerformanceCounter(&start);
+        for (UInt s = 0; s < nSteps; ++s)
+            for (UInt i = 0; i < MAXCARS; ++i)
+                cars[i].step(inputs[(s + 37*i) & 255]);
+        ::QueryPerformanceCounter(&stop);
+        seconds[a] = Double(stop.QuadPart - start.QuadPart) / Double(frequency.QuadPart);
+        for (UInt i = 0; i < MAXCARS; ++i)
+            sum += cars[i].state( ).positionY;
+    }
+    CarPhysics::defaultArithmetic(CarPhysics::floatingPoint);
+    Double n = Double(nSteps) * MAXCARS;
+    printf("%.0f physics steps: float %.1f ns, fixed point %.1f ns per step, %.1f M and %.1f M steps/s (%d)\n",
+           n, 1e9*seconds[0]/n, 1e9*seconds[1]/n, (seconds[0] > 0.0) ? n/seconds[0]/1e6 : 0.0,
+           (seconds[1] > 0.0) ? n/seconds[1]/1e6 : 0.0, (sum > 0.0) ? 1 : 0);
+    printf("%u golden values checked, %u errors\n", nGolden, nErrors);
+    return (nErrors == 0) ? 0 : 1;
+}
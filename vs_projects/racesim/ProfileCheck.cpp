@@ -0,0 +1,212 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// With -profiles the gear and engine pitch tables of the built-in vehicles
+// are checked against the formulas they replaced, at every speed, and the
+// engine update of a field of cars is timed both ways.
+
+#include "RaceSim.h"
+#include <math.h>
+
+// Hz a profile may be off the formulas it replaced
+#define PROFILETOLERANCE 2
+
+
+// the engine pitch Car::updateEngineFreq gave an automatic transmission before
+// the profiles, with the gear and whether it had just shifted
+static Int
+referenceFrequency(const Car::Parameters& vehicle, Int speed, Int& gear, Boolean& shifted)
+{
+    Int gearRange = vehicle.topspeed / (vehicle.gears + 1);
+    gear    = 0;
+    shifted = false;
+    if ((speed / gearRange) < 2)
+        return Int((Float(speed) / (2.0f * Float(gearRange))) * (vehicle.topfreq - vehicle.idlefreq)) + vehicle.idlefreq;
+    gear = speed / gearRange;
+    if (gear > vehicle.gears)
+        gear = vehicle.gears;
+    Float gearSpeed = (Float(speed) - Float(gear) * Float(gearRange)) / Float(gearRange);
+    if (gearSpeed < 0.07f)
+    {
+        shifted = true;
+        return Int(((0.07f - gearSpeed) / 0.07f) * Float(vehicle.topfreq - vehicle.shiftfreq) + vehicle.shiftfreq);
+    }
+    return Int(gearSpeed * (vehicle.topfreq - vehicle.shiftfreq) + vehicle.shiftfreq);
+}
+
+
+// the copy ComputerPlayer and NetworkPlayer had, which lets the gear run past the top one
+static Int
+referenceFrequencyComputer(const Car::Parameters& vehicle, Int speed, Int& gear, Boolean& shifted)
+{
+    Int gearRange = vehicle.topspeed/(vehicle.gears+1);
+    gear    = 0;
+    shifted = false;
+    if ((speed / gearRange) < 2)
+        return Int((speed / (2.0f*gearRange))*(vehicle.topfreq - vehicle.idlefreq)) + vehicle.idlefreq;
+    gear = speed / gearRange;
+    Float gearSpeed = (speed - gear*gearRange)/(1.0f*gearRange);
+    if (gearSpeed < 0.07f)
+    {
+        shifted = true;
+        return Int(((0.07f - gearSpeed)/0.07f)*(vehicle.topfreq - vehicle.shiftfreq) + vehicle.shiftfreq);
+    }
+    return Int(gearSpeed*(vehicle.topfreq - vehicle.shiftfreq) + vehicle.shiftfreq);
+}
+
+
+// Car::updateEngineFreqManual before the profiles
+static Int
+referenceFrequencyManual(const Car::Parameters& vehicle, Int gear, Int speed)
+{
+    Int gearRange = vehicle.topspeed / vehicle.gears;
+    Int frequency;
+    if (gear == 1)
+    {
+        if (speed < Int((4.0f / 3.0f) * Float(gearRange)))
+            frequency = vehicle.idlefreq + Int((Float(speed) * 3.0f / Float(2 * gearRange)) * Float(vehicle.topfreq - vehicle.idlefreq));
+        else
+            frequency = vehicle.idlefreq + 2 * (vehicle.topfreq - vehicle.idlefreq);
+    }
+    else
+    {
+        Float shiftPoint = ((2.0f / 3.0f) + Float(gear-1)) * Float(gearRange);
+        frequency = Int((Float(speed) / shiftPoint) * Float(vehicle.topfreq));
+        if (frequency > 2 * vehicle.topfreq)
+            frequency = 2 * vehicle.topfreq;
+        if (frequency < vehicle.idlefreq / 2)
+            frequency = vehicle.idlefreq / 2;
+    }
+    return frequency;
+}
+
+
+// CarPhysics::gearFactor before the profiles
+static Int
+referenceGearFactor(const Car::Parameters& vehicle, Int gear, Float speed)
+{
+    Float gearSpeed = Float(vehicle.topspeed/vehicle.gears);
+    Float gearCenter = gearSpeed*(Float(gear) - 0.82f);
+    Float relSpeedDiff = (speed - gearCenter)/gearSpeed;
+    if (absval<Float>(relSpeedDiff) >= 1.9f)
+        relSpeedDiff = 1.9f;
+    Int acceleration = Int(100.0f*(0.5f + cosf(relSpeedDiff*DirectX::Pi*0.5f)));
+    if (acceleration < 5)
+        return 5;
+    return acceleration;
+}
+
+
+// every speed of every built-in vehicle against the formulas the profiles
+// replaced, then the cost of updating the engine pitch of a field of cars
+Int
+checkProfiles(UInt updates)
+{
+    UInt nErrors = 0;
+    printf("vehicle  auto Hz  manual Hz  pull %%  computer Hz  clamped Hz  gear/shift\n");
+    for (UInt v = 0; v < NVEHICLES; ++v)
+    {
+        const Car::Parameters& vehicle = vehicles[v];
+        const VehicleProfile& profile = VehicleProfile::official(v);
+        Int autoError = 0;
+        Int manualError = 0;
+        Int factorError = 0;
+        Int computerError = 0;
+        Int clampChange = 0;
+        UInt nMismatches = 0;
+        // a little past the top speed, where only the network puts a car
+        for (Int speed = 0; speed <= vehicle.topspeed + 1000; ++speed)
+        {
+            Int gear;
+            Boolean shifted;
+            Int reference = referenceFrequency(vehicle, speed, gear, shifted);
+            Boolean profileShifted;
+            autoError = (std::max)(autoError, absval<Int>(profile.frequency(speed, profileShifted) - reference));
+            if ((profile.gear(speed) != gear) || (profileShifted != shifted))
+                ++nMismatches;
+            // the computer and network players now keep the top gear too, the
+            // pitch only moves where their old count ran past it
+            reference = referenceFrequencyComputer(vehicle, speed, gear, shifted);
+            Int computer = profile.frequency(speed, profileShifted);
+            if (gear > vehicle.gears)
+                clampChange = (std::max)(clampChange, absval<Int>(computer - reference));
+            else
+            {
+                computerError = (std::max)(computerError, absval<Int>(computer - reference));
+                if ((profile.gear(speed) != gear) || (profileShifted != shifted))
+                    ++nMismatches;
+            }
+            for (Int g = 1; g <= vehicle.gears; ++g)
+            {
+                manualError = (std::max)(manualError,
+                                         absval<Int>(profile.frequencyManual(g, speed) - referenceFrequencyManual(vehicle, g, speed)));
+                Float f = Float(speed) + 0.5f;
+                factorError = (std::max)(factorError,
+                                         absval<Int>(profile.gearFactor(g, f) - referenceGearFactor(vehicle, g, f)));
+            }
+        }
+        Boolean passed = (autoError <= PROFILETOLERANCE) && (manualError <= PROFILETOLERANCE) &&
+                         (computerError <= PROFILETOLERANCE) && (factorError <= 1) && (nMismatches == 0);
+        printf("%7u  %7d  %9d  %6d  %11d  %10d  %10u%s\n", v + 1, autoError, manualError, factorError,
+               computerError, clampChange, nMismatches, passed ? "" : "  FAILED");
+        if (!passed)
+            ++nErrors;
+    }
+
+    // a field of cars changing speed a little between updates, as in a race
+    UInt random = 1;
+    Int speed[MAXCARS];
+    const Car::Parameters* parameters[MAXCARS];
+    const VehicleProfile* profiles[MAXCARS];
+    for (UInt i = 0; i < MAXCARS; ++i)
+    {
+        UInt v = UInt(nextRandom(random, NVEHICLES));
+        parameters[i] = &vehicles[v];
+        profiles[i]   = &VehicleProfile::official(v);
+        speed[i]      = nextRandom(random, vehicles[v].topspeed);
+    }
+    Int step[64];
+    for (UInt i = 0; i < 64; ++i)
+        step[i] = nextRandom(random, 161) - 80;
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    Double seconds[2];
+    UInt sum[2] = { 0, 0 };
+    for (UInt pass = 0; pass < 2; ++pass)
+    {
+        Int s[MAXCARS];
+        for (UInt i = 0; i < MAXCARS; ++i)
+            s[i] = speed[i];
+        ::QueryPerformanceCounter(&start);
+        for (UInt u = 0; u < updates; ++u)
+        {
+            for (UInt i = 0; i < MAXCARS; ++i)
+            {
+                s[i] += step[(u + i) & 63];
+                if ((s[i] < 0) || (s[i] > parameters[i]->topspeed))
+                    s[i] = parameters[i]->topspeed/2;
+                Int gear;
+                Boolean shifted;
+                if (pass == 0)
+                    sum[pass] += referenceFrequency(*parameters[i], s[i], gear, shifted) + gear + (shifted ? 1 : 0);
+                else
+                {
+                    gear = profiles[i]->gear(s[i]);
+                    sum[pass] += profiles[i]->frequency(s[i], shifted) + gear + (shifted ? 1 : 0);
+                }
+            }
+        }
+        ::QueryPerformanceCounter(&stop);
+        seconds[pass] = Double(stop.QuadPart - start.QuadPart) / Double(frequency.QuadPart);
+    }
+    UInt nUpdates = updates*MAXCARS;
+    printf("%u engine updates: formula %.1f ns, profile %.1f ns per car, %.1fx (%u %u)\n",
+           nUpdates, 1e9*seconds[0]/nUpdates, 1e9*seconds[1]/nUpdates,
+           (seconds[1] > 0.0) ? seconds[0]/seconds[1] : 0.0, sum[0] & 1, sum[1] & 1);
+    printf("%u vehicles checked, %u errors\n", NVEHICLES, nErrors);
+    return (nErrors == 0) ? 0 : 1;
+}
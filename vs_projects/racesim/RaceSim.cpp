@@ -0,0 +1,674 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// Runs single races without sound, input or the game loop, as fast as the
+// machine allows, and writes the results as CSV or JSON:
+//
+//     racesim [-track <name|file.trk>] [-laps <n>] [-computers <n>]
+//             [-difficulty <0-2>] [-player <vehicle>] [-races <n>]
+//             [-threads <n>] [-seed <n>] [-json] [-output <file>]
+//             [-record <file>] [-rewind] [-replays <file>] [-ghosts <file>]
+//             [-fixed]
+//     racesim -replay <file> [-json] [-output <file>]
+//     racesim -profiles [<updates>]
+//     racesim -vehicles [<directory>] [<mutations>]
+//     racesim -surfaces [<file>] [<steps>]
+//     racesim -golden [<file>] [<steps>]
+//     racesim -events [<pending>]
+//     racesim -framerate [<seconds>]
+//     racesim -balance <sweep> [-balance <sweep>] [-laps <n>] [-races <n>]
+//             [-difficulty <0-2>] [-threads <n>] [-seed <n>] [-fixed]
+//             [-output <file>] [-front <directory>]
+//
+// Every race gets its own seed (base seed + race number), so a run can be
+// repeated exactly, with any number of threads.
+//
+// With -record the state of every car is also written as the race server
+// would hold it, every RECORDINTERVAL seconds, for replaying races through
+// the network code (see snapbench). Per race the file holds the number of
+// frames as a UInt, followed by that many frames of NMAXPLAYERS PlayerData
+// records; the slots of cars that do not take part are in state 'undefined'.
+//
+// With -fixed the cars step in fixed point (CarPhysics::fixedPoint), and the
+// races come out the same with every compiler and on every machine.
+//
+// The checks, benchmarks and the balance lab are each in a file of their
+// own next to this one, named after the option; this file has the race
+// model they share and writes the results.
+
+#include "RaceSim.h"
+#include "resource.h"
+#include "CarDefs.h"
+
+Tracer  _raceTracer("racesim");
+
+// simulated seconds a race may last per lap before it is given up
+#define LAPTIMEOUT      600.0f
+// time lost after a crash before the engine is started again
+#define CRASHDELAY      4.0f
+#define STARTDELAY      1.0f
+// as often as the race server sends the players around (SERVER_UPDATE_TIME)
+#define RECORDINTERVAL  0.1f
+
+
+struct Batch
+{
+    Settings*       settings;
+    Track*          track;
+    RaceResult*     results;
+    volatile LONG   next;
+};
+
+
+// Park-Miller, so results do not depend on the C library
+Int
+nextRandom(UInt& state, Int max)
+{
+    state = UInt((Huge(state) * 48271) % 2147483647);
+    return Int(state % UInt(max));
+}
+
+
+void
+bump(SimCar& car, Int bumpX, Int bumpY, Int bumpSpeed)
+{
+    Int positionX = car.physics.positionX( );
+    Int positionY = car.physics.positionY( );
+    Int speed = car.physics.speed( );
+    if (bumpY != 0)
+    {
+        positionY += bumpY;
+        speed -= bumpSpeed;
+    }
+    if (bumpX != 0)
+    {
+        positionX += 2*bumpX;
+        speed -= speed/5;
+    }
+    if (speed < 0)
+        speed = 0;
+    car.physics.sync(positionX, positionY, speed);
+}
+
+
+static void
+record(const SimCar* car, const RaceResult& result, std::vector<PlayerData>& recording)
+{
+    for (UInt i = 0; i < NMAXPLAYERS; ++i)
+    {
+        PlayerData data;
+        ::memset(&data, 0, sizeof(data));
+        data.id           = i + 1;
+        data.playerNumber = UByte(i);
+        data.state        = undefined;
+        if (i < result.cars)
+        {
+            const SimCar& c = car[i];
+            const VehicleProfile& profile = VehicleProfile::official(result.car[i].vehicle);
+            data.car           = UByte(result.car[i].vehicle);
+            data.posX          = c.physics.positionX( );
+            data.posY          = c.physics.positionY( );
+            data.speed         = UShort(c.physics.speed( ));
+            data.frequency     = profile.frequency(c.physics.speed( ));
+            data.state         = UByte((c.state == SimCar::finished) ? finished : racing);
+            data.engineRunning = (c.state != SimCar::crashed);
+            data.braking       = (c.state == SimCar::running) && (c.throttle == 0);
+        }
+        recording.push_back(data);
+    }
+}
+
+
+void
+vehicleParameters(const Car::Parameters& v, const VehicleProfile* profile, CarPhysics::Model model,
+                  CarPhysics::Parameters& parameters)
+{
+    parameters.model           = model;
+    parameters.acceleration    = v.acceleration;
+    parameters.deceleration    = v.deceleration;
+    parameters.topspeed        = v.topspeed;
+    parameters.gears           = v.gears;
+    parameters.steering        = v.steering;
+    parameters.steeringFactor  = v.steeringFactor;
+    parameters.profile         = profile;
+}
+
+
+void
+vehicleParameters(UInt vehicle, CarPhysics::Model model, CarPhysics::Parameters& parameters)
+{
+    vehicleParameters(vehicles[vehicle], &VehicleProfile::official(vehicle), model, parameters);
+}
+
+
+// a car on its grid position, waiting for the start; the player starts at
+// once, a computer a random moment later
+void
+startCar(Track* track, Int difficulty, UInt position, const CarPhysics::Parameters& parameters, UInt& random,
+         SimCar& c)
+{
+    c.physics.parameters(parameters);
+    c.physics.reset((position % 2) ? 3000 : -3000, 14000 - position*2000);
+    c.driver   = new ComputerDriver(track, difficulty, nextRandom(random, 100));
+    c.cursor   = new RoadCursor(track);
+    c.events   = new EventScheduler(REWINDCAREVENTS);
+    c.state    = SimCar::waiting;
+    if (parameters.model == CarPhysics::player)
+        c.events->schedule(Event::carStart, STARTDELAY);
+    else
+        c.events->schedule(Event::carComputerStart, STARTDELAY + (1.5f + (3.0f*nextRandom(random, 100))/100));
+    c.lapStart = 0.0f;
+    c.lap      = 1;
+    c.surface  = track->definition( )[0].surface;
+    c.steering = 0;
+    c.throttle = 0;
+}
+
+
+void
+startRace(const Settings& settings, Track* track, UInt number, Race& race, RaceResult& result)
+{
+    UInt random = settings.seed + number;
+    if (random == 0)
+        random = 1;
+    race.nCars    = settings.computers + ((settings.player >= 0) ? 1 : 0);
+    race.position = 0;
+    race.steps    = 0;
+    race.time     = 0.0f;
+    result.seed   = random;
+    result.cars   = race.nCars;
+    result.time   = 0.0f;
+    for (UInt i = 0; i < race.nCars; ++i)
+    {
+        // the player takes the first grid position, like in a single race
+        CarResult& r = result.car[i];
+        SimCar& c = race.car[i];
+        ::memset(&r, 0, sizeof(r));
+        r.player  = (settings.player >= 0) && (i == 0);
+        r.vehicle = (r.player) ? UInt(settings.player) : UInt(nextRandom(random, NVEHICLES));
+        CarPhysics::Parameters parameters;
+        vehicleParameters(r.vehicle, (r.player) ? CarPhysics::player : CarPhysics::computer, parameters);
+        startCar(track, settings.difficulty, i, parameters, random, c);
+    }
+    race.random = random;
+}
+
+
+// the player takes the actions of a replay when there is one, otherwise it is
+// driven like the computers
+void
+stepRace(const Settings& settings, Track* track, Race& race, RaceResult& result, const RaceReplay::Actions* player)
+{
+    UInt laneWidth = track->laneWidth( );
+    Float time = race.time = (++race.steps)*PHYSICSSTEP;
+    for (UInt i = 0; i < race.nCars; ++i)
+    {
+        SimCar& c = race.car[i];
+        CarResult& r = result.car[i];
+        if (c.state == SimCar::finished)
+            continue;
+        if (c.state != SimCar::running)
+        {
+            Event event;
+            while (c.events->popDue(time, event))
+                c.state = SimCar::running;
+            continue;
+        }
+        Boolean replayed = (player != NULL) && (r.player);
+        if (replayed)
+        {
+            c.steering = player->steering;
+            c.throttle = player->throttle;
+        }
+        else
+            c.driver->drive(c.physics.positionX( ), c.physics.positionY( ), c.steering, c.throttle);
+        CarPhysics::Input input;
+        input.steering = c.steering;
+        input.throttle = c.throttle;
+        input.brake    = (replayed) ? player->brake : 0;
+        input.gear     = 0;
+        input.surface  = c.surface;
+        c.physics.step(input);
+        c.physics.settle( );
+
+        Int positionX = c.physics.positionX( );
+        Int positionY = c.physics.positionY( );
+        Int speed = c.physics.speed( );
+        Track::Road road = c.cursor->road(positionY);
+        c.surface = road.surface;
+        if ((positionX < road.left) || (positionX - road.left > 2*Int(laneWidth)))
+        {
+            ++r.crashes;
+            if (speed < c.physics.parameters( ).topspeed/2)
+                c.physics.sync((road.right + road.left)/2, positionY, speed/4);
+            else
+            {
+                c.physics.sync((road.right + road.left)/2, positionY, 0);
+                c.state = SimCar::crashed;
+                c.events->schedule(Event::carRestart, time + CRASHDELAY);
+            }
+        }
+
+        UInt lap = track->lap(positionY);
+        if (lap > c.lap)
+        {
+            if (r.laps < MAXLAPS)
+                r.lapTime[r.laps] = time - c.lapStart;
+            ++r.laps;
+            c.lapStart = time;
+            c.lap = lap;
+            if (lap > settings.laps)
+            {
+                c.state    = SimCar::finished;
+                r.finished = true;
+                r.time     = time;
+                r.position = ++race.position;
+            }
+        }
+    }
+
+    // only the player bumps into the others, as in LevelSingleRace
+    if ((settings.player >= 0) && (race.car[0].state == SimCar::running))
+    {
+        for (UInt i = 1; i < race.nCars; ++i)
+        {
+            if (race.car[i].state == SimCar::finished)
+                continue;
+            Int bumpX = race.car[0].physics.positionX( ) - race.car[i].physics.positionX( );
+            Int bumpY = race.car[0].physics.positionY( ) - race.car[i].physics.positionY( );
+            if ((absval<Int>(bumpX) < 1000) && (absval<Int>(bumpY) < 500))
+            {
+                Int bumpSpeed = race.car[0].physics.speed( ) - race.car[i].physics.speed( );
+                bump(race.car[0], bumpX, bumpY, bumpSpeed);
+                bump(race.car[i], -bumpX, -bumpY, -bumpSpeed);
+                ++result.car[0].bumps;
+                ++result.car[i].bumps;
+            }
+        }
+    }
+}
+
+
+Boolean
+raceRunning(const Settings& settings, const Race& race)
+{
+    return (race.position < race.nCars) && (race.time < LAPTIMEOUT*settings.laps);
+}
+
+
+void
+endRace(Race& race, RaceResult& result)
+{
+    result.time = race.time;
+    for (UInt i = 0; i < race.nCars; ++i)
+    {
+        SAFE_DELETE(race.car[i].driver);
+        SAFE_DELETE(race.car[i].cursor);
+        SAFE_DELETE(race.car[i].events);
+    }
+}
+
+
+void
+simulate(const Settings& settings, Track* track, UInt number, RaceResult& result)
+{
+    Race race;
+    startRace(settings, track, number, race, result);
+    Float nextRecord = 0.0f;
+    result.recording.clear( );
+    while (raceRunning(settings, race))
+    {
+        if ((settings.record[0] != '\0') && (race.time >= nextRecord))
+        {
+            record(race.car, result, result.recording);
+            nextRecord += RECORDINTERVAL;
+        }
+        stepRace(settings, track, race, result);
+    }
+    endRace(race, result);
+}
+
+
+Boolean
+sameResult(const RaceResult& a, const RaceResult& b)
+{
+    if ((a.cars != b.cars) || (a.time != b.time))
+        return false;
+    for (UInt i = 0; i < a.cars; ++i)
+    {
+        const CarResult& ca = a.car[i];
+        const CarResult& cb = b.car[i];
+        if ((ca.vehicle != cb.vehicle) || (ca.position != cb.position) || (ca.finished != cb.finished) ||
+            (ca.time != cb.time) || (ca.laps != cb.laps) || (ca.bumps != cb.bumps) || (ca.crashes != cb.crashes))
+            return false;
+        for (UInt lap = 0; (lap < ca.laps) && (lap < MAXLAPS); ++lap)
+            if (ca.lapTime[lap] != cb.lapTime[lap])
+                return false;
+    }
+    return true;
+}
+
+
+Boolean
+sameState(const CarPhysics::State* a, const CarPhysics::State* b, UInt nCars)
+{
+    for (UInt i = 0; i < nCars; ++i)
+        if ((a[i].positionX != b[i].positionX) || (a[i].positionY != b[i].positionY) || (a[i].speed != b[i].speed)
+            || (a[i].speedDiff != b[i].speedDiff) || (a[i].thrust != b[i].thrust) || (a[i].steering != b[i].steering))
+            return false;
+    return true;
+}
+
+
+// seconds the threads took to run the routine until it ran out of work
+Double
+runThreads(UInt nThreads, LPTHREAD_START_ROUTINE routine, LPVOID parameter)
+{
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    ::QueryPerformanceCounter(&start);
+    HANDLE* threads = new HANDLE[nThreads];
+    for (UInt i = 0; i < nThreads; ++i)
+        threads[i] = ::CreateThread(NULL, 0, routine, parameter, 0, NULL);
+    for (UInt i = 0; i < nThreads; ++i)
+    {
+        ::WaitForSingleObject(threads[i], INFINITE);
+        ::CloseHandle(threads[i]);
+    }
+    ::QueryPerformanceCounter(&stop);
+    SAFE_DELETE_ARRAY(threads);
+    return Double(stop.QuadPart - start.QuadPart) / Double(frequency.QuadPart);
+}
+
+
+static DWORD WINAPI
+worker(LPVOID parameter)
+{
+    Batch* batch = (Batch*)parameter;
+    for (;;)
+    {
+        LONG race = InterlockedIncrement(&batch->next) - 1;
+        if (race >= (LONG)batch->settings->races)
+            break;
+        simulate(*batch->settings, batch->track, UInt(race), batch->results[race]);
+    }
+    return 0;
+}
+
+
+void
+writeCsv(FILE* out, const Settings& settings, const RaceResult* results)
+{
+    fprintf(out, "race,seed,car,vehicle,player,position,finished,time,laps,bumps,crashes");
+    for (UInt lap = 0; (lap < settings.laps) && (lap < MAXLAPS); ++lap)
+        fprintf(out, ",lap%u", lap + 1);
+    fprintf(out, "\n");
+    for (UInt race = 0; race < settings.races; ++race)
+    {
+        const RaceResult& result = results[race];
+        for (UInt i = 0; i < result.cars; ++i)
+        {
+            const CarResult& r = result.car[i];
+            fprintf(out, "%u,%u,%u,%u,%d,%u,%d,%.3f,%u,%u,%u", race, result.seed, i, r.vehicle + 1,
+                    r.player ? 1 : 0, r.position, r.finished ? 1 : 0, r.time, r.laps, r.bumps, r.crashes);
+            for (UInt lap = 0; (lap < settings.laps) && (lap < MAXLAPS); ++lap)
+            {
+                if (lap < r.laps)
+                    fprintf(out, ",%.3f", r.lapTime[lap]);
+                else
+                    fprintf(out, ",");
+            }
+            fprintf(out, "\n");
+        }
+    }
+}
+
+
+void
+writeJson(FILE* out, const Settings& settings, const RaceResult* results)
+{
+    fprintf(out, "{\n  \"track\": \"%s\",\n  \"laps\": %u,\n  \"difficulty\": %d,\n  \"races\": [\n",
+            settings.track, settings.laps, settings.difficulty);
+    for (UInt race = 0; race < settings.races; ++race)
+    {
+        const RaceResult& result = results[race];
+        fprintf(out, "    { \"race\": %u, \"seed\": %u, \"time\": %.3f, \"cars\": [\n", race, result.seed, result.time);
+        for (UInt i = 0; i < result.cars; ++i)
+        {
+            const CarResult& r = result.car[i];
+            fprintf(out, "      { \"car\": %u, \"vehicle\": %u, \"player\": %s, \"position\": %u, \"finished\": %s, "
+                         "\"time\": %.3f, \"bumps\": %u, \"crashes\": %u, \"laps\": [",
+                    i, r.vehicle + 1, r.player ? "true" : "false", r.position, r.finished ? "true" : "false",
+                    r.time, r.bumps, r.crashes);
+            for (UInt lap = 0; (lap < r.laps) && (lap < MAXLAPS); ++lap)
+                fprintf(out, "%s%.3f", (lap > 0) ? ", " : "", r.lapTime[lap]);
+            fprintf(out, "] }%s\n", (i + 1 < result.cars) ? "," : "");
+        }
+        fprintf(out, "    ] }%s\n", (race + 1 < settings.races) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+
+static Boolean
+writeRecording(const Char* filename, const Settings& settings, const RaceResult* results)
+{
+    FILE* out = fopen(filename, "wb");
+    if (out == NULL)
+        return false;
+    for (UInt race = 0; race < settings.races; ++race)
+    {
+        const std::vector<PlayerData>& recording = results[race].recording;
+        UInt nFrames = UInt(recording.size( )) / NMAXPLAYERS;
+        fwrite(&nFrames, sizeof(nFrames), 1, out);
+        if (nFrames > 0)
+            fwrite(&recording[0], sizeof(PlayerData), recording.size( ), out);
+    }
+    Boolean written = (ferror(out) == 0);
+    fclose(out);
+    return written;
+}
+
+
+static Boolean
+parseArguments(int argc, char* argv[], Settings& settings)
+{
+    SYSTEM_INFO system;
+    ::GetSystemInfo(&system);
+    strcpy(settings.track, "america");
+    settings.laps       = 3;
+    settings.computers  = 7;
+    settings.difficulty = 1;
+    settings.player     = -1;
+    settings.races      = 100;
+    settings.threads    = system.dwNumberOfProcessors;
+    settings.seed       = 1;
+    settings.json       = false;
+    settings.rewind     = false;
+    settings.fixed      = false;
+    settings.output[0]  = '\0';
+    settings.record[0]  = '\0';
+    settings.replay[0]  = '\0';
+    settings.replays[0] = '\0';
+    settings.ghosts[0]  = '\0';
+    settings.balance[0] = '\0';
+    settings.front[0]   = '\0';
+    for (Int i = 1; i < argc; ++i)
+    {
+        const Char* option = argv[i];
+        const Char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(option, "-json") == 0)
+        {
+            settings.json = true;
+            continue;
+        }
+        if (strcmp(option, "-rewind") == 0)
+        {
+            settings.rewind = true;
+            continue;
+        }
+        if (strcmp(option, "-fixed") == 0)
+        {
+            settings.fixed = true;
+            continue;
+        }
+        if (value == NULL)
+            return false;
+        ++i;
+        if (strcmp(option, "-track") == 0)
+            _snprintf(settings.track, sizeof(settings.track) - 1, "%s", value);
+        else if (strcmp(option, "-output") == 0)
+            _snprintf(settings.output, sizeof(settings.output) - 1, "%s", value);
+        else if (strcmp(option, "-record") == 0)
+            _snprintf(settings.record, sizeof(settings.record) - 1, "%s", value);
+        else if (strcmp(option, "-replay") == 0)
+            _snprintf(settings.replay, sizeof(settings.replay) - 1, "%s", value);
+        else if (strcmp(option, "-replays") == 0)
+            _snprintf(settings.replays, sizeof(settings.replays) - 1, "%s", value);
+        else if (strcmp(option, "-ghosts") == 0)
+            _snprintf(settings.ghosts, sizeof(settings.ghosts) - 1, "%s", value);
+        else if (strcmp(option, "-balance") == 0)
+        {
+            UInt length = UInt(strlen(settings.balance));
+            if (length + strlen(value) + 2 > sizeof(settings.balance))
+                return false;
+            _snprintf(settings.balance + length, sizeof(settings.balance) - length - 1, "%s%s",
+                      (length > 0) ? ";" : "", value);
+        }
+        else if (strcmp(option, "-front") == 0)
+            _snprintf(settings.front, sizeof(settings.front) - 1, "%s", value);
+        else if (strcmp(option, "-laps") == 0)
+            settings.laps = atoi(value);
+        else if (strcmp(option, "-computers") == 0)
+            settings.computers = atoi(value);
+        else if (strcmp(option, "-difficulty") == 0)
+            settings.difficulty = atoi(value);
+        else if (strcmp(option, "-player") == 0)
+            settings.player = atoi(value) - 1;
+        else if (strcmp(option, "-races") == 0)
+            settings.races = atoi(value);
+        else if (strcmp(option, "-threads") == 0)
+            settings.threads = atoi(value);
+        else if (strcmp(option, "-seed") == 0)
+            settings.seed = UInt(strtoul(value, NULL, 10));
+        else
+            return false;
+    }
+    UInt nCars = settings.computers + ((settings.player >= 0) ? 1 : 0);
+    if ((settings.laps == 0) || (nCars == 0) || (nCars > MAXCARS) || (settings.races == 0) ||
+        (settings.player >= NVEHICLES) || (settings.difficulty < 0) || (settings.difficulty > 2))
+        return false;
+    if (settings.threads == 0)
+        settings.threads = 1;
+    return true;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    if ((argc >= 2) && (argc <= 3) && (strcmp(argv[1], "-profiles") == 0))
+        return checkProfiles((argc == 3) ? UInt(atoi(argv[2])) : 1000000);
+    if ((argc >= 2) && (argc <= 4) && (strcmp(argv[1], "-vehicles") == 0))
+        return checkVehicles((argc >= 3) ? argv[2] : "Vehicles", (argc == 4) ? UInt(atoi(argv[3])) : 100000);
+    if ((argc >= 2) && (argc <= 4) && (strcmp(argv[1], "-surfaces") == 0))
+        return checkSurfaces((argc >= 3) ? argv[2] : "surfaces.cfg", (argc == 4) ? UInt(atoi(argv[3])) : 200000);
+    if ((argc >= 2) && (argc <= 4) && (strcmp(argv[1], "-golden") == 0))
+        return checkGolden((argc >= 3) ? argv[2] : "golden.txt", (argc == 4) ? UInt(atoi(argv[3])) : 1000000);
+    if ((argc >= 2) && (argc <= 3) && (strcmp(argv[1], "-framerate") == 0))
+        return checkFrameRates((argc == 3) ? (std::max)(UInt(atoi(argv[2])), 1u) : 60);
+    if ((argc >= 2) && (argc <= 3) && (strcmp(argv[1], "-events") == 0))
+        return checkEvents((argc == 3) ? (std::max)(UInt(atoi(argv[2])), 10u) : 100000);
+    Settings settings;
+    if (!parseArguments(argc, argv, settings))
+    {
+        printf("usage: racesim [-track <name|file.trk>] [-laps <n>] [-computers <n>]\n");
+        printf("               [-difficulty <0-2>] [-player <vehicle>] [-races <n>]\n");
+        printf("               [-threads <n>] [-seed <n>] [-json] [-output <file>]\n");
+        printf("               [-record <file>] [-rewind] [-replays <file>] [-ghosts <file>]\n");
+        printf("               [-fixed]\n");
+        printf("       racesim -replay <file> [-json] [-output <file>]\n");
+        printf("       racesim -profiles [<updates>]\n");
+        printf("       racesim -vehicles [<directory>] [<mutations>]\n");
+        printf("       racesim -surfaces [<file>] [<steps>]\n");
+        printf("       racesim -golden [<file>] [<steps>]\n");
+        printf("       racesim -events [<pending>]\n");
+        printf("       racesim -framerate [<seconds>]\n");
+        printf("       racesim -balance <sweep> [-balance <sweep>] [-laps <n>] [-races <n>]\n");
+        printf("               [-difficulty <0-2>] [-threads <n>] [-seed <n>] [-fixed]\n");
+        printf("               [-output <file>] [-front <directory>]\n");
+        printf("       a sweep is <vehicle>:<field>=<from>[..<to>[/<step>]],...\n");
+        return 2;
+    }
+    if (settings.replay[0] != '\0')
+        return playReplay(settings);
+    CarPhysics::defaultArithmetic(settings.fixed ? CarPhysics::fixedPoint : CarPhysics::floatingPoint);
+    if (settings.balance[0] != '\0')
+        return balanceVehicles(settings);
+    Track* track = Track::readTrack(settings.track);
+    if ((track == NULL) || (track->trackLength( ) == 0))
+    {
+        fprintf(stderr, "%s: no track definition found\n", settings.track);
+        SAFE_DELETE(track);
+        return 1;
+    }
+
+    // built before the workers share them
+    VehicleProfile::official(0);
+
+    if (settings.rewind)
+    {
+        Int result = checkRewind(settings, track);
+        SAFE_DELETE(track);
+        return result;
+    }
+    if (settings.replays[0] != '\0')
+    {
+        Int result = checkReplays(settings, track);
+        SAFE_DELETE(track);
+        return result;
+    }
+    if (settings.ghosts[0] != '\0')
+    {
+        Int result = checkGhosts(settings, track);
+        SAFE_DELETE(track);
+        return result;
+    }
+
+    Batch batch;
+    batch.settings = &settings;
+    batch.track    = track;
+    batch.results  = new RaceResult[settings.races];
+    batch.next     = 0;
+
+    Double seconds = runThreads(settings.threads, worker, &batch);
+
+    FILE* out = stdout;
+    if (settings.output[0] != '\0')
+        out = fopen(settings.output, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "%s: could not write\n", settings.output);
+        SAFE_DELETE_ARRAY(batch.results);
+        SAFE_DELETE(track);
+        return 1;
+    }
+    if (settings.json)
+        writeJson(out, settings, batch.results);
+    else
+        writeCsv(out, settings, batch.results);
+    if (out != stdout)
+        fclose(out);
+    if ((settings.record[0] != '\0') && (!writeRecording(settings.record, settings, batch.results)))
+        fprintf(stderr, "%s: could not write\n", settings.record);
+
+    fprintf(stderr, "%u races on %u threads in %.3f s: %.1f races/s\n", settings.races, settings.threads,
+            seconds, (seconds > 0.0) ? settings.races / seconds : 0.0);
+    SAFE_DELETE_ARRAY(batch.results);
+    SAFE_DELETE(track);
+    return 0;
+}
@@ -0,0 +1,148 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+#ifndef __RACING_RACESIM_H__
+#define __RACING_RACESIM_H__
+
+#include "Track.h"
+#include "CarPhysics.h"
+#include "ComputerDriver.h"
+#include "RoadCursor.h"
+#include "Game.h"
+#include "Car.h"
+#include "Packets.h"
+#include "VehicleProfile.h"
+#include "RaceRewind.h"
+#include "RaceReplay.h"
+#include <vector>
+
+// the built-in vehicles, in CarDefs.h
+#define NVEHICLES       12
+#define MAXCARS         8
+#define MAXLAPS         16
+// the sweeps given to -balance
+#define BALANCESIZE     1024
+
+extern Car::Parameters vehicles[NVEHICLES];
+
+
+struct Settings
+{
+    Char            track[MAX_PATH];
+    UInt            laps;
+    UInt            computers;
+    Int             difficulty;
+    Int             player;         // vehicle of the scripted player, -1 for none
+    UInt            races;
+    UInt            threads;
+    UInt            seed;
+    Boolean         json;
+    Boolean         rewind;
+    Boolean         fixed;
+    Char            output[MAX_PATH];
+    Char            record[MAX_PATH];
+    Char            replay[MAX_PATH];
+    Char            replays[MAX_PATH];
+    Char            ghosts[MAX_PATH];
+    Char            balance[BALANCESIZE];   // the sweeps, separated by ';'
+    Char            front[MAX_PATH];
+};
+
+struct CarResult
+{
+    UInt            vehicle;
+    Boolean         player;
+    UInt            position;
+    Boolean         finished;
+    Float           time;
+    UInt            laps;
+    Float           lapTime[MAXLAPS];
+    UInt            bumps;
+    UInt            crashes;
+};
+
+struct RaceResult
+{
+    UInt            seed;
+    UInt            cars;
+    Float           time;
+    CarResult       car[MAXCARS];
+    std::vector<PlayerData> recording;
+};
+
+struct SimCar
+{
+    enum State
+    {
+        waiting,
+        running,
+        crashed,
+        finished
+    };
+
+    CarPhysics      physics;
+    ComputerDriver* driver;
+    RoadCursor*     cursor;
+    EventScheduler* events;         // the start, or the restart after a crash
+    State           state;
+    Float           lapStart;
+    UInt            lap;
+    Track::Surface  surface;
+    Int             steering;
+    Int             throttle;
+};
+
+// everything that changes while a race runs
+struct Race
+{
+    SimCar          car[MAXCARS];
+    UInt            nCars;
+    UInt            position;       // cars finished so far
+    UInt            steps;
+    Float           time;
+    UInt            random;
+};
+
+
+// the race model, in RaceSim.cpp
+Int         nextRandom(UInt& state, Int max);
+void        bump(SimCar& car, Int bumpX, Int bumpY, Int bumpSpeed);
+void        vehicleParameters(const Car::Parameters& v, const VehicleProfile* profile, CarPhysics::Model model,
+                              CarPhysics::Parameters& parameters);
+void        vehicleParameters(UInt vehicle, CarPhysics::Model model, CarPhysics::Parameters& parameters);
+void        startCar(Track* track, Int difficulty, UInt position, const CarPhysics::Parameters& parameters, UInt& random,
+                     SimCar& c);
+void        startRace(const Settings& settings, Track* track, UInt number, Race& race, RaceResult& result);
+void        stepRace(const Settings& settings, Track* track, Race& race, RaceResult& result,
+                     const RaceReplay::Actions* player = NULL);
+Boolean     raceRunning(const Settings& settings, const Race& race);
+void        endRace(Race& race, RaceResult& result);
+void        simulate(const Settings& settings, Track* track, UInt number, RaceResult& result);
+Boolean     sameResult(const RaceResult& a, const RaceResult& b);
+Boolean     sameState(const CarPhysics::State* a, const CarPhysics::State* b, UInt nCars);
+Double      runThreads(UInt nThreads, LPTHREAD_START_ROUTINE routine, LPVOID parameter);
+void        writeCsv(FILE* out, const Settings& settings, const RaceResult* results);
+void        writeJson(FILE* out, const Settings& settings, const RaceResult* results);
+
+// a built-in vehicle as a vehicle file, in VehicleCheck.cpp
+void        vehicleText(const Car::Parameters& p, UInt vehicle, std::vector<Char>& text);
+
+// the checks and benchmarks, each in a file named after it
+Int         checkRewind(const Settings& settings, Track* track);
+Int         checkReplays(const Settings& settings, Track* track);
+Int         playReplay(Settings& settings);
+Int         checkGhosts(const Settings& settings, Track* track);
+Int         checkProfiles(UInt updates);
+Int         checkVehicles(const Char* directory, UInt nMutations);
+Int         checkSurfaces(const Char* filename, UInt nSteps);
+Int         checkGolden(const Char* filename, UInt nSteps);
+Int         checkEvents(UInt maxPending);
+Int         checkFrameRates(UInt seconds);
+Int         balanceVehicles(const Settings& settings);
+
+
+#endif /* __RACING_RACESIM_H__ */
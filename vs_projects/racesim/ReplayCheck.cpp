@@ -0,0 +1,227 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// With -replays every race is raced in frames of made-up lengths, like the
+// game's, by the scripted player (vehicle 1 without -player), its actions
+// recorded into a RaceReplay. The replay is written to the file, read back
+// and raced again from the file alone, the player driven by what was read,
+// and both have to end in the same state to the last bit. Then racing the
+// replays again is timed, as a workload that is the same every run; the file
+// keeps the last race.
+//
+// With -replay the race recorded in the file, by the game or by -replays, is
+// raced again as fast as it goes and its result written. The track, cars and
+// seed are the ones in the file; racesim only knows the built-in vehicles
+// and races the way it models a race, so a race from the game ends the way
+// its player drove it but not in the same places.
+
+#include "RaceSim.h"
+
+// microseconds a frame of a race recorded by -replays takes, a sleep of
+// 10 ms as in Game::run and some work
+#define REPLAYFRAMEMIN  10000
+#define REPLAYFRAMEMAX  25000
+// times -replays races its replays again to time them
+#define REPLAYBENCHRUNS 5
+
+
+// a race in frames as long as the replay says, the player driven by the
+// actions of each frame; when recording the frames are made up and the
+// scripted player's actions are added to the replay instead. The steps due
+// are counted from the sum of the frames, as CarPhysics::run does
+static UInt
+replayRace(const Settings& settings, Track* track, UInt number, RaceReplay& replay, Boolean recording,
+           RaceResult& result, CarPhysics::State* final)
+{
+    Race race;
+    startRace(settings, track, number, race, result);
+    UInt frames = result.seed;
+    UHuge clock = 0;
+    UInt elapsed;
+    RaceReplay::Actions actions;
+    ::memset(&actions, 0, sizeof(actions));
+    replay.rewind( );
+    while (raceRunning(settings, race))
+    {
+        if (recording)
+        {
+            SimCar& player = race.car[0];
+            elapsed = REPLAYFRAMEMIN + nextRandom(frames, REPLAYFRAMEMAX - REPLAYFRAMEMIN);
+            if (player.state == SimCar::running)
+                player.driver->drive(player.physics.positionX( ), player.physics.positionY( ),
+                                     actions.steering, actions.throttle);
+            replay.add(elapsed, actions);
+        }
+        else if (!replay.next(elapsed, actions))
+            break;
+        clock += elapsed;
+        while ((raceRunning(settings, race)) && (UHuge(race.steps + 1)*(1000000/PHYSICSRATE) <= clock))
+            stepRace(settings, track, race, result, &actions);
+    }
+    for (UInt i = 0; i < race.nCars; ++i)
+        final[i] = race.car[i].physics.state( );
+    UInt steps = race.steps;
+    endRace(race, result);
+    return steps;
+}
+
+
+// the settings a replay was recorded with, false if racesim cannot race it
+static Boolean
+replaySettings(const RaceReplay::Setup& setup, Settings& settings)
+{
+    _snprintf(settings.track, sizeof(settings.track) - 1, "%s", setup.track);
+    settings.laps       = setup.laps;
+    settings.computers  = setup.computers;
+    settings.difficulty = setup.difficulty;
+    settings.player     = Int(setup.vehicle);
+    settings.seed       = setup.seed;
+    settings.races      = 1;
+    settings.fixed      = (setup.arithmetic == CarPhysics::fixedPoint);
+    if (setup.vehicleFile[0] != '\0')
+        fprintf(stderr, "%s: not a built-in vehicle, racing vehicle %u\n", setup.vehicleFile, setup.vehicle + 1);
+    return (settings.laps > 0) && (settings.computers + 1 <= MAXCARS) && (settings.player < NVEHICLES)
+           && (settings.difficulty >= 0) && (settings.difficulty <= 2);
+}
+
+
+// every race recorded, written, read back and raced again from the file;
+// both have to end the same to the last bit. Then the replays are raced
+// again and again as a benchmark of a fixed workload
+Int
+checkReplays(const Settings& settings, Track* track)
+{
+    Settings scripted = settings;
+    if (scripted.player < 0)
+        scripted.player = 0;
+    if (scripted.computers + 1 > MAXCARS)
+        scripted.computers = MAXCARS - 1;
+    std::vector<RaceReplay*> replays;
+    UInt nErrors = 0;
+    UHuge bytes = 0;
+    UHuge duration = 0;
+    for (UInt number = 0; number < settings.races; ++number)
+    {
+        RaceReplay* recorded = new RaceReplay;
+        RaceReplay::Setup setup;
+        ::memset(&setup, 0, sizeof(setup));
+        setup.seed       = (scripted.seed + number != 0) ? scripted.seed + number : 1;
+        setup.mode       = RaceReplay::singleRace;
+        _snprintf(setup.track, sizeof(setup.track) - 1, "%s", scripted.track);
+        setup.vehicle    = UInt(scripted.player);
+        setup.automaticTransmission = true;
+        setup.laps       = scripted.laps;
+        setup.computers  = scripted.computers;
+        setup.difficulty = scripted.difficulty;
+        setup.arithmetic = CarPhysics::defaultArithmetic( );
+        recorded->record(setup);
+        RaceResult first;
+        CarPhysics::State firstState[MAXCARS];
+        replayRace(scripted, track, number, *recorded, true, first, firstState);
+
+        RaceReplay* loaded = new RaceReplay;
+        Settings played = settings;
+        Boolean same = (recorded->write(settings.replays)) && (loaded->read(settings.replays))
+                       && (loaded->nFrames( ) == recorded->nFrames( )) && (replaySettings(loaded->setup( ), played));
+        if (same)
+        {
+            RaceResult second;
+            CarPhysics::State secondState[MAXCARS];
+            replayRace(played, track, 0, *loaded, false, second, secondState);
+            same = (sameResult(first, second)) && (sameState(firstState, secondState, first.cars));
+        }
+        if (!same)
+            ++nErrors;
+        bytes    += loaded->size( );
+        duration += loaded->duration( );
+        printf("race %u: %.3f s, %u frames in %u bytes, %s\n", number, first.time, recorded->nFrames( ),
+               recorded->size( ), same ? "same" : "DIFFERENT");
+        SAFE_DELETE(recorded);
+        replays.push_back(loaded);
+    }
+
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    UHuge frames = 0;
+    UHuge steps = 0;
+    ::QueryPerformanceCounter(&start);
+    for (UInt run = 0; run < REPLAYBENCHRUNS; ++run)
+    {
+        for (UInt i = 0; i < replays.size( ); ++i)
+        {
+            Settings played = settings;
+            replaySettings(replays[i]->setup( ), played);
+            RaceResult result;
+            CarPhysics::State state[MAXCARS];
+            steps  += replayRace(played, track, 0, *replays[i], false, result, state);
+            frames += replays[i]->nFrames( );
+        }
+    }
+    ::QueryPerformanceCounter(&stop);
+    Double seconds = Double(stop.QuadPart - start.QuadPart) / Double(frequency.QuadPart);
+    for (UInt i = 0; i < replays.size( ); ++i)
+        SAFE_DELETE(replays[i]);
+    printf("%u replays, %.1f bytes per second of racing, raced %u times: %.2f us per frame, "
+           "%.3f us per step\n", settings.races, (duration > 0) ? 1e6*bytes/Double(duration) : 0.0,
+           REPLAYBENCHRUNS, (frames > 0) ? 1e6*seconds/frames : 0.0, (steps > 0) ? 1e6*seconds/steps : 0.0);
+    printf("%u races, %u errors\n", settings.races, nErrors);
+    return (nErrors == 0) ? 0 : 1;
+}
+
+
+// the race of a replay file raced again, its result written as any race's
+Int
+playReplay(Settings& settings)
+{
+    RaceReplay replay;
+    if (!replay.read(settings.replay))
+    {
+        fprintf(stderr, "%s: not a replay\n", settings.replay);
+        return 1;
+    }
+    if (!replaySettings(replay.setup( ), settings))
+    {
+        fprintf(stderr, "%s: not a race racesim can run\n", settings.replay);
+        return 1;
+    }
+    Track* track = Track::readTrack(settings.track);
+    if ((track == NULL) || (track->trackLength( ) == 0))
+    {
+        fprintf(stderr, "%s: no track definition found\n", settings.track);
+        SAFE_DELETE(track);
+        return 1;
+    }
+    VehicleProfile::official(0);
+    CarPhysics::defaultArithmetic(settings.fixed ? CarPhysics::fixedPoint : CarPhysics::floatingPoint);
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    ::QueryPerformanceCounter(&start);
+    RaceResult result;
+    CarPhysics::State state[MAXCARS];
+    UInt steps = replayRace(settings, track, 0, replay, false, result, state);
+    ::QueryPerformanceCounter(&stop);
+    SAFE_DELETE(track);
+    Double seconds = Double(stop.QuadPart - start.QuadPart) / Double(frequency.QuadPart);
+
+    FILE* out = stdout;
+    if (settings.output[0] != '\0')
+        out = fopen(settings.output, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "%s: could not write\n", settings.output);
+        return 1;
+    }
+    if (settings.json)
+        writeJson(out, settings, &result);
+    else
+        writeCsv(out, settings, &result);
+    if (out != stdout)
+        fclose(out);
+    fprintf(stderr, "%u frames, %u steps, %.1f s of racing in %.3f s: %.2f us per frame\n", replay.nFrames( ),
+            steps, replay.duration( )/1e6, seconds, (replay.nFrames( ) > 0) ? 1e6*seconds/replay.nFrames( ) : 0.0);
+    return 0;
+}
@@ -0,0 +1,212 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// With -rewind every race is run once straight through and once jumping
+// back to RaceRewind snapshots taken on the way, and both have to give the
+// same result. A car with more events pending than a snapshot holds has to
+// fail the snapshot rather than lose them. Then taking snapshots of a full
+// field is timed.
+
+#include "RaceSim.h"
+#include "RaceRewind.h"
+
+// times a race checked by -rewind jumps back at most
+#define REWINDJUMPS     3
+
+
+// false when the events of a car don't fit, the frame is not to be kept
+static Boolean
+saveRace(const Race& race, const RaceResult& result, RaceRewind::Frame& frame)
+{
+    frame.step      = race.steps;
+    frame.random    = race.random;
+    frame.nCars     = race.nCars;
+    frame.nFinished = race.position;
+    frame.nEvents   = 0;
+    for (UInt i = 0; i < race.nCars; ++i)
+    {
+        const SimCar& c = race.car[i];
+        const CarResult& r = result.car[i];
+        RaceRewind::Car& saved = frame.car[i];
+        c.physics.save(saved.physics);
+        saved.lapStart   = c.lapStart;
+        saved.finishTime = r.time;
+        saved.lap        = c.lap;
+        saved.laps       = r.laps;
+        saved.position   = r.position;
+        saved.bumps      = r.bumps;
+        saved.crashes    = r.crashes;
+        saved.steering   = c.steering;
+        saved.throttle   = c.throttle;
+        saved.state      = UByte(c.state);
+        saved.surface    = UByte(c.surface);
+        UInt nEvents;
+        if (!RaceRewind::saveEvents(*c.events, saved.event, REWINDCAREVENTS, nEvents))
+            return false;
+        saved.nEvents    = UByte(nEvents);
+    }
+    return true;
+}
+
+
+// the lap times of laps completed after the snapshot are written again as
+// the race carries on, the ones before it were never touched
+static void
+restoreRace(const RaceRewind::Frame& frame, Race& race, RaceResult& result)
+{
+    race.steps    = frame.step;
+    race.time     = frame.time;
+    race.random   = frame.random;
+    race.position = frame.nFinished;
+    for (UInt i = 0; i < race.nCars; ++i)
+    {
+        SimCar& c = race.car[i];
+        CarResult& r = result.car[i];
+        const RaceRewind::Car& saved = frame.car[i];
+        c.physics.restore(saved.physics);
+        c.lapStart = saved.lapStart;
+        c.lap      = saved.lap;
+        c.steering = saved.steering;
+        c.throttle = saved.throttle;
+        c.state    = SimCar::State(saved.state);
+        c.surface  = Track::Surface(saved.surface);
+        c.cursor->reset( );
+        RaceRewind::restoreEvents(saved.event, saved.nEvents, *c.events);
+        r.time     = saved.finishTime;
+        r.laps     = saved.laps;
+        r.position = saved.position;
+        r.finished = (saved.position > 0);
+        r.bumps    = saved.bumps;
+        r.crashes  = saved.crashes;
+    }
+}
+
+
+// every race run straight through and again with jumps back to snapshots
+// taken on the way; both have to end the same to the last bit. Then the cost
+// of taking a snapshot of a full field and what a ring of REWINDSECONDS takes
+Int
+checkRewind(const Settings& settings, Track* track)
+{
+    UInt nErrors = 0;
+    UInt nRewinds = 0;
+    UInt nDiscarded = 0;
+    UInt random = settings.seed;
+    for (UInt number = 0; number < settings.races; ++number)
+    {
+        RaceResult straight;
+        simulate(settings, track, number, straight);
+
+        RaceResult rewound;
+        Race race;
+        RaceRewind rewind;
+        startRace(settings, track, number, race, rewound);
+        UInt jumps = 0;
+        while (raceRunning(settings, race))
+        {
+            if (rewind.due(race.time) && !saveRace(race, rewound, rewind.capture(race.time)))
+            {
+                rewind.discard( );
+                ++nDiscarded;
+            }
+            stepRace(settings, track, race, rewound);
+            // now and then a jump back, at most a few per race so it ends; one
+            // past the latest snapshot goes to the latest, an empty ring nowhere
+            if ((jumps < REWINDJUMPS) && (nextRandom(random, 2000) == 0))
+            {
+                const RaceRewind::Frame* frame = rewind.rewind(nextRandom(random, rewind.nFrames( ) + 1));
+                if (frame != NULL)
+                {
+                    restoreRace(*frame, race, rewound);
+                    ++jumps;
+                }
+            }
+        }
+        endRace(race, rewound);
+        nRewinds += jumps;
+        Boolean same = sameResult(straight, rewound);
+        if (!same)
+            ++nErrors;
+        printf("race %u: %.3f s, %u jumps back, %s\n", number, straight.time, jumps, same ? "same" : "DIFFERENT");
+    }
+
+    // one event more than a snapshot holds fails it and saves none of them,
+    // the ones that fit all come out in order
+    EventScheduler events(1);
+    RaceRewind::Pending pending[REWINDCAREVENTS];
+    UInt nPending = REWINDCAREVENTS;
+    for (UInt i = 0; i <= REWINDCAREVENTS; ++i)
+        events.schedule(Event::carRestart, Float(REWINDCAREVENTS - i));
+    if (RaceRewind::saveEvents(events, pending, REWINDCAREVENTS, nPending) || (nPending != 0))
+    {
+        printf("%u events pending saved in room for %u\n", REWINDCAREVENTS + 1, REWINDCAREVENTS);
+        ++nErrors;
+    }
+    Event first;
+    events.popDue(0.0f, first);
+    if (!RaceRewind::saveEvents(events, pending, REWINDCAREVENTS, nPending) || (nPending != REWINDCAREVENTS))
+    {
+        printf("%u events pending not saved in room for %u\n", REWINDCAREVENTS, REWINDCAREVENTS);
+        ++nErrors;
+    }
+    for (UInt i = 0; i < nPending; ++i)
+    {
+        if (pending[i].time != Float(i + 1))
+        {
+            printf("event %u saved due at %.1f\n", i, pending[i].time);
+            ++nErrors;
+        }
+    }
+
+    // an empty ring has nothing to go back to, also after a failed snapshot
+    RaceRewind empty(REWINDSECONDS, REWINDRATE);
+    if (empty.rewind(0) != NULL)
+    {
+        printf("rewound to a snapshot of an empty ring\n");
+        ++nErrors;
+    }
+    empty.capture(0.0f);
+    empty.discard( );
+    if ((empty.rewind(5) != NULL) || (empty.nFrames( ) != 0))
+    {
+        printf("rewound to a discarded snapshot, %u left\n", empty.nFrames( ));
+        ++nErrors;
+    }
+
+    // a full field halfway around, snapshotted over and over into a ring
+    // as long as the default one
+    RaceResult result;
+    Race race;
+    RaceRewind rewind(REWINDSECONDS, REWINDRATE);
+    startRace(settings, track, 0, race, result);
+    while ((race.time < 60.0f) && raceRunning(settings, race))
+        stepRace(settings, track, race, result);
+    UInt nCaptures = 4*rewind.capacity( );
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    ::QueryPerformanceCounter(&start);
+    for (UInt i = 0; i < nCaptures; ++i)
+    {
+        if (!saveRace(race, result, rewind.capture(race.time + i*(1.0f/REWINDRATE))))
+            rewind.discard( );
+    }
+    ::QueryPerformanceCounter(&stop);
+    Double capture = Double(stop.QuadPart - start.QuadPart) / Double(frequency.QuadPart) / nCaptures;
+    ::QueryPerformanceCounter(&start);
+    UInt nRestores = rewind.capacity( );
+    for (UInt i = 0; i < nRestores; ++i)
+        restoreRace(rewind.frame(rewind.find(race.time + (i % REWINDSECONDS))), race, result);
+    ::QueryPerformanceCounter(&stop);
+    Double restore = Double(stop.QuadPart - start.QuadPart) / Double(frequency.QuadPart) / nRestores;
+    endRace(race, result);
+    printf("%u cars: %.2f us per snapshot, %.2f us per rewind, %u bytes per snapshot, "
+           "%u s at %u per second in %.1f MB\n", race.nCars, 1e6*capture, 1e6*restore,
+           UInt(sizeof(RaceRewind::Frame)), REWINDSECONDS, REWINDRATE, rewind.memory( )/1048576.0);
+    printf("%u races, %u jumps back, %u snapshots without room for the events, %u errors\n",
+           settings.races, nRewinds, nDiscarded, nErrors);
+    return (nErrors == 0) ? 0 : 1;
+}
@@ -0,0 +1,299 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// With -surfaces the table in the file (surfaces.cfg by default) has to be
+// the built-in one and broken tables have to give the errors they should.
+// Then every built-in vehicle is driven at random over every surface, by
+// CarPhysics on the table and by the switch it had before, and both have to
+// stay the same to the last bit; then physics steps are timed both ways.
+
+#include "RaceSim.h"
+#include "resource.h"
+#include "SurfaceTable.h"
+
+
+// CarPhysics::step before SurfaceTable, the surfaces written out in it
+static void
+referenceStep(const CarPhysics::Parameters& parameters, CarPhysics::State& state, const CarPhysics::Input& input)
+{
+    Int acceleration = parameters.acceleration;
+    Int deceleration = parameters.deceleration;
+    switch (input.surface)
+    {
+        case Track::gravel:
+            acceleration = (acceleration*2)/3;
+            deceleration = (deceleration*2)/3;
+            break;
+        case Track::water:
+            acceleration = (acceleration*3)/5;
+            deceleration = (deceleration*3)/5;
+            break;
+        case Track::sand:
+            if (parameters.model == CarPhysics::player)
+            {
+                acceleration = acceleration/2;
+                deceleration = (deceleration*3)/2;
+            }
+            else
+            {
+                acceleration = (acceleration*3)/8;
+                deceleration = (deceleration*5)/4;
+            }
+            break;
+        case Track::snow:
+            deceleration = deceleration/2;
+            break;
+        default:
+            break;
+    }
+
+    if (input.throttle == 0)
+        state.thrust = input.brake;
+    else if (input.brake == 0)
+        state.thrust = input.throttle;
+    else if (-input.brake > input.throttle)
+        state.thrust = input.brake;
+    else if (parameters.model == CarPhysics::player)
+        state.thrust = input.throttle;
+
+    Float topspeed = Float(parameters.topspeed);
+    Float factor = 1.0f;
+    if (parameters.model == CarPhysics::player)
+    {
+        if (input.gear > 0)
+            factor = parameters.profile->gearFactor(input.gear, state.speed) / 100.0f;
+        if ((input.steering != 0) && (state.speed > topspeed/2))
+            factor *= 1.0f - (1.5f*state.speed/topspeed)*absval<Int>(input.steering)/100.0f;
+    }
+
+    if (state.thrust > 10)
+        state.speedDiff = PHYSICSSTEP*state.thrust*acceleration*factor;
+    else if (state.thrust < -10)
+        state.speedDiff = PHYSICSSTEP*state.thrust*deceleration;
+    else
+        state.speedDiff = PHYSICSSTEP*-1000.0f;
+    if (state.speedDiff > 0.0f)
+        state.speedDiff *= 2.0f - (topspeed + state.speed)/(2.0f*topspeed);
+    state.speed += state.speedDiff;
+    if (state.speed > topspeed)
+        state.speed = topspeed;
+    if (state.speed < 0.0f)
+        state.speed = 0.0f;
+
+    state.steering = input.steering;
+    Float brakeLimit = (parameters.model == CarPhysics::player) ? 0.0f : 5000.0f;
+    if ((state.thrust < -50) && (state.speed > brakeLimit))
+        state.steering = state.steering*2/3;
+
+    Float steering = Float(parameters.steering);
+    if (input.surface == Track::snow)
+        steering *= 1.44f;
+    state.positionY += state.speed*PHYSICSSTEP;
+    state.positionX += state.steering*PHYSICSSTEP*steering*
+                       ((5000.0f + state.speed*parameters.steeringFactor/100.0f)/topspeed);
+}
+
+
+static Boolean
+sameSurface(const SurfaceTable::Surface& a, const SurfaceTable::Surface& b)
+{
+    for (UInt m = 0; m < 2; ++m)
+        if ((a.grip[m].numerator != b.grip[m].numerator) || (a.grip[m].denominator != b.grip[m].denominator)
+            || (a.braking[m].numerator != b.braking[m].numerator) || (a.braking[m].denominator != b.braking[m].denominator))
+            return false;
+    return (a.drag == b.drag) && (a.steering == b.steering) && (a.sound == b.sound);
+}
+
+
+// a table made of one of these has to give that many errors, and the surface
+// the grip, steering and sound given
+struct SurfaceCase
+{
+    const Char*     text;
+    UInt            nErrors;
+    UInt            surface;
+    Int             numerator;
+    Int             denominator;
+    Int             steering;
+    Int             sound;
+};
+
+static const SurfaceCase surfaceCases[] =
+{
+    { "sand.grip=1/3\r\nsand.steering=90\r\n",          0, Track::sand,    1, 3, 90,  IDR_SAND    },
+    { "  ; comment\n\nsand.grip= 2 / 5 \n",             0, Track::sand,    2, 5, 100, IDR_SAND    },
+    { "water.computergrip=1/2\nwater.sound=snow",       0, Track::water,   3, 5, 100, IDR_SNOW    },
+    { "gravel.grip=2/0\n",                              1, Track::gravel,  2, 3, 100, IDR_GRAVEL  },
+    { "gravel.grip=two thirds\n",                       1, Track::gravel,  2, 3, 100, IDR_GRAVEL  },
+    { "gravel.grip=1/2/3\ngravel.grip=1\n",             2, Track::gravel,  2, 3, 100, IDR_GRAVEL  },
+    { "gravel.grip=1001\n",                             1, Track::gravel,  2, 3, 100, IDR_GRAVEL  },
+    { "mud.grip=1\ngrip=1\n",                           2, Track::asphalt, 1, 1, 100, IDR_ASPHALT },
+    { "snow.wheels=4\nsnow.steering\n",                 2, Track::snow,    1, 1, 144, IDR_SNOW    },
+    { "snow.steering=150\nsnow.steering=160\n",         1, Track::snow,    1, 1, 150, IDR_SNOW    },
+    { "snow.steering=-5\nsnow.drag=1e3\n",              2, Track::snow,    1, 1, 144, IDR_SNOW    },
+    { "snow.sound=lava\nsnow.sound=builtin1\n",         2, Track::snow,    1, 1, 144, IDR_SNOW    }
+};
+#define NSURFACECASES   (sizeof(surfaceCases) / sizeof(surfaceCases[0]))
+
+
+// the table in the file against the built-in one and broken tables against
+// the errors they should give; then every built-in vehicle, as player and
+// computer, driven at random over every surface by CarPhysics and by the
+// switch it had before, to the last bit. Last, both ways are timed
+Int
+checkSurfaces(const Char* filename, UInt nSteps)
+{
+    UInt nErrors = 0;
+    SurfaceTable builtin;
+    SurfaceTable file;
+    if (!file.read(filename))
+    {
+        printf("%s: could not be read\n", filename);
+        ++nErrors;
+    }
+    else if (file.nErrors( ) > 0)
+    {
+        printf("%s(%u): %s, %u errors FAILED\n", filename, file.errorLine( ), file.error( ), file.nErrors( ));
+        ++nErrors;
+    }
+    for (UInt s = 0; s < NSURFACES; ++s)
+    {
+        if (!sameSurface(file.surface(s), builtin.surface(s)))
+        {
+            printf("%s: %s is not the built-in surface FAILED\n", filename, SurfaceTable::name(s));
+            ++nErrors;
+        }
+    }
+
+    UInt nCaseErrors = 0;
+    for (UInt i = 0; i < NSURFACECASES; ++i)
+    {
+        const SurfaceCase& c = surfaceCases[i];
+        SurfaceTable table;
+        table.parse(c.text, UInt(::strlen(c.text)), "case");
+        const SurfaceTable::Surface& surface = table.surface(c.surface);
+        if ((table.nErrors( ) != c.nErrors) || (surface.grip[0].numerator != c.numerator)
+            || (surface.grip[0].denominator != c.denominator) || (surface.steering != c.steering) || (surface.sound != c.sound))
+        {
+            printf("case %u: %u errors (%s), grip %d/%d, steering %d FAILED\n", i + 1, table.nErrors( ), table.error( ),
+                   surface.grip[0].numerator, surface.grip[0].denominator, surface.steering);
+            ++nCaseErrors;
+        }
+    }
+    printf("%u broken tables, %u failed\n", UInt(NSURFACECASES), nCaseErrors);
+    if (nCaseErrors > 0)
+        ++nErrors;
+
+    // CarPhysics takes its numbers from the active table
+    SurfaceTable::load(filename);
+    printf("vehicle  player  computer\n");
+    UInt random = 1;
+    for (UInt v = 0; v < NVEHICLES; ++v)
+    {
+        UInt mismatch[2];
+        for (UInt m = 0; m < 2; ++m)
+        {
+            const Car::Parameters& vehicle = vehicles[v];
+            CarPhysics::Parameters parameters;
+            parameters.model           = (m == 0) ? CarPhysics::player : CarPhysics::computer;
+            parameters.acceleration    = vehicle.acceleration;
+            parameters.deceleration    = vehicle.deceleration;
+            parameters.topspeed        = vehicle.topspeed;
+            parameters.gears           = vehicle.gears;
+            parameters.steering        = vehicle.steering;
+            parameters.steeringFactor  = vehicle.steeringFactor;
+            parameters.profile         = &VehicleProfile::official(v);
+            CarPhysics physics;
+            physics.parameters(parameters);
+            physics.reset(0, 0);
+            CarPhysics::State state = physics.state( );
+            mismatch[m] = 0;
+            for (UInt i = 0; (i < nSteps) && (mismatch[m] == 0); ++i)
+            {
+                // a surface past the last one now and then, which has to handle like asphalt
+                CarPhysics::Input input;
+                input.steering = nextRandom(random, 201) - 100;
+                input.throttle = (nextRandom(random, 3) == 0) ? 0 : nextRandom(random, 101);
+                input.brake    = (nextRandom(random, 3) == 0) ? -nextRandom(random, 101) : 0;
+                input.gear     = (m == 0) ? nextRandom(random, vehicle.gears + 1) : 0;
+                input.surface  = Track::Surface(nextRandom(random, NSURFACES + 1));
+                physics.step(input);
+                referenceStep(parameters, state, input);
+                if (!sameState(&physics.state( ), &state, 1))
+                    mismatch[m] = i + 1;
+            }
+        }
+        Boolean passed = (mismatch[0] == 0) && (mismatch[1] == 0);
+        printf("%7u  %6u  %8u%s\n", v + 1, mismatch[0], mismatch[1], passed ? "" : "  FAILED");
+        if (!passed)
+            ++nErrors;
+    }
+
+    // a field of cars on inputs prepared beforehand, so the steps are timed alone
+    CarPhysics cars[MAXCARS];
+    CarPhysics::Parameters parameters[MAXCARS];
+    for (UInt i = 0; i < MAXCARS; ++i)
+    {
+        UInt v = UInt(nextRandom(random, NVEHICLES));
+        const Car::Parameters& vehicle = vehicles[v];
+        parameters[i].model           = (i == 0) ? CarPhysics::player : CarPhysics::computer;
+        parameters[i].acceleration    = vehicle.acceleration;
+        parameters[i].deceleration    = vehicle.deceleration;
+        parameters[i].topspeed        = vehicle.topspeed;
+        parameters[i].gears           = vehicle.gears;
+        parameters[i].steering        = vehicle.steering;
+        parameters[i].steeringFactor  = vehicle.steeringFactor;
+        parameters[i].profile         = &VehicleProfile::official(v);
+        cars[i].parameters(parameters[i]);
+    }
+    CarPhysics::Input inputs[256];
+    for (UInt i = 0; i < 256; ++i)
+    {
+        inputs[i].steering = nextRandom(random, 201) - 100;
+        inputs[i].throttle = nextRandom(random, 101);
+        inputs[i].brake    = (nextRandom(random, 4) == 0) ? -nextRandom(random, 101) : 0;
+        inputs[i].gear     = 0;
+        inputs[i].surface  = Track::Surface(nextRandom(random, NSURFACES));
+    }
+    LARGE_INTEGER frequency, start, stop;
+    ::QueryPerformanceFrequency(&frequency);
+    Double seconds[2];
+    Double sum[2] = { 0.0, 0.0 };
+    for (UInt way = 0; way < 2; ++way)
+    {
+        CarPhysics::State states[MAXCARS];
+        for (UInt i = 0; i < MAXCARS; ++i)
+        {
+            cars[i].reset(0, 0);
+            states[i] = cars[i].state( );
+        }
+        ::QueryPerformanceCounter(&start);
+        for (UInt s = 0; s < nSteps; ++s)
+        {
+            for (UInt i = 0; i < MAXCARS; ++i)
+            {
+                const CarPhysics::Input& input = inputs[(s + 37*i) & 255];
+                if (way == 0)
+                    referenceStep(parameters[i], states[i], input);
+                else
+                    cars[i].step(input);
+            }
+        }
+        ::QueryPerformanceCounter(&stop);
+        seconds[way] = Double(stop.QuadPart - start.QuadPart) / Double(frequency.QuadPart);
+        for (UInt i = 0; i < MAXCARS; ++i)
+            sum[way] += (way == 0) ? states[i].positionY : cars[i].state( ).positionY;
+    }
+    Double n = Double(nSteps) * MAXCARS;
+    printf("%.0f physics steps: switch %.1f ns, table %.1f ns per step, %.1f M and %.1f M steps/s%s\n",
+           n, 1e9*seconds[0]/n, 1e9*seconds[1]/n, (seconds[0] > 0.0) ? n/seconds[0]/1e6 : 0.0,
+           (seconds[1] > 0.0) ? n/seconds[1]/1e6 : 0.0, (sum[0] == sum[1]) ? "" : ", results differ FAILED");
+    if (sum[0] != sum[1])
+        ++nErrors;
+    printf("%u vehicles checked, %u errors\n", NVEHICLES, nErrors);
+    return (nErrors == 0) ? 0 : 1;
+}
@@ -0,0 +1,401 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// With -vehicles every .vhc in the directory (Vehicles by default) is read
+// by VehicleDefinition and the way Car read it before, the built-in vehicles
+// are written out and read back, broken files are checked against the errors
+// they should give, and files made up by changing the others at random have
+// to give a usable vehicle. Last, reading the files is timed.
+
+#include "RaceSim.h"
+#include "VehicleDefinition.h"
+
+// vehicle files read each way when timing -vehicles
+#define VEHICLEBENCHREADS 20000
+
+
+// how Car read a custom vehicle before VehicleDefinition, scanning the file
+// again for every field
+static void
+referenceRead(const Char* filename, VehicleDefinition& result)
+{
+    result.reset( );
+    File file((Char*)filename, File::read);
+    if (!file.opened( ))
+        return;
+    file.readInt("acceleration", result.acceleration, 10);
+    file.readInt("deceleration", result.deceleration, 40);
+    file.readInt("topspeed", result.topspeed, 15000);
+    file.readInt("idlefreq", result.idlefreq, 11000);
+    file.readInt("topfreq", result.topfreq, 50000);
+    file.readInt("shiftfreq", result.shiftfreq, 40000);
+    file.readInt("numberofgears", result.gears, 5);
+    file.readInt("steering", result.steering, 100);
+    file.readInt("steeringfactor", result.steeringFactor, 40);
+    file.readInt("haswipers", result.hasWipers, 1);
+    const Char* fields[] = { "enginesound", "throttlesound", "startsound", "hornsound", "backfiresound",
+                             "crashsound", "brakesound" };
+    const Char* defaults[] = { "builtin1", "", "builtin1", "builtin1", "", "builtin1", "builtin1" };
+    Char* sounds[] = { result.engineSound, result.throttleSound, result.startSound, result.hornSound,
+                       result.backfireSound, result.crashSound, result.brakeSound };
+    for (UInt i = 0; i < 7; ++i)
+    {
+        Char value[MAX_PATH];
+        file.readString((Char*)fields[i], value, 128, (Char*)defaults[i]);
+        strncpy(sounds[i], value, VEHICLESTRINGSIZE - 1);
+        sounds[i][VEHICLESTRINGSIZE - 1] = '\0';
+    }
+}
+
+
+// the same from memory, for the files the fuzzing makes up: the first line
+// naming a field exactly sets it, numbers are read by atoi
+static void
+referenceParse(const std::vector<Char>& text, VehicleDefinition& result)
+{
+    result.reset( );
+    const Char* fields[] = { "acceleration", "deceleration", "topspeed", "idlefreq", "topfreq", "shiftfreq",
+                             "numberofgears", "steering", "steeringfactor", "haswipers",
+                             "enginesound", "throttlesound", "startsound", "hornsound", "backfiresound",
+                             "crashsound", "brakesound" };
+    Int* values[] = { &result.acceleration, &result.deceleration, &result.topspeed, &result.idlefreq,
+                      &result.topfreq, &result.shiftfreq, &result.gears, &result.steering,
+                      &result.steeringFactor, &result.hasWipers };
+    Char* sounds[] = { result.engineSound, result.throttleSound, result.startSound, result.hornSound,
+                       result.backfireSound, result.crashSound, result.brakeSound };
+    Boolean found[17] = { false };
+    std::string line;
+    for (UInt i = 0; i <= text.size( ); ++i)
+    {
+        if ((i < text.size( )) && (text[i] != '\n'))
+        {
+            line += text[i];
+            continue;
+        }
+        if ((!line.empty( )) && (line[line.size( ) - 1] == '\r'))
+            line.erase(line.size( ) - 1);
+        std::string::size_type equals = line.find('=');
+        for (UInt f = 0; (equals != std::string::npos) && (f < 17); ++f)
+        {
+            if ((found[f]) || (line.compare(0, equals, fields[f]) != 0))
+                continue;
+            found[f] = true;
+            std::string value = line.substr(equals + 1);
+            if (f < 10)
+                *values[f] = atoi(value.c_str( ));
+            else
+            {
+                strncpy(sounds[f - 10], value.c_str( ), VEHICLESTRINGSIZE - 1);
+                sounds[f - 10][VEHICLESTRINGSIZE - 1] = '\0';
+            }
+        }
+        line.clear( );
+    }
+}
+
+
+static Boolean
+sameVehicle(const VehicleDefinition& a, const VehicleDefinition& b)
+{
+    return (a.acceleration == b.acceleration) && (a.deceleration == b.deceleration) &&
+           (a.topspeed == b.topspeed) && (a.idlefreq == b.idlefreq) && (a.topfreq == b.topfreq) &&
+           (a.shiftfreq == b.shiftfreq) && (a.gears == b.gears) && (a.steering == b.steering) &&
+           (a.steeringFactor == b.steeringFactor) && (a.hasWipers == b.hasWipers) &&
+           (strcmp(a.engineSound, b.engineSound) == 0) && (strcmp(a.throttleSound, b.throttleSound) == 0) &&
+           (strcmp(a.startSound, b.startSound) == 0) && (strcmp(a.hornSound, b.hornSound) == 0) &&
+           (strcmp(a.backfireSound, b.backfireSound) == 0) && (strcmp(a.crashSound, b.crashSound) == 0) &&
+           (strcmp(a.brakeSound, b.brakeSound) == 0);
+}
+
+
+// what Car can be handed whatever the file said: names it can print into a
+// path and built-in sounds of vehicles that exist
+static Boolean
+usableVehicle(const VehicleDefinition& definition)
+{
+    const Char* sounds[] = { definition.engineSound, definition.throttleSound, definition.startSound,
+                             definition.hornSound, definition.backfireSound, definition.crashSound,
+                             definition.brakeSound };
+    for (UInt i = 0; i < 7; ++i)
+    {
+        if (memchr(sounds[i], '\0', VEHICLESTRINGSIZE) == NULL)
+            return false;
+        if ((strncmp(sounds[i], "builtin", 7) == 0) && ((atoi(sounds[i] + 7) < 1) || (atoi(sounds[i] + 7) > NVEHICLES)))
+            return false;
+    }
+    return true;
+}
+
+
+// a vehicle written the way a player would write a custom one, with the
+// sounds of the built-in vehicle it is or was made from
+void
+vehicleText(const Car::Parameters& p, UInt vehicle, std::vector<Char>& text)
+{
+    Char buffer[1024];
+    UInt n = 1 + vehicle % NVEHICLES;
+    _snprintf(buffer, sizeof(buffer) - 1,
+              "; vehicle %u\r\nenginesound=builtin%u\r\n;throttlesound=\r\nstartsound=builtin%u\r\n"
+              "hornsound=builtin%u\r\ncrashsound=builtin%u\r\nbrakesound=builtin%u\r\n"
+              "acceleration=%d\r\ndeceleration=%d\r\ntopspeed=%d\r\nidlefreq=%d\r\ntopfreq=%d\r\n"
+              "shiftfreq=%d\r\nnumberofgears=%d\r\nsteering=%d\r\nsteeringfactor=%d\r\nhaswipers=%d\r\n",
+              vehicle + 1, n, n, n, n, n, p.acceleration, p.deceleration, p.topspeed, p.idlefreq, p.topfreq,
+              p.shiftfreq, p.gears, p.steering, p.steeringFactor, p.hasWipers);
+    buffer[sizeof(buffer) - 1] = '\0';
+    text.assign(buffer, buffer + strlen(buffer));
+}
+
+
+// one to four changes of the kind a hand edited or damaged file has
+static void
+mutate(std::vector<Char>& text, UInt& random)
+{
+    static const Char alphabet[] = "=\n\r; \t-+0123456789builtinx\0\xff";
+    UInt nChanges = 1 + nextRandom(random, 4);
+    for (UInt c = 0; c < nChanges; ++c)
+    {
+        Int size = Int(text.size( ));
+        Int at = (size > 0) ? nextRandom(random, size) : 0;
+        switch (nextRandom(random, 7))
+        {
+        case 0 :
+            if (size > 0)
+                text[at] = alphabet[nextRandom(random, sizeof(alphabet))];
+            break;
+        case 1 :
+            text.insert(text.begin( ) + at, alphabet[nextRandom(random, sizeof(alphabet))]);
+            break;
+        case 2 :
+            text.erase(text.begin( ) + at, text.begin( ) + (std::min)(size, at + 1 + nextRandom(random, 16)));
+            break;
+        case 3 :
+        {
+            Int length = (std::min)(size - at, 1 + nextRandom(random, 40));
+            std::vector<Char> copy(text.begin( ) + at, text.begin( ) + at + length);
+            text.insert(text.begin( ) + nextRandom(random, size + 1), copy.begin( ), copy.end( ));
+            break;
+        }
+        case 4 :
+            text.resize(at);
+            break;
+        case 5 :
+            text.insert(text.begin( ) + at, 40 + nextRandom(random, 200), Char('a' + nextRandom(random, 26)));
+            break;
+        default :
+        {
+            Char digits[32];
+            _snprintf(digits, sizeof(digits) - 1, "builtin%d", nextRandom(random, 30) - 5);
+            digits[sizeof(digits) - 1] = '\0';
+            text.insert(text.begin( ) + at, digits, digits + strlen(digits));
+            break;
+        }
+        }
+    }
+}
+
+
+struct VehicleCase
+{
+    const Char*     text;
+    UInt            size;
+    UInt            nErrors;
+    UInt            errorLine;
+    Int             topspeed;
+    const Char*     engineSound;
+};
+
+// malformed files and what has to come out of them
+static const VehicleCase vehicleCases[] =
+{
+    { "",                                               0,  0, 0, 15000, "builtin1" },
+    { "topspeed=21000",                                 14, 0, 0, 21000, "builtin1" },
+    { ";topspeed=1\r\n\r\n  \r\ntopspeed=2\r\n",        31, 0, 0, 2,     "builtin1" },
+    { "topspeed=fast\n",                                14, 1, 1, 15000, "builtin1" },
+    { "topspeed=\n",                                    10, 1, 1, 15000, "builtin1" },
+    { "topspeed= 300 \n",                               15, 0, 0, 300,   "builtin1" },
+    { "topspeed=12abc\n",                               15, 1, 1, 15000, "builtin1" },
+    { "topspeed=99999999999\n",                         21, 1, 1, 15000, "builtin1" },
+    { "topspeed=100\ntopspeed=200\n",                   26, 1, 2, 100,   "builtin1" },
+    { "steering=3\nnumberofgears\ntopspeed=5\n",        36, 1, 2, 5,     "builtin1" },
+    { "TopSpeed=5\n",                                   11, 1, 1, 15000, "builtin1" },
+    { "topspeed=1\0\n",                                 12, 1, 1, 15000, "builtin1" },
+    { "enginesound=builtin12\n",                        22, 0, 0, 15000, "builtin12" },
+    { "enginesound=builtin13\n",                        22, 1, 1, 15000, "builtin1" },
+    { "enginesound=builtin0\n",                         21, 1, 1, 15000, "builtin1" },
+    { "enginesound=builtin\n",                          20, 1, 1, 15000, "builtin1" },
+    { "enginesound=builtin-3\n",                        22, 1, 1, 15000, "builtin1" },
+    { "\n\nenginesound=my engine.wav\n",                28, 0, 0, 15000, "my engine.wav" },
+    { "enginesound=engine\x01.wav\n",                   24, 1, 1, 15000, "builtin1" },
+    { "enginesound=aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\n",
+                                                        81, 1, 1, 15000, "builtin1" }
+};
+
+
+// the custom vehicles in a directory read both ways, made up broken ones,
+// and how long reading takes
+Int
+checkVehicles(const Char* directory, UInt nMutations)
+{
+    UInt nErrors = 0;
+
+    // the files on disk, every field as Car read it before
+    std::vector<std::string> files;
+    Char pattern[MAX_PATH];
+    _snprintf(pattern, sizeof(pattern) - 1, "%s\\*.vhc", directory);
+    pattern[sizeof(pattern) - 1] = '\0';
+    WIN32_FIND_DATA findFileData;
+    HANDLE find = ::FindFirstFile(pattern, &findFileData);
+    if (find != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            if (!(findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+                files.push_back(std::string(directory) + "\\" + findFileData.cFileName);
+        }
+        while (::FindNextFile(find, &findFileData));
+        ::FindClose(find);
+    }
+    std::sort(files.begin( ), files.end( ));
+    std::vector<std::vector<Char> > seeds;
+    for (UInt i = 0; i < files.size( ); ++i)
+    {
+        VehicleDefinition definition;
+        VehicleDefinition reference;
+        Boolean read = definition.read(files[i].c_str( ));
+        referenceRead(files[i].c_str( ), reference);
+        Boolean same = sameVehicle(definition, reference);
+        printf("%s: %u errors%s%s%s\n", files[i].c_str( ), definition.nErrors( ),
+               (definition.nErrors( ) > 0) ? ", first " : "", definition.error( ),
+               (!read || (definition.nErrors( ) == 0 && !same)) ? "  FAILED" : (same ? "" : "  (differs, see errors)"));
+        if (!read || ((definition.nErrors( ) == 0) && !same))
+            ++nErrors;
+        FILE* file = fopen(files[i].c_str( ), "rb");
+        if (file != NULL)
+        {
+            std::vector<Char> text;
+            Char buffer[4096];
+            size_t n;
+            while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+                text.insert(text.end( ), buffer, buffer + n);
+            fclose(file);
+            seeds.push_back(text);
+        }
+    }
+
+    // the built-in vehicles written out and read back
+    for (UInt v = 0; v < NVEHICLES; ++v)
+    {
+        std::vector<Char> text;
+        vehicleText(vehicles[v], v, text);
+        VehicleDefinition definition;
+        definition.parse(&text[0], UInt(text.size( )), "built-in");
+        const Car::Parameters& p = vehicles[v];
+        if ((definition.nErrors( ) != 0) || (definition.acceleration != p.acceleration) ||
+            (definition.deceleration != p.deceleration) || (definition.topspeed != p.topspeed) ||
+            (definition.idlefreq != p.idlefreq) || (definition.topfreq != p.topfreq) ||
+            (definition.shiftfreq != p.shiftfreq) || (definition.gears != p.gears) ||
+            (definition.steering != p.steering) || (definition.steeringFactor != p.steeringFactor) ||
+            (definition.hasWipers != p.hasWipers))
+        {
+            printf("built-in vehicle %u does not read back  FAILED\n", v + 1);
+            ++nErrors;
+        }
+        seeds.push_back(text);
+    }
+
+    // broken files with known answers
+    for (UInt i = 0; i < sizeof(vehicleCases) / sizeof(vehicleCases[0]); ++i)
+    {
+        const VehicleCase& c = vehicleCases[i];
+        VehicleDefinition definition;
+        definition.parse(c.text, c.size, "case");
+        if ((definition.nErrors( ) != c.nErrors) || (definition.errorLine( ) != c.errorLine) ||
+            (definition.topspeed != c.topspeed) || (strcmp(definition.engineSound, c.engineSound) != 0))
+        {
+            printf("case %u: %u errors, line %u, topspeed %d, engine '%s'  FAILED\n", i, definition.nErrors( ),
+                   definition.errorLine( ), definition.topspeed, definition.engineSound);
+            ++nErrors;
+        }
+    }
+
+    // made up broken files: whatever is in them the result is usable, reading
+    // twice gives the same, and a file without errors reads as it did before
+    UInt random = 1;
+    UInt nClean = 0;
+    UInt nFuzzErrors = 0;
+    for (UInt m = 0; m < nMutations; ++m)
+    {
+        std::vector<Char> text = seeds[m % seeds.size( )];
+        mutate(text, random);
+        // kept apart from the rest, so reading past the end shows
+        Char* copy = new Char[text.size( ) + 1];
+        if (!text.empty( ))
+            memcpy(copy, &text[0], text.size( ));
+        VehicleDefinition definition;
+        VehicleDefinition again;
+        VehicleDefinition reference;
+        definition.parse(copy, UInt(text.size( )), "mutation");
+        again.parse(copy, UInt(text.size( )), "mutation");
+        referenceParse(text, reference);
+        SAFE_DELETE_ARRAY(copy);
+        Boolean clean = (definition.nErrors( ) == 0);
+        if (clean)
+            ++nClean;
+        if (!usableVehicle(definition) || !sameVehicle(definition, again) ||
+            (again.nErrors( ) != definition.nErrors( )) || (clean && !sameVehicle(definition, reference)))
+        {
+            if (nFuzzErrors++ < 10)
+                printf("mutation %u (%u bytes, %u errors) FAILED\n", m, UInt(text.size( )), definition.nErrors( ));
+        }
+    }
+    printf("%u mutations, %u without errors, %u failed\n", nMutations, nClean, nFuzzErrors);
+    if (nFuzzErrors > 0)
+        ++nErrors;
+
+    // reading the files on disk: field by field as before, in one pass, from
+    // the cache, and parsing alone from memory
+    if (!files.empty( ))
+    {
+        UInt nReads = (std::max)(UInt(1), UInt(VEHICLEBENCHREADS / files.size( )));
+        LARGE_INTEGER frequency, start, stop;
+        ::QueryPerformanceFrequency(&frequency);
+        Double seconds[4];
+        UInt sum = 0;
+        UInt bytes = 0;
+        for (UInt way = 0; way < 4; ++way)
+        {
+            ::QueryPerformanceCounter(&start);
+            for (UInt r = 0; r < nReads; ++r)
+            {
+                for (UInt i = 0; i < files.size( ); ++i)
+                {
+                    VehicleDefinition definition;
+                    if (way == 0)
+                        referenceRead(files[i].c_str( ), definition);
+                    else if (way == 1)
+                        definition.read(files[i].c_str( ));
+                    else if (way == 2)
+                        sum += VehicleDefinition::cached(files[i].c_str( ))->topspeed;
+                    else
+                    {
+                        definition.parse(&seeds[i][0], UInt(seeds[i].size( )));
+                        bytes += UInt(seeds[i].size( ));
+                    }
+                    sum += definition.topspeed;
+                }
+            }
+            ::QueryPerformanceCounter(&stop);
+            seconds[way] = Double(stop.QuadPart - start.QuadPart) / Double(frequency.QuadPart);
+        }
+        Double n = Double(nReads) * files.size( );
+        printf("%.0f reads: by field %.2f us, one pass %.2f us, cached %.2f us, parse %.2f us per file, "
+               "%.0f MB/s (%u)\n", n, 1e6*seconds[0]/n, 1e6*seconds[1]/n, 1e6*seconds[2]/n, 1e6*seconds[3]/n,
+               (seconds[3] > 0.0) ? bytes / seconds[3] / 1e6 : 0.0, sum & 1);
+    }
+    printf("%u files checked, %u errors\n", UInt(files.size( )), nErrors);
+    return (nErrors == 0) ? 0 : 1;
+}
@@ -0,0 +1,290 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// Replays races recorded by racesim (-record) through the race server's
+// broadcast, once the way it used to go, a PacketPlayerData per player, and
+// once as snapshots, and reports the bytes per second every client receives:
+//
+//     snapbench [-loss <percent>] [-latency <updates>] [-overhead <bytes>]
+//               [-seed <n>] <recording>
+//
+// Snapshots and their acknowledgements are dropped 'loss' percent of the time
+// and an acknowledgement reaches the server 'latency' updates after the
+// snapshot was sent. Every snapshot that gets through is checked against what
+// was encoded. 'overhead' is added per datagram for the UDP transport, UDP and
+// IP headers.
+
+#include "Snapshot.h"
+#include <vector>
+
+#define RECORDINTERVAL      0.1f
+// UdpTransport header, UDP header and IPv4 header
+#define DATAGRAMOVERHEAD    (12 + 8 + 20)
+
+
+struct Settings
+{
+    UInt            loss;
+    UInt            latency;
+    UInt            overhead;
+    UInt            seed;
+    Char            recording[MAX_PATH];
+};
+
+struct Traffic
+{
+    UHuge           bytes;
+    UHuge           datagrams;
+};
+
+struct Ack
+{
+    UInt            due;
+    UShort          sequence;
+};
+
+struct Totals
+{
+    Double          clientSeconds;
+    Traffic         old;
+    Traffic         snapshots;
+    Traffic         acks;
+    UHuge           sent;
+    UHuge           decoded;
+    UHuge           full;
+    UHuge           mismatches;
+    Double          encodeTime;
+    Double          decodeTime;
+};
+
+
+static Huge
+ticks( )
+{
+    LARGE_INTEGER now;
+    ::QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+
+static Double
+ticksPerSec( )
+{
+    LARGE_INTEGER frequency;
+    ::QueryPerformanceFrequency(&frequency);
+    return Double(frequency.QuadPart);
+}
+
+
+// Park-Miller, like racesim
+static UInt
+nextRandom(UInt& state, UInt max)
+{
+    state = UInt((Huge(state) * 48271) % 2147483647);
+    return state % max;
+}
+
+
+static Boolean
+racer(const PlayerData& data)
+{
+    return (data.state == awaitingStart) || (data.state == racing) || (data.state == finished);
+}
+
+
+static Boolean
+same(const PlayerData& a, const PlayerData& b)
+{
+    return (a.id == b.id) && (a.car == b.car) && (a.state == b.state) && (a.posX == b.posX) &&
+           (a.posY == b.posY) && (a.speed == b.speed) && (a.frequency == b.frequency) &&
+           (a.engineRunning == b.engineRunning) && (a.braking == b.braking) &&
+           (a.horning == b.horning) && (a.backfiring == b.backfiring);
+}
+
+
+static void
+replay(const Settings& settings, const PlayerData* frames, UInt nFrames, UInt& random, Totals& totals)
+{
+    Double perSec = ticksPerSec( );
+    SnapshotEncoder encoder[NMAXPLAYERS];
+    SnapshotDecoder decoder[NMAXPLAYERS];
+    std::vector<Ack> acks[NMAXPLAYERS];
+    for (UInt frame = 0; frame < nFrames; ++frame)
+    {
+        const PlayerData* players = frames + frame*NMAXPLAYERS;
+        Snapshot snapshot;
+        snapshot.clear( );
+        UInt nPresent = 0;
+        for (UInt i = 0; i < NMAXPLAYERS; ++i)
+        {
+            if ((players[i].state != undefined) && (players[i].state != notReady))
+            {
+                snapshot.set(players[i]);
+                ++nPresent;
+            }
+        }
+        for (UInt to = 0; to < NMAXPLAYERS; ++to)
+        {
+            if (!racer(players[to]))
+                continue;
+            totals.clientSeconds += RECORDINTERVAL;
+
+            // the acknowledgements that arrive by now
+            std::vector<Ack>& pending = acks[to];
+            for (UInt i = 0; i < pending.size( ); )
+            {
+                if (pending[i].due <= frame)
+                {
+                    encoder[to].acknowledge(pending[i].sequence);
+                    pending.erase(pending.begin( ) + i);
+                }
+                else
+                    ++i;
+            }
+
+            // the old way, a packet per other player
+            UInt nOthers = nPresent - (((snapshot.present & (1 << to)) != 0) ? 1 : 0);
+            totals.old.bytes     += nOthers * (sizeof(PacketPlayerData) + settings.overhead);
+            totals.old.datagrams += nOthers;
+
+            Snapshot others = snapshot;
+            others.present &= ~(1 << to);
+            PacketSnapshot packet;
+            Huge start = ticks( );
+            UInt size = encoder[to].encode(others, packet);
+            totals.encodeTime += (ticks( ) - start) / perSec;
+            totals.snapshots.bytes += size + settings.overhead;
+            ++totals.snapshots.datagrams;
+            ++totals.sent;
+            if (nextRandom(random, 100) < settings.loss)
+                continue;
+
+            start = ticks( );
+            const Snapshot* decoded = decoder[to].decode(&packet, size);
+            totals.decodeTime += (ticks( ) - start) / perSec;
+            if (decoded == 0)
+                continue;
+            ++totals.decoded;
+            for (UInt i = 0; i < NMAXPLAYERS; ++i)
+            {
+                PlayerData expected, received;
+                Boolean hasExpected = others.get(i, expected);
+                Boolean hasReceived = decoded->get(i, received);
+                if ((hasExpected != hasReceived) || ((hasExpected) && (!same(expected, received))))
+                    ++totals.mismatches;
+            }
+            totals.acks.bytes += sizeof(PacketSnapshotAck) + settings.overhead;
+            ++totals.acks.datagrams;
+            if (nextRandom(random, 100) < settings.loss)
+                continue;
+            Ack ack;
+            ack.due      = frame + settings.latency;
+            ack.sequence = decoded->sequence;
+            pending.push_back(ack);
+        }
+    }
+    for (UInt i = 0; i < NMAXPLAYERS; ++i)
+        totals.full += encoder[i].nFull( );
+}
+
+
+static Boolean
+parseArguments(int argc, char* argv[], Settings& settings)
+{
+    settings.loss         = 0;
+    settings.latency      = 1;
+    settings.overhead     = DATAGRAMOVERHEAD;
+    settings.seed         = 1;
+    settings.recording[0] = '\0';
+    for (Int i = 1; i < argc; ++i)
+    {
+        const Char* option = argv[i];
+        if (option[0] != '-')
+        {
+            _snprintf(settings.recording, sizeof(settings.recording) - 1, "%s", option);
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        const Char* value = argv[++i];
+        if (strcmp(option, "-loss") == 0)
+            settings.loss = atoi(value);
+        else if (strcmp(option, "-latency") == 0)
+            settings.latency = atoi(value);
+        else if (strcmp(option, "-overhead") == 0)
+            settings.overhead = atoi(value);
+        else if (strcmp(option, "-seed") == 0)
+            settings.seed = UInt(strtoul(value, NULL, 10));
+        else
+            return false;
+    }
+    if (settings.seed == 0)
+        settings.seed = 1;
+    return (settings.recording[0] != '\0') && (settings.loss < 100);
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    Settings settings;
+    if (!parseArguments(argc, argv, settings))
+    {
+        printf("usage: snapbench [-loss <percent>] [-latency <updates>] [-overhead <bytes>]\n");
+        printf("                 [-seed <n>] <recording>\n");
+        return 2;
+    }
+    FILE* in = fopen(settings.recording, "rb");
+    if (in == NULL)
+    {
+        fprintf(stderr, "%s: could not read\n", settings.recording);
+        return 1;
+    }
+
+    Totals totals;
+    ::memset(&totals, 0, sizeof(totals));
+    UInt random = settings.seed;
+    UInt nRaces = 0;
+    std::vector<PlayerData> frames;
+    UInt nFrames;
+    while (fread(&nFrames, sizeof(nFrames), 1, in) == 1)
+    {
+        frames.resize(nFrames*NMAXPLAYERS);
+        if ((nFrames > 0) && (fread(&frames[0], sizeof(PlayerData), frames.size( ), in) != frames.size( )))
+        {
+            fprintf(stderr, "%s: race %u is cut short\n", settings.recording, nRaces);
+            break;
+        }
+        if (nFrames > 0)
+            replay(settings, &frames[0], nFrames, random, totals);
+        ++nRaces;
+    }
+    fclose(in);
+    if (totals.clientSeconds <= 0.0)
+    {
+        fprintf(stderr, "%s: no races recorded\n", settings.recording);
+        return 1;
+    }
+
+    Double seconds = totals.clientSeconds;
+    Double oldRate = totals.old.bytes / seconds;
+    Double newRate = totals.snapshots.bytes / seconds;
+    printf("%u races, %.0f client seconds, %u%% loss, acknowledged after %u updates, %u bytes per datagram\n",
+           nRaces, seconds, settings.loss, settings.latency, settings.overhead);
+    printf("player data  : %8.0f bytes/s %6.1f datagrams/s per client\n",
+           oldRate, totals.old.datagrams / seconds);
+    printf("snapshots    : %8.0f bytes/s %6.1f datagrams/s per client, %.1f%% of player data\n",
+           newRate, totals.snapshots.datagrams / seconds, (oldRate > 0.0) ? 100.0 * newRate / oldRate : 0.0);
+    printf("acknowledged : %8.0f bytes/s %6.1f datagrams/s per client upstream\n",
+           totals.acks.bytes / seconds, totals.acks.datagrams / seconds);
+    printf("decoded %llu of %llu snapshots, %llu full, %llu mismatches\n",
+           totals.decoded, totals.sent, totals.full, totals.mismatches);
+    printf("encode %.2f us, decode %.2f us per snapshot\n",
+           (totals.sent > 0) ? 1e6 * totals.encodeTime / totals.sent : 0.0,
+           (totals.decoded > 0) ? 1e6 * totals.decodeTime / totals.decoded : 0.0);
+    return (totals.mismatches == 0) ? 0 : 1;
+}
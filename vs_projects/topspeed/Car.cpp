@@ -5,6 +5,7 @@
 #include "resource.h"
 #include "RaceInput.h"
 #include "CarDefs.h"
+#include "VehicleDefinition.h"
 
 #define MAXSURFACEFREQ 100000
 
@@ -33,7 +34,6 @@ Car::Car(Game* game, Track* track, UInt vehicle, Char* vehicleFile) :
     m_soundBackfire(0),
     m_backfirePlayed(false),
     m_backfirePlayedAuto(false),
-    m_thrust(0),
     m_prevFrequency(0),
     m_prevBrakeFrequency(0),
     m_brakeFrequency(0),
@@ -46,15 +46,11 @@ Car::Car(Game* game, Track* track, UInt vehicle, Char* vehicleFile) :
     m_currentSteering(0),
     m_currentThrottle(0),
     m_currentBrake(0),
-    m_currentAcceleration(0),
-    m_currentDeceleration(0),
-    m_speedDiff(0),
-    m_factor1(100),
-    m_factor2(1.0),
     m_speed(0),
     m_frame(1),
     m_throttleVolume(0.0f),
     m_userDefined(false),
+    m_profile(0),
     m_soundEngine(0),
     m_soundStart(0),
     m_soundHorn(0),
@@ -76,6 +72,7 @@ Car::Car(Game* game, Track* track, UInt vehicle, Char* vehicleFile) :
         m_gears         = officialParameters.gears;
         m_steering      = officialParameters.steering;
         m_steeringFactor= officialParameters.steeringFactor;
+        m_profile       = &VehicleProfile::official(vehicle);
         m_frequency     = m_idlefreq;
         m_soundEngine   = m_soundManager->create(officialParameters.engineSound);
         // m_soundEngine->playInSoftware(true);
@@ -100,34 +97,25 @@ Car::Car(Game* game, Track* track, UInt vehicle, Char* vehicleFile) :
         Int length = ::strlen(vehicleFile);
         ::strncpy(m_customFile, vehicleFile, length-4);
         m_customFile[length-4] = '\0';
-        File file(vehicleFile, File::read);
-        file.readInt("acceleration", m_acceleration, 10);
-        file.readInt("deceleration", m_deceleration, 40);
-        file.readInt("topspeed", m_topspeed, 15000);
-        file.readInt("idlefreq", m_idlefreq, 11000);
-        file.readInt("topfreq", m_topfreq, 50000);
-        file.readInt("shiftfreq", m_shiftfreq, 40000);
-        file.readInt("numberofgears", m_gears, 5);
-        file.readInt("steering", m_steering, 100);
-        file.readInt("steeringfactor", m_steeringFactor, 40);
-        Char    engineSound[64];
-        Char    throttleSound[64];
-        Char    startSound[64];
-        Char    hornSound[64];
-        Char    backfireSound[64];
-        Char    crashSound[64];
-//        Char    monoCrashSound[64];
-        Char    brakeSound[64];
-        file.readString("enginesound", engineSound, 128, "builtin1");
-        file.readString("throttlesound", throttleSound, 128, "");
-        file.readString("startsound", startSound, 128, "builtin1");
-        file.readString("hornsound", hornSound, 128, "builtin1");
-        file.readString("backfiresound", backfireSound, 128, "");
-        file.readString("crashsound", crashSound, 128, "builtin1");
-//        file.readString("monoCrashsound", monoCrashSound, 128, "builtin1");
-        file.readString("brakesound", brakeSound, 128, "builtin1");
+        const VehicleDefinition* definition = VehicleDefinition::cached(vehicleFile);
+        m_acceleration   = definition->acceleration;
+        m_deceleration   = definition->deceleration;
+        m_topspeed       = definition->topspeed;
+        m_idlefreq       = definition->idlefreq;
+        m_topfreq        = definition->topfreq;
+        m_shiftfreq      = definition->shiftfreq;
+        m_gears          = definition->gears;
+        m_steering       = definition->steering;
+        m_steeringFactor = definition->steeringFactor;
+        const Char* engineSound   = definition->engineSound;
+        const Char* throttleSound = definition->throttleSound;
+        const Char* startSound    = definition->startSound;
+        const Char* hornSound     = definition->hornSound;
+        const Char* backfireSound = definition->backfireSound;
+        const Char* crashSound    = definition->crashSound;
+        const Char* brakeSound    = definition->brakeSound;
         if (m_track->weather() == Track::rain)
-            file.readInt("haswipers", m_hasWipers, 1);
+            m_hasWipers = definition->hasWipers;
 
         m_carType	  = (CarType)0; // default value
 
@@ -241,17 +229,34 @@ Car::Car(Game* game, Track* track, UInt vehicle, Char* vehicleFile) :
         }
     }
 
+    if (m_userDefined)
+    {
+        m_customProfile.build(m_topspeed, m_gears, m_idlefreq, m_topfreq, m_shiftfreq);
+        m_profile = &m_customProfile;
+    }
+    CarPhysics::Parameters physics;
+    physics.model           = CarPhysics::player;
+    physics.acceleration    = m_acceleration;
+    physics.deceleration    = m_deceleration;
+    physics.topspeed        = m_topspeed;
+    physics.gears           = m_gears;
+    physics.steering        = m_steering;
+    physics.steeringFactor  = m_steeringFactor;
+    physics.profile         = m_profile;
+    m_physics.parameters(physics);
+
     if (m_hasWipers == 1)
         m_soundWipers	= m_soundManager->create(IDR_WIPERS);
-    m_soundAsphalt  = m_soundManager->create(IDR_ASPHALT);
+    const SurfaceTable& surfaces = SurfaceTable::active( );
+    m_soundAsphalt  = m_soundManager->create(surfaces.surface(Track::asphalt).sound);
     m_soundAsphalt->playInSoftware(true);
-    m_soundGravel   = m_soundManager->create(IDR_GRAVEL);
+    m_soundGravel   = m_soundManager->create(surfaces.surface(Track::gravel).sound);
     m_soundGravel->playInSoftware(true);
-    m_soundWater    = m_soundManager->create(IDR_WATER);
+    m_soundWater    = m_soundManager->create(surfaces.surface(Track::water).sound);
     m_soundWater->playInSoftware(true);
-    m_soundSand   = m_soundManager->create(IDR_SAND);
+    m_soundSand   = m_soundManager->create(surfaces.surface(Track::sand).sound);
     m_soundSand->playInSoftware(true);
-    m_soundSnow   = m_soundManager->create(IDR_SNOW);
+    m_soundSnow   = m_soundManager->create(surfaces.surface(Track::snow).sound);
     m_soundSnow->playInSoftware(true);
     m_soundMiniCrash= m_soundManager->create(IDR_CRASH_SHORT);
     m_soundBump1    = m_soundManager->create(IDR_BUMP1);
@@ -326,6 +331,7 @@ Car::initialize(Int positionX, Int positionY)
     RACE("Car::initialize");
     m_positionX = positionX;
     m_positionY = positionY;
+    m_physics.reset(positionX, positionY);
     m_laneWidth = m_track->laneWidth()*2;
     if (m_effectSpring)
         m_effectSpring->play( );
@@ -560,37 +566,11 @@ Car::run(Float elapsed)
         Boolean gearUp      = m_game->raceInput()->getGearUp( );
         Boolean gearDown    = m_game->raceInput()->getGearDown( );
         
-        m_currentAcceleration = m_acceleration;
-        m_currentDeceleration = m_deceleration;
-        m_speedDiff = 0;
-        switch (m_surface)
-        {
-            case Track::gravel:
-                m_currentAcceleration = (m_currentAcceleration*2)/3;
-                m_currentDeceleration = (m_currentDeceleration*2)/3;
-                break;
-            case Track::water:
-                m_currentAcceleration = (m_currentAcceleration*3)/5;
-                m_currentDeceleration = (m_currentDeceleration*3)/5;
-                break;
-            case Track::sand:
-                m_currentAcceleration = (m_currentAcceleration)/2;
-                m_currentDeceleration = (m_currentDeceleration*3)/2;
-                break;
-            case Track::snow:
-                // m_currentAcceleration = m_currentAcceleration;
-                m_currentDeceleration = (m_currentDeceleration)/2;
-                break;
-            default:
-                break;
-        }
-        m_factor1 = 100;
         if (m_manualTransmission)
         {
             static Boolean stickReleased = false;
             if ((!gearUp) && (!gearDown))
                 stickReleased = true;
-            m_factor1 = calculateAcceleration( );
             if ((gearDown) && (m_gear > 1) && (stickReleased))
             {
                 stickReleased = false;
@@ -600,7 +580,7 @@ Car::run(Float elapsed)
                     m_soundBadSwitch->play( );
                 if (m_soundBackfire != 0)
                 {
-                    if ((!m_soundBackfire->playing()) && (random(5) == 1))
+                    if ((random(5) == 1) && (!m_soundBackfire->playing()))
                     {
                         m_soundBackfire->play( );
                     }
@@ -616,7 +596,7 @@ Car::run(Float elapsed)
                     m_soundBadSwitch->play( );
                 if (m_soundBackfire != 0)
                 {
-                    if ((!m_soundBackfire->playing()) && (random(5) == 1))
+                    if ((random(5) == 1) && (!m_soundBackfire->playing()))
                     {
                         m_soundBackfire->play( );
                     }
@@ -665,83 +645,56 @@ Car::run(Float elapsed)
             else if (m_soundThrottle->playing( ))
                 m_soundThrottle->stop( );
         }
-        m_thrust   = m_currentThrottle;
-        if (m_currentThrottle == 0)
-            m_thrust = m_currentBrake;
-        else if (m_currentBrake == 0)
-            m_thrust = m_currentThrottle;
-        else if (-m_currentBrake > m_currentThrottle)
-            m_thrust = m_currentBrake;
-
-		m_factor2 = 1.0;
-		if ((m_currentSteering != 0) && (m_speed > m_topspeed/2))
-		{
-			m_factor2 = 1.0 - (1.5*m_speed/m_topspeed)*absval<int>(m_currentSteering)/100;			
-		}
+        CarPhysics::Input input;
+        input.steering  = m_currentSteering;
+        input.throttle  = m_currentThrottle;
+        input.brake     = m_currentBrake;
+        input.gear      = (m_manualTransmission) ? m_gear : 0;
+        input.surface   = (Track::Surface)m_surface;
+        m_physics.sync(m_positionX, m_positionY, m_speed);
+        m_physics.run(elapsed, input);
+        m_positionX = m_physics.positionX( );
+        m_positionY = m_physics.positionY( );
+        m_speed     = m_physics.speed( );
+        m_currentSteering = m_physics.steering( );
+        Int thrust  = m_physics.thrust( );
 
-        if (m_thrust > 10)
+        if ((thrust > 10) && (m_backfirePlayed == true))
+            m_backfirePlayed = false;
+        if (thrust <= 0)
         {
-            m_speedDiff = Int((elapsed*m_thrust*m_currentAcceleration*m_factor1*m_factor2)/100);
-            if (m_backfirePlayed == true)
-                m_backfirePlayed = false;
-        }
-        else if (m_thrust < -10)
-            m_speedDiff = Int(elapsed*m_thrust*m_currentDeceleration);
-        else
-            m_speedDiff = Int(elapsed*-1000);
-
-        if (m_speedDiff > 0)
-            m_speedDiff = (Int)(m_speedDiff * (2.0f - ((m_topspeed + m_speed)*1.0f/(2.0f*m_topspeed))));
-        m_speed += m_speedDiff;
-        if (m_speed > m_topspeed)
-            m_speed = m_topspeed;
-        if (m_speed < 0)
-            m_speed = 0;
-
-		if (m_thrust <= 0)
-		{
-                if (m_soundBackfire != 0)
+            if (m_soundBackfire != 0)
+            {
+                if (m_backfirePlayed == false)
                 {
-                    if ((!m_soundBackfire->playing()) && (m_backfirePlayed == false))
-                    {
-                        if (random(5) == 1)
-                            m_soundBackfire->play( );
-                    }
-                    m_backfirePlayed = true;
+                    if ((random(5) == 1) && (!m_soundBackfire->playing()))
+                        m_soundBackfire->play( );
                 }
+                m_backfirePlayed = true;
             }
+        }
 
-            if ((m_thrust < -50) && (m_speed > 0))
-            {  
-                brakeSound();
-
-                if (m_effectSpring)
-                    m_effectSpring->gain(5000*m_speed/m_topspeed);
-                m_currentSteering = m_currentSteering*2/3;
-            }
+        if ((thrust < -50) && (m_speed > 0))
+        {  
+            brakeSound();
+            if (m_effectSpring)
+                m_effectSpring->gain(5000*m_speed/m_topspeed);
+        }
         else if ((m_currentSteering != 0) && (m_speed > m_topspeed/2))
-		{
-			if (m_thrust > -50)
-			{
-				brakeCurveSound( );
-			}
-		}
-		else
         {
-            if (m_soundBrake->playing( ))
-				m_soundBrake->stop( );
-			m_soundAsphalt->volume(90);
-                  m_soundGravel->volume(90);
-                  m_soundWater->volume(90);
-                  m_soundSand->volume(90);
-                  m_soundSnow->volume(90);
+            if (thrust > -50)
+                brakeCurveSound( );
         }
-
-        m_positionY += Int(m_speed*elapsed);
-        if (m_surface != Track::snow)
-            m_positionX += Int(m_currentSteering*elapsed*m_steering*((5000.0f + m_speed*m_steeringFactor/100)/m_topspeed));
         else
-            m_positionX += Int(m_currentSteering*elapsed*(m_steering*1.44f)*((5000.0f + m_speed*m_steeringFactor/100)/m_topspeed));
+        {
+            if (m_soundBrake->playing( ))
+                m_soundBrake->stop( );
+            m_soundAsphalt->volume(90);
+            m_soundGravel->volume(90);
+            m_soundWater->volume(90);
+            m_soundSand->volume(90);
+            m_soundSnow->volume(90);
+        }
 
         // update frequencies
         if (m_frame % 4 == 0)
@@ -839,9 +792,9 @@ Car::run(Float elapsed)
     }
     else if (m_state == stopping)
     {
-        m_speed -= Int(elapsed*100*m_deceleration);
-        if (m_speed < 0)
-            m_speed = 0;
+        m_physics.sync(m_positionX, m_positionY, m_speed);
+        m_physics.runStopping(elapsed);
+        m_speed = m_physics.speed( );
         // update frequencies
         if (m_frame % 4 == 0)
         {
@@ -862,38 +815,32 @@ Car::run(Float elapsed)
             m_soundHorn->stop( );
     }
     // Handle events
-    Event* e = 0;
-    while (e = m_eventList.next(e))
+    Event e;
+    while (m_events.popDue(m_game->currentTime( ), e))
     {
-        if (e->time < m_game->currentTime( ))
+        switch (e.type)
         {
-            switch (e->type)
-            {
-		case Event::carStart:
-                m_soundEngine->frequency(m_idlefreq);
-                if (m_soundThrottle)
-                    m_soundThrottle->frequency(m_idlefreq);
-                if (m_effectStart)
-                    m_effectStart->stop( );
-                m_soundEngine->play(0, true);
-                if (m_hasWipers == 1)
-                    m_soundWipers->play(0, true);
-                m_state = running;
-                break;
-		case Event::carRestart:
-                if (m_effectCrash)
-                    m_effectCrash->stop( );
-                start( );
-                break;
-		case Event::inGear:
-                m_switchingGear = 0;
-                break;
-            default:
-                break;
-            }
-            m_eventList.purge(e);
-            delete e;
-            e = 0;
+	case Event::carStart:
+            m_soundEngine->frequency(m_idlefreq);
+            if (m_soundThrottle)
+                m_soundThrottle->frequency(m_idlefreq);
+            if (m_effectStart)
+                m_effectStart->stop( );
+            m_soundEngine->play(0, true);
+            if (m_hasWipers == 1)
+                m_soundWipers->play(0, true);
+            m_state = running;
+            break;
+	case Event::carRestart:
+            if (m_effectCrash)
+                m_effectCrash->stop( );
+            start( );
+            break;
+	case Event::inGear:
+            m_switchingGear = 0;
+            break;
+        default:
+            break;
         }
     }
 }
@@ -1301,32 +1248,21 @@ Car::evaluate(Track::Road road)
 void 
 Car::pushEvent(Event::Type type, Float time)
 {
-    Event* e = new Event;
-    e->type = type;
-    e->time = m_game->currentTime( ) + time;
-    m_eventList.push(e);
+    m_events.schedule(type, m_game->currentTime( ) + time);
 }
 
 
 void 
 Car::updateEngineFreq( )
 {
-    Int gearRange = m_topspeed / (m_gears + 1);
-    if ((m_speed / gearRange) < 2)
-    {
-        Float gearSpeed = (Float(m_speed) / (2.0f * Float(gearRange)));
-        m_frequency = Int(gearSpeed * (m_topfreq - m_idlefreq)) + m_idlefreq;
-    }
-    else
+    Boolean shifted;
+    m_frequency = m_profile->frequency(m_speed, shifted);
+    Int gear = m_profile->gear(m_speed);
+    if (gear > 0)
     {
-        // Int gear = m_speed / gearRange;
-        m_gear = m_speed / gearRange;
-        if (m_gear > m_gears)
-            m_gear = m_gears;
-        Float gearSpeed = (Float(m_speed) - Float(m_gear) * Float(gearRange)) / Float(gearRange);
-        if (gearSpeed < 0.07f)
+        m_gear = gear;
+        if (shifted)
         {
-            m_frequency = Int(((0.07f - gearSpeed) / 0.07f) * Float(m_topfreq - m_shiftfreq) + m_shiftfreq);
             if (m_soundBackfire != 0)
             {
                 if (!m_backfirePlayedAuto)
@@ -1339,7 +1275,6 @@ Car::updateEngineFreq( )
         }
         else
         {
-            m_frequency = Int(gearSpeed * (m_topfreq - m_shiftfreq) + m_shiftfreq);
             if (m_soundBackfire != 0)
             {
                 if (m_backfirePlayedAuto)
@@ -1367,28 +1302,7 @@ Car::updateEngineFreq( )
 void
 Car::updateEngineFreqManual( )
 {
-    Int gearRange = m_topspeed / m_gears;
-    // m_frequency = m_shiftfreq;
-    if (m_gear == 1)
-    {
-        if (m_speed < Int((4.0f / 3.0f) * Float(gearRange)))
-        {
-            m_frequency = m_idlefreq + Int((Float(m_speed) * 3.0f / Float(2 * gearRange)) * Float(m_topfreq - m_idlefreq));
-        }
-        else
-        {
-            m_frequency = m_idlefreq + 2 * (m_topfreq - m_idlefreq);
-        }
-    }
-    else
-    {
-        Float shiftPoint = ((2.0f / 3.0f) + Float(m_gear-1)) * Float(gearRange);
-        m_frequency = Int((Float(m_speed) / shiftPoint) * Float(m_topfreq));
-        if (m_frequency > 2 * m_topfreq)
-            m_frequency = 2 * m_topfreq;
-        if (m_frequency < m_idlefreq / 2)
-            m_frequency = m_idlefreq / 2;
-    }
+    m_frequency = m_profile->frequencyManual(m_gear, m_speed);
     if (m_switchingGear != 0)
         m_frequency = (2 * m_prevFrequency + m_frequency) / 3;
     if (m_frequency != m_prevFrequency)
@@ -1408,47 +1322,6 @@ Car::updateEngineFreqManual( )
 }
 
 
-Int
-Car::calculateAcceleration( )
-{
-    Int gearSpeed = m_topspeed/m_gears;
-    Int gearCenter = Int(Float(gearSpeed) * (Float(m_gear) - 0.82f));
-    m_speedDiff = m_speed - gearCenter;
-    Float relSpeedDiff = Float(m_speedDiff) / Float(gearSpeed);
-    /* if (!m_manualTransmission)
-    {
-        if (relSpeedDiff > 1.1f)
-        {
-            m_switchingGear = 1;
-            ++m_gear;
-            pushEvent(Event::inGear, 0.2f);
-        }
-        else if (relSpeedDiff < -1.1f)
-        {
-            m_switchingGear = -1;
-            --m_gear;
-            pushEvent(Event::inGear, 0.2f);
-        }
-    } */
-    if (absval<Float>(relSpeedDiff) < 1.9f)
-    {
-        Int acceleration = Int(100.0f * (0.5f + cosf(relSpeedDiff * (DirectX::Pi) * 0.5f)));
-        if (acceleration < 5)
-            return 5;
-        else 
-            return acceleration;
-    }
-    else
-    {
-        Int acceleration = Int(100.0f * (0.5f + cosf(0.95f * (DirectX::Pi))));
-        if (acceleration < 5)
-            return 5;
-        else
-            return acceleration;
-    }
-}
-
-
 void
 Car::updateSoundRoad( )
 {
@@ -9,6 +9,9 @@
 
 #include "Game.h"
 #include "Track.h"
+#include "CarPhysics.h"
+#include "VehicleProfile.h"
+#include "EventScheduler.h"
 #include "Packets.h"
 
 class Track;
@@ -103,8 +106,6 @@ public:
 
 
 private:
-    Int calculateAcceleration( );
-
     void updateEngineFreq( );
     void updateEngineFreqManual( );
     void updateSoundRoad( );
@@ -136,7 +137,7 @@ private:
     DirectX::Sound*         m_soundBump1;
     DirectX::Sound*         m_soundBadSwitch;
     DirectX::Sound*	    m_soundBackfire;
-    EventList               m_eventList;
+    EventScheduler          m_events;
     Int                     m_frame;
 
     Float                   m_prevThrottleVolume;
@@ -144,6 +145,7 @@ private:
 
     Int                     m_surface;
 
+    CarPhysics              m_physics;
     Int                     m_speed;
     Int                     m_gear;
     Int                     m_positionX;
@@ -166,7 +168,8 @@ private:
     Int                     m_gears;
     Int                     m_steering;
     Int                     m_steeringFactor;
-    Int                     m_thrust;
+    VehicleProfile          m_customProfile;
+    const VehicleProfile*   m_profile;
     Int                     m_prevFrequency;
     Int                     m_frequency;
     Int                     m_prevBrakeFrequency;
@@ -179,11 +182,6 @@ private:
     Int                     m_currentSteering;
     Int                     m_currentThrottle;
     Int                     m_currentBrake;
-    Int                     m_currentAcceleration;
-    Int                     m_currentDeceleration;
-    Int                     m_speedDiff;
-    Int                     m_factor1;
-    Double                  m_factor2;
     Char                    m_customFile[64];
     Boolean                 m_userDefined;
     // forcefeedback
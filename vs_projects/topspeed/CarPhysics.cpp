@@ -0,0 +1,364 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "CarPhysics.h"
+
+static CarPhysics::Arithmetic _defaultArithmetic = CarPhysics::floatingPoint;
+
+
+CarPhysics::CarPhysics( ) :
+    m_prevPositionX(0.0),
+    m_prevPositionY(0.0),
+    m_accumulator(0.0f),
+    m_steps(0),
+    m_publishedX(0),
+    m_publishedY(0),
+    m_publishedSpeed(0)
+{
+    m_parameters.model          = player;
+    m_parameters.acceleration   = 10;
+    m_parameters.deceleration   = 40;
+    m_parameters.topspeed       = 15000;
+    m_parameters.gears          = 5;
+    m_parameters.steering       = 100;
+    m_parameters.steeringFactor = 40;
+    m_parameters.profile        = NULL;
+    parameters(m_parameters);
+    reset(0, 0);
+}
+
+
+CarPhysics::~CarPhysics( )
+{
+}
+
+
+void
+CarPhysics::parameters(const Parameters& parameters)
+{
+    m_parameters = parameters;
+    const SurfaceTable& surfaces = SurfaceTable::active( );
+    for (UInt i = 0; i < NSURFACES; ++i)
+    {
+        const SurfaceTable::Surface& surface = surfaces.surface(i);
+        const SurfaceTable::Factor& grip = surface.grip[m_parameters.model];
+        const SurfaceTable::Factor& braking = surface.braking[m_parameters.model];
+        m_acceleration[i] = (m_parameters.acceleration*grip.numerator)/grip.denominator;
+        m_deceleration[i] = (m_parameters.deceleration*braking.numerator)/braking.denominator;
+        m_steering[i]     = Float(m_parameters.steering)*(Float(surface.steering)/100.0f);
+        m_coasting[i]     = PHYSICSSTEP*-Float(surface.drag);
+        m_steeringFixed[i] = m_parameters.steering*surface.steering;
+        m_coastingFixed[i] = -(surface.drag << PHYSICSSPEEDSHIFT)/PHYSICSRATE;
+    }
+    m_arithmetic = _defaultArithmetic;
+}
+
+
+void
+CarPhysics::reset(Int positionX, Int positionY)
+{
+    m_state.positionX   = positionX;
+    m_state.positionY   = positionY;
+    m_state.speed       = 0.0f;
+    m_state.speedDiff   = 0.0f;
+    m_state.thrust      = 0;
+    m_state.steering    = 0;
+    m_prevPositionX     = positionX;
+    m_prevPositionY     = positionY;
+    m_accumulator       = 0.0f;
+    m_steps             = 0;
+    publish( );
+}
+
+
+void
+CarPhysics::save(Snapshot& snapshot) const
+{
+    snapshot.state          = m_state;
+    snapshot.prevPositionX  = m_prevPositionX;
+    snapshot.prevPositionY  = m_prevPositionY;
+    snapshot.accumulator    = m_accumulator;
+    snapshot.steps          = m_steps;
+    snapshot.publishedX     = m_publishedX;
+    snapshot.publishedY     = m_publishedY;
+    snapshot.publishedSpeed = m_publishedSpeed;
+}
+
+
+void
+CarPhysics::restore(const Snapshot& snapshot)
+{
+    m_state          = snapshot.state;
+    m_prevPositionX  = snapshot.prevPositionX;
+    m_prevPositionY  = snapshot.prevPositionY;
+    m_accumulator    = snapshot.accumulator;
+    m_steps          = snapshot.steps;
+    m_publishedX     = snapshot.publishedX;
+    m_publishedY     = snapshot.publishedY;
+    m_publishedSpeed = snapshot.publishedSpeed;
+}
+
+
+void
+CarPhysics::sync(Int positionX, Int positionY, Int speed)
+{
+    // crashes, bumps and the like move the car outside the simulation
+    if (positionX != m_publishedX)
+    {
+        m_state.positionX = positionX;
+        m_prevPositionX   = positionX;
+        m_publishedX      = positionX;
+    }
+    if (positionY != m_publishedY)
+    {
+        m_state.positionY = positionY;
+        m_prevPositionY   = positionY;
+        m_publishedY      = positionY;
+    }
+    if (speed != m_publishedSpeed)
+    {
+        m_state.speed     = Float(speed);
+        m_publishedSpeed  = speed;
+    }
+}
+
+
+UInt
+CarPhysics::accumulate(Float elapsed)
+{
+    if (elapsed > 0.0f)
+        m_accumulator += elapsed;
+    UInt steps = UInt(m_accumulator / PHYSICSSTEP);
+    if (steps > MAXPHYSICSSTEPS)
+    {
+        steps = MAXPHYSICSSTEPS;
+        m_accumulator = 0.0f;
+    }
+    else
+        m_accumulator -= steps*PHYSICSSTEP;
+    if (m_accumulator < 0.0f)
+        m_accumulator = 0.0f;
+    return steps;
+}
+
+
+void
+CarPhysics::step(const Input& input)
+{
+    if (m_arithmetic == fixedPoint)
+    {
+        stepFixed(input);
+        return;
+    }
+    UInt surface = (UInt(input.surface) < NSURFACES) ? UInt(input.surface) : UInt(Track::asphalt);
+    Int acceleration = m_acceleration[surface];
+    Int deceleration = m_deceleration[surface];
+
+    updateThrust(input);
+    Float topspeed = Float(m_parameters.topspeed);
+    Float factor = 1.0f;
+    if (m_parameters.model == player)
+    {
+        if (input.gear > 0)
+            factor = m_parameters.profile->gearFactor(input.gear, m_state.speed) / 100.0f;
+        if ((input.steering != 0) && (m_state.speed > topspeed/2))
+            factor *= 1.0f - (1.5f*m_state.speed/topspeed)*absval<Int>(input.steering)/100.0f;
+    }
+
+    if (m_state.thrust > 10)
+        m_state.speedDiff = PHYSICSSTEP*m_state.thrust*acceleration*factor;
+    else if (m_state.thrust < -10)
+        m_state.speedDiff = PHYSICSSTEP*m_state.thrust*deceleration;
+    else
+        m_state.speedDiff = m_coasting[surface];
+    if (m_state.speedDiff > 0.0f)
+        m_state.speedDiff *= 2.0f - (topspeed + m_state.speed)/(2.0f*topspeed);
+    m_state.speed += m_state.speedDiff;
+    if (m_state.speed > topspeed)
+        m_state.speed = topspeed;
+    if (m_state.speed < 0.0f)
+        m_state.speed = 0.0f;
+
+    // hard braking takes away some of the grip
+    m_state.steering = input.steering;
+    Float brakeLimit = (m_parameters.model == player) ? 0.0f : 5000.0f;
+    if ((m_state.thrust < -50) && (m_state.speed > brakeLimit))
+        m_state.steering = m_state.steering*2/3;
+
+    Float steering = m_steering[surface];
+    m_prevPositionX = m_state.positionX;
+    m_prevPositionY = m_state.positionY;
+    m_state.positionY += m_state.speed*PHYSICSSTEP;
+    m_state.positionX += m_state.steering*PHYSICSSTEP*steering*
+                         ((5000.0f + m_state.speed*m_parameters.steeringFactor/100.0f)/topspeed);
+    ++m_steps;
+}
+
+
+// the same step in whole numbers, see the formats above
+void
+CarPhysics::stepFixed(const Input& input)
+{
+    const Huge one = Huge(1) << PHYSICSPOSITIONSHIFT;
+    UInt surface = (UInt(input.surface) < NSURFACES) ? UInt(input.surface) : UInt(Track::asphalt);
+    updateThrust(input);
+
+    Huge topspeed = Huge(m_parameters.topspeed) << PHYSICSSPEEDSHIFT;
+    Huge speed = Huge(m_state.speed*Float(1 << PHYSICSSPEEDSHIFT));
+    Huge factor = one;
+    if (m_parameters.model == player)
+    {
+        if (input.gear > 0)
+            factor = m_parameters.profile->gearFactorFixed(input.gear, Int(speed))*one/100;
+        if ((input.steering != 0) && (2*speed > topspeed))
+            factor = factor*(one - 3*speed*absval<Int>(input.steering)*one/(2*topspeed*100))/one;
+    }
+
+    Huge speedDiff;
+    if (m_state.thrust > 10)
+        speedDiff = Huge(m_state.thrust)*m_acceleration[surface]*factor*(1 << PHYSICSSPEEDSHIFT)/(PHYSICSRATE*one);
+    else if (m_state.thrust < -10)
+        speedDiff = Huge(m_state.thrust)*m_deceleration[surface]*(1 << PHYSICSSPEEDSHIFT)/PHYSICSRATE;
+    else
+        speedDiff = m_coastingFixed[surface];
+    if (speedDiff > 0)
+        speedDiff = speedDiff*(3*topspeed - speed)/(2*topspeed);
+    speed += speedDiff;
+    if (speed > topspeed)
+        speed = topspeed;
+    if (speed < 0)
+        speed = 0;
+    m_state.speedDiff = Float(speedDiff)/Float(1 << PHYSICSSPEEDSHIFT);
+    m_state.speed     = Float(speed)/Float(1 << PHYSICSSPEEDSHIFT);
+
+    m_state.steering = input.steering;
+    Huge brakeLimit = (m_parameters.model == player) ? 0 : (Huge(5000) << PHYSICSSPEEDSHIFT);
+    if ((m_state.thrust < -50) && (speed > brakeLimit))
+        m_state.steering = m_state.steering*2/3;
+
+    // (5000 + speed*steeringFactor/100)/topspeed, split so big vehicle files do not overflow it
+    Huge pull = (Huge(500000) << PHYSICSSPEEDSHIFT) + speed*m_parameters.steeringFactor;
+    Huge range = 100*topspeed;
+    pull = (pull/range)*one + (pull%range)*one/range;
+    Huge positionX = Huge(m_state.positionX*Double(one));
+    Huge positionY = Huge(m_state.positionY*Double(one));
+    positionY += speed*(one >> PHYSICSSPEEDSHIFT)/PHYSICSRATE;
+    positionX += Huge(m_state.steering)*m_steeringFixed[surface]*pull/(100*PHYSICSRATE);
+    m_prevPositionX = m_state.positionX;
+    m_prevPositionY = m_state.positionY;
+    m_state.positionX = Double(positionX)/Double(one);
+    m_state.positionY = Double(positionY)/Double(one);
+    ++m_steps;
+}
+
+
+// a computer player keeps its thrust while both pedals are pressed lightly
+void
+CarPhysics::updateThrust(const Input& input)
+{
+    if (input.throttle == 0)
+        m_state.thrust = input.brake;
+    else if (input.brake == 0)
+        m_state.thrust = input.throttle;
+    else if (-input.brake > input.throttle)
+        m_state.thrust = input.brake;
+    else if (m_parameters.model == player)
+        m_state.thrust = input.throttle;
+}
+
+
+void
+CarPhysics::stepStopping( )
+{
+    if (m_arithmetic == fixedPoint)
+    {
+        stepStoppingFixed( );
+        return;
+    }
+    m_state.speedDiff = -PHYSICSSTEP*100.0f*m_parameters.deceleration;
+    m_state.speed += m_state.speedDiff;
+    if (m_state.speed < 0.0f)
+        m_state.speed = 0.0f;
+    m_state.thrust = 0;
+    m_state.steering = 0;
+    m_prevPositionX = m_state.positionX;
+    m_prevPositionY = m_state.positionY;
+    ++m_steps;
+}
+
+
+void
+CarPhysics::stepStoppingFixed( )
+{
+    Huge speed = Huge(m_state.speed*Float(1 << PHYSICSSPEEDSHIFT));
+    Huge speedDiff = -Huge(100*m_parameters.deceleration)*(1 << PHYSICSSPEEDSHIFT)/PHYSICSRATE;
+    speed += speedDiff;
+    if (speed < 0)
+        speed = 0;
+    m_state.speedDiff = Float(speedDiff)/Float(1 << PHYSICSSPEEDSHIFT);
+    m_state.speed     = Float(speed)/Float(1 << PHYSICSSPEEDSHIFT);
+    m_state.thrust = 0;
+    m_state.steering = 0;
+    m_prevPositionX = m_state.positionX;
+    m_prevPositionY = m_state.positionY;
+    ++m_steps;
+}
+
+
+UInt
+CarPhysics::run(Float elapsed, const Input& input)
+{
+    UInt steps = accumulate(elapsed);
+    for (UInt i = 0; i < steps; ++i)
+        step(input);
+    publish( );
+    return steps;
+}
+
+
+UInt
+CarPhysics::runStopping(Float elapsed)
+{
+    UInt steps = accumulate(elapsed);
+    for (UInt i = 0; i < steps; ++i)
+        stepStopping( );
+    publish( );
+    return steps;
+}
+
+
+void
+CarPhysics::publish( )
+{
+    Double alpha = m_accumulator / PHYSICSSTEP;
+    m_publishedX     = Int(m_prevPositionX + (m_state.positionX - m_prevPositionX)*alpha);
+    m_publishedY     = Int(m_prevPositionY + (m_state.positionY - m_prevPositionY)*alpha);
+    m_publishedSpeed = Int(m_state.speed);
+}
+
+
+// for callers stepping by hand, hands out the last step without interpolating
+void
+CarPhysics::settle( )
+{
+    m_prevPositionX = m_state.positionX;
+    m_prevPositionY = m_state.positionY;
+    publish( );
+}
+
+
+CarPhysics::Arithmetic
+CarPhysics::defaultArithmetic( )
+{
+    return _defaultArithmetic;
+}
+
+
+void
+CarPhysics::defaultArithmetic(Arithmetic arithmetic)
+{
+    _defaultArithmetic = arithmetic;
+}
@@ -0,0 +1,168 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_CARPHYSICS_H__
+#define __RACING_CARPHYSICS_H__
+
+#include "Track.h"
+#include "VehicleProfile.h"
+#include "SurfaceTable.h"
+
+// fixed simulation rate
+#define PHYSICSRATE     200
+#define PHYSICSSTEP     (1.0f / PHYSICSRATE)
+// steps simulated per frame at most, the rest of a long frame is dropped
+#define MAXPHYSICSSTEPS 25
+// fixed point: fraction bits of speeds, and of positions and the factors in
+// between, which share theirs
+#define PHYSICSSPEEDSHIFT       PROFILESPEEDSHIFT
+#define PHYSICSPOSITIONSHIFT    16
+
+
+/*************************************************************************************
+ *@class CarPhysics
+ *@description
+ *    Speed and position of one vehicle, advanced in fixed steps of PHYSICSSTEP
+ *    seconds no matter how long a frame takes. Frame time is collected in an
+ *    accumulator, positions handed out to the game are interpolated between
+ *    the last two steps. No sound or input device is touched, the owner passes
+ *    the controls in and drives its sounds from the state afterwards.
+ *
+ *    How the vehicle handles on each surface is worked out from the active
+ *    SurfaceTable when it gets its parameters, a step only looks it up.
+ *
+ *    Float steps come out differently with other compilers, settings or
+ *    instruction sets. With fixedPoint arithmetic a step is worked out in
+ *    whole numbers only and gives the same state to the last bit everywhere,
+ *    as long as it is stepped by hand as well (step and settle, not run with
+ *    frame times). Speeds are Q.8, 1/256 of a unit; positions and the
+ *    factors in between, the pull of a gear among them, Q.16 in a Huge;
+ *    divisions round toward zero. The State keeps its fields, holding values
+ *    these formats give exactly: speeds to 65536 units, positions to 2^37.
+ *    The arithmetic is taken, like the surfaces, when the parameters are set.
+ *************************************************************************************/
+class CarPhysics
+{
+public:
+    // the computer players have always handled slightly differently
+    enum Model
+    {
+        player,
+        computer
+    };
+
+    enum Arithmetic
+    {
+        floatingPoint   = 0,
+        fixedPoint      = 1
+    };
+
+    struct Parameters
+    {
+        Model   model;
+        Int     acceleration;
+        Int     deceleration;
+        Int     topspeed;
+        Int     gears;
+        Int     steering;
+        Int     steeringFactor;
+        const VehicleProfile* profile;  // the pull of a manual gear
+    };
+
+    struct Input
+    {
+        Int             steering;
+        Int             throttle;
+        Int             brake;
+        Int             gear;       // selected gear, 0 for an automatic transmission
+        Track::Surface  surface;
+    };
+
+    struct State
+    {
+        Double  positionX;
+        Double  positionY;
+        Float   speed;
+        Float   speedDiff;
+        Int     thrust;
+        Int     steering;           // steering after braking took its share
+    };
+
+    // everything that changes while the car runs, to put it back exactly
+    struct Snapshot
+    {
+        State   state;
+        Double  prevPositionX;
+        Double  prevPositionY;
+        Float   accumulator;
+        UInt    steps;
+        Int     publishedX;
+        Int     publishedY;
+        Int     publishedSpeed;
+    };
+
+public:
+    CarPhysics( );
+    virtual ~CarPhysics( );
+
+public:
+    void            parameters(const Parameters& parameters);
+    const Parameters& parameters( ) const               { return m_parameters;      }
+    const State&    state( ) const                      { return m_state;           }
+
+    void            reset(Int positionX, Int positionY);
+    void            sync(Int positionX, Int positionY, Int speed);
+    UInt            accumulate(Float elapsed);
+    void            step(const Input& input);
+    void            stepStopping( );
+    UInt            run(Float elapsed, const Input& input);
+    UInt            runStopping(Float elapsed);
+    void            publish( );
+    void            settle( );
+    void            save(Snapshot& snapshot) const;
+    void            restore(const Snapshot& snapshot);
+    Arithmetic      arithmetic( ) const                 { return m_arithmetic;          }
+
+    Int             positionX( ) const                  { return m_publishedX;          }
+    Int             positionY( ) const                  { return m_publishedY;          }
+    Int             speed( ) const                      { return m_publishedSpeed;      }
+    Int             thrust( ) const                     { return m_state.thrust;        }
+    Int             steering( ) const                   { return m_state.steering;      }
+    UInt            steps( ) const                      { return m_steps;               }
+
+public:
+    // for the cars given their parameters from now on
+    static Arithmetic   defaultArithmetic( );
+    static void         defaultArithmetic(Arithmetic arithmetic);
+
+private:
+    void            updateThrust(const Input& input);
+    void            stepFixed(const Input& input);
+    void            stepStoppingFixed( );
+
+private:
+    Parameters      m_parameters;
+    State           m_state;
+    Double          m_prevPositionX;
+    Double          m_prevPositionY;
+    Float           m_accumulator;
+    UInt            m_steps;
+    // values last handed out, to notice when the owner moved the car itself
+    Int             m_publishedX;
+    Int             m_publishedY;
+    Int             m_publishedSpeed;
+    // the parameters on every surface
+    Int             m_acceleration[NSURFACES];
+    Int             m_deceleration[NSURFACES];
+    Float           m_steering[NSURFACES];
+    Float           m_coasting[NSURFACES];      // speed change a step without thrust
+    Arithmetic      m_arithmetic;
+    Int             m_steeringFixed[NSURFACES]; // steering times the percentage of the surface
+    Int             m_coastingFixed[NSURFACES];
+};
+
+
+#endif /* __RACING_CARPHYSICS_H__ */
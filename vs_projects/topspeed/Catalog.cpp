@@ -0,0 +1,359 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "Catalog.h"
+#include "TrackFile.h"
+#include "VehicleDefinition.h"
+#include "Game.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// entries a cache file may claim before it is taken for damaged
+#define CATALOGMAXENTRIES   (1 << 20)
+
+static const Char catalogMagic[4] = { 'T', 'S', 'C', 'G' };
+
+
+static int
+comparePaths(const void* a, const void* b)
+{
+    return ::strcmp(((const Catalog::Entry*)a)->path, ((const Catalog::Entry*)b)->path);
+}
+
+
+static int
+compareSounds(const void* a, const void* b)
+{
+    return ::_stricmp((const Char*)a, (const Char*)b);
+}
+
+
+Catalog::Catalog(const Char* trackDirectory, const Char* vehicleDirectory, const Char* cacheFile) :
+    m_entries(NULL),
+    m_nEntries(0),
+    m_capacity(0),
+    m_nTracks(0),
+    m_sounds(NULL),
+    m_nSounds(0),
+    m_soundCapacity(0),
+    m_cache(NULL),
+    m_nCache(0),
+    m_pending(NULL),
+    m_nPending(0),
+    m_next(0)
+{
+    ::_snprintf(m_trackDirectory, MAX_PATH - 1, "%s", trackDirectory);
+    m_trackDirectory[MAX_PATH - 1] = '\0';
+    ::_snprintf(m_vehicleDirectory, MAX_PATH - 1, "%s", vehicleDirectory);
+    m_vehicleDirectory[MAX_PATH - 1] = '\0';
+    ::_snprintf(m_cacheFile, MAX_PATH - 1, "%s", cacheFile);
+    m_cacheFile[MAX_PATH - 1] = '\0';
+}
+
+
+Catalog::~Catalog( )
+{
+    SAFE_DELETE_ARRAY(m_entries);
+    SAFE_DELETE_ARRAY(m_sounds);
+    SAFE_DELETE_ARRAY(m_cache);
+    SAFE_DELETE_ARRAY(m_pending);
+}
+
+
+void
+Catalog::scan(UInt nThreads)
+{
+    m_nEntries = 0;
+    m_nTracks  = 0;
+    load( );
+    list(m_trackDirectory, "trk", trackFile);
+    m_nTracks = m_nEntries;
+    list(m_vehicleDirectory, "vhc", vehicleFile);
+
+    // what the cache knows is taken over, the rest is parsed
+    SAFE_DELETE_ARRAY(m_pending);
+    m_pending  = new UInt[m_nEntries + 1];
+    m_nPending = 0;
+    UInt nKnown = 0;
+    for (UInt i = 0; i < m_nEntries; ++i)
+    {
+        Entry& entry = m_entries[i];
+        const Entry* known = cached(entry);
+        if (known == NULL)
+        {
+            m_pending[m_nPending++] = i;
+            continue;
+        }
+        Boolean hasSound = entry.hasSound;
+        entry = *known;
+        entry.hasSound = hasSound;
+        ++nKnown;
+    }
+
+    if (nThreads == 0)
+    {
+        SYSTEM_INFO system;
+        ::GetSystemInfo(&system);
+        nThreads = system.dwNumberOfProcessors;
+    }
+    if (nThreads > CATALOGTHREADS)
+        nThreads = CATALOGTHREADS;
+    if (nThreads > m_nPending)
+        nThreads = m_nPending;
+    m_next = 0;
+    if (nThreads <= 1)
+        worker(this);
+    else
+    {
+        HANDLE threads[CATALOGTHREADS];
+        UInt nStarted = 0;
+        for (UInt i = 0; i < nThreads; ++i)
+        {
+            threads[nStarted] = ::CreateThread(NULL, 0, worker, this, 0, NULL);
+            if (threads[nStarted] != NULL)
+                ++nStarted;
+        }
+        // without workers this thread does the parsing, with them it helps out
+        worker(this);
+        ::WaitForMultipleObjects(nStarted, threads, TRUE, INFINITE);
+        for (UInt i = 0; i < nStarted; ++i)
+            ::CloseHandle(threads[i]);
+    }
+
+    // each entry taken from the cache matches a different cached one, so any
+    // left over belong to files that went away
+    if ((m_nPending > 0) || (nKnown != m_nCache))
+        save( );
+    SAFE_DELETE_ARRAY(m_cache);
+    m_nCache = 0;
+    RACE("Catalog::scan : %u tracks, %u vehicles, %u parsed, %u from the cache",
+         m_nTracks, m_nEntries - m_nTracks, m_nPending, nKnown);
+}
+
+
+void
+Catalog::parse(Entry& entry)
+{
+    entry.valid = false;
+    if (entry.kind == trackFile)
+    {
+        Track::Definition* definition = NULL;
+        UInt               length     = 0;
+        Track::Weather     weather    = Track::sunny;
+        Track::Ambience    ambience   = Track::noAmbience;
+        if (TrackFile::readText(entry.path, definition, length, weather, ambience))
+        {
+            entry.segments  = length;
+            entry.lapLength = 0;
+            for (UInt i = 0; i < length; ++i)
+                entry.lapLength += definition[i].length;
+            entry.weather   = weather;
+            entry.ambience  = ambience;
+            entry.valid     = true;
+        }
+        SAFE_DELETE_ARRAY(definition);
+        return;
+    }
+
+    // not through the cache, that is for the cars of a race, not for every file on disk
+    VehicleDefinition definition;
+    if (!definition.read(entry.path))
+        return;
+    entry.acceleration   = definition.acceleration;
+    entry.deceleration   = definition.deceleration;
+    entry.topspeed       = definition.topspeed;
+    entry.idlefreq       = definition.idlefreq;
+    entry.topfreq        = definition.topfreq;
+    entry.shiftfreq      = definition.shiftfreq;
+    entry.gears          = definition.gears;
+    entry.steering       = definition.steering;
+    entry.steeringFactor = definition.steeringFactor;
+    entry.hasWipers      = definition.hasWipers;
+    entry.valid = (entry.topspeed > 0) && (entry.gears > 0) && (entry.idlefreq > 0);
+}
+
+
+void
+Catalog::load( )
+{
+    SAFE_DELETE_ARRAY(m_cache);
+    m_nCache = 0;
+    FILE* file = ::fopen(m_cacheFile, "rb");
+    if (file == NULL)
+        return;
+    Header header;
+    if ((::fread(&header, sizeof(header), 1, file) == 1)
+        && (::memcmp(header.magic, catalogMagic, sizeof(catalogMagic)) == 0)
+        && (header.version == CATALOG_VERSION) && (header.entrySize == sizeof(Entry))
+        && (header.nEntries <= CATALOGMAXENTRIES))
+    {
+        m_cache = new Entry[header.nEntries + 1];
+        if (::fread(m_cache, sizeof(Entry), header.nEntries, file) == header.nEntries)
+            m_nCache = header.nEntries;
+        else
+            SAFE_DELETE_ARRAY(m_cache);
+    }
+    ::fclose(file);
+    if (m_cache == NULL)
+    {
+        RACE("(!) Catalog::load : %s is not a catalog of this version, scanning everything", m_cacheFile);
+        return;
+    }
+    for (UInt i = 0; i < m_nCache; ++i)
+    {
+        m_cache[i].path[CATALOGPATH - 1]  = '\0';
+        m_cache[i].sound[CATALOGPATH - 1] = '\0';
+    }
+    ::qsort(m_cache, m_nCache, sizeof(Entry), comparePaths);
+}
+
+
+void
+Catalog::save( )
+{
+    FILE* file = ::fopen(m_cacheFile, "wb");
+    if (file == NULL)
+    {
+        RACE("(!) Catalog::save : could not write %s", m_cacheFile);
+        return;
+    }
+    Header header;
+    ::memcpy(header.magic, catalogMagic, sizeof(catalogMagic));
+    header.version   = CATALOG_VERSION;
+    header.entrySize = sizeof(Entry);
+    header.nEntries  = m_nEntries;
+    Boolean written = (::fwrite(&header, sizeof(header), 1, file) == 1)
+                      && (::fwrite(m_entries, sizeof(Entry), m_nEntries, file) == m_nEntries);
+    ::fclose(file);
+    if (!written)
+    {
+        // half a cache would only be thrown away by the next load
+        RACE("(!) Catalog::save : could not write %s", m_cacheFile);
+        ::remove(m_cacheFile);
+    }
+}
+
+
+void
+Catalog::list(const Char* directory, const Char* extension, Kind kind)
+{
+    listSounds(directory);
+    Char pattern[MAX_PATH];
+    ::_snprintf(pattern, MAX_PATH - 1, "%s\\*.%s", directory, extension);
+    pattern[MAX_PATH - 1] = '\0';
+    WIN32_FIND_DATA findFileData;
+    HANDLE findHandle = ::FindFirstFile(pattern, &findFileData);
+    if (findHandle == INVALID_HANDLE_VALUE)
+        return;
+    UInt extensionLength = UInt(::strlen(extension)) + 1;
+    do
+    {
+        // *.trk also finds name.trkb through its short name
+        UInt nameLength = UInt(::strlen(findFileData.cFileName));
+        if ((nameLength <= extensionLength) || (findFileData.cFileName[nameLength - extensionLength] != '.')
+            || (::_stricmp(findFileData.cFileName + nameLength - extensionLength + 1, extension) != 0))
+            continue;
+        Entry entry;
+        ::memset(&entry, 0, sizeof(entry));
+        Int length = ::_snprintf(entry.path, CATALOGPATH, "%s\\%s", directory, findFileData.cFileName);
+        if ((length < 0) || (length >= CATALOGPATH))
+        {
+            RACE("(!) Catalog::list : %s\\%s, path too long", directory, findFileData.cFileName);
+            continue;
+        }
+        entry.path[CATALOGPATH - 1] = '\0';
+        ::_snprintf(entry.sound, CATALOGPATH - 1, "%.*s.wav", Int(length - extensionLength), entry.path);
+        entry.sound[CATALOGPATH - 1] = '\0';
+        entry.hasSound = (::bsearch(entry.sound, m_sounds, m_nSounds, CATALOGPATH, compareSounds) != NULL);
+        entry.size     = (UHuge(findFileData.nFileSizeHigh) << 32) | findFileData.nFileSizeLow;
+        entry.modified = (UHuge(findFileData.ftLastWriteTime.dwHighDateTime) << 32)
+                         | findFileData.ftLastWriteTime.dwLowDateTime;
+        entry.kind     = kind;
+        add(entry);
+    }
+    while (::FindNextFile(findHandle, &findFileData));
+    ::FindClose(findHandle);
+}
+
+
+void
+Catalog::listSounds(const Char* directory)
+{
+    // one listing of the sounds instead of looking up each one, the sounds are
+    // not part of the cache as they come and go without the file changing
+    m_nSounds = 0;
+    Char pattern[MAX_PATH];
+    ::_snprintf(pattern, MAX_PATH - 1, "%s\\*.wav", directory);
+    pattern[MAX_PATH - 1] = '\0';
+    WIN32_FIND_DATA findFileData;
+    HANDLE findHandle = ::FindFirstFile(pattern, &findFileData);
+    if (findHandle == INVALID_HANDLE_VALUE)
+        return;
+    do
+    {
+        if (m_nSounds == m_soundCapacity)
+        {
+            UInt capacity = (m_soundCapacity == 0) ? 64 : 2*m_soundCapacity;
+            Char (*sounds)[CATALOGPATH] = new Char[capacity][CATALOGPATH];
+            if (m_nSounds > 0)
+                ::memcpy(sounds, m_sounds, m_nSounds*CATALOGPATH);
+            SAFE_DELETE_ARRAY(m_sounds);
+            m_sounds        = sounds;
+            m_soundCapacity = capacity;
+        }
+        Int length = ::_snprintf(m_sounds[m_nSounds], CATALOGPATH, "%s\\%s", directory, findFileData.cFileName);
+        if ((length >= 0) && (length < CATALOGPATH))
+            ++m_nSounds;
+    }
+    while (::FindNextFile(findHandle, &findFileData));
+    ::FindClose(findHandle);
+    ::qsort(m_sounds, m_nSounds, CATALOGPATH, compareSounds);
+}
+
+
+void
+Catalog::add(const Entry& entry)
+{
+    if (m_nEntries == m_capacity)
+    {
+        UInt capacity = (m_capacity == 0) ? 64 : 2*m_capacity;
+        Entry* entries = new Entry[capacity];
+        if (m_nEntries > 0)
+            ::memcpy(entries, m_entries, m_nEntries*sizeof(Entry));
+        SAFE_DELETE_ARRAY(m_entries);
+        m_entries  = entries;
+        m_capacity = capacity;
+    }
+    m_entries[m_nEntries++] = entry;
+}
+
+
+const Catalog::Entry*
+Catalog::cached(const Entry& entry)
+{
+    if (m_nCache == 0)
+        return NULL;
+    const Entry* known = (const Entry*)::bsearch(&entry, m_cache, m_nCache, sizeof(Entry), comparePaths);
+    if ((known == NULL) || (known->size != entry.size) || (known->modified != entry.modified)
+        || (known->kind != entry.kind))
+        return NULL;
+    return known;
+}
+
+
+DWORD WINAPI
+Catalog::worker(LPVOID parameter)
+{
+    Catalog* catalog = (Catalog*)parameter;
+    for (;;)
+    {
+        LONG i = ::InterlockedIncrement(&catalog->m_next) - 1;
+        if (i >= LONG(catalog->m_nPending))
+            break;
+        parse(catalog->m_entries[catalog->m_pending[i]]);
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_CATALOG_H__
+#define __RACING_CATALOG_H__
+
+#include "Track.h"
+
+#define CATALOGFILE         "Catalog.dat"
+#define CATALOG_VERSION     2
+// longest path of a custom file, as the menus keep them
+#define CATALOGPATH         64
+// workers parsing files at most
+#define CATALOGTHREADS      8
+
+
+/*************************************************************************************
+ *@class Catalog
+ *@description
+ *    The custom tracks and vehicles on disk, Tracks\*.trk and Vehicles\*.vhc, and
+ *    what the menus need to know about them: whether the file reads as a track or
+ *    vehicle at all, whether its name sound is there, the length of a track and
+ *    the parameters of a vehicle. The directories are listed on the calling
+ *    thread, the files are parsed by a pool of workers.
+ *
+ *    What was found is kept in CATALOGFILE, keyed by path, size and time of the
+ *    last write, so a scan only parses the files that are new or changed since
+ *    the last one. The file is a Header followed by the Entry array, written
+ *    again whenever a scan parsed something or a file went away.
+ *************************************************************************************/
+class Catalog
+{
+public:
+    enum Kind
+    {
+        trackFile       = 0,
+        vehicleFile     = 1
+    };
+
+    struct Entry
+    {
+        Char            path[CATALOGPATH];      // "Tracks\name.trk", the way the menus name it
+        Char            sound[CATALOGPATH];     // the sound saying its name, "Tracks\name.wav"
+        UHuge           size;
+        UHuge           modified;               // time of the last write
+        UInt            kind;
+        Boolean         valid;
+        Boolean         hasSound;
+        // a track
+        UInt            segments;
+        UInt            lapLength;
+        UInt            weather;
+        UInt            ambience;
+        // a vehicle, the values Car reads
+        Int             acceleration;
+        Int             deceleration;
+        Int             topspeed;
+        Int             idlefreq;
+        Int             topfreq;
+        Int             shiftfreq;
+        Int             gears;
+        Int             steering;
+        Int             steeringFactor;
+        Int             hasWipers;
+    };
+
+    struct Header
+    {
+        Char            magic[4];
+        UInt            version;
+        UInt            entrySize;
+        UInt            nEntries;
+    };
+
+public:
+    Catalog(const Char* trackDirectory = "Tracks", const Char* vehicleDirectory = "Vehicles",
+            const Char* cacheFile = CATALOGFILE);
+    virtual ~Catalog( );
+
+public:
+    void            scan(UInt nThreads = 0);
+    UInt            nTracks( )                  { return m_nTracks;                 }
+    const Entry&    track(UInt i)               { return m_entries[i];              }
+    UInt            nVehicles( )                { return m_nEntries - m_nTracks;    }
+    const Entry&    vehicle(UInt i)             { return m_entries[m_nTracks + i];  }
+    UInt            nParsed( )                  { return m_nPending;                }
+
+public:
+    static void     parse(Entry& entry);
+
+private:
+    void            load( );
+    void            save( );
+    void            list(const Char* directory, const Char* extension, Kind kind);
+    void            listSounds(const Char* directory);
+    void            add(const Entry& entry);
+    const Entry*    cached(const Entry& entry);
+    static DWORD WINAPI worker(LPVOID parameter);
+
+private:
+    Char                m_trackDirectory[MAX_PATH];
+    Char                m_vehicleDirectory[MAX_PATH];
+    Char                m_cacheFile[MAX_PATH];
+    Entry*              m_entries;          // the tracks, then the vehicles
+    UInt                m_nEntries;
+    UInt                m_capacity;
+    UInt                m_nTracks;
+    Char              (*m_sounds)[CATALOGPATH]; // the .wav files of the directory being listed, sorted
+    UInt                m_nSounds;
+    UInt                m_soundCapacity;
+    Entry*              m_cache;            // as read from the cache file, sorted by path
+    UInt                m_nCache;
+    UInt*               m_pending;          // the entries the cache did not know
+    UInt                m_nPending;
+    volatile LONG       m_next;             // next of them a worker takes
+};
+
+
+#endif /* __RACING_CATALOG_H__ */
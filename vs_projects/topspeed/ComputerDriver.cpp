@@ -0,0 +1,212 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "ComputerDriver.h"
+
+// how far ahead a hairpin is noticed
+#define CALLLENGTH 3000
+
+
+// whether offset is more, or less, than percent of width; in whole numbers, so
+// every machine drives the same, and as the float quotients compared before
+static Boolean
+above(Int offset, Int width, Int percent)
+{
+    return Huge(offset)*100 > Huge(width)*percent;
+}
+
+
+static Boolean
+below(Int offset, Int width, Int percent)
+{
+    return Huge(offset)*100 < Huge(width)*percent;
+}
+
+
+ComputerDriver::ComputerDriver(Track* track, Int difficulty, Int random) :
+    m_track(track),
+    m_roadCursor(track),
+    m_aheadCursor(track),
+    m_difficulty(difficulty),
+    m_random(random),
+    m_relPos(0),
+    m_nextRelPos(0)
+{
+}
+
+
+ComputerDriver::~ComputerDriver( )
+{
+}
+
+
+void
+ComputerDriver::drive(Int positionX, Int positionY, Int& steering, Int& throttle)
+{
+    UInt laneWidth = m_track->laneWidth( );
+    Track::Road road = m_roadCursor.road(positionY);
+    m_relPos = Float(positionX - road.left) / (Float(laneWidth) *2.0f);
+    Track::Road nextRoad = m_aheadCursor.road(positionY + CALLLENGTH);
+    m_nextRelPos = Float(positionX - nextRoad.left) / (Float(laneWidth) * 2.0f);
+    Int offset = positionX - road.left;
+    Int width  = 2*Int(laneWidth);
+    throttle = 100;
+    steering = 0;
+    if ((road.type == Track::hairpinLeft) || (nextRoad.type == Track::hairpinLeft))
+    {
+        switch (m_difficulty)
+        {
+        case 0: // easy
+            if (above(offset, width, 65))
+                steering = -100;
+            // throttle = 100;
+            break;
+        case 1: // normal
+            if (above(offset, width, 55))
+                steering = -100;
+            throttle = 66;
+            break;
+        case 2: // hard
+            if (above(offset, width, 55))
+                steering = -100;
+            throttle = 33;
+            /* if ((brake == 0) && (m_speed >= m_topspeed/2))
+            {
+                brake = -100;
+                throttle = 0;
+            }
+            else if ((brake == -100) && (m_speed <= m_topspeed/3))
+            {
+                brake = 0;
+                throttle = 50;
+            }
+            else
+            {
+                brake = -25;
+                throttle = 0;
+            } */
+            break;
+        default:
+            break;
+        }
+    }
+    else if ((road.type == Track::hairpinRight) || (nextRoad.type == Track::hairpinRight))
+    {
+        switch (m_difficulty)
+        {
+        case 0: // easy
+            if (below(offset, width, 35))
+                steering = 100;
+            // throttle = 100;
+            break;
+        case 1: // normal
+            if (below(offset, width, 45))
+                steering = 100;
+            throttle = 66;
+            break;
+        case 2: // hard
+            if (below(offset, width, 45))
+                steering = 100;
+            throttle = 33;
+            /* if ((brake == 0) && (m_speed >= m_topspeed/2))
+            {
+                brake = -100;
+                throttle = 0;
+            }
+            else if ((brake == -100) && (m_speed <= m_topspeed/3))
+            {
+                brake = 0;
+                throttle = 50;
+            }
+            else
+            {
+                brake = -25;
+                throttle = 0;
+            } */
+            break;
+        default:
+            break;
+        }
+    }
+    else if (below(offset, width, 40))
+    {
+        if (above(offset, width, 20))
+        {
+            switch (m_difficulty)
+            {
+            case 0: // easy
+                steering = 100 - m_random/5;
+                break;
+            case 1: // normal
+                steering = 100 - m_random/10;
+                break;
+            case 2: // hard
+                steering = 100 - m_random/25;
+                break;
+            default:
+                break;
+            }
+        }
+        else
+        {
+            switch (m_difficulty)
+            {
+            case 0: // easy
+                steering = 100 - m_random/10;
+                break;
+            case 1: // normal
+                steering = 100 - m_random/20;
+                throttle = 75;
+                break;
+            case 2: // hard
+                steering = 100;
+                throttle = 50;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+    else if (above(offset, width, 60))
+    {
+        if (below(offset, width, 80))
+        {
+            switch (m_difficulty)
+            {
+            case 0: // easy
+                steering = -100 + m_random/5;
+                break;
+            case 1: // normal
+                steering = -100 + m_random/10;
+                break;
+            case 2: // hard
+                steering = -100 + m_random/25;
+                break;
+            default:
+                break;
+            }
+        }
+        else
+        {
+            switch (m_difficulty)
+            {
+            case 0: // easy
+                steering = -100 + m_random/10;
+                break;
+            case 1: // normal
+                steering = -100 + m_random/20;
+                throttle = 75;
+                break;
+            case 2: // hard
+                steering = -100;
+                throttle = 50;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
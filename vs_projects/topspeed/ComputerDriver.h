@@ -0,0 +1,42 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_COMPUTERDRIVER_H__
+#define __RACING_COMPUTERDRIVER_H__
+
+#include "Track.h"
+#include "RoadCursor.h"
+
+/*************************************************************************************
+ *@class ComputerDriver
+ *@description
+ *    The decisions of a computer player: looks at the road under the car and a
+ *    little ahead of it and picks steering and throttle. Holds no sounds and
+ *    reads no game state, so it can drive outside a running race as well.
+ *************************************************************************************/
+class ComputerDriver
+{
+public:
+    ComputerDriver(Track* track, Int difficulty, Int random);
+    virtual ~ComputerDriver( );
+
+public:
+    void        drive(Int positionX, Int positionY, Int& steering, Int& throttle);
+    Float       relPos( )                   { return m_relPos;      }
+    Float       nextRelPos( )               { return m_nextRelPos;  }
+
+private:
+    Track*              m_track;
+    RoadCursor          m_roadCursor;
+    RoadCursor          m_aheadCursor;
+    Int                 m_difficulty;
+    Int                 m_random;
+    Float               m_relPos;
+    Float               m_nextRelPos;
+};
+
+
+#endif /* __RACING_COMPUTERDRIVER_H__ */
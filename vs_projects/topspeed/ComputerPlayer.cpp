@@ -12,11 +12,12 @@
 #include "RaceInput.h"
 #include "Car.h"
 
-#define CALLLENGTH 3000
 extern Car::Parameters vehicles[NVEHICLES];
 
 ComputerPlayer::ComputerPlayer(Game* game, UInt vehicle, Track* track, Int playerNumber) :
     m_track(track),
+    m_roadCursor(track),
+    m_driver(track, game->raceSettings( ).difficulty, random(100)),
     m_surface(Track::asphalt),
     m_gear(1),
     m_state(stopped),
@@ -26,7 +27,6 @@ ComputerPlayer::ComputerPlayer(Game* game, UInt vehicle, Track* track, Int playe
     m_horning(false),
     m_game(game),
     m_soundManager(game->soundManager( )),
-    m_difficulty(game->raceSettings( ).difficulty),
     m_soundEngine(0),
     m_soundStart(0),
     m_soundHorn(0),
@@ -38,20 +38,15 @@ ComputerPlayer::ComputerPlayer(Game* game, UInt vehicle, Track* track, Int playe
     m_brakeFrequency(0),
     m_laneWidth(0),
     m_relPos(0),
-    m_nextRelPos(0),
     m_diffX(0),
     m_diffY(0),
     m_currentSteering(0),
     m_currentThrottle(0),
     m_currentBrake(0),
-    m_currentAcceleration(0),
-    m_currentDeceleration(0),
     m_speedDiff(0),
-    m_thrust(0),
     m_speed(0),
     m_frame(1),
-    m_finished(false),
-    m_random(random(100))
+    m_finished(false)
 {
     RACE("(+) ComputerPlayer");
     m_carType     = (CarType)vehicle;
@@ -64,7 +59,18 @@ ComputerPlayer::ComputerPlayer(Game* game, UInt vehicle, Track* track, Int playe
     m_gears         = vehicles[vehicle].gears;
     m_steering      = vehicles[vehicle].steering;
     m_steeringFactor= vehicles[vehicle].steeringFactor;
+    m_profile       = &VehicleProfile::official(vehicle);
     m_frequency     = m_idlefreq;
+    CarPhysics::Parameters physics;
+    physics.model           = CarPhysics::computer;
+    physics.acceleration    = m_acceleration;
+    physics.deceleration    = m_deceleration;
+    physics.topspeed        = m_topspeed;
+    physics.gears           = m_gears;
+    physics.steering        = m_steering;
+    physics.steeringFactor  = m_steeringFactor;
+    physics.profile         = m_profile;
+    m_physics.parameters(physics);
     m_soundEngine   = m_soundManager->create(vehicles[vehicle].engineSound, m_game->threeD( ));
     m_soundStart    = m_soundManager->create(vehicles[vehicle].startSound, m_game->threeD( ));
     m_soundHorn     = m_soundManager->create(vehicles[vehicle].hornSound, m_game->threeD( ));
@@ -122,6 +128,7 @@ ComputerPlayer::initialize(Int positionX, Int positionY, Int trackLength)
     RACE("ComputerPlayer::initialize");
     m_positionX = positionX;
     m_positionY = positionY;
+    m_physics.reset(positionX, positionY);
     m_trackLength = trackLength;
     m_laneWidth = m_track->laneWidth();
 //RACE("m_laneWidth = %d", m_laneWidth);
@@ -286,35 +293,31 @@ ComputerPlayer::run(Float elapsed, Int playerX, Int playerY)
     }
     if ((m_state == running) && (m_game->started( )))
     {
-        AI(/* playerY */);
-        
-        m_currentAcceleration = m_acceleration;
-        m_currentDeceleration = m_deceleration;
-        switch (m_surface)
+        // the AI decides again before every physics step
+        m_physics.sync(m_positionX, m_positionY, m_speed);
+        UInt steps = m_physics.accumulate(elapsed);
+        for (UInt i = 0; i < steps; ++i)
         {
-            case Track::gravel:
-                m_currentAcceleration = (m_currentAcceleration*2)/3;
-                m_currentDeceleration = (m_currentDeceleration*2)/3;
-                break;
-            case Track::water:
-                m_currentAcceleration = (m_currentAcceleration*3)/5;
-                m_currentDeceleration = (m_currentDeceleration*3)/5;
-                break;
-            case Track::sand:
-                m_currentAcceleration = (m_currentAcceleration*3)/8;
-                m_currentDeceleration = (m_currentDeceleration*5)/4;
-                break;
-            case Track::snow:
-                // m_currentAcceleration = m_currentAcceleration;
-                m_currentDeceleration = (m_currentDeceleration)/2;
-                break;
-            default:
-                break;
+            m_positionX = Int(m_physics.state( ).positionX);
+            m_positionY = Int(m_physics.state( ).positionY);
+            m_speed     = Int(m_physics.state( ).speed);
+            m_driver.drive(m_positionX, m_positionY, m_currentSteering, m_currentThrottle);
+            CarPhysics::Input input;
+            input.steering  = m_currentSteering;
+            input.throttle  = m_currentThrottle;
+            input.brake     = m_currentBrake;
+            input.gear      = 0;
+            input.surface   = (Track::Surface)m_surface;
+            m_physics.step(input);
         }
+        m_physics.publish( );
+        m_positionX = m_physics.positionX( );
+        m_positionY = m_physics.positionY( );
+        m_speed     = m_physics.speed( );
+        m_currentSteering = m_physics.steering( );
 
         if (m_currentThrottle == 0)
         {
-            m_thrust = m_currentBrake;
             if (m_currentBrake != 0)
             {
                 if ((m_surface == Track::asphalt) && (!m_soundBrake->playing( )))
@@ -325,33 +328,9 @@ ComputerPlayer::run(Float elapsed, Int playerX, Int playerY)
         }
         else if (m_currentBrake == 0)
         {
-            m_thrust = m_currentThrottle;
             if (m_soundBrake->playing( ))
                 m_soundBrake->stop( );
         }
-        else if (-m_currentBrake > m_currentThrottle)
-            m_thrust = m_currentBrake;
-        if (m_thrust > 10)
-            m_speedDiff = Int(elapsed*m_thrust*m_currentAcceleration);
-        else if (m_thrust < -10)
-            m_speedDiff = Int(elapsed*m_thrust*m_currentDeceleration);
-        else
-            m_speedDiff = Int(elapsed*-1000);
-        if (m_speedDiff > 0)
-            m_speedDiff = (Int)(m_speedDiff * (2.0f - ((m_topspeed + m_speed)*1.0f/(2.0f*m_topspeed))));
-        m_speed += m_speedDiff;
-        if (m_speed > m_topspeed)
-            m_speed = m_topspeed;
-        if (m_speed < 0)
-            m_speed = 0;
-        if ((m_thrust < -50) && (m_speed > 5000))
-            m_currentSteering = m_currentSteering*2/3;
-
-        m_positionY += Int(m_speed*elapsed);
-        if (m_surface != Track::snow)
-            m_positionX += Int(m_currentSteering*elapsed*m_steering*((5000.0f + m_speed*m_steeringFactor/100)/m_topspeed));
-        else
-            m_positionX += Int(m_currentSteering*elapsed*(m_steering*1.44f)*((5000.0f + m_speed*m_steeringFactor/100)/m_topspeed));
 
         // update frequencies
         if (m_frame % 4 == 0)
@@ -365,15 +344,15 @@ ComputerPlayer::run(Float elapsed, Int playerX, Int playerY)
             }
             updateEngineFreq( );
         }
-        Track::Road road = m_track->roadComputer(m_positionY);
+        Track::Road road = m_roadCursor.road(m_positionY);
         if (!finished( ))
             evaluate(road);
     }
     else if (m_state == stopping)
     {
-        m_speed -= Int(elapsed*100*m_deceleration);
-        if (m_speed < 0)
-            m_speed = 0;
+        m_physics.sync(m_positionX, m_positionY, m_speed);
+        m_physics.runStopping(elapsed);
+        m_speed = m_physics.speed( );
         // update frequencies
         if (m_frame % 4 == 0)
         {
@@ -395,39 +374,33 @@ ComputerPlayer::run(Float elapsed, Int playerX, Int playerY)
     }
 
     // Handle events
-    Event* e = 0;
-    while (e = m_eventList.next(e))
+    Event e;
+    while (m_events.popDue(m_game->currentTime( ), e))
     {
-        if (e->time < m_game->currentTime( ))
+        switch (e.type)
         {
-            m_eventList.purge(e);
-            switch (e->type)
-            {
-		case Event::carStart:
-                m_soundEngine->frequency(m_idlefreq);
-                m_soundEngine->play(0, true);
-                m_state = running;
-                break;
-            case Event::carComputerStart:
-                start( );
-                break;
-            case Event::carRestart:
-                start( );
-                break;
-            case Event::inGear:
-                m_switchingGear = 0;
-                break;
-            case Event::stopHorn:
-                m_horning = false;
-                break;
-            case Event::startHorn:
-                m_horning = true;
-                break;
-            default:
-                break;
-            }
-            delete e;
-            e = 0;
+	case Event::carStart:
+            m_soundEngine->frequency(m_idlefreq);
+            m_soundEngine->play(0, true);
+            m_state = running;
+            break;
+        case Event::carComputerStart:
+            start( );
+            break;
+        case Event::carRestart:
+            start( );
+            break;
+        case Event::inGear:
+            m_switchingGear = 0;
+            break;
+        case Event::stopHorn:
+            m_horning = false;
+            break;
+        case Event::startHorn:
+            m_horning = true;
+            break;
+        default:
+            break;
         }
     }
 }
@@ -468,29 +441,19 @@ ComputerPlayer::evaluate(Track::Road road)
 void 
 ComputerPlayer::pushEvent(Event::Type type, Float time)
 {
-    Event* e = new Event;
-    e->type = type;
-    e->time = m_game->currentTime( ) + time;
-    m_eventList.push(e);
+    m_events.schedule(type, m_game->currentTime( ) + time);
 }
 
 
 void 
 ComputerPlayer::updateEngineFreq( )
 {
-    Int gearRange = m_topspeed/(m_gears+1);
-    if ((m_speed / gearRange) < 2)
-    {
-        Float gearSpeed = (m_speed / (2.0f*gearRange));
-        m_frequency = Int(gearSpeed*(m_topfreq - m_idlefreq)) + m_idlefreq;
-    }
-    else
+    Boolean shifted;
+    m_frequency = m_profile->frequency(m_speed, shifted);
+    if (m_profile->gear(m_speed) > 0)
     {
-        Int gear = m_speed / gearRange;
-        Float gearSpeed = (m_speed - gear*gearRange)/(1.0f*gearRange);
-        if (gearSpeed < 0.07f)
+        if (shifted)
         {
-            m_frequency = Int(((0.07f - gearSpeed)/0.07f)*(m_topfreq - m_shiftfreq) + m_shiftfreq);
             if (m_soundBackfire != 0)
             {
                 if (m_backfirePlayedAuto == false)
@@ -503,7 +466,6 @@ ComputerPlayer::updateEngineFreq( )
         }
         else
         {
-            m_frequency = Int(gearSpeed*(m_topfreq - m_shiftfreq) + m_shiftfreq);
             if (m_soundBackfire != 0)
             {
                 if (m_backfirePlayedAuto == true)
@@ -526,6 +488,7 @@ ComputerPlayer::calculateAcceleration( )
     Int gearCenter = (Int)(gearSpeed*(m_gear - 0.82f));
     m_speedDiff = m_speed - gearCenter;
     Float relSpeedDiff = m_speedDiff/(gearSpeed*1.0f);
+    Int acceleration = m_profile->gearFactor(m_gear, Float(m_speed));
     if (relSpeedDiff > 1.1f)
     {
         m_switchingGear = 1;
@@ -538,226 +501,7 @@ ComputerPlayer::calculateAcceleration( )
         --m_gear;
         pushEvent(Event::inGear, 0.2f);
     }
-    if (absval<Float>(relSpeedDiff) < 1.9f)
-    {
-        Int acceleration = Int(100*(0.5f+cosf(relSpeedDiff*(DirectX::Pi)*0.5f)));
-        if (acceleration < 5)
-            return 5;
-        else 
-            return acceleration;
-    }
-    else
-    {
-        Int acceleration = Int(100*(0.5f+cosf(0.95f*(DirectX::Pi))));
-        if (acceleration < 5)
-            return 5;
-        else
-            return acceleration;
-    }
-}
-
-void 
-ComputerPlayer::AI(/* Int playerPosY */)
-{
-    /* switch (m_difficulty)
-    {
-        case 0: // easy
-            if (playerPosY < m_positionY)
-            {
-                if (m_speed > m_topspeed*(35 + m_random/20)/60)
-                    m_currentThrottle = 0;
-                else
-                    m_currentThrottle = 55 + m_random/10;
-            }
-            else 
-                m_currentThrottle = 80;
-            break;
-        case 1: // normal
-            if (playerPosY < m_positionY)
-            {
-                if (m_speed > m_topspeed*(45 + m_random/20)/60)
-                    m_currentThrottle = 0;
-                else
-                    m_currentThrottle = 65 + m_random/10;
-            }
-            else 
-                m_currentThrottle = 100;
-            break;
-        case 2: // hard
-            if (playerPosY < m_positionY)
-            {
-                if (m_speed > m_topspeed*(55 + m_random/20)/60)
-                    m_currentThrottle = 0;
-                else
-                    m_currentThrottle = 75 + m_random/10;
-            }
-            else 
-                m_currentThrottle = 100;
-            break;
-        default:
-            break;
-    } */
-
-    Track::Road road = m_track->roadComputer(m_positionY);
-    m_relPos = Float(m_positionX - road.left) / (Float(m_laneWidth) *2.0f);
-    Track::Road nextRoad = m_track->roadComputer(m_positionY + CALLLENGTH);
-    m_nextRelPos = Float(m_positionX - nextRoad.left) / (Float(m_laneWidth) * 2.0f);
-    m_currentThrottle = 100;
-    m_currentSteering = 0;
-    if ((road.type == Track::hairpinLeft) || (nextRoad.type == Track::hairpinLeft))
-    {
-        switch (m_difficulty)
-        {
-        case 0: // easy
-            if (m_relPos > 0.65f)
-                m_currentSteering = -100;
-            // m_currentThrottle = 100;
-            break;
-        case 1: // normal
-            if (m_relPos > 0.55f)
-                m_currentSteering = -100;
-            m_currentThrottle = 66;
-            break;
-        case 2: // hard
-            if (m_relPos > 0.55f)
-                m_currentSteering = -100;
-            m_currentThrottle = 33;
-            /* if ((m_currentBrake == 0) && (m_speed >= m_topspeed/2))
-            {
-                m_currentBrake = -100;
-                m_currentThrottle = 0;
-            }
-            else if ((m_currentBrake == -100) && (m_speed <= m_topspeed/3))
-            {
-                m_currentBrake = 0;
-                m_currentThrottle = 50;
-            }
-            else
-            {
-                m_currentBrake = -25;
-                m_currentThrottle = 0;
-            } */
-            break;
-        default:
-            break;
-        }
-    }
-    else if ((road.type == Track::hairpinRight) || (nextRoad.type == Track::hairpinRight))
-    {
-        switch (m_difficulty)
-        {
-        case 0: // easy
-            if (m_relPos < 0.35f)
-                m_currentSteering = 100;
-            // m_currentThrottle = 100;
-            break;
-        case 1: // normal
-            if (m_relPos < 0.45f)
-                m_currentSteering = 100;
-            m_currentThrottle = 66;
-            break;
-        case 2: // hard
-            if (m_relPos < 0.45f)
-                m_currentSteering = 100;
-            m_currentThrottle = 33;
-            /* if ((m_currentBrake == 0) && (m_speed >= m_topspeed/2))
-            {
-                m_currentBrake = -100;
-                m_currentThrottle = 0;
-            }
-            else if ((m_currentBrake == -100) && (m_speed <= m_topspeed/3))
-            {
-                m_currentBrake = 0;
-                m_currentThrottle = 50;
-            }
-            else
-            {
-                m_currentBrake = -25;
-                m_currentThrottle = 0;
-            } */
-            break;
-        default:
-            break;
-        }
-    }
-    else if (m_relPos < 0.40f)
-    {
-        if (m_relPos > 0.2f)
-        {
-            switch (m_difficulty)
-            {
-            case 0: // easy
-                m_currentSteering = 100 - m_random/5;
-                break;
-            case 1: // normal
-                m_currentSteering = 100 - m_random/10;
-                break;
-            case 2: // hard
-                m_currentSteering = 100 - m_random/25;
-                break;
-            default:
-                break;
-            }
-        }
-        else
-        {
-            switch (m_difficulty)
-            {
-            case 0: // easy
-                m_currentSteering = 100 - m_random/10;
-                break;
-            case 1: // normal
-                m_currentSteering = 100 - m_random/20;
-                m_currentThrottle = 75;
-                break;
-            case 2: // hard
-                m_currentSteering = 100;
-                m_currentThrottle = 50;
-                break;
-            default:
-                break;
-            }
-        }
-    }
-    else if (m_relPos > 0.6f)
-    {
-        if (m_relPos < 0.8f)
-        {
-            switch (m_difficulty)
-            {
-            case 0: // easy
-                m_currentSteering = -100 + m_random/5;
-                break;
-            case 1: // normal
-                m_currentSteering = -100 + m_random/10;
-                break;
-            case 2: // hard
-                m_currentSteering = -100 / m_random/25;
-                break;
-            default:
-                break;
-            }
-        }
-        else
-        {
-            switch (m_difficulty)
-            {
-            case 0: // easy
-                m_currentSteering = -100 + m_random/10;
-                break;
-            case 1: // normal
-                m_currentSteering = -100 + m_random/20;
-                m_currentThrottle = 75;
-                break;
-            case 2: // hard
-                m_currentSteering = -100;
-                m_currentThrottle = 50;
-                break;
-            default:
-                break;
-            }
-        }
-    }
+    return acceleration;
 }
 
 void 
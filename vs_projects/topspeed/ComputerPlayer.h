@@ -11,6 +11,10 @@
 
 #include "Game.h"
 #include "Track.h"
+#include "RoadCursor.h"
+#include "ComputerDriver.h"
+#include "CarPhysics.h"
+#include "EventScheduler.h"
 #include "Packets.h"
 
 class ComputerPlayer
@@ -69,7 +73,6 @@ public:
 //    DirectX::Sound* onTail( )                       { return m_soundOnTail;     }
 
 private:
-    void AI(/* Int playerPosY */);
     Int calculateAcceleration( );
 
     void updateEngineFreq( );
@@ -83,6 +86,8 @@ private:
     State                   m_state;
     Game*                   m_game;
     Track*                  m_track;
+    RoadCursor              m_roadCursor;
+    ComputerDriver          m_driver;
     DirectX::SoundManager*  m_soundManager;
     DirectX::Sound*         m_soundEngine;
     DirectX::Sound*         m_soundHorn;
@@ -95,11 +100,12 @@ private:
 
 //    DirectX::Sound*         m_soundInFront;
 //    DirectX::Sound*         m_soundOnTail;
-    EventList               m_eventList;
+    EventScheduler          m_events;
     Int                     m_frame;
 
     Int                     m_surface;
 
+    CarPhysics              m_physics;
     Int                     m_speed;
     Int                     m_gear;
     Int                     m_positionX;
@@ -118,28 +124,23 @@ private:
     Int                     m_gears;
     Int                     m_steering;
     Int                     m_steeringFactor;
+    const VehicleProfile*   m_profile;
 
     Int                     m_playerNumber;
     // Int                     m_position;
-    Int                     m_random;
     UInt                    m_prevFrequency;
     UInt                    m_frequency;
     UInt                    m_prevBrakeFrequency;
     UInt                    m_brakeFrequency;
     UInt                    m_laneWidth;
     Float                   m_relPos;
-    Float                   m_nextRelPos;
     // Int                     m_panPos;
     Int                     m_diffX;
     Int                     m_diffY;
     Int                     m_currentSteering;
     Int                     m_currentThrottle;
     Int                     m_currentBrake;
-    Int                     m_currentAcceleration;
-    Int                     m_currentDeceleration;
     Int                     m_speedDiff;
-    Int                     m_thrust;
-    Int                     m_difficulty;
     Boolean                 m_finished;
     Boolean                 m_horning;
     Boolean                 m_backfirePlayedAuto;
@@ -0,0 +1,283 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "EventScheduler.h"
+#include <algorithm>
+
+#define SLOTBITS        32
+#define SLOTMASK        0xffffffff
+#define NOSLOT          0xffffffff
+
+
+EventScheduler::EventScheduler(UInt capacity) :
+    m_slots(0),
+    m_heap(0),
+    m_order(0),
+    m_capacity(capacity),
+    m_size(0),
+    m_free(NOSLOT),
+    m_sequence(0)
+{
+    if (m_capacity == 0)
+        m_capacity = 1;
+    m_slots = new Slot[m_capacity];
+    m_heap  = new UInt[m_capacity];
+    m_order = new UInt[m_capacity];
+    for (UInt i = 0; i < m_capacity; ++i)
+        m_slots[i].generation = 0;
+    clear( );
+}
+
+
+EventScheduler::~EventScheduler( )
+{
+    SAFE_DELETE_ARRAY(m_slots);
+    SAFE_DELETE_ARRAY(m_heap);
+    SAFE_DELETE_ARRAY(m_order);
+}
+
+
+EventScheduler::Handle
+EventScheduler::schedule(Event::Type type, Float time, DirectX::Sound* sound)
+{
+    if (m_free == NOSLOT)
+        grow( );
+    UInt index = m_free;
+    Slot& s = m_slots[index];
+    m_free = s.nextFree;
+    s.event.type     = type;
+    s.event.time     = time;
+    s.event.sound    = sound;
+    s.event.next     = 0;
+    s.event.previous = 0;
+    s.sequence       = m_sequence++;
+    s.heapIndex      = m_size;
+    m_heap[m_size++] = index;
+    siftUp(s.heapIndex);
+    return (Handle(s.generation) << SLOTBITS) | (index + 1);
+}
+
+
+Boolean
+EventScheduler::cancel(Handle handle)
+{
+    Slot* s = slot(handle);
+    if (s == 0)
+        return false;
+    UInt index = s->heapIndex;
+    remove(index);
+    return true;
+}
+
+
+Boolean
+EventScheduler::reschedule(Handle handle, Float time)
+{
+    Slot* s = slot(handle);
+    if (s == 0)
+        return false;
+    s->event.time = time;
+    s->sequence = m_sequence++;
+    siftUp(s->heapIndex);
+    siftDown(s->heapIndex);
+    return true;
+}
+
+
+Boolean
+EventScheduler::popDue(Float now, Event& event)
+{
+    if ((m_size == 0) || (m_slots[m_heap[0]].event.time > now))
+        return false;
+    event = m_slots[m_heap[0]].event;
+    remove(0);
+    return true;
+}
+
+
+void
+EventScheduler::cancelSounds( )
+{
+    UInt kept = 0;
+    for (UInt i = 0; i < m_size; ++i)
+    {
+        UInt index = m_heap[i];
+        if (m_slots[index].event.sound)
+            release(index);
+        else
+            m_heap[kept++] = index;
+    }
+    m_size = kept;
+    // rebuild the heap over what is left
+    for (UInt i = 0; i < m_size; ++i)
+        m_slots[m_heap[i]].heapIndex = i;
+    for (UInt i = m_size/2; i > 0; --i)
+        siftDown(i - 1);
+}
+
+
+void
+EventScheduler::clear( )
+{
+    for (UInt i = 0; i < m_size; ++i)
+        ++m_slots[m_heap[i]].generation;
+    m_size = 0;
+    m_free = NOSLOT;
+    for (UInt i = m_capacity; i > 0; --i)
+    {
+        m_slots[i - 1].heapIndex = NOSLOT;
+        m_slots[i - 1].nextFree = m_free;
+        m_free = i - 1;
+    }
+}
+
+
+Boolean
+EventScheduler::save(Event* events, UInt max, UInt& nSaved) const
+{
+    nSaved = 0;
+    if (m_size > max)
+    {
+        RACE("(!) EventScheduler::save : %d events pending, room for %d, none saved", m_size, max);
+        return false;
+    }
+    // the heap only orders parents before their children
+    for (UInt i = 0; i < m_size; ++i)
+        m_order[i] = i;
+    DueBefore dueBefore = { this };
+    std::sort(m_order, m_order + m_size, dueBefore);
+    for (UInt i = 0; i < m_size; ++i)
+        events[i] = m_slots[m_heap[m_order[i]]].event;
+    nSaved = m_size;
+    return true;
+}
+
+
+Boolean
+EventScheduler::before(UInt a, UInt b) const
+{
+    const Slot& sa = m_slots[m_heap[a]];
+    const Slot& sb = m_slots[m_heap[b]];
+    if (sa.event.time != sb.event.time)
+        return sa.event.time < sb.event.time;
+    // sequence numbers wrap, compare their distance instead
+    return Int(sa.sequence - sb.sequence) < 0;
+}
+
+
+EventScheduler::Slot*
+EventScheduler::slot(Handle handle) const
+{
+    UInt index = UInt(handle & SLOTMASK);
+    if ((index == 0) || (index > m_capacity))
+        return 0;
+    Slot* s = &m_slots[index - 1];
+    if (s->generation != UInt(handle >> SLOTBITS))
+        return 0;
+    if ((s->heapIndex >= m_size) || (m_heap[s->heapIndex] != index - 1))
+        return 0;
+    return s;
+}
+
+
+void
+EventScheduler::siftUp(UInt index)
+{
+    while (index > 0)
+    {
+        UInt parent = (index - 1)/2;
+        if (!before(index, parent))
+            break;
+        UInt t = m_heap[index];
+        m_heap[index] = m_heap[parent];
+        m_heap[parent] = t;
+        m_slots[m_heap[index]].heapIndex = index;
+        m_slots[m_heap[parent]].heapIndex = parent;
+        index = parent;
+    }
+}
+
+
+void
+EventScheduler::siftDown(UInt index)
+{
+    for (;;)
+    {
+        UInt smallest = index;
+        UInt left = 2*index + 1;
+        UInt right = left + 1;
+        if ((left < m_size) && before(left, smallest))
+            smallest = left;
+        if ((right < m_size) && before(right, smallest))
+            smallest = right;
+        if (smallest == index)
+            break;
+        UInt t = m_heap[index];
+        m_heap[index] = m_heap[smallest];
+        m_heap[smallest] = t;
+        m_slots[m_heap[index]].heapIndex = index;
+        m_slots[m_heap[smallest]].heapIndex = smallest;
+        index = smallest;
+    }
+}
+
+
+void
+EventScheduler::remove(UInt index)
+{
+    UInt removed = m_heap[index];
+    --m_size;
+    if (index != m_size)
+    {
+        UInt moved = m_heap[m_size];
+        m_heap[index] = moved;
+        m_slots[moved].heapIndex = index;
+        siftUp(index);
+        siftDown(m_slots[moved].heapIndex);
+    }
+    release(removed);
+}
+
+
+void
+EventScheduler::release(UInt slot)
+{
+    Slot& s = m_slots[slot];
+    ++s.generation;
+    s.heapIndex = NOSLOT;
+    s.nextFree = m_free;
+    m_free = slot;
+}
+
+
+// all slots are in use: twice as many, the new ones free; slot numbers and
+// generations stay, so the handles out there stay valid
+void
+EventScheduler::grow( )
+{
+    UInt capacity = 2*m_capacity;
+    RACE("EventScheduler::grow : %d events pending, room for %d", m_size, capacity);
+    Slot* slots = new Slot[capacity];
+    UInt* heap  = new UInt[capacity];
+    for (UInt i = 0; i < m_capacity; ++i)
+        slots[i] = m_slots[i];
+    for (UInt i = 0; i < m_size; ++i)
+        heap[i] = m_heap[i];
+    SAFE_DELETE_ARRAY(m_order);
+    m_order = new UInt[capacity];
+    for (UInt i = capacity; i > m_capacity; --i)
+    {
+        slots[i - 1].generation = 0;
+        slots[i - 1].heapIndex  = NOSLOT;
+        slots[i - 1].nextFree   = m_free;
+        m_free = i - 1;
+    }
+    SAFE_DELETE_ARRAY(m_slots);
+    SAFE_DELETE_ARRAY(m_heap);
+    m_slots    = slots;
+    m_heap     = heap;
+    m_capacity = capacity;
+}
@@ -0,0 +1,90 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_EVENTSCHEDULER_H__
+#define __RACING_EVENTSCHEDULER_H__
+
+#include "Game.h"
+
+// events the pool starts with, it doubles whenever it runs out
+#define EVENTPOOLSIZE 256
+
+
+/*************************************************************************************
+ *@class EventScheduler
+ *@description
+ *    Pending events ordered by due time in a binary heap. Events are kept in a
+ *    pool that doubles when it runs out, so scheduling only allocates when more
+ *    events are pending than ever before, and finding the due events costs
+ *    nothing for the ones that are not due yet. Events due at the same time
+ *    come out in the order they were scheduled. A handle stays valid until its
+ *    event is popped or cancelled, stale handles are ignored.
+ *
+ *    save copies all pending events out in the order they come due, or none
+ *    when there are more than the room given for them; scheduling them again in
+ *    that order after a clear puts the scheduler back the way it was, except for
+ *    the handles handed out before.
+ *************************************************************************************/
+class EventScheduler
+{
+public:
+    // the slot number plus one in the low half, so 0 is never valid, and the
+    // generation of the slot in the high half
+    typedef UHuge Handle;
+
+public:
+    EventScheduler(UInt capacity = EVENTPOOLSIZE);
+    virtual ~EventScheduler( );
+
+public:
+    Handle      schedule(Event::Type type, Float time, DirectX::Sound* sound = 0);
+    Boolean     cancel(Handle handle);
+    Boolean     reschedule(Handle handle, Float time);
+    Boolean     popDue(Float now, Event& event);
+    void        cancelSounds( );
+    void        clear( );
+    Boolean     save(Event* events, UInt max, UInt& nSaved) const;
+    UInt        pending( ) const            { return m_size;        }
+    UInt        capacity( ) const           { return m_capacity;    }
+
+private:
+    struct Slot
+    {
+        Event       event;
+        UInt        sequence;
+        UInt        generation;
+        UInt        heapIndex;
+        UInt        nextFree;
+    };
+
+    // orders heap indices by due time, for save
+    struct DueBefore
+    {
+        const EventScheduler* scheduler;
+        Boolean operator()(UInt a, UInt b) const  { return scheduler->before(a, b); }
+    };
+
+private:
+    Boolean     before(UInt a, UInt b) const;
+    Slot*       slot(Handle handle) const;
+    void        siftUp(UInt index);
+    void        siftDown(UInt index);
+    void        remove(UInt index);
+    void        release(UInt slot);
+    void        grow( );
+
+private:
+    Slot*               m_slots;
+    UInt*               m_heap;
+    UInt*               m_order;        // room for save to sort every pending event
+    UInt                m_capacity;
+    UInt                m_size;
+    UInt                m_free;
+    UInt                m_sequence;
+};
+
+
+#endif /* __RACING_EVENTSCHEDULER_H__ */
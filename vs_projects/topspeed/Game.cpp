@@ -17,6 +17,8 @@
 #include "RaceServer.h"
 #include "RaceClient.h"
 #include "RaceInput.h"
+#include "SurfaceTable.h"
+#include "CarPhysics.h"
 #include "resource.h"
 #include "Common\If\Algorithm.h"
 
@@ -27,6 +29,8 @@ Tracer  _raceTracer("race");
 Game::Game( ) :
     m_initialized(false),
     m_soundManager(0),
+    m_mixer(0),
+    m_mixerOutput(0),
     m_raceInput(0),
     m_menu(0),
     m_levelTimeTrial(0),
@@ -40,8 +44,16 @@ Game::Game( ) :
     m_raceClient(0),
     m_serverStarted(false),
     m_threeD(m_raceSettings.threeD),
-    m_pauseKeyReleased(true)
+    m_pauseKeyReleased(true),
+    m_recording(false),
+    m_replaying(false),
+    m_savedLaps(0),
+    m_savedComputers(0),
+    m_savedDifficulty(0),
+    m_savedArithmetic(0)
 {
+    m_replayFile[0] = '\0';
+    m_soundMixer[0] = '\0';
     RACE("(+) Game");
     RACE("Game : initializing COM");
     HRESULT hres = CoInitializeEx(NULL, COINIT_MULTITHREADED);
@@ -65,7 +77,18 @@ Game::~Game( )
     SAFE_DELETE(m_levelTimeTrial);
     SAFE_DELETE(m_levelSingleRace);
     SAFE_DELETE(m_levelMultiplayer);
+    RACE("Game : sound cache %d hits, %d misses, %d evictions, %I64u bytes decoded",
+         pcmCache.hits( ), pcmCache.misses( ), pcmCache.evictions( ), pcmCache.bytesDecoded( ));
     SAFE_DELETE(m_soundManager);
+    if (m_mixer)
+    {
+        m_mixer->stopThread( );
+        RACE("Game : mixer %I64u blocks, %.1f us a block, %.1f us longest, of %.1f us, %d voices in real time",
+             m_mixer->blocks( ), m_mixer->mixTime( ), m_mixer->maxMixTime( ), m_mixer->blockTime( ),
+             m_mixer->maxVoices( ));
+    }
+    SAFE_DELETE(m_mixer);
+    SAFE_DELETE(m_mixerOutput);
     SAFE_DELETE(m_inputManager);
     RACE("~Game : uninitializing COM");
     CoUninitialize();
@@ -77,7 +100,19 @@ void
 Game::initialize(::Window::Handle handle)
 {
     RACE("Game::initialize : handle = %d", (UInt) handle);
-    m_soundManager = new DirectX::SoundManager(handle, 2, 44100, 16);
+    if (m_soundMixer[0] != '\0')
+    {
+        RACE("Game::initialize : sounds through the software mixer into %s", m_soundMixer);
+        if (_stricmp(m_soundMixer, "null") == 0)
+            m_mixerOutput = new DirectX::NullOutput;
+        else
+            m_mixerOutput = new DirectX::WaveFileOutput(m_soundMixer);
+        m_mixer = new DirectX::Mixer(m_mixerOutput);
+        m_mixer->startThread( );
+        m_soundManager = new DirectX::SoundManager(m_mixer);
+    }
+    else
+        m_soundManager = new DirectX::SoundManager(handle, 2, 44100, 16);
     if (!m_raceSettings.hardwareAcceleration)
         m_soundManager->playInSoftware(true);
     m_soundManager->reverseStereo(m_raceSettings.reverseStereo);
@@ -88,6 +123,8 @@ Game::initialize(::Window::Handle handle)
     m_raceInput->initialize( );
     m_raceServer = new RaceServer(this);
     m_raceClient = new RaceClient(this);
+    // how cars handle on the road surfaces, the built-in table without the file
+    SurfaceTable::load("surfaces.cfg");
 
     Char numberSound[12];
     for (UInt i = 0; i <= 100; ++i)
@@ -108,11 +145,27 @@ Game::run( )
     if (m_initialized)
     {
         Huge helapsed = m_timer.microElapsed( );
-        Float elapsed = helapsed / 1000000.0f;
-        m_currentTime += elapsed;
         m_inputManager->update( );
         m_inputState = m_inputManager->state( );
         m_raceInput->run(m_inputState);
+        if (m_replaying)
+        {
+            // the time and actions of the frame as it was recorded
+            UInt replayElapsed;
+            RaceReplay::Actions actions;
+            if (!m_replay.next(replayElapsed, actions))
+            {
+                RACE("Game::run : end of the replay");
+                state(menu);
+                return;
+            }
+            helapsed = replayElapsed;
+            m_raceInput->actions(actions);
+        }
+        else if (m_recording)
+            m_replay.add(UInt(helapsed), m_raceInput->actions( ));
+        Float elapsed = helapsed / 1000000.0f;
+        m_currentTime += elapsed;
         switch (m_state)
         {
         case menu:
@@ -237,6 +290,7 @@ Game::state(State state)
     switch (state)
     {
         case menu:
+            stopReplay( );
             if ((m_state == quickStart) || (m_state == timeTrial) || (m_state == singleRace) || (m_state == multiplayer))
             {
                 if (m_levelTimeTrial)
@@ -316,6 +370,7 @@ Game::state(State state)
                 m_menu->finalize( );
                 SAFE_DELETE(m_menu);
             }
+            startReplay(RaceReplay::timeTrial);
             m_levelTimeTrial = new LevelTimeTrial(this, m_raceSettings.nrOfLaps, m_nextTrack, m_nextAutomaticTransmission, m_nextVehicle, m_nextVehicleFile);
             m_levelTimeTrial->initialize( );
             m_timer.microElapsed( );
@@ -328,6 +383,7 @@ Game::state(State state)
                 m_menu->finalize( );
                 SAFE_DELETE(m_menu);
             }
+            startReplay(RaceReplay::singleRace);
             m_levelSingleRace = new LevelSingleRace(this, m_raceSettings.nrOfLaps, m_nextTrack, m_nextAutomaticTransmission, m_nextVehicle, m_nextVehicleFile);
             m_levelSingleRace->initialize(random(m_raceSettings.nrOfComputers+1));
             m_timer.microElapsed( );
@@ -422,6 +478,105 @@ Game::nextAutomaticTransmission(Boolean b)
 */
 
 
+void
+Game::soundMixer(const Char* output)
+{
+    ::strncpy(m_soundMixer, output, MAX_PATH - 1);
+    m_soundMixer[MAX_PATH - 1] = '\0';
+}
+
+
+void
+Game::recordReplays(const Char* filename)
+{
+    ::strncpy(m_replayFile, filename, MAX_PATH - 1);
+    m_replayFile[MAX_PATH - 1] = '\0';
+}
+
+
+Boolean
+Game::replay(const Char* filename)
+{
+    RACE("Game::replay : %s", filename);
+    if (!m_replay.read(filename))
+        return false;
+    const RaceReplay::Setup& setup = m_replay.setup( );
+    if (::strlen(setup.vehicleFile) >= 128)
+    {
+        RACE("(!) Game::replay : vehicle file name too long");
+        return false;
+    }
+    m_recording = false;
+    m_replaying = true;
+    // the race is played with the settings it had, the player's own come back after
+    m_savedLaps       = m_raceSettings.nrOfLaps;
+    m_savedComputers  = m_raceSettings.nrOfComputers;
+    m_savedDifficulty = m_raceSettings.difficulty;
+    m_savedArithmetic = CarPhysics::defaultArithmetic( );
+    m_raceSettings.nrOfLaps      = setup.laps;
+    m_raceSettings.nrOfComputers = setup.computers;
+    m_raceSettings.difficulty    = setup.difficulty;
+    CarPhysics::defaultArithmetic(CarPhysics::Arithmetic(setup.arithmetic));
+    ::strncpy(m_nextTrack, setup.track, sizeof(m_nextTrack) - 1);
+    m_nextTrack[sizeof(m_nextTrack) - 1] = '\0';
+    nextVehicle(setup.vehicle, (setup.vehicleFile[0] != '\0') ? (Char*)setup.vehicleFile : NULL);
+    m_nextAutomaticTransmission = setup.automaticTransmission;
+    state((setup.mode == RaceReplay::timeTrial) ? timeTrial : singleRace);
+    return true;
+}
+
+
+// seeds random for the race about to start, either from the replay being
+// played or, when races are recorded, from the clock
+void
+Game::startReplay(RaceReplay::Mode mode)
+{
+    if (m_replaying)
+    {
+        m_replay.rewind( );
+        seedRandom(m_replay.setup( ).seed);
+        return;
+    }
+    if (m_replayFile[0] == '\0')
+        return;
+    RaceReplay::Setup setup;
+    ::memset(&setup, 0, sizeof(setup));
+    setup.seed = ::GetTickCount( );
+    setup.mode = mode;
+    ::strncpy(setup.track, m_nextTrack, REPLAYPATH - 1);
+    setup.vehicle = m_nextVehicle;
+    if (m_nextVehicleFile != NULL)
+        ::strncpy(setup.vehicleFile, m_nextVehicleFile, REPLAYPATH - 1);
+    setup.automaticTransmission = m_nextAutomaticTransmission;
+    setup.laps       = m_raceSettings.nrOfLaps;
+    setup.computers  = m_raceSettings.nrOfComputers;
+    setup.difficulty = m_raceSettings.difficulty;
+    setup.arithmetic = CarPhysics::defaultArithmetic( );
+    seedRandom(setup.seed);
+    m_replay.record(setup);
+    m_recording = true;
+}
+
+
+void
+Game::stopReplay( )
+{
+    if (m_recording)
+    {
+        m_replay.write(m_replayFile);
+        m_recording = false;
+    }
+    if (m_replaying)
+    {
+        m_raceSettings.nrOfLaps      = m_savedLaps;
+        m_raceSettings.nrOfComputers = m_savedComputers;
+        m_raceSettings.difficulty    = m_savedDifficulty;
+        CarPhysics::defaultArithmetic(CarPhysics::Arithmetic(m_savedArithmetic));
+        m_replaying = false;
+    }
+}
+
+
 Boolean
 Game::startClient( )
 {
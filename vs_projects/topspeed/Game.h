@@ -135,11 +135,28 @@ public:
     Boolean pauseKeyReleased( ) { return m_pauseKeyReleased; }
     Boolean serverStarted( ) { return m_serverStarted; }
 
+public:
+    // before initialize: the sounds play through the software mixer instead of
+    // DirectSound, into a wave file or, for "null", nowhere
+    void    soundMixer(const Char* output);
+
+    // races recorded into filename, and a recorded race played again
+    void    recordReplays(const Char* filename);
+    Boolean replay(const Char* filename);
+    Boolean replaying( ) { return m_replaying; }
+
+private:
+    void    startReplay(RaceReplay::Mode mode);
+    void    stopReplay( );
+
 private:
     Boolean                         m_initialized;
     State                           m_state;
     DirectX::Timer                  m_timer;
     DirectX::SoundManager*          m_soundManager;
+    DirectX::Mixer*                 m_mixer;
+    DirectX::MixerOutput*           m_mixerOutput;
+    Char                            m_soundMixer[MAX_PATH];
     DirectX::InputManager*          m_inputManager;
     RaceInput*                      m_raceInput;
     DirectX::Input::State           m_inputState;
@@ -171,6 +188,16 @@ private:
     State                           m_pausedState;
     Boolean                         m_pauseKeyReleased;
 
+    // replays
+    RaceReplay                      m_replay;
+    Char                            m_replayFile[MAX_PATH];
+    Boolean                         m_recording;
+    Boolean                         m_replaying;
+    Int                             m_savedLaps;
+    Int                             m_savedComputers;
+    Int                             m_savedDifficulty;
+    UInt                            m_savedArithmetic;
+
     // numbers
 public:
     DirectX::Sound*                 m_soundNumbers[101];
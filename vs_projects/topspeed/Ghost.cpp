@@ -0,0 +1,477 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "Ghost.h"
+#include "Game.h"
+#include <stdio.h>
+
+static const Char ghostMagic[4] = { 'T', 'S', 'G', 'H' };
+
+
+// small values either side of 0 in few bytes: 0, -1, 1, -2, 2...
+static UInt
+zigzag(Int value)
+{
+    return (UInt(value) << 1) ^ UInt(value >> 31);
+}
+
+
+static Int
+unzigzag(UInt value)
+{
+    return Int(value >> 1) ^ -Int(value & 1);
+}
+
+
+// the nearest multiple of step, in steps
+static Int
+quantize(Int value, Int step)
+{
+    if (value >= 0)
+        return (value + step/2) / step;
+    return -((step/2 - value) / step);
+}
+
+
+static Int
+between(Int a, Int b, Float f)
+{
+    return a + Int(Float(b - a)*f);
+}
+
+
+Ghost::Ghost( ) :
+    m_samples(0),
+    m_size(0),
+    m_capacity(0),
+    m_nSamples(0),
+    m_keyframes(0),
+    m_nKeyframes(0),
+    m_keyCapacity(0),
+    m_vehicle(0),
+    m_manualTransmission(false),
+    m_raceTime(0),
+    m_recorded(false),
+    m_lastTime(0.0f)
+{
+    m_key[0] = '\0';
+    m_vehicleFile[0] = '\0';
+    ::memset(&m_last, 0, sizeof(m_last));
+    ::memset(&m_state, 0, sizeof(m_state));
+}
+
+
+Ghost::~Ghost( )
+{
+    SAFE_DELETE_ARRAY(m_samples);
+    SAFE_DELETE_ARRAY(m_keyframes);
+}
+
+
+void
+Ghost::record(const Char* key, UInt vehicle, const Char* vehicleFile, Boolean manualTransmission)
+{
+    clear( );
+    _snprintf(m_key, sizeof(m_key) - 1, "%s", key);
+    m_key[sizeof(m_key) - 1] = '\0';
+    m_vehicle = vehicle;
+    _snprintf(m_vehicleFile, sizeof(m_vehicleFile) - 1, "%s", (vehicleFile != NULL) ? vehicleFile : "");
+    m_vehicleFile[sizeof(m_vehicleFile) - 1] = '\0';
+    m_manualTransmission = manualTransmission;
+}
+
+
+void
+Ghost::add(Float time, const Sample& sample)
+{
+    // before the first frame the car stood where it is now
+    if (!m_recorded)
+    {
+        m_recorded = true;
+        m_lastTime = time;
+        m_last     = sample;
+    }
+    while (Float(m_nSamples) / GHOSTRATE <= time)
+    {
+        if (m_size + 1 + 5*5 > m_capacity)
+        {
+            if (m_capacity >= GHOSTMAXSIZE)
+            {
+                RACE("(!) Ghost::add : ghost full at %u samples", m_nSamples);
+                break;
+            }
+            UInt capacity = (m_capacity == 0) ? 4096 : 2*m_capacity;
+            UByte* samples = new UByte[capacity];
+            if (m_size > 0)
+                ::memcpy(samples, m_samples, m_size);
+            SAFE_DELETE_ARRAY(m_samples);
+            m_samples  = samples;
+            m_capacity = capacity;
+        }
+        Sample at = sample;
+        Float sampleTime = Float(m_nSamples) / GHOSTRATE;
+        if ((sampleTime < time) && (time > m_lastTime))
+        {
+            Float f = (sampleTime - m_lastTime) / (time - m_lastTime);
+            if (f < 0.0f)
+                f = 0.0f;
+            at.positionX = between(m_last.positionX, sample.positionX, f);
+            at.positionY = between(m_last.positionY, sample.positionY, f);
+            at.speed     = between(m_last.speed, sample.speed, f);
+            at.gear      = (f < 0.5f) ? m_last.gear : sample.gear;
+        }
+        encode(at);
+    }
+    m_lastTime = time;
+    m_last     = sample;
+}
+
+
+Boolean
+Ghost::write(const Char* filename) const
+{
+    FILE* file = ::fopen(filename, "wb");
+    if (file == NULL)
+    {
+        RACE("(!) Ghost::write : could not write %s", filename);
+        return false;
+    }
+    Header header;
+    ::memset(&header, 0, sizeof(header));
+    ::memcpy(header.magic, ghostMagic, sizeof(ghostMagic));
+    header.version  = GHOST_VERSION;
+    ::memcpy(header.key, m_key, sizeof(m_key));
+    header.vehicle  = m_vehicle;
+    ::memcpy(header.vehicleFile, m_vehicleFile, sizeof(m_vehicleFile));
+    header.manualTransmission = m_manualTransmission;
+    header.raceTime = m_raceTime;
+    header.rate     = GHOSTRATE;
+    header.nSamples = m_nSamples;
+    header.size     = m_size;
+    Boolean written = (::fwrite(&header, sizeof(header), 1, file) == 1)
+                      && ((m_size == 0) || (::fwrite(m_samples, 1, m_size, file) == m_size));
+    ::fclose(file);
+    if (!written)
+    {
+        RACE("(!) Ghost::write : could not write %s", filename);
+        ::remove(filename);
+        return false;
+    }
+    RACE("Ghost::write : %s, %u samples in %u bytes", filename, m_nSamples, m_size);
+    return true;
+}
+
+
+Boolean
+Ghost::read(const Char* filename)
+{
+    clear( );
+    FILE* file = ::fopen(filename, "rb");
+    if (file == NULL)
+        return false;
+    Header header;
+    Boolean valid = (::fread(&header, sizeof(header), 1, file) == 1)
+                    && (::memcmp(header.magic, ghostMagic, sizeof(ghostMagic)) == 0)
+                    && (header.version == GHOST_VERSION) && (header.rate == GHOSTRATE)
+                    && (header.size <= GHOSTMAXSIZE);
+    if (valid)
+    {
+        m_samples  = new UByte[header.size + 1];
+        m_capacity = header.size + 1;
+        valid = (::fread(m_samples, 1, header.size, file) == header.size);
+    }
+    ::fclose(file);
+    if (!valid)
+    {
+        RACE("(!) Ghost::read : %s is not a ghost of this version", filename);
+        clear( );
+        return false;
+    }
+    ::memcpy(m_key, header.key, sizeof(m_key));
+    m_key[sizeof(m_key) - 1] = '\0';
+    m_vehicle = header.vehicle;
+    ::memcpy(m_vehicleFile, header.vehicleFile, sizeof(m_vehicleFile));
+    m_vehicleFile[sizeof(m_vehicleFile) - 1] = '\0';
+    m_manualTransmission = header.manualTransmission;
+    m_raceTime = header.raceTime;
+    m_size     = header.size;
+
+    // decoded once to find the keyframes, a sample takes at least a byte
+    m_nSamples = (header.nSamples < m_size) ? header.nSamples : m_size;
+    State state;
+    Sample sample;
+    ::memset(&state, 0, sizeof(state));
+    while (state.index < m_nSamples)
+    {
+        if (state.index % GHOSTKEYINTERVAL == 0)
+            keyframe(state.offset);
+        if (!next(state, sample))
+            break;
+    }
+    if (state.index != header.nSamples)
+        RACE("(!) Ghost::read : %s holds %u samples, not %u", filename, state.index, header.nSamples);
+    m_nSamples = state.index;
+    m_nKeyframes = (m_nSamples + GHOSTKEYINTERVAL - 1) / GHOSTKEYINTERVAL;
+    return m_nSamples > 0;
+}
+
+
+void
+Ghost::start(UInt keyframe, State& state) const
+{
+    ::memset(&state, 0, sizeof(state));
+    if (m_nKeyframes == 0)
+        return;
+    if (keyframe >= m_nKeyframes)
+        keyframe = m_nKeyframes - 1;
+    state.index  = keyframe*GHOSTKEYINTERVAL;
+    state.offset = m_keyframes[keyframe];
+}
+
+
+Boolean
+Ghost::next(State& state, Sample& sample) const
+{
+    if ((state.index >= m_nSamples) || (state.offset >= m_size))
+        return false;
+    State decoded = state;
+    UInt value;
+    Boolean complete;
+    if (decoded.index % GHOSTKEYINTERVAL == 0)
+    {
+        complete = get(decoded.offset, value);
+        decoded.positionX = unzigzag(value);
+        complete = complete && get(decoded.offset, value);
+        decoded.positionY = unzigzag(value);
+        complete = complete && get(decoded.offset, value);
+        decoded.velocity = unzigzag(value);
+        complete = complete && get(decoded.offset, value);
+        decoded.speed = unzigzag(value);
+        complete = complete && get(decoded.offset, value);
+        decoded.gear = unzigzag(value);
+    }
+    else
+    {
+        UByte changed = m_samples[decoded.offset++];
+        complete = true;
+        if ((complete) && (changed & changedVelocity))
+        {
+            complete = get(decoded.offset, value);
+            decoded.velocity += unzigzag(value);
+        }
+        decoded.positionY += decoded.velocity;
+        if ((complete) && (changed & changedX))
+        {
+            complete = get(decoded.offset, value);
+            decoded.positionX += unzigzag(value);
+        }
+        if ((complete) && (changed & changedSpeed))
+        {
+            complete = get(decoded.offset, value);
+            decoded.speed += unzigzag(value);
+        }
+        if ((complete) && (changed & changedGear))
+        {
+            complete = get(decoded.offset, value);
+            decoded.gear += unzigzag(value);
+        }
+    }
+    if (!complete)
+        return false;
+    ++decoded.index;
+    state = decoded;
+    sample.positionX = state.positionX*GHOSTPOSITIONSTEP;
+    sample.positionY = state.positionY*GHOSTPOSITIONSTEP;
+    sample.speed     = state.speed*GHOSTSPEEDSTEP;
+    sample.gear      = state.gear;
+    return true;
+}
+
+
+void
+Ghost::clear( )
+{
+    SAFE_DELETE_ARRAY(m_samples);
+    SAFE_DELETE_ARRAY(m_keyframes);
+    m_size        = 0;
+    m_capacity    = 0;
+    m_nSamples    = 0;
+    m_nKeyframes  = 0;
+    m_keyCapacity = 0;
+    m_raceTime    = 0;
+    m_recorded    = false;
+    m_lastTime    = 0.0f;
+    ::memset(&m_last, 0, sizeof(m_last));
+    ::memset(&m_state, 0, sizeof(m_state));
+}
+
+
+// the values are rounded first and only then coded, so what next gives is
+// the rounded value itself and not the sum of rounded changes
+void
+Ghost::encode(const Sample& sample)
+{
+    Int positionX = quantize(sample.positionX, GHOSTPOSITIONSTEP);
+    Int positionY = quantize(sample.positionY, GHOSTPOSITIONSTEP);
+    Int speed     = quantize(sample.speed, GHOSTSPEEDSTEP);
+    Int velocity  = (m_nSamples == 0) ? 0 : positionY - m_state.positionY;
+    if (m_nSamples % GHOSTKEYINTERVAL == 0)
+    {
+        keyframe(m_size);
+        put(zigzag(positionX));
+        put(zigzag(positionY));
+        put(zigzag(velocity));
+        put(zigzag(speed));
+        put(zigzag(sample.gear));
+    }
+    else
+    {
+        UByte changed = 0;
+        if (velocity != m_state.velocity)
+            changed |= changedVelocity;
+        if (positionX != m_state.positionX)
+            changed |= changedX;
+        if (speed != m_state.speed)
+            changed |= changedSpeed;
+        if (sample.gear != m_state.gear)
+            changed |= changedGear;
+        m_samples[m_size++] = changed;
+        if (changed & changedVelocity)
+            put(zigzag(velocity - m_state.velocity));
+        if (changed & changedX)
+            put(zigzag(positionX - m_state.positionX));
+        if (changed & changedSpeed)
+            put(zigzag(speed - m_state.speed));
+        if (changed & changedGear)
+            put(zigzag(sample.gear - m_state.gear));
+    }
+    m_state.positionX = positionX;
+    m_state.positionY = positionY;
+    m_state.velocity  = velocity;
+    m_state.speed     = speed;
+    m_state.gear      = sample.gear;
+    ++m_nSamples;
+}
+
+
+// seven bits a byte, the high bit set on all but the last
+void
+Ghost::put(UInt value)
+{
+    while (value >= 0x80)
+    {
+        m_samples[m_size++] = UByte(value | 0x80);
+        value >>= 7;
+    }
+    m_samples[m_size++] = UByte(value);
+}
+
+
+Boolean
+Ghost::get(UInt& offset, UInt& value) const
+{
+    value = 0;
+    for (UInt shift = 0; (shift < 35) && (offset < m_size); shift += 7)
+    {
+        UByte b = m_samples[offset++];
+        value |= UInt(b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+
+void
+Ghost::keyframe(UInt offset)
+{
+    if (m_nKeyframes == m_keyCapacity)
+    {
+        UInt capacity = (m_keyCapacity == 0) ? 64 : 2*m_keyCapacity;
+        UInt* keyframes = new UInt[capacity];
+        if (m_nKeyframes > 0)
+            ::memcpy(keyframes, m_keyframes, m_nKeyframes*sizeof(UInt));
+        SAFE_DELETE_ARRAY(m_keyframes);
+        m_keyframes   = keyframes;
+        m_keyCapacity = capacity;
+    }
+    m_keyframes[m_nKeyframes++] = offset;
+}
+
+
+GhostCursor::GhostCursor(const Ghost* ghost) :
+    m_ghost(ghost),
+    m_valid(false),
+    m_index(0),
+    m_ended(true),
+    m_decoded(0)
+{
+    ::memset(&m_state, 0, sizeof(m_state));
+    ::memset(&m_before, 0, sizeof(m_before));
+    ::memset(&m_after, 0, sizeof(m_after));
+}
+
+
+GhostCursor::~GhostCursor( )
+{
+}
+
+
+// false once the time is past the last sample, which sample then holds
+Boolean
+GhostCursor::at(Float time, Ghost::Sample& sample)
+{
+    if ((m_ghost == NULL) || (m_ghost->nSamples( ) == 0))
+    {
+        ::memset(&sample, 0, sizeof(sample));
+        return false;
+    }
+    Float position = (time > 0.0f) ? time*GHOSTRATE : 0.0f;
+    UInt index = (position < Float(m_ghost->nSamples( ))) ? UInt(position) : m_ghost->nSamples( );
+    if ((!m_valid) || (index < m_index) || (index >= m_index + GHOSTKEYINTERVAL))
+        seek(index);
+    while ((!m_ended) && (m_index < index))
+        advance( );
+    if (m_ended)
+    {
+        sample = m_before;
+        return position <= Float(m_index);
+    }
+    Float f = position - Float(m_index);
+    sample.positionX = between(m_before.positionX, m_after.positionX, f);
+    sample.positionY = between(m_before.positionY, m_after.positionY, f);
+    sample.speed     = between(m_before.speed, m_after.speed, f);
+    sample.gear      = (f < 0.5f) ? m_before.gear : m_after.gear;
+    return true;
+}
+
+
+void
+GhostCursor::seek(UInt index)
+{
+    m_ghost->start(index / GHOSTKEYINTERVAL, m_state);
+    m_index = m_state.index;
+    m_valid = true;
+    if (!m_ghost->next(m_state, m_before))
+    {
+        ::memset(&m_before, 0, sizeof(m_before));
+        m_ended = true;
+        return;
+    }
+    m_ended = !m_ghost->next(m_state, m_after);
+    m_decoded += (m_ended) ? 1 : 2;
+}
+
+
+void
+GhostCursor::advance( )
+{
+    m_before = m_after;
+    ++m_index;
+    m_ended = !m_ghost->next(m_state, m_after);
+    if (!m_ended)
+        ++m_decoded;
+}
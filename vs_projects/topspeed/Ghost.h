@@ -0,0 +1,177 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_GHOST_H__
+#define __RACING_GHOST_H__
+
+#include <Common/If/Common.h>
+
+#define GHOST_VERSION       1
+// samples per second of race, and the samples from one keyframe to the next
+#define GHOSTRATE           10
+#define GHOSTKEYINTERVAL    50
+// positions are kept to GHOSTPOSITIONSTEP units, speeds to GHOSTSPEEDSTEP
+#define GHOSTPOSITIONSTEP   16
+#define GHOSTSPEEDSTEP      10
+// the "track;laps" key of highscore.cfg and the name of a vehicle file
+#define GHOSTKEYSIZE        128
+#define GHOSTPATH           256
+// bytes of samples a ghost may hold, many hours of racing
+#define GHOSTMAXSIZE        (4*1024*1024)
+
+
+/*************************************************************************************
+ *@class Ghost
+ *@description
+ *    The way a car went around a track: GHOSTRATE times a second of race its
+ *    position along the road, its lateral position, its speed and its gear.
+ *    add takes the car every frame, however long the frames are, and works
+ *    out the samples that fell within the frame between it and the one before.
+ *
+ *    Positions and speed are rounded to a step and only the rounded values are
+ *    coded, each as its change since the sample before, and for the position
+ *    along the road the change in that change; a car going on at the same
+ *    speed costs a byte a sample. Every GHOSTKEYINTERVAL samples a keyframe
+ *    holds the values themselves, so playback can start anywhere. Rounding
+ *    errors do not add up: a sample is off by at most half a step.
+ *
+ *    The file is a Header followed by the samples.
+ *************************************************************************************/
+class Ghost
+{
+public:
+    struct Sample
+    {
+        Int             positionX;
+        Int             positionY;
+        Int             speed;
+        Int             gear;
+    };
+
+    // the rounded values of the sample last coded, and where the next one starts
+    struct State
+    {
+        Int             positionX;
+        Int             positionY;
+        Int             velocity;           // change in positionY since the sample before
+        Int             speed;
+        Int             gear;
+        UInt            index;
+        UInt            offset;
+    };
+
+public:
+    Ghost( );
+    virtual ~Ghost( );
+
+public:
+    void            record(const Char* key, UInt vehicle, const Char* vehicleFile, Boolean manualTransmission);
+    void            add(Float time, const Sample& sample);
+    void            finish(Int raceTime)            { m_raceTime = raceTime;    }
+    Boolean         write(const Char* filename) const;
+
+    Boolean         read(const Char* filename);
+    void            start(UInt keyframe, State& state) const;
+    Boolean         next(State& state, Sample& sample) const;
+
+    const Char*     key( ) const                    { return m_key;             }
+    UInt            vehicle( ) const                { return m_vehicle;         }
+    const Char*     vehicleFile( ) const            { return m_vehicleFile;     }
+    Boolean         manualTransmission( ) const     { return m_manualTransmission;  }
+    Int             raceTime( ) const               { return m_raceTime;        }
+    UInt            nSamples( ) const               { return m_nSamples;        }
+    UInt            nKeyframes( ) const             { return m_nKeyframes;      }
+    UInt            size( ) const                   { return m_size;            }
+
+private:
+    struct Header
+    {
+        Char            magic[4];
+        UInt            version;
+        Char            key[GHOSTKEYSIZE];
+        UInt            vehicle;
+        Char            vehicleFile[GHOSTPATH];     // empty for a built-in vehicle
+        Boolean         manualTransmission;
+        Int             raceTime;                   // milliseconds, as in highscore.cfg
+        UInt            rate;
+        UInt            nSamples;
+        UInt            size;
+    };
+
+    enum Changed
+    {
+        changedVelocity = 0x01,
+        changedX        = 0x02,
+        changedSpeed    = 0x04,
+        changedGear     = 0x08
+    };
+
+private:
+    void            clear( );
+    void            encode(const Sample& sample);
+    void            put(UInt value);
+    Boolean         get(UInt& offset, UInt& value) const;
+    void            keyframe(UInt offset);
+
+private:
+    UByte*          m_samples;
+    UInt            m_size;
+    UInt            m_capacity;
+    UInt            m_nSamples;
+    UInt*           m_keyframes;        // offset of every keyframe
+    UInt            m_nKeyframes;
+    UInt            m_keyCapacity;
+    Char            m_key[GHOSTKEYSIZE];
+    UInt            m_vehicle;
+    Char            m_vehicleFile[GHOSTPATH];
+    Boolean         m_manualTransmission;
+    Int             m_raceTime;
+    // the frame before and the sample last coded, where add takes the changes from
+    Boolean         m_recorded;
+    Float           m_lastTime;
+    Sample          m_last;
+    State           m_state;
+};
+
+
+/*************************************************************************************
+ *@class GhostCursor
+ *@description
+ *    Plays a Ghost back: at gives the car at a time of the race, in between two
+ *    samples the straight line between them and the gear of the nearer one.
+ *    Going forward it only decodes the samples the time has passed, one every
+ *    few frames; going back, or further ahead than a keyframe, it starts again
+ *    from the nearest keyframe.
+ *************************************************************************************/
+class GhostCursor
+{
+public:
+    GhostCursor(const Ghost* ghost = NULL);
+    virtual ~GhostCursor( );
+
+public:
+    void            ghost(const Ghost* ghost)       { m_ghost = ghost; reset( );    }
+    void            reset( )                        { m_valid = false;      }
+    Boolean         at(Float time, Ghost::Sample& sample);
+    UInt            decoded( ) const                { return m_decoded;     }
+
+private:
+    void            seek(UInt index);
+    void            advance( );
+
+private:
+    const Ghost*    m_ghost;
+    Boolean         m_valid;
+    Ghost::State    m_state;
+    Ghost::Sample   m_before;           // the samples at m_index and m_index + 1
+    Ghost::Sample   m_after;
+    UInt            m_index;
+    Boolean         m_ended;            // no sample after m_before
+    UInt            m_decoded;
+};
+
+
+#endif /* __RACING_GHOST_H__ */
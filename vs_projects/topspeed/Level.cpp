@@ -6,6 +6,7 @@
 */
 #include "Level.h"
 #include "resource.h"
+#include "TrackRegistry.h"
 #include "Common/If/Algorithm.h"
 
 
@@ -74,54 +75,9 @@ Level::Level(Game* game, Char* track, Boolean automaticTransmission, UInt nrOfLa
         sprintf(tempName, "race\\info\\laps2go%d", i+1);
         m_soundLaps[i] = m_game->loadLanguageSound(tempName);
     }
-    if (strcmp(m_track->trackName( ), "america") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\america");
-    else if (strcmp(m_track->trackName( ), "austria") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\austria");
-    else if (strcmp(m_track->trackName( ), "belgium") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\belgium");
-    else if (strcmp(m_track->trackName( ), "brazil") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\brazil");
-    else if (strcmp(m_track->trackName( ), "china") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\china");
-    else if (strcmp(m_track->trackName( ), "england") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\england");
-    else if (strcmp(m_track->trackName( ), "finland") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\finland");
-    else if (strcmp(m_track->trackName( ), "france") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\france");
-    else if (strcmp(m_track->trackName( ), "germany") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\germany");
-    else if (strcmp(m_track->trackName( ), "ireland") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\ireland");
-    else if (strcmp(m_track->trackName( ), "italy") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\italy");
-    else if (strcmp(m_track->trackName( ), "netherlands") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\netherlands");
-    else if (strcmp(m_track->trackName( ), "portugal") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\portugal");
-    else if (strcmp(m_track->trackName( ), "russia") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\russia");
-    else if (strcmp(m_track->trackName( ), "spain") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\spain");
-    else if (strcmp(m_track->trackName( ), "sweden") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\sweden");
-    else if (strcmp(m_track->trackName( ), "switserland") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\switserland");
-    else if (strcmp(m_track->trackName( ), "advHills") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\rallyhills");
-    else if (strcmp(m_track->trackName( ), "advCoast") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\frenchcoast");
-    else if (strcmp(m_track->trackName( ), "advCountry") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\englishcountry");
-    else if (strcmp(m_track->trackName( ), "advAirport") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\rideairport");
-    else if (strcmp(m_track->trackName( ), "advDesert") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\rallydesert");
-    else if (strcmp(m_track->trackName( ), "advRush") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\rushhour");
-    else if (strcmp(m_track->trackName( ), "advEscape") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\polarescape");
+    const TrackRegistry::Entry* builtin = TrackRegistry::find(m_track->trackName( ));
+    if (builtin != NULL)
+        m_soundTrackName = m_game->loadLanguageSound(builtin->sound);
     else
     {
         Int length = ::strlen(m_track->trackName( ));
@@ -194,55 +150,10 @@ Level::Level(Game* game, Char* track, Track::TrackData trackData, Boolean automa
         sprintf(tempName, "race\\info\\laps2go%d", i+1);
         m_soundLaps[i] = m_game->loadLanguageSound(tempName);
     }
-    if (strcmp(m_track->trackName( ), "america") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\america");
-    else if (strcmp(m_track->trackName( ), "austria") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\austria");
-    else if (strcmp(m_track->trackName( ), "belgium") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\belgium");
-    else if (strcmp(m_track->trackName( ), "brazil") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\brazil");
-    else if (strcmp(m_track->trackName( ), "china") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\china");
-    else if (strcmp(m_track->trackName( ), "england") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\england");
-    else if (strcmp(m_track->trackName( ), "finland") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\finland");
-    else if (strcmp(m_track->trackName( ), "france") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\france");
-    else if (strcmp(m_track->trackName( ), "germany") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\germany");
-    else if (strcmp(m_track->trackName( ), "ireland") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\ireland");
-    else if (strcmp(m_track->trackName( ), "italy") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\italy");
-    else if (strcmp(m_track->trackName( ), "netherlands") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\netherlands");
-    else if (strcmp(m_track->trackName( ), "portugal") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\portugal");
-    else if (strcmp(m_track->trackName( ), "russia") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\russia");
-    else if (strcmp(m_track->trackName( ), "spain") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\spain");
-    else if (strcmp(m_track->trackName( ), "sweden") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\sweden");
-    else if (strcmp(m_track->trackName( ), "switserland") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\switserland");
-    else if (strcmp(m_track->trackName( ), "advHills") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\rallyhills");
-    else if (strcmp(m_track->trackName( ), "advCoast") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\frenchcoast");
-    else if (strcmp(m_track->trackName( ), "advCountry") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\englishcountry");
-    else if (strcmp(m_track->trackName( ), "advAirport") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\rideairport");
-    else if (strcmp(m_track->trackName( ), "advDesert") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\rallydesert");
-    else if (strcmp(m_track->trackName( ), "advRush") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\rushhour");
-    else if (strcmp(m_track->trackName( ), "advEscape") == 0)
-        m_soundTrackName = m_game->loadLanguageSound("tracks\\polarescape");
-        else if ((!m_game->serverStarted( )) && (strcmp(m_track->trackName( ), "custom") == 0))
+    const TrackRegistry::Entry* builtin = TrackRegistry::find(m_track->trackName( ));
+    if (builtin != NULL)
+        m_soundTrackName = m_game->loadLanguageSound(builtin->sound);
+    else if ((!m_game->serverStarted( )) && (strcmp(m_track->trackName( ), "custom") == 0))
         m_soundTrackName = m_game->loadLanguageSound("menu\\customtrack");
     else
     {
@@ -389,11 +300,7 @@ Level::callNextRoad(Track::Road& nextRoad)
 void 
 Level::pushEvent(Event::Type type, Float time, DirectX::Sound* sound)
 {
-    Event* e = new Event;
-    e->type = type;
-    e->time = m_elapsedTotal + time;
-    e->sound = sound;
-    m_eventList.push(e);
+    m_events.schedule(type, m_elapsedTotal + time, sound);
 }
 
 
@@ -441,18 +348,7 @@ RACE("Level::loadRandomSounds : Finished loading %d sounds for a total of %d", p
 void
 Level::flushPendingSounds( )
 {
-    Event* e = 0;
-    while (e = m_eventList.next(e))
-    {
-        if (e->sound)
-        {
-            m_eventList.purge(e);
-            delete e;
-            e = 0;
-        }
-    }
-    delete e;
-    e = 0;
+    m_events.cancelSounds( );
 }
 
 void
@@ -9,6 +9,7 @@
 
 #include "Game.h"
 #include "Car.h"
+#include "EventScheduler.h"
 #include "Track.h"
 #include "Packets.h"
 #include "Common/If/Algorithm.h"
@@ -89,7 +90,7 @@ protected:
     Int                     m_raceTime;
     UInt                    m_lap;
     Track::Road             m_currentRoad;
-    EventList               m_eventList;
+    EventScheduler          m_events;
     Boolean                 m_started;
     Boolean                 m_finished;
     Boolean                 m_acceptPlayerInfo;
@@ -153,72 +153,64 @@ LevelSingleRace::run(Float elapsed)
         pushEvent(Event::playSound, 1.5f, m_soundStart);
     }
     // Handle events
-    Event* e = 0;
-    while (e = m_eventList.next(e))
+    Event e;
+    while (m_events.popDue(m_elapsedTotal, e))
     {
-        if (e->time <= m_elapsedTotal)
+        switch (e.type)
         {
-            switch (e->type)
+        case Event::carStart:
+            m_car->start( );
+            break;
+        case Event::raceStart:
+            m_raceTime = 0;
+            // start stopwatch
+            m_stopwatch.elapsed( );
+            m_lap = 0;
+            m_started = true;
+            break;
+        case Event::raceFinish:
+            pushEvent(Event::playSound, m_sayTimeLength, m_soundYourTime);
+            m_sayTimeLength += m_soundYourTime->length() + 0.5f;
+            sayTime(m_raceTime);
+            pushEvent(Event::raceTimeFinalize, m_sayTimeLength);
+            break;
+        case Event::playSound:
+            if (e.sound)
             {
-            case Event::carStart:
-                m_car->start( );
-                break;
-            case Event::raceStart:
-                m_raceTime = 0;
-                // start stopwatch
-                m_stopwatch.elapsed( );
-                m_lap = 0;
-                m_started = true;
-                break;
-            case Event::raceFinish:
-                pushEvent(Event::playSound, m_sayTimeLength, m_soundYourTime);
-                m_sayTimeLength += m_soundYourTime->length() + 0.5f;
-                sayTime(m_raceTime);
-                pushEvent(Event::raceTimeFinalize, m_sayTimeLength);
-                break;
-            case Event::playSound:
-                if (e->sound)
-                {
-                    e->sound->reset( );
-                    e->sound->play( );
-                }
-                break;
-            /* case Event::playSoundAndDelete:
-                if (e->sound)
-                {
-                    e->sound->play( );
-                    pushEvent(Event::deleteSound, e->sound->length( ), e->sound);
-                }
-                break;
-            case Event::deleteSound:
-                if (e->sound)
-                {
-                    SAFE_DELETE(e->sound);
-                }
-                break; */
-            case Event::raceTimeFinalize:
-                m_sayTimeLength = 0.0f;
-                delete e;
-                e = 0;
-                m_game->state(Game::menu);
-                return;
-            case Event::playRadioSound:
-                --m_unkeyQueue;
-                if (m_unkeyQueue == 0)
-                    speak(m_soundUnkey[random(NUNKEYS)]);
-                break;
-            case Event::acceptPlayerInfo:
-                m_acceptPlayerInfo = true;
-                break;
-            case Event::acceptCurrentRaceInfo:
-                m_acceptCurrentRaceInfo = true;
-                break;
-            default:
-                break;
+                e.sound->reset( );
+                e.sound->play( );
             }
-            m_eventList.purge(e);
-            delete e;
-            e = 0;
+            break;
+        /* case Event::playSoundAndDelete:
+            if (e.sound)
+            {
+                e.sound->play( );
+                pushEvent(Event::deleteSound, e.sound->length( ), e.sound);
+            }
+            break;
+        case Event::deleteSound:
+            if (e.sound)
+            {
+                SAFE_DELETE(e.sound);
+            }
+            break; */
+        case Event::raceTimeFinalize:
+            m_sayTimeLength = 0.0f;
+            m_game->state(Game::menu);
+            return;
+        case Event::playRadioSound:
+            --m_unkeyQueue;
+            if (m_unkeyQueue == 0)
+                speak(m_soundUnkey[random(NUNKEYS)]);
+            break;
+        case Event::acceptPlayerInfo:
+            m_acceptPlayerInfo = true;
+            break;
+        case Event::acceptCurrentRaceInfo:
+            m_acceptCurrentRaceInfo = true;
+            break;
+        default:
+            break;
         }
     }
 
@@ -5,13 +5,19 @@
 * This program is distributed under the terms of the GNU General Public License version 3.
 */
 #include "LevelTimeTrial.h"
+#include "VehicleDefinition.h"
 
+extern Car::Parameters vehicles[NVEHICLES];
 
 const Char highscoreFile[] = "highscore.cfg";
+const Char ghostExtension[] = ".ghost";
 
 LevelTimeTrial::LevelTimeTrial(Game* game, UInt nrOfLaps, Char* track, Boolean automaticTransmission, UInt vehicle, Char* vehicleFile) :
     Level(game, track, automaticTransmission, nrOfLaps, vehicle, vehicleFile),
-    m_soundVehicle(0)
+    m_soundVehicle(0),
+    m_soundGhost(0),
+    m_ghostFrequency(0),
+    m_raceStart(0.0f)
 {
     RACE("(+) LevelTimeTrial");
     Char filename[64];
@@ -25,12 +31,16 @@ LevelTimeTrial::LevelTimeTrial(Game* game, UInt nrOfLaps, Char* track, Boolean a
         sprintf(filename, "%s.wav", m_car->customFile( ));
         m_soundVehicle = m_game->soundManager( )->create(filename);
     }
+    Char trackLaps[64];
+    sprintf(trackLaps, "%s;%d", m_track->trackName( ), m_nrOfLaps);
+    m_ghost.record(trackLaps, vehicle, vehicleFile, m_manualTransmission);
 }
 
 
 LevelTimeTrial::~LevelTimeTrial( )
 {
     RACE("(-) LevelTimeTrial");
+    SAFE_DELETE(m_soundGhost);
 }
 
 
@@ -43,6 +53,7 @@ LevelTimeTrial::initialize( )
     m_soundPause    = m_game->loadLanguageSound("race\\pause");
     m_soundUnpause  = m_game->loadLanguageSound("race\\unpause");
     m_soundTheme4->volume(50);
+    loadGhost( );
 }
 
 
@@ -64,85 +75,79 @@ LevelTimeTrial::run(Float elapsed)
         m_soundStart->play( );
     }
     // Handle events
-    Event* e = 0;
-    while (e = m_eventList.next(e))
+    Event e;
+    while (m_events.popDue(m_elapsedTotal, e))
     {
-        if (e->time <= m_elapsedTotal)
+        switch (e.type)
         {
-            switch (e->type)
+        case Event::carStart:
+            m_car->start( );
+            break;
+        case Event::raceStart:
+            m_raceTime = 0;
+            // start stopwatch
+            m_stopwatch.elapsed( );
+            m_lap = 0;
+            m_started = true;
+            m_raceStart = m_elapsedTotal;
+            break;
+        case Event::raceFinish:
+            pushEvent(Event::playSound, m_sayTimeLength, m_soundYourTime);
+            m_sayTimeLength += m_soundYourTime->length() + 0.5f;
+            sayTime(m_raceTime);
+            m_highscore = readHighScore(/* m_track */);
+            // a replay does not set times, its stopwatch timed the playback, not the race
+            if (((m_raceTime < m_highscore) || (m_highscore == 0)) && (!m_game->replaying( )))
+            {
+                writeHighScore(/* m_track, m_raceTime */);
+                pushEvent(Event::playSound, m_sayTimeLength, m_soundNewTime);
+                m_sayTimeLength += m_soundNewTime->length();
+            }
+            else
+            {
+                pushEvent(Event::playSound, m_sayTimeLength, m_soundBestTime);
+                m_sayTimeLength += m_soundBestTime->length() + 0.5f;
+                sayTime(m_highscore);
+            }
+            pushEvent(Event::raceTimeFinalize, m_sayTimeLength);
+            break;
+        case Event::playSound:
+            if (e.sound)
             {
-            case Event::carStart:
-                m_car->start( );
-                break;
-            case Event::raceStart:
-                m_raceTime = 0;
-                // start stopwatch
-                m_stopwatch.elapsed( );
-                m_lap = 0;
-                m_started = true;
-                break;
-            case Event::raceFinish:
-                pushEvent(Event::playSound, m_sayTimeLength, m_soundYourTime);
-                m_sayTimeLength += m_soundYourTime->length() + 0.5f;
-                sayTime(m_raceTime);
-                m_highscore = readHighScore(/* m_track */);
-                if ((m_raceTime < m_highscore) || (m_highscore == 0))
-                {
-                    writeHighScore(/* m_track, m_raceTime */);
-                    pushEvent(Event::playSound, m_sayTimeLength, m_soundNewTime);
-                    m_sayTimeLength += m_soundNewTime->length();
-                }
-                else
-                {
-                    pushEvent(Event::playSound, m_sayTimeLength, m_soundBestTime);
-                    m_sayTimeLength += m_soundBestTime->length() + 0.5f;
-                    sayTime(m_highscore);
-                }
-                pushEvent(Event::raceTimeFinalize, m_sayTimeLength);
-                break;
-            case Event::playSound:
-                if (e->sound)
-                {
-                    e->sound->reset( );
-                    e->sound->play( );
-                }
-                break;
-            /* case Event::playSoundAndDelete:
-                if (e->sound)
-                {
-                    e->sound->play( );
-                    pushEvent(Event::deleteSound, e->sound->length( ), e->sound);
-                }
-                break;
-            case Event::deleteSound:
-                if (e->sound)
-                {
-                    SAFE_DELETE(e->sound);
-                }
-                break; */
-            case Event::raceTimeFinalize:
-                m_sayTimeLength = 0.0f;
-                delete e;
-                e = 0;
-                m_game->state(Game::menu);
-                return;
-            case Event::playRadioSound:
-                --m_unkeyQueue;
-                if (m_unkeyQueue == 0)
-                    speak(m_soundUnkey[random(NUNKEYS)]);
-                break;
-            case Event::acceptPlayerInfo:
-                m_acceptPlayerInfo = true;
-                break;
-            case Event::acceptCurrentRaceInfo:
-                m_acceptCurrentRaceInfo = true;
-                break;
-            default:
-                break;
+                e.sound->reset( );
+                e.sound->play( );
             }
-            m_eventList.purge(e);
-            delete e;
-            e = 0;
+            break;
+        /* case Event::playSoundAndDelete:
+            if (e.sound)
+            {
+                e.sound->play( );
+                pushEvent(Event::deleteSound, e.sound->length( ), e.sound);
+            }
+            break;
+        case Event::deleteSound:
+            if (e.sound)
+            {
+                SAFE_DELETE(e.sound);
+            }
+            break; */
+        case Event::raceTimeFinalize:
+            m_sayTimeLength = 0.0f;
+            m_game->state(Game::menu);
+            return;
+        case Event::playRadioSound:
+            --m_unkeyQueue;
+            if (m_unkeyQueue == 0)
+                speak(m_soundUnkey[random(NUNKEYS)]);
+            break;
+        case Event::acceptPlayerInfo:
+            m_acceptPlayerInfo = true;
+            break;
+        case Event::acceptCurrentRaceInfo:
+            m_acceptCurrentRaceInfo = true;
+            break;
+        default:
+            break;
         }
     }
 
@@ -163,12 +168,22 @@ LevelTimeTrial::run(Float elapsed)
             m_car->quiet( );
             m_car->stop( );
             m_raceTime = m_stopwatch.elapsed( ) - m_stopwatchDiff;
+            recordGhost(m_elapsedTotal + elapsed - m_raceStart);
+            m_ghost.finish(m_raceTime);
             // handleFinish( );                
             pushEvent(Event::raceFinish, 2.0f);
         }
         else if ((m_game->raceSettings( ).automaticInfo) && (m_lap > 1) && (m_lap < m_nrOfLaps + 1))
             speak(m_soundLaps[m_nrOfLaps - m_lap], true);
     }
+    if ((m_started) && (m_lap <= m_nrOfLaps))
+    {
+        recordGhost(m_elapsedTotal + elapsed - m_raceStart);
+        if (m_soundGhost)
+            runGhost(m_elapsedTotal + elapsed - m_raceStart);
+    }
+    else if ((m_soundGhost) && (m_soundGhost->playing( )))
+        m_soundGhost->stop( );
     if ((m_game->raceInput()->getCurrentGear( )) && (m_started) && (m_acceptCurrentRaceInfo) && (m_lap <= m_nrOfLaps))
     {
         m_acceptCurrentRaceInfo = false;
@@ -297,6 +312,10 @@ LevelTimeTrial::writeHighScore(/*  Track* track, Int time */)
     file->writeKeyInt(trackLaps, m_raceTime); 
     // file.writeKeyInt(track->trackName( ), time); 
     SAFE_DELETE(file);
+    // the run that set the time is the ghost of the next one
+    Char filename[MAX_PATH];
+    ghostFile(filename, sizeof(filename));
+    m_ghost.write(filename);
 }
 
 
@@ -314,6 +333,118 @@ LevelTimeTrial::readHighScore(/* Track* track */)
 }
 
 
+// the key of highscore.cfg, without what a file name cannot hold
+void
+LevelTimeTrial::ghostFile(Char* filename, UInt size)
+{
+    Char name[GHOSTKEYSIZE];
+    const Char* key = m_ghost.key( );
+    UInt i = 0;
+    for ( ; (key[i] != '\0') && (i < GHOSTKEYSIZE - 1); ++i)
+        name[i] = (::isalnum(UByte(key[i]))) ? key[i] : '_';
+    name[i] = '\0';
+    _snprintf(filename, size - 1, "%s%s", name, ghostExtension);
+    filename[size - 1] = '\0';
+}
+
+
+void
+LevelTimeTrial::loadGhost( )
+{
+    Char filename[MAX_PATH];
+    ghostFile(filename, sizeof(filename));
+    if ((!m_bestGhost.read(filename)) || (::strcmp(m_bestGhost.key( ), m_ghost.key( )) != 0))
+        return;
+    RACE("LevelTimeTrial::loadGhost : %s, %d ms", filename, m_bestGhost.raceTime( ));
+    // it sounds like the vehicle that set the time, whatever the player drives now
+    const Char* vehicleFile = m_bestGhost.vehicleFile( );
+    if (vehicleFile[0] == '\0')
+    {
+        UInt vehicle = (m_bestGhost.vehicle( ) < NVEHICLES) ? m_bestGhost.vehicle( ) : 0;
+        m_ghostProfile.build(vehicles[vehicle].topspeed, vehicles[vehicle].gears, vehicles[vehicle].idlefreq,
+                             vehicles[vehicle].topfreq, vehicles[vehicle].shiftfreq);
+        m_soundGhost = m_game->soundManager( )->create(vehicles[vehicle].engineSound, m_game->threeD( ));
+    }
+    else
+    {
+        const VehicleDefinition* definition = VehicleDefinition::cached(vehicleFile);
+        m_ghostProfile.build(definition->topspeed, definition->gears, definition->idlefreq,
+                             definition->topfreq, definition->shiftfreq);
+        const Char* engineSound = definition->engineSound;
+        if (strncmp(engineSound, "builtin", 7) == 0)
+            m_soundGhost = m_game->soundManager( )->create(vehicles[atoi(engineSound+7)-1].engineSound, m_game->threeD( ));
+        else
+        {
+            Char engineSound2[MAX_PATH];
+            _snprintf(engineSound2, sizeof(engineSound2) - 1, "Vehicles\\%s", engineSound);
+            engineSound2[sizeof(engineSound2) - 1] = '\0';
+            m_soundGhost = m_game->soundManager( )->create(engineSound2, m_game->threeD( ));
+        }
+    }
+    if (m_soundGhost == 0)
+        return;
+    if (m_game->threeD( ))
+        m_soundGhost->initializeBuffer3D( );
+    m_soundGhost->volume(80);
+    m_ghostCursor.ghost(&m_bestGhost);
+}
+
+
+void
+LevelTimeTrial::recordGhost(Float time)
+{
+    Ghost::Sample sample;
+    sample.positionX = m_car->positionX( );
+    sample.positionY = m_car->positionY( );
+    sample.speed     = m_car->speed( );
+    sample.gear      = m_car->gear( );
+    m_ghost.add(time, sample);
+}
+
+
+void
+LevelTimeTrial::runGhost(Float time)
+{
+    Ghost::Sample sample;
+    if (!m_ghostCursor.at(time, sample))
+    {
+        // the best run is over, its car stands at the finish
+        if (m_soundGhost->playing( ))
+            m_soundGhost->stop( );
+        return;
+    }
+    if (!m_soundGhost->playing( ))
+        m_soundGhost->play(0, true);
+    UInt frequency = (m_bestGhost.manualTransmission( )) ? m_ghostProfile.frequencyManual(sample.gear, sample.speed)
+                                                         : m_ghostProfile.frequency(sample.speed);
+    if (frequency != m_ghostFrequency)
+    {
+        m_soundGhost->frequency(frequency);
+        m_ghostFrequency = frequency;
+    }
+    DirectX::Vector3 relPos(Float(sample.positionX - m_car->positionX( )) / Float(m_track->laneWidth( )),
+                            Float(sample.positionY - m_car->positionY( )) / 12000.0f, 0.0f);
+    if (m_game->threeD( ))
+        m_soundGhost->position(relPos);
+    else
+        setSoundPosition(m_soundGhost, relPos);
+}
+
+
+void
+LevelTimeTrial::setSoundPosition(DirectX::Sound* sound, DirectX::Vector3 relPos)
+{
+    Float distance = sqrt(sqrt(relPos.x*relPos.x) + sqrt(relPos.y*relPos.y));
+    if (relPos.x < -2.0f)
+        sound->pan(-100);
+    else if (relPos.x > 2.0f)
+        sound->pan(100);
+    else
+        sound->pan(Int(relPos.x*50.0f));
+    sound->volume(Int(100.0f - (distance*10.0f)));
+}
+
+
 /*
 Boolean
 LevelTimeTrial::readHighscores( )
@@ -371,6 +502,9 @@ LevelTimeTrial::pause( )
     fadeIn( );
     m_soundTheme4->play(0, true);
     m_car->pause( );
+    // runGhost starts it again
+    if ((m_soundGhost) && (m_soundGhost->playing( )))
+        m_soundGhost->stop( );
     m_soundPause->play( );
 }
 
@@ -11,6 +11,8 @@
 #include "Car.h"
 #include "Track.h"
 #include "Level.h"
+#include "Ghost.h"
+#include "VehicleProfile.h"
 
 class LevelTimeTrial : public Level
 {
@@ -35,9 +37,22 @@ private:
     // void    writeHighscores( );
     Int     readHighScore(/* Track* track */);
     // void    handleFinish( );
+    void    ghostFile(Char* filename, UInt size);
+    void    loadGhost( );
+    void    recordGhost(Float time);
+    void    runGhost(Float time);
+    void    setSoundPosition(DirectX::Sound* sound, DirectX::Vector3 relPos);
 
 private:
     DirectX::Sound*         m_soundVehicle;
+    // this run, and the best one so far driving along as a ghost car
+    Ghost                   m_ghost;
+    Ghost                   m_bestGhost;
+    GhostCursor             m_ghostCursor;
+    DirectX::Sound*         m_soundGhost;
+    VehicleProfile          m_ghostProfile;
+    UInt                    m_ghostFrequency;
+    Float                   m_raceStart;
 };
 
 
@@ -269,23 +269,8 @@ Menu::initialize(Goto nextGoto)
     m_soundAdventure            = m_game->loadLanguageSound("menu\\streetadventure");
     m_soundCustomTrack            = m_game->loadLanguageSound("menu\\customtrack");
     m_soundPickCircuit          = m_game->loadLanguageSound("menu\\selectatrack");
-    m_soundAmerica              = m_game->loadLanguageSound("tracks\\america");
-    m_soundAustria              = m_game->loadLanguageSound("tracks\\austria");
-    m_soundBelgium              = m_game->loadLanguageSound("tracks\\belgium");
-    m_soundBrazil              = m_game->loadLanguageSound("tracks\\brazil");
-    m_soundChina              = m_game->loadLanguageSound("tracks\\china");
-    m_soundEngland              = m_game->loadLanguageSound("tracks\\england");
-    m_soundFinland              = m_game->loadLanguageSound("tracks\\finland");
-    m_soundFrance              = m_game->loadLanguageSound("tracks\\france");
-    m_soundGermany              = m_game->loadLanguageSound("tracks\\germany");
-    m_soundIreland                = m_game->loadLanguageSound("tracks\\ireland");
-    m_soundItaly                = m_game->loadLanguageSound("tracks\\italy");
-    m_soundNetherlands          = m_game->loadLanguageSound("tracks\\netherlands");
-    m_soundPortugal                = m_game->loadLanguageSound("tracks\\portugal");
-    m_soundRussia              = m_game->loadLanguageSound("tracks\\russia");
-    m_soundSpain                = m_game->loadLanguageSound("tracks\\spain");
-    m_soundSweden                = m_game->loadLanguageSound("tracks\\sweden");
-    m_soundSwitserland                = m_game->loadLanguageSound("tracks\\switserland");
+    for (UInt i = 0; i < NTRACKS; ++i)
+        m_soundTracks[i] = m_game->loadLanguageSound(TrackRegistry::entry(i).sound);
 ////	RACE("Menu::initialize : loading some more menu sounds...");    
     m_soundPickVehicle              = m_game->loadLanguageSound("menu\\selectavehicle");
     Char vehicleSound[19];
@@ -296,13 +281,6 @@ Menu::initialize(Goto nextGoto)
     }
     m_soundRandom               = m_game->loadLanguageSound("menu\\random");
     m_soundPickAdventure        = m_game->loadLanguageSound("menu\\selectadventure");
-    m_soundHills                = m_game->loadLanguageSound("tracks\\rallyhills");
-    m_soundCoast                = m_game->loadLanguageSound("tracks\\frenchcoast");
-    m_soundCountry              = m_game->loadLanguageSound("tracks\\englishcountry");
-    m_soundAirport              = m_game->loadLanguageSound("tracks\\rideairport");
-    m_soundDesert              = m_game->loadLanguageSound("tracks\\rallydesert");
-    m_soundRush              = m_game->loadLanguageSound("tracks\\rushhour");
-    m_soundEscape              = m_game->loadLanguageSound("tracks\\polarescape");
     m_soundChoose               = m_game->loadLanguageSound("menu\\makeaselection");
     m_soundChangeOption               = m_game->loadLanguageSound("menu\\changeoptionto");
     m_soundConfirm               = m_game->loadLanguageSound("menu\\areyousure");
@@ -427,57 +405,12 @@ m_soundServerStarted            = m_game->loadLanguageSound("menu\\serverstarted
     m_singleRace[4].action     = a_back;
 
     // Initialize time trial circuit trackmenu
-    m_timeTrialCircuitTrack[0].sound  = m_soundAmerica;
-    m_timeTrialCircuitTrack[0].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[0].name = "america";
-    m_timeTrialCircuitTrack[1].sound  = m_soundAustria;
-    m_timeTrialCircuitTrack[1].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[1].name = "austria";
-    m_timeTrialCircuitTrack[2].sound  = m_soundBelgium;
-    m_timeTrialCircuitTrack[2].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[2].name = "belgium";
-    m_timeTrialCircuitTrack[3].sound  = m_soundBrazil;
-    m_timeTrialCircuitTrack[3].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[3].name = "brazil";
-    m_timeTrialCircuitTrack[4].sound  = m_soundChina;
-    m_timeTrialCircuitTrack[4].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[4].name = "china";
-    m_timeTrialCircuitTrack[5].sound  = m_soundEngland;
-    m_timeTrialCircuitTrack[5].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[5].name = "england";
-    m_timeTrialCircuitTrack[6].sound  = m_soundFinland;
-    m_timeTrialCircuitTrack[6].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[6].name = "finland";
-    m_timeTrialCircuitTrack[7].sound  = m_soundFrance;
-    m_timeTrialCircuitTrack[7].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[7].name = "france";
-    m_timeTrialCircuitTrack[8].sound  = m_soundGermany;
-    m_timeTrialCircuitTrack[8].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[8].name = "germany";
-    m_timeTrialCircuitTrack[9].sound  = m_soundIreland;
-    m_timeTrialCircuitTrack[9].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[9].name = "ireland";
-    m_timeTrialCircuitTrack[10].sound  = m_soundItaly;
-    m_timeTrialCircuitTrack[10].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[10].name = "italy";
-    m_timeTrialCircuitTrack[11].sound  = m_soundNetherlands;
-    m_timeTrialCircuitTrack[11].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[11].name = "netherlands";
-    m_timeTrialCircuitTrack[12].sound  = m_soundPortugal;
-    m_timeTrialCircuitTrack[12].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[12].name = "portugal";
-    m_timeTrialCircuitTrack[13].sound  = m_soundRussia;
-    m_timeTrialCircuitTrack[13].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[13].name = "russia";
-    m_timeTrialCircuitTrack[14].sound  = m_soundSpain;
-    m_timeTrialCircuitTrack[14].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[14].name = "spain";
-    m_timeTrialCircuitTrack[15].sound  = m_soundSweden;
-    m_timeTrialCircuitTrack[15].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[15].name = "sweden";
-    m_timeTrialCircuitTrack[16].sound  = m_soundSwitserland;
-    m_timeTrialCircuitTrack[16].action = a_timeCircuitChoose;
-    m_timeTrialCircuitTrack[16].name = "switserland";
+    for (UInt i = 0; i < NCIRCUITS; ++i)
+    {
+        m_timeTrialCircuitTrack[i].sound  = m_soundTracks[i];
+        m_timeTrialCircuitTrack[i].action = a_timeCircuitChoose;
+        m_timeTrialCircuitTrack[i].name   = TrackRegistry::entry(i).name;
+    }
     m_timeTrialCircuitTrack[17].sound  = m_soundRandom;
     m_timeTrialCircuitTrack[17].action = a_timeCircuitChooseRandom;
     m_timeTrialCircuitTrack[18].sound      = m_soundBack;
@@ -491,27 +424,12 @@ m_soundServerStarted            = m_game->loadLanguageSound("menu\\serverstarted
     m_timeTrialCircuitTrans[2].action     = a_back;
 
     // Initialize adventure menu
-    m_timeTrialAdventureTrack[0].sound   = m_soundHills;
-    m_timeTrialAdventureTrack[0].action  = a_timeAdventureChoose;
-    m_timeTrialAdventureTrack[0].name = "advHills";
-    m_timeTrialAdventureTrack[1].sound   = m_soundCoast;
-    m_timeTrialAdventureTrack[1].action  = a_timeAdventureChoose;
-    m_timeTrialAdventureTrack[1].name = "advCoast";
-    m_timeTrialAdventureTrack[2].sound   = m_soundCountry;
-    m_timeTrialAdventureTrack[2].action  = a_timeAdventureChoose;
-    m_timeTrialAdventureTrack[2].name = "advCountry";
-    m_timeTrialAdventureTrack[3].sound   = m_soundAirport;
-    m_timeTrialAdventureTrack[3].action  = a_timeAdventureChoose;
-    m_timeTrialAdventureTrack[3].name = "advAirport";
-    m_timeTrialAdventureTrack[4].sound   = m_soundDesert;
-    m_timeTrialAdventureTrack[4].action  = a_timeAdventureChoose;
-    m_timeTrialAdventureTrack[4].name = "advDesert";
-    m_timeTrialAdventureTrack[5].sound   = m_soundRush;
-    m_timeTrialAdventureTrack[5].action  = a_timeAdventureChoose;
-    m_timeTrialAdventureTrack[5].name = "advRush";
-    m_timeTrialAdventureTrack[6].sound   = m_soundEscape;
-    m_timeTrialAdventureTrack[6].action  = a_timeAdventureChoose;
-    m_timeTrialAdventureTrack[6].name = "advEscape";
+    for (UInt i = 0; i < NADVENTURES; ++i)
+    {
+        m_timeTrialAdventureTrack[i].sound  = m_soundTracks[NCIRCUITS + i];
+        m_timeTrialAdventureTrack[i].action = a_timeAdventureChoose;
+        m_timeTrialAdventureTrack[i].name   = TrackRegistry::entry(NCIRCUITS + i).name;
+    }
     m_timeTrialAdventureTrack[7].sound   = m_soundRandom;
     m_timeTrialAdventureTrack[7].action  = a_timeAdventureChooseRandom;
     m_timeTrialAdventureTrack[8].sound   = m_soundBack;
@@ -550,83 +468,23 @@ m_soundServerStarted            = m_game->loadLanguageSound("menu\\serverstarted
     m_singleRaceCircuitTrans[2].action     = a_back;
 
     // Initialize single race circuit trackmenu
-    m_singleRaceCircuitTrack[0].sound  = m_soundAmerica;
-    m_singleRaceCircuitTrack[0].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[0].name = "america";
-    m_singleRaceCircuitTrack[1].sound  = m_soundAustria;
-    m_singleRaceCircuitTrack[1].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[1].name = "austria";
-    m_singleRaceCircuitTrack[2].sound  = m_soundBelgium;
-    m_singleRaceCircuitTrack[2].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[2].name = "belgium";
-    m_singleRaceCircuitTrack[3].sound  = m_soundBrazil;
-    m_singleRaceCircuitTrack[3].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[3].name = "brazil";
-    m_singleRaceCircuitTrack[4].sound  = m_soundChina;
-    m_singleRaceCircuitTrack[4].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[4].name = "china";
-    m_singleRaceCircuitTrack[5].sound  = m_soundEngland;
-    m_singleRaceCircuitTrack[5].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[5].name = "england";
-    m_singleRaceCircuitTrack[6].sound  = m_soundFinland;
-    m_singleRaceCircuitTrack[6].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[6].name = "finland";
-    m_singleRaceCircuitTrack[7].sound  = m_soundFrance;
-    m_singleRaceCircuitTrack[7].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[7].name = "france";
-    m_singleRaceCircuitTrack[8].sound  = m_soundGermany;
-    m_singleRaceCircuitTrack[8].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[8].name = "germany";
-    m_singleRaceCircuitTrack[9].sound  = m_soundIreland;
-    m_singleRaceCircuitTrack[9].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[9].name = "ireland";
-    m_singleRaceCircuitTrack[10].sound  = m_soundItaly;
-    m_singleRaceCircuitTrack[10].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[10].name = "italy";
-    m_singleRaceCircuitTrack[11].sound  = m_soundNetherlands;
-    m_singleRaceCircuitTrack[11].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[11].name = "netherlands";
-    m_singleRaceCircuitTrack[12].sound  = m_soundPortugal;
-    m_singleRaceCircuitTrack[12].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[12].name = "portugal";
-    m_singleRaceCircuitTrack[13].sound  = m_soundRussia;
-    m_singleRaceCircuitTrack[13].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[13].name = "russia";
-    m_singleRaceCircuitTrack[14].sound  = m_soundSpain;
-    m_singleRaceCircuitTrack[14].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[14].name = "spain";
-    m_singleRaceCircuitTrack[15].sound  = m_soundSweden;
-    m_singleRaceCircuitTrack[15].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[15].name = "sweden";
-    m_singleRaceCircuitTrack[16].sound  = m_soundSwitserland;
-    m_singleRaceCircuitTrack[16].action = a_singleCircuitChoose;
-    m_singleRaceCircuitTrack[16].name = "switserland";
+    for (UInt i = 0; i < NCIRCUITS; ++i)
+    {
+        m_singleRaceCircuitTrack[i].sound  = m_soundTracks[i];
+        m_singleRaceCircuitTrack[i].action = a_singleCircuitChoose;
+        m_singleRaceCircuitTrack[i].name   = TrackRegistry::entry(i).name;
+    }
     m_singleRaceCircuitTrack[17].sound  = m_soundRandom;
     m_singleRaceCircuitTrack[17].action = a_singleCircuitChooseRandom;
     m_singleRaceCircuitTrack[18].sound      = m_soundBack;
     m_singleRaceCircuitTrack[18].action     = a_back;
     // Initialize adventure menu
-    m_singleRaceAdventureTrack[0].sound   = m_soundHills;
-    m_singleRaceAdventureTrack[0].action  = a_singleAdventureChoose;
-    m_singleRaceAdventureTrack[0].name = "advHills";
-    m_singleRaceAdventureTrack[1].sound   = m_soundCoast;
-    m_singleRaceAdventureTrack[1].action  = a_singleAdventureChoose;
-    m_singleRaceAdventureTrack[1].name = "advCoast";
-    m_singleRaceAdventureTrack[2].sound   = m_soundCountry;
-    m_singleRaceAdventureTrack[2].action  = a_singleAdventureChoose;
-    m_singleRaceAdventureTrack[2].name = "advCountry";
-    m_singleRaceAdventureTrack[3].sound   = m_soundAirport;
-    m_singleRaceAdventureTrack[3].action  = a_singleAdventureChoose;
-    m_singleRaceAdventureTrack[3].name = "advAirport";
-    m_singleRaceAdventureTrack[4].sound   = m_soundDesert;
-    m_singleRaceAdventureTrack[4].action  = a_singleAdventureChoose;
-    m_singleRaceAdventureTrack[4].name = "advDesert";
-    m_singleRaceAdventureTrack[5].sound   = m_soundRush;
-    m_singleRaceAdventureTrack[5].action  = a_singleAdventureChoose;
-    m_singleRaceAdventureTrack[5].name = "advRush";
-    m_singleRaceAdventureTrack[6].sound   = m_soundEscape;
-    m_singleRaceAdventureTrack[6].action  = a_singleAdventureChoose;
-    m_singleRaceAdventureTrack[6].name = "advEscape";
+    for (UInt i = 0; i < NADVENTURES; ++i)
+    {
+        m_singleRaceAdventureTrack[i].sound  = m_soundTracks[NCIRCUITS + i];
+        m_singleRaceAdventureTrack[i].action = a_singleAdventureChoose;
+        m_singleRaceAdventureTrack[i].name   = TrackRegistry::entry(NCIRCUITS + i).name;
+    }
     m_singleRaceAdventureTrack[7].sound   = m_soundRandom;
     m_singleRaceAdventureTrack[7].action  = a_singleAdventureChooseRandom;
     m_singleRaceAdventureTrack[8].sound   = m_soundBack;
@@ -681,57 +539,12 @@ m_soundServerStarted            = m_game->loadLanguageSound("menu\\serverstarted
     m_multiHost[5].action     = a_multiHostStopServer;
 
     // Initialize multiplayer host track menu
-    m_multiHostCircuitTrack[0].sound  = m_soundAmerica;
-    m_multiHostCircuitTrack[0].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[0].name = "america";
-    m_multiHostCircuitTrack[1].sound  = m_soundAustria;
-    m_multiHostCircuitTrack[1].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[1].name = "austria";
-    m_multiHostCircuitTrack[2].sound  = m_soundBelgium;
-    m_multiHostCircuitTrack[2].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[2].name = "belgium";
-    m_multiHostCircuitTrack[3].sound  = m_soundBrazil;
-    m_multiHostCircuitTrack[3].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[3].name = "brazil";
-    m_multiHostCircuitTrack[4].sound  = m_soundChina;
-    m_multiHostCircuitTrack[4].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[4].name = "china";
-    m_multiHostCircuitTrack[5].sound  = m_soundEngland;
-    m_multiHostCircuitTrack[5].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[5].name = "england";
-    m_multiHostCircuitTrack[6].sound  = m_soundFinland;
-    m_multiHostCircuitTrack[6].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[6].name = "finland";
-    m_multiHostCircuitTrack[7].sound  = m_soundFrance;
-    m_multiHostCircuitTrack[7].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[7].name = "france";
-    m_multiHostCircuitTrack[8].sound  = m_soundGermany;
-    m_multiHostCircuitTrack[8].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[8].name = "germany";
-    m_multiHostCircuitTrack[9].sound  = m_soundIreland;
-    m_multiHostCircuitTrack[9].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[9].name = "ireland";
-    m_multiHostCircuitTrack[10].sound  = m_soundItaly;
-    m_multiHostCircuitTrack[10].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[10].name = "italy";
-    m_multiHostCircuitTrack[11].sound  = m_soundNetherlands;
-    m_multiHostCircuitTrack[11].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[11].name = "netherlands";
-    m_multiHostCircuitTrack[12].sound  = m_soundPortugal;
-    m_multiHostCircuitTrack[12].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[12].name = "portugal";
-    m_multiHostCircuitTrack[13].sound  = m_soundRussia;
-    m_multiHostCircuitTrack[13].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[13].name = "russia";
-    m_multiHostCircuitTrack[14].sound  = m_soundSpain;
-    m_multiHostCircuitTrack[14].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[14].name = "spain";
-    m_multiHostCircuitTrack[15].sound  = m_soundSweden;
-    m_multiHostCircuitTrack[15].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[15].name = "sweden";
-    m_multiHostCircuitTrack[16].sound  = m_soundSwitserland;
-    m_multiHostCircuitTrack[16].action = a_multiHostCircuitChoose;
-    m_multiHostCircuitTrack[16].name = "switserland";
+    for (UInt i = 0; i < NCIRCUITS; ++i)
+    {
+        m_multiHostCircuitTrack[i].sound  = m_soundTracks[i];
+        m_multiHostCircuitTrack[i].action = a_multiHostCircuitChoose;
+        m_multiHostCircuitTrack[i].name   = TrackRegistry::entry(i).name;
+    }
     m_multiHostCircuitTrack[17].sound  = m_soundRandom;
     m_multiHostCircuitTrack[17].action = a_multiHostCircuitChooseRandom;
     m_multiHostCircuitTrack[18].sound      = m_soundBack;
@@ -751,27 +564,12 @@ m_soundServerStarted            = m_game->loadLanguageSound("menu\\serverstarted
     m_multiHostCircuitTrans[2].action      = a_back;
 
     // Initialize multiplayer host Adventure track menu
-    m_multiHostAdventureTrack[0].sound  = m_soundHills;
-    m_multiHostAdventureTrack[0].action = a_multiHostAdventureChoose;
-    m_multiHostAdventureTrack[0].name = "advHills";
-    m_multiHostAdventureTrack[1].sound  = m_soundCoast;
-    m_multiHostAdventureTrack[1].action = a_multiHostAdventureChoose;
-    m_multiHostAdventureTrack[1].name = "advCoast";
-    m_multiHostAdventureTrack[2].sound  = m_soundCountry;
-    m_multiHostAdventureTrack[2].action = a_multiHostAdventureChoose;
-    m_multiHostAdventureTrack[2].name = "advCountry";
-    m_multiHostAdventureTrack[3].sound  = m_soundAirport;
-    m_multiHostAdventureTrack[3].action = a_multiHostAdventureChoose;
-    m_multiHostAdventureTrack[3].name = "advAirport";
-    m_multiHostAdventureTrack[4].sound  = m_soundDesert;
-    m_multiHostAdventureTrack[4].action = a_multiHostAdventureChoose;
-    m_multiHostAdventureTrack[4].name = "advDesert";
-    m_multiHostAdventureTrack[5].sound  = m_soundRush;
-    m_multiHostAdventureTrack[5].action = a_multiHostAdventureChoose;
-    m_multiHostAdventureTrack[5].name = "advRush";
-    m_multiHostAdventureTrack[6].sound  = m_soundEscape;
-    m_multiHostAdventureTrack[6].action = a_multiHostAdventureChoose;
-    m_multiHostAdventureTrack[6].name = "advEscape";
+    for (UInt i = 0; i < NADVENTURES; ++i)
+    {
+        m_multiHostAdventureTrack[i].sound  = m_soundTracks[NCIRCUITS + i];
+        m_multiHostAdventureTrack[i].action = a_multiHostAdventureChoose;
+        m_multiHostAdventureTrack[i].name   = TrackRegistry::entry(NCIRCUITS + i).name;
+    }
     m_multiHostAdventureTrack[7].sound  = m_soundRandom;
     m_multiHostAdventureTrack[7].action = a_multiHostAdventureChooseRandom;
     m_multiHostAdventureTrack[8].sound      = m_soundBack;
@@ -1105,6 +903,7 @@ m_soundServerStarted            = m_game->loadLanguageSound("menu\\serverstarted
 //    RACE("Menu::initialize : ready to initialize the language menu.");    
     initializeLanguageMenu( );
 //    RACE("Menu::initialize : ready to initialize the track menu.");    
+    m_catalog.scan( );
     initializeTrackMenu( );
 //    RACE("Menu::initialize : ready to initialize the vehicle menu.");    
     initializeVehicleMenu( );
@@ -1204,61 +1003,29 @@ Menu::initializeLanguageMenu( )
 void
 Menu::initializeTrackMenu( )
 {
-    WIN32_FIND_DATA findFileData;
-    HANDLE          findHandle = INVALID_HANDLE_VALUE;
-    DWORD           error;
-    
+    // the catalog checked the files, only the name sounds are loaded here
     DirectX::Sound* trackSounds[MAXCUSTOMTRACKS];
     UInt            nTracks = 0;
-    findHandle = ::FindFirstFile("Tracks\\*.trk", &findFileData);
-    if (findHandle == INVALID_HANDLE_VALUE) 
+    for (UInt i = 0; (i < m_catalog.nTracks( )) && (nTracks < MAXCUSTOMTRACKS); ++i)
     {
-//        RACE("Menu::initializeTrackMenu : FindFirstFile failed with error 0x%x", GetLastError());
-    } 
-    else 
-    {
-        ::sprintf(m_customTrackFiles[nTracks], "Tracks\\%s", findFileData.cFileName);
-        Int length = ::strlen(m_customTrackFiles[nTracks]);
-        Char soundFile[64];
-        ::strncpy(soundFile, m_customTrackFiles[nTracks], length-4);
-        soundFile[length-4] = '\0';
-        sprintf(soundFile, "%s.wav", soundFile);
-        trackSounds[nTracks] = m_game->soundManager()->create(soundFile);
+        const Catalog::Entry& entry = m_catalog.track(i);
+        if (!entry.valid)
+        {
+            RACE("Menu::initializeTrackMenu : track %s has no road, skipped", entry.path);
+            continue;
+        }
+        Char soundFile[CATALOGPATH];
+        ::strcpy(soundFile, entry.sound);
+        trackSounds[nTracks] = entry.hasSound ? m_game->soundManager()->create(soundFile) : 0;
         if (trackSounds[nTracks] != 0)
         {
             // trackfile and soundfile exist
-            // RACE("Menu::initializeTrackMenu : added %s", m_customTrackFiles[nTracks]);
+            ::strcpy(m_customTrackFiles[nTracks], entry.path);
             ++nTracks;
         }
         else
         {
-            RACE("Menu::initializeTrackMenu : no soundfile for track %s found!", m_customTrackFiles[nTracks]);
-        }
-        while ((nTracks < MAXCUSTOMTRACKS) && (::FindNextFile(findHandle, &findFileData) != 0)) 
-        {
-            ::sprintf(m_customTrackFiles[nTracks], "Tracks\\%s", findFileData.cFileName);
-            length = ::strlen(m_customTrackFiles[nTracks]);
-            soundFile[64];
-            ::strncpy(soundFile, m_customTrackFiles[nTracks], length-4);
-            soundFile[length-4] = '\0';
-            sprintf(soundFile, "%s.wav", soundFile);
-            trackSounds[nTracks] = m_game->soundManager()->create(soundFile);
-            if (trackSounds[nTracks] != 0)
-            {
-                // trackfile and soundfile exist
-//                RACE("Menu::initializeTrackMenu : added %s", m_customTrackFiles[nTracks]);
-                ++nTracks;
-            }
-            else
-            {
-                RACE("Menu::initializeTrackMenu : no soundfile for track %s found!", m_customTrackFiles[nTracks]);
-            }
-        }
-        error = GetLastError();
-        ::FindClose(findHandle);
-        if (error != ERROR_NO_MORE_FILES) 
-        {
-//            RACE("Menu::initializeTrackMenu : FindNextFile failed with error 0x%x", error);
+            RACE("Menu::initializeTrackMenu : no soundfile for track %s found!", entry.path);
         }
     }
     RACE("Menu::initializeTrackMenu : %d user defined tracks found", nTracks);
@@ -1300,61 +1067,29 @@ Menu::initializeTrackMenu( )
 void
 Menu::initializeVehicleMenu( )
 {
-    WIN32_FIND_DATA findFileData;
-    HANDLE          findHandle = INVALID_HANDLE_VALUE;
-    DWORD           error;
-    
+    // the catalog checked the files, only the name sounds are loaded here
     DirectX::Sound* vehicleSounds[MAXCUSTOMVEHICLES];
     UInt            nVehicles = 0;
-    findHandle = ::FindFirstFile("Vehicles\\*.vhc", &findFileData);
-    if (findHandle == INVALID_HANDLE_VALUE) 
+    for (UInt i = 0; (i < m_catalog.nVehicles( )) && (nVehicles < MAXCUSTOMVEHICLES); ++i)
     {
-//        RACE("Menu::initializeVehicleMenu : FindFirstFile failed with error 0x%x", GetLastError());
-    } 
-    else 
-    {
-        ::sprintf(m_vehicleFiles[nVehicles], "Vehicles\\%s", findFileData.cFileName);
-        Int length = ::strlen(m_vehicleFiles[nVehicles]);
-        Char soundFile[64];
-        ::strncpy(soundFile, m_vehicleFiles[nVehicles], length-4);
-        soundFile[length-4] = '\0';
-        sprintf(soundFile, "%s.wav", soundFile);
-        vehicleSounds[nVehicles] = m_soundManager->create(soundFile);
+        const Catalog::Entry& entry = m_catalog.vehicle(i);
+        if (!entry.valid)
+        {
+            RACE("Menu::initializeVehicleMenu : vehicle %s does not read, skipped", entry.path);
+            continue;
+        }
+        Char soundFile[CATALOGPATH];
+        ::strcpy(soundFile, entry.sound);
+        vehicleSounds[nVehicles] = entry.hasSound ? m_soundManager->create(soundFile) : 0;
         if (vehicleSounds[nVehicles] != 0)
         {
             // vehiclefile and soundfile exist
-//            RACE("Menu::initializeVehicleMenu : added %s", m_vehicleFiles[nVehicles]);
+            ::strcpy(m_vehicleFiles[nVehicles], entry.path);
             ++nVehicles;
         }
         else
         {
-            RACE("Menu::initializeVehicleMenu : no soundfile for vehicle %s found!", m_vehicleFiles[nVehicles]);
-        }
-        while ((nVehicles < MAXCUSTOMVEHICLES) && (::FindNextFile(findHandle, &findFileData) != 0)) 
-        {
-            ::sprintf(m_vehicleFiles[nVehicles], "Vehicles\\%s", findFileData.cFileName);
-            length = ::strlen(m_vehicleFiles[nVehicles]);
-            soundFile[64];
-            ::strncpy(soundFile, m_vehicleFiles[nVehicles], length-4);
-            soundFile[length-4] = '\0';
-            sprintf(soundFile, "%s.wav", soundFile);
-            vehicleSounds[nVehicles] = m_soundManager->create(soundFile);
-            if (vehicleSounds[nVehicles] != 0)
-            {
-                // vehiclefile and soundfile exist
-//                RACE("Menu::initializeVehicleMenu : added %s", m_vehicleFiles[nVehicles]);
-                ++nVehicles;
-            }
-            else
-            {
-                RACE("Menu::initializeVehicleMenu : no soundfile for vehicle %s found!", m_vehicleFiles[nVehicles]);
-            }
-        }
-        error = GetLastError();
-        ::FindClose(findHandle);
-        if (error != ERROR_NO_MORE_FILES) 
-        {
-//            RACE("Menu::initializeVehicleMenu : FindNextFile failed with error 0x%x", error);
+            RACE("Menu::initializeVehicleMenu : no soundfile for vehicle %s found!", entry.path);
         }
     }
     RACE("Menu::initializeVehicleMenu : %d user defined vehicles found", nVehicles);
@@ -1502,35 +1237,13 @@ Menu::finalize( )
     SAFE_DELETE(m_soundAdventure);
     SAFE_DELETE(m_soundCustomTrack);
     SAFE_DELETE(m_soundPickCircuit);
-    SAFE_DELETE(m_soundAmerica);
-    SAFE_DELETE(m_soundAustria);
-    SAFE_DELETE(m_soundBelgium);
-    SAFE_DELETE(m_soundBrazil);
-    SAFE_DELETE(m_soundChina);
-    SAFE_DELETE(m_soundEngland);
-    SAFE_DELETE(m_soundFinland);
-    SAFE_DELETE(m_soundFrance);
-    SAFE_DELETE(m_soundGermany);
-    SAFE_DELETE(m_soundIreland);
-    SAFE_DELETE(m_soundItaly);
-    SAFE_DELETE(m_soundNetherlands);
-    SAFE_DELETE(m_soundPortugal);
-    SAFE_DELETE(m_soundRussia);
-    SAFE_DELETE(m_soundSpain);
-    SAFE_DELETE(m_soundSweden);
-    SAFE_DELETE(m_soundSwitserland);
+    for (UInt i = 0; i < NTRACKS; ++i)
+        SAFE_DELETE(m_soundTracks[i]);
     SAFE_DELETE(m_soundPickVehicle);
     for (UInt i = 0; i < NVEHICLES; ++i)
         SAFE_DELETE(m_soundVehicles[i]);
     SAFE_DELETE(m_soundRandom);
     SAFE_DELETE(m_soundPickAdventure);
-    SAFE_DELETE(m_soundHills);
-    SAFE_DELETE(m_soundCoast);
-    SAFE_DELETE(m_soundCountry);
-    SAFE_DELETE(m_soundAirport);
-    SAFE_DELETE(m_soundDesert);
-    SAFE_DELETE(m_soundRush);
-    SAFE_DELETE(m_soundEscape);
     SAFE_DELETE(m_soundChoose);
     SAFE_DELETE(m_soundConfirm);
     SAFE_DELETE(m_soundAutomatic);
@@ -9,11 +9,13 @@
 
 #include "Game.h"
 #include "RaceInput.h"
+#include "TrackRegistry.h"
+#include "Catalog.h"
 
 #define NVEHICLES     12
-#define NCIRCUITS     17
-#define NADVENTURES   7
-#define NTRACKS       24
+#define NCIRCUITS     NBUILTINCIRCUITS
+#define NADVENTURES   NBUILTINADVENTURES
+#define NTRACKS       NBUILTINTRACKS
 #define MAXCUSTOMTRACKS 256
 #define MAXCUSTOMVEHICLES 256
 
@@ -182,34 +184,11 @@ private:
     DirectX::Sound*         m_soundAdventure;
     DirectX::Sound*         m_soundCustomTrack;
     DirectX::Sound*         m_soundPickCircuit;
-    DirectX::Sound*         m_soundAmerica;
-    DirectX::Sound*         m_soundAustria;
-    DirectX::Sound*         m_soundBelgium;
-    DirectX::Sound*         m_soundBrazil;
-    DirectX::Sound*         m_soundChina;
-    DirectX::Sound*         m_soundEngland;
-    DirectX::Sound*         m_soundFinland;
-    DirectX::Sound*         m_soundFrance;
-    DirectX::Sound*         m_soundGermany;
-    DirectX::Sound*         m_soundIreland;
-    DirectX::Sound*         m_soundItaly;
-    DirectX::Sound*         m_soundNetherlands;
-    DirectX::Sound*         m_soundPortugal;
-    DirectX::Sound*         m_soundRussia;
-    DirectX::Sound*         m_soundSpain;
-    DirectX::Sound*         m_soundSweden;
-    DirectX::Sound*         m_soundSwitserland;
+    DirectX::Sound*         m_soundTracks[NTRACKS];
     DirectX::Sound*         m_soundPickVehicle;
     DirectX::Sound*         m_soundVehicles[NVEHICLES];
     DirectX::Sound*         m_soundRandom;
     DirectX::Sound*         m_soundPickAdventure;
-    DirectX::Sound*         m_soundHills;
-    DirectX::Sound*         m_soundCoast;
-    DirectX::Sound*         m_soundCountry;
-    DirectX::Sound*         m_soundAirport;
-    DirectX::Sound*         m_soundDesert;
-    DirectX::Sound*         m_soundRush;
-    DirectX::Sound*         m_soundEscape;
     DirectX::Sound*         m_soundChoose;
     DirectX::Sound*         m_soundChangeOption;
     DirectX::Sound*         m_soundConfirm;
@@ -377,6 +356,7 @@ private:
     Char                    m_languageFiles[64][64];
     Char                    m_customTrackFiles[MAXCUSTOMTRACKS][64];
     Char                    m_vehicleFiles[MAXCUSTOMVEHICLES][64];
+    Catalog                 m_catalog;
     UInt                    m_nSessions;
     Char                    m_nSessionsSound[64];
 
@@ -27,6 +27,7 @@ NetworkPlayer::NetworkPlayer( ) :
 //    m_soundInFront(0),
 //    m_soundOnTail(0),
     m_initialized(false),
+    m_profile(0),
     m_frame(1),
     m_finished(false),
     m_backfirePlayed(false),
@@ -67,7 +68,18 @@ NetworkPlayer::initialize(Game* game, UInt number, UInt vehicle, Int trackLength
     m_topfreq       = vehicles[vehicle].topfreq;
     m_shiftfreq     = vehicles[vehicle].shiftfreq;
     m_gears         = vehicles[vehicle].gears;
+    m_profile       = &VehicleProfile::official(vehicle);
     m_frequency     = m_idlefreq;
+    CarPhysics::Parameters physics;
+    physics.model           = CarPhysics::player;
+    physics.acceleration    = vehicles[vehicle].acceleration;
+    physics.deceleration    = m_deceleration;
+    physics.topspeed        = m_topspeed;
+    physics.gears           = m_gears;
+    physics.steering        = vehicles[vehicle].steering;
+    physics.steeringFactor  = vehicles[vehicle].steeringFactor;
+    physics.profile         = m_profile;
+    m_physics.parameters(physics);
     m_soundEngine   = m_game->soundManager()->create(vehicles[vehicle].engineSound, m_game->threeD( ));
     m_soundStart    = m_game->soundManager()->create(vehicles[vehicle].startSound, m_game->threeD( ));
     m_soundHorn     = m_game->soundManager()->create(vehicles[vehicle].hornSound, m_game->threeD( ));
@@ -199,9 +211,10 @@ NetworkPlayer::run(Float elapsed, Int playerX, Int playerY)
     }
     else if (m_state == stopping)
     {
-        m_speed -= Int(elapsed*100*m_deceleration);
-        if (m_speed < 0)
-            m_speed = 0;
+        // positions keep coming from the network, only the speed runs down here
+        m_physics.sync(m_positionX, m_positionY, m_speed);
+        m_physics.runStopping(elapsed);
+        m_speed = m_physics.speed( );
         // update frequencies
         if (m_frame % 4 == 0)
         {
@@ -242,25 +255,7 @@ NetworkPlayer::run(Float elapsed, Int playerX, Int playerY)
 void 
 NetworkPlayer::updateEngineFreq( )
 {
-    Int gearRange = m_topspeed/(m_gears+1);
-    if ((m_speed / gearRange) < 2)
-    {
-        Float gearSpeed = (m_speed / (2.0f*gearRange));
-        m_frequency = Int(gearSpeed*(m_topfreq - m_idlefreq)) + m_idlefreq;
-    }
-    else
-    {
-        Int gear = m_speed / gearRange;
-        Float gearSpeed = (m_speed - gear*gearRange)/(1.0f*gearRange);
-        if (gearSpeed < 0.07f)
-        {
-            m_frequency = Int(((0.07f - gearSpeed)/0.07f)*(m_topfreq - m_shiftfreq) + m_shiftfreq);
-        }
-        else
-        {
-            m_frequency = Int(gearSpeed*(m_topfreq - m_shiftfreq) + m_shiftfreq);
-        }        
-    }
+    m_frequency = m_profile->frequency(m_speed);
     if (m_frequency != m_prevFrequency)
     {
         m_soundEngine-> frequency(m_frequency);
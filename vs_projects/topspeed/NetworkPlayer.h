@@ -12,6 +12,7 @@
 
 #include "Packets.h"
 #include "Game.h"
+#include "CarPhysics.h"
 
 class NetworkPlayer
 {
@@ -67,6 +68,7 @@ private:
     UInt                    m_number;
     State                   m_state;
     Game*                   m_game;
+    CarPhysics              m_physics;
     Int                     m_speed;
     Int                     m_prevFrequency;
     Int                     m_frequency;
@@ -97,6 +99,7 @@ private:
     Int                     m_topfreq;
     Int                     m_shiftfreq;
     Int                     m_gears;
+    const VehicleProfile*   m_profile;
     Int                     m_frame;
     UInt                    m_laneWidth;
     Int                     m_diffX;
@@ -12,8 +12,10 @@
 
 #define         NMAXPLAYERS     8
 #define         MAXMULTITRACKLENGTH    8192
+// bytes a snapshot of all players takes at most, see Snapshot.h
+#define         SNAPSHOTMAXDATA        256
 
-const UByte _TopSpeedVersion = 0x1E;
+const UByte _TopSpeedVersion = 0x20;
 
 #pragma pack(push)
 #pragma pack(1)
@@ -80,7 +82,11 @@ enum Command
     cmdPlayerCrashed,
     cmdPlayerBumped,
     cmdPlayerDisconnected,
-    cmdLoadCustomTrack
+    cmdLoadCustomTrack,
+    cmdSnapshot,
+    cmdSnapshotAck,
+    cmdOfferTrack,
+    cmdRequestTrack
 };
 
 
@@ -126,6 +132,21 @@ public:
 };
 
 
+// the track by the hash of its content, see TrackCache; a client that does
+// not have it answers with PacketRequestTrack and gets PacketLoadCustomTrack
+class PacketOfferTrack : public PacketLoadTrack
+{
+public:
+    UHuge           trackHash;
+};
+
+class PacketRequestTrack : public PacketBase
+{
+public:
+    UHuge           trackHash;
+};
+
+
 class PacketGeneral : public PacketBase
 {
 };
@@ -183,6 +204,21 @@ public:
     UShort          bumpSpeed;
 };
 
+class PacketSnapshot : public PacketBase
+{
+public:
+    UShort          sequence;
+    UShort          baseline;       // equal to sequence for a full snapshot
+    UByte           players;        // bit per player number present
+    UByte           data[SNAPSHOTMAXDATA];
+};
+
+class PacketSnapshotAck : public PacketBase
+{
+public:
+    UShort          sequence;
+};
+
 #pragma pack(pop)
 
 #endif /* __RACING_PACKETS_H__ */
@@ -25,12 +25,12 @@ RaceClient::RaceClient(Game* game) :
     Mutex::Guard guard(m_mutex);
     RACE("(+) RaceClient");
     m_trackData.definition = NULL;
+    m_trackHash = 0;
 }
 
 
 RaceClient::~RaceClient( )
 {
-    Mutex::Guard guard(m_mutex);
     RACE("(-) RaceClient");
     finalize( );
 }
@@ -42,7 +42,10 @@ RaceClient::initialize( )
     RACE("RaceClient::initialize");
     if (m_client == 0)
     {
-        m_client = new DirectX::Client( );
+        if (m_game->raceSettings().directPlay)
+            m_client = new DirectX::Client( );
+        else
+            m_client = new DirectX::UdpClient( );
         m_client->setGUID(m_game->gameGuid());
         m_client->setIClient(this);
         m_client->initialize( );
@@ -74,19 +77,29 @@ RaceClient::initialize( )
         m_playerCrashed[player] = false;
     }
     m_playerState = undefined;
+    m_snapshots.reset( );
     resetResults( );
 }
 
 void
 RaceClient::finalize( )
 {
-    Mutex::Guard guard(m_mutex);
     RACE("RaceClient::finalize");
-    if (m_client)
+    // finalizing the client waits for the thread that calls onPacket and
+    // onSessionLost, which take the lock, so it is done without holding it;
+    // the callbacks still running find the client gone and do nothing
+    DirectX::Client* client;
     {
-        m_client->finalize( );
-        SAFE_DELETE(m_client);
+        Mutex::Guard guard(m_mutex);
+        client = m_client;
+        m_client = 0;
     }
+    if (client)
+    {
+        client->finalize( );
+        SAFE_DELETE(client);
+    }
+    Mutex::Guard guard(m_mutex);
     m_trackSelected = false;
 	SAFE_DELETE_ARRAY(m_trackData.definition);
     // state flags
@@ -377,6 +390,8 @@ RaceClient::onPacket(UInt from, void* buffer, UInt size)
 {
     Mutex::Guard guard(m_mutex);
     //RACE("RaceClient::onPacket");
+    if (m_client == 0)
+        return;
     if (size >= 0)
     {
         PacketBase* packet = reinterpret_cast<PacketBase*>(buffer);
@@ -445,6 +460,21 @@ RACE("***client received packet %d, command %d with a size of %d", packet, packe
                     }
                     break;
                 }
+                case cmdSnapshot :
+                {
+                    // Update the data of the others, then tell the server what we have
+                    const Snapshot* snapshot = m_snapshots.decode(reinterpret_cast<PacketSnapshot*>(packet), size);
+                    if (snapshot)
+                    {
+                        for (UInt player = 0; player < NMAXPLAYERS; ++player)
+                            snapshot->get(player, m_playerData[player]);
+                        PacketSnapshotAck ack;
+                        ack.command  = cmdSnapshotAck;
+                        ack.sequence = snapshot->sequence;
+                        sendPacket(&ack, sizeof(PacketSnapshotAck), false);
+                    }
+                    break;
+                }
                 case cmdPlayerState :
                 {
                     // Update the playerstate for this client
@@ -530,25 +560,39 @@ else
                     m_game->playerDisconnected((UInt)player->playerNumber);
                     break;
                 }
+                case cmdOfferTrack :
+                    if ((!m_trackSelected) && (size >= sizeof(PacketOfferTrack)))
+                    {
+                        // a track we have costs nothing, only unknown ones are sent
+                        PacketOfferTrack* offerTrack = reinterpret_cast<PacketOfferTrack*>(packet);
+                        RACE("RaceClient::onPacket : received 'OfferTrack(%s)', nrOfLaps = %d, trackLength = %d", offerTrack->trackname, offerTrack->nrOfLaps, offerTrack->trackLength);
+                        m_nrOfLaps = offerTrack->nrOfLaps;
+                        strcpy(m_track, offerTrack->trackname);
+                        m_trackHash = offerTrack->trackHash;
+                        if (m_trackCache.find(m_trackHash, m_trackData))
+                            m_trackSelected = true;
+                        else
+                        {
+                            PacketRequestTrack request;
+                            request.command   = cmdRequestTrack;
+                            request.trackHash = m_trackHash;
+                            sendPacket(&request, sizeof(PacketRequestTrack), true);
+                        }
+                    }
+                    break;
                 case cmdLoadCustomTrack :
                     if (!m_trackSelected)
                     {
                         PacketLoadCustomTrack* loadTrack = reinterpret_cast<PacketLoadCustomTrack*>(packet);
                         RACE("RaceClient::onPacket : received 'LoadCustomTrack(%s)', nrOfLaps = %d, trackLength = %d", loadTrack->trackname, loadTrack->nrOfLaps, loadTrack->trackLength);
+                        if (!TrackCache::readPacket(loadTrack, size, m_trackData))
+                            break;
                         m_nrOfLaps = loadTrack->nrOfLaps;
                         strcpy(m_track, loadTrack->trackname);
-                        m_trackData.weather = (Track::Weather)loadTrack->trackWeather;
-                        m_trackData.ambience = (Track::Ambience)loadTrack->trackAmbience;
-                        m_trackData.length = loadTrack->trackLength;
-                        SAFE_DELETE_ARRAY(m_trackData.definition);
-                        m_trackData.definition = new Track::Definition[loadTrack->trackLength];
-        				for (UInt i = 0; i < loadTrack->trackLength; ++i)
-                        {
-                            m_trackData.definition[i].type = (Track::Type)loadTrack->trackDefinition[i].type;
-                            m_trackData.definition[i].surface = (Track::Surface)loadTrack->trackDefinition[i].surface;
-                            m_trackData.definition[i].noise = (Track::Noise)loadTrack->trackDefinition[i].noise;
-                            m_trackData.definition[i].length = loadTrack->trackDefinition[i].length;
-                        }
+                        UHuge hash = TrackCache::hash(m_trackData);
+                        if (hash != m_trackHash)
+                            RACE("(!) RaceClient::onPacket : the track is not the one offered");
+                        m_trackCache.store(hash, m_trackData);
                         m_trackSelected = true;
                     }
                     break;
@@ -565,6 +609,8 @@ RaceClient::onSessionLost( )
 {
     Mutex::Guard guard(m_mutex);
     RACE("RaceClient::onSessionLost");
+    if (m_client == 0)
+        return;
     m_connected = false;
     m_sessionLost = true;
 
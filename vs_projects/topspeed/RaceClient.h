@@ -8,8 +8,11 @@
 #define __RACING_RACECLIENT_H__
 
 #include <DxCommon/If/Network.h>
+#include <DxCommon/If/UdpNetwork.h>
 #include <Common/If/Mutex.h>
 #include "Packets.h"
+#include "Snapshot.h"
+#include "TrackCache.h"
 
 class Game;
 class Menu;
@@ -83,7 +86,10 @@ private:
     UInt                m_nrOfLaps;
     Boolean             m_trackSelected;
     Track::TrackData	m_trackData;
+    UHuge               m_trackHash;
+    TrackCache          m_trackCache;
     PlayerData          m_playerData[NMAXPLAYERS];
+    SnapshotDecoder     m_snapshots;
     Boolean             m_playerFinished[NMAXPLAYERS];
     Boolean             m_playerFinalize[NMAXPLAYERS];
     Boolean             m_playerStarted[NMAXPLAYERS];
@@ -12,6 +12,7 @@ RaceInput::RaceInput(Game* game) :
     m_game(game),
     m_useJoystick(true)
 {
+    ::memset(&m_actions, 0, sizeof(m_actions));
     RACE("(+) RaceInput");
 }
 
@@ -79,10 +80,52 @@ void
 RaceInput::run(DirectX::Input::State& input)
 {
     m_lastState = input;
+    m_actions.steering = readSteering( );
+    m_actions.throttle = readThrottle( );
+    m_actions.brake    = readBrake( );
+    const struct
+    {
+        JoystickAxisOrButton    axis;
+        UByte                   key;
+        UInt                    bit;
+    } buttons[ ] =
+    {
+        { m_gearUp,             m_kbGearUp,             RaceReplay::gearUp          },
+        { m_gearDown,           m_kbGearDown,           RaceReplay::gearDown        },
+        { m_horn,               m_kbHorn,               RaceReplay::horn            },
+        { m_requestInfo,        m_kbRequestInfo,        RaceReplay::requestInfo     },
+        { m_currentGear,        m_kbCurrentGear,        RaceReplay::currentGear     },
+        { m_currentLapNr,       m_kbCurrentLapNr,       RaceReplay::currentLapNr    },
+        { m_currentRacePerc,    m_kbCurrentRacePerc,    RaceReplay::currentRacePerc },
+        { m_currentLapPerc,     m_kbCurrentLapPerc,     RaceReplay::currentLapPerc  },
+        { m_currentRaceTime,    m_kbCurrentRaceTime,    RaceReplay::currentRaceTime }
+    };
+    m_actions.buttons = 0;
+    for (UInt i = 0; i < sizeof(buttons)/sizeof(buttons[0]); ++i)
+        if (readButton(buttons[i].axis, buttons[i].key))
+            m_actions.buttons |= buttons[i].bit;
+    // these are keys only, whatever the device
+    const UByte keys[ ] = { m_kbTrackName, m_kbPlayerNumber, m_kbPause, m_kbFlush };
+    const UInt  bits[ ] = { RaceReplay::trackName, RaceReplay::playerNumber, RaceReplay::pause, RaceReplay::flush };
+    for (UInt i = 0; i < sizeof(keys)/sizeof(keys[0]); ++i)
+        if (m_lastState.keys[keys[i]])
+            m_actions.buttons |= bits[i];
+    const UByte players[ ] = { m_kbPlayer1, m_kbPlayer2, m_kbPlayer3, m_kbPlayer4,
+                               m_kbPlayer5, m_kbPlayer6, m_kbPlayer7, m_kbPlayer8 };
+    const UByte positions[ ] = { m_kbPlayerPos1, m_kbPlayerPos2, m_kbPlayerPos3, m_kbPlayerPos4,
+                                 m_kbPlayerPos5, m_kbPlayerPos6, m_kbPlayerPos7, m_kbPlayerPos8 };
+    for (UInt i = 0; i < 8; ++i)
+    {
+        if (m_lastState.keys[players[i]])
+            m_actions.buttons |= RaceReplay::playerInfo1 << i;
+        if (m_lastState.keys[positions[i]])
+            m_actions.buttons |= RaceReplay::playerPosition1 << i;
+    }
 }
 
+
 Int  
-RaceInput::getSteering( )
+RaceInput::readSteering( )
 {
     if (!m_useJoystick)
     {
@@ -106,7 +149,7 @@ RaceInput::getSteering( )
 
 
 Int
-RaceInput::getThrottle( )
+RaceInput::readThrottle( )
 {
     if (!m_useJoystick)
     {
@@ -123,7 +166,7 @@ RaceInput::getThrottle( )
 
 
 Int
-RaceInput::getBrake( )
+RaceInput::readBrake( )
 {
     if (!m_useJoystick)
     {
@@ -138,212 +181,30 @@ RaceInput::getBrake( )
 
 
 Boolean
-RaceInput::getGearUp( )
-{
-    if (!m_useJoystick)
-    {
-        return ((Boolean)(m_lastState.keys[m_kbGearUp]));
-    }
-    else
-    {
-        return (getAxis(m_gearUp) > 50);
-    }
-}
-
-
-Boolean
-RaceInput::getGearDown( )
-{
-    if (!m_useJoystick)
-    {
-        return ((Boolean)(m_lastState.keys[m_kbGearDown]));
-    }
-    else
-    {
-        return (getAxis(m_gearDown) > 50);
-    }
-}
-
-
-Boolean
-RaceInput::getHorn( )
-{
-    if (!m_useJoystick)
-    {
-        return ((Boolean)(m_lastState.keys[m_kbHorn]));
-    }
-    else
-    {
-        return (getAxis(m_horn) > 50);
-    }
-}
-
-Boolean
-RaceInput::getRequestInfo( )
-{
-    if (!m_useJoystick)
-    {
-        return ((Boolean)(m_lastState.keys[m_kbRequestInfo]));
-    }
-    else
-    {
-        return (getAxis(m_requestInfo) > 50);
-    }
-}
-
-Boolean
-RaceInput::getCurrentGear( )
-{
-    if (!m_useJoystick)
-    {
-        return ((Boolean)(m_lastState.keys[m_kbCurrentGear]));
-    }
-    else
-    {
-        return (getAxis(m_currentGear) > 50);
-    }
-}
-
-Boolean
-RaceInput::getCurrentLapNr( )
-{
-    if (!m_useJoystick)
-    {
-        return ((Boolean)(m_lastState.keys[m_kbCurrentLapNr]));
-    }
-    else
-    {
-        return (getAxis(m_currentLapNr) > 50);
-    }
-}
-
-Boolean
-RaceInput::getCurrentRacePerc( )
-{
-    if (!m_useJoystick)
-    {
-        return ((Boolean)(m_lastState.keys[m_kbCurrentRacePerc]));
-    }
-    else
-    {
-        return (getAxis(m_currentRacePerc) > 50);
-    }
-}
-
-Boolean
-RaceInput::getCurrentLapPerc( )
+RaceInput::readButton(JoystickAxisOrButton a, UByte key)
 {
     if (!m_useJoystick)
     {
-        return ((Boolean)(m_lastState.keys[m_kbCurrentLapPerc]));
+        return ((Boolean)(m_lastState.keys[key]));
     }
     else
     {
-        return (getAxis(m_currentLapPerc) > 50);
+        return (getAxis(a) > 50);
     }
 }
 
-Boolean
-RaceInput::getCurrentRaceTime( )
-{
-    if (!m_useJoystick)
-    {
-        return ((Boolean)(m_lastState.keys[m_kbCurrentRaceTime]));
-    }
-    else
-    {
-        return (getAxis(m_currentRaceTime) > 50);
-    }
-}
 
+// the first of the 8 bits set, in player, the way F1 to F8 and 1 to 8 are read
 Boolean
-RaceInput::getPlayerInfo(UInt& player)
+RaceInput::player8(UInt first, UInt& player) const
 {
-    if (m_lastState.keys[m_kbPlayer1])
-    {
-        player = 0;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayer2])
-    {
-        player = 1;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayer3])
-    {
-        player = 2;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayer4])
-    {
-        player = 3;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayer5])
-    {
-        player = 4;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayer6])
-    {
-        player = 5;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayer7])
-    {
-        player = 6;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayer8])
-    {
-        player = 7;
-        return true;
-    }
-    return false;
-}
-
-Boolean
-RaceInput::getPlayerPosition(UInt& player)
-{
-    if (m_lastState.keys[m_kbPlayerPos1])
-    {
-        player = 0;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayerPos2])
-    {
-        player = 1;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayerPos3])
-    {
-        player = 2;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayerPos4])
-    {
-        player = 3;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayerPos5])
-    {
-        player = 4;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayerPos6])
-    {
-        player = 5;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayerPos7])
-    {
-        player = 6;
-        return true;
-    }
-    else if (m_lastState.keys[m_kbPlayerPos8])
+    for (UInt i = 0; i < 8; ++i)
     {
-        player = 7;
-        return true;
+        if (m_actions.buttons & (first << i))
+        {
+            player = i;
+            return true;
+        }
     }
     return false;
 }
@@ -8,6 +8,7 @@
 #define __RACING_RACEINPUT_H__
 
 #include <DxCommon/If/Common.h>
+#include "RaceReplay.h"
 
 class Game;
 
@@ -97,32 +98,41 @@ public:
     void setCurrentRaceTime(UByte key);
     void setCenter(DirectX::Input::State& c);
     void setDevice(Boolean useJoystick);
-    Int     getSteering( );
-    Int     getThrottle( );
-    Int     getBrake( );
-    Boolean getGearUp( );
-    Boolean getGearDown( );
-    Boolean getHorn( );
-    Boolean getRequestInfo( );
-    Boolean getCurrentGear( );
-    Boolean getCurrentLapNr( );
-    Boolean getCurrentRacePerc( );
-    Boolean getCurrentLapPerc( );
-    Boolean getCurrentRaceTime( );
-    Boolean getPlayerInfo(UInt& player);
-    Boolean getTrackName( ) { return ((Boolean)(m_lastState.keys[m_kbTrackName])); }
-    Boolean getPlayerNumber( ) { return ((Boolean)(m_lastState.keys[m_kbPlayerNumber])); }
-    Boolean getPause( ) { return ((Boolean)(m_lastState.keys[m_kbPause])); }
-    Boolean getPlayerPosition(UInt& player);
-    Boolean getFlush( ) { return ((Boolean)(m_lastState.keys[m_kbFlush])); }
+    Int     getSteering( )                  { return m_actions.steering; }
+    Int     getThrottle( )                  { return m_actions.throttle; }
+    Int     getBrake( )                     { return m_actions.brake; }
+    Boolean getGearUp( )                    { return button(RaceReplay::gearUp); }
+    Boolean getGearDown( )                  { return button(RaceReplay::gearDown); }
+    Boolean getHorn( )                      { return button(RaceReplay::horn); }
+    Boolean getRequestInfo( )               { return button(RaceReplay::requestInfo); }
+    Boolean getCurrentGear( )               { return button(RaceReplay::currentGear); }
+    Boolean getCurrentLapNr( )              { return button(RaceReplay::currentLapNr); }
+    Boolean getCurrentRacePerc( )           { return button(RaceReplay::currentRacePerc); }
+    Boolean getCurrentLapPerc( )            { return button(RaceReplay::currentLapPerc); }
+    Boolean getCurrentRaceTime( )           { return button(RaceReplay::currentRaceTime); }
+    Boolean getPlayerInfo(UInt& player)     { return player8(RaceReplay::playerInfo1, player); }
+    Boolean getTrackName( )                 { return button(RaceReplay::trackName); }
+    Boolean getPlayerNumber( )              { return button(RaceReplay::playerNumber); }
+    Boolean getPause( )                     { return button(RaceReplay::pause); }
+    Boolean getPlayerPosition(UInt& player) { return player8(RaceReplay::playerPosition1, player); }
+    Boolean getFlush( )                     { return button(RaceReplay::flush); }
     DirectX::Input::State& getCenter( )         { return m_centerInput; }
     void readFromSettings( );
 
 public:
+    // what the devices say, or what a replay said when actions is called after run
     void run(DirectX::Input::State& input);
+    const RaceReplay::Actions& actions( ) const            { return m_actions;    }
+    void actions(const RaceReplay::Actions& actions)       { m_actions = actions; }
 
 private:
     Int getAxis(JoystickAxisOrButton a);
+    Int readSteering( );
+    Int readThrottle( );
+    Int readBrake( );
+    Boolean readButton(JoystickAxisOrButton a, UByte key);
+    Boolean button(UInt bit) const          { return ((m_actions.buttons & bit) != 0); }
+    Boolean player8(UInt first, UInt& player) const;
 
 private:
     Game*                   m_game;
@@ -175,6 +185,7 @@ private:
     UByte                   m_kbFlush;
     DirectX::Input::State   m_centerInput;
     DirectX::Input::State   m_lastState;
+    RaceReplay::Actions     m_actions;
 };
 
 
@@ -0,0 +1,266 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "RaceReplay.h"
+#include "Game.h"
+#include <stdio.h>
+
+static const Char replayMagic[4] = { 'T', 'S', 'R', 'P' };
+
+
+// small values either side of 0 in few bytes: 0, -1, 1, -2, 2...
+static UInt
+zigzag(Int value)
+{
+    return (UInt(value) << 1) ^ UInt(value >> 31);
+}
+
+
+static Int
+unzigzag(UInt value)
+{
+    return Int(value >> 1) ^ -Int(value & 1);
+}
+
+
+RaceReplay::RaceReplay( ) :
+    m_frames(0),
+    m_size(0),
+    m_capacity(0),
+    m_nFrames(0),
+    m_duration(0)
+{
+    ::memset(&m_setup, 0, sizeof(m_setup));
+    rewind( );
+}
+
+
+RaceReplay::~RaceReplay( )
+{
+    SAFE_DELETE_ARRAY(m_frames);
+}
+
+
+void
+RaceReplay::record(const Setup& setup)
+{
+    clear( );
+    m_setup = setup;
+    m_setup.track[REPLAYPATH - 1] = '\0';
+    m_setup.vehicleFile[REPLAYPATH - 1] = '\0';
+}
+
+
+void
+RaceReplay::add(UInt elapsed, const Actions& actions)
+{
+    // the most a frame takes: the byte of changes and five values
+    if (m_size + 1 + 5*5 > m_capacity)
+    {
+        if (m_capacity >= REPLAYMAXSIZE)
+        {
+            RACE("(!) RaceReplay::add : replay full, frame %u dropped", m_nFrames);
+            return;
+        }
+        UInt capacity = (m_capacity == 0) ? 4096 : 2*m_capacity;
+        UByte* frames = new UByte[capacity];
+        if (m_size > 0)
+            ::memcpy(frames, m_frames, m_size);
+        SAFE_DELETE_ARRAY(m_frames);
+        m_frames   = frames;
+        m_capacity = capacity;
+    }
+    UByte changed = 0;
+    if (actions.steering != m_actions.steering)
+        changed |= changedSteering;
+    if (actions.throttle != m_actions.throttle)
+        changed |= changedThrottle;
+    if (actions.brake != m_actions.brake)
+        changed |= changedBrake;
+    if (actions.buttons != m_actions.buttons)
+        changed |= changedButtons;
+    m_frames[m_size++] = changed;
+    put(zigzag(Int(elapsed - m_elapsed)));
+    if (changed & changedSteering)
+        put(zigzag(actions.steering));
+    if (changed & changedThrottle)
+        put(zigzag(actions.throttle));
+    if (changed & changedBrake)
+        put(zigzag(actions.brake));
+    if (changed & changedButtons)
+        put(actions.buttons);
+    m_elapsed = elapsed;
+    m_actions = actions;
+    m_duration += elapsed;
+    ++m_nFrames;
+}
+
+
+Boolean
+RaceReplay::write(const Char* filename) const
+{
+    FILE* file = ::fopen(filename, "wb");
+    if (file == NULL)
+    {
+        RACE("(!) RaceReplay::write : could not write %s", filename);
+        return false;
+    }
+    Header header;
+    ::memset(&header, 0, sizeof(header));
+    ::memcpy(header.magic, replayMagic, sizeof(replayMagic));
+    header.version = REPLAY_VERSION;
+    header.setup   = m_setup;
+    header.nFrames = m_nFrames;
+    header.size    = m_size;
+    Boolean written = (::fwrite(&header, sizeof(header), 1, file) == 1)
+                      && ((m_size == 0) || (::fwrite(m_frames, 1, m_size, file) == m_size));
+    ::fclose(file);
+    if (!written)
+    {
+        RACE("(!) RaceReplay::write : could not write %s", filename);
+        ::remove(filename);
+        return false;
+    }
+    RACE("RaceReplay::write : %s, %u frames in %u bytes", filename, m_nFrames, m_size);
+    return true;
+}
+
+
+Boolean
+RaceReplay::read(const Char* filename)
+{
+    clear( );
+    FILE* file = ::fopen(filename, "rb");
+    if (file == NULL)
+    {
+        RACE("(!) RaceReplay::read : could not open %s", filename);
+        return false;
+    }
+    Header header;
+    Boolean valid = (::fread(&header, sizeof(header), 1, file) == 1)
+                    && (::memcmp(header.magic, replayMagic, sizeof(replayMagic)) == 0)
+                    && (header.version == REPLAY_VERSION) && (header.size <= REPLAYMAXSIZE);
+    if (valid)
+    {
+        m_frames   = new UByte[header.size + 1];
+        m_capacity = header.size + 1;
+        valid = (::fread(m_frames, 1, header.size, file) == header.size);
+    }
+    ::fclose(file);
+    if (!valid)
+    {
+        RACE("(!) RaceReplay::read : %s is not a replay of this version", filename);
+        clear( );
+        return false;
+    }
+    m_setup = header.setup;
+    m_setup.track[REPLAYPATH - 1] = '\0';
+    m_setup.vehicleFile[REPLAYPATH - 1] = '\0';
+    m_size = header.size;
+
+    // counted again rather than believed, next stops where the bytes do
+    UInt elapsed;
+    Actions actions;
+    rewind( );
+    while (next(elapsed, actions))
+    {
+        ++m_nFrames;
+        m_duration += elapsed;
+    }
+    if (m_nFrames != header.nFrames)
+        RACE("(!) RaceReplay::read : %s holds %u frames, not %u", filename, m_nFrames, header.nFrames);
+    rewind( );
+    return true;
+}
+
+
+void
+RaceReplay::rewind( )
+{
+    m_position = 0;
+    m_elapsed  = 0;
+    ::memset(&m_actions, 0, sizeof(m_actions));
+}
+
+
+Boolean
+RaceReplay::next(UInt& elapsed, Actions& actions)
+{
+    if (m_position >= m_size)
+        return false;
+    UByte changed = m_frames[m_position++];
+    UInt value;
+    Boolean complete = get(value);
+    elapsed = m_elapsed + unzigzag(value);
+    actions = m_actions;
+    if ((complete) && (changed & changedSteering))
+    {
+        complete = get(value);
+        actions.steering = unzigzag(value);
+    }
+    if ((complete) && (changed & changedThrottle))
+    {
+        complete = get(value);
+        actions.throttle = unzigzag(value);
+    }
+    if ((complete) && (changed & changedBrake))
+    {
+        complete = get(value);
+        actions.brake = unzigzag(value);
+    }
+    if ((complete) && (changed & changedButtons))
+    {
+        complete = get(value);
+        actions.buttons = value;
+    }
+    if (!complete)
+        return false;
+    m_elapsed = elapsed;
+    m_actions = actions;
+    return true;
+}
+
+
+void
+RaceReplay::clear( )
+{
+    SAFE_DELETE_ARRAY(m_frames);
+    m_size     = 0;
+    m_capacity = 0;
+    m_nFrames  = 0;
+    m_duration = 0;
+    rewind( );
+}
+
+
+// seven bits a byte, the high bit set on all but the last
+void
+RaceReplay::put(UInt value)
+{
+    while (value >= 0x80)
+    {
+        m_frames[m_size++] = UByte(value | 0x80);
+        value >>= 7;
+    }
+    m_frames[m_size++] = UByte(value);
+}
+
+
+Boolean
+RaceReplay::get(UInt& value)
+{
+    value = 0;
+    for (UInt shift = 0; (shift < 35) && (m_position < m_size); shift += 7)
+    {
+        UByte b = m_frames[m_position++];
+        value |= UInt(b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+            return true;
+    }
+    // cut off in the middle of a value, the frame is not played
+    m_position = m_size;
+    return false;
+}
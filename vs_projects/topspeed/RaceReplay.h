@@ -0,0 +1,138 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_RACEREPLAY_H__
+#define __RACING_RACEREPLAY_H__
+
+#include <Common/If/Common.h>
+
+#define REPLAY_VERSION      2
+// longest track or vehicle file name, as Game keeps the track
+#define REPLAYPATH          256
+// bytes of frames a replay may hold, a few hours of racing
+#define REPLAYMAXSIZE       (16*1024*1024)
+
+
+/*************************************************************************************
+ *@class RaceReplay
+ *@description
+ *    A race as it was played: what was chosen before it started, the seed of
+ *    random, and for every frame the time it took and the actions RaceInput
+ *    read from the keyboard or joystick. Feeding the same frames back gives
+ *    the same race, as long as the game does not look at the clock itself.
+ *
+ *    A frame is a byte saying what changed since the frame before, the
+ *    change in its time and only the values that changed; a frame in which
+ *    nothing but the time changes takes two or three bytes. The file is a
+ *    Header followed by the frames.
+ *************************************************************************************/
+class RaceReplay
+{
+public:
+    enum Mode
+    {
+        singleRace      = 0,
+        timeTrial       = 1
+    };
+
+    // the buttons RaceInput knows, bits of Actions::buttons
+    enum Button
+    {
+        gearUp          = 0x00000001,
+        gearDown        = 0x00000002,
+        horn            = 0x00000004,
+        requestInfo     = 0x00000008,
+        currentGear     = 0x00000010,
+        currentLapNr    = 0x00000020,
+        currentRacePerc = 0x00000040,
+        currentLapPerc  = 0x00000080,
+        currentRaceTime = 0x00000100,
+        trackName       = 0x00000200,
+        playerNumber    = 0x00000400,
+        pause           = 0x00000800,
+        flush           = 0x00001000,
+        playerInfo1     = 0x00002000,       // and the 7 bits after it, one per player
+        playerPosition1 = 0x00200000        // idem
+    };
+
+    struct Actions
+    {
+        Int             steering;
+        Int             throttle;
+        Int             brake;
+        UInt            buttons;
+    };
+
+    struct Setup
+    {
+        UInt            seed;
+        UInt            mode;
+        Char            track[REPLAYPATH];
+        UInt            vehicle;
+        Char            vehicleFile[REPLAYPATH];    // empty for a built-in vehicle
+        Boolean         automaticTransmission;
+        UInt            laps;
+        UInt            computers;
+        Int             difficulty;
+        UInt            arithmetic;     // CarPhysics::Arithmetic
+    };
+
+public:
+    RaceReplay( );
+    virtual ~RaceReplay( );
+
+public:
+    void            record(const Setup& setup);
+    void            add(UInt elapsed, const Actions& actions);
+    Boolean         write(const Char* filename) const;
+
+    Boolean         read(const Char* filename);
+    void            rewind( );
+    Boolean         next(UInt& elapsed, Actions& actions);
+
+    const Setup&    setup( ) const              { return m_setup;       }
+    UInt            nFrames( ) const            { return m_nFrames;     }
+    UInt            size( ) const               { return m_size;        }
+    UHuge           duration( ) const           { return m_duration;    }
+
+private:
+    struct Header
+    {
+        Char            magic[4];
+        UInt            version;
+        Setup           setup;
+        UInt            nFrames;
+        UInt            size;
+    };
+
+    enum Changed
+    {
+        changedSteering = 0x01,
+        changedThrottle = 0x02,
+        changedBrake    = 0x04,
+        changedButtons  = 0x08
+    };
+
+private:
+    void            clear( );
+    void            put(UInt value);
+    Boolean         get(UInt& value);
+
+private:
+    UByte*          m_frames;
+    UInt            m_size;
+    UInt            m_capacity;
+    UInt            m_nFrames;
+    UHuge           m_duration;         // microseconds
+    Setup           m_setup;
+    // the frame before, where add and next take the changes from
+    UInt            m_position;
+    UInt            m_elapsed;
+    Actions         m_actions;
+};
+
+
+#endif /* __RACING_RACEREPLAY_H__ */
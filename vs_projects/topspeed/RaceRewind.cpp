@@ -0,0 +1,125 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "RaceRewind.h"
+
+
+RaceRewind::RaceRewind(UInt seconds, UInt rate) :
+    m_frames(0),
+    m_capacity(0),
+    m_first(0),
+    m_nFrames(0),
+    m_interval(0.0f),
+    m_nextCapture(0.0f)
+{
+    if (rate == 0)
+        rate = 1;
+    // one more than the seconds ask for, so the oldest is that far back
+    m_capacity = seconds*rate + 1;
+    m_interval = 1.0f / rate;
+    m_frames   = new Frame[m_capacity];
+    RACE("(+) RaceRewind : %d snapshots of %d bytes", m_capacity, sizeof(Frame));
+}
+
+
+RaceRewind::~RaceRewind( )
+{
+    SAFE_DELETE_ARRAY(m_frames);
+    RACE("(-) RaceRewind");
+}
+
+
+void
+RaceRewind::clear( )
+{
+    m_first       = 0;
+    m_nFrames     = 0;
+    m_nextCapture = 0.0f;
+}
+
+
+RaceRewind::Frame&
+RaceRewind::capture(Float time)
+{
+    UInt index;
+    if (m_nFrames < m_capacity)
+        index = (m_first + m_nFrames++) % m_capacity;
+    else
+    {
+        index = m_first;
+        m_first = (m_first + 1) % m_capacity;
+    }
+    m_nextCapture = time + m_interval;
+    Frame& frame = m_frames[index];
+    frame.time = time;
+    return frame;
+}
+
+
+// the latest snapshot is dropped, the next capture is due as it was
+void
+RaceRewind::discard( )
+{
+    if (m_nFrames > 0)
+        --m_nFrames;
+}
+
+
+// NULL while there is no snapshot to go back to
+const RaceRewind::Frame*
+RaceRewind::rewind(UInt i)
+{
+    if (m_nFrames == 0)
+        return NULL;
+    if (i >= m_nFrames)
+        i = m_nFrames - 1;
+    m_nFrames = i + 1;
+    const Frame& latest = frame(i);
+    m_nextCapture = latest.time + m_interval;
+    return &latest;
+}
+
+
+UInt
+RaceRewind::find(Float time) const
+{
+    if (m_nFrames == 0)
+        return 0;
+    // snapshots are about an interval apart, so the guess is off by a few at most
+    Float offset = (time - frame(0).time) / m_interval;
+    UInt i = (offset <= 0.0f) ? 0 : (offset >= Float(m_nFrames - 1)) ? m_nFrames - 1 : UInt(offset);
+    while ((i + 1 < m_nFrames) && (frame(i + 1).time <= time))
+        ++i;
+    while ((i > 0) && (frame(i).time > time))
+        --i;
+    return i;
+}
+
+
+// no Frame has room for more than REWINDEVENTS
+Boolean
+RaceRewind::saveEvents(const EventScheduler& events, Pending* pending, UInt max, UInt& nPending)
+{
+    Event saved[REWINDEVENTS];
+    if (!events.save(saved, (max < REWINDEVENTS) ? max : REWINDEVENTS, nPending))
+        return false;
+    for (UInt i = 0; i < nPending; ++i)
+    {
+        pending[i].time  = saved[i].time;
+        pending[i].type  = saved[i].type;
+        pending[i].sound = saved[i].sound;
+    }
+    return true;
+}
+
+
+void
+RaceRewind::restoreEvents(const Pending* pending, UInt nPending, EventScheduler& events)
+{
+    events.clear( );
+    for (UInt i = 0; i < nPending; ++i)
+        events.schedule(Event::Type(pending[i].type), pending[i].time, pending[i].sound);
+}
@@ -0,0 +1,113 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_RACEREWIND_H__
+#define __RACING_RACEREWIND_H__
+
+#include "CarPhysics.h"
+#include "EventScheduler.h"
+
+// snapshots taken per second of race, and the seconds kept by default
+#define REWINDRATE          10
+#define REWINDSECONDS       600
+// cars a snapshot holds, as many as a race has players
+#define REWINDCARS          8
+// pending events kept per car and for the race itself
+#define REWINDCAREVENTS     4
+#define REWINDEVENTS        16
+
+
+/*************************************************************************************
+ *@class RaceRewind
+ *@description
+ *    The last REWINDSECONDS of a race, as snapshots taken REWINDRATE times a
+ *    second in a ring allocated once. A snapshot is a Frame, plain data the
+ *    owner fills in place: per car the physics, the lap, position and crash
+ *    counters and the pending events, for the race the time, the simulation
+ *    step and the state of its random numbers. Taking one copies less than
+ *    two kilobytes and allocates nothing; when the ring is full the oldest is
+ *    written over. A snapshot that could not be filled in, with more events
+ *    pending than it has room for, is thrown away again with discard.
+ *
+ *    rewind makes an older snapshot the latest one and drops the ones after
+ *    it, so the race carries on from there and is recorded again; with no
+ *    snapshot taken yet it returns NULL and leaves the race where it is. The road
+ *    cursors are not kept, they only remember where the last query was; the
+ *    owner resets them and the next query seeks.
+ *************************************************************************************/
+class RaceRewind
+{
+public:
+    // an event the way EventScheduler::schedule takes it
+    struct Pending
+    {
+        Float               time;
+        UInt                type;
+        DirectX::Sound*     sound;
+    };
+
+    struct Car
+    {
+        CarPhysics::Snapshot physics;
+        Float           lapStart;
+        Float           finishTime;
+        UInt            lap;
+        UInt            laps;           // laps completed
+        UInt            position;       // 0 while still racing
+        UInt            bumps;
+        UInt            crashes;
+        Int             steering;
+        Int             throttle;
+        UByte           state;
+        UByte           surface;
+        UByte           nEvents;
+        Pending         event[REWINDCAREVENTS];
+    };
+
+    struct Frame
+    {
+        Float           time;
+        UInt            step;
+        UInt            random;
+        UInt            nCars;
+        UInt            nFinished;
+        UInt            nEvents;
+        Car             car[REWINDCARS];
+        Pending         event[REWINDEVENTS];
+    };
+
+public:
+    RaceRewind(UInt seconds = REWINDSECONDS, UInt rate = REWINDRATE);
+    virtual ~RaceRewind( );
+
+public:
+    void            clear( );
+    Boolean         due(Float time) const       { return time >= m_nextCapture;         }
+    Frame&          capture(Float time);
+    void            discard( );
+    const Frame*    rewind(UInt i);
+    UInt            find(Float time) const;
+
+    UInt            nFrames( ) const            { return m_nFrames;                     }
+    const Frame&    frame(UInt i) const         { return m_frames[(m_first + i) % m_capacity];  }
+    UInt            capacity( ) const           { return m_capacity;                    }
+    UInt            memory( ) const             { return m_capacity*sizeof(Frame);      }
+
+public:
+    static Boolean  saveEvents(const EventScheduler& events, Pending* pending, UInt max, UInt& nPending);
+    static void     restoreEvents(const Pending* pending, UInt nPending, EventScheduler& events);
+
+private:
+    Frame*              m_frames;
+    UInt                m_capacity;
+    UInt                m_first;        // the oldest snapshot
+    UInt                m_nFrames;
+    Float               m_interval;
+    Float               m_nextCapture;
+};
+
+
+#endif /* __RACING_RACEREWIND_H__ */
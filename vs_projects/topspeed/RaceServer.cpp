@@ -20,12 +20,12 @@ RaceServer::RaceServer(Game* game) :
     Mutex::Guard guard(m_mutex);
     RACE("(+) RaceServer");
     m_trackData.definition = NULL;
+    m_trackHash = 0;
 }
 
 
 RaceServer::~RaceServer( )
 {
-    Mutex::Guard guard(m_mutex);
     RACE("(-) RaceServer");
     finalize( );
 }
@@ -37,7 +37,10 @@ RaceServer::initialize( )
     RACE("RaceServer::initialize");
     if (m_server == 0)
     {
-        m_server = new DirectX::Server( );
+        if (m_game->raceSettings().directPlay)
+            m_server = new DirectX::Server( );
+        else
+            m_server = new DirectX::UdpServer( );
         m_server->setGUID(m_game->gameGuid());
         m_server->setIServer(this);
         char sessionName[64];
@@ -50,15 +53,25 @@ RaceServer::initialize( )
 void
 RaceServer::finalize( )
 {
-    Mutex::Guard guard(m_mutex);
     RACE("RaceServer::finalize");
-    m_finalizing = true;
-    if (m_server)
+    // stopping the session waits for the thread that calls onPacket and the
+    // like, which take the lock, so it is stopped without holding it; the
+    // callbacks still running find the server gone and do nothing
+    DirectX::Server* server;
     {
-        m_server->stopSession( );
-        SAFE_DELETE(m_server);
-        m_playerMap.clear( );
+        Mutex::Guard guard(m_mutex);
+        m_finalizing = true;
+        server = m_server;
+        m_server = 0;
     }
+    if (server)
+    {
+        server->stopSession( );
+        SAFE_DELETE(server);
+    }
+    Mutex::Guard guard(m_mutex);
+    if (server)
+        m_playerMap.clear( );
     resetTrack( );
     m_finalizing = false;
 }
@@ -71,28 +84,14 @@ RaceServer::run(Float elapsed)
     m_lastUpdateTime += elapsed;
     if (m_lastUpdateTime > SERVER_UPDATE_TIME)
     {
+        Snapshot snapshot;
+        snapshot.clear( );
         TPlayerDataMap::iterator it;
         for (it = m_playerMap.begin( ); it != m_playerMap.end( ); ++it)
         {
             PlayerData player = (*it).second;
             if ((player.state != undefined) && (player.state != notReady))
-            {
-                PacketPlayerData packet;
-                packet.command              = cmdPlayerData;
-                packet.playerId             = player.id;
-                packet.playerNumber         = player.playerNumber;
-                packet.car                  = (CarType)player.car;
-                packet.racedata.positionX   = player.posX;
-                packet.racedata.positionY   = player.posY;
-                packet.racedata.speed       = player.speed;
-                packet.racedata.frequency       = player.frequency;
-                packet.state                = (PlayerState)player.state;
-                packet.engineRunning        = player.engineRunning;
-                packet.braking              = player.braking;
-                packet.horning              = player.horning;
-                packet.backfiring           = player.backfiring;
-                sendPacketToRacersExceptTo(player.id, &packet, sizeof(PacketPlayerData), false);
-            }
+                snapshot.set(player);
             if (player.state == racing)
             {
                 // check for bumps
@@ -119,6 +118,19 @@ RaceServer::run(Float elapsed)
                 }
             }
         }        
+        // every racer gets the others as the difference to what it acknowledged last
+        for (it = m_playerMap.begin( ); it != m_playerMap.end( ); ++it)
+        {
+            PlayerData player = (*it).second;
+            if (((player.state == awaitingStart) || (player.state == racing) || (player.state == finished)) && (player.playerNumber < NMAXPLAYERS))
+            {
+                Snapshot others = snapshot;
+                others.present &= ~(1 << player.playerNumber);
+                PacketSnapshot packet;
+                UInt size = m_encoder[player.playerNumber].encode(others, packet);
+                sendPacketTo(player.id, &packet, size, false);
+            }
+        }
         m_lastUpdateTime = 0.0f;
     }
 }
@@ -140,45 +152,24 @@ void
 RaceServer::loadCustomTrack(Char* trackname)
 {
     Mutex::Guard guard(m_mutex);
-    RACE("RaceServer::loadCustomTrack : sending track to all pending players, trackname = %s", trackname);
-    PacketLoadCustomTrack packet;
-    packet.command = cmdLoadCustomTrack;
+    RACE("RaceServer::loadCustomTrack : offering track to all pending players, trackname = %s", trackname);
     strcpy(m_track, trackname);
-    if (strstr(_strlwr(m_track), "adv") == NULL)
-        packet.nrOfLaps = (UByte)m_game->raceSettings().nrOfLaps;
-    else
-        packet.nrOfLaps = 1;
     Track* track = Track::readTrack(trackname);
     m_trackData.userDefined = track->userDefined( );
-    if (!m_trackData.userDefined)
-        strcpy(packet.trackname, trackname);
-    else
-        sprintf(packet.trackname, "custom");
     m_trackData.weather = track->weather( );
-    packet.trackWeather = (UByte)track->weather( );
     m_trackData.ambience = track->ambience( );
-    packet.trackAmbience = (UByte)track->ambience( );
     m_trackData.length = track->trackLength( );
-    packet.trackLength = (UShort)track->trackLength( );
+    if (m_trackData.length > MAXMULTITRACKLENGTH)
+        m_trackData.length = MAXMULTITRACKLENGTH;
     SAFE_DELETE_ARRAY(m_trackData.definition);
-    m_trackData.definition = new Track::Definition[track->trackLength()];
+    m_trackData.definition = new Track::Definition[m_trackData.length];
     Track::Definition* trackDefinition = track->definition();
-    for (UInt i = 0; i < track->trackLength(); ++i)
-    {
+    for (UInt i = 0; i < m_trackData.length; ++i)
         m_trackData.definition[i] = trackDefinition[i];
-        packet.trackDefinition[i].type = (UByte)trackDefinition[i].type;
-        packet.trackDefinition[i].surface = (UByte)trackDefinition[i].surface;
-        packet.trackDefinition[i].noise = (UByte)trackDefinition[i].noise;
-        packet.trackDefinition[i].length = trackDefinition[i].length;
-        if (i == MAXMULTITRACKLENGTH-1)
-        {
-           m_trackData.length = MAXMULTITRACKLENGTH;
-           packet.trackLength = MAXMULTITRACKLENGTH;
-           break;
-        }
-    }
-    sendPacketToNotReady(&packet, sizeof(PacketLoadTrack) + (sizeof(MultiplayerDefinition) * track->trackLength()), true);
+    SAFE_DELETE(track);
+    m_trackHash = TrackCache::hash(m_trackData);
     m_trackSelected = true;
+    sendTrackOffer(0);
 }
 
 void 
@@ -336,10 +327,44 @@ RaceServer::sendPlayerDisconnected(UInt player)
     sendPacketExceptTo(playerData.id, &packet, sizeof(PacketPlayer), true);
 }
 
+void
+RaceServer::fillTrackHeader(PacketLoadTrack& packet)
+{
+    Mutex::Guard guard(m_mutex);
+    if (strstr(_strlwr(m_track), "adv") == NULL)
+        packet.nrOfLaps = (UByte)m_game->raceSettings().nrOfLaps;
+    else
+        packet.nrOfLaps = 1;
+    if (!m_trackData.userDefined)
+        strcpy(packet.trackname, m_track);
+    else
+        sprintf(packet.trackname, "custom");
+    packet.trackWeather = (UByte)m_trackData.weather;
+    packet.trackAmbience = (UByte)m_trackData.ambience;
+    packet.trackLength = (UShort)m_trackData.length;
+}
+
+void
+RaceServer::sendTrackOffer(UInt to)
+{
+    Mutex::Guard guard(m_mutex);
+    PacketOfferTrack packet;
+    fillTrackHeader(packet);
+    packet.command = cmdOfferTrack;
+    packet.trackHash = m_trackHash;
+    // to nobody in particular means to everyone who is not ready yet
+    if (to == 0)
+        sendPacketToNotReady(&packet, sizeof(PacketOfferTrack), true);
+    else
+        sendPacketTo(to, &packet, sizeof(PacketOfferTrack), true);
+}
+
 void
 RaceServer::onPacket(UInt from, void* buffer, UInt size)
 {
     Mutex::Guard guard(m_mutex);
+    if ((m_finalizing) || (m_server == 0))
+        return;
     PacketBase* packet = static_cast<PacketBase*>(buffer);
 RACE("***server received packet %d, command %d with a size of %d", packet, packet->command, size);
     switch (packet->command)
@@ -375,39 +400,37 @@ RACE("***server received packet %d, command %d with a size of %d", packet, packe
             m_playerMap[from].backfiring    = playerData->backfiring;
         }
         break;
+    case cmdSnapshotAck:
+        {
+            PacketSnapshotAck* snapshotAck = static_cast<PacketSnapshotAck*>(buffer);
+            TPlayerDataMap::iterator it = m_playerMap.find(from);
+            if ((it != m_playerMap.end( )) && ((*it).second.playerNumber < NMAXPLAYERS))
+                m_encoder[(*it).second.playerNumber].acknowledge(snapshotAck->sequence);
+        }
+        break;
+    case cmdRequestTrack:
+        {
+            // only clients that have neither the track nor a cached copy ask
+            PacketRequestTrack* requestTrack = static_cast<PacketRequestTrack*>(buffer);
+            if ((size >= sizeof(PacketRequestTrack)) && (m_trackSelected) && (requestTrack->trackHash == m_trackHash))
+            {
+                RACE("RaceServer::onPacket : sending track to client %d, trackname = %s", from, m_track);
+                PacketLoadCustomTrack packetCustomTrack;
+                fillTrackHeader(packetCustomTrack);
+                packetCustomTrack.command = cmdLoadCustomTrack;
+                UInt packetSize = TrackCache::writePacket(m_trackData, packetCustomTrack);
+                sendPacketTo(from, &packetCustomTrack, packetSize, true);
+            }
+        }
+        break;
     case cmdPlayerState:
         {
             // Update the playerstate for this client
             PacketPlayerState* playerState = reinterpret_cast<PacketPlayerState*>(packet);
             if ((playerState->state == notReady) && (m_playerMap[from].state != notReady) && (m_trackSelected))
             {
-                RACE("RaceServer::onPacket : sending track to player %d, trackname = %s", playerState->playerNumber, m_track);
-                PacketLoadCustomTrack packetCustomTrack;
-                packetCustomTrack.command = cmdLoadCustomTrack;
-                if (strstr(_strlwr(m_track), "adv") == NULL)
-                    packetCustomTrack.nrOfLaps = (UByte)m_game->raceSettings().nrOfLaps;
-                else
-                    packetCustomTrack.nrOfLaps = 1;
-                if (!m_trackData.userDefined)
-                    strcpy(packetCustomTrack.trackname, m_track);
-                else
-                    sprintf(packetCustomTrack.trackname, "custom");
-                packetCustomTrack.trackWeather = (UByte)m_trackData.weather;
-                packetCustomTrack.trackAmbience = (UByte)m_trackData.ambience;
-                packetCustomTrack.trackLength = (UShort)m_trackData.length;
-                for (UInt i = 0; i < m_trackData.length; ++i)
-                {
-                    packetCustomTrack.trackDefinition[i].type = (UByte)m_trackData.definition[i].type;
-                    packetCustomTrack.trackDefinition[i].surface = (UByte)m_trackData.definition[i].surface;
-                    packetCustomTrack.trackDefinition[i].noise = (UByte)m_trackData.definition[i].noise;
-                    packetCustomTrack.trackDefinition[i].length = m_trackData.definition[i].length;
-                    if (i == MAXMULTITRACKLENGTH-1)
-                    {
-                       packetCustomTrack.trackLength = MAXMULTITRACKLENGTH;
-                       break;
-                    }
-                }
-                sendPacketTo(from, &packetCustomTrack, sizeof(PacketLoadTrack) + (sizeof(MultiplayerDefinition) * m_trackData.length), true);
+                RACE("RaceServer::onPacket : offering track to player %d, trackname = %s", playerState->playerNumber, m_track);
+                sendTrackOffer(from);
             }
             RACE("RaceServer::onPacket : updating the state for client %d from %d to %d", from, m_playerMap[from].state, playerState->state);
             m_playerMap[from].state         = playerState->state;
@@ -461,6 +484,8 @@ RaceServer::onAddConnection(UInt id)
 {
     Mutex::Guard guard(m_mutex);
     RACE("RaceServer::onAddConnection : id = %d", id);
+    if ((m_finalizing) || (m_server == 0))
+        return;
     PlayerData playerData;
     playerData.id     = id;
     playerData.playerNumber = 0;
@@ -499,6 +524,7 @@ RaceServer::onAddConnection(UInt id)
     // if arrived here, a valid playernumber was found, it is contained in i
     playerData.playerNumber = (UByte)i;
     m_playerMap[id] = playerData;
+    m_encoder[i].reset( );
     // send over the playernumber
     PacketPlayer packet;
     packet.command = cmdPlayerNumber;
@@ -517,33 +543,8 @@ RaceServer::onAddConnection(UInt id)
         }
         else
         {
-            RACE("RaceServer::onPacket : sending track to player %d, trackname = %s", playerData.playerNumber, m_track);
-            PacketLoadCustomTrack packetCustomTrack;
-            packetCustomTrack.command = cmdLoadCustomTrack;
-            if (strstr(_strlwr(m_track), "adv") == NULL)
-                packetCustomTrack.nrOfLaps = (UByte)m_game->raceSettings().nrOfLaps;
-            else
-                packetCustomTrack.nrOfLaps = 1;
-            if (!m_trackData.userDefined)
-                strcpy(packetCustomTrack.trackname, m_track);
-            else
-                sprintf(packetCustomTrack.trackname, "custom");
-            packetCustomTrack.trackWeather = (UByte)m_trackData.weather;
-            packetCustomTrack.trackAmbience = (UByte)m_trackData.ambience;
-            packetCustomTrack.trackLength = (UShort)m_trackData.length;
-            for (UInt i = 0; i < m_trackData.length; ++i)
-            {
-                packetCustomTrack.trackDefinition[i].type = (UByte)m_trackData.definition[i].type;
-                packetCustomTrack.trackDefinition[i].surface = (UByte)m_trackData.definition[i].surface;
-                packetCustomTrack.trackDefinition[i].noise = (UByte)m_trackData.definition[i].noise;
-                packetCustomTrack.trackDefinition[i].length = m_trackData.definition[i].length;
-                if (i == MAXMULTITRACKLENGTH-1)
-                {
-                   packetCustomTrack.trackLength = MAXMULTITRACKLENGTH;
-                   break;
-                }
-            }
-            sendPacketTo(id, &packetCustomTrack, sizeof(PacketLoadTrack) + (sizeof(MultiplayerDefinition) * m_trackData.length), true);
+            RACE("RaceServer::onAddConnection : offering track to player %d, trackname = %s", playerData.playerNumber, m_track);
+            sendTrackOffer(id);
         }
     }
 }
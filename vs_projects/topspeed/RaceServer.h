@@ -8,11 +8,14 @@
 #define __RACING_RACESERVER_H__
 
 #include <DxCommon/If/Network.h>
+#include <DxCommon/If/UdpNetwork.h>
 #include <Common/If/Mutex.h>
 #include "Packets.h"
 #include <map>
 #include "RaceClient.h"
 #include "Track.h"
+#include "Snapshot.h"
+#include "TrackCache.h"
 
 #define SERVER_UPDATE_TIME      0.1f
 
@@ -62,6 +65,8 @@ private:
     void sendPacketToRacers(PacketBase* packet, UInt size, Boolean secure);
     void sendPacketToRacersExceptTo(UInt to, PacketBase* packet, UInt size, Boolean secure);
     void sendPlayerDisconnected(UInt player);
+    void fillTrackHeader(PacketLoadTrack& packet);
+    void sendTrackOffer(UInt to);
 
 public:
     virtual void    onPacket(UInt from, void* buffer, UInt size);
@@ -76,6 +81,7 @@ private:
     DirectX::Server*                m_server;
     Mutex                           m_mutex;
     TPlayerDataMap                  m_playerMap;
+    SnapshotEncoder                 m_encoder[NMAXPLAYERS];
     Float                           m_lastUpdateTime;
     Boolean                         m_raceStarted;
     UInt                            m_raceResults[NMAXPLAYERS];
@@ -84,6 +90,7 @@ private:
     Boolean                         m_trackSelected;
     Char                            m_track[32];
     Track::TrackData	             m_trackData;
+    UHuge                           m_trackHash;
 };
 
 
@@ -63,6 +63,7 @@ RaceSettings::RaceSettings( ) :
     randomCustomTracks(0),
     randomCustomVehicles(0),
     singleRaceCustomVehicles(0),
+    directPlay(0),
     serverNumber(random(4999) + 1000)
 {
     RACE("(+) RaceSettings");
@@ -141,6 +142,8 @@ RaceSettings::read( )
         randomCustomTracks          = settingsFile.readInt( );
         randomCustomVehicles          = settingsFile.readInt( );
         singleRaceCustomVehicles          = settingsFile.readInt( );
+        // settings written before this one read -1
+        directPlay          = (settingsFile.readInt( ) == 1) ? 1 : 0;
     }
 }
     
@@ -200,6 +203,7 @@ settingsFile.writeKeyString("lang", language);
     settingsFile.writeInt((Int) randomCustomTracks);
     settingsFile.writeInt((Int) randomCustomVehicles);
     settingsFile.writeInt((Int) singleRaceCustomVehicles);
+    settingsFile.writeInt((Int) directPlay);
 }
 
 
@@ -250,4 +254,5 @@ RaceSettings::restoreDefaults( )
     randomCustomTracks          = 0;
     randomCustomVehicles          = 0;
     singleRaceCustomVehicles          = 0;
+    directPlay          = 0;
 }
@@ -68,6 +68,8 @@ public: /* yeah, I know, just being lazy */
     Int                         randomCustomTracks;
     Int                         randomCustomVehicles;
     Int                         singleRaceCustomVehicles;
+    // 1 to race over DirectPlay instead of UDP, for hosts that still run old versions
+    Int                         directPlay;
 };
 
 
@@ -0,0 +1,113 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "RoadCursor.h"
+
+// segments to step before giving up and seeking
+#define MAXSTEPS 8
+
+RoadCursor::RoadCursor(Track* track) :
+    m_track(track),
+    m_valid(false),
+    m_lap(0),
+    m_segment(0),
+    m_start(0),
+    m_end(0),
+    m_relPos(0)
+{
+}
+
+
+RoadCursor::~RoadCursor( )
+{
+}
+
+
+Track::Road
+RoadCursor::road(Int position)
+{
+    locate(position);
+    UInt lap = (m_track->length( ) > 0) ? (UInt)(position / m_track->length( )) : 0;
+    UInt center = lap*m_track->lapCenter( ) + m_track->segmentCenter(m_segment);
+    return m_track->segmentRoad(m_segment, center, m_relPos);
+}
+
+
+UInt
+RoadCursor::segmentAt(Int position)
+{
+    locate(position);
+    return m_segment;
+}
+
+
+void
+RoadCursor::locate(Int position)
+{
+    // a track without segments: everything is on its first, empty segment
+    if (m_track->length( ) == 0)
+    {
+        m_valid   = false;
+        m_segment = 0;
+        m_relPos  = 0;
+        return;
+    }
+    UInt lap = (UInt)(position / m_track->length( ));
+    UInt pos = position % m_track->length( );
+    if (m_valid)
+    {
+        for (UInt i = 0; i < MAXSTEPS; ++i)
+        {
+            if ((lap == m_lap) && (pos >= m_start) && (pos < m_end))
+                break;
+            if ((lap > m_lap) || ((lap == m_lap) && (pos >= m_end)))
+                forward( );
+            else
+                backward( );
+        }
+    }
+    if ((!m_valid) || (lap != m_lap) || (pos < m_start) || (pos >= m_end))
+        seek(lap, pos);
+    m_relPos = pos - m_start;
+}
+
+
+void
+RoadCursor::seek(UInt lap, UInt pos)
+{
+    m_lap     = lap;
+    m_segment = m_track->segmentAt(pos);
+    m_start   = m_track->segmentStart(m_segment);
+    m_end     = m_track->segmentStart(m_segment + 1);
+    m_valid   = true;
+}
+
+
+void
+RoadCursor::forward( )
+{
+    if (++m_segment == m_track->trackLength( ))
+    {
+        m_segment = 0;
+        ++m_lap;
+    }
+    m_start = m_track->segmentStart(m_segment);
+    m_end   = m_track->segmentStart(m_segment + 1);
+}
+
+
+void
+RoadCursor::backward( )
+{
+    if (m_segment == 0)
+    {
+        m_segment = m_track->trackLength( );
+        --m_lap;
+    }
+    --m_segment;
+    m_start = m_track->segmentStart(m_segment);
+    m_end   = m_track->segmentStart(m_segment + 1);
+}
@@ -0,0 +1,50 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_ROADCURSOR_H__
+#define __RACING_ROADCURSOR_H__
+
+#include "Track.h"
+
+/*************************************************************************************
+ *@class RoadCursor
+ *@description
+ *    Remembers the segment of the last road query on a track. Positions close to
+ *    the previous one are found by stepping a few segments forward or backward
+ *    (wrapping across laps), anything further away falls back to a full seek.
+ *    Every entity querying the road each frame should own its own cursor.
+ *************************************************************************************/
+class RoadCursor
+{
+public:
+    RoadCursor(Track* track);
+    virtual ~RoadCursor( );
+
+public:
+    void        reset( )                    { m_valid = false;      }
+    Track::Road road(Int position);
+    UInt        segmentAt(Int position);
+    UInt        segment( )                  { return m_segment;     }
+    UInt        relPos( )                   { return m_relPos;      }
+
+private:
+    void        locate(Int position);
+    void        seek(UInt lap, UInt pos);
+    void        forward( );
+    void        backward( );
+
+private:
+    Track*              m_track;
+    Boolean             m_valid;
+    UInt                m_lap;
+    UInt                m_segment;
+    UInt                m_start;
+    UInt                m_end;
+    UInt                m_relPos;
+};
+
+
+#endif /* __RACING_ROADCURSOR_H__ */
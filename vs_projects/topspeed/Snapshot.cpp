@@ -0,0 +1,397 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "Snapshot.h"
+#include <string.h>
+
+// the fields of a player, one bit each in the mask of changed fields
+#define FIELDID         0x01
+#define FIELDCAR        0x02
+#define FIELDSTATE      0x04
+#define FIELDFLAGS      0x08
+#define FIELDPOSX       0x10
+#define FIELDPOSY       0x20
+#define FIELDSPEED      0x40
+#define FIELDFREQUENCY  0x80
+
+#define SNAPSHOTHEADER  (sizeof(PacketSnapshot) - SNAPSHOTMAXDATA)
+
+
+namespace
+{
+
+/*************************************************************************************
+ *@class BitWriter
+ *@description
+ *    Appends bits to a fixed buffer, the first bit in the lowest bit of a byte.
+ *************************************************************************************/
+class BitWriter
+{
+public:
+    BitWriter(UByte* buffer, UInt size) :
+        m_buffer(buffer),
+        m_size(size),
+        m_bits(0)
+    {
+        ::memset(m_buffer, 0, m_size);
+    }
+
+    void write(UInt value, UInt nBits)
+    {
+        for (UInt i = 0; i < nBits; ++i)
+        {
+            if ((m_bits >> 3) >= m_size)
+                return;
+            if (value & (UInt(1) << i))
+                m_buffer[m_bits >> 3] |= UByte(1 << (m_bits & 7));
+            ++m_bits;
+        }
+    }
+
+    // zigzag, then a two bit size class and the value in 4, 8, 16 or 32 bits
+    void writeDelta(Int delta)
+    {
+        UInt value = (UInt(delta) << 1) ^ UInt(delta >> 31);
+        if (value < 0x10)
+        {
+            write(0, 2);
+            write(value, 4);
+        }
+        else if (value < 0x100)
+        {
+            write(1, 2);
+            write(value, 8);
+        }
+        else if (value < 0x10000)
+        {
+            write(2, 2);
+            write(value, 16);
+        }
+        else
+        {
+            write(3, 2);
+            write(value, 32);
+        }
+    }
+
+    UInt size( ) const          { return (m_bits + 7) >> 3;     }
+
+private:
+    UByte*      m_buffer;
+    UInt        m_size;
+    UInt        m_bits;
+};
+
+
+/*************************************************************************************
+ *@class BitReader
+ *@description
+ *    Reads what BitWriter wrote. Reading past the end sets the overrun flag and
+ *    returns zero bits.
+ *************************************************************************************/
+class BitReader
+{
+public:
+    BitReader(const UByte* buffer, UInt size) :
+        m_buffer(buffer),
+        m_size(size),
+        m_bits(0),
+        m_overrun(false)
+    {
+    }
+
+    UInt read(UInt nBits)
+    {
+        UInt value = 0;
+        for (UInt i = 0; i < nBits; ++i)
+        {
+            if ((m_bits >> 3) >= m_size)
+            {
+                m_overrun = true;
+                return 0;
+            }
+            if (m_buffer[m_bits >> 3] & (1 << (m_bits & 7)))
+                value |= (UInt(1) << i);
+            ++m_bits;
+        }
+        return value;
+    }
+
+    Int readDelta( )
+    {
+        static const UInt sizes[4] = { 4, 8, 16, 32 };
+        UInt value = read(sizes[read(2)]);
+        return Int(value >> 1) ^ -Int(value & 1);
+    }
+
+    Boolean overrun( ) const    { return m_overrun;             }
+
+private:
+    const UByte*    m_buffer;
+    UInt            m_size;
+    UInt            m_bits;
+    Boolean         m_overrun;
+};
+
+
+const Snapshot::Player  _emptyPlayer = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+
+Int
+quantize(Int value, UInt shift)
+{
+    return (value + (1 << (shift - 1))) >> shift;
+}
+
+
+void
+clearHistory(Snapshot* history)
+{
+    // a sequence that does not belong in its slot never matches a lookup
+    for (UInt i = 0; i < SNAPSHOTHISTORY; ++i)
+    {
+        history[i].clear( );
+        history[i].sequence = UShort(i + 1);
+    }
+}
+
+} // namespace
+
+
+void
+Snapshot::clear( )
+{
+    sequence = 0;
+    present = 0;
+    for (UInt i = 0; i < NMAXPLAYERS; ++i)
+        player[i] = _emptyPlayer;
+}
+
+
+void
+Snapshot::set(const PlayerData& data)
+{
+    if (data.playerNumber >= NMAXPLAYERS)
+        return;
+    Player& p   = player[data.playerNumber];
+    p.id        = data.id;
+    p.car       = data.car;
+    p.state     = data.state;
+    p.flags     = (data.engineRunning ? engineRunning : 0) | (data.braking ? braking : 0) |
+                  (data.horning ? horning : 0) | (data.backfiring ? backfiring : 0);
+    p.posX      = quantize(data.posX, SNAPSHOTPOSITIONSHIFT);
+    p.posY      = quantize(data.posY, SNAPSHOTPOSITIONSHIFT);
+    p.speed     = quantize(data.speed, SNAPSHOTSPEEDSHIFT);
+    p.frequency = quantize(data.frequency, SNAPSHOTFREQUENCYSHIFT);
+    present |= UByte(1 << data.playerNumber);
+}
+
+
+Boolean
+Snapshot::get(UInt playerNumber, PlayerData& data) const
+{
+    if ((playerNumber >= NMAXPLAYERS) || ((present & (1 << playerNumber)) == 0))
+        return false;
+    const Player& p    = player[playerNumber];
+    data.id            = p.id;
+    data.playerNumber  = UByte(playerNumber);
+    data.car           = p.car;
+    data.state         = p.state;
+    data.engineRunning = (p.flags & engineRunning) != 0;
+    data.braking       = (p.flags & braking) != 0;
+    data.horning       = (p.flags & horning) != 0;
+    data.backfiring    = (p.flags & backfiring) != 0;
+    data.posX          = p.posX * (1 << SNAPSHOTPOSITIONSHIFT);
+    data.posY          = p.posY * (1 << SNAPSHOTPOSITIONSHIFT);
+    data.speed         = UShort(p.speed * (1 << SNAPSHOTSPEEDSHIFT));
+    data.frequency     = p.frequency * (1 << SNAPSHOTFREQUENCYSHIFT);
+    return true;
+}
+
+
+SnapshotEncoder::SnapshotEncoder( )
+{
+    reset( );
+}
+
+
+SnapshotEncoder::~SnapshotEncoder( )
+{
+}
+
+
+void
+SnapshotEncoder::reset( )
+{
+    clearHistory(m_history);
+    m_sequence      = 0;
+    m_acknowledged  = 0;
+    m_baseline      = false;
+    m_nFull         = 0;
+}
+
+
+void
+SnapshotEncoder::acknowledge(UShort sequence)
+{
+    // only snapshots that were sent and are still remembered, and only newer ones
+    UShort age = UShort(m_sequence - sequence);
+    if ((age == 0) || (age >= SNAPSHOTHISTORY))
+        return;
+    if ((m_baseline) && (Short(sequence - m_acknowledged) <= 0))
+        return;
+    m_acknowledged = sequence;
+    m_baseline = true;
+}
+
+
+UInt
+SnapshotEncoder::encode(const Snapshot& snapshot, PacketSnapshot& packet)
+{
+    Snapshot& current = m_history[m_sequence % SNAPSHOTHISTORY];
+    current = snapshot;
+    current.sequence = m_sequence;
+
+    const Snapshot* baseline = 0;
+    if ((m_baseline) && (UShort(m_sequence - m_acknowledged) < SNAPSHOTHISTORY))
+    {
+        baseline = &m_history[m_acknowledged % SNAPSHOTHISTORY];
+        if (baseline->sequence != m_acknowledged)
+            baseline = 0;
+    }
+    if (baseline == 0)
+    {
+        m_baseline = false;
+        ++m_nFull;
+    }
+
+    packet.command  = cmdSnapshot;
+    packet.sequence = m_sequence;
+    packet.baseline = (baseline) ? baseline->sequence : m_sequence;
+    packet.players  = current.present;
+    BitWriter writer(packet.data, SNAPSHOTMAXDATA);
+    for (UInt i = 0; i < NMAXPLAYERS; ++i)
+    {
+        if ((current.present & (1 << i)) == 0)
+            continue;
+        const Snapshot::Player& p = current.player[i];
+        const Snapshot::Player& b = ((baseline) && (baseline->present & (1 << i))) ? baseline->player[i] : _emptyPlayer;
+        UInt fields = ((p.id != b.id) ? FIELDID : 0) |
+                      ((p.car != b.car) ? FIELDCAR : 0) |
+                      ((p.state != b.state) ? FIELDSTATE : 0) |
+                      ((p.flags != b.flags) ? FIELDFLAGS : 0) |
+                      ((p.posX != b.posX) ? FIELDPOSX : 0) |
+                      ((p.posY != b.posY) ? FIELDPOSY : 0) |
+                      ((p.speed != b.speed) ? FIELDSPEED : 0) |
+                      ((p.frequency != b.frequency) ? FIELDFREQUENCY : 0);
+        if (fields == 0)
+        {
+            writer.write(0, 1);
+            continue;
+        }
+        writer.write(1, 1);
+        writer.write(fields, 8);
+        if (fields & FIELDID)
+            writer.write(p.id, 32);
+        if (fields & FIELDCAR)
+            writer.write(p.car, 8);
+        if (fields & FIELDSTATE)
+            writer.write(p.state, 8);
+        if (fields & FIELDFLAGS)
+            writer.write(p.flags, 4);
+        if (fields & FIELDPOSX)
+            writer.writeDelta(p.posX - b.posX);
+        if (fields & FIELDPOSY)
+            writer.writeDelta(p.posY - b.posY);
+        if (fields & FIELDSPEED)
+            writer.writeDelta(p.speed - b.speed);
+        if (fields & FIELDFREQUENCY)
+            writer.writeDelta(p.frequency - b.frequency);
+    }
+    ++m_sequence;
+    return SNAPSHOTHEADER + writer.size( );
+}
+
+
+SnapshotDecoder::SnapshotDecoder( )
+{
+    reset( );
+}
+
+
+SnapshotDecoder::~SnapshotDecoder( )
+{
+}
+
+
+void
+SnapshotDecoder::reset( )
+{
+    clearHistory(m_history);
+    m_last      = 0;
+    m_decoded   = false;
+}
+
+
+const Snapshot*
+SnapshotDecoder::decode(const PacketSnapshot* packet, UInt size)
+{
+    if (size < SNAPSHOTHEADER)
+        return 0;
+    UShort sequence = packet->sequence;
+    if ((m_decoded) && (Short(sequence - m_last) <= 0))
+        return 0;
+    const Snapshot* baseline = 0;
+    if (packet->baseline != sequence)
+    {
+        if (UShort(sequence - packet->baseline) >= SNAPSHOTHISTORY)
+            return 0;
+        baseline = &m_history[packet->baseline % SNAPSHOTHISTORY];
+        if (baseline->sequence != packet->baseline)
+            return 0;
+    }
+
+    // decode aside, so a broken packet leaves the history alone
+    Snapshot snapshot;
+    snapshot.sequence = sequence;
+    snapshot.present  = packet->players;
+    BitReader reader(packet->data, size - SNAPSHOTHEADER);
+    for (UInt i = 0; i < NMAXPLAYERS; ++i)
+    {
+        const Snapshot::Player& b = ((baseline) && (baseline->present & (1 << i))) ? baseline->player[i] : _emptyPlayer;
+        Snapshot::Player& p = snapshot.player[i];
+        p = b;
+        if ((snapshot.present & (1 << i)) == 0)
+            continue;
+        if (reader.read(1) == 0)
+            continue;
+        UInt fields = reader.read(8);
+        if (fields & FIELDID)
+            p.id = reader.read(32);
+        if (fields & FIELDCAR)
+            p.car = UByte(reader.read(8));
+        if (fields & FIELDSTATE)
+            p.state = UByte(reader.read(8));
+        if (fields & FIELDFLAGS)
+            p.flags = UByte(reader.read(4));
+        if (fields & FIELDPOSX)
+            p.posX = b.posX + reader.readDelta( );
+        if (fields & FIELDPOSY)
+            p.posY = b.posY + reader.readDelta( );
+        if (fields & FIELDSPEED)
+            p.speed = b.speed + reader.readDelta( );
+        if (fields & FIELDFREQUENCY)
+            p.frequency = b.frequency + reader.readDelta( );
+    }
+    if (reader.overrun( ))
+        return 0;
+
+    Snapshot& current = m_history[sequence % SNAPSHOTHISTORY];
+    current = snapshot;
+    m_last = sequence;
+    m_decoded = true;
+    return &current;
+}
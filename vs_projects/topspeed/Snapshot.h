@@ -0,0 +1,116 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_SNAPSHOT_H__
+#define __RACING_SNAPSHOT_H__
+
+#include "Packets.h"
+
+// snapshots both sides remember to delta against, a power of two; a client
+// that acknowledged nothing for this many snapshots gets a full one again
+#define SNAPSHOTHISTORY         32
+// quantization, as a shift: positions in steps of 16, the speed in steps of 8
+// and the engine frequency in steps of 16 Hz, all well below what can be heard
+#define SNAPSHOTPOSITIONSHIFT   4
+#define SNAPSHOTSPEEDSHIFT      3
+#define SNAPSHOTFREQUENCYSHIFT  4
+
+
+/*************************************************************************************
+ *@class Snapshot
+ *@description
+ *    The state of all players at one server update, quantized. Only the players
+ *    with their bit set in 'present' are valid.
+ *************************************************************************************/
+struct Snapshot
+{
+    enum Flag
+    {
+        engineRunning   = 1,
+        braking         = 2,
+        horning         = 4,
+        backfiring      = 8
+    };
+
+    struct Player
+    {
+        UInt        id;
+        UByte       car;
+        UByte       state;
+        UByte       flags;
+        Int         posX;
+        Int         posY;
+        Int         speed;
+        Int         frequency;
+    };
+
+    UShort          sequence;
+    UByte           present;
+    Player          player[NMAXPLAYERS];
+
+    void            clear( );
+    void            set(const PlayerData& data);
+    Boolean         get(UInt playerNumber, PlayerData& data) const;
+};
+
+
+/*************************************************************************************
+ *@class SnapshotEncoder
+ *@description
+ *    The server side of one client. Every snapshot is sent as the difference to
+ *    the last one the client acknowledged: per player one bit telling whether
+ *    anything changed, a mask of the fields that did and the changed fields as
+ *    variable length differences. When the client acknowledged nothing that is
+ *    still remembered, because snapshots or acknowledgements got lost, a full
+ *    snapshot is sent, which is the difference to an empty one.
+ *************************************************************************************/
+class SnapshotEncoder
+{
+public:
+    SnapshotEncoder( );
+    virtual ~SnapshotEncoder( );
+
+public:
+    void        reset( );
+    void        acknowledge(UShort sequence);
+    UInt        encode(const Snapshot& snapshot, PacketSnapshot& packet);
+    UInt        nFull( ) const              { return m_nFull;       }
+
+private:
+    Snapshot            m_history[SNAPSHOTHISTORY];
+    UShort              m_sequence;
+    UShort              m_acknowledged;
+    Boolean             m_baseline;
+    UInt                m_nFull;
+};
+
+
+/*************************************************************************************
+ *@class SnapshotDecoder
+ *@description
+ *    The client side: rebuilds snapshots from the server's packets against the
+ *    ones decoded before. Packets older than the last one decoded, or based on
+ *    a snapshot that is not remembered, are refused. Decoding does not
+ *    allocate, everything lives in the history ring.
+ *************************************************************************************/
+class SnapshotDecoder
+{
+public:
+    SnapshotDecoder( );
+    virtual ~SnapshotDecoder( );
+
+public:
+    void            reset( );
+    const Snapshot* decode(const PacketSnapshot* packet, UInt size);
+
+private:
+    Snapshot            m_history[SNAPSHOTHISTORY];
+    UShort              m_last;
+    Boolean             m_decoded;
+};
+
+
+#endif /* __RACING_SNAPSHOT_H__ */
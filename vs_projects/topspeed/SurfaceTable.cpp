@@ -0,0 +1,277 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "SurfaceTable.h"
+#include "VehicleDefinition.h"
+#include "Game.h"
+#include "resource.h"
+#include <stdio.h>
+
+// the largest numerator, denominator, drag and steering a file may give
+#define SURFACEMAXFACTOR    1000
+#define SURFACEMAXDRAG      100000
+#define SURFACEMAXSTEERING  1000
+
+static const Char* surfaceNames[NSURFACES] =
+{
+    "asphalt", "gravel", "water", "sand", "snow"
+};
+
+// what CarPhysics::step and Car had written out before there was a table
+static const SurfaceTable::Surface builtinSurfaces[NSURFACES] =
+{
+    //  grip player, computer   braking player, computer   drag  steering  sound
+    { { { 1, 1 }, { 1, 1 } },   { { 1, 1 }, { 1, 1 } },    1000, 100,      IDR_ASPHALT },
+    { { { 2, 3 }, { 2, 3 } },   { { 2, 3 }, { 2, 3 } },    1000, 100,      IDR_GRAVEL  },
+    { { { 3, 5 }, { 3, 5 } },   { { 3, 5 }, { 3, 5 } },    1000, 100,      IDR_WATER   },
+    { { { 1, 2 }, { 3, 8 } },   { { 3, 2 }, { 5, 4 } },    1000, 100,      IDR_SAND    },
+    { { { 1, 1 }, { 1, 1 } },   { { 1, 2 }, { 1, 2 } },    1000, 144,      IDR_SNOW    }
+};
+
+// a field of a surface and where it goes, a fraction, a number or the sound
+struct SurfaceField
+{
+    const Char*                                 name;
+    UInt                                        length;
+    SurfaceTable::Factor (SurfaceTable::Surface::* factor)[2];
+    UInt                                        model;
+    Int SurfaceTable::Surface::*                value;
+    Int                                         maximum;
+};
+
+static const SurfaceField surfaceFields[] =
+{
+    { "grip",             4, &SurfaceTable::Surface::grip,    0, NULL, SURFACEMAXFACTOR },
+    { "computergrip",    12, &SurfaceTable::Surface::grip,    1, NULL, SURFACEMAXFACTOR },
+    { "braking",          7, &SurfaceTable::Surface::braking, 0, NULL, SURFACEMAXFACTOR },
+    { "computerbraking", 15, &SurfaceTable::Surface::braking, 1, NULL, SURFACEMAXFACTOR },
+    { "drag",             4, NULL, 0, &SurfaceTable::Surface::drag,     SURFACEMAXDRAG },
+    { "steering",         8, NULL, 0, &SurfaceTable::Surface::steering, SURFACEMAXSTEERING },
+    { "sound",            5, NULL, 0, NULL, 0 }
+};
+#define NSURFACEFIELDS  (sizeof(surfaceFields) / sizeof(surfaceFields[0]))
+
+
+static Boolean
+isBlank(Char c)
+{
+    return (c == ' ') || (c == '\t');
+}
+
+
+// made on first use, cars made before main have the built-in numbers too
+static SurfaceTable&
+activeSurfaces( )
+{
+    static SurfaceTable table;
+    return table;
+}
+
+
+// the surface a name is, NSURFACES for none
+static UInt
+findSurface(const Char* text, UInt length)
+{
+    for (UInt i = 0; i < NSURFACES; ++i)
+        if ((::strlen(surfaceNames[i]) == length) && (::memcmp(surfaceNames[i], text, length) == 0))
+            return i;
+    return NSURFACES;
+}
+
+
+SurfaceTable::SurfaceTable( )
+{
+    reset( );
+}
+
+
+SurfaceTable::~SurfaceTable( )
+{
+}
+
+
+void
+SurfaceTable::reset( )
+{
+    ::memcpy(m_surfaces, builtinSurfaces, sizeof(m_surfaces));
+    m_nErrors   = 0;
+    m_errorLine = 0;
+    m_error[0]  = '\0';
+}
+
+
+Boolean
+SurfaceTable::read(const Char* filename)
+{
+    reset( );
+    FILE* file = ::fopen(filename, "rb");
+    if (file == NULL)
+    {
+        reportError(filename, 0, "file", "could not be opened");
+        return false;
+    }
+    ::fseek(file, 0, SEEK_END);
+    long size = ::ftell(file);
+    ::fseek(file, 0, SEEK_SET);
+    if ((size < 0) || (size > SURFACEMAXFILESIZE))
+    {
+        ::fclose(file);
+        reportError(filename, 0, "file", "too big to be a surface table");
+        return false;
+    }
+    Char* text = new Char[size + 1];
+    Boolean complete = (::fread(text, 1, size, file) == UInt(size));
+    ::fclose(file);
+    if (complete)
+        parse(text, UInt(size), filename);
+    else
+        reportError(filename, 0, "file", "could not be read");
+    SAFE_DELETE_ARRAY(text);
+    return complete;
+}
+
+
+void
+SurfaceTable::parse(const Char* text, UInt size, const Char* name)
+{
+    reset( );
+    UInt seen[NSURFACES] = { 0 };
+    UInt lineNumber = 1;
+    const Char* end = text + size;
+    while (text < end)
+    {
+        const Char* newline = (const Char*)::memchr(text, '\n', end - text);
+        const Char* lineEnd = newline ? newline : end;
+        UInt length = UInt(lineEnd - text);
+        if ((length > 0) && (text[length - 1] == '\r'))
+            --length;
+        parseLine(text, length, lineNumber, seen, name);
+        text = newline ? newline + 1 : end;
+        ++lineNumber;
+    }
+}
+
+
+const Char*
+SurfaceTable::name(UInt surface)
+{
+    return (surface < NSURFACES) ? surfaceNames[surface] : "";
+}
+
+
+const SurfaceTable&
+SurfaceTable::active( )
+{
+    return activeSurfaces( );
+}
+
+
+// a table that cannot be read leaves the one before
+Boolean
+SurfaceTable::load(const Char* filename)
+{
+    SurfaceTable table;
+    if (!table.read(filename))
+        return false;
+    activeSurfaces( ) = table;
+    RACE("SurfaceTable::load : %s, %u errors", filename, table.nErrors( ));
+    return true;
+}
+
+
+void
+SurfaceTable::parseLine(const Char* line, UInt length, UInt lineNumber, UInt* seen, const Char* name)
+{
+    UInt first = 0;
+    while ((first < length) && isBlank(line[first]))
+        ++first;
+    if ((first == length) || (line[first] == ';'))
+        return;
+    const Char* equals = (const Char*)::memchr(line, '=', length);
+    if (equals == NULL)
+    {
+        reportError(name, lineNumber, "line", "has no '='");
+        return;
+    }
+    UInt keyLength = UInt(equals - line);
+    const Char* value = equals + 1;
+    UInt valueLength = length - keyLength - 1;
+    const Char* dot = (const Char*)::memchr(line, '.', keyLength);
+    UInt surface = dot ? findSurface(line, UInt(dot - line)) : NSURFACES;
+    if (surface == NSURFACES)
+    {
+        reportError(name, lineNumber, "field", "is not on a surface");
+        return;
+    }
+    const Char* key = dot + 1;
+    keyLength -= UInt(key - line);
+
+    Surface& target = m_surfaces[surface];
+    for (UInt i = 0; i < NSURFACEFIELDS; ++i)
+    {
+        const SurfaceField& field = surfaceFields[i];
+        if ((field.length != keyLength) || (::memcmp(field.name, key, keyLength) != 0))
+            continue;
+        if (seen[surface] & (1 << i))
+        {
+            reportError(name, lineNumber, field.name, "named again, the first value counts");
+            return;
+        }
+        seen[surface] |= (1 << i);
+
+        if (field.factor)
+        {
+            const Char* slash = (const Char*)::memchr(value, '/', valueLength);
+            UInt numeratorLength = slash ? UInt(slash - value) : valueLength;
+            Factor factor;
+            factor.denominator = 1;
+            if ((!VehicleDefinition::parseNumber(value, numeratorLength, factor.numerator))
+                || ((slash) && (!VehicleDefinition::parseNumber(slash + 1, valueLength - numeratorLength - 1, factor.denominator))))
+                reportError(name, lineNumber, field.name, "is not a fraction");
+            else if ((factor.numerator < 0) || (factor.numerator > field.maximum)
+                     || (factor.denominator < 1) || (factor.denominator > field.maximum))
+                reportError(name, lineNumber, field.name, "is out of range");
+            else
+                (target.*field.factor)[field.model] = factor;
+            return;
+        }
+        if (field.value)
+        {
+            Int number;
+            if (!VehicleDefinition::parseNumber(value, valueLength, number))
+                reportError(name, lineNumber, field.name, "is not a number");
+            else if ((number < 0) || (number > field.maximum))
+                reportError(name, lineNumber, field.name, "is out of range");
+            else
+                target.*field.value = number;
+            return;
+        }
+
+        while ((valueLength > 0) && isBlank(value[0]))
+            ++value, --valueLength;
+        while ((valueLength > 0) && isBlank(value[valueLength - 1]))
+            --valueLength;
+        UInt sound = findSurface(value, valueLength);
+        if (sound == NSURFACES)
+            reportError(name, lineNumber, field.name, "is not the sound of a surface");
+        else
+            target.sound = builtinSurfaces[sound].sound;
+        return;
+    }
+    reportError(name, lineNumber, "field", "is not one of a surface");
+}
+
+
+void
+SurfaceTable::reportError(const Char* name, UInt lineNumber, const Char* what, const Char* message)
+{
+    RACE("(!) SurfaceTable : %s(%u) : %s %s", name, lineNumber, what, message);
+    if (m_nErrors++ > 0)
+        return;
+    m_errorLine = lineNumber;
+    _snprintf(m_error, sizeof(m_error) - 1, "%s %s", what, message);
+    m_error[sizeof(m_error) - 1] = '\0';
+}
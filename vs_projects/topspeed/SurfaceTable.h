@@ -0,0 +1,98 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_SURFACETABLE_H__
+#define __RACING_SURFACETABLE_H__
+
+#include "Track.h"
+
+// surfaces a track knows, Track::Surface
+#define NSURFACES           5
+// longest description of an error
+#define SURFACEERRORSIZE    128
+// bigger files are not surface tables, they are not read at all
+#define SURFACEMAXFILESIZE  65536
+
+
+/*************************************************************************************
+ *@class SurfaceTable
+ *@description
+ *    How a car handles on each road surface, indexed by Track::Surface: the
+ *    share of its acceleration and deceleration it keeps, per CarPhysics::Model,
+ *    the speed it loses rolling without thrust, how much it steers and the
+ *    sound it makes. The built-in numbers are the ones CarPhysics always had;
+ *    every car, player, computer or network, handles by the same table.
+ *
+ *    A table file holds lines "surface.field=value", the surface by its name
+ *    (asphalt, gravel, water, sand, snow):
+ *
+ *        grip, computergrip          acceleration kept, "3/5" or "1"
+ *        braking, computerbraking    deceleration kept, idem
+ *        drag                        speed lost per second rolling
+ *        steering                    percent of the vehicle's steering
+ *        sound                       the built-in sound of the surface named
+ *
+ *    The fractions are applied as whole numbers are divided, rounding down,
+ *    to get the numbers of before exactly. A field the file leaves out keeps
+ *    its built-in value, the computer's grip and braking included. Errors are
+ *    reported by line the way VehicleDefinition reports them.
+ *
+ *    load replaces the active table, the one CarPhysics works out its numbers
+ *    from when it gets its parameters, so it goes before the first race.
+ *************************************************************************************/
+class SurfaceTable
+{
+public:
+    // Int arithmetic: value*numerator/denominator
+    struct Factor
+    {
+        Int             numerator;
+        Int             denominator;
+    };
+
+    struct Surface
+    {
+        Factor          grip[2];            // per CarPhysics::Model
+        Factor          braking[2];
+        Int             drag;
+        Int             steering;
+        Int             sound;              // resource id
+    };
+
+public:
+    SurfaceTable( );
+    virtual ~SurfaceTable( );
+
+public:
+    void            reset( );
+    Boolean         read(const Char* filename);
+    void            parse(const Char* text, UInt size, const Char* name = "");
+
+    // surfaces outside the table handle like asphalt
+    const Surface&  surface(UInt surface) const     { return m_surfaces[(surface < NSURFACES) ? surface : UInt(Track::asphalt)];  }
+
+    UInt            nErrors( ) const                { return m_nErrors;     }
+    UInt            errorLine( ) const              { return m_errorLine;   }
+    const Char*     error( ) const                  { return m_error;       }
+
+public:
+    static const Char*          name(UInt surface);
+    static const SurfaceTable&  active( );
+    static Boolean              load(const Char* filename);
+
+private:
+    void            parseLine(const Char* line, UInt length, UInt lineNumber, UInt* seen, const Char* name);
+    void            reportError(const Char* name, UInt lineNumber, const Char* what, const Char* message);
+
+private:
+    Surface         m_surfaces[NSURFACES];
+    UInt            m_nErrors;
+    UInt            m_errorLine;
+    Char            m_error[SURFACEERRORSIZE];
+};
+
+
+#endif /* __RACING_SURFACETABLE_H__ */
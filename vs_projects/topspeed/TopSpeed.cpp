@@ -12,6 +12,7 @@
 #include "TopSpeed.h"
 #include "TopSpeedDlg.h"
 #include "Game.h"
+#include "CarPhysics.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -83,9 +84,15 @@ CreateMutex(NULL, FALSE, "TSpeed_3");
 
     File* settings = new File("TopSpeed.cfg", File::read);
     Int enableTracing = 0;
+    Int fixedPointPhysics = 0;
+    Char recordReplay[MAX_PATH] = "";
+    Char soundMixer[MAX_PATH] = "";
     if (settings->opened( ))
     {
         settings->readInt("EnableTracing", enableTracing, 0);
+        settings->readString("RecordReplay", recordReplay, MAX_PATH, "");
+        settings->readString("SoundMixer", soundMixer, MAX_PATH, "");
+        settings->readInt("FixedPointPhysics", fixedPointPhysics, 0);
     }
     else
     {
@@ -109,9 +116,31 @@ CreateMutex(NULL, FALSE, "TSpeed_3");
         dxTracer.bind(_file);
     }
 
+    // races that come out the same on every machine, for replays shared between them
+    if (fixedPointPhysics)
+        CarPhysics::defaultArithmetic(CarPhysics::fixedPoint);
     m_game = new Game( );
+    // the sounds mixed in software, into a wave file or "null", to profile them
+    if (soundMixer[0] != '\0')
+        m_game->soundMixer(soundMixer);
 
     m_game->initialize(m_pMainWnd->GetSafeHwnd());    
+    // every race goes into the file RecordReplay names, TopSpeed <file> plays one again
+    if (recordReplay[0] != '\0')
+        m_game->recordReplays(recordReplay);
+    if ((m_lpCmdLine != NULL) && (m_lpCmdLine[0] != '\0'))
+    {
+        Char replayFile[MAX_PATH];
+        const Char* name = m_lpCmdLine;
+        if (*name == '"')
+            ++name;
+        ::strncpy(replayFile, name, MAX_PATH - 1);
+        replayFile[MAX_PATH - 1] = '\0';
+        Char* quote = ::strchr(replayFile, '"');
+        if (quote != NULL)
+            *quote = '\0';
+        m_game->replay(replayFile);
+    }
     
     m_initialized = true;
     m_pDlg->setGame(m_game);
@@ -5,18 +5,20 @@
 * This program is distributed under the terms of the GNU General Public License version 3.
 */
 #include "Track.h"
+#include "RoadCursor.h"
+#include "TrackStream.h"
+#include "TrackFile.h"
 #include "Game.h"
 #include "resource.h"
-#include "TrackDefs.h"
+#include "TrackRegistry.h"
 
 #define LANEWIDTH 15000
 #define CALLLENGTH 3000
-#define TYPES 9
-#define SURFACES 5
-#define NOISES 12
-#define MINPARTLENGTH 5000
 
 Track::Track() :
+    m_game(NULL),
+    m_laneWidth(LANEWIDTH),
+    m_callLength(CALLLENGTH),
     m_userDefined(false),
     m_weather(sunny),
     m_ambience(noAmbience),
@@ -38,14 +40,25 @@ Track::Track() :
     m_soundOwl(NULL),
     m_lapDistance(0),
     m_lapCenter(0),
+    m_trackFile(NULL),
+    m_bakedIndex(false),
+    m_segmentStart(NULL),
+    m_segmentCenter(NULL),
+    m_segmentBuckets(NULL),
+    m_bucketShift(0),
+    m_cursor(NULL),
+    m_stream(NULL),
     m_currentRoad(0),
     m_relPos(0),
-    m_lastCalled(0),
-    m_factor(0),
-    m_noiseLength(0),
-    m_noiseStartPos(0),
-    m_noiseEndPos(0),
-    m_noisePlaying(false)
+    m_calls(NULL),
+    m_nextCall(0),
+    m_nextCallLap(0),
+    m_callsStarted(false),
+    m_noiseZones(NULL),
+    m_nNoiseZones(0),
+    m_segmentNoiseZone(NULL),
+    m_noiseZone(NONOISEZONE),
+    m_noiseVolume(0)
 {
     RACE("(+) Track");
 }
@@ -77,13 +90,24 @@ Track::Track(Char* trackName, TrackData data, Game* game) :
     m_length(data.length),
     m_lapDistance(0),
     m_lapCenter(0),
+    m_trackFile(NULL),
+    m_bakedIndex(false),
+    m_segmentStart(NULL),
+    m_segmentCenter(NULL),
+    m_segmentBuckets(NULL),
+    m_bucketShift(0),
+    m_cursor(NULL),
+    m_stream(NULL),
     m_currentRoad(0),
-    m_lastCalled(0),
-    m_factor(0),
-    m_noiseLength(0),
-    m_noiseStartPos(0),
-    m_noiseEndPos(0),
-    m_noisePlaying(false)
+    m_calls(NULL),
+    m_nextCall(0),
+    m_nextCallLap(0),
+    m_callsStarted(false),
+    m_noiseZones(NULL),
+    m_nNoiseZones(0),
+    m_segmentNoiseZone(NULL),
+    m_noiseZone(NONOISEZONE),
+    m_noiseVolume(0)
 {
     RACE("(+) Track : building custom track %s, length of track = %d", trackName, data.length);
     if (strlen(trackName) < 64)
@@ -103,27 +127,8 @@ Track::Track(Char* trackName, TrackData data, Game* game) :
 		m_definition[i].length  = data.definition[i].length;
         // RACE("Track : building custom track %s, part %d: type=%d, surface=%d, noise=%d, length=%d", trackName, i+1, data.definition[i].type, data.definition[i].surface, data.definition[i].noise, data.definition[i].length);
     }
-    m_soundCrowd        = m_game->soundManager( )->create(IDR_CROWD);
-    m_soundOcean        = m_game->soundManager( )->create(IDR_OCEAN);
-    if (m_weather == rain)
-        m_soundRain     = m_game->soundManager( )->create(IDR_RAIN);
-    else if (m_weather == wind)
-        m_soundWind     = m_game->soundManager( )->create(IDR_WIND);
-    else if (m_weather == storm)
-        m_soundStorm    = m_game->soundManager( )->create(IDR_STORM);
-    if (m_ambience == desert)
-        m_soundDesert   = m_game->soundManager( )->create(IDR_DESERT);
-    else if (m_ambience == airport)
-        m_soundAirport   = m_game->soundManager( )->create(IDR_AIRPORT);
-    m_soundAirplane     = m_game->soundManager( )->create(IDR_AIRPLANE);
-    m_soundClock        = m_game->soundManager( )->create(IDR_CLOCK);
-    m_soundJet          = m_game->soundManager( )->create(IDR_JET);
-    m_soundThunder      = m_game->soundManager( )->create(IDR_THUNDER);
-    m_soundPile         = m_game->soundManager( )->create(IDR_PILE);
-    m_soundConstruction = m_game->soundManager( )->create(IDR_CONST);
-    m_soundRiver        = m_game->soundManager( )->create(IDR_RIVER);
-    m_soundHelicopter        = m_game->soundManager( )->create(IDR_HELICOPTER);
-    m_soundOwl        = m_game->soundManager( )->create(IDR_OWL);
+    buildIndex( );
+    createSounds( );
 }
 
 Track::Track(Char* filename, Game* game) :
@@ -152,13 +157,24 @@ Track::Track(Char* filename, Game* game) :
     m_soundOwl(NULL),
     m_lapDistance(0),
     m_lapCenter(0),
+    m_trackFile(NULL),
+    m_bakedIndex(false),
+    m_segmentStart(NULL),
+    m_segmentCenter(NULL),
+    m_segmentBuckets(NULL),
+    m_bucketShift(0),
+    m_cursor(NULL),
+    m_stream(NULL),
     m_currentRoad(0),
-    m_lastCalled(0),
-    m_factor(0),
-    m_noiseLength(0),
-    m_noiseStartPos(0),
-    m_noiseEndPos(0),
-    m_noisePlaying(false)
+    m_calls(NULL),
+    m_nextCall(0),
+    m_nextCallLap(0),
+    m_callsStarted(false),
+    m_noiseZones(NULL),
+    m_nNoiseZones(0),
+    m_segmentNoiseZone(NULL),
+    m_noiseZone(NONOISEZONE),
+    m_noiseVolume(0)
 {
     RACE("(+) Track : filename = %s", filename);
     if (strlen(filename) < 64)
@@ -169,435 +185,132 @@ Track::Track(Char* filename, Game* game) :
     {
         strcpy(m_trackName, "");
     }
-    if (strcmp(filename, "america") == 0)
-    {
-        m_definition = _trAmerica;
-        m_length     = sizeof(_trAmerica)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "austria") == 0)
-    {
-        m_definition = _trAustria;
-        m_length     = sizeof(_trAustria)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "belgium") == 0)
-    {
-        m_definition = _trBelgium;
-        m_length     = sizeof(_trBelgium)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "brazil") == 0)
-    {
-        m_definition = _trBrazil;
-        m_length     = sizeof(_trBrazil)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "china") == 0)
-    {
-        m_definition = _trChina;
-        m_length     = sizeof(_trChina)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "england") == 0)
-    {
-        m_definition = _trEngland;
-        m_length     = sizeof(_trEngland)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "finland") == 0)
-    {
-        m_definition = _trFinland;
-        m_length     = sizeof(_trFinland)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "france") == 0)
-    {
-        m_definition = _trFrance;
-        m_length     = sizeof(_trFrance)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "germany") == 0)
-    {
-        m_definition = _trGermany;
-        m_length     = sizeof(_trGermany)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "ireland") == 0)
-    {
-        m_definition = _trIreland;
-        m_length     = sizeof(_trIreland)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "italy") == 0)
-    {
-        m_definition = _trItaly;
-        m_length     = sizeof(_trItaly)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "netherlands") == 0)
-    {
-        m_definition = _trNetherlands;
-        m_length     = sizeof(_trNetherlands)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "portugal") == 0)
-    {
-        m_definition = _trPortugal;
-        m_length     = sizeof(_trPortugal)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "russia") == 0)
-    {
-        m_definition = _trRussia;
-        m_length     = sizeof(_trRussia)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "spain") == 0)
-    {
-        m_definition = _trSpain;
-        m_length     = sizeof(_trSpain)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "sweden") == 0)
-    {
-        m_definition = _trSweden;
-        m_length     = sizeof(_trSweden)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "switserland") == 0)
-    {
-        m_definition = _trSwitserland;
-        m_length     = sizeof(_trSwitserland)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "advHills") == 0)
-    {
-        m_definition = _trAdvHills;
-        m_length     = sizeof(_trAdvHills)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "advCoast") == 0)
-    {
-        m_definition = _trAdvCoast;
-        m_length     = sizeof(_trAdvCoast)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "advCountry") == 0)
-    {
-        m_definition = _trAdvCountry;
-        m_length     = sizeof(_trAdvCountry)/sizeof(Definition);
-        m_weather = rain;
-    }
-    else if (strcmp(filename, "advAirport") == 0)
-    {
-        m_definition = _trAirport;
-        m_length     = sizeof(_trAirport)/sizeof(Definition);
-        m_ambience = airport;
-    }
-    else if (strcmp(filename, "advDesert") == 0)
-    {
-        m_definition = _trDesert;
-        m_length     = sizeof(_trDesert)/sizeof(Definition);
-        m_ambience = desert;
-    }
-    else if (strcmp(filename, "advRush") == 0)
-    {
-        m_definition = _trAdvRush;
-        m_length     = sizeof(_trAdvRush)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "advEscape") == 0)
-    {
-        m_definition = _trAdvEscape;
-        m_length     = sizeof(_trAdvEscape)/sizeof(Definition);
-        m_weather = wind;
-    }
-    else
+    if (!readBuiltin(filename))
     {
         m_userDefined = true;
-        File file(filename, File::read);
-        // Find out the length
-        m_length = 0;
-        while (file.readInt( ) >= 0)
-        {
-            file.readInt( );
-            if (file.readInt( ) < MINPARTLENGTH)
-                file.readInt( );
-            ++m_length;
-        }
-        file.rewind( );
-        RACE("Track : reading trackfile, length of track = %d", m_length);
-        if (m_length == 0)
-        {
-            m_length = 1;
-            m_definition = new Definition[1];
-            m_definition[0].type = (Type)0;
-            m_definition[0].surface = (Surface)0;
-            m_definition[0].noise = (Noise)0;
-            m_definition[0].length = MINPARTLENGTH;
-            m_weather  = (Weather)0;
-            m_ambience = (Ambience)0;
-        }
-        else
-        {
-            m_definition = new Definition[m_length];
-            Int temp = 0;
-            for (UInt i = 0; i < m_length; ++i)
-            {
-                m_definition[i].type    = (Type)file.readInt( );
-                m_definition[i].surface = (Surface)file.readInt( );
-                temp = file.readInt( );
-                if (temp < NOISES)
-                {
-                    m_definition[i].noise   = (Noise)temp;
-                    m_definition[i].length  = file.readInt( );
-                }
-                else
-                {
-                    if (m_definition[i].type >= TYPES)
-                    {
-                        m_definition[i].noise = (Noise)((m_definition[i].type - TYPES) + 1);
-                        m_definition[i].type = (Type)0;
-                    }
-                    else
-                    {
-                        m_definition[i].noise = (Noise)0;
-                    }
-                    m_definition[i].length = temp;
-                }
-                if (m_definition[i].type >= TYPES)
-                    m_definition[i].type = (Type)0;
-                if (m_definition[i].surface >= SURFACES)
-                    m_definition[i].surface = (Surface)0;
-                if (m_definition[i].noise >= NOISES)
-                    m_definition[i].noise = (Noise)0;
-                if (m_definition[i].length < MINPARTLENGTH)
-                    m_definition[i].length = MINPARTLENGTH;
-            }
-            file.readInt( ); // -1
-            m_weather  = (Weather)file.readInt( );
-            if (m_weather < 0)
-                m_weather = (Weather)0;
-            m_ambience = (Ambience)file.readInt( );
-            if (m_ambience < 0)
-                m_ambience = (Ambience)0;
-        }
-        RACE("Track : done reading trackfile");
+        readCustom(filename);
     }
-    m_soundCrowd        = m_game->soundManager( )->create(IDR_CROWD);
-    m_soundOcean        = m_game->soundManager( )->create(IDR_OCEAN);
-    if (m_weather == rain)
-        m_soundRain     = m_game->soundManager( )->create(IDR_RAIN);
-    else if (m_weather == wind)
-        m_soundWind     = m_game->soundManager( )->create(IDR_WIND);
-    else if (m_weather == storm)
-        m_soundStorm    = m_game->soundManager( )->create(IDR_STORM);
-    if (m_ambience == desert)
-        m_soundDesert   = m_game->soundManager( )->create(IDR_DESERT);
-    else if (m_ambience == airport)
-        m_soundAirport   = m_game->soundManager( )->create(IDR_AIRPORT);
-    m_soundAirplane     = m_game->soundManager( )->create(IDR_AIRPLANE);
-    m_soundClock        = m_game->soundManager( )->create(IDR_CLOCK);
-    m_soundJet          = m_game->soundManager( )->create(IDR_JET);
-    m_soundThunder      = m_game->soundManager( )->create(IDR_THUNDER);
-    m_soundPile         = m_game->soundManager( )->create(IDR_PILE);
-    m_soundConstruction = m_game->soundManager( )->create(IDR_CONST);
-    m_soundRiver        = m_game->soundManager( )->create(IDR_RIVER);
-    m_soundHelicopter        = m_game->soundManager( )->create(IDR_HELICOPTER);
-    m_soundOwl        = m_game->soundManager( )->create(IDR_OWL);
+    buildIndex( );
+    createSounds( );
+}
+
+Track::Track(UInt seed, Game* game) :
+    m_game(game),
+    m_laneWidth(LANEWIDTH),
+    m_callLength(CALLLENGTH),
+    m_relPos(0),
+    m_userDefined(false),
+    m_weather(sunny),
+    m_ambience(noAmbience),
+    m_soundCrowd(NULL),
+    m_soundOcean(NULL),
+    m_soundRain(NULL),
+    m_soundWind(NULL),
+    m_soundStorm(NULL),
+    m_soundDesert(NULL),
+    m_soundAirport(NULL),
+    m_soundAirplane(NULL),
+    m_soundClock(NULL),
+    m_soundJet(NULL),
+    m_soundThunder(NULL),
+    m_soundPile(NULL),
+    m_soundConstruction(NULL),
+    m_soundRiver(NULL),
+    m_soundHelicopter(NULL),
+    m_soundOwl(NULL),
+    m_length(0),
+    m_lapDistance(0),
+    m_lapCenter(0),
+    m_definition(NULL),
+    m_trackFile(NULL),
+    m_bakedIndex(false),
+    m_segmentStart(NULL),
+    m_segmentCenter(NULL),
+    m_segmentBuckets(NULL),
+    m_bucketShift(0),
+    m_cursor(NULL),
+    m_stream(NULL),
+    m_currentRoad(0),
+    m_calls(NULL),
+    m_nextCall(0),
+    m_nextCallLap(0),
+    m_callsStarted(false),
+    m_noiseZones(NULL),
+    m_nNoiseZones(0),
+    m_segmentNoiseZone(NULL),
+    m_noiseZone(NONOISEZONE),
+    m_noiseVolume(0)
+{
+    RACE("(+) Track : endless track, seed = %u", seed);
+    _snprintf(m_trackName, sizeof(m_trackName) - 1, "endless %u", seed);
+    m_trackName[sizeof(m_trackName) - 1] = '\0';
+    m_stream = new TrackStream(seed);
+    createSounds( );
 }
 
 Track* 
 Track::readTrack(Char* filename)
 {
     Track* result = new Track();
-    if (strcmp(filename, "america") == 0)
-    {
-        result->m_definition = _trAmerica;
-        result->m_length     = sizeof(_trAmerica)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "austria") == 0)
-    {
-        result->m_definition = _trAustria;
-        result->m_length     = sizeof(_trAustria)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "belgium") == 0)
-    {
-        result->m_definition = _trBelgium;
-        result->m_length     = sizeof(_trBelgium)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "brazil") == 0)
-    {
-        result->m_definition = _trBrazil;
-        result->m_length     = sizeof(_trBrazil)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "china") == 0)
-    {
-        result->m_definition = _trChina;
-        result->m_length     = sizeof(_trChina)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "england") == 0)
-    {
-        result->m_definition = _trEngland;
-        result->m_length     = sizeof(_trEngland)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "finland") == 0)
-    {
-        result->m_definition = _trFinland;
-        result->m_length     = sizeof(_trFinland)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "france") == 0)
-    {
-        result->m_definition = _trFrance;
-        result->m_length     = sizeof(_trFrance)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "germany") == 0)
-    {
-        result->m_definition = _trGermany;
-        result->m_length     = sizeof(_trGermany)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "ireland") == 0)
-    {
-        result->m_definition = _trIreland;
-        result->m_length     = sizeof(_trIreland)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "italy") == 0)
-    {
-        result->m_definition = _trItaly;
-        result->m_length     = sizeof(_trItaly)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "netherlands") == 0)
-    {
-        result->m_definition = _trNetherlands;
-        result->m_length     = sizeof(_trNetherlands)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "portugal") == 0)
-    {
-        result->m_definition = _trPortugal;
-        result->m_length     = sizeof(_trPortugal)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "russia") == 0)
-    {
-        result->m_definition = _trRussia;
-        result->m_length     = sizeof(_trRussia)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "spain") == 0)
-    {
-        result->m_definition = _trSpain;
-        result->m_length     = sizeof(_trSpain)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "sweden") == 0)
-    {
-        result->m_definition = _trSweden;
-        result->m_length     = sizeof(_trSweden)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "switserland") == 0)
-    {
-        result->m_definition = _trSwitserland;
-        result->m_length     = sizeof(_trSwitserland)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "advHills") == 0)
-    {
-        result->m_definition = _trAdvHills;
-        result->m_length     = sizeof(_trAdvHills)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "advCoast") == 0)
-    {
-        result->m_definition = _trAdvCoast;
-        result->m_length     = sizeof(_trAdvCoast)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "advCountry") == 0)
-    {
-        result->m_definition = _trAdvCountry;
-        result->m_length     = sizeof(_trAdvCountry)/sizeof(Definition);
-        result->m_weather = rain;
-    }
-    else if (strcmp(filename, "advAirport") == 0)
-    {
-        result->m_definition = _trAirport;
-        result->m_length     = sizeof(_trAirport)/sizeof(Definition);
-        result->m_ambience = airport;
-    }
-    else if (strcmp(filename, "advDesert") == 0)
-    {
-        result->m_definition = _trDesert;
-        result->m_length     = sizeof(_trDesert)/sizeof(Definition);
-        result->m_ambience = desert;
-    }
-    else if (strcmp(filename, "advRush") == 0)
-    {
-        result->m_definition = _trAdvRush;
-        result->m_length     = sizeof(_trAdvRush)/sizeof(Definition);
-    }
-    else if (strcmp(filename, "advEscape") == 0)
-    {
-        result->m_definition = _trAdvEscape;
-        result->m_length     = sizeof(_trAdvEscape)/sizeof(Definition);
-        result->m_weather = wind;
-    }
-    else
+    if (!result->readBuiltin(filename))
     {
         result->m_userDefined = true;
-        File file(filename, File::read);
-        // Find out the length
-        result->m_length = 0;
-        while (file.readInt( ) >= 0)
-        {
-            file.readInt( );
-            if (file.readInt( ) < MINPARTLENGTH)
-                file.readInt( );
-            ++result->m_length;
-        }
-        file.rewind( );
-        RACE("Track : reading trackfile, length of track = %d", result->m_length);
-        if (result->m_length == 0)
-        {
-            result->m_length = 1;
-            result->m_definition = new Definition[1];
-            result->m_definition[0].type = (Type)0;
-            result->m_definition[0].surface = (Surface)0;
-            result->m_definition[0].noise = (Noise)0;
-            result->m_definition[0].length = MINPARTLENGTH;
-            result->m_weather  = (Weather)0;
-            result->m_ambience = (Ambience)0;
-        }
-        else
-        {
-            result->m_definition = new Definition[result->m_length];
-            Int temp = 0;
-            for (UInt i = 0; i < result->m_length; ++i)
-            {
-                result->m_definition[i].type    = (Type)file.readInt( );
-                result->m_definition[i].surface = (Surface)file.readInt( );
-                temp = file.readInt( );
-                if (temp < NOISES)
-                {
-                    result->m_definition[i].noise   = (Noise)temp;
-                    result->m_definition[i].length  = file.readInt( );
-                }
-                else
-                {
-                    if (result->m_definition[i].type >= TYPES)
-                    {
-                        result->m_definition[i].noise = (Noise)((result->m_definition[i].type - TYPES) + 1);
-                        result->m_definition[i].type = (Type)0;
-                    }
-                    else
-                    {
-                        result->m_definition[i].noise = (Noise)0;
-                    }
-                    result->m_definition[i].length = temp;
-                }
-                if (result->m_definition[i].type >= TYPES)
-                    result->m_definition[i].type = (Type)0;
-                if (result->m_definition[i].surface >= SURFACES)
-                    result->m_definition[i].surface = (Surface)0;
-                if (result->m_definition[i].noise >= NOISES)
-                    result->m_definition[i].noise = (Noise)0;
-                if (result->m_definition[i].length < MINPARTLENGTH)
-                    result->m_definition[i].length = MINPARTLENGTH;
-            }
-            file.readInt( ); // -1
-            result->m_weather = (Weather)file.readInt( );
-            if (result->m_weather < 0)
-                result->m_weather = (Weather)0;
-            result->m_ambience = (Ambience)file.readInt( );
-            if (result->m_ambience < 0)
-                result->m_ambience = (Ambience)0;
-        }
-        RACE("Track : done reading trackfile");
+        result->readCustom(filename);
     }
+    result->buildIndex( );
+    return result;
+}
+
+Track*
+Track::fromData(TrackData data)
+{
+    Track* result = new Track();
+    result->m_userDefined = true;
+    result->m_weather  = data.weather;
+    result->m_ambience = data.ambience;
+    result->m_length   = data.length;
+    result->m_definition = new Definition[data.length];
+    for (UInt i = 0; i < data.length; ++i)
+        result->m_definition[i] = data.definition[i];
+    result->buildIndex( );
+    return result;
+}
+
+Track*
+Track::fromSeed(UInt seed)
+{
+    Track* result = new Track();
+    result->m_length     = 0;
+    result->m_definition = NULL;
+    result->m_stream     = new TrackStream(seed);
+    _snprintf(result->m_trackName, sizeof(result->m_trackName) - 1, "endless %u", seed);
+    result->m_trackName[sizeof(result->m_trackName) - 1] = '\0';
     return result;
 }
 
 Track::~Track( )
 {
     RACE("(-) Track");
-    if (m_userDefined)
+    if (m_trackFile != NULL)
     {
-        SAFE_DELETE_ARRAY(m_definition);
+        // definition and index live in the mapped file
+        SAFE_DELETE(m_trackFile);
     }
+    else if (!m_bakedIndex)
+    {
+        if (m_userDefined)
+        {
+            SAFE_DELETE_ARRAY(m_definition);
+        }
+        SAFE_DELETE_ARRAY(m_segmentStart);
+        SAFE_DELETE_ARRAY(m_segmentCenter);
+    }
+    SAFE_DELETE_ARRAY(m_segmentBuckets);
+    SAFE_DELETE_ARRAY(m_calls);
+    SAFE_DELETE_ARRAY(m_noiseZones);
+    SAFE_DELETE_ARRAY(m_segmentNoiseZone);
+    SAFE_DELETE(m_cursor);
+    SAFE_DELETE(m_stream);
     if (m_weather == rain)
 	{
         SAFE_DELETE(m_soundRain);
@@ -632,46 +345,18 @@ Track::~Track( )
 }
 
 
+void
+Track::advance(Int last, Int first)
+{
+    if (m_stream != NULL)
+        m_stream->advance(last, first);
+}
+
+
 void
 Track::initialize( )
 {
     RACE("Track::initialize");
-    // calculate tracklength
-    for (UInt i = 0; i < m_length; ++i)
-    {
-        m_lapDistance += m_definition[i].length;
-        switch (m_definition[i].type)
-        {
-        case straight :
-            break;
-        case easyLeft :
-            m_lapCenter -= m_definition[i].length/2; 
-            break;
-        case left :
-            m_lapCenter -= m_definition[i].length*2/3;
-            break;
-        case hardLeft :
-            m_lapCenter -= m_definition[i].length;
-            break;
-        case hairpinLeft :
-            m_lapCenter -= m_definition[i].length*3/2;
-            break;
-        case easyRight :
-            m_lapCenter += m_definition[i].length/2;
-            break;
-        case right :
-            m_lapCenter += m_definition[i].length*2/3;
-            break;
-        case hardRight :
-            m_lapCenter += m_definition[i].length;
-            break;
-        case hairpinRight :
-            m_lapCenter += m_definition[i].length*3/2;
-            break;
-        default :
-            break;
-        }
-    }
     if (m_weather == rain)
         m_soundRain->play(0, true);
     else if (m_weather == wind)
@@ -702,265 +387,84 @@ Track::finalize( )
 }
 
 
-void 
-Track::run(/* Float elapsed, */ Int position)
-{
-    if ((m_noisePlaying == true) && (position > m_noiseEndPos))
-        m_noisePlaying = false;
-    switch (m_definition[m_currentRoad].noise)
-    {
-    case crowd:
-        if (!m_noisePlaying)
-        {
-            calculateNoiseLength( );
-            m_noiseStartPos = position;
-            m_noiseEndPos = position + m_noiseLength;
-        }
-        m_factor = (position - m_noiseStartPos) * 1.0f / m_noiseLength;
-        if (m_factor < 0.5f)
-            m_factor *= 2.0f;
-        else
-            m_factor = 2.0f * (1.0f - m_factor);
-        m_soundCrowd->volume((Int)(80.0f + m_factor * 20.0f));
-        if (!(m_soundCrowd->playing( )))
-        {
-            m_soundCrowd->play(0, true);
-        }   
-        break;
-    case ocean:
-        if (!m_noisePlaying)
-        {
-            calculateNoiseLength( );
-            m_noiseStartPos = position;
-            m_noiseEndPos = position + m_noiseLength;
-        }
-        m_factor = (position - m_noiseStartPos) * 1.0f / m_noiseLength;
-        if (m_factor < 0.5f)
-            m_factor *= 2.0f;
-        else
-            m_factor = 2.0f * (1.0f - m_factor);
-        m_soundOcean->volume((Int)(80.0f + m_factor * 20.0f));
-        if (!(m_soundOcean->playing( )))
-        {
-            m_soundOcean->pan(-10);
-            m_soundOcean->play(0, true);
-        }   
-        break;
-    case runway:
-        if (!(m_soundAirplane->playing( )))
-        {
-            m_soundAirplane->play( );
-        }
-        break;
-    case clock:
-        if (!m_noisePlaying)
-        {
-            calculateNoiseLength( );
-            m_noiseStartPos = position;
-            m_noiseEndPos = position + m_noiseLength;
-        }
-        m_factor = (position - m_noiseStartPos) * 1.0f / m_noiseLength;
-        if (m_factor < 0.5f)
-            m_factor *= 2.0f;
-        else
-            m_factor = 2.0f * (1.0f - m_factor);
-        m_soundClock->volume((Int)(80.0f + m_factor * 20.0f));
-        if (!(m_soundClock->playing( )))
-        {
-            m_soundClock->pan(25);
-            m_soundClock->play(0, true);
-        }   
-        break;
-    case jet:
-        if (!(m_soundJet->playing( )))
-        {
-            m_soundJet->play( );
-        }
-        break;
-    case thunder:
-        if (!(m_soundThunder->playing( )))
-        {
-            m_soundThunder->play( );
-        }
-        break;
-    case pile:
-        if (!m_noisePlaying)
-        {
-            calculateNoiseLength( );
-            m_noiseStartPos = position;
-            m_noiseEndPos = position + m_noiseLength;
-        }
-        m_factor = (position - m_noiseStartPos) * 1.0f / m_noiseLength;
-        if (m_factor < 0.5f)
-            m_factor *= 2.0f;
-        else
-            m_factor = 2.0f * (1.0f - m_factor);
-        m_soundPile->volume((Int)(80.0f + m_factor * 20.0f));
-        if (!(m_soundPile->playing( )))
-        {
-            m_soundPile->play(0, true);
-        }   
-        break;
-    case construction:
-        if (!m_noisePlaying)
-        {
-            calculateNoiseLength( );
-            m_noiseStartPos = position;
-            m_noiseEndPos = position + m_noiseLength;
-        }
-        m_factor = (position - m_noiseStartPos) * 1.0f / m_noiseLength;
-        if (m_factor < 0.5f)
-            m_factor *= 2.0f;
-        else
-            m_factor = 2.0f * (1.0f - m_factor);
-        m_soundConstruction->volume((Int)(80.0f + m_factor * 20.0f));
-        if (!(m_soundConstruction->playing( )))
-        {
-            m_soundConstruction->play(0, true);
-        }   
-        break;
-    case river:
-        if (!m_noisePlaying)
-        {
-            calculateNoiseLength( );
-            m_noiseStartPos = position;
-            m_noiseEndPos = position + m_noiseLength;
-        }
-        m_factor = (position - m_noiseStartPos) * 1.0f / m_noiseLength;
-        if (m_factor < 0.5f)
-            m_factor *= 2.0f;
-        else
-            m_factor = 2.0f * (1.0f - m_factor);
-        m_soundRiver->volume((Int)(80.0f + m_factor * 20.0f));
-        if (!(m_soundRiver->playing( )))
-        {
-            m_soundRiver->play(0, true);
-        }   
-        break;
-    case helicopter:
-        if (!(m_soundHelicopter->playing( )))
-        {
-            m_soundHelicopter->play( );
-        }
-        break;
-    case owl:
-        if (!(m_soundOwl->playing( )))
-        {
-            m_soundOwl->play( );
-        }
-        break;
-    default:
-        m_soundCrowd->stop( );
-        m_soundOcean->stop( );
-        m_soundClock->stop( );
-        m_soundPile->stop( );
-        m_soundConstruction->stop( );
-        m_soundRiver->stop( );
-        break;
-    }
-}
-
-
+void 
+Track::run(/* Float elapsed, */ Int position)
+{
+    // sounds only start and stop when the player crosses into another zone
+    Int zone = noiseZoneAt(position);
+    Boolean looped;
+    if (zone != m_noiseZone)
+    {
+        if (m_noiseZone != NONOISEZONE)
+        {
+            DirectX::Sound* sound = noiseSound(m_zone.noise, looped);
+            if (looped)
+                sound->stop( );
+        }
+        if (zone != NONOISEZONE)
+        {
+            // a copy, an endless track may release the zone while its noise still plays
+            m_zone = (m_stream != NULL) ? m_stream->noiseZone(zone) : m_noiseZones[zone];
+            Noise noise = m_zone.noise;
+            DirectX::Sound* sound = noiseSound(noise, looped);
+            if (looped)
+            {
+                if (noise == ocean)
+                    sound->pan(-10);
+                else if (noise == clock)
+                    sound->pan(25);
+                sound->play(0, true);
+            }
+            else
+                sound->play( );
+        }
+        m_noiseZone   = zone;
+        m_noiseVolume = -1;
+    }
+    if (zone == NONOISEZONE)
+        return;
+
+    // looping noises swell towards the middle of their zone
+    const NoiseZone& current = m_zone;
+    DirectX::Sound* sound = noiseSound(current.noise, looped);
+    if ((!looped) || (current.length == 0))
+        return;
+    UInt offset;
+    if (m_stream != NULL)
+        offset = UInt(position) - current.start;
+    else
+        offset = ((position % m_lapDistance) + m_lapDistance - current.start) % m_lapDistance;
+    Float factor = offset * 1.0f / current.length;
+    if (factor < 0.5f)
+        factor *= 2.0f;
+    else
+        factor = 2.0f * (1.0f - factor);
+    Int volume = (Int)(80.0f + factor * 20.0f);
+    if (volume != m_noiseVolume)
+    {
+        sound->volume(volume);
+        m_noiseVolume = volume;
+    }
+}
+
+
 Track::Road
 Track::road(Int position)
 {
-    UInt lap = (UInt)(position / m_lapDistance);
-    UInt pos = position % m_lapDistance;
-    UInt dist = 0;
-    UInt center = lap*m_lapCenter;
-    for (UInt i = 0; i < m_length; ++i)
-    {
-        if ((dist <= pos) && (dist + m_definition[i].length > pos))
-        {
-            m_prevRelPos = m_relPos;
-            m_relPos = pos - dist;
-            m_currentRoad = i;
-            Road road;
-            road.type    = m_definition[i].type;
-            road.surface = m_definition[i].surface;
-                        road.length  = m_definition[i].length;
-            switch (m_definition[i].type)
-            {
-            case straight :
-                road.left  = center - m_laneWidth;
-                road.right = center + m_laneWidth;
-                break;
-            case easyLeft :
-                road.left  = center - m_laneWidth - m_relPos/2;
-                road.right = center + m_laneWidth - m_relPos/2;
-                break;
-            case left :
-                road.left  = center - m_laneWidth - m_relPos*2/3;
-                road.right = center + m_laneWidth - m_relPos*2/3;
-                break;
-            case hardLeft :
-                road.left  = center - m_laneWidth - m_relPos;
-                road.right = center + m_laneWidth - m_relPos;
-                break;
-            case hairpinLeft :
-                road.left  = center - m_laneWidth - m_relPos*3/2;
-                road.right = center + m_laneWidth - m_relPos*3/2;
-                break;
-            case easyRight :
-                road.left  = center - m_laneWidth + m_relPos/2;
-                road.right = center + m_laneWidth + m_relPos/2;
-                break;
-            case right :
-                road.left  = center - m_laneWidth + m_relPos*2/3;
-                road.right = center + m_laneWidth + m_relPos*2/3;
-                break;
-            case hardRight :
-                road.left  = center - m_laneWidth + m_relPos;
-                road.right = center + m_laneWidth + m_relPos;
-                break;
-            case hairpinRight :
-                road.left  = center - m_laneWidth + m_relPos*3/2;
-                road.right = center + m_laneWidth + m_relPos*3/2;
-                break;
-            default :
-                road.left  = center - m_laneWidth;
-                road.right = center + m_laneWidth;
-                break;
-            }
-            
-            return road;
-        }
-        switch (m_definition[i].type)
-        {
-        case straight :
-            break;
-        case easyLeft :
-            center -= m_definition[i].length/2; 
-            break;
-        case left :
-            center -= m_definition[i].length*2/3;
-            break;
-        case hardLeft :
-            center -= m_definition[i].length;
-            break;
-        case hairpinLeft :
-            center -= m_definition[i].length*3/2;
-            break;
-        case easyRight :
-            center += m_definition[i].length/2;
-            break;
-        case right :
-            center += m_definition[i].length*2/3;
-            break;
-        case hardRight :
-            center += m_definition[i].length;
-            break;
-        case hairpinRight :
-            center += m_definition[i].length*3/2;
-            break;
-        default :
-            break;
-        }
-        
-        dist += m_definition[i].length;
-    }
-    // shouldn't arrive here
-    Road road = {0, 0, asphalt, straight, 5000};
+    if (m_stream != NULL)
+    {
+        UInt segment  = m_stream->locate(position);
+        m_prevRelPos  = m_relPos;
+        m_relPos      = UInt(position) - m_stream->segmentStart(segment);
+        m_currentRoad = segment;
+        return segmentRoad(m_stream->definition(segment), m_stream->segmentCenter(segment), m_relPos);
+    }
+    if (m_length == 0)
+        return segmentRoad(0, 0, 0);
+    Road road = m_cursor->road(position);
+    m_prevRelPos = m_relPos;
+    m_relPos = m_cursor->relPos( );
+    m_currentRoad = m_cursor->segment( );
     return road;
 }
 
@@ -968,103 +472,17 @@ Track::road(Int position)
 Track::Road
 Track::roadComputer(Int position)
 {
-    UInt lap = (UInt)(position / m_lapDistance);
-    UInt pos = position % m_lapDistance;
-    UInt dist = 0;
-    UInt center = lap*m_lapCenter;
-    Int relPos = 0;
-    for (UInt i = 0; i < m_length; ++i)
+    if (m_stream != NULL)
     {
-        if ((dist <= pos) && (dist + m_definition[i].length > pos))
-        {
-            relPos = pos - dist;
-            Road road;
-            road.type    = m_definition[i].type;
-            road.surface = m_definition[i].surface;
-            road.length  = m_definition[i].length;
-            switch (m_definition[i].type)
-            {
-            case straight :
-                road.left  = center - m_laneWidth;
-                road.right = center + m_laneWidth;
-                break;
-            case easyLeft :
-                road.left  = center - m_laneWidth - relPos/2;
-                road.right = center + m_laneWidth - relPos/2;
-                break;
-            case left :
-                road.left  = center - m_laneWidth - relPos*2/3;
-                road.right = center + m_laneWidth - relPos*2/3;
-                break;
-            case hardLeft :
-                road.left  = center - m_laneWidth - relPos;
-                road.right = center + m_laneWidth - relPos;
-                break;
-            case hairpinLeft :
-                road.left  = center - m_laneWidth - relPos*3/2;
-                road.right = center + m_laneWidth - relPos*3/2;
-                break;
-            case easyRight :
-                road.left  = center - m_laneWidth + relPos/2;
-                road.right = center + m_laneWidth + relPos/2;
-                break;
-            case right :
-                road.left  = center - m_laneWidth + relPos*2/3;
-                road.right = center + m_laneWidth + relPos*2/3;
-                break;
-            case hardRight :
-                road.left  = center - m_laneWidth + relPos;
-                road.right = center + m_laneWidth + relPos;
-                break;
-            case hairpinRight :
-                road.left  = center - m_laneWidth + relPos*3/2;
-                road.right = center + m_laneWidth + relPos*3/2;
-                break;
-            default :
-                road.left  = center - m_laneWidth;
-                road.right = center + m_laneWidth;
-                break;
-            }
-            
-            return road;
-        }
-        switch (m_definition[i].type)
-        {
-        case straight :
-            break;
-        case easyLeft :
-            center -= m_definition[i].length/2; 
-            break;
-        case left :
-            center -= m_definition[i].length*2/3;
-            break;
-        case hardLeft :
-            center -= m_definition[i].length;
-            break;
-        case hairpinLeft :
-            center -= m_definition[i].length*3/2;
-            break;
-        case easyRight :
-            center += m_definition[i].length/2;
-            break;
-        case right :
-            center += m_definition[i].length*2/3;
-            break;
-        case hardRight :
-            center += m_definition[i].length;
-            break;
-        case hairpinRight :
-            center += m_definition[i].length*3/2;
-            break;
-        default :
-            break;
-        }
-        
-        dist += m_definition[i].length;
+        UInt i = m_stream->segmentAt(position);
+        return segmentRoad(m_stream->definition(i), m_stream->segmentCenter(i), UInt(position) - m_stream->segmentStart(i));
     }
-    // shouldn't arrive here
-    Road road = {0, 0, asphalt, straight, 5000};
-    return road;
+    if (m_length == 0)
+        return segmentRoad(0, 0, 0);
+    UInt lap = (UInt)(position / m_lapDistance);
+    UInt pos = position % m_lapDistance;
+    UInt i = segmentAt(pos);
+    return segmentRoad(i, lap*m_lapCenter + m_segmentCenter[i], pos - m_segmentStart[i]);
 }
 
 
@@ -1073,15 +491,16 @@ Track::nextRoad(Road& road, Int position, Int speed)
 {
     if (m_game->raceSettings().curveAnnouncement == 0)
     {
-        Int currentLength = m_definition[m_currentRoad].length;
+        Int currentLength = (m_stream != NULL) ? m_stream->definition(m_currentRoad).length : m_definition[m_currentRoad].length;
         // if (currentLength > m_callLength)
         // {
             if ((m_relPos + m_callLength > (UInt)currentLength) &&
                 (m_prevRelPos + m_callLength <= (UInt)currentLength))
             {
-                road.type = m_definition[(m_currentRoad + 1)%m_length].type;        
-                road.surface = m_definition[(m_currentRoad + 1)%m_length].surface;
-                road.length = m_definition[(m_currentRoad + 1)%m_length].length;
+                Definition next = (m_stream != NULL) ? m_stream->definition(m_currentRoad + 1) : m_definition[(m_currentRoad + 1)%m_length];
+                road.type = next.type;
+                road.surface = next.surface;
+                road.length = next.length;
                 return true;
             }
         // }
@@ -1089,50 +508,431 @@ Track::nextRoad(Road& road, Int position, Int speed)
         return false;
     }
     else
+        return nextCall(road, position, speed);
+}
+
+
+Boolean
+Track::nextCall(Road& road, Int position, Int speed)
+{
+    if (m_stream != NULL)
+    {
+        // the same schedule on a single lap that never ends
+        if (!m_callsStarted)
+        {
+            m_nextCall     = m_stream->segmentAt(position) + 1;
+            m_callsStarted = true;
+        }
+        while (m_stream->segmentStart(m_nextCall + 1) <= UInt(position))
+            ++m_nextCall;
+        if (Huge(m_stream->segmentStart(m_nextCall)) > Huge(position) + m_callLength + speed/2)
+            return false;
+        const Definition& next = m_stream->definition(m_nextCall);
+        road.type    = next.type;
+        road.surface = next.surface;
+        road.length  = next.length;
+        ++m_nextCall;
+        return true;
+    }
+    if (m_length == 0)
+        return false;
+    if (!m_callsStarted)
     {
-        // determine the distance to look ahead
-        Int lookAhead = m_callLength + speed/2;
-        Int roadAhead = roadAt(position + lookAhead);
-        if ((((roadAhead - m_lastCalled + m_length) % m_length) > 0) && 
-            (((roadAhead - m_lastCalled + m_length) % m_length) <= m_length/2))
+        // the segment the player starts on is not announced, the next one is
+        m_nextCallLap  = (UInt)(position / m_lapDistance);
+        m_nextCall     = segmentAt(position % m_lapDistance) + 1;
+        if (m_nextCall == m_length)
         {
-            road.type       = m_definition[roadAhead].type;
-            road.surface    = m_definition[roadAhead].surface;
-            road.length     = m_definition[roadAhead].length;
-            m_lastCalled = roadAhead;
-            return true;
+            m_nextCall = 0;
+            ++m_nextCallLap;
         }
+        m_callsStarted = true;
+    }
+    // a segment the player already left is not worth announcing any more
+    while (Huge(m_nextCallLap)*m_lapDistance + m_calls[m_nextCall].position + m_calls[m_nextCall].length <= Huge(position))
+    {
+        if (++m_nextCall == m_length)
+        {
+            m_nextCall = 0;
+            ++m_nextCallLap;
+        }
+    }
+    // the window ahead grows with the speed; every segment it reaches is
+    // announced once, in order, one per frame when several come at once
+    Int lookAhead = m_callLength + speed/2;
+    const Call& call = m_calls[m_nextCall];
+    if (Huge(m_nextCallLap)*m_lapDistance + call.position > Huge(position) + lookAhead)
         return false;
+    road.type    = call.type;
+    road.surface = call.surface;
+    road.length  = call.length;
+    if (++m_nextCall == m_length)
+    {
+        m_nextCall = 0;
+        ++m_nextCallLap;
     }
+    return true;
 }
 
 
 Int
 Track::roadAt(Int position)
 {
-    UInt pos = position % m_lapDistance;
-    UInt dist = 0;
-    for (UInt i = 0; i < m_length; ++i)
+    if (m_stream != NULL)
+        return m_stream->segmentAt(position);
+    if (m_length == 0)
+        return 0;
+    return segmentAt(position % m_lapDistance);
+}
+
+
+Int
+Track::noiseZoneAt(Int position)
+{
+    if (m_stream != NULL)
+    {
+        UInt segment = m_stream->locate(position);
+        return (m_stream->definition(segment).noise != noNoise) ? Int(segment) : NONOISEZONE;
+    }
+    if (m_length == 0)
+        return NONOISEZONE;
+    return m_segmentNoiseZone[m_cursor->segmentAt(position)];
+}
+
+
+void
+Track::createSounds( )
+{
+    m_soundCrowd        = m_game->soundManager( )->create(IDR_CROWD);
+    m_soundOcean        = m_game->soundManager( )->create(IDR_OCEAN);
+    if (m_weather == rain)
+        m_soundRain     = m_game->soundManager( )->create(IDR_RAIN);
+    else if (m_weather == wind)
+        m_soundWind     = m_game->soundManager( )->create(IDR_WIND);
+    else if (m_weather == storm)
+        m_soundStorm    = m_game->soundManager( )->create(IDR_STORM);
+    if (m_ambience == desert)
+        m_soundDesert   = m_game->soundManager( )->create(IDR_DESERT);
+    else if (m_ambience == airport)
+        m_soundAirport   = m_game->soundManager( )->create(IDR_AIRPORT);
+    m_soundAirplane     = m_game->soundManager( )->create(IDR_AIRPLANE);
+    m_soundClock        = m_game->soundManager( )->create(IDR_CLOCK);
+    m_soundJet          = m_game->soundManager( )->create(IDR_JET);
+    m_soundThunder      = m_game->soundManager( )->create(IDR_THUNDER);
+    m_soundPile         = m_game->soundManager( )->create(IDR_PILE);
+    m_soundConstruction = m_game->soundManager( )->create(IDR_CONST);
+    m_soundRiver        = m_game->soundManager( )->create(IDR_RIVER);
+    m_soundHelicopter        = m_game->soundManager( )->create(IDR_HELICOPTER);
+    m_soundOwl        = m_game->soundManager( )->create(IDR_OWL);
+}
+
+
+DirectX::Sound*
+Track::noiseSound(Noise noise, Boolean& looped)
+{
+    looped = true;
+    switch (noise)
+    {
+    case crowd :
+        return m_soundCrowd;
+    case ocean :
+        return m_soundOcean;
+    case clock :
+        return m_soundClock;
+    case pile :
+        return m_soundPile;
+    case construction :
+        return m_soundConstruction;
+    case river :
+        return m_soundRiver;
+    default :
+        break;
+    }
+    looped = false;
+    switch (noise)
+    {
+    case runway :
+        return m_soundAirplane;
+    case jet :
+        return m_soundJet;
+    case thunder :
+        return m_soundThunder;
+    case helicopter :
+        return m_soundHelicopter;
+    case owl :
+        return m_soundOwl;
+    default :
+        return NULL;
+    }
+}
+
+
+// Offset of the road center 'distance' units into a segment of the given type.
+// Left curves give a negative offset, wrapped in an UInt just like the center itself.
+UInt
+Track::curveOffset(Type type, UInt distance)
+{
+    switch (type)
+    {
+    case Track::easyLeft :
+        return 0 - distance/2;
+    case Track::left :
+        return 0 - distance*2/3;
+    case Track::hardLeft :
+        return 0 - distance;
+    case Track::hairpinLeft :
+        return 0 - distance*3/2;
+    case Track::easyRight :
+        return distance/2;
+    case Track::right :
+        return distance*2/3;
+    case Track::hardRight :
+        return distance;
+    case Track::hairpinRight :
+        return distance*3/2;
+    default :
+        return 0;
+    }
+}
+
+
+void
+Track::readCustom(Char* filename)
+{
+    Char binaryName[MAX_PATH];
+    TrackFile::binaryName(filename, binaryName, sizeof(binaryName));
+    if (TrackFile::upToDate(filename, binaryName))
     {
-        if ((dist <= pos) && (dist + m_definition[i].length > pos))
+        m_trackFile = new TrackFile( );
+        if (m_trackFile->open(binaryName))
+        {
+            m_definition = m_trackFile->definition( );
+            m_length     = m_trackFile->trackLength( );
+            m_weather    = m_trackFile->weather( );
+            m_ambience   = m_trackFile->ambience( );
+            return;
+        }
+        SAFE_DELETE(m_trackFile);
+    }
+    TrackFile::readText(filename, m_definition, m_length, m_weather, m_ambience);
+}
+
+
+Boolean
+Track::readBuiltin(Char* filename)
+{
+    const TrackRegistry::Entry* builtin = TrackRegistry::find(filename);
+    if (builtin == NULL)
+        return false;
+    m_definition    = builtin->definition;
+    m_length        = builtin->length;
+    m_weather       = builtin->weather;
+    m_ambience      = builtin->ambience;
+    m_segmentStart  = builtin->segmentStart;
+    m_segmentCenter = builtin->segmentCenter;
+    m_lapDistance   = builtin->lapDistance;
+    m_lapCenter     = builtin->lapCenter;
+    m_bakedIndex    = true;
+    return true;
+}
+
+
+void
+Track::buildIndex( )
+{
+    if (m_trackFile != NULL)
+    {
+        m_segmentStart  = m_trackFile->segmentStart( );
+        m_segmentCenter = m_trackFile->segmentCenter( );
+        m_lapDistance   = m_trackFile->lapDistance( );
+        m_lapCenter     = m_trackFile->lapCenter( );
+    }
+    else if (!m_bakedIndex)
+    {
+        SAFE_DELETE_ARRAY(m_segmentStart);
+        SAFE_DELETE_ARRAY(m_segmentCenter);
+        m_segmentStart  = new UInt[m_length + 1];
+        m_segmentCenter = new UInt[m_length + 1];
+        UInt dist   = 0;
+        UInt center = 0;
+        for (UInt i = 0; i < m_length; ++i)
         {
-            return i;
+            m_segmentStart[i]  = dist;
+            m_segmentCenter[i] = center;
+            dist   += m_definition[i].length;
+            center += curveOffset(m_definition[i].type, m_definition[i].length);
         }
-        dist += m_definition[i].length;
+        m_segmentStart[m_length]  = dist;
+        m_segmentCenter[m_length] = center;
+        m_lapDistance = dist;
+        m_lapCenter   = center;
+    }
+    buildBuckets( );
+    buildCalls( );
+    buildNoiseZones( );
+    if (m_cursor == NULL)
+        m_cursor = new RoadCursor(this);
+    m_cursor->reset( );
+}
+
+
+void
+Track::buildBuckets( )
+{
+    // about four stretches per segment, so a position is a step or two away
+    // from the segment its stretch starts in
+    SAFE_DELETE_ARRAY(m_segmentBuckets);
+    m_bucketShift = 0;
+    while ((m_lapDistance >> m_bucketShift) > 4*m_length)
+        ++m_bucketShift;
+    UInt nBuckets = (m_lapDistance >> m_bucketShift) + 1;
+    m_segmentBuckets = new UInt[nBuckets];
+    UInt segment = 0;
+    for (UInt i = 0; i < nBuckets; ++i)
+    {
+        while ((segment + 1 < m_length) && (m_segmentStart[segment + 1] <= (i << m_bucketShift)))
+            ++segment;
+        m_segmentBuckets[i] = segment;
     }
-    return -1;
 }
 
+
 void
-Track::calculateNoiseLength( )
+Track::buildCalls( )
+{
+    SAFE_DELETE_ARRAY(m_calls);
+    m_calls = new Call[m_length];
+    for (UInt i = 0; i < m_length; ++i)
+    {
+        m_calls[i].position = m_segmentStart[i];
+        m_calls[i].type     = m_definition[i].type;
+        m_calls[i].surface  = m_definition[i].surface;
+        m_calls[i].length   = m_definition[i].length;
+    }
+    m_callsStarted = false;
+}
+
+
+void
+Track::buildNoiseZones( )
+{
+    SAFE_DELETE_ARRAY(m_noiseZones);
+    SAFE_DELETE_ARRAY(m_segmentNoiseZone);
+    m_noiseZones       = new NoiseZone[m_length];
+    m_segmentNoiseZone = new Int[m_length];
+    m_nNoiseZones      = 0;
+    m_noiseZone        = NONOISEZONE;
+    if (m_length == 0)
+        return;
+
+    // a zone crossing the finish line starts in the last segments of the lap,
+    // so the segments at the start of the lap are left for it
+    UInt first = 0;
+    if ((m_definition[0].noise != noNoise) && (m_definition[m_length - 1].noise == m_definition[0].noise))
+    {
+        while ((first < m_length) && (m_definition[first].noise == m_definition[0].noise))
+            ++first;
+        if (first == m_length)
+            first = 0;
+    }
+    UInt n = 0;
+    while (n < m_length)
+    {
+        UInt i = (first + n) % m_length;
+        Noise noise = m_definition[i].noise;
+        if (noise == noNoise)
+        {
+            m_segmentNoiseZone[i] = NONOISEZONE;
+            ++n;
+            continue;
+        }
+        NoiseZone& zone = m_noiseZones[m_nNoiseZones];
+        zone.start  = m_segmentStart[i];
+        zone.length = 0;
+        zone.noise  = noise;
+        while ((n < m_length) && (m_definition[(first + n) % m_length].noise == noise))
+        {
+            i = (first + n) % m_length;
+            zone.length += m_definition[i].length;
+            m_segmentNoiseZone[i] = m_nNoiseZones;
+            ++n;
+        }
+        ++m_nNoiseZones;
+    }
+}
+
+
+UInt
+Track::segmentAt(UInt pos)
 {
-    m_noiseLength = 0;
-    UInt i = m_currentRoad;
-    while ((i < m_length) && (m_definition[i].noise == m_definition[m_currentRoad].noise))
+    // last segment starting at or before pos
+    if (m_length == 0)
+        return 0;
+    UInt low  = 0;
+    UInt high = m_length;
+    while (high - low > 1)
+    {
+        UInt mid = (low + high) / 2;
+        if (m_segmentStart[mid] <= pos)
+            low = mid;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+
+Track::Road
+Track::segmentRoad(UInt segment, UInt center, UInt relPos)
+{
+    // a track without segments has the road the linear search fell back to
+    if (m_length == 0)
+    {
+        Road road = {0, 0, asphalt, straight, 5000};
+        return road;
+    }
+    return segmentRoad(m_definition[segment], center, relPos);
+}
+
+
+Track::Road
+Track::segmentRoad(const Definition& definition, UInt center, UInt relPos)
+{
+    Road road;
+    road.type    = definition.type;
+    road.surface = definition.surface;
+    road.length  = definition.length;
+    center      += curveOffset(road.type, relPos);
+    road.left    = center - m_laneWidth;
+    road.right   = center + m_laneWidth;
+    return road;
+}
+
+
+void
+Track::roadBatch(const Int* positions, Road* out, UInt n)
+{
+    // the bucket of a position is usually its own segment or a step before it,
+    // so no search; the division per car is all that is left of roadComputer
+    if (m_stream != NULL)
+    {
+        for (UInt i = 0; i < n; ++i)
+            out[i] = roadComputer(positions[i]);
+        return;
+    }
+    if (m_length == 0)
+    {
+        for (UInt i = 0; i < n; ++i)
+            out[i] = segmentRoad(0, 0, 0);
+        return;
+    }
+    for (UInt i = 0; i < n; ++i)
     {
-        m_noiseLength += m_definition[i].length;
-        ++i;
+        UInt lap = (UInt)(positions[i] / m_lapDistance);
+        UInt pos = positions[i] % m_lapDistance;
+        UInt s = m_segmentBuckets[pos >> m_bucketShift];
+        while (m_segmentStart[s + 1] <= pos)
+            ++s;
+        out[i] = segmentRoad(s, lap*m_lapCenter + m_segmentCenter[s], pos - m_segmentStart[s]);
     }
-    m_noisePlaying = true;
-//RACE("calculate... 1: i = %d, m_noiseLength = %d", i, m_noiseLength);
 }
@@ -11,6 +11,12 @@
 #include "DxCommon\If\Common.h" 
 
 class Game;
+class RoadCursor;
+class TrackFile;
+class TrackStream;
+
+// the noise zone of a position where there is none
+#define NONOISEZONE     (-1)
 
 class Track
 {
@@ -85,6 +91,21 @@ public:
         UInt            length;
     };
 
+    struct Call
+    {
+        UInt            position;       // start of the segment in the lap
+        Type            type;
+        Surface         surface;
+        UInt            length;
+    };
+
+    struct NoiseZone
+    {
+        UInt            start;          // position in the lap
+        UInt            length;         // may reach past the finish line into the next lap
+        Noise           noise;
+    };
+
     struct TrackData
     {
         Boolean userDefined;
@@ -97,6 +118,7 @@ public:
 public:
     Track(Char* trackName, TrackData data, Game* game);
     Track(Char* filename, Game* game);
+    Track(UInt seed, Game* game);
     virtual ~Track( );
 
 private:
@@ -113,19 +135,45 @@ public:
     Weather     weather( ) { return m_weather; }
     Ambience    ambience( ) { return m_ambience; }
     Boolean     userDefined( ) { return m_userDefined; }
+    Boolean     endless( )                 { return m_stream != NULL; }
+    TrackStream* stream( )                 { return m_stream;      }
+    void        advance(Int last, Int first);
     void        run(/* Float elapsed, */ Int position);
     Road        road(Int position);
     Road        roadComputer(Int position);
+    void        roadBatch(const Int* positions, Road* out, UInt n);
     Boolean     nextRoad(Road& road, Int position, Int speed);
+    Boolean     nextCall(Road& road, Int position, Int speed);
     Int         roadAt(Int position);
-    void        calculateNoiseLength( );
-    UInt        lap(Int position)          { return (position/m_lapDistance) + 1; }
+    Int         noiseZoneAt(Int position);
+    UInt        nNoiseZones( )             { return m_nNoiseZones; }
+    const NoiseZone& noiseZone(UInt i)     { return m_noiseZones[i]; }
+    UInt        lap(Int position)          { return (m_stream != NULL) ? 1 : (position/m_lapDistance) + 1; }
     // Int         number( )                  { return m_number;      }
     Char*       trackName( )               { return m_trackName;   }
     UInt        length( )                  { return m_lapDistance; }
+    UInt        lapCenter( )               { return m_lapCenter;   }
+    UInt        segmentStart(UInt i)       { return m_segmentStart[i];  }
+    UInt        segmentCenter(UInt i)      { return m_segmentCenter[i]; }
+    UInt        segmentAt(UInt pos);
+    Road        segmentRoad(UInt segment, UInt center, UInt relPos);
+    Road        segmentRoad(const Definition& definition, UInt center, UInt relPos);
 
 public:
     static Track* readTrack(Char* filename);
+    static Track* fromData(TrackData data);
+    static Track* fromSeed(UInt seed);
+    static UInt   curveOffset(Type type, UInt distance);
+
+private:
+    Boolean     readBuiltin(Char* filename);
+    void        readCustom(Char* filename);
+    void        buildIndex( );
+    void        buildBuckets( );
+    void        buildCalls( );
+    void        buildNoiseZones( );
+    void        createSounds( );
+    DirectX::Sound* noiseSound(Noise noise, Boolean& looped);
 
 private:
     Game*               m_game;
@@ -135,17 +183,29 @@ private:
     UInt                m_lapDistance;
     UInt                m_lapCenter;
     Definition*         m_definition;
+    TrackFile*          m_trackFile;        // mapped .trkb file providing definition and index, if any
+    Boolean             m_bakedIndex;       // definition and index come from the TrackRegistry
+    UInt*               m_segmentStart;     // m_length+1 entries, start position of each segment in a lap
+    UInt*               m_segmentCenter;    // m_length+1 entries, lateral center when entering each segment
+    UInt*               m_segmentBuckets;   // segment at the start of every stretch of 1 << m_bucketShift of the lap
+    UInt                m_bucketShift;
+    RoadCursor*         m_cursor;
+    TrackStream*        m_stream;           // the road of an endless track, which has no definition, index or laps
     UInt                m_relPos;
     UInt                m_currentRoad;
     UInt                m_prevRelPos;
     UInt                m_laneWidth;
     UInt                m_callLength;
-    Int                 m_lastCalled;
-    Float               m_factor;
-    UInt                m_noiseLength;
-    Int                 m_noiseStartPos;
-    Int                 m_noiseEndPos;
-    Boolean             m_noisePlaying;
+    Call*               m_calls;            // m_length entries, the announcement of each segment
+    UInt                m_nextCall;         // segment to announce next
+    UInt                m_nextCallLap;
+    Boolean             m_callsStarted;
+    NoiseZone*          m_noiseZones;       // sorted by start, only the last one may cross the finish line
+    UInt                m_nNoiseZones;
+    Int*                m_segmentNoiseZone; // m_length entries, the zone of each segment or NONOISEZONE
+    Int                 m_noiseZone;        // the zone at the last run, a segment on an endless track
+    NoiseZone           m_zone;             // copy of that zone
+    Int                 m_noiseVolume;      // volume last given to the looping noise of that zone
     DirectX::Sound*     m_soundCrowd;
     DirectX::Sound*     m_soundOcean;
     DirectX::Sound*     m_soundRain;
@@ -0,0 +1,235 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "TrackCache.h"
+#include "TrackRegistry.h"
+#include "Game.h"
+#include <stdio.h>
+
+static const Char trackCacheMagic[4] = { 'T', 'S', 'T', 'C' };
+
+
+// 64 bit FNV-1a over the bytes of value, lowest first
+static void
+mix(UHuge& hash, UInt value, UInt nBytes)
+{
+    for (UInt i = 0; i < nBytes; ++i)
+    {
+        hash ^= UByte(value >> (8*i));
+        hash *= 1099511628211ULL;
+    }
+}
+
+
+static void
+readSegment(const MultiplayerDefinition& segment, Track::Definition& definition)
+{
+    definition.type    = (Track::Type)segment.type;
+    definition.surface = (Track::Surface)segment.surface;
+    definition.noise   = (Track::Noise)segment.noise;
+    definition.length  = segment.length;
+}
+
+
+static void
+writeSegment(const Track::Definition& definition, MultiplayerDefinition& segment)
+{
+    segment.type    = (UByte)definition.type;
+    segment.surface = (UByte)definition.surface;
+    segment.noise   = (UByte)definition.noise;
+    segment.length  = definition.length;
+}
+
+
+TrackCache::TrackCache(const Char* directory)
+{
+    _snprintf(m_directory, sizeof(m_directory) - 1, "%s", directory);
+    m_directory[sizeof(m_directory) - 1] = '\0';
+}
+
+
+TrackCache::~TrackCache( )
+{
+}
+
+
+Boolean
+TrackCache::find(UHuge hash, Track::TrackData& data)
+{
+    // the built-in tracks are never written to the cache, every game has them
+    for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+    {
+        const TrackRegistry::Entry& entry = TrackRegistry::entry(i);
+        Track::TrackData builtin;
+        builtin.userDefined = false;
+        builtin.weather     = entry.weather;
+        builtin.ambience    = entry.ambience;
+        builtin.length      = entry.length;
+        builtin.definition  = entry.definition;
+        if (TrackCache::hash(builtin) != hash)
+            continue;
+        RACE("TrackCache::find : %016llx is %s", hash, entry.name);
+        SAFE_DELETE_ARRAY(data.definition);
+        data = builtin;
+        data.definition = new Track::Definition[builtin.length];
+        for (UInt j = 0; j < builtin.length; ++j)
+            data.definition[j] = entry.definition[j];
+        return true;
+    }
+
+    Char filename[MAX_PATH];
+    fileName(hash, filename, sizeof(filename));
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL)
+        return false;
+    Header header;
+    Boolean result = (fread(&header, sizeof(header), 1, file) == 1) &&
+                     (memcmp(header.magic, trackCacheMagic, sizeof(trackCacheMagic)) == 0) &&
+                     (header.version == TRACKCACHE_VERSION) && (header.hash == hash) &&
+                     (header.length > 0) && (header.length <= MAXMULTITRACKLENGTH);
+    Track::TrackData cached;
+    cached.definition = NULL;
+    if (result)
+    {
+        MultiplayerDefinition* segments = new MultiplayerDefinition[header.length];
+        result = (fread(segments, sizeof(MultiplayerDefinition), header.length, file) == header.length);
+        cached.userDefined = true;
+        cached.weather     = (Track::Weather)header.weather;
+        cached.ambience    = (Track::Ambience)header.ambience;
+        cached.length      = header.length;
+        cached.definition  = new Track::Definition[header.length];
+        for (UInt i = 0; i < header.length; ++i)
+            readSegment(segments[i], cached.definition[i]);
+        SAFE_DELETE_ARRAY(segments);
+    }
+    fclose(file);
+    if ((result) && (TrackCache::hash(cached) != hash))
+        result = false;
+    if (!result)
+    {
+        RACE("(!) TrackCache::find : %s is damaged", filename);
+        SAFE_DELETE_ARRAY(cached.definition);
+        return false;
+    }
+    SAFE_DELETE_ARRAY(data.definition);
+    data = cached;
+    return true;
+}
+
+
+Boolean
+TrackCache::store(UHuge hash, const Track::TrackData& data)
+{
+    if ((data.length == 0) || (data.length > MAXMULTITRACKLENGTH))
+        return false;
+    ::CreateDirectory(m_directory, NULL);
+    Header header;
+    memcpy(header.magic, trackCacheMagic, sizeof(trackCacheMagic));
+    header.version  = TRACKCACHE_VERSION;
+    header.hash     = hash;
+    header.length   = data.length;
+    header.weather  = data.weather;
+    header.ambience = data.ambience;
+    MultiplayerDefinition* segments = new MultiplayerDefinition[data.length];
+    for (UInt i = 0; i < data.length; ++i)
+        writeSegment(data.definition[i], segments[i]);
+
+    Char filename[MAX_PATH];
+    fileName(hash, filename, sizeof(filename));
+    Boolean result = false;
+    FILE* file = fopen(filename, "wb");
+    if (file != NULL)
+    {
+        result = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+                 (fwrite(segments, sizeof(MultiplayerDefinition), data.length, file) == data.length);
+        fclose(file);
+    }
+    if (!result)
+        RACE("(!) TrackCache::store : could not write %s", filename);
+    SAFE_DELETE_ARRAY(segments);
+    return result;
+}
+
+
+void
+TrackCache::clear( )
+{
+    Char pattern[MAX_PATH];
+    _snprintf(pattern, sizeof(pattern) - 1, "%s\\*.trkc", m_directory);
+    pattern[sizeof(pattern) - 1] = '\0';
+    WIN32_FIND_DATA findFileData;
+    HANDLE findHandle = ::FindFirstFile(pattern, &findFileData);
+    if (findHandle == INVALID_HANDLE_VALUE)
+        return;
+    do
+    {
+        Char filename[MAX_PATH];
+        _snprintf(filename, sizeof(filename) - 1, "%s\\%s", m_directory, findFileData.cFileName);
+        filename[sizeof(filename) - 1] = '\0';
+        ::DeleteFile(filename);
+    }
+    while (::FindNextFile(findHandle, &findFileData));
+    ::FindClose(findHandle);
+}
+
+
+void
+TrackCache::fileName(UHuge hash, Char* result, UInt size)
+{
+    _snprintf(result, size, "%s\\%016llx.trkc", m_directory, hash);
+    result[size - 1] = '\0';
+}
+
+
+UHuge
+TrackCache::hash(const Track::TrackData& data)
+{
+    // everything that goes over the wire, in the sizes it goes in
+    UInt length = (data.length < MAXMULTITRACKLENGTH) ? data.length : MAXMULTITRACKLENGTH;
+    UHuge hash = 14695981039346656037ULL;
+    mix(hash, length, sizeof(UShort));
+    mix(hash, data.weather, sizeof(UByte));
+    mix(hash, data.ambience, sizeof(UByte));
+    for (UInt i = 0; i < length; ++i)
+    {
+        mix(hash, data.definition[i].type, sizeof(UByte));
+        mix(hash, data.definition[i].surface, sizeof(UByte));
+        mix(hash, data.definition[i].noise, sizeof(UByte));
+        mix(hash, data.definition[i].length, sizeof(UInt));
+    }
+    return hash;
+}
+
+
+UInt
+TrackCache::writePacket(const Track::TrackData& data, PacketLoadCustomTrack& packet)
+{
+    UInt length = (data.length < MAXMULTITRACKLENGTH) ? data.length : MAXMULTITRACKLENGTH;
+    packet.trackWeather  = (UByte)data.weather;
+    packet.trackAmbience = (UByte)data.ambience;
+    packet.trackLength   = (UShort)length;
+    for (UInt i = 0; i < length; ++i)
+        writeSegment(data.definition[i], packet.trackDefinition[i]);
+    return sizeof(PacketLoadTrack) + sizeof(MultiplayerDefinition)*length;
+}
+
+
+Boolean
+TrackCache::readPacket(const PacketLoadCustomTrack* packet, UInt size, Track::TrackData& data)
+{
+    if ((size < sizeof(PacketLoadTrack)) || (packet->trackLength == 0) || (packet->trackLength > MAXMULTITRACKLENGTH) ||
+        (size < sizeof(PacketLoadTrack) + sizeof(MultiplayerDefinition)*packet->trackLength))
+        return false;
+    SAFE_DELETE_ARRAY(data.definition);
+    data.userDefined = true;
+    data.weather     = (Track::Weather)packet->trackWeather;
+    data.ambience    = (Track::Ambience)packet->trackAmbience;
+    data.length      = packet->trackLength;
+    data.definition  = new Track::Definition[packet->trackLength];
+    for (UInt i = 0; i < packet->trackLength; ++i)
+        readSegment(packet->trackDefinition[i], data.definition[i]);
+    return true;
+}
@@ -0,0 +1,61 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_TRACKCACHE_H__
+#define __RACING_TRACKCACHE_H__
+
+#include "Packets.h"
+
+#define TRACKCACHEDIR       "Tracks\\Cache"
+#define TRACKCACHE_VERSION  1
+
+
+/*************************************************************************************
+ *@class TrackCache
+ *@description
+ *    The tracks a client received from race servers, kept on disk by the hash of
+ *    their content: the weather, the ambience and every segment the way
+ *    PacketLoadCustomTrack carries it. A server offers a track by its hash and
+ *    only sends the whole track to clients that find neither a built-in track
+ *    nor a cached one with that hash.
+ *
+ *    A cached track is a Header followed by the MultiplayerDefinition array. The
+ *    hash is checked again when reading, so a damaged file is a miss.
+ *************************************************************************************/
+class TrackCache
+{
+public:
+    struct Header
+    {
+        Char            magic[4];
+        UInt            version;
+        UHuge           hash;
+        UInt            length;
+        UInt            weather;
+        UInt            ambience;
+    };
+
+public:
+    TrackCache(const Char* directory = TRACKCACHEDIR);
+    virtual ~TrackCache( );
+
+public:
+    Boolean             find(UHuge hash, Track::TrackData& data);
+    Boolean             store(UHuge hash, const Track::TrackData& data);
+    void                clear( );
+    void                fileName(UHuge hash, Char* result, UInt size);
+
+public:
+    static UHuge        hash(const Track::TrackData& data);
+    static UInt         writePacket(const Track::TrackData& data, PacketLoadCustomTrack& packet);
+    static Boolean      readPacket(const PacketLoadCustomTrack* packet, UInt size, Track::TrackData& data);
+
+private:
+    Char                m_directory[MAX_PATH];
+};
+
+
+#endif /* __RACING_TRACKCACHE_H__ */
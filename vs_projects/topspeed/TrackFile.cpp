@@ -0,0 +1,316 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "TrackFile.h"
+#include "Game.h"
+
+#define TYPES 9
+#define SURFACES 5
+#define NOISES 12
+
+// The definition array of a .trkb file is used in place, so it has to match the file layout
+typedef Char definitionLayoutCheck[(sizeof(Track::Definition) == 4*sizeof(UInt)) ? 1 : -1];
+
+static const Char trackFileMagic[4] = {'T', 'R', 'K', 'B'};
+
+
+TrackFile::TrackFile( ) :
+    m_file(INVALID_HANDLE_VALUE),
+    m_mapping(NULL),
+    m_view(NULL),
+    m_header(NULL),
+    m_definition(NULL),
+    m_segmentStart(NULL),
+    m_segmentCenter(NULL)
+{
+    RACE("(+) TrackFile");
+}
+
+
+TrackFile::~TrackFile( )
+{
+    RACE("(-) TrackFile");
+    close( );
+}
+
+
+Boolean
+TrackFile::open(const Char* filename)
+{
+    close( );
+    m_file = ::CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+    UInt size = ::GetFileSize(m_file, NULL);
+    if ((size == INVALID_FILE_SIZE) || (size < sizeof(Header)))
+    {
+        RACE("(!) TrackFile::open : %s is too small", filename);
+        close( );
+        return false;
+    }
+    m_mapping = ::CreateFileMapping(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_mapping != NULL)
+        m_view = (UByte*)::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (m_view == NULL)
+    {
+        RACE("(!) TrackFile::open : could not map %s, error 0x%x", filename, ::GetLastError( ));
+        close( );
+        return false;
+    }
+    m_header = (Header*)m_view;
+    UInt length = m_header->length;
+    if ((memcmp(m_header->magic, trackFileMagic, sizeof(trackFileMagic)) != 0) ||
+        (m_header->version != TRACKFILE_VERSION) || (length == 0) || (length > (size - sizeof(Header))/sizeof(Track::Definition)) ||
+        (size != sizeof(Header) + length*sizeof(Track::Definition) + 2*(length + 1)*sizeof(UInt)))
+    {
+        RACE("(!) TrackFile::open : %s is not a version %d track file", filename, TRACKFILE_VERSION);
+        close( );
+        return false;
+    }
+    if (checksum(m_view + sizeof(Header), size - sizeof(Header)) != m_header->checksum)
+    {
+        RACE("(!) TrackFile::open : checksum mismatch in %s", filename);
+        close( );
+        return false;
+    }
+    m_definition    = (Track::Definition*)(m_view + sizeof(Header));
+    m_segmentStart  = (UInt*)(m_definition + length);
+    m_segmentCenter = m_segmentStart + length + 1;
+    if (!valid( ))
+    {
+        RACE("(!) TrackFile::open : %s holds a track the text format cannot", filename);
+        close( );
+        return false;
+    }
+    RACE("TrackFile::open : mapped %s, length of track = %d", filename, length);
+    return true;
+}
+
+
+// The checksum only tells the file was written whole; what it holds is
+// used without further checks, so it has to be a track readText could
+// give, with the index Track would build for it
+Boolean
+TrackFile::valid( ) const
+{
+    UInt length = m_header->length;
+    UInt dist   = 0;
+    UInt center = 0;
+    for (UInt i = 0; i < length; ++i)
+    {
+        const Track::Definition& segment = m_definition[i];
+        if ((UInt(segment.type) >= TYPES) || (UInt(segment.surface) >= SURFACES) ||
+            (UInt(segment.noise) >= NOISES) || (segment.length < MINPARTLENGTH) ||
+            (segment.length > ~dist))
+            return false;
+        if ((m_segmentStart[i] != dist) || (m_segmentCenter[i] != center))
+            return false;
+        dist   += segment.length;
+        center += Track::curveOffset(segment.type, segment.length);
+    }
+    return (m_segmentStart[length] == dist) && (m_segmentCenter[length] == center) &&
+           (m_header->lapDistance == dist) && (m_header->lapCenter == center) && (dist != 0);
+}
+
+
+void
+TrackFile::close( )
+{
+    if (m_view != NULL)
+        ::UnmapViewOfFile(m_view);
+    if (m_mapping != NULL)
+        ::CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        ::CloseHandle(m_file);
+    m_file          = INVALID_HANDLE_VALUE;
+    m_mapping       = NULL;
+    m_view          = NULL;
+    m_header        = NULL;
+    m_definition    = NULL;
+    m_segmentStart  = NULL;
+    m_segmentCenter = NULL;
+}
+
+
+Boolean
+TrackFile::readText(const Char* filename, Track::Definition*& definition, UInt& length,
+                    Track::Weather& weather, Track::Ambience& ambience)
+{
+    File file(filename, File::read);
+    // Find out the length
+    length = 0;
+    if (file.opened( ))
+    {
+        while (file.readInt( ) >= 0)
+        {
+            file.readInt( );
+            if (file.readInt( ) < MINPARTLENGTH)
+                file.readInt( );
+            ++length;
+        }
+        file.rewind( );
+    }
+    RACE("TrackFile : reading trackfile, length of track = %d", length);
+    if (length == 0)
+    {
+        length = 1;
+        definition = new Track::Definition[1];
+        definition[0].type    = (Track::Type)0;
+        definition[0].surface = (Track::Surface)0;
+        definition[0].noise   = (Track::Noise)0;
+        definition[0].length  = MINPARTLENGTH;
+        weather  = (Track::Weather)0;
+        ambience = (Track::Ambience)0;
+        return false;
+    }
+    definition = new Track::Definition[length];
+    Int temp = 0;
+    for (UInt i = 0; i < length; ++i)
+    {
+        definition[i].type    = (Track::Type)file.readInt( );
+        definition[i].surface = (Track::Surface)file.readInt( );
+        temp = file.readInt( );
+        if (temp < NOISES)
+        {
+            definition[i].noise   = (Track::Noise)temp;
+            definition[i].length  = file.readInt( );
+        }
+        else
+        {
+            // old format: no noise field, noises are encoded as extra types
+            if (definition[i].type >= TYPES)
+            {
+                definition[i].noise = (Track::Noise)((definition[i].type - TYPES) + 1);
+                definition[i].type = (Track::Type)0;
+            }
+            else
+            {
+                definition[i].noise = (Track::Noise)0;
+            }
+            definition[i].length = temp;
+        }
+        if (definition[i].type >= TYPES)
+            definition[i].type = (Track::Type)0;
+        if (definition[i].surface >= SURFACES)
+            definition[i].surface = (Track::Surface)0;
+        if (definition[i].noise >= NOISES)
+            definition[i].noise = (Track::Noise)0;
+        if (definition[i].length < MINPARTLENGTH)
+            definition[i].length = MINPARTLENGTH;
+    }
+    file.readInt( ); // -1
+    weather  = (Track::Weather)file.readInt( );
+    if (weather < 0)
+        weather = (Track::Weather)0;
+    ambience = (Track::Ambience)file.readInt( );
+    if (ambience < 0)
+        ambience = (Track::Ambience)0;
+    RACE("TrackFile : done reading trackfile");
+    return true;
+}
+
+
+Boolean
+TrackFile::writeText(const Char* filename, Track::Definition* definition, UInt length,
+                     Track::Weather weather, Track::Ambience ambience)
+{
+    // Segments are always written with an explicit noise field, which the
+    // reader tells apart from the old format because noise < MINPARTLENGTH.
+    FILE* file = fopen(filename, "w");
+    if (file == NULL)
+    {
+        RACE("(!) TrackFile::writeText : could not create %s", filename);
+        return false;
+    }
+    for (UInt i = 0; i < length; ++i)
+    {
+        fprintf(file, "%d %d %d %u\n", definition[i].type, definition[i].surface, definition[i].noise, definition[i].length);
+    }
+    fprintf(file, "-1 %d %d\n", weather, ambience);
+    Boolean result = (ferror(file) == 0);
+    fclose(file);
+    return result;
+}
+
+
+Boolean
+TrackFile::writeBinary(const Char* filename, Track* track)
+{
+    UInt length = track->trackLength( );
+    UInt payloadSize = length*sizeof(Track::Definition) + 2*(length + 1)*sizeof(UInt);
+    UByte* payload = new UByte[payloadSize];
+    Track::Definition* definition = (Track::Definition*)payload;
+    UInt* segmentStart  = (UInt*)(definition + length);
+    UInt* segmentCenter = segmentStart + length + 1;
+    for (UInt i = 0; i < length; ++i)
+        definition[i] = track->definition( )[i];
+    for (UInt i = 0; i <= length; ++i)
+    {
+        segmentStart[i]  = track->segmentStart(i);
+        segmentCenter[i] = track->segmentCenter(i);
+    }
+    Header header;
+    memcpy(header.magic, trackFileMagic, sizeof(trackFileMagic));
+    header.version     = TRACKFILE_VERSION;
+    header.length      = length;
+    header.weather     = track->weather( );
+    header.ambience    = track->ambience( );
+    header.lapDistance = track->length( );
+    header.lapCenter   = track->lapCenter( );
+    header.checksum    = checksum(payload, payloadSize);
+
+    Boolean result = false;
+    FILE* file = fopen(filename, "wb");
+    if (file != NULL)
+    {
+        result = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+                 (fwrite(payload, payloadSize, 1, file) == 1);
+        fclose(file);
+    }
+    if (!result)
+        RACE("(!) TrackFile::writeBinary : could not write %s", filename);
+    SAFE_DELETE_ARRAY(payload);
+    return result;
+}
+
+
+void
+TrackFile::binaryName(const Char* filename, Char* result, UInt size)
+{
+    UInt length = strlen(filename);
+    if ((length > 4) && (_stricmp(filename + length - 4, ".trk") == 0))
+        _snprintf(result, size, "%sb", filename);
+    else
+        _snprintf(result, size, "%s.trkb", filename);
+    result[size - 1] = '\0';
+}
+
+
+Boolean
+TrackFile::upToDate(const Char* textName, const Char* binaryName)
+{
+    WIN32_FILE_ATTRIBUTE_DATA binaryData;
+    WIN32_FILE_ATTRIBUTE_DATA textData;
+    if (!::GetFileAttributesEx(binaryName, GetFileExInfoStandard, &binaryData))
+        return false;
+    if (!::GetFileAttributesEx(textName, GetFileExInfoStandard, &textData))
+        return true;
+    return ::CompareFileTime(&binaryData.ftLastWriteTime, &textData.ftLastWriteTime) >= 0;
+}
+
+
+UInt
+TrackFile::checksum(const UByte* data, UInt size)
+{
+    // 32 bit FNV-1a
+    UInt hash = 2166136261u;
+    for (UInt i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,84 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_TRACKFILE_H__
+#define __RACING_TRACKFILE_H__
+
+#include "Track.h"
+
+#define TRACKFILE_VERSION 1
+// shortest segment a track may have, shorter ones are stretched when reading
+#define MINPARTLENGTH 5000
+
+/*************************************************************************************
+ *@class TrackFile
+ *@description
+ *    Reads and writes custom track files. Text tracks (.trk) are the files players
+ *    edit by hand; binary tracks (.trkb) hold the same definition together with the
+ *    segment index of the track, and are mapped into memory and used in place.
+ *
+ *    A .trkb file consists of a Header followed by the Definition array (four 32 bit
+ *    values per segment), the segment start positions and the segment centers (both
+ *    length+1 32 bit values). All values are little endian. The checksum covers
+ *    everything following the header.
+ *************************************************************************************/
+class TrackFile
+{
+public:
+    struct Header
+    {
+        Char            magic[4];
+        UInt            version;
+        UInt            length;
+        UInt            weather;
+        UInt            ambience;
+        UInt            lapDistance;
+        UInt            lapCenter;
+        UInt            checksum;
+    };
+
+public:
+    TrackFile( );
+    virtual ~TrackFile( );
+
+public:
+    Boolean             open(const Char* filename);
+    void                close( );
+
+    Track::Definition*  definition( )           { return m_definition;              }
+    UInt                trackLength( )          { return m_header->length;          }
+    Track::Weather      weather( )              { return (Track::Weather)m_header->weather;   }
+    Track::Ambience     ambience( )             { return (Track::Ambience)m_header->ambience; }
+    UInt                lapDistance( )          { return m_header->lapDistance;     }
+    UInt                lapCenter( )            { return m_header->lapCenter;       }
+    UInt*               segmentStart( )         { return m_segmentStart;            }
+    UInt*               segmentCenter( )        { return m_segmentCenter;           }
+
+public:
+    static Boolean      readText(const Char* filename, Track::Definition*& definition, UInt& length,
+                                 Track::Weather& weather, Track::Ambience& ambience);
+    static Boolean      writeText(const Char* filename, Track::Definition* definition, UInt length,
+                                  Track::Weather weather, Track::Ambience ambience);
+    static Boolean      writeBinary(const Char* filename, Track* track);
+    static void         binaryName(const Char* filename, Char* result, UInt size);
+    static Boolean      upToDate(const Char* textName, const Char* binaryName);
+
+private:
+    Boolean             valid( ) const;
+    static UInt         checksum(const UByte* data, UInt size);
+
+private:
+    HANDLE              m_file;
+    HANDLE              m_mapping;
+    UByte*              m_view;
+    Header*             m_header;
+    Track::Definition*  m_definition;
+    UInt*               m_segmentStart;
+    UInt*               m_segmentCenter;
+};
+
+
+#endif /* __RACING_TRACKFILE_H__ */
@@ -0,0 +1,202 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "TrackGenerator.h"
+#include "TrackFile.h"
+
+// segment lengths are in steps of this
+#define LENGTHSTEP  5000
+
+
+TrackGenerator::TrackGenerator(UInt seed)
+{
+    reset(seed);
+}
+
+
+TrackGenerator::~TrackGenerator( )
+{
+}
+
+
+void
+TrackGenerator::reset(UInt seed)
+{
+    // spread neighbouring seeds apart, Park-Miller starting from 1 and 2 takes a
+    // while to tell them apart
+    m_seed          = seed;
+    m_state         = UInt((Huge(seed) * 2654435761U) % 2147483646) + 1;
+    random(1);
+    random(1);
+    m_nGenerated    = 0;
+    m_type          = Track::straight;
+    m_nCurves       = 0;
+    m_nStraights    = 0;
+    m_surface       = Track::asphalt;
+    m_surfaceLeft   = 0;
+    m_noiseGap      = GENERATORNOISEGAP;
+}
+
+
+void
+TrackGenerator::next(Track::Definition& segment)
+{
+    if (m_nGenerated == 0)
+    {
+        segment.type   = Track::straight;
+        segment.length = randomLength(GENERATORSTARTLENGTH, GENERATORSTARTLENGTH + 2*LENGTHSTEP);
+    }
+    else
+        nextType(segment);
+    nextSurface(segment);
+    nextNoise(segment);
+    if (segment.type == Track::straight)
+    {
+        ++m_nStraights;
+        m_nCurves = 0;
+    }
+    else
+    {
+        ++m_nCurves;
+        m_nStraights = 0;
+    }
+    m_type = segment.type;
+    ++m_nGenerated;
+}
+
+
+UInt
+TrackGenerator::severity(Track::Type type)
+{
+    if (type == Track::straight)
+        return 0;
+    return (type <= Track::hairpinLeft) ? UInt(type) : UInt(type - Track::hairpinLeft);
+}
+
+
+Int
+TrackGenerator::direction(Track::Type type)
+{
+    if (type == Track::straight)
+        return 0;
+    return (type <= Track::hairpinLeft) ? -1 : 1;
+}
+
+
+Track::Type
+TrackGenerator::curve(Int direction, UInt severity)
+{
+    if ((direction == 0) || (severity == 0))
+        return Track::straight;
+    return Track::Type((direction < 0) ? severity : Track::hairpinLeft + severity);
+}
+
+
+// Park-Miller, like the tools
+UInt
+TrackGenerator::random(UInt max)
+{
+    m_state = UInt((Huge(m_state) * 48271) % 2147483647);
+    return m_state % max;
+}
+
+
+UInt
+TrackGenerator::randomLength(UInt minimum, UInt maximum)
+{
+    return minimum + LENGTHSTEP*random((maximum - minimum)/LENGTHSTEP + 1);
+}
+
+
+void
+TrackGenerator::nextType(Track::Definition& segment)
+{
+    UInt severity  = TrackGenerator::severity(m_type);
+    Int  direction = TrackGenerator::direction(m_type);
+    Track::Type type;
+    if ((severity == 4) || (m_nCurves >= GENERATORMAXCURVES))
+        type = Track::straight;
+    else if (severity == 0)
+    {
+        // after a straight a curve of any kind, or now and then another straight
+        if ((m_nStraights < 2) && (random(4) == 0))
+            type = Track::straight;
+        else
+        {
+            UInt r = random(20);
+            UInt s = (r < 7) ? 1 : (r < 13) ? 2 : (r < 18) ? 3 : 4;
+            type = curve((random(2) == 0) ? -1 : 1, s);
+        }
+    }
+    else
+    {
+        UInt r = random(20);
+        if (r < 7)
+            type = Track::straight;
+        else if ((severity == 1) && (r < 10))
+            type = curve(-direction, 1 + random(2));
+        else
+            type = curve(direction, severity + random(3) - 1);
+    }
+
+    segment.type = type;
+    switch (TrackGenerator::severity(type))
+    {
+    case 0 :
+        segment.length = randomLength(2*LENGTHSTEP, 16*LENGTHSTEP);
+        break;
+    case 3 :
+        segment.length = randomLength(4*LENGTHSTEP, 8*LENGTHSTEP);
+        break;
+    case 4 :
+        segment.length = randomLength(6*LENGTHSTEP, 8*LENGTHSTEP);
+        break;
+    default :
+        segment.length = randomLength(4*LENGTHSTEP, 10*LENGTHSTEP);
+        break;
+    }
+}
+
+
+void
+TrackGenerator::nextSurface(Track::Definition& segment)
+{
+    // a stretch of one surface ends on the first straight after it ran out
+    Boolean changed = false;
+    if (m_surfaceLeft > 0)
+        --m_surfaceLeft;
+    else if (segment.type == Track::straight)
+    {
+        UInt r = random(10);
+        m_surface     = (r < 6) ? Track::asphalt : (r < 8) ? Track::gravel : (r < 9) ? Track::sand : Track::snow;
+        m_surfaceLeft = 10 + random(31);
+        changed       = true;
+    }
+    segment.surface = m_surface;
+
+    // now and then a ford, a short straight through water in the middle of a stretch
+    if ((segment.type == Track::straight) && (!changed) && (m_surface != Track::snow) && (random(30) == 0))
+    {
+        segment.surface = Track::water;
+        segment.length  = randomLength(MINPARTLENGTH, 2*LENGTHSTEP);
+    }
+}
+
+
+void
+TrackGenerator::nextNoise(Track::Definition& segment)
+{
+    if ((segment.type == Track::straight) && (m_noiseGap >= GENERATORNOISEGAP) && (random(4) == 0))
+    {
+        segment.noise = Track::Noise(Track::crowd + random(Track::owl));
+        m_noiseGap = 0;
+    }
+    else
+    {
+        segment.noise = Track::noNoise;
+        ++m_noiseGap;
+    }
+}
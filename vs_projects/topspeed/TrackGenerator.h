@@ -0,0 +1,78 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_TRACKGENERATOR_H__
+#define __RACING_TRACKGENERATOR_H__
+
+#include "Track.h"
+
+// the first segment is a straight at least this long, room for the starting grid
+#define GENERATORSTARTLENGTH    30000
+// curves in a row before the road straightens out again
+#define GENERATORMAXCURVES      4
+// segments between two noises at least
+#define GENERATORNOISEGAP       6
+
+
+/*************************************************************************************
+ *@class TrackGenerator
+ *@description
+ *    Makes up a road one segment at a time, the same road for the same seed. The
+ *    segments follow the rules of the tracks that come with the game:
+ *
+ *    - no segment is shorter than MINPARTLENGTH;
+ *    - a curve tightens or opens up by one step at a time, easy, normal, hard,
+ *      hairpin, only a straight may lead into a curve of any kind;
+ *    - a hairpin follows a straight or a hard curve and is followed by a
+ *      straight;
+ *    - the road only turns the other way right after an easy curve, and then
+ *      into an easy or normal one;
+ *    - never more than GENERATORMAXCURVES curves or two straights in a row;
+ *    - the surface changes on straights, water only ever on a short straight;
+ *    - a noise is heard on a single straight, at least GENERATORNOISEGAP
+ *      segments after the last one.
+ *
+ *    The random numbers are Park-Miller, which does the same on every compiler.
+ *************************************************************************************/
+class TrackGenerator
+{
+public:
+    TrackGenerator(UInt seed);
+    virtual ~TrackGenerator( );
+
+public:
+    void        reset(UInt seed);
+    void        next(Track::Definition& segment);
+    UInt        seed( )                     { return m_seed;        }
+    UInt        nGenerated( )               { return m_nGenerated;  }
+
+public:
+    // 0 for a straight up to 4 for a hairpin, and the direction of a curve
+    static UInt     severity(Track::Type type);
+    static Int      direction(Track::Type type);
+    static Track::Type curve(Int direction, UInt severity);
+
+private:
+    UInt        random(UInt max);
+    UInt        randomLength(UInt minimum, UInt maximum);
+    void        nextType(Track::Definition& segment);
+    void        nextSurface(Track::Definition& segment);
+    void        nextNoise(Track::Definition& segment);
+
+private:
+    UInt                m_seed;
+    UInt                m_state;
+    UInt                m_nGenerated;
+    Track::Type         m_type;             // of the last segment
+    UInt                m_nCurves;          // curves in a row up to the last segment
+    UInt                m_nStraights;       // straights in a row up to the last segment
+    Track::Surface      m_surface;          // of the stretch the road is in
+    UInt                m_surfaceLeft;      // segments until the surface may change
+    UInt                m_noiseGap;         // segments since the last noise
+};
+
+
+#endif /* __RACING_TRACKGENERATOR_H__ */
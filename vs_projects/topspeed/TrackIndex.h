@@ -0,0 +1,457 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_TRACKINDEX_H__
+#define __RACING_TRACKINDEX_H__
+
+// NEVER INCLUDE THIS FILE IN A HEADER!!
+
+// Generated by 'trackconv -registry' from TrackDefs.h, do not edit.
+// The segment index of every built-in track and the perfect hash of their names.
+
+// america, 9 segments
+UInt _ixAmericaStart[] =
+{
+    0, 40000, 70000, 120000, 150000, 230000, 260000, 310000,
+    340000, 380000
+};
+UInt _ixAmericaCenter[] =
+{
+    0, 0, 4294952296, 4294918963, 4294903963, 4294903963, 4294888963, 4294855630,
+    4294840630, 4294840630
+};
+const UInt _ixAmericaLap = 380000;
+const UInt _ixAmericaLapCenter = 4294840630;
+
+// austria, 12 segments
+UInt _ixAustriaStart[] =
+{
+    0, 30000, 60000, 100000, 120000, 160000, 210000, 240000,
+    280000, 310000, 370000, 390000, 410000
+};
+UInt _ixAustriaCenter[] =
+{
+    0, 0, 4294937296, 4294877296, 4294877296, 4294857296, 4294857296, 4294887296,
+    4294887296, 4294842296, 4294842296, 4294852296, 4294852296
+};
+const UInt _ixAustriaLap = 410000;
+const UInt _ixAustriaLapCenter = 4294852296;
+
+// belgium, 12 segments
+UInt _ixBelgiumStart[] =
+{
+    0, 30000, 60000, 90000, 97000, 127000, 167000, 197000,
+    237000, 257000, 277000, 302000, 312000
+};
+UInt _ixBelgiumCenter[] =
+{
+    0, 0, 4294952296, 15000, 15000, 4294962296, 4294962296, 40000,
+    40000, 50000, 50000, 66666, 66666
+};
+const UInt _ixBelgiumLap = 312000;
+const UInt _ixBelgiumLapCenter = 66666;
+
+// brazil, 10 segments
+UInt _ixBrazilStart[] =
+{
+    0, 50000, 100000, 140000, 180000, 230000, 290000, 330000,
+    380000, 420000, 450000
+};
+UInt _ixBrazilCenter[] =
+{
+    0, 0, 50000, 50000, 76666, 76666, 46666, 86666,
+    86666, 60000, 60000
+};
+const UInt _ixBrazilLap = 450000;
+const UInt _ixBrazilLapCenter = 60000;
+
+// china, 10 segments
+UInt _ixChinaStart[] =
+{
+    0, 30000, 70000, 100000, 150000, 210000, 240000, 290000,
+    330000, 370000, 420000
+};
+UInt _ixChinaCenter[] =
+{
+    0, 0, 26666, 26666, 4294960629, 23333, 23333, 4294940629,
+    4294940629, 4294900629, 4294900629
+};
+const UInt _ixChinaLap = 420000;
+const UInt _ixChinaLapCenter = 4294900629;
+
+// england, 12 segments
+UInt _ixEnglandStart[] =
+{
+    0, 40000, 70000, 110000, 150000, 178000, 218000, 258000,
+    308000, 348000, 378000, 428000, 458000
+};
+UInt _ixEnglandCenter[] =
+{
+    0, 0, 4294947296, 4294927296, 4294927296, 2000, 2000, 28666,
+    28666, 48666, 48666, 15333, 15333
+};
+const UInt _ixEnglandLap = 458000;
+const UInt _ixEnglandLapCenter = 15333;
+
+// finland, 11 segments
+UInt _ixFinlandStart[] =
+{
+    0, 50000, 90000, 130000, 170000, 230000, 260000, 280000,
+    320000, 350000, 400000, 430000
+};
+UInt _ixFinlandCenter[] =
+{
+    0, 0, 4294907296, 4294933962, 4294933962, 26666, 11666, 11666,
+    38332, 38332, 4999, 4999
+};
+const UInt _ixFinlandLap = 430000;
+const UInt _ixFinlandLapCenter = 4999;
+
+// france, 13 segments
+UInt _ixFranceStart[] =
+{
+    0, 40000, 80000, 100000, 130000, 170000, 230000, 270000,
+    310000, 340000, 370000, 410000, 440000, 470000
+};
+UInt _ixFranceCenter[] =
+{
+    0, 0, 20000, 20000, 40000, 40000, 4294917296, 4294917296,
+    4294877296, 4294877296, 4294897296, 4294897296, 4294882296, 4294882296
+};
+const UInt _ixFranceLap = 470000;
+const UInt _ixFranceLapCenter = 4294882296;
+
+// germany, 11 segments
+UInt _ixGermanyStart[] =
+{
+    0, 40000, 80000, 100000, 140000, 170000, 200000, 230000,
+    280000, 300000, 330000, 370000
+};
+UInt _ixGermanyCenter[] =
+{
+    0, 0, 26666, 26666, 6666, 6666, 26666, 6666,
+    6666, 4294963962, 4294933962, 4294933962
+};
+const UInt _ixGermanyLap = 370000;
+const UInt _ixGermanyLapCenter = 4294933962;
+
+// ireland, 11 segments
+UInt _ixIrelandStart[] =
+{
+    0, 70000, 120000, 170000, 200000, 220000, 260000, 280000,
+    300000, 350000, 380000, 390000
+};
+UInt _ixIrelandCenter[] =
+{
+    0, 0, 33333, 33333, 18333, 18333, 58333, 48333,
+    48333, 81666, 61666, 61666
+};
+const UInt _ixIrelandLap = 390000;
+const UInt _ixIrelandLapCenter = 61666;
+
+// italy, 13 segments
+UInt _ixItalyStart[] =
+{
+    0, 40000, 65000, 90000, 140000, 170000, 190000, 220000,
+    250000, 290000, 320000, 360000, 430000, 460000
+};
+UInt _ixItalyCenter[] =
+{
+    0, 0, 4294954796, 0, 0, 4294937296, 4294937296, 0,
+    4294947296, 4294947296, 0, 0, 46666, 46666
+};
+const UInt _ixItalyLap = 460000;
+const UInt _ixItalyLapCenter = 46666;
+
+// netherlands, 12 segments
+UInt _ixNetherlandsStart[] =
+{
+    0, 40000, 60000, 66000, 86000, 116000, 141000, 161000,
+    211000, 241000, 259000, 279000, 297000
+};
+UInt _ixNetherlandsCenter[] =
+{
+    0, 0, 4294953963, 4294953963, 4294943963, 4294963963, 4294951463, 4294951463,
+    4294918130, 4294918130, 4294927130, 4294907130, 4294907130
+};
+const UInt _ixNetherlandsLap = 297000;
+const UInt _ixNetherlandsLapCenter = 4294907130;
+
+// portugal, 10 segments
+UInt _ixPortugalStart[] =
+{
+    0, 30000, 70000, 100000, 130000, 170000, 200000, 250000,
+    310000, 360000, 380000
+};
+UInt _ixPortugalCenter[] =
+{
+    0, 0, 4294947296, 4294947296, 0, 40000, 40000, 15000,
+    4294942296, 0, 0
+};
+const UInt _ixPortugalLap = 380000;
+const UInt _ixPortugalLapCenter = 0;
+
+// russia, 11 segments
+UInt _ixRussiaStart[] =
+{
+    0, 40000, 80000, 110000, 140000, 190000, 220000, 270000,
+    310000, 340000, 380000, 420000
+};
+UInt _ixRussiaCenter[] =
+{
+    0, 0, 20000, 0, 0, 50000, 50000, 75000,
+    48334, 48334, 28334, 28334
+};
+const UInt _ixRussiaLap = 420000;
+const UInt _ixRussiaLapCenter = 28334;
+
+// spain, 13 segments
+UInt _ixSpainStart[] =
+{
+    0, 40000, 70000, 110000, 140000, 170000, 210000, 280000,
+    320000, 370000, 410000, 450000, 480000, 500000
+};
+UInt _ixSpainCenter[] =
+{
+    0, 0, 4294937296, 4294937296, 4294922296, 4294922296, 4294948962, 4294948962,
+    4294922296, 4294922296, 4294902296, 4294902296, 4294882296, 4294882296
+};
+const UInt _ixSpainLap = 500000;
+const UInt _ixSpainLapCenter = 4294882296;
+
+// sweden, 11 segments
+UInt _ixSwedenStart[] =
+{
+    0, 30000, 80000, 130000, 170000, 210000, 260000, 300000,
+    330000, 370000, 420000, 450000
+};
+UInt _ixSwedenCenter[] =
+{
+    0, 0, 50000, 0, 0, 4294940630, 4294915630, 4294935630,
+    4294935630, 4294962296, 20000, 20000
+};
+const UInt _ixSwedenLap = 450000;
+const UInt _ixSwedenLapCenter = 20000;
+
+// switserland, 11 segments
+UInt _ixSwitserlandStart[] =
+{
+    0, 40000, 71000, 101000, 131000, 161000, 201000, 221000,
+    260000, 280000, 320000, 340000
+};
+UInt _ixSwitserlandCenter[] =
+{
+    0, 0, 46500, 46500, 66500, 66500, 26500, 26500,
+    7000, 7000, 47000, 47000
+};
+const UInt _ixSwitserlandLap = 340000;
+const UInt _ixSwitserlandLapCenter = 47000;
+
+// advHills, 43 segments
+UInt _ixAdvHillsStart[] =
+{
+    0, 40000, 55000, 80000, 95000, 123000, 145000, 160000,
+    175000, 200000, 219000, 236000, 253000, 268000, 283000, 293000,
+    303000, 343000, 353000, 398000, 415500, 425000, 434000, 449000,
+    459000, 474000, 480000, 495000, 510000, 521000, 551000, 571000,
+    611000, 631000, 651000, 666000, 686000, 706000, 721000, 736000,
+    746000, 776000, 791000, 831000
+};
+UInt _ixAdvHillsCenter[] =
+{
+    0, 0, 4294957296, 4294957296, 4294949796, 4294949796, 4294964462, 4294956962,
+    4294956962, 4294940296, 4294940296, 4294948796, 4294960129, 4294960129, 4294952629, 4294945963,
+    4294935963, 4294935963, 4294940963, 4294940963, 4294949713, 4294949713, 4294945213, 4294955213,
+    4294955213, 4294947713, 4294947713, 4294955213, 4294945213, 4294945213, 4294930213, 4294930213,
+    4294930213, 4294940213, 4294953546, 4294953546, 4294943546, 4294943546, 4294933546, 4294941046,
+    4294941046, 4294941046, 4294951046, 4294951046
+};
+const UInt _ixAdvHillsLap = 831000;
+const UInt _ixAdvHillsLapCenter = 4294951046;
+
+// advCoast, 41 segments
+UInt _ixAdvCoastStart[] =
+{
+    0, 40000, 65000, 95000, 114000, 139000, 177000, 196000,
+    215000, 237000, 258000, 277000, 297000, 354000, 373000, 389000,
+    411000, 446000, 461000, 483000, 504000, 517000, 532000, 564000,
+    583000, 595000, 614000, 633000, 647000, 677000, 737000, 767000,
+    787000, 817000, 832000, 852000, 872000, 887000, 902000, 944000,
+    974000, 1024000
+};
+UInt _ixAdvCoastCenter[] =
+{
+    0, 0, 12500, 4294959796, 4294959796, 4294943130, 4294962130, 4294962130,
+    4294949464, 4294949464, 4294949464, 4294936798, 4294926798, 4294926798, 4294936298, 4294946964,
+    4294932298, 4294932298, 4294942298, 4294931298, 4294917298, 4294923798, 4294908798, 4294908798,
+    4294899298, 4294899298, 4294908798, 4294908798, 4294901798, 4294916798, 4294916798, 4294936798,
+    4294936798, 4294921798, 4294921798, 4294935131, 4294935131, 4294945131, 4294952631, 4294952631,
+    4294937631, 4294937631
+};
+const UInt _ixAdvCoastLap = 1024000;
+const UInt _ixAdvCoastLapCenter = 4294937631;
+
+// advCountry, 39 segments
+UInt _ixAdvCountryStart[] =
+{
+    0, 25000, 50000, 85000, 110000, 145000, 175000, 236000,
+    253000, 278000, 298000, 329000, 357000, 378000, 413000, 429000,
+    454000, 481000, 503000, 531000, 544000, 565000, 613000, 628000,
+    640000, 652000, 684000, 699000, 717000, 741000, 771000, 791000,
+    805000, 820000, 835000, 847000, 862000, 897000, 918000, 988000
+};
+UInt _ixAdvCountryCenter[] =
+{
+    0, 0, 4294942296, 4294942296, 4294958962, 4294958962, 6666, 6666,
+    4294956962, 4294956962, 4294943629, 4294943629, 4294943629, 4294957629, 4294957629, 4294949629,
+    4294949629, 4294949629, 4294964295, 4294964295, 3499, 34999, 34999, 24999,
+    32999, 32999, 32999, 22999, 31999, 31999, 46999, 46999,
+    60999, 60999, 53499, 53499, 30999, 30999, 44999, 44999
+};
+const UInt _ixAdvCountryLap = 988000;
+const UInt _ixAdvCountryLapCenter = 44999;
+
+// advAirport, 43 segments
+UInt _ixAdvAirportStart[] =
+{
+    0, 22000, 48000, 64000, 87000, 113000, 141000, 158000,
+    164000, 210000, 231000, 249000, 265000, 292000, 308000, 320000,
+    348000, 375000, 381000, 417000, 436000, 447000, 454000, 467000,
+    485000, 502000, 508000, 520000, 531000, 548000, 569000, 575000,
+    615000, 632000, 656000, 673000, 690000, 707000, 728000, 744000,
+    756000, 786000, 802000, 842000
+};
+UInt _ixAdvAirportCenter[] =
+{
+    0, 0, 26000, 26000, 14500, 14500, 4294963130, 4334,
+    4334, 4334, 18334, 6334, 4294965630, 4294965630, 4294957630, 2334,
+    2334, 20334, 20334, 20334, 7668, 2168, 2168, 15168,
+    15168, 23668, 23668, 15668, 32168, 32168, 21668, 21668,
+    21668, 30168, 30168, 21668, 21668, 10335, 10335, 21001,
+    15001, 15001, 23001, 23001
+};
+const UInt _ixAdvAirportLap = 842000;
+const UInt _ixAdvAirportLapCenter = 23001;
+
+// advDesert, 90 segments
+UInt _ixAdvDesertStart[] =
+{
+    0, 150000, 170000, 210000, 240000, 330000, 430000, 450000,
+    490000, 509000, 520111, 560111, 569111, 639111, 647111, 687111,
+    727111, 737111, 817111, 892111, 1017111, 1027111, 1045111, 1050111,
+    1090111, 1136111, 1148456, 1158456, 1198456, 1276233, 1330554, 1430553,
+    1436553, 1476553, 1516553, 1526553, 1556553, 1756553, 1816553, 1851553,
+    1931553, 1940053, 1973386, 2019386, 2079386, 2119386, 2144386, 2186386,
+    2276386, 2296386, 2326386, 2421386, 2921386, 2927386, 2933386, 2939386,
+    2979386, 3229386, 3234386, 3239386, 3244386, 3294386, 3309386, 3349386,
+    3369386, 3399386, 3406886, 3506886, 3581886, 3621886, 3631886, 3691886,
+    3701886, 3736886, 3770219, 3775219, 3808552, 3841885, 3875218, 3908551,
+    3952995, 4008550, 4041883, 4064105, 4164105, 4194105, 4224105, 4290771,
+    4957437, 4967437, 4977437
+};
+UInt _ixAdvDesertCenter[] =
+{
+    0, 0, 4294957296, 30000, 0, 4294832296, 4294832296, 4294852296,
+    4294852296, 4294861796, 4294872907, 4294832907, 4294828407, 4294863407, 4294863407, 4294883407,
+    4294883407, 4294873407, 4294833407, 4294870907, 4294870907, 4294865907, 4294865907, 4294865907,
+    4294865907, 4294934907, 4294941079, 4294941079, 33783, 4294884414, 4294911574, 4294911574,
+    4294920574, 4294960574, 19944, 24944, 9944, 9944, 69944, 69944,
+    123277, 123277, 106611, 175611, 115611, 155611, 155611, 218611,
+    218611, 238611, 223611, 81111, 81111, 84111, 88111, 94111,
+    154111, 154111, 151611, 148278, 143278, 68278, 68278, 28278,
+    4294965574, 4294965574, 5778, 5778, 4294860574, 4294860574, 4294855574, 4294945574,
+    4294935574, 4294935574, 4294902241, 4294902241, 4294868908, 4294868908, 4294835575, 4294835575,
+    4294791131, 4294791131, 4294757798, 4294757798, 4294907798, 4294937798, 4294957798, 4294891132,
+    4294891132, 4294891132, 4294891132
+};
+const UInt _ixAdvDesertLap = 4977437;
+const UInt _ixAdvDesertLapCenter = 4294891132;
+
+// advRush, 104 segments
+UInt _ixAdvRushStart[] =
+{
+    0, 35000, 155000, 208000, 278000, 308000, 332000, 362000,
+    394000, 413000, 448000, 463000, 515000, 538000, 543000, 568000,
+    588000, 688000, 773000, 805000, 847000, 867000, 887000, 910000,
+    931000, 970000, 1013000, 1051000, 1101000, 1170000, 1208000, 1238000,
+    1281000, 1311000, 1321000, 1361000, 1437000, 1467000, 1497000, 1597000,
+    1631000, 1731000, 1751000, 1771000, 1791000, 1811000, 1821000, 1827700,
+    1909700, 1951700, 1981700, 2111700, 2134700, 2162700, 2172700, 2192700,
+    2295700, 2325700, 2359700, 2393700, 2398700, 2432700, 2462700, 2492700,
+    2522700, 2540700, 2545700, 2665700, 2723700, 2785700, 2806700, 2846700,
+    2896700, 2996700, 3056700, 3101700, 3153700, 3184700, 3314700, 3340700,
+    3370700, 3400700, 3431700, 3461700, 3484700, 3516700, 3551700, 3594700,
+    3628700, 3728700, 3744700, 3844700, 3924700, 4024700, 4037700, 4137700,
+    4187700, 4237700, 4267700, 4308700, 4408700, 4508700, 4578700, 4598700,
+    4698700
+};
+UInt _ixAdvRushCenter[] =
+{
+    0, 0, 0, 0, 4294897296, 4294897296, 4294873296, 4294853296,
+    4294821296, 4294821296, 4294838796, 4294838796, 4294812796, 4294797463, 4294799963, 4294799963,
+    4294779963, 4294779963, 4294779963, 4294763963, 4294763963, 4294783963, 4294783963, 4294768630,
+    4294768630, 4294749130, 4294792130, 4294766797, 4294766797, 4294766797, 4294766797, 4294746797,
+    4294789797, 4294809797, 4294809797, 4294809797, 4294809797, 4294839797, 4294809797, 4294809797,
+    4294775797, 4294775797, 4294775797, 4294762464, 4294762464, 4294749131, 4294749131, 4294749131,
+    4294749131, 4294721131, 4294741131, 4294741131, 4294725798, 4294753798, 4294758798, 4294758798,
+    4294758798, 4294773798, 4294796464, 4294813464, 4294813464, 4294830464, 4294810464, 4294830464,
+    4294810464, 4294810464, 4294815464, 4294815464, 4294815464, 4294877464, 4294877464, 4294877464,
+    4294877464, 4294877464, 4294907464, 4294937464, 4294902798, 4294887298, 4294887298, 4294874298,
+    4294889298, 4294869298, 4294889964, 4294869964, 4294869964, 4294848631, 4294848631, 4294870131,
+    4294892797, 4294826131, 4294826131, 4294926131, 4294926131, 4294926131, 4294917465, 4294817465,
+    4294842465, 4294875798, 4294890798, 4294870298, 4294870298, 4294870298, 4294870298, 4294870298,
+    4294870298
+};
+const UInt _ixAdvRushLap = 4698700;
+const UInt _ixAdvRushLapCenter = 4294870298;
+
+// advEscape, 88 segments
+UInt _ixAdvEscapeStart[] =
+{
+    0, 50000, 88000, 118000, 128000, 148000, 168000, 188000,
+    256000, 262000, 365000, 385000, 415000, 545000, 596000, 636000,
+    641000, 821000, 960000, 985000, 1020000, 1030000, 1050000, 1133500,
+    1158500, 1188500, 1225500, 1283500, 1298500, 1311500, 1321500, 1326500,
+    1336500, 1396500, 1426500, 1479500, 1517500, 1551500, 1586500, 1667000,
+    1702000, 1712000, 1792000, 1892000, 1982000, 2012000, 2087000, 2187000,
+    2205000, 2255000, 2290000, 2303000, 2363000, 2463000, 2521000, 2531000,
+    2631000, 2709000, 2715000, 2747000, 2770000, 2820000, 2837000, 2867000,
+    2889000, 2924000, 2954000, 2984000, 3014000, 3072000, 3082000, 3141000,
+    3211000, 3263000, 3286000, 3309000, 3346000, 3446000, 3474000, 3483200,
+    3565200, 3600200, 3652200, 3682200, 3712200, 3747200, 3767200, 3814200,
+    3899200
+};
+UInt _ixAdvEscapeCenter[] =
+{
+    0, 0, 4294948296, 4294963296, 4294956630, 4294956630, 4294946630, 4294946630,
+    4294912630, 4294915630, 4294915630, 4294902297, 4294922297, 4294835631, 4294835631, 4294855631,
+    4294858964, 4294858964, 4294928464, 4294911798, 4294935131, 4294935131, 4294925131, 4294925131,
+    4294912631, 4294912631, 4294931131, 4294931131, 4294941131, 4294932465, 4294932465, 4294935798,
+    4294935798, 4294965798, 4294950798, 4294915465, 4294915465, 4294932465, 4294955798, 4294902132,
+    4294902132, 4294897132, 4294843799, 4294843799, 4294783799, 4294783799, 4294833799, 4294883799,
+    4294883799, 4294850466, 4294873799, 4294865133, 4294865133, 4294915133, 4294915133, 4294910133,
+    4294843467, 4294882467, 4294882467, 4294898467, 4294883134, 4294858134, 4294866634, 4294851634,
+    4294836968, 4294836968, 4294816968, 4294801968, 4294781968, 4294752968, 4294746302, 4294746302,
+    4294792968, 4294792968, 4294781468, 4294766135, 4294784635, 4294851301, 4294851301, 4294846701,
+    4294846701, 4294870034, 4294870034, 4294885034, 4294905034, 4294922534, 4294922534, 4294953867,
+    4294953867
+};
+const UInt _ixAdvEscapeLap = 3899200;
+const UInt _ixAdvEscapeLapCenter = 4294953867;
+
+// seed of each bucket
+UInt _trackHashSeed[TRACKHASHBUCKETS] =
+{
+    1, 76, 3, 2, 5, 11, 9, 209
+};
+
+// the track at each slot
+UByte _trackHashSlot[NBUILTINTRACKS] =
+{
+    4, 9, 10, 5, 23, 1, 7, 0, 16, 15, 2, 19, 14, 17, 3, 6, 20, 11, 21, 8, 22, 12, 18, 13
+};
+
+#endif /* __RACING_TRACKINDEX_H__ */
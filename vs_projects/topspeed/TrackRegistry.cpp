@@ -0,0 +1,97 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "TrackRegistry.h"
+#include "TrackDefs.h"
+
+#ifndef TRACKREGISTRY_BOOTSTRAP
+#include "TrackIndex.h"
+#define BUILTIN(name, sound, definition, index, weather, ambience) \
+    { name, sound, definition, sizeof(definition)/sizeof(Track::Definition), \
+      index##Start, index##Center, index##Lap, index##LapCenter, weather, ambience }
+#else
+// a track was added and TrackIndex.h does not know it yet: trackconv built
+// this way has only the definitions, enough for -registry to generate it
+#define BUILTIN(name, sound, definition, index, weather, ambience) \
+    { name, sound, definition, sizeof(definition)/sizeof(Track::Definition), \
+      NULL, NULL, 0, 0, weather, ambience }
+#endif
+
+
+static const TrackRegistry::Entry _builtinTracks[NBUILTINTRACKS] =
+{
+    BUILTIN("america",      "tracks\\america",          _trAmerica,     _ixAmerica,     Track::sunny,   Track::noAmbience),
+    BUILTIN("austria",      "tracks\\austria",          _trAustria,     _ixAustria,     Track::sunny,   Track::noAmbience),
+    BUILTIN("belgium",      "tracks\\belgium",          _trBelgium,     _ixBelgium,     Track::sunny,   Track::noAmbience),
+    BUILTIN("brazil",       "tracks\\brazil",           _trBrazil,      _ixBrazil,      Track::sunny,   Track::noAmbience),
+    BUILTIN("china",        "tracks\\china",            _trChina,       _ixChina,       Track::sunny,   Track::noAmbience),
+    BUILTIN("england",      "tracks\\england",          _trEngland,     _ixEngland,     Track::sunny,   Track::noAmbience),
+    BUILTIN("finland",      "tracks\\finland",          _trFinland,     _ixFinland,     Track::sunny,   Track::noAmbience),
+    BUILTIN("france",       "tracks\\france",           _trFrance,      _ixFrance,      Track::sunny,   Track::noAmbience),
+    BUILTIN("germany",      "tracks\\germany",          _trGermany,     _ixGermany,     Track::sunny,   Track::noAmbience),
+    BUILTIN("ireland",      "tracks\\ireland",          _trIreland,     _ixIreland,     Track::sunny,   Track::noAmbience),
+    BUILTIN("italy",        "tracks\\italy",            _trItaly,       _ixItaly,       Track::sunny,   Track::noAmbience),
+    BUILTIN("netherlands",  "tracks\\netherlands",      _trNetherlands, _ixNetherlands, Track::sunny,   Track::noAmbience),
+    BUILTIN("portugal",     "tracks\\portugal",         _trPortugal,    _ixPortugal,    Track::sunny,   Track::noAmbience),
+    BUILTIN("russia",       "tracks\\russia",           _trRussia,      _ixRussia,      Track::sunny,   Track::noAmbience),
+    BUILTIN("spain",        "tracks\\spain",            _trSpain,       _ixSpain,       Track::sunny,   Track::noAmbience),
+    BUILTIN("sweden",       "tracks\\sweden",           _trSweden,      _ixSweden,      Track::sunny,   Track::noAmbience),
+    BUILTIN("switserland",  "tracks\\switserland",      _trSwitserland, _ixSwitserland, Track::sunny,   Track::noAmbience),
+    BUILTIN("advHills",     "tracks\\rallyhills",       _trAdvHills,    _ixAdvHills,    Track::sunny,   Track::noAmbience),
+    BUILTIN("advCoast",     "tracks\\frenchcoast",      _trAdvCoast,    _ixAdvCoast,    Track::sunny,   Track::noAmbience),
+    BUILTIN("advCountry",   "tracks\\englishcountry",   _trAdvCountry,  _ixAdvCountry,  Track::rain,    Track::noAmbience),
+    BUILTIN("advAirport",   "tracks\\rideairport",      _trAirport,     _ixAdvAirport,  Track::sunny,   Track::airport),
+    BUILTIN("advDesert",    "tracks\\rallydesert",      _trDesert,      _ixAdvDesert,   Track::sunny,   Track::desert),
+    BUILTIN("advRush",      "tracks\\rushhour",         _trAdvRush,     _ixAdvRush,     Track::sunny,   Track::noAmbience),
+    BUILTIN("advEscape",    "tracks\\polarescape",      _trAdvEscape,   _ixAdvEscape,   Track::wind,    Track::noAmbience)
+};
+
+
+const TrackRegistry::Entry*
+TrackRegistry::find(const Char* name)
+{
+    if (name == NULL)
+        return NULL;
+#ifdef TRACKREGISTRY_BOOTSTRAP
+    for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+    {
+        if (strcmp(_builtinTracks[i].name, name) == 0)
+            return &_builtinTracks[i];
+    }
+    return NULL;
+#else
+    UInt bucket = hash(name, 0) % TRACKHASHBUCKETS;
+    UInt slot = hash(name, _trackHashSeed[bucket]) % NBUILTINTRACKS;
+    const Entry* entry = &_builtinTracks[_trackHashSlot[slot]];
+    if (strcmp(entry->name, name) != 0)
+        return NULL;
+    return entry;
+#endif
+}
+
+
+const TrackRegistry::Entry&
+TrackRegistry::entry(UInt i)
+{
+    return _builtinTracks[i];
+}
+
+
+UInt
+TrackRegistry::hash(const Char* name, UInt seed)
+{
+    // FNV-1a, started from the seed, with a final mix so the low bits change too
+    UInt h = 2166136261U ^ (seed * 16777619U);
+    for (const UByte* c = (const UByte*)name; *c != 0; ++c)
+    {
+        h ^= *c;
+        h *= 16777619U;
+    }
+    h ^= h >> 15;
+    h *= 0x2c1b3c6dU;
+    h ^= h >> 12;
+    return h;
+}
@@ -0,0 +1,60 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_TRACKREGISTRY_H__
+#define __RACING_TRACKREGISTRY_H__
+
+#include "Track.h"
+
+// the circuits come first, then the adventures, in the order of the menus
+#define NBUILTINCIRCUITS    17
+#define NBUILTINADVENTURES  7
+#define NBUILTINTRACKS      (NBUILTINCIRCUITS + NBUILTINADVENTURES)
+// buckets of the perfect hash, each with a seed of its own
+#define TRACKHASHBUCKETS    8
+
+
+/*************************************************************************************
+ *@class TrackRegistry
+ *@description
+ *    The tracks that come with the game. Everything Track would otherwise work out
+ *    when loading one is baked in: the definition from TrackDefs.h, the segment
+ *    index, lap distance and center from TrackIndex.h, the weather and ambience
+ *    and the sound announcing the track. Names are found with a minimal perfect
+ *    hash: the first hash picks a bucket, the seed of the bucket gives a second
+ *    hash that lands every name on a slot of its own, and a single strcmp tells
+ *    whether it was a built-in track at all.
+ *
+ *    TrackIndex.h is generated by 'trackconv -registry', which has to run again
+ *    when a track is added or changed; for a new track trackconv is built with
+ *    TRACKREGISTRY_BOOTSTRAP defined first. 'trackconv -check' compares the
+ *    baked data with what Track builds at run time.
+ *************************************************************************************/
+class TrackRegistry
+{
+public:
+    struct Entry
+    {
+        Char*               name;
+        Char*               sound;          // language sound announcing the track
+        Track::Definition*  definition;
+        UInt                length;
+        UInt*               segmentStart;   // length+1 entries
+        UInt*               segmentCenter;  // length+1 entries
+        UInt                lapDistance;
+        UInt                lapCenter;
+        Track::Weather      weather;
+        Track::Ambience     ambience;
+    };
+
+public:
+    static const Entry*     find(const Char* name);
+    static const Entry&     entry(UInt i);
+    static UInt             hash(const Char* name, UInt seed);
+};
+
+
+#endif /* __RACING_TRACKREGISTRY_H__ */
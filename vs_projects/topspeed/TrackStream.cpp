@@ -0,0 +1,165 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "TrackStream.h"
+#include "Game.h"
+
+// steps the cursor takes to a nearby segment before it searches
+#define LOCATESTEPS 4
+
+
+TrackStream::TrackStream(UInt seed) :
+    m_generator(seed),
+    m_ring(NULL),
+    m_capacity(TRACKSTREAMCHUNKS),
+    m_first(0),
+    m_end(0),
+    m_segment(0)
+{
+    RACE("(+) TrackStream : seed = %u", seed);
+    m_ring = new Chunk[m_capacity];
+    generate( );
+}
+
+
+TrackStream::~TrackStream( )
+{
+    RACE("(-) TrackStream");
+    SAFE_DELETE_ARRAY(m_ring);
+}
+
+
+void
+TrackStream::advance(Int last, Int first)
+{
+    // the newest chunk stays, the next one continues from its end
+    UInt pos = (last < 0) ? 0 : UInt(last);
+    while ((m_end - m_first > 1) && (m_ring[m_first & (m_capacity - 1)].start[TRACKCHUNKSEGMENTS] <= pos))
+        ++m_first;
+    UInt ahead = ((first < 0) ? 0 : UInt(first)) + TRACKSTREAMAHEAD;
+    while (m_ring[(m_end - 1) & (m_capacity - 1)].start[TRACKCHUNKSEGMENTS] < ahead)
+        generate( );
+}
+
+
+UInt
+TrackStream::locate(Int position)
+{
+    UInt pos = (position < 0) ? 0 : UInt(position);
+    if (m_segment < firstSegment( ))
+        m_segment = firstSegment( );
+    for (UInt i = 0; (i < LOCATESTEPS) && (segmentStart(m_segment + 1) <= pos); ++i)
+        ++m_segment;
+    for (UInt i = 0; (i < LOCATESTEPS) && (m_segment > firstSegment( )) && (segmentStart(m_segment) > pos); ++i)
+        --m_segment;
+    if ((segmentStart(m_segment) > pos) || (segmentStart(m_segment + 1) <= pos))
+        m_segment = segmentAt(position);
+    return m_segment;
+}
+
+
+UInt
+TrackStream::segmentAt(Int position)
+{
+    UInt pos = (position < 0) ? 0 : UInt(position);
+    while (m_ring[(m_end - 1) & (m_capacity - 1)].start[TRACKCHUNKSEGMENTS] <= pos)
+        generate( );
+    // the chunk first, then the segment in it
+    UInt low  = m_first;
+    UInt high = m_end;
+    while (high - low > 1)
+    {
+        UInt mid = low + (high - low) / 2;
+        if (m_ring[mid & (m_capacity - 1)].start[0] <= pos)
+            low = mid;
+        else
+            high = mid;
+    }
+    return (low << TRACKCHUNKSHIFT) + search(m_ring[low & (m_capacity - 1)], pos);
+}
+
+
+Track::NoiseZone
+TrackStream::noiseZone(UInt segment)
+{
+    // the generator gives a noise to a single segment
+    const Track::Definition& definition = this->definition(segment);
+    Track::NoiseZone zone;
+    zone.start  = segmentStart(segment);
+    zone.length = definition.length;
+    zone.noise  = definition.noise;
+    return zone;
+}
+
+
+TrackStream::Chunk&
+TrackStream::chunk(UInt segment)
+{
+    while ((segment >> TRACKCHUNKSHIFT) >= m_end)
+        generate( );
+    return m_ring[(segment >> TRACKCHUNKSHIFT) & (m_capacity - 1)];
+}
+
+
+void
+TrackStream::generate( )
+{
+    if (m_end - m_first == m_capacity)
+        grow( );
+    UInt dist   = 0;
+    UInt center = 0;
+    if (m_end > 0)
+    {
+        const Chunk& previous = m_ring[(m_end - 1) & (m_capacity - 1)];
+        dist   = previous.start[TRACKCHUNKSEGMENTS];
+        center = previous.center[TRACKCHUNKSEGMENTS];
+    }
+    Chunk& chunk = m_ring[m_end & (m_capacity - 1)];
+    for (UInt i = 0; i < TRACKCHUNKSEGMENTS; ++i)
+    {
+        m_generator.next(chunk.definition[i]);
+        chunk.start[i]  = dist;
+        chunk.center[i] = center;
+        dist   += chunk.definition[i].length;
+        center += Track::curveOffset(chunk.definition[i].type, chunk.definition[i].length);
+    }
+    chunk.start[TRACKCHUNKSEGMENTS]  = dist;
+    chunk.center[TRACKCHUNKSEGMENTS] = center;
+    ++m_end;
+}
+
+
+void
+TrackStream::grow( )
+{
+    // every chunk moves to the slot its number has in the larger ring
+    UInt capacity = 2*m_capacity;
+    RACE("TrackStream::grow : %u chunks", capacity);
+    Chunk* ring = new Chunk[capacity];
+    for (UInt i = m_first; i != m_end; ++i)
+        ring[i & (capacity - 1)] = m_ring[i & (m_capacity - 1)];
+    SAFE_DELETE_ARRAY(m_ring);
+    m_ring     = ring;
+    m_capacity = capacity;
+}
+
+
+UInt
+TrackStream::search(const Chunk& chunk, UInt pos)
+{
+    // last segment starting at or before pos
+    UInt low  = 0;
+    UInt high = TRACKCHUNKSEGMENTS;
+    while (high - low > 1)
+    {
+        UInt mid = (low + high) / 2;
+        if (chunk.start[mid] <= pos)
+            low = mid;
+        else
+            high = mid;
+    }
+    return low;
+}
@@ -0,0 +1,82 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_TRACKSTREAM_H__
+#define __RACING_TRACKSTREAM_H__
+
+#include "TrackGenerator.h"
+
+// segments per chunk, a power of two
+#define TRACKCHUNKSHIFT     6
+#define TRACKCHUNKSEGMENTS  (1 << TRACKCHUNKSHIFT)
+// chunks the ring starts with, a power of two; it doubles when the field spreads out further
+#define TRACKSTREAMCHUNKS   4
+// road kept generated ahead of the furthest car
+#define TRACKSTREAMAHEAD    200000
+
+
+/*************************************************************************************
+ *@class TrackStream
+ *@description
+ *    The road of an endless track, generated by a TrackGenerator in chunks of
+ *    TRACKCHUNKSEGMENTS segments. The chunks live in a ring: advance generates
+ *    them up to TRACKSTREAMAHEAD ahead of the furthest car and releases the
+ *    ones the last car has left behind, so the memory taken depends on how far
+ *    the field is spread out and not on how far it went.
+ *
+ *    Segments are numbered from the start of the road and each chunk keeps the
+ *    start and lateral center of its segments, the way Track does for a lap;
+ *    an endless track is a single lap that never ends. Positions ahead of what
+ *    was generated are generated first, positions behind what was released are
+ *    not allowed. Positions are Int like everywhere else, the road ends after
+ *    about 2^31 units.
+ *************************************************************************************/
+class TrackStream
+{
+public:
+    struct Chunk
+    {
+        Track::Definition   definition[TRACKCHUNKSEGMENTS];
+        UInt                start[TRACKCHUNKSEGMENTS + 1];
+        UInt                center[TRACKCHUNKSEGMENTS + 1];
+    };
+
+public:
+    TrackStream(UInt seed);
+    virtual ~TrackStream( );
+
+public:
+    void        advance(Int last, Int first);
+    UInt        locate(Int position);
+    UInt        segmentAt(Int position);
+    const Track::Definition& definition(UInt segment)   { return chunk(segment).definition[segment & (TRACKCHUNKSEGMENTS - 1)]; }
+    UInt        segmentStart(UInt segment)  { return chunk(segment).start[segment & (TRACKCHUNKSEGMENTS - 1)];  }
+    UInt        segmentCenter(UInt segment) { return chunk(segment).center[segment & (TRACKCHUNKSEGMENTS - 1)]; }
+    Track::NoiseZone noiseZone(UInt segment);
+    UInt        seed( )                     { return m_generator.seed( );           }
+    UInt        firstSegment( )             { return m_first << TRACKCHUNKSHIFT;    }
+    UInt        endSegment( )               { return m_end << TRACKCHUNKSHIFT;      }
+    UInt        nChunks( )                  { return m_end - m_first;               }
+    UInt        capacity( )                 { return m_capacity;                    }
+    UInt        memory( )                   { return sizeof(TrackStream) + m_capacity*sizeof(Chunk); }
+
+private:
+    Chunk&      chunk(UInt segment);
+    void        generate( );
+    void        grow( );
+    UInt        search(const Chunk& chunk, UInt pos);
+
+private:
+    TrackGenerator      m_generator;
+    Chunk*              m_ring;
+    UInt                m_capacity;
+    UInt                m_first;            // number of the oldest chunk kept
+    UInt                m_end;              // one past the number of the newest chunk
+    UInt                m_segment;          // segment of the last locate
+};
+
+
+#endif /* __RACING_TRACKSTREAM_H__ */
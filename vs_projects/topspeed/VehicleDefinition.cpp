@@ -0,0 +1,290 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "VehicleDefinition.h"
+#include "Game.h"
+#include <stdio.h>
+
+#define NVEHICLES 12
+
+// a field of the file and where it goes, either a number or a sound
+struct VehicleField
+{
+    const Char*                     name;
+    UInt                            length;
+    Int VehicleDefinition::*        value;
+    Int                             defaultValue;
+    Char (VehicleDefinition::*      sound)[VEHICLESTRINGSIZE];
+    const Char*                     defaultSound;
+};
+
+static const VehicleField vehicleFields[] =
+{
+    { "acceleration",   12, &VehicleDefinition::acceleration,   10,     NULL, NULL },
+    { "deceleration",   12, &VehicleDefinition::deceleration,   40,     NULL, NULL },
+    { "topspeed",        8, &VehicleDefinition::topspeed,       15000,  NULL, NULL },
+    { "idlefreq",        8, &VehicleDefinition::idlefreq,       11000,  NULL, NULL },
+    { "topfreq",         7, &VehicleDefinition::topfreq,        50000,  NULL, NULL },
+    { "shiftfreq",       9, &VehicleDefinition::shiftfreq,      40000,  NULL, NULL },
+    { "numberofgears",  13, &VehicleDefinition::gears,          5,      NULL, NULL },
+    { "steering",        8, &VehicleDefinition::steering,       100,    NULL, NULL },
+    { "steeringfactor", 14, &VehicleDefinition::steeringFactor, 40,     NULL, NULL },
+    { "haswipers",       9, &VehicleDefinition::hasWipers,      1,      NULL, NULL },
+    { "enginesound",    11, NULL, 0, &VehicleDefinition::engineSound,   "builtin1" },
+    { "throttlesound",  13, NULL, 0, &VehicleDefinition::throttleSound, ""         },
+    { "startsound",     10, NULL, 0, &VehicleDefinition::startSound,    "builtin1" },
+    { "hornsound",       9, NULL, 0, &VehicleDefinition::hornSound,     "builtin1" },
+    { "backfiresound",  13, NULL, 0, &VehicleDefinition::backfireSound, ""         },
+    { "crashsound",     10, NULL, 0, &VehicleDefinition::crashSound,    "builtin1" },
+    { "brakesound",     10, NULL, 0, &VehicleDefinition::brakeSound,    "builtin1" }
+};
+#define NVEHICLEFIELDS  (sizeof(vehicleFields) / sizeof(vehicleFields[0]))
+
+struct VehicleCacheSlot
+{
+    Char                path[MAX_PATH];
+    UHuge               size;
+    UHuge               modified;
+    Boolean             used;
+    VehicleDefinition   definition;
+};
+
+static VehicleCacheSlot _vehicleCache[VEHICLECACHESIZE];
+static UInt             _nextVehicleSlot = 0;
+
+
+static Boolean
+isBlank(Char c)
+{
+    return (c == ' ') || (c == '\t');
+}
+
+
+Boolean
+VehicleDefinition::parseNumber(const Char* value, UInt length, Int& result)
+{
+    UInt i = 0;
+    while ((i < length) && isBlank(value[i]))
+        ++i;
+    Boolean negative = false;
+    if ((i < length) && ((value[i] == '-') || (value[i] == '+')))
+        negative = (value[i++] == '-');
+    UInt  digits = 0;
+    Huge  number = 0;
+    for ( ; (i < length) && (value[i] >= '0') && (value[i] <= '9'); ++i, ++digits)
+        if (number <= 2147483648LL)
+            number = number*10 + (value[i] - '0');
+    while ((i < length) && isBlank(value[i]))
+        ++i;
+    if ((digits == 0) || (i < length) || (number > (negative ? 2147483648LL : 2147483647LL)))
+        return false;
+    result = Int(negative ? -number : number);
+    return true;
+}
+
+
+VehicleDefinition::VehicleDefinition( )
+{
+    reset( );
+}
+
+
+VehicleDefinition::~VehicleDefinition( )
+{
+}
+
+
+void
+VehicleDefinition::reset( )
+{
+    for (UInt i = 0; i < NVEHICLEFIELDS; ++i)
+    {
+        const VehicleField& field = vehicleFields[i];
+        if (field.value)
+            this->*field.value = field.defaultValue;
+        else
+            ::strcpy(this->*field.sound, field.defaultSound);
+    }
+    m_nErrors   = 0;
+    m_errorLine = 0;
+    m_error[0]  = '\0';
+}
+
+
+Boolean
+VehicleDefinition::read(const Char* filename)
+{
+    reset( );
+    FILE* file = ::fopen(filename, "rb");
+    if (file == NULL)
+    {
+        reportError(filename, 0, "file", "could not be opened");
+        return false;
+    }
+    ::fseek(file, 0, SEEK_END);
+    long size = ::ftell(file);
+    ::fseek(file, 0, SEEK_SET);
+    if ((size < 0) || (size > VEHICLEMAXFILESIZE))
+    {
+        ::fclose(file);
+        reportError(filename, 0, "file", "too big to be a vehicle");
+        return false;
+    }
+    Char* text = new Char[size + 1];
+    Boolean complete = (::fread(text, 1, size, file) == UInt(size));
+    ::fclose(file);
+    if (complete)
+        parse(text, UInt(size), filename);
+    else
+        reportError(filename, 0, "file", "could not be read");
+    SAFE_DELETE_ARRAY(text);
+    return complete;
+}
+
+
+void
+VehicleDefinition::parse(const Char* text, UInt size, const Char* name)
+{
+    reset( );
+    UInt seen = 0;
+    UInt lineNumber = 1;
+    const Char* end = text + size;
+    while (text < end)
+    {
+        const Char* newline = (const Char*)::memchr(text, '\n', end - text);
+        const Char* lineEnd = newline ? newline : end;
+        UInt length = UInt(lineEnd - text);
+        if ((length > 0) && (text[length - 1] == '\r'))
+            --length;
+        parseLine(text, length, lineNumber, seen, name);
+        text = newline ? newline + 1 : end;
+        ++lineNumber;
+    }
+}
+
+
+const VehicleDefinition*
+VehicleDefinition::cached(const Char* filename)
+{
+    static VehicleDefinition unreadable;
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!::GetFileAttributesEx(filename, GetFileExInfoStandard, &attributes))
+    {
+        unreadable.read(filename);
+        return &unreadable;
+    }
+    UHuge size     = (UHuge(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+    UHuge modified = (UHuge(attributes.ftLastWriteTime.dwHighDateTime) << 32)
+                     | attributes.ftLastWriteTime.dwLowDateTime;
+
+    VehicleCacheSlot* slot = NULL;
+    for (UInt i = 0; (i < VEHICLECACHESIZE) && (slot == NULL); ++i)
+        if ((_vehicleCache[i].used) && (::_stricmp(_vehicleCache[i].path, filename) == 0))
+            slot = &_vehicleCache[i];
+    if ((slot != NULL) && (slot->size == size) && (slot->modified == modified))
+        return &slot->definition;
+    if (slot == NULL)
+    {
+        slot = &_vehicleCache[_nextVehicleSlot];
+        _nextVehicleSlot = (_nextVehicleSlot + 1) % VEHICLECACHESIZE;
+    }
+    RACE("VehicleDefinition::cached : reading %s", filename);
+    _snprintf(slot->path, sizeof(slot->path) - 1, "%s", filename);
+    slot->path[sizeof(slot->path) - 1] = '\0';
+    slot->size     = size;
+    slot->modified = modified;
+    slot->used     = slot->definition.read(filename);
+    return &slot->definition;
+}
+
+
+void
+VehicleDefinition::clearCache( )
+{
+    for (UInt i = 0; i < VEHICLECACHESIZE; ++i)
+        _vehicleCache[i].used = false;
+    _nextVehicleSlot = 0;
+}
+
+
+void
+VehicleDefinition::parseLine(const Char* line, UInt length, UInt lineNumber, UInt& seen, const Char* name)
+{
+    UInt first = 0;
+    while ((first < length) && isBlank(line[first]))
+        ++first;
+    if ((first == length) || (line[first] == ';'))
+        return;
+    const Char* equals = (const Char*)::memchr(line, '=', length);
+    if (equals == NULL)
+    {
+        reportError(name, lineNumber, "line", "has no '='");
+        return;
+    }
+    UInt keyLength = UInt(equals - line);
+    const Char* value = equals + 1;
+    UInt valueLength = length - keyLength - 1;
+
+    for (UInt i = 0; i < NVEHICLEFIELDS; ++i)
+    {
+        const VehicleField& field = vehicleFields[i];
+        if ((field.length != keyLength) || (::memcmp(field.name, line, keyLength) != 0))
+            continue;
+        if (seen & (1 << i))
+        {
+            reportError(name, lineNumber, field.name, "named again, the first value counts");
+            return;
+        }
+        seen |= (1 << i);
+        if (field.value)
+        {
+            if (!parseNumber(value, valueLength, this->*field.value))
+                reportError(name, lineNumber, field.name, "is not a number");
+            return;
+        }
+
+        if (valueLength >= VEHICLESTRINGSIZE)
+        {
+            reportError(name, lineNumber, field.name, "is too long");
+            return;
+        }
+        for (UInt j = 0; j < valueLength; ++j)
+        {
+            if (UByte(value[j]) < ' ')
+            {
+                reportError(name, lineNumber, field.name, "is not a name");
+                return;
+            }
+        }
+        // Car takes the n-th built-in vehicle for "builtin<n>" without looking
+        if ((valueLength >= 7) && (::memcmp(value, "builtin", 7) == 0))
+        {
+            Int vehicle;
+            if ((valueLength == 7) || (value[7] < '0') || (value[7] > '9')
+                || (!parseNumber(value + 7, valueLength - 7, vehicle)) || (vehicle < 1) || (vehicle > NVEHICLES))
+            {
+                reportError(name, lineNumber, field.name, "is not a built-in sound");
+                return;
+            }
+        }
+        ::memcpy(this->*field.sound, value, valueLength);
+        (this->*field.sound)[valueLength] = '\0';
+        return;
+    }
+    reportError(name, lineNumber, "field", "is not one of a vehicle");
+}
+
+
+void
+VehicleDefinition::reportError(const Char* name, UInt lineNumber, const Char* what, const Char* message)
+{
+    RACE("(!) VehicleDefinition : %s(%u) : %s %s", name, lineNumber, what, message);
+    if (m_nErrors++ > 0)
+        return;
+    m_errorLine = lineNumber;
+    _snprintf(m_error, sizeof(m_error) - 1, "%s %s", what, message);
+    m_error[sizeof(m_error) - 1] = '\0';
+}
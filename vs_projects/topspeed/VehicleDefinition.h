@@ -0,0 +1,93 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_VEHICLEDEFINITION_H__
+#define __RACING_VEHICLEDEFINITION_H__
+
+#include "Track.h"
+
+// longest sound name, terminator included, as Car keeps them
+#define VEHICLESTRINGSIZE   64
+// longest description of an error
+#define VEHICLEERRORSIZE    128
+// bigger files are not vehicles, they are not read at all
+#define VEHICLEMAXFILESIZE  65536
+// definitions the cache keeps, after that the oldest one is parsed over
+#define VEHICLECACHESIZE    32
+
+
+/*************************************************************************************
+ *@class VehicleDefinition
+ *@description
+ *    A custom vehicle file (.vhc) read in a single pass. Every line holding
+ *    "field=value" sets the field it names, the first time it is named; the
+ *    fields are the ones Car reads, with the same defaults when a file leaves
+ *    them out. Lines starting with ';' are comments.
+ *
+ *    What is wrong with a file is reported by line: lines without '=', fields
+ *    nobody reads, numbers that are not numbers, names too long to keep and
+ *    built-in sounds that do not exist. The field keeps its default then, and
+ *    the file is still used. The first error is kept with its line, all of
+ *    them go to the trace.
+ *
+ *    cached keeps the definitions that were read, by path, size and time of
+ *    the last write of the file, so cars reading the same file again do not
+ *    parse it again until it changes. The cache belongs to the thread running
+ *    the races; whoever needs a definition for long copies it.
+ *************************************************************************************/
+class VehicleDefinition
+{
+public:
+    VehicleDefinition( );
+    virtual ~VehicleDefinition( );
+
+public:
+    void            reset( );
+    Boolean         read(const Char* filename);
+    void            parse(const Char* text, UInt size, const Char* name = "");
+
+    UInt            nErrors( ) const            { return m_nErrors;     }
+    UInt            errorLine( ) const          { return m_errorLine;   }
+    const Char*     error( ) const              { return m_error;       }
+
+public:
+    static const VehicleDefinition* cached(const Char* filename);
+    static void     clearCache( );
+    // a number the way atoi reads it, but all of the value has to be one
+    static Boolean  parseNumber(const Char* value, UInt length, Int& result);
+
+public:
+    Int             acceleration;
+    Int             deceleration;
+    Int             topspeed;
+    Int             idlefreq;
+    Int             topfreq;
+    Int             shiftfreq;
+    Int             gears;
+    Int             steering;
+    Int             steeringFactor;
+    Int             hasWipers;
+    // "builtin<n>" for the sound of the n-th built-in vehicle, otherwise a file in Vehicles
+    Char            engineSound[VEHICLESTRINGSIZE];
+    Char            throttleSound[VEHICLESTRINGSIZE];
+    Char            startSound[VEHICLESTRINGSIZE];
+    Char            hornSound[VEHICLESTRINGSIZE];
+    Char            backfireSound[VEHICLESTRINGSIZE];
+    Char            crashSound[VEHICLESTRINGSIZE];
+    Char            brakeSound[VEHICLESTRINGSIZE];
+
+private:
+    void            parseLine(const Char* line, UInt length, UInt lineNumber, UInt& seen, const Char* name);
+    void            reportError(const Char* name, UInt lineNumber, const Char* what, const Char* message);
+
+private:
+    UInt            m_nErrors;
+    UInt            m_errorLine;
+    Char            m_error[VEHICLEERRORSIZE];
+};
+
+
+#endif /* __RACING_VEHICLEDEFINITION_H__ */
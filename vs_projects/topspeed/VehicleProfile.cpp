@@ -0,0 +1,249 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#include "VehicleProfile.h"
+#include "Car.h"
+#include "Game.h"
+#include <math.h>
+
+#define NVEHICLES 12
+
+extern Car::Parameters vehicles[NVEHICLES];
+
+
+// a slope in fixed point, absurd vehicle files are kept from overflowing it
+static Int
+fixedSlope(Double rise, Double run)
+{
+    Double slope = floor(rise * (1 << PROFILESHIFT) / run + 0.5);
+    if (slope > 2147483647.0)
+        return 2147483647;
+    if (slope < -2147483647.0)
+        return -2147483647;
+    return Int(slope);
+}
+
+
+VehicleProfile::VehicleProfile( )
+{
+    build(15000, 5, 11000, 50000, 40000);
+}
+
+
+VehicleProfile::VehicleProfile(Int topspeed, Int gears, Int idlefreq, Int topfreq, Int shiftfreq)
+{
+    build(topspeed, gears, idlefreq, topfreq, shiftfreq);
+}
+
+
+VehicleProfile::~VehicleProfile( )
+{
+}
+
+
+void
+VehicleProfile::build(Int topspeed, Int gears, Int idlefreq, Int topfreq, Int shiftfreq)
+{
+    if ((gears < 1) || (gears > PROFILEMAXGEARS))
+    {
+        RACE("(!) VehicleProfile::build : %d gears, using %d", gears, (gears < 1) ? 1 : PROFILEMAXGEARS);
+        gears = (gears < 1) ? 1 : PROFILEMAXGEARS;
+    }
+    m_topspeed  = topspeed;
+    m_gears     = gears;
+    m_idlefreq  = idlefreq;
+    m_topfreq   = topfreq;
+    m_shiftfreq = shiftfreq;
+
+    // automatic: the engine idles through the first two ranges, after that
+    // every range is a gear up to the top one
+    m_range   = topspeed / (gears + 1);
+    if (m_range < 1)
+        m_range = 1;
+    m_idleEnd = 2*m_range;
+    m_idle    = fixedSlope(topfreq - idlefreq, 2.0*m_range);
+    // the first speed into a gear the formula no longer counts as just shifted
+    m_shiftEnd = Int(ceil(0.07*m_range));
+    while ((m_shiftEnd > 0) && (Float(m_shiftEnd - 1) / Float(m_range) >= 0.07f))
+        --m_shiftEnd;
+    while (Float(m_shiftEnd) / Float(m_range) < 0.07f)
+        ++m_shiftEnd;
+    m_fall = fixedSlope(topfreq - shiftfreq, 0.07*m_range);
+    m_rise = fixedSlope(topfreq - shiftfreq, m_range);
+    m_rangeShift = 0;
+    while ((m_rangeShift < 30) && ((1 << (m_rangeShift + 1)) <= m_range))
+        ++m_rangeShift;
+    m_covered = gears*m_range;
+    for (UInt i = 0; (Int(i) << m_rangeShift) < m_covered; ++i)
+    {
+        Int band = (Int(i) << m_rangeShift) / m_range;
+        m_rangeGear[i]       = UByte(band);
+        m_rangeShiftPoint[i] = (band + 1)*m_range;
+    }
+
+    // manual: the gears are wider, the first climbs to twice the top pitch
+    // and the others peak at two thirds into the gear
+    Int range = topspeed / gears;
+    if (range < 1)
+        range = 1;
+    m_firstLimit = Int((4.0f / 3.0f) * Float(range));
+    m_firstSlope = fixedSlope(3.0*(topfreq - idlefreq), 2.0*range);
+    for (Int g = 2; g <= gears; ++g)
+    {
+        Float shiftPoint = ((2.0f / 3.0f) + Float(g - 1)) * Float(range);
+        m_manualSlope[g] = fixedSlope(topfreq, shiftPoint);
+        m_manualLimit[g] = Int(ceil(2.0*shiftPoint)) + 1;
+    }
+
+    // the pull of a gear falls off like a cosine either side of its center
+    m_manualRange = range;
+    for (Int g = 1; g <= gears; ++g)
+    {
+        m_center[g]      = Float(range) * (Float(g) - 0.82f);
+        m_centerFixed[g] = (Huge(range)*(100*g - 82) << PROFILESPEEDSHIFT)/100;
+    }
+    m_factorScale = PROFILEFACTORSTEPS / Float(range);
+    for (Int i = 0; i <= PROFILEFACTORSIZE; ++i)
+    {
+        Float relSpeedDiff = (i + 0.5f) / PROFILEFACTORSTEPS;
+        if (relSpeedDiff >= PROFILEFACTORLIMIT)
+            relSpeedDiff = PROFILEFACTORLIMIT;
+        Int factor = Int(100.0f*(0.5f + cosf(relSpeedDiff*DirectX::Pi*0.5f)));
+        m_factor[i] = UByte((factor < 5) ? 5 : factor);
+    }
+}
+
+
+Int
+VehicleProfile::gear(Int speed) const
+{
+    if (speed < m_idleEnd)
+        return 0;
+    return band(speed);
+}
+
+
+Int
+VehicleProfile::frequency(Int speed) const
+{
+    Boolean shifted;
+    return frequency(speed, shifted);
+}
+
+
+Int
+VehicleProfile::frequency(Int speed, Boolean& shifted) const
+{
+    shifted = false;
+    if (speed < 0)
+        speed = 0;
+    if (speed < m_idleEnd)
+        return m_idlefreq + Int((Huge(speed)*m_idle) >> PROFILESHIFT);
+    return pitch(band(speed), speed, shifted);
+}
+
+
+Int
+VehicleProfile::frequencyManual(Int gear, Int speed) const
+{
+    if (speed < 0)
+        speed = 0;
+    if (gear <= 1)
+    {
+        if (speed < m_firstLimit)
+            return m_idlefreq + Int((Huge(speed)*m_firstSlope) >> PROFILESHIFT);
+        return m_idlefreq + 2*(m_topfreq - m_idlefreq);
+    }
+    if (gear > m_gears)
+        gear = m_gears;
+    if (speed > m_manualLimit[gear])
+        speed = m_manualLimit[gear];
+    Int frequency = Int((Huge(speed)*m_manualSlope[gear]) >> PROFILESHIFT);
+    if (frequency > 2*m_topfreq)
+        frequency = 2*m_topfreq;
+    if (frequency < m_idlefreq/2)
+        frequency = m_idlefreq/2;
+    return frequency;
+}
+
+
+Int
+VehicleProfile::gearFactor(Int gear, Float speed) const
+{
+    if (gear < 1)
+        gear = 1;
+    if (gear > m_gears)
+        gear = m_gears;
+    Float distance = speed - m_center[gear];
+    if (distance < 0.0f)
+        distance = -distance;
+    Int i = Int(distance*m_factorScale);
+    if (i > PROFILEFACTORSIZE)
+        i = PROFILEFACTORSIZE;
+    return m_factor[i];
+}
+
+
+// the same in whole numbers, for a speed with PROFILESPEEDSHIFT fraction bits
+Int
+VehicleProfile::gearFactorFixed(Int gear, Int speed) const
+{
+    if (gear < 1)
+        gear = 1;
+    if (gear > m_gears)
+        gear = m_gears;
+    Huge distance = Huge(speed) - m_centerFixed[gear];
+    if (distance < 0)
+        distance = -distance;
+    Huge i = distance*PROFILEFACTORSTEPS/(Huge(m_manualRange) << PROFILESPEEDSHIFT);
+    if (i > PROFILEFACTORSIZE)
+        i = PROFILEFACTORSIZE;
+    return m_factor[i];
+}
+
+
+const VehicleProfile&
+VehicleProfile::official(UInt vehicle)
+{
+    static VehicleProfile profiles[NVEHICLES];
+    static Boolean        built = false;
+    if (!built)
+    {
+        for (UInt i = 0; i < NVEHICLES; ++i)
+            profiles[i].build(vehicles[i].topspeed, vehicles[i].gears, vehicles[i].idlefreq,
+                              vehicles[i].topfreq, vehicles[i].shiftfreq);
+        built = true;
+    }
+    if (vehicle >= NVEHICLES)
+        vehicle = 0;
+    return profiles[vehicle];
+}
+
+
+// the pitch within a gear, every gear past the idle ranges is as wide and
+// falls and climbs alike
+Int
+VehicleProfile::pitch(Int gear, Int speed, Boolean& shifted) const
+{
+    Int offset = speed - gear*m_range;
+    if (offset < m_shiftEnd)
+    {
+        // rounded up, so the pitch comes out as the float formula truncated it
+        shifted = true;
+        return m_topfreq - Int((Huge(offset)*m_fall + (1 << PROFILESHIFT) - 1) >> PROFILESHIFT);
+    }
+    return m_shiftfreq + Int((Huge(offset)*m_rise) >> PROFILESHIFT);
+}
+
+
+Int
+VehicleProfile::band(Int speed) const
+{
+    if (speed >= m_covered)
+        return m_gears;
+    UInt i = UInt(speed) >> m_rangeShift;
+    return m_rangeGear[i] + ((speed >= m_rangeShiftPoint[i]) ? 1 : 0);
+}
@@ -0,0 +1,107 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+#ifndef __RACING_VEHICLEPROFILE_H__
+#define __RACING_VEHICLEPROFILE_H__
+
+#include "Track.h"
+
+// gears a profile holds at most, a vehicle file asking for more gets these
+#define PROFILEMAXGEARS     16
+// fraction bits of the frequency slopes
+#define PROFILESHIFT        16
+// entries of the gear factor table per gear width off the center of a gear
+#define PROFILEFACTORSTEPS  256
+// the gear factor no longer changes this many gear widths off the center
+#define PROFILEFACTORLIMIT  1.9f
+#define PROFILEFACTORSIZE   (Int(PROFILEFACTORLIMIT*PROFILEFACTORSTEPS) + 1)
+// fraction bits of the speed gearFactorFixed takes
+#define PROFILESPEEDSHIFT   8
+
+
+/*************************************************************************************
+ *@class VehicleProfile
+ *@description
+ *    The gear and engine pitch math of one vehicle, worked out once when the
+ *    vehicle is defined instead of in every car on every update. Car,
+ *    ComputerPlayer and NetworkPlayer take the gear and frequency of an
+ *    automatic transmission from here, Car that of a manual one and CarPhysics
+ *    the pull of the selected gear.
+ *
+ *    Speed maps to an automatic gear through a table of speed ranges as wide
+ *    as a power of two, none wider than a gear, so a range holds at most one
+ *    shift point. Within a gear the pitch falls off for a moment after the
+ *    shift and then climbs again: both are straight lines, kept as a start and
+ *    a slope in fixed point. The pull of a gear is a cosine of how far the car
+ *    is off its center, kept in a table of PROFILEFACTORSTEPS entries per gear
+ *    width. Frequencies are within a few Hz of what the float formulas gave,
+ *    the pull within one percent. The gear stays at the top one, also for
+ *    the computer and network players, whose own count used to run past it.
+ *
+ *    The profiles of the built-in vehicles are built by official, on first
+ *    use; build that from a single thread before sharing them.
+ *************************************************************************************/
+class VehicleProfile
+{
+public:
+    VehicleProfile( );
+    VehicleProfile(Int topspeed, Int gears, Int idlefreq, Int topfreq, Int shiftfreq);
+    virtual ~VehicleProfile( );
+
+public:
+    void            build(Int topspeed, Int gears, Int idlefreq, Int topfreq, Int shiftfreq);
+
+    // automatic transmission, the gear is 0 while the engine still idles
+    Int             gear(Int speed) const;
+    Int             frequency(Int speed) const;
+    Int             frequency(Int speed, Boolean& shifted) const;
+    // manual transmission
+    Int             frequencyManual(Int gear, Int speed) const;
+    // how well the selected gear pulls, in percent
+    Int             gearFactor(Int gear, Float speed) const;
+    Int             gearFactorFixed(Int gear, Int speed) const;
+
+    Int             topspeed( ) const               { return m_topspeed;    }
+    Int             gears( ) const                  { return m_gears;       }
+
+public:
+    static const VehicleProfile& official(UInt vehicle);
+
+private:
+    Int             band(Int speed) const;
+    Int             pitch(Int gear, Int speed, Boolean& shifted) const;
+
+private:
+    Int                 m_topspeed;
+    Int                 m_gears;
+    Int                 m_idlefreq;
+    Int                 m_topfreq;
+    Int                 m_shiftfreq;
+    // automatic
+    Int                 m_range;        // speed per gear
+    Int                 m_idleEnd;      // speed the engine idles up to
+    Int                 m_idle;         // slope while idling
+    Int                 m_shiftEnd;     // speed into a gear the pitch falls off until
+    Int                 m_fall;         // slopes within a gear, Hz per unit of speed in fixed point
+    Int                 m_rise;
+    UInt                m_rangeShift;   // of the speed ranges of the gear table
+    Int                 m_covered;      // speed up to which the table goes, the top gear after it
+    UByte               m_rangeGear[2*PROFILEMAXGEARS + 2];
+    Int                 m_rangeShiftPoint[2*PROFILEMAXGEARS + 2];
+    // manual
+    Int                 m_firstLimit;   // speed up to which the first gear climbs
+    Int                 m_firstSlope;
+    Int                 m_manualLimit[PROFILEMAXGEARS + 1];
+    Int                 m_manualSlope[PROFILEMAXGEARS + 1];
+    Float               m_center[PROFILEMAXGEARS + 1];
+    Int                 m_manualRange;
+    Huge                m_centerFixed[PROFILEMAXGEARS + 1];     // PROFILESPEEDSHIFT fraction bits
+    Float               m_factorScale;  // table entries per unit of speed
+    UByte               m_factor[PROFILEFACTORSIZE + 1];
+};
+
+
+#endif /* __RACING_VEHICLEPROFILE_H__ */
@@ -0,0 +1,158 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// The curve announcements of a track, checked by replaying recorded speeds
+// through it at frame rates from 20 to 1000 fps.
+
+#include "TrackConv.h"
+#include "RoadCursor.h"
+#include <math.h>
+
+
+
+
+// speed over time, sampled every half second like a recording
+struct SpeedProfile
+{
+    const Char*     name;
+    UInt            nSamples;
+    Int             speed[16];
+};
+
+static const SpeedProfile _speedProfiles[] =
+{
+    { "standing start", 12, { 0, 1500, 3500, 5500, 7500, 9000, 10500, 12000, 13000, 14000, 14500, 15000 } },
+    { "braking for curves", 12, { 12000, 15000, 16000, 9000, 5000, 8000, 13000, 16000, 17000, 6000, 4000, 11000 } },
+    { "flat out", 2, { 40000, 40000 } }
+};
+
+#define CALLLAPS    3
+// as in Track.cpp
+#define CALLLENGTH  3000
+
+
+static Int
+profileSpeed(const SpeedProfile& profile, Double time)
+{
+    // repeats once the samples run out
+    Double at = fmod(time * 2.0, Double(profile.nSamples));
+    UInt i = UInt(at);
+    Double fraction = at - i;
+    return Int(profile.speed[i] + fraction*(profile.speed[(i + 1) % profile.nSamples] - profile.speed[i]));
+}
+
+
+// drives three laps at the given frame rate and returns the segments announced,
+// counted from the start of the race
+static void
+replayCalls(Track* track, const SpeedProfile& profile, UInt fps, Boolean old, std::vector<UInt>& calls)
+{
+    calls.clear( );
+    RoadCursor ahead(track);
+    Int length = Int(track->trackLength( ));
+    Int lastCalled = 0;
+    UInt next = track->segmentAt(14000 % track->length( )) + 1;
+    Double position = 14000.0;
+    Double dt = 1.0 / fps;
+    for (UInt frame = 0; position < CALLLAPS*Double(track->length( )); ++frame)
+    {
+        Int speed = profileSpeed(profile, frame * dt);
+        position += speed * dt;
+        if (!old)
+        {
+            // nextCall hands out the segments in order, find which one it was
+            Track::Road road;
+            if (!track->nextCall(road, Int(position), speed))
+                continue;
+            for (UInt i = 0; i < UInt(length); ++i, ++next)
+            {
+                const Track::Definition& segment = track->definition( )[next % length];
+                if ((segment.type == road.type) && (segment.surface == road.surface) && (segment.length == road.length))
+                    break;
+            }
+            calls.push_back(next++);
+            continue;
+        }
+        // what nextRoad did before the schedule
+        Int aheadPosition = Int(position) + CALLLENGTH + speed/2;
+        Int roadAhead = ahead.segmentAt(aheadPosition);
+        if ((((roadAhead - lastCalled + length) % length) > 0) &&
+            (((roadAhead - lastCalled + length) % length) <= length/2))
+        {
+            calls.push_back(track->lap(aheadPosition)*length - length + roadAhead);
+            lastCalled = roadAhead;
+        }
+    }
+}
+
+
+static Track*
+copyTrack(Track* track)
+{
+    Track::TrackData data;
+    data.userDefined = true;
+    data.weather     = track->weather( );
+    data.ambience    = track->ambience( );
+    data.length      = track->trackLength( );
+    data.definition  = track->definition( );
+    return Track::fromData(data);
+}
+
+
+// every segment announced exactly once per lap, in order and the same at every
+// frame rate; only segments the car drove past before they could be announced
+// are left out
+UInt
+checkCalls(Track* track, const Char* name, UInt& nSkipped, UInt& nRepeated, UInt& nDropped)
+{
+    static const UInt frameRates[] = { 20, 30, 60, 144, 1000 };
+    UInt first = track->segmentAt(14000 % track->length( )) + 1;
+    UInt last  = CALLLAPS*track->trackLength( );
+    UInt nErrors = 0;
+    for (UInt p = 0; p < sizeof(_speedProfiles)/sizeof(_speedProfiles[0]); ++p)
+    {
+        const SpeedProfile& profile = _speedProfiles[p];
+        for (UInt f = 0; f < sizeof(frameRates)/sizeof(frameRates[0]); ++f)
+        {
+            for (UInt old = 0; old < 2; ++old)
+            {
+                std::vector<UInt> calls;
+                Track* fresh = copyTrack(track);
+                replayCalls(fresh, profile, frameRates[f], old != 0, calls);
+                SAFE_DELETE(fresh);
+                std::vector<UInt> made(last + track->trackLength( ) + 1, 0);
+                for (UInt i = 0; i < calls.size( ); ++i)
+                {
+                    if (calls[i] < made.size( ))
+                        ++made[calls[i]];
+                }
+                UInt skipped = 0;
+                UInt repeated = 0;
+                for (UInt segment = first; segment < last; ++segment)
+                {
+                    if (made[segment] == 0)
+                        ++skipped;
+                    else if (made[segment] > 1)
+                        repeated += made[segment] - 1;
+                }
+                if (old)
+                {
+                    nSkipped  += skipped;
+                    nRepeated += repeated;
+                    continue;
+                }
+                nDropped += skipped;
+                if (repeated > 0)
+                {
+                    printf("%s: %s at %u fps repeated %u announcements\n", name, profile.name, frameRates[f], repeated);
+                    ++nErrors;
+                }
+            }
+        }
+    }
+    return nErrors;
+}
@@ -0,0 +1,260 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// The custom file catalog, timed with -catalog against scanning the folders
+// the way the menus did.
+
+#include "TrackConv.h"
+#include "TrackFile.h"
+#include "TrackStream.h"
+#include "Catalog.h"
+#include <algorithm>
+
+// where the catalog benchmark makes its files
+#define CATALOGBENCH        "catalogbench"
+#define CATALOGBENCHTRACKS  CATALOGBENCH "\\Tracks"
+#define CATALOGBENCHVEHICLES CATALOGBENCH "\\Vehicles"
+#define CATALOGBENCHCACHE   CATALOGBENCH "\\Catalog.dat"
+
+
+static Boolean
+sameEntry(const Catalog::Entry& a, const Catalog::Entry& b)
+{
+    return (strcmp(a.path, b.path) == 0) && (strcmp(a.sound, b.sound) == 0)
+           && (a.size == b.size) && (a.modified == b.modified) && (a.kind == b.kind)
+           && (a.valid == b.valid) && (a.hasSound == b.hasSound)
+           && (a.segments == b.segments) && (a.lapLength == b.lapLength)
+           && (a.weather == b.weather) && (a.ambience == b.ambience)
+           && (a.acceleration == b.acceleration) && (a.deceleration == b.deceleration)
+           && (a.topspeed == b.topspeed) && (a.idlefreq == b.idlefreq) && (a.topfreq == b.topfreq)
+           && (a.shiftfreq == b.shiftfreq) && (a.gears == b.gears) && (a.steering == b.steering)
+           && (a.steeringFactor == b.steeringFactor) && (a.hasWipers == b.hasWipers);
+}
+
+
+// a custom track of some 40 segments, one more when it is touched, every 250th
+// without any
+static Boolean
+writeCatalogTrack(UInt i, Boolean touched)
+{
+    Char name[MAX_PATH];
+    _snprintf(name, sizeof(name), "%s\\track%05u.trk", CATALOGBENCHTRACKS, i);
+    name[sizeof(name) - 1] = '\0';
+    TrackGenerator generator(i + 1);
+    UInt length = (i % 250 == 249) ? 0 : 40 + (i % 8) + (touched ? 1 : 0);
+    Track::Definition definition[48];
+    for (UInt s = 0; s < length; ++s)
+        generator.next(definition[s]);
+    return TrackFile::writeText(name, definition, length, Track::Weather(i % 4), Track::Ambience(i % 3));
+}
+
+
+static Boolean
+writeCatalogVehicle(UInt i, Boolean touched)
+{
+    Char name[MAX_PATH];
+    _snprintf(name, sizeof(name), "%s\\vehicle%05u.vhc", CATALOGBENCHVEHICLES, i);
+    name[sizeof(name) - 1] = '\0';
+    FILE* file = fopen(name, "w");
+    if (file == NULL)
+        return false;
+    fprintf(file, "enginesound=builtin%u\nstartsound=builtin1\nhornsound=builtin4\ncrashsound=builtin3\n", 1 + i % 8);
+    fprintf(file, "brakesound=builtin6\nacceleration=%u\ndeceleration=%u\ntopspeed=%u\n",
+            8 + i % 10, 30 + i % 20, 15000 + 10*(i % 1000));
+    fprintf(file, "idlefreq=11025\ntopfreq=%u\nshiftfreq=%u\nnumberofgears=%u\n",
+            50000 + i % 20000, 40000 + i % 10000, 4 + i % 3);
+    fprintf(file, "steering=%u\nsteeringfactor=%u\nhaswipers=%u\n", 100 + i % 150, 30 + i % 70, i % 2);
+    if (touched)
+        fprintf(file, ";touched\n");
+    Boolean result = (ferror(file) == 0);
+    fclose(file);
+    return result;
+}
+
+
+static Boolean
+writeCatalogSound(const Char* directory, const Char* prefix, UInt i)
+{
+    Char name[MAX_PATH];
+    _snprintf(name, sizeof(name), "%s\\%s%05u.wav", directory, prefix, i);
+    name[sizeof(name) - 1] = '\0';
+    FILE* file = fopen(name, "wb");
+    if (file == NULL)
+        return false;
+    fclose(file);
+    return true;
+}
+
+
+static void
+removeCatalogFiles(const Char* directory)
+{
+    Char pattern[MAX_PATH];
+    _snprintf(pattern, sizeof(pattern), "%s\\*", directory);
+    pattern[sizeof(pattern) - 1] = '\0';
+    WIN32_FIND_DATA findFileData;
+    HANDLE findHandle = ::FindFirstFile(pattern, &findFileData);
+    if (findHandle == INVALID_HANDLE_VALUE)
+        return;
+    do
+    {
+        if (findFileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            continue;
+        Char name[MAX_PATH];
+        _snprintf(name, sizeof(name), "%s\\%s", directory, findFileData.cFileName);
+        name[sizeof(name) - 1] = '\0';
+        ::DeleteFile(name);
+    }
+    while (::FindNextFile(findHandle, &findFileData));
+    ::FindClose(findHandle);
+}
+
+
+static void
+removeCatalogBench( )
+{
+    removeCatalogFiles(CATALOGBENCHTRACKS);
+    removeCatalogFiles(CATALOGBENCHVEHICLES);
+    removeCatalogFiles(CATALOGBENCH);
+    ::RemoveDirectory(CATALOGBENCHTRACKS);
+    ::RemoveDirectory(CATALOGBENCHVEHICLES);
+    ::RemoveDirectory(CATALOGBENCH);
+}
+
+
+static Double
+timeScan(Catalog& catalog, UInt nThreads)
+{
+    Huge start = ticks( );
+    catalog.scan(nThreads);
+    return (ticks( ) - start) / ticksPerSec( );
+}
+
+
+Int
+benchCatalog(UInt nFiles)
+{
+    if ((nFiles < 2) || (nFiles > 100000))
+    {
+        printf("the catalog is benchmarked with 2 to 100000 files\n");
+        return 2;
+    }
+    removeCatalogBench( );
+    ::CreateDirectory(CATALOGBENCH, NULL);
+    ::CreateDirectory(CATALOGBENCHTRACKS, NULL);
+    ::CreateDirectory(CATALOGBENCHVEHICLES, NULL);
+    // every 100th file has no sound
+    UInt nTracks   = nFiles / 2;
+    UInt nVehicles = nFiles - nTracks;
+    UInt nInvalid  = 0;
+    UInt nSilent   = 0;
+    Boolean written = true;
+    for (UInt i = 0; written && (i < nTracks); ++i)
+    {
+        written = writeCatalogTrack(i, false);
+        if (i % 250 == 249)
+            ++nInvalid;
+        if (i % 100 == 99)
+            ++nSilent;
+        else
+            written = written && writeCatalogSound(CATALOGBENCHTRACKS, "track", i);
+    }
+    for (UInt i = 0; written && (i < nVehicles); ++i)
+    {
+        written = writeCatalogVehicle(i, false);
+        if (i % 100 == 99)
+            ++nSilent;
+        else
+            written = written && writeCatalogSound(CATALOGBENCHVEHICLES, "vehicle", i);
+    }
+    if (!written)
+    {
+        printf("could not write the files in %s\n", CATALOGBENCH);
+        removeCatalogBench( );
+        return 1;
+    }
+    SYSTEM_INFO system;
+    ::GetSystemInfo(&system);
+    UInt nThreads = (std::min)(UInt(system.dwNumberOfProcessors), UInt(CATALOGTHREADS));
+
+    // cold, on one thread and on all of them
+    Catalog single(CATALOGBENCHTRACKS, CATALOGBENCHVEHICLES, CATALOGBENCHCACHE);
+    Double coldSingle = timeScan(single, 1);
+    ::DeleteFile(CATALOGBENCHCACHE);
+    Catalog cold(CATALOGBENCHTRACKS, CATALOGBENCHVEHICLES, CATALOGBENCHCACHE);
+    Double coldParallel = timeScan(cold, nThreads);
+    UInt nErrors = 0;
+    UInt nFound = 0;
+    UInt nBad = 0;
+    UInt nQuiet = 0;
+    for (UInt i = 0; i < cold.nTracks( ) + cold.nVehicles( ); ++i)
+    {
+        const Catalog::Entry& entry = (i < cold.nTracks( )) ? cold.track(i) : cold.vehicle(i - cold.nTracks( ));
+        const Catalog::Entry& other = (i < single.nTracks( )) ? single.track(i) : single.vehicle(i - single.nTracks( ));
+        if (!sameEntry(entry, other))
+            ++nErrors;
+        nBad   += entry.valid ? 0 : 1;
+        nQuiet += entry.hasSound ? 0 : 1;
+        ++nFound;
+    }
+    if ((cold.nTracks( ) != nTracks) || (cold.nVehicles( ) != nVehicles) || (nBad != nInvalid) || (nQuiet != nSilent))
+    {
+        printf("cold scan found %u tracks, %u vehicles, %u invalid, %u without sound; expected %u, %u, %u, %u\n",
+               cold.nTracks( ), cold.nVehicles( ), nBad, nQuiet, nTracks, nVehicles, nInvalid, nSilent);
+        ++nErrors;
+    }
+
+    // warm, everything from the cache
+    Catalog warm(CATALOGBENCHTRACKS, CATALOGBENCHVEHICLES, CATALOGBENCHCACHE);
+    Double warmScan = timeScan(warm, nThreads);
+    if (warm.nParsed( ) != 0)
+    {
+        printf("warm scan parsed %u files\n", warm.nParsed( ));
+        ++nErrors;
+    }
+    for (UInt i = 0; (i < cold.nTracks( )) && (i < warm.nTracks( )); ++i)
+        nErrors += sameEntry(cold.track(i), warm.track(i)) ? 0 : 1;
+    for (UInt i = 0; (i < cold.nVehicles( )) && (i < warm.nVehicles( )); ++i)
+        nErrors += sameEntry(cold.vehicle(i), warm.vehicle(i)) ? 0 : 1;
+
+    // 1% of the files changed, only those are parsed again
+    UInt nTouched = 0;
+    for (UInt i = 0; i < nTracks; i += 200)
+    {
+        writeCatalogTrack(i, true);
+        ++nTouched;
+    }
+    for (UInt i = 0; i < nVehicles; i += 200)
+    {
+        writeCatalogVehicle(i, true);
+        ++nTouched;
+    }
+    Catalog touched(CATALOGBENCHTRACKS, CATALOGBENCHVEHICLES, CATALOGBENCHCACHE);
+    Double touchedScan = timeScan(touched, nThreads);
+    if (touched.nParsed( ) != nTouched)
+    {
+        printf("scan after touching %u files parsed %u\n", nTouched, touched.nParsed( ));
+        ++nErrors;
+    }
+    for (UInt i = 0; i < touched.nTracks( ); i += 200)
+    {
+        if (touched.track(i).segments != cold.track(i).segments + 1)
+            ++nErrors;
+    }
+
+    printf("catalog: %u tracks, %u vehicles, %u invalid, %u without sound\n",
+           nTracks, nVehicles, nInvalid, nSilent);
+    printf("cold   : %.1f ms on 1 thread, %.1f ms on %u threads, %.1f us per file\n",
+           1e3 * coldSingle, 1e3 * coldParallel, nThreads, 1e6 * coldParallel / nFound);
+    printf("warm   : %.1f ms, %.1f us per file, %.1fx faster than cold\n",
+           1e3 * warmScan, 1e6 * warmScan / nFound, coldParallel / warmScan);
+    printf("touched: %.1f ms with %u of %u files parsed again\n",
+           1e3 * touchedScan, touched.nParsed( ), nFound);
+    printf("%u errors\n", nErrors);
+    removeCatalogBench( );
+    return (nErrors == 0) ? 0 : 1;
+}
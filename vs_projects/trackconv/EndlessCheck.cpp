@@ -0,0 +1,316 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// The road of endless tracks, checked against the lap track it is made of
+// and timed with -endless.
+
+#include "TrackConv.h"
+#include "TrackFile.h"
+#include "TrackStream.h"
+#include <algorithm>
+
+// speed is in hundredths of km/h and a car moves by its speed every second
+#define KILOMETER           360000
+// as far as an Int position goes
+#define ENDLESSMAXKM        5000
+// segments generated by each check of the generator
+#define ENDLESSSEGMENTS     200000
+// segments of the lap track an endless track is compared with, some 150 km
+#define ENDLESSLAPSEGMENTS  2000
+
+
+static Boolean
+sameDefinition(const Track::Definition& a, const Track::Definition& b)
+{
+    return (a.type == b.type) && (a.surface == b.surface) && (a.noise == b.noise) && (a.length == b.length);
+}
+
+
+// the rules TrackGenerator promises, checked on what it made
+static UInt
+checkRules(TrackGenerator& generator, UInt nSegments)
+{
+    UInt nErrors = 0;
+    UInt nCurves = 0;
+    UInt nStraights = 0;
+    UInt lastNoise = 0;
+    Boolean noised = false;
+    Track::Surface surface = Track::asphalt;
+    Track::Definition previous;
+    for (UInt i = 0; i < nSegments; ++i)
+    {
+        Track::Definition segment;
+        generator.next(segment);
+        UInt s = TrackGenerator::severity(segment.type);
+        Int  d = TrackGenerator::direction(segment.type);
+        UInt ps = (i > 0) ? TrackGenerator::severity(previous.type) : 0;
+        Int  pd = (i > 0) ? TrackGenerator::direction(previous.type) : 0;
+        nCurves    = (s > 0) ? nCurves + 1 : 0;
+        nStraights = (s == 0) ? nStraights + 1 : 0;
+        const Char* broken = NULL;
+        if (segment.length < MINPARTLENGTH)
+            broken = "too short";
+        else if ((i == 0) && ((s != 0) || (segment.length < GENERATORSTARTLENGTH)))
+            broken = "no room to start";
+        else if ((ps == 4) && (s != 0))
+            broken = "no straight after a hairpin";
+        else if ((s == 4) && (ps != 0) && ((ps != 3) || (pd != d)))
+            broken = "hairpin after a curve that is not hard";
+        else if ((s > 0) && (ps > 0) && (d == pd) && ((s + 1 < ps) || (ps + 1 < s)))
+            broken = "curve tightens or opens up too fast";
+        else if ((s > 0) && (ps > 0) && (d != pd) && ((ps != 1) || (s > 2)))
+            broken = "turns the other way too sharply";
+        else if (nCurves > GENERATORMAXCURVES)
+            broken = "too many curves in a row";
+        else if (nStraights > 2)
+            broken = "three straights in a row";
+        else if ((segment.surface == Track::water) && ((s != 0) || (segment.length > 10000)))
+            broken = "water off a short straight";
+        else if ((segment.surface != Track::water) && (segment.surface != surface) && (s != 0))
+            broken = "surface changes in a curve";
+        else if ((segment.noise != Track::noNoise) && (s != 0))
+            broken = "noise in a curve";
+        else if ((segment.noise != Track::noNoise) && (noised) && (i - lastNoise <= GENERATORNOISEGAP))
+            broken = "noises too close";
+        if (broken != NULL)
+        {
+            printf("seed %u, segment %u: %s\n", generator.seed( ), i, broken);
+            if (++nErrors > 10)
+                return nErrors;
+        }
+        if (segment.surface != Track::water)
+            surface = segment.surface;
+        if (segment.noise != Track::noNoise)
+        {
+            noised = true;
+            lastNoise = i;
+        }
+        previous = segment;
+    }
+    return nErrors;
+}
+
+
+// the same seed gives the same road, the road follows the rules, and an endless
+// track drives like a lap track of the same segments while it keeps only the
+// chunks the cars are on
+UInt
+checkEndless( )
+{
+    UInt nErrors = 0;
+    TrackGenerator a(1234);
+    TrackGenerator b(1234);
+    TrackGenerator c(1235);
+    UInt nSame = 0;
+    for (UInt i = 0; i < ENDLESSSEGMENTS; ++i)
+    {
+        Track::Definition x, y, z;
+        a.next(x);
+        b.next(y);
+        c.next(z);
+        if ((!sameDefinition(x, y)) && (++nErrors <= 10))
+            printf("seed 1234: segment %u differs between two generators\n", i);
+        nSame += sameDefinition(x, z) ? 1 : 0;
+    }
+    if (nSame == ENDLESSSEGMENTS)
+    {
+        printf("seeds 1234 and 1235 give the same road\n");
+        ++nErrors;
+    }
+    a.reset(1234);
+    TrackGenerator d(1234);
+    for (UInt i = 0; i < ENDLESSSEGMENTS; ++i)
+    {
+        Track::Definition x, y;
+        a.next(x);
+        d.next(y);
+        if ((!sameDefinition(x, y)) && (++nErrors <= 10))
+            printf("seed 1234: segment %u differs after a reset\n", i);
+    }
+    static const UInt seeds[] = { 0, 1, 2, 42, 0xdeadbeef };
+    for (UInt i = 0; i < sizeof(seeds)/sizeof(seeds[0]); ++i)
+    {
+        TrackGenerator generator(seeds[i]);
+        nErrors += checkRules(generator, ENDLESSSEGMENTS);
+    }
+
+    // a lap track of the first segments the endless track will generate
+    std::vector<Track::Definition> definition(ENDLESSLAPSEGMENTS);
+    TrackGenerator generator(99);
+    for (UInt i = 0; i < ENDLESSLAPSEGMENTS; ++i)
+        generator.next(definition[i]);
+    Track::TrackData data;
+    data.userDefined = true;
+    data.weather     = Track::sunny;
+    data.ambience    = Track::noAmbience;
+    data.length      = ENDLESSLAPSEGMENTS;
+    data.definition  = &definition[0];
+    Track* lap = Track::fromData(data);
+    Track* endless = Track::fromSeed(99);
+    Track* unstreamed = Track::fromSeed(99);
+
+    // eight cars racing most of the lap, the first of them the player
+    UInt random = 1;
+    Int positions[8];
+    for (UInt i = 0; i < 8; ++i)
+        positions[i] = 14000 - 1500*i;
+    Int end = Int(lap->length( )) - 100000;
+    UInt nFrames = 0;
+    UInt nChunks = 0;
+    while ((positions[0] < end) && (nErrors <= 10))
+    {
+        Int last  = positions[0];
+        Int first = positions[0];
+        Int speed = 0;
+        for (UInt i = 0; i < 8; ++i)
+        {
+            Int step = 250 + nextRandom(random, 400);
+            if (i == 0)
+                speed = step*60;
+            positions[i] = (std::min)(positions[i] + step, end);
+            last  = (std::min)(last, positions[i]);
+            first = (std::max)(first, positions[i]);
+        }
+        endless->advance(last, first);
+        nChunks = (std::max)(nChunks, endless->stream( )->nChunks( ));
+        ++nFrames;
+        if (!sameRoad(endless->road(positions[0]), lap->road(positions[0])))
+        {
+            printf("endless: road differs at %d\n", positions[0]);
+            ++nErrors;
+        }
+        Track::Road called, lapCalled;
+        Boolean calls = endless->nextCall(called, positions[0], speed);
+        if ((calls != lap->nextCall(lapCalled, positions[0], speed)) ||
+            ((calls) && ((called.type != lapCalled.type) || (called.length != lapCalled.length))))
+        {
+            printf("endless: announcement differs at %d\n", positions[0]);
+            ++nErrors;
+        }
+        if ((endless->noiseZoneAt(positions[0]) != NONOISEZONE) != (lap->noiseZoneAt(positions[0]) != NONOISEZONE))
+        {
+            printf("endless: noise differs at %d\n", positions[0]);
+            ++nErrors;
+        }
+        for (UInt i = 1; i < 8; ++i)
+        {
+            if (!sameRoad(endless->roadComputer(positions[i]), lap->roadComputer(positions[i])))
+            {
+                printf("endless: roadComputer differs at %d\n", positions[i]);
+                ++nErrors;
+            }
+        }
+        // a track that was never advanced generates what it is asked for
+        Int position = last + Int(nextRandom(random, UInt(first - last) + 1));
+        if (!sameRoad(unstreamed->roadComputer(position), lap->roadComputer(position)))
+        {
+            printf("endless: road differs at %d without advancing\n", position);
+            ++nErrors;
+        }
+    }
+    if (endless->stream( )->firstSegment( ) == 0)
+    {
+        printf("endless: nothing released in %u km\n", UInt(end / KILOMETER));
+        ++nErrors;
+    }
+
+    // a car left at the start holds everything behind the field, so the ring grows
+    // until the car moves on
+    Track* spread = Track::fromSeed(99);
+    spread->advance(0, end);
+    UInt capacity = spread->stream( )->capacity( );
+    for (Int position = 0; (position < end) && (nErrors <= 10); position += 997)
+    {
+        if (!sameRoad(spread->roadComputer(position), lap->roadComputer(position)))
+        {
+            printf("endless: road differs at %d in a grown ring\n", position);
+            ++nErrors;
+        }
+    }
+    spread->advance(end, end);
+    if ((capacity <= TRACKSTREAMCHUNKS) || (spread->stream( )->nChunks( ) > 2))
+    {
+        printf("endless: %u chunks for a spread field, %u once it closed up\n", capacity, spread->stream( )->nChunks( ));
+        ++nErrors;
+    }
+    printf("endless tracks: %u frames driven, at most %u chunks kept\n", nFrames, nChunks);
+    SAFE_DELETE(lap);
+    SAFE_DELETE(endless);
+    SAFE_DELETE(unstreamed);
+    SAFE_DELETE(spread);
+    return nErrors;
+}
+
+
+// the generator alone over the distance, then a field of eight cars racing it at
+// 60 frames per second on an endless track
+Int
+benchEndless(UInt km)
+{
+    if ((km == 0) || (km > ENDLESSMAXKM))
+    {
+        printf("an endless race goes from 1 to %u km\n", ENDLESSMAXKM);
+        return 2;
+    }
+    Double perSec = ticksPerSec( );
+    Int distance = Int(km*KILOMETER);
+    TrackGenerator generator(1);
+    Track::Definition segment;
+    UInt nSegments = 0;
+    Huge generated = 0;
+    Huge start = ticks( );
+    while (generated < Huge(distance))
+    {
+        generator.next(segment);
+        generated += segment.length;
+        ++nSegments;
+    }
+    Double generate = (ticks( ) - start) / perSec;
+    printf("generator: %u segments for %u km in %.1f ms, %.1f million segments/s\n",
+           nSegments, km, 1e3 * generate, nSegments / generate / 1e6);
+    printf("           as a lap track %u bytes of definition and index\n",
+           UInt(nSegments*sizeof(Track::Definition) + 2*(nSegments + 1)*sizeof(UInt)));
+
+    Track* track = Track::fromSeed(1);
+    UInt random = 1;
+    Int positions[8];
+    for (UInt i = 0; i < 8; ++i)
+        positions[i] = 14000 - 1500*i;
+    UInt nFrames = 0;
+    UInt nCalls = 0;
+    UInt nChunks = 0;
+    UInt memory = 0;
+    UInt sum = 0;
+    start = ticks( );
+    while (positions[7] < distance)
+    {
+        Int last  = positions[0];
+        Int first = positions[0];
+        for (UInt i = 0; i < 8; ++i)
+        {
+            positions[i] += 330 + nextRandom(random, 100);
+            last  = (std::min)(last, positions[i]);
+            first = (std::max)(first, positions[i]);
+        }
+        track->advance(last, first);
+        sum += track->road(positions[0]).left;
+        Track::Road road;
+        nCalls += track->nextCall(road, positions[0], 22800) ? 1 : 0;
+        for (UInt i = 1; i < 8; ++i)
+            sum += track->roadComputer(positions[i]).left;
+        nChunks = (std::max)(nChunks, track->stream( )->nChunks( ));
+        memory  = (std::max)(memory, track->stream( )->memory( ));
+        ++nFrames;
+    }
+    Double race = (ticks( ) - start) / perSec;
+    printf("race     : %u frames in %.1f ms, %.1f ns per frame, %u segments generated\n",
+           nFrames, 1e3 * race, 1e9 * race / nFrames, track->stream( )->endSegment( ));
+    printf("           %u announcements, at most %u chunks kept in %u bytes (%u)\n",
+           nCalls, nChunks, memory, sum & 1);
+    SAFE_DELETE(track);
+    return 0;
+}
@@ -0,0 +1,133 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// The noise zones of a track, checked against the noise of the segment
+// under a car driving through it.
+
+#include "TrackConv.h"
+
+
+// drives a car through three laps of the track and compares the noise zones
+// with the noise of the segment under it: the zone changes exactly when the
+// noise does, also at the finish line
+UInt
+checkNoise(Track* track, const Char* name)
+{
+    UInt nErrors = 0;
+    for (UInt i = 0; i < track->nNoiseZones( ); ++i)
+    {
+        const Track::NoiseZone& zone = track->noiseZone(i);
+        Boolean sorted = (i == 0) || (track->noiseZone(i - 1).start + track->noiseZone(i - 1).length <= zone.start);
+        Boolean inLap  = (i + 1 == track->nNoiseZones( )) || (zone.start + zone.length <= track->length( ));
+        if ((!sorted) || (!inLap) || (zone.length > track->length( )))
+        {
+            printf("%s: noise zone %u at %u, %u long, out of order\n", name, i, zone.start, zone.length);
+            ++nErrors;
+        }
+    }
+    Track::Definition* definition = track->definition( );
+    Int previousZone = NONOISEZONE;
+    Track::Noise previousNoise = Track::noNoise;
+    for (UInt position = 0; position < 3*track->length( ); position += 97)
+    {
+        Int zone = track->noiseZoneAt(position);
+        Track::Noise noise = definition[track->segmentAt(position % track->length( ))].noise;
+        Boolean right;
+        if (noise == Track::noNoise)
+            right = (zone == NONOISEZONE);
+        else
+        {
+            right = (zone >= 0) && (UInt(zone) < track->nNoiseZones( ));
+            if (right)
+            {
+                const Track::NoiseZone& current = track->noiseZone(zone);
+                UInt offset = (position % track->length( ) + track->length( ) - current.start) % track->length( );
+                right = (current.noise == noise) && (offset < current.length);
+            }
+        }
+        if ((position > 0) && ((zone != previousZone) != (noise != previousNoise)))
+            right = false;
+        if (!right)
+        {
+            printf("%s: noise zone %d at %u is wrong\n", name, zone, position);
+            if (++nErrors > 10)
+                break;
+        }
+        previousZone  = zone;
+        previousNoise = noise;
+    }
+    return nErrors;
+}
+
+
+static Track*
+noiseTrack(const Track::Noise* noises, UInt nSegments)
+{
+    Track::Definition definition[8];
+    for (UInt i = 0; i < nSegments; ++i)
+    {
+        definition[i].type    = (i % 2) ? Track::easyLeft : Track::straight;
+        definition[i].surface = Track::asphalt;
+        definition[i].noise   = noises[i];
+        definition[i].length  = 500 + 700*i;
+    }
+    Track::TrackData data;
+    data.userDefined = true;
+    data.weather     = Track::sunny;
+    data.ambience    = Track::noAmbience;
+    data.length      = nSegments;
+    data.definition  = definition;
+    return Track::fromData(data);
+}
+
+
+UInt
+checkNoiseZones( )
+{
+    static const Track::Noise crossing[]   = { Track::crowd, Track::noNoise, Track::ocean, Track::crowd, Track::crowd };
+    static const Track::Noise everywhere[] = { Track::clock, Track::clock, Track::clock };
+    static const Track::Noise touching[]   = { Track::crowd, Track::crowd, Track::noNoise, Track::ocean };
+    static const Track::Noise quiet[]      = { Track::noNoise, Track::noNoise };
+    static const Track::Noise oneShots[]   = { Track::jet, Track::noNoise, Track::jet, Track::runway, Track::jet };
+    struct Case
+    {
+        const Char*         name;
+        const Track::Noise* noises;
+        UInt                nSegments;
+        UInt                nZones;
+    };
+    static const Case cases[] =
+    {
+        { "crossing the finish line",   crossing,   5, 2 },
+        { "all around the lap",         everywhere, 3, 1 },
+        { "touching the finish line",   touching,   4, 2 },
+        { "without noise",              quiet,      2, 0 },
+        { "one shots",                  oneShots,   5, 3 }
+    };
+    UInt nErrors = 0;
+    for (UInt i = 0; i < sizeof(cases)/sizeof(cases[0]); ++i)
+    {
+        Track* track = noiseTrack(cases[i].noises, cases[i].nSegments);
+        if (track->nNoiseZones( ) != cases[i].nZones)
+        {
+            printf("%s: %u noise zones, expected %u\n", cases[i].name, track->nNoiseZones( ), cases[i].nZones);
+            ++nErrors;
+        }
+        nErrors += checkNoise(track, cases[i].name);
+        SAFE_DELETE(track);
+    }
+    // a track without segments has no zones and is quiet everywhere
+    Track* track = noiseTrack(quiet, 0);
+    if ((track->nNoiseZones( ) != 0) || (track->noiseZoneAt(0) != NONOISEZONE) ||
+        (track->noiseZoneAt(14000) != NONOISEZONE) || (track->segmentAt(14000) != 0))
+    {
+        printf("empty track: noise zones where there is no road\n");
+        ++nErrors;
+    }
+    SAFE_DELETE(track);
+    return nErrors;
+}
@@ -0,0 +1,583 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// The baked index of the built-in tracks: -registry writes it, -check
+// checks it against the tracks Track builds and runs the checks of every
+// other part of a track over them, -bench times it.
+
+#include "TrackConv.h"
+#include "RoadCursor.h"
+#include <ctype.h>
+#include <algorithm>
+
+// the built-in tracks -bench looks up segments on, the longest ones
+#define BENCHLONGESTTRACKS  3
+// and the segments of the synthetic track it adds to them
+#define BENCHSEGMENTS       100000
+
+
+// "advHills" becomes "_ixAdvHills"
+static void
+indexName(const Char* name, Char* result, UInt size)
+{
+    _snprintf(result, size, "_ix%c%s", toupper(name[0]), name + 1);
+    result[size - 1] = '\0';
+}
+
+
+static Boolean
+bucketLess(const std::vector<UInt>* a, const std::vector<UInt>* b)
+{
+    return a->size( ) > b->size( );
+}
+
+
+// a seed per bucket so every name lands on a slot of its own, largest buckets
+// first while there is still room to choose from
+static Boolean
+findSeeds(UInt* seeds, UByte* slots)
+{
+    std::vector<UInt> buckets[TRACKHASHBUCKETS];
+    for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+        buckets[TrackRegistry::hash(TrackRegistry::entry(i).name, 0) % TRACKHASHBUCKETS].push_back(i);
+    std::vector<const std::vector<UInt>*> order;
+    for (UInt b = 0; b < TRACKHASHBUCKETS; ++b)
+    {
+        seeds[b] = 0;
+        order.push_back(&buckets[b]);
+    }
+    std::stable_sort(order.begin( ), order.end( ), bucketLess);
+
+    Boolean taken[NBUILTINTRACKS];
+    for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+        taken[i] = false;
+    for (UInt o = 0; o < order.size( ); ++o)
+    {
+        const std::vector<UInt>& bucket = *order[o];
+        if (bucket.empty( ))
+            break;
+        UInt b = UInt(&bucket - buckets);
+        Boolean found = false;
+        for (UInt seed = 1; (seed < 1000000) && (!found); ++seed)
+        {
+            UInt slot[NBUILTINTRACKS];
+            found = true;
+            for (UInt i = 0; (i < bucket.size( )) && (found); ++i)
+            {
+                slot[i] = TrackRegistry::hash(TrackRegistry::entry(bucket[i]).name, seed) % NBUILTINTRACKS;
+                if (taken[slot[i]])
+                    found = false;
+                for (UInt j = 0; (j < i) && (found); ++j)
+                {
+                    if (slot[j] == slot[i])
+                        found = false;
+                }
+            }
+            if (!found)
+                continue;
+            seeds[b] = seed;
+            for (UInt i = 0; i < bucket.size( ); ++i)
+            {
+                taken[slot[i]] = true;
+                slots[slot[i]] = UByte(bucket[i]);
+            }
+        }
+        if (!found)
+            return false;
+    }
+    return true;
+}
+
+
+static void
+writeArray(FILE* out, const Char* name, const Char* suffix, Track* track, Boolean start)
+{
+    fprintf(out, "UInt %s%s[] =\n{", name, suffix);
+    for (UInt i = 0; i <= track->trackLength( ); ++i)
+    {
+        if (i % 8 == 0)
+            fprintf(out, (i == 0) ? "\n    " : ",\n    ");
+        else
+            fprintf(out, ", ");
+        fprintf(out, "%u", start ? track->segmentStart(i) : track->segmentCenter(i));
+    }
+    fprintf(out, "\n};\n");
+}
+
+
+Int
+writeRegistry(const Char* target)
+{
+    UInt seeds[TRACKHASHBUCKETS];
+    UByte slots[NBUILTINTRACKS];
+    if (!findSeeds(seeds, slots))
+    {
+        printf("no perfect hash found, change TRACKHASHBUCKETS\n");
+        return 1;
+    }
+    FILE* out = fopen(target, "w");
+    if (out == NULL)
+    {
+        printf("%s: could not write\n", target);
+        return 1;
+    }
+    fprintf(out, "/**\n");
+    fprintf(out, "* Top Speed 3\n");
+    fprintf(out, "* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)\n");
+    fprintf(out, "* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter\n");
+    fprintf(out, "* This program is distributed under the terms of the GNU General Public License version 3.\n");
+    fprintf(out, "*/\n");
+    fprintf(out, "#ifndef __RACING_TRACKINDEX_H__\n");
+    fprintf(out, "#define __RACING_TRACKINDEX_H__\n\n");
+    fprintf(out, "// NEVER INCLUDE THIS FILE IN A HEADER!!\n\n");
+    fprintf(out, "// Generated by 'trackconv -registry' from TrackDefs.h, do not edit.\n");
+    fprintf(out, "// The segment index of every built-in track and the perfect hash of their names.\n\n");
+    for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+    {
+        const TrackRegistry::Entry& entry = TrackRegistry::entry(i);
+        Track* track = buildTrack(entry);
+        Char name[64];
+        indexName(entry.name, name, sizeof(name));
+        fprintf(out, "// %s, %u segments\n", entry.name, track->trackLength( ));
+        writeArray(out, name, "Start", track, true);
+        writeArray(out, name, "Center", track, false);
+        fprintf(out, "const UInt %sLap = %u;\n", name, track->length( ));
+        fprintf(out, "const UInt %sLapCenter = %u;\n\n", name, track->lapCenter( ));
+        SAFE_DELETE(track);
+    }
+    fprintf(out, "// seed of each bucket\n");
+    fprintf(out, "UInt _trackHashSeed[TRACKHASHBUCKETS] =\n{\n    ");
+    for (UInt b = 0; b < TRACKHASHBUCKETS; ++b)
+        fprintf(out, "%u%s", seeds[b], (b + 1 < TRACKHASHBUCKETS) ? ", " : "");
+    fprintf(out, "\n};\n\n");
+    fprintf(out, "// the track at each slot\n");
+    fprintf(out, "UByte _trackHashSlot[NBUILTINTRACKS] =\n{\n    ");
+    for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+        fprintf(out, "%u%s", slots[i], (i + 1 < NBUILTINTRACKS) ? ", " : "");
+    fprintf(out, "\n};\n\n");
+    fprintf(out, "#endif /* __RACING_TRACKINDEX_H__ */\n");
+    Boolean result = (ferror(out) == 0);
+    fclose(out);
+    if (result)
+        printf("%s: %u tracks\n", target, NBUILTINTRACKS);
+    else
+        printf("%s: could not write\n", target);
+    return result ? 0 : 1;
+}
+
+
+Int
+checkRegistry( )
+{
+    UInt nErrors = 0;
+    UInt nSkipped = 0;
+    UInt nRepeated = 0;
+    UInt nDropped = 0;
+    for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+    {
+        const TrackRegistry::Entry& entry = TrackRegistry::entry(i);
+        Track* track = buildTrack(entry);
+        Boolean same = (entry.segmentStart != NULL) && (entry.segmentCenter != NULL) &&
+                       (entry.lapDistance == track->length( )) && (entry.lapCenter == track->lapCenter( ));
+        for (UInt j = 0; (j <= entry.length) && (same); ++j)
+        {
+            same = (entry.segmentStart[j] == track->segmentStart(j)) &&
+                   (entry.segmentCenter[j] == track->segmentCenter(j));
+        }
+        if (!same)
+        {
+            printf("%s: baked index is stale, run trackconv -registry\n", entry.name);
+            ++nErrors;
+        }
+        if (TrackRegistry::find(entry.name) != &entry)
+        {
+            printf("%s: not found by name\n", entry.name);
+            ++nErrors;
+        }
+        Char other[64];
+        _snprintf(other, sizeof(other), "%sx", entry.name);
+        other[sizeof(other) - 1] = '\0';
+        if (TrackRegistry::find(other) != NULL)
+        {
+            printf("%s: found as a built-in track\n", other);
+            ++nErrors;
+        }
+        _snprintf(other, sizeof(other), "%c%s", toupper(entry.name[0]), entry.name + 1);
+        if (TrackRegistry::find(other) != NULL)
+        {
+            printf("%s: found as a built-in track\n", other);
+            ++nErrors;
+        }
+        SAFE_DELETE(track);
+        track = Track::readTrack(entry.name);
+        nErrors += checkNoise(track, entry.name);
+        UInt dropped = 0;
+        nErrors += checkCalls(track, entry.name, nSkipped, nRepeated, dropped);
+        nErrors += checkRoadBatch(track, entry.name);
+        nErrors += checkRoadCursor(track, entry.name);
+        if (dropped > 0)
+        {
+            printf("%s: %u announcements left out\n", entry.name, dropped);
+            ++nErrors;
+        }
+        SAFE_DELETE(track);
+    }
+    nErrors += checkNoiseZones( );
+
+    // a track of short segments, where a fast car looks ahead past several
+    Track::Definition definition[40];
+    for (UInt i = 0; i < 40; ++i)
+    {
+        definition[i].type    = Track::Type(i % 9);
+        definition[i].surface = Track::Surface(i % 3);
+        definition[i].noise   = Track::noNoise;
+        definition[i].length  = 800 + 300*(i % 5);
+    }
+    Track::TrackData data;
+    data.userDefined = true;
+    data.weather     = Track::sunny;
+    data.ambience    = Track::noAmbience;
+    data.length      = 40;
+    data.definition  = definition;
+    Track* track = Track::fromData(data);
+    nErrors += checkCalls(track, "short segments", nSkipped, nRepeated, nDropped);
+    nErrors += checkRoadBatch(track, "short segments");
+    nErrors += checkRoadCursor(track, "short segments");
+    SAFE_DELETE(track);
+
+    // many segments of different lengths, so buckets hold several of them
+    Track::Definition longDefinition[300];
+    for (UInt i = 0; i < 300; ++i)
+    {
+        longDefinition[i].type    = Track::Type((i * 7) % 9);
+        longDefinition[i].surface = Track::asphalt;
+        longDefinition[i].noise   = Track::noNoise;
+        longDefinition[i].length  = 1000 + 377*(i % 11);
+    }
+    data.length     = 300;
+    data.definition = longDefinition;
+    track = Track::fromData(data);
+    nErrors += checkRoadBatch(track, "long track");
+    nErrors += checkRoadCursor(track, "long track");
+    SAFE_DELETE(track);
+
+    // no segments at all, the road the linear search fell back to
+    data.length     = 0;
+    data.definition = longDefinition;
+    track = Track::fromData(data);
+    Int emptyPositions[2] = { 0, 14000 };
+    Track::Road emptyRoads[2];
+    track->roadBatch(emptyPositions, emptyRoads, 2);
+    Track::Road emptyRoad = track->roadComputer(14000);
+    if ((track->segmentAt(14000) != 0) || (track->roadAt(14000) != 0) ||
+        (emptyRoad.length != 5000) || (emptyRoads[1].length != 5000) || (emptyRoad.left != 0))
+    {
+        printf("empty track: not the default road\n");
+        ++nErrors;
+    }
+    SAFE_DELETE(track);
+    printf("curve announcements at 20 to 1000 fps: %u driven past on short segments,\n", nDropped);
+    printf("before the schedule %u skipped and %u repeated\n", nSkipped, nRepeated);
+    static const Char* others[] = { "", "adv", "custom", "tracks\\america", "america.trk" };
+    for (UInt i = 0; i < sizeof(others)/sizeof(others[0]); ++i)
+    {
+        if (TrackRegistry::find(others[i]) != NULL)
+        {
+            printf("\"%s\": found as a built-in track\n", others[i]);
+            ++nErrors;
+        }
+    }
+    nErrors += checkEndless( );
+    printf("%u built-in tracks checked, %u errors\n", NBUILTINTRACKS, nErrors);
+    return (nErrors == 0) ? 0 : 1;
+}
+
+
+// the lookup the way Track and Level did it before, a strcmp per track
+static const TrackRegistry::Entry*
+findLinear(const Char* name)
+{
+    for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+    {
+        if (strcmp(TrackRegistry::entry(i).name, name) == 0)
+            return &TrackRegistry::entry(i);
+    }
+    return NULL;
+}
+
+
+// the road the way roadComputer found it before the index, a walk over the
+// segments of the lap adding up their lengths and curves
+static Track::Road
+roadLinear(Track* track, Int position)
+{
+    UInt lap = (UInt)(position / track->length( ));
+    UInt pos = position % track->length( );
+    UInt dist = 0;
+    UInt center = lap*track->lapCenter( );
+    const Track::Definition* definition = track->definition( );
+    for (UInt i = 0; i < track->trackLength( ); ++i)
+    {
+        if ((dist <= pos) && (dist + definition[i].length > pos))
+            return track->segmentRoad(definition[i], center, pos - dist);
+        center += Track::curveOffset(definition[i].type, definition[i].length);
+        dist += definition[i].length;
+    }
+    Track::Road road = {0, 0, Track::asphalt, Track::straight, 5000};
+    return road;
+}
+
+
+static Boolean
+longerTrack(const std::pair<UInt, UInt>& a, const std::pair<UInt, UInt>& b)
+{
+    return a.first > b.first;
+}
+
+
+// positions all over three laps, the same for both ways of looking them up;
+// the walk gets fewer of them on long tracks, where it takes its time, and so
+// does building the index
+static UInt
+benchLookup(Track* track, const Char* name, UInt rounds)
+{
+    Double perSec = ticksPerSec( );
+    UInt nSegments = track->trackLength( );
+    UInt nIndexed = rounds;
+    UInt nLinear  = (std::max)((std::min)(UInt(Huge(rounds)*100/nSegments), rounds), 1u);
+    UInt nBuilds  = (std::max)((std::min)(UInt(Huge(rounds)*100/nSegments), 1000u), 1u);
+    std::vector<Int> positions(nIndexed);
+    UInt random = 1;
+    for (UInt q = 0; q < nIndexed; ++q)
+    {
+        random = random*1103515245 + 12345;
+        positions[q] = Int(Huge(random >> 1) % (Huge(3)*track->length( )));
+    }
+
+    UInt nErrors = 0;
+    UInt sum = 0;
+    Huge start = ticks( );
+    for (UInt q = 0; q < nLinear; ++q)
+        sum += roadLinear(track, positions[q]).left;
+    Double linear = (ticks( ) - start) / perSec;
+    start = ticks( );
+    for (UInt q = 0; q < nIndexed; ++q)
+        sum += track->roadComputer(positions[q]).left;
+    Double indexed = (ticks( ) - start) / perSec;
+    for (UInt q = 0; q < nLinear; ++q)
+    {
+        Track::Road expected = roadLinear(track, positions[q]);
+        Track::Road road = track->roadComputer(positions[q]);
+        if ((road.left != expected.left) || (road.right != expected.right) || (road.type != expected.type) ||
+            (road.surface != expected.surface) || (road.length != expected.length))
+        {
+            if (nErrors == 0)
+                printf("%s: at %d the index has %d-%d, the walk %d-%d\n", name, positions[q],
+                       road.left, road.right, expected.left, expected.right);
+            ++nErrors;
+        }
+    }
+
+    Track::TrackData data;
+    data.userDefined = true;
+    data.weather     = track->weather( );
+    data.ambience    = track->ambience( );
+    data.length      = nSegments;
+    data.definition  = track->definition( );
+    start = ticks( );
+    for (UInt b = 0; b < nBuilds; ++b)
+    {
+        Track* built = Track::fromData(data);
+        sum += built->length( );
+        SAFE_DELETE(built);
+    }
+    Double build = (ticks( ) - start) / perSec;
+    printf("  %-12s %6u segments %10.1f ns walk %6.1f ns segmentAt %8.1f us indexed (%u)%s\n", name, nSegments,
+           1e9 * linear / nLinear, 1e9 * indexed / nIndexed, 1e6 * build / nBuilds, sum & 1,
+           (nErrors == 0) ? "" : "  FAILED");
+    return nErrors;
+}
+
+
+Int
+benchRegistry(UInt rounds)
+{
+    Double perSec = ticksPerSec( );
+    UInt found = 0;
+    Huge start = ticks( );
+    for (UInt r = 0; r < rounds; ++r)
+    {
+        for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+            found += (TrackRegistry::find(TrackRegistry::entry(i).name) != NULL) ? 1 : 0;
+        found += (TrackRegistry::find("custom") != NULL) ? 1 : 0;
+    }
+    Double hashed = (ticks( ) - start) / perSec;
+    start = ticks( );
+    for (UInt r = 0; r < rounds; ++r)
+    {
+        for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+            found += (findLinear(TrackRegistry::entry(i).name) != NULL) ? 1 : 0;
+        found += (findLinear("custom") != NULL) ? 1 : 0;
+    }
+    Double linear = (ticks( ) - start) / perSec;
+    UInt nLookups = rounds * (NBUILTINTRACKS + 1);
+    printf("lookup   : %7.1f ns hashed, %7.1f ns strcmp chain\n",
+           1e9 * hashed / nLookups, 1e9 * linear / nLookups);
+
+    UInt loads = (rounds / 10 > 0) ? rounds / 10 : 1;
+    start = ticks( );
+    for (UInt r = 0; r < loads; ++r)
+    {
+        for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+        {
+            Track* track = Track::readTrack(TrackRegistry::entry(i).name);
+            found += track->trackLength( );
+            SAFE_DELETE(track);
+        }
+    }
+    Double baked = (ticks( ) - start) / perSec;
+    start = ticks( );
+    for (UInt r = 0; r < loads; ++r)
+    {
+        for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+        {
+            Track* track = buildTrack(TrackRegistry::entry(i));
+            found += track->trackLength( );
+            SAFE_DELETE(track);
+        }
+    }
+    Double built = (ticks( ) - start) / perSec;
+    UInt nLoads = loads * NBUILTINTRACKS;
+    printf("load     : %7.1f us baked, %7.1f us copied and indexed (%u)\n",
+           1e6 * baked / nLoads, 1e6 * built / nLoads, found);
+
+    // the noise zone part of Track::run, a frame every 50 units over three laps
+    printf("noise    : per frame, zones and transitions per lap\n");
+    for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+    {
+        Track* track = Track::readTrack(TrackRegistry::entry(i).name);
+        UInt laps = 3;
+        UInt nFrames = 0;
+        UInt nTransitions = 0;
+        Int previous = NONOISEZONE;
+        start = ticks( );
+        for (UInt r = 0; r < loads; ++r)
+        {
+            for (UInt position = 0; position < laps*track->length( ); position += 50)
+            {
+                Int zone = track->noiseZoneAt(position);
+                if (zone != previous)
+                    ++nTransitions;
+                previous = zone;
+                ++nFrames;
+            }
+        }
+        Double elapsed = (ticks( ) - start) / perSec;
+        printf("  %-12s %6.1f ns %3u zones %5.1f transitions\n", TrackRegistry::entry(i).name,
+               1e9 * elapsed / nFrames, track->nNoiseZones( ), Double(nTransitions) / (laps*loads));
+        SAFE_DELETE(track);
+    }
+
+    // a field of cars spread over the lap, driving 100 frames on every track
+    printf("road     : per car and frame, over all built-in tracks\n");
+    static const UInt fields[] = { 8, 64, 1024 };
+    for (UInt f = 0; f < sizeof(fields)/sizeof(fields[0]); ++f)
+    {
+        UInt nCars = fields[f];
+        UInt frames = (rounds / nCars > 0) ? rounds / nCars : 1;
+        std::vector<Int> positions(nCars);
+        std::vector<Track::Road> roads(nCars);
+        Double single = 0.0;
+        Double cursor = 0.0;
+        Double batch  = 0.0;
+        UInt sum = 0;
+        for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+        {
+            Track* track = Track::readTrack(TrackRegistry::entry(i).name);
+            std::vector<RoadCursor*> cursors;
+            for (UInt c = 0; c < nCars; ++c)
+                cursors.push_back(new RoadCursor(track));
+            for (UInt pass = 0; pass < 3; ++pass)
+            {
+                for (UInt c = 0; c < nCars; ++c)
+                    positions[c] = 14000 + UInt(Huge(c) * track->length( ) / nCars);
+                start = ticks( );
+                for (UInt frame = 0; frame < frames; ++frame)
+                {
+                    if (pass == 0)
+                    {
+                        for (UInt c = 0; c < nCars; ++c)
+                            roads[c] = track->roadComputer(positions[c]);
+                    }
+                    else if (pass == 1)
+                    {
+                        for (UInt c = 0; c < nCars; ++c)
+                            roads[c] = cursors[c]->road(positions[c]);
+                    }
+                    else
+                        track->roadBatch(&positions[0], &roads[0], nCars);
+                    for (UInt c = 0; c < nCars; ++c)
+                    {
+                        sum += roads[c].left;
+                        positions[c] += 150 + (c & 15)*10;
+                    }
+                }
+                Double elapsed = (ticks( ) - start) / perSec;
+                if (pass == 0)
+                    single += elapsed;
+                else if (pass == 1)
+                    cursor += elapsed;
+                else
+                    batch += elapsed;
+            }
+            for (UInt c = 0; c < nCars; ++c)
+                SAFE_DELETE(cursors[c]);
+            SAFE_DELETE(track);
+        }
+        Double nQueries = Double(frames) * nCars * NBUILTINTRACKS;
+        printf("  %4u cars %6.1f ns roadComputer %6.1f ns cursors %6.1f ns roadBatch (%u)\n", nCars,
+               1e9 * single / nQueries, 1e9 * cursor / nQueries, 1e9 * batch / nQueries, sum & 1);
+    }
+
+    // roadComputer walking the segments as before and searching the index,
+    // on the built-in tracks with the most segments and one of 100000
+    printf("segments : per lookup, walked and searched, and the index built per track\n");
+    std::vector<std::pair<UInt, UInt> > sizes;
+    for (UInt i = 0; i < NBUILTINTRACKS; ++i)
+    {
+        Track* track = Track::readTrack(TrackRegistry::entry(i).name);
+        sizes.push_back(std::make_pair(track->trackLength( ), i));
+        SAFE_DELETE(track);
+    }
+    std::stable_sort(sizes.begin( ), sizes.end( ), longerTrack);
+    UInt nErrors = 0;
+    for (UInt i = 0; (i < BENCHLONGESTTRACKS) && (i < sizes.size( )); ++i)
+    {
+        Char* name = TrackRegistry::entry(sizes[i].second).name;
+        Track* track = Track::readTrack(name);
+        nErrors += benchLookup(track, name, rounds);
+        SAFE_DELETE(track);
+    }
+    std::vector<Track::Definition> definition(BENCHSEGMENTS);
+    for (UInt i = 0; i < BENCHSEGMENTS; ++i)
+    {
+        definition[i].type    = Track::Type((i * 7) % 9);
+        definition[i].surface = Track::Surface(i % 3);
+        definition[i].noise   = Track::noNoise;
+        definition[i].length  = 1000 + 377*(i % 11);
+    }
+    Track::TrackData data;
+    data.userDefined = true;
+    data.weather     = Track::sunny;
+    data.ambience    = Track::noAmbience;
+    data.length      = BENCHSEGMENTS;
+    data.definition  = &definition[0];
+    Track* track = Track::fromData(data);
+    nErrors += benchLookup(track, "synthetic", rounds);
+    SAFE_DELETE(track);
+    return (nErrors == 0) ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// The batched road queries and the road cursor of a track, checked against a
+// seek for every position.
+
+#include "TrackConv.h"
+#include "RoadCursor.h"
+
+
+Boolean
+sameRoad(const Track::Road& a, const Track::Road& b)
+{
+    return (a.left == b.left) && (a.right == b.right) && (a.surface == b.surface) &&
+           (a.type == b.type) && (a.length == b.length);
+}
+
+
+// roadBatch against roadComputer, for batches of every size up to 200 cars
+UInt
+checkRoadBatch(Track* track, const Char* name)
+{
+    UInt random = 1;
+    std::vector<Int> positions;
+    std::vector<Track::Road> roads;
+    UInt nErrors = 0;
+    for (UInt n = 1; n <= 200; ++n)
+    {
+        positions.resize(n);
+        roads.resize(n);
+        for (UInt i = 0; i < n; ++i)
+        {
+            // segment starts and the positions around them too
+            if (nextRandom(random, 4) == 0)
+                positions[i] = nextRandom(random, 5)*track->length( ) + track->segmentStart(nextRandom(random, track->trackLength( ))) + nextRandom(random, 3);
+            else
+                positions[i] = nextRandom(random, 5*track->length( ));
+            if ((positions[i] > 0) && (nextRandom(random, 2) == 0))
+                --positions[i];
+        }
+        track->roadBatch(&positions[0], &roads[0], n);
+        for (UInt i = 0; i < n; ++i)
+        {
+            if (!sameRoad(roads[i], track->roadComputer(positions[i])))
+            {
+                printf("%s: roadBatch differs at %d\n", name, positions[i]);
+                if (++nErrors > 10)
+                    return nErrors;
+            }
+        }
+    }
+    return nErrors;
+}
+
+
+// a RoadCursor query against a seek for the same position
+static Boolean
+cursorRight(Track* track, RoadCursor& cursor, Int position)
+{
+    Track::Road expected = track->roadComputer(position);
+    UInt pos = position % track->length( );
+    UInt segment = track->segmentAt(pos);
+    Track::Road road = cursor.road(position);
+    return sameRoad(road, expected) && (cursor.segment( ) == segment) &&
+           (cursor.relPos( ) == pos - track->segmentStart(segment)) &&
+           (cursor.segmentAt(position) == segment) && sameRoad(track->road(position), expected);
+}
+
+
+// RoadCursor, which Track::road goes through, against a seek for every
+// query: forward and backward over three laps in steps from a few units to
+// many segments, back and forth across every lap line and jumping anywhere
+UInt
+checkRoadCursor(Track* track, const Char* name)
+{
+    static const Int steps[] = { 7, 61, 250, 1000, 5000, 40000 };
+    Int end = 3*Int(track->length( ));
+    UInt nErrors = 0;
+    for (UInt s = 0; s < sizeof(steps)/sizeof(steps[0]); ++s)
+    {
+        RoadCursor cursor(track);
+        for (Int position = 0; position < end; position += steps[s])
+        {
+            if (!cursorRight(track, cursor, position))
+            {
+                printf("%s: cursor differs at %d going forward %d at a time\n", name, position, steps[s]);
+                if (++nErrors > 10)
+                    return nErrors;
+            }
+        }
+        for (Int position = end - 1; position >= 0; position -= steps[s])
+        {
+            if (!cursorRight(track, cursor, position))
+            {
+                printf("%s: cursor differs at %d going backward %d at a time\n", name, position, steps[s]);
+                if (++nErrors > 10)
+                    return nErrors;
+            }
+        }
+    }
+
+    UInt random = 1;
+    RoadCursor cursor(track);
+    for (Int lap = 1; lap <= 3; ++lap)
+    {
+        Int line = lap*Int(track->length( ));
+        for (Int d = -3000; d <= 3000; d += 37)
+        {
+            Int position = line + ((nextRandom(random, 2) == 0) ? d : -d);
+            if (!cursorRight(track, cursor, position))
+            {
+                printf("%s: cursor differs at %d around lap %d\n", name, position, lap);
+                if (++nErrors > 10)
+                    return nErrors;
+            }
+        }
+    }
+    for (UInt i = 0; i < 2000; ++i)
+    {
+        Int position = Int(nextRandom(random, 4*track->length( )));
+        if (!cursorRight(track, cursor, position))
+        {
+            printf("%s: cursor differs at %d after a jump\n", name, position);
+            if (++nErrors > 10)
+                return nErrors;
+        }
+    }
+    return nErrors;
+}
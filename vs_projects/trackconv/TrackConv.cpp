@@ -0,0 +1,169 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// Converts custom tracks between the text (.trk) and binary (.trkb) formats,
+// generates and checks the baked index of the built-in tracks and checks the
+// noise zones, curve announcements, batched road queries and road cursor of
+// every track and the road of endless tracks, checks custom track files both
+// ways and benchmarks the custom file catalog:
+//
+//     trackconv <track.trk> [<track.trkb>]
+//     trackconv <track.trkb> [<track.trk>]
+//     trackconv -registry <TrackIndex.h>
+//     trackconv -check
+//     trackconv -bench [<rounds>]
+//     trackconv -endless [<km>]
+//     trackconv -catalog [<files>]
+//     trackconv -files [<directory>] [<rounds>]
+//
+// The checks and benchmarks of each part of a track are in a file of their
+// own next to this one.
+
+#include "TrackConv.h"
+#include "TrackFile.h"
+
+Tracer  _raceTracer("trackconv");
+
+
+static Boolean
+endsWith(const Char* name, const Char* extension)
+{
+    UInt length = strlen(name);
+    UInt extLength = strlen(extension);
+    return (length > extLength) && (_stricmp(name + length - extLength, extension) == 0);
+}
+
+
+static Int
+toBinary(const Char* source, const Char* target)
+{
+    Track::TrackData data;
+    data.userDefined = true;
+    if (!TrackFile::readText(source, data.definition, data.length, data.weather, data.ambience))
+    {
+        printf("%s: no track definition found\n", source);
+        SAFE_DELETE_ARRAY(data.definition);
+        return 1;
+    }
+    Track* track = Track::fromData(data);
+    SAFE_DELETE_ARRAY(data.definition);
+    Boolean result = TrackFile::writeBinary(target, track);
+    if (result)
+        printf("%s -> %s: %u segments, lap distance %u\n", source, target, track->trackLength( ), track->length( ));
+    else
+        printf("%s: could not write\n", target);
+    SAFE_DELETE(track);
+    return result ? 0 : 1;
+}
+
+
+static Int
+toText(const Char* source, const Char* target)
+{
+    TrackFile file;
+    if (!file.open(source))
+    {
+        printf("%s: not a valid track file\n", source);
+        return 1;
+    }
+    if (!TrackFile::writeText(target, file.definition( ), file.trackLength( ), file.weather( ), file.ambience( )))
+    {
+        printf("%s: could not write\n", target);
+        return 1;
+    }
+    printf("%s -> %s: %u segments\n", source, target, file.trackLength( ));
+    return 0;
+}
+
+
+Huge
+ticks( )
+{
+    LARGE_INTEGER now;
+    ::QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+
+Double
+ticksPerSec( )
+{
+    LARGE_INTEGER frequency;
+    ::QueryPerformanceFrequency(&frequency);
+    return Double(frequency.QuadPart);
+}
+
+
+// the track as Track builds it at run time, from the definition alone
+Track*
+buildTrack(const TrackRegistry::Entry& entry)
+{
+    Track::TrackData data;
+    data.userDefined = false;
+    data.weather     = entry.weather;
+    data.ambience    = entry.ambience;
+    data.length      = entry.length;
+    data.definition  = entry.definition;
+    return Track::fromData(data);
+}
+
+
+// Park-Miller, like racesim
+UInt
+nextRandom(UInt& state, UInt max)
+{
+    state = UInt((Huge(state) * 48271) % 2147483647);
+    return state % max;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    if ((argc == 3) && (strcmp(argv[1], "-registry") == 0))
+        return writeRegistry(argv[2]);
+    if ((argc == 2) && (strcmp(argv[1], "-check") == 0))
+        return checkRegistry( );
+    if ((argc >= 2) && (argc <= 3) && (strcmp(argv[1], "-bench") == 0))
+        return benchRegistry((argc == 3) ? UInt(atoi(argv[2])) : 100000);
+    if ((argc >= 2) && (argc <= 3) && (strcmp(argv[1], "-endless") == 0))
+        return benchEndless((argc == 3) ? UInt(atoi(argv[2])) : 1000);
+    if ((argc >= 2) && (argc <= 3) && (strcmp(argv[1], "-catalog") == 0))
+        return benchCatalog((argc == 3) ? UInt(atoi(argv[2])) : 10000);
+    if ((argc >= 2) && (argc <= 4) && (strcmp(argv[1], "-files") == 0))
+        return checkTrackFiles((argc >= 3) ? argv[2] : "Tracks", (argc == 4) ? UInt(atoi(argv[3])) : 200);
+    if ((argc < 2) || (argc > 3) || (argv[1][0] == '-'))
+    {
+        printf("usage: trackconv <track.trk> [<track.trkb>]\n");
+        printf("       trackconv <track.trkb> [<track.trk>]\n");
+        printf("       trackconv -registry <TrackIndex.h>\n");
+        printf("       trackconv -check\n");
+        printf("       trackconv -bench [<rounds>]\n");
+        printf("       trackconv -endless [<km>]\n");
+        printf("       trackconv -catalog [<files>]\n");
+        printf("       trackconv -files [<directory>] [<rounds>]\n");
+        return 2;
+    }
+    Char target[MAX_PATH];
+    if (endsWith(argv[1], ".trkb"))
+    {
+        if (argc == 3)
+            _snprintf(target, sizeof(target), "%s", argv[2]);
+        else
+            _snprintf(target, sizeof(target), "%.*s", (Int)strlen(argv[1]) - 1, argv[1]);
+        target[sizeof(target) - 1] = '\0';
+        return toText(argv[1], target);
+    }
+    if (argc == 3)
+    {
+        _snprintf(target, sizeof(target), "%s", argv[2]);
+        target[sizeof(target) - 1] = '\0';
+    }
+    else
+        TrackFile::binaryName(argv[1], target, sizeof(target));
+    return toBinary(argv[1], target);
+}
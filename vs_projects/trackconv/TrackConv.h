@@ -0,0 +1,41 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+#ifndef __RACING_TRACKCONV_H__
+#define __RACING_TRACKCONV_H__
+
+#include "Track.h"
+#include "TrackRegistry.h"
+#include "Game.h"
+#include <vector>
+
+
+// shared by the checks, in TrackConv.cpp
+Huge        ticks( );
+Double      ticksPerSec( );
+Track*      buildTrack(const TrackRegistry::Entry& entry);
+UInt        nextRandom(UInt& state, UInt max);
+
+// the checks of every part of a track, each in a file named after it
+UInt        checkNoise(Track* track, const Char* name);
+UInt        checkNoiseZones( );
+UInt        checkCalls(Track* track, const Char* name, UInt& nSkipped, UInt& nRepeated, UInt& nDropped);
+Boolean     sameRoad(const Track::Road& a, const Track::Road& b);
+UInt        checkRoadBatch(Track* track, const Char* name);
+UInt        checkRoadCursor(Track* track, const Char* name);
+UInt        checkEndless( );
+
+// the commands, in the files of the part they check or time
+Int         writeRegistry(const Char* target);
+Int         checkRegistry( );
+Int         benchRegistry(UInt rounds);
+Int         benchEndless(UInt km);
+Int         benchCatalog(UInt nFiles);
+Int         checkTrackFiles(const Char* directory, UInt rounds);
+
+
+#endif /* __RACING_TRACKCONV_H__ */
@@ -0,0 +1,334 @@
+/**
+* Top Speed 3
+* Copyright 2003-2013 Playing in the Dark (http://playinginthedark.net)
+* Code contributors: Davy Kager, Davy Loots and Leonard de Ruijter
+* This program is distributed under the terms of the GNU General Public License version 3.
+*/
+
+// The custom track files, checked with -files: every .trk in the directory
+// is converted to binary and back and read through Track both ways, binary
+// files broken in every field TrackFile::open checks have to be refused and
+// Track has to fall back to the text file. Last, loading the tracks is
+// timed from the text and from the binary files.
+
+#include "TrackConv.h"
+#include "TrackFile.h"
+#include <string>
+
+// where -files copies the tracks to
+#define TRACKFILECHECK      "trackfilecheck"
+#define TRACKFILECHECKTEXT  TRACKFILECHECK "\\track.trk"
+#define TRACKFILECHECKBINARY TRACKFILECHECK "\\track.trkb"
+
+
+static Boolean
+sameTrack(Track* a, Track* b)
+{
+    if ((a->trackLength( ) != b->trackLength( )) || (a->length( ) != b->length( )) ||
+        (a->lapCenter( ) != b->lapCenter( )) || (a->weather( ) != b->weather( )) ||
+        (a->ambience( ) != b->ambience( )))
+        return false;
+    for (UInt i = 0; i < a->trackLength( ); ++i)
+    {
+        const Track::Definition& x = a->definition( )[i];
+        const Track::Definition& y = b->definition( )[i];
+        if ((x.type != y.type) || (x.surface != y.surface) || (x.noise != y.noise) || (x.length != y.length))
+            return false;
+    }
+    for (UInt i = 0; i <= a->trackLength( ); ++i)
+    {
+        if ((a->segmentStart(i) != b->segmentStart(i)) || (a->segmentCenter(i) != b->segmentCenter(i)))
+            return false;
+    }
+    return true;
+}
+
+
+static Boolean
+readFile(const Char* filename, std::vector<UByte>& data)
+{
+    data.clear( );
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL)
+        return false;
+    UByte buffer[4096];
+    UInt n;
+    while ((n = UInt(fread(buffer, 1, sizeof(buffer), file))) > 0)
+        data.insert(data.end( ), buffer, buffer + n);
+    fclose(file);
+    return true;
+}
+
+
+// as TrackFile writes it, so a broken file gets past the checksum
+static void
+writeBroken(const std::vector<UByte>& data)
+{
+    TrackFile::Header header;
+    memcpy(&header, &data[0], sizeof(header));
+    UInt hash = 2166136261u;
+    for (UInt i = sizeof(header); i < data.size( ); ++i)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    header.checksum = hash;
+    FILE* file = fopen(TRACKFILECHECKBINARY, "wb");
+    if (file == NULL)
+        return;
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(&data[sizeof(header)], data.size( ) - sizeof(header), 1, file);
+    fclose(file);
+}
+
+
+static Boolean
+copyText(const Char* source)
+{
+    std::vector<UByte> data;
+    if (!readFile(source, data))
+        return false;
+    FILE* file = fopen(TRACKFILECHECKTEXT, "wb");
+    if (file == NULL)
+        return false;
+    if (!data.empty( ))
+        fwrite(&data[0], data.size( ), 1, file);
+    Boolean result = (ferror(file) == 0);
+    fclose(file);
+    return result;
+}
+
+
+// the ways a binary file is broken: a field of the first, middle or last
+// segment out of range, an index entry or the lap off by one
+enum Breakage
+{
+    badType,
+    badSurface,
+    badNoise,
+    shortSegment,
+    badStart,
+    badCenter,
+    badEnd,
+    badLapDistance,
+    badLapCenter,
+    noLap,
+    nBreakages
+};
+
+static const Char* _breakageNames[nBreakages] =
+{
+    "type", "surface", "noise", "short segment", "segment start", "segment center",
+    "end of the index", "lap distance", "lap center", "lap distance 0"
+};
+
+
+static void
+breakFile(std::vector<UByte>& data, UInt breakage, UInt segment)
+{
+    TrackFile::Header* header = (TrackFile::Header*)&data[0];
+    UInt length = header->length;
+    Track::Definition* definition = (Track::Definition*)(&data[0] + sizeof(TrackFile::Header));
+    UInt* segmentStart  = (UInt*)(definition + length);
+    UInt* segmentCenter = segmentStart + length + 1;
+    switch (breakage)
+    {
+    case badType :
+        definition[segment].type = Track::Type(Track::hairpinRight + 1);
+        break;
+    case badSurface :
+        definition[segment].surface = Track::Surface(Track::snow + 1);
+        break;
+    case badNoise :
+        definition[segment].noise = Track::Noise(Track::owl + 1);
+        break;
+    case shortSegment :
+        definition[segment].length = MINPARTLENGTH - 1;
+        break;
+    case badStart :
+        ++segmentStart[segment];
+        break;
+    case badCenter :
+        ++segmentCenter[segment];
+        break;
+    case badEnd :
+        ++segmentStart[length];
+        break;
+    case badLapDistance :
+        ++header->lapDistance;
+        break;
+    case badLapCenter :
+        ++header->lapCenter;
+        break;
+    case noLap :
+        header->lapDistance = 0;
+        break;
+    }
+}
+
+
+static Double
+timeLoads(const std::vector<std::string>& files, UInt rounds, Boolean binary, UInt& nLoaded)
+{
+    Char textName[] = TRACKFILECHECKTEXT;
+    Double total = 0.0;
+    for (UInt f = 0; f < files.size( ); ++f)
+    {
+        ::DeleteFile(TRACKFILECHECKBINARY);
+        if (!copyText(files[f].c_str( )))
+            continue;
+        if (binary)
+        {
+            Track* track = Track::readTrack(textName);
+            TrackFile::writeBinary(TRACKFILECHECKBINARY, track);
+            SAFE_DELETE(track);
+        }
+        Huge start = ticks( );
+        for (UInt r = 0; r < rounds; ++r)
+        {
+            Track* track = Track::readTrack(textName);
+            nLoaded += track->trackLength( );
+            SAFE_DELETE(track);
+        }
+        total += (ticks( ) - start) / ticksPerSec( );
+    }
+    return total;
+}
+
+
+Int
+checkTrackFiles(const Char* directory, UInt rounds)
+{
+    std::vector<std::string> files;
+    Char pattern[MAX_PATH];
+    _snprintf(pattern, sizeof(pattern), "%s\\*.trk", directory);
+    pattern[sizeof(pattern) - 1] = '\0';
+    WIN32_FIND_DATA findFileData;
+    HANDLE findHandle = ::FindFirstFile(pattern, &findFileData);
+    if (findHandle != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            Char name[MAX_PATH];
+            _snprintf(name, sizeof(name), "%s\\%s", directory, findFileData.cFileName);
+            name[sizeof(name) - 1] = '\0';
+            files.push_back(name);
+        }
+        while (::FindNextFile(findHandle, &findFileData));
+        ::FindClose(findHandle);
+    }
+    if (files.empty( ))
+    {
+        printf("%s: no track files\n", directory);
+        return 1;
+    }
+    ::CreateDirectory(TRACKFILECHECK, NULL);
+
+    Char textName[] = TRACKFILECHECKTEXT;
+    UInt nErrors = 0;
+    UInt nBroken = 0;
+    for (UInt f = 0; f < files.size( ); ++f)
+    {
+        const Char* name = files[f].c_str( );
+        ::DeleteFile(TRACKFILECHECKBINARY);
+        if (!copyText(name))
+        {
+            printf("%s: could not copy to %s\n", name, TRACKFILECHECK);
+            ++nErrors;
+            continue;
+        }
+        Track* text = Track::readTrack(textName);
+
+        // text to binary, read as Track reads it and written back as text
+        if (!TrackFile::writeBinary(TRACKFILECHECKBINARY, text))
+        {
+            printf("%s: could not convert\n", name);
+            ++nErrors;
+            SAFE_DELETE(text);
+            continue;
+        }
+        TrackFile file;
+        Boolean opened = file.open(TRACKFILECHECKBINARY);
+        if (!opened)
+        {
+            printf("%s: binary file refused\n", name);
+            ++nErrors;
+        }
+        Char again[MAX_PATH];
+        _snprintf(again, sizeof(again), "%s\\again.trk", TRACKFILECHECK);
+        again[sizeof(again) - 1] = '\0';
+        Boolean written = opened &&
+                          TrackFile::writeText(again, file.definition( ), file.trackLength( ), file.weather( ), file.ambience( ));
+        file.close( );
+        Track* binary = Track::readTrack(textName);
+        if (!sameTrack(text, binary))
+        {
+            printf("%s: not the same from the binary file\n", name);
+            ++nErrors;
+        }
+        SAFE_DELETE(binary);
+        if (written)
+        {
+            Track::TrackData data;
+            TrackFile::readText(again, data.definition, data.length, data.weather, data.ambience);
+            data.userDefined = true;
+            Track* back = Track::fromData(data);
+            SAFE_DELETE_ARRAY(data.definition);
+            if (!sameTrack(text, back))
+            {
+                printf("%s: not the same written back as text\n", name);
+                ++nErrors;
+            }
+            SAFE_DELETE(back);
+            ::DeleteFile(again);
+        }
+        else
+        {
+            printf("%s: could not write back as text\n", name);
+            ++nErrors;
+        }
+
+        // broken binary files, written after the text so Track takes them
+        std::vector<UByte> good;
+        readFile(TRACKFILECHECKBINARY, good);
+        UInt length = text->trackLength( );
+        UInt segments[3] = { 0, length/2, length - 1 };
+        for (UInt b = 0; b < nBreakages; ++b)
+        {
+            for (UInt s = 0; s < 3; ++s)
+            {
+                std::vector<UByte> data = good;
+                breakFile(data, b, segments[s]);
+                writeBroken(data);
+                ++nBroken;
+                if (file.open(TRACKFILECHECKBINARY))
+                {
+                    printf("%s: %s broken in segment %u taken\n", name, _breakageNames[b], segments[s]);
+                    ++nErrors;
+                }
+                file.close( );
+                Track* fallback = Track::readTrack(textName);
+                if (!sameTrack(text, fallback))
+                {
+                    printf("%s: %s broken in segment %u, not the text track\n", name, _breakageNames[b], segments[s]);
+                    ++nErrors;
+                }
+                SAFE_DELETE(fallback);
+            }
+        }
+        SAFE_DELETE(text);
+    }
+    printf("%u track files and %u broken binary files checked, %u errors\n",
+           UInt(files.size( )), nBroken, nErrors);
+
+    UInt nLoaded = 0;
+    Double fromText   = timeLoads(files, rounds, false, nLoaded);
+    Double fromBinary = timeLoads(files, rounds, true, nLoaded);
+    UInt nLoads = UInt(files.size( ))*rounds;
+    printf("load     : %7.2f us from text, %7.2f us from binary per track, %.1fx (%u)\n",
+           1e6 * fromText / nLoads, 1e6 * fromBinary / nLoads, fromText / fromBinary, nLoaded % 2);
+    ::DeleteFile(TRACKFILECHECKTEXT);
+    ::DeleteFile(TRACKFILECHECKBINARY);
+    ::RemoveDirectory(TRACKFILECHECK);
+    return (nErrors == 0) ? 0 : 1;
+}